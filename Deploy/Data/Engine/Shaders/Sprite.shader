@@ -1,4 +1,5 @@
 #version 300 es
+#pragma keywords COMPACT_INSTANCE
 
 /*
     Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
@@ -10,16 +11,31 @@
 
     layout(location = 0) in vec2 vertexPosition;
     layout(location = 1) in vec2 vertexCoords;
-    layout(location = 2) in mat4 instanceTransform;
-    layout(location = 6) in vec4 instanceRectangle;
-    layout(location = 7) in vec4 instanceCoords;
-    layout(location = 8) in vec4 instanceColor;
+
+    #if defined(COMPACT_INSTANCE)
+        layout(location = 2) in vec4 instanceBasis;
+        layout(location = 3) in vec3 instancePosition;
+        layout(location = 4) in vec4 instanceCoords;
+        layout(location = 5) in vec4 instanceColor;
+    #else
+        layout(location = 2) in mat4 instanceTransform;
+        layout(location = 6) in vec4 instanceRectangle;
+        layout(location = 7) in vec4 instanceCoords;
+        layout(location = 8) in vec4 instanceColor;
+    #endif
 
     out vec2 fragmentCoords;
     out vec4 fragmentColor;
 
     void main()
     {
+    #if defined(COMPACT_INSTANCE)
+        // Transform base quad using affine instance transformation with folded rectangle.
+        vec4 position = vec4(instancePosition, 1.0f);
+        position.xy += instanceBasis.xy * vertexPosition.x;
+        position.xy += instanceBasis.zw * vertexPosition.y;
+        position = vertexTransform * position;
+    #else
         // Transform base quad using sprite rectangle.
         vec4 position = vec4(vertexPosition, 0.0f, 1.0f);
 
@@ -32,6 +48,7 @@
         // Transform position using vertex and instance transformations.
         position = instanceTransform * position;
         position = vertexTransform * position;
+    #endif
 
         // Transform base coordinates using texture rectangle.
         vec2 coords = vertexCoords;
@@ -43,22 +60,11 @@
         coords.y += instanceCoords.y;
 
         // Rotate texture if specified region rectangle requires so.
-        float cosFactor, sinFactor;
-
         if((instanceCoords.z > instanceCoords.x && instanceCoords.w < instanceCoords.y) ||
             (instanceCoords.z < instanceCoords.x && instanceCoords.w > instanceCoords.y))
         {
-
-            cosFactor = cos(radians(90.0f));
-            sinFactor = sin(radians(90.0f));
+            coords = coords.yx;
         }
-        else
-        {
-            cosFactor = cos(radians(0.0f));
-            sinFactor = sin(radians(0.0f));
-        }
-
-        coords *= mat2(cosFactor, sinFactor, sinFactor, cosFactor);
 
         // Output sprite vertex.
         gl_Position = position;
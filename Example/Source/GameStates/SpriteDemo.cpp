@@ -51,7 +51,10 @@ SpriteDemo::CreateResult SpriteDemo::Create(Engine::Root* engine)
     }
 
     // Create game instance.
-    instance->m_gameInstance = Game::GameInstance::Create().UnwrapOr(nullptr);
+    Game::GameInstance::CreateFromParams gameInstanceParams;
+    gameInstanceParams.engineSystems = &engine->GetSystems();
+
+    instance->m_gameInstance = Game::GameInstance::Create(gameInstanceParams).UnwrapOr(nullptr);
     if(instance->m_gameInstance == nullptr)
     {
         LOG_ERROR("Could not create game instance!");
@@ -19,6 +19,9 @@ int main()
     {
         { "timer.maxUpdateDelta", "1.0f" },
         { "render.spriteBatchSize", "128" },
+        { "render.spriteCompactInstances", "false" },
+        { "render.recordCommands", "false" },
+        { "render.shaderCacheDirectory", "Cache/Shaders" },
     };
 
     if(auto engine = Engine::Root::Create(configVars).UnwrapOr(nullptr))
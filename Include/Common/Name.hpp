@@ -46,13 +46,13 @@ namespace Common
         Name(const char* string)
             : m_hash(Common::StringHash<HashType>(string))
         {
-            NameRegistry::GetInstance().Register(*this, string);
+            NameRegistry::GetInstance().Register(m_hash, string);
         }
 
         Name(const std::string_view string)
             : m_hash(Common::StringHash<HashType>(string))
         {
-            NameRegistry::GetInstance().Register(*this, string);
+            NameRegistry::GetInstance().Register(m_hash, string);
         }
 
         Name(const HashType hash)
@@ -131,7 +131,7 @@ namespace std
     {
         std::size_t operator()(const Common::Name& name) const noexcept
         {
-            return name.GetHash();
+            return static_cast<std::size_t>(name.GetHash());
         }
     };
 }
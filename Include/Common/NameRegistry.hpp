@@ -5,7 +5,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 #include "Common/NonCopyable.hpp"
 
 #ifndef NDEBUG
@@ -15,36 +20,83 @@
 /*
     Name Registry
 
-    Registry of names for looking them up by hash identifier.
-    This should generally be disabled in shipped game.
+    Registry of names for looking them up by hash identifier. Names constructed from strings
+    are registered automatically only when NAME_REGISTRY_ENABLED is defined, which should
+    generally be disabled in shipped game, as names then cannot be constexpr. Strings can
+    still be registered explicitly in all builds, either when interning runtime strings or
+    along with hashes that were calculated at compile time.
+
+    Registry can be used concurrently from multiple threads. Entries are split between shards
+    selected by hash, each guarded by its own reader-writer lock, so threads looking up names
+    rarely contend. String bytes are copied into monotonic arena of each shard, which avoids
+    allocation per entry and keeps returned string views valid for lifetime of registry.
+
+    Registering different string under already registered hash is detected as collision in
+    all builds. Collisions are logged and counted, and abort the program if configured to
+    (which is default when name registry is enabled).
 */
 
 namespace Common
 {
-    class Name;
-
     class NameRegistry : public NonCopyable
     {
     public:
-        using HashType = uint32_t;
+        using HashType = uint64_t;
+
+        static constexpr std::size_t ShardCount = 16;
+        static constexpr std::size_t ArenaBlockSize = 16 * 1024;
 
         NameRegistry();
         ~NameRegistry();
 
         static NameRegistry& GetInstance();
 
-#ifdef NAME_REGISTRY_ENABLED
     public:
-        void Register(std::string_view string);
-        std::string_view Lookup(HashType hash);
+        HashType Register(std::string_view string);
+        void Register(HashType hash, std::string_view string);
+        std::string_view Lookup(HashType hash) const;
+
+        bool IsRegistered(std::string_view string) const;
+        bool IsRegistered(HashType hash) const;
+
+        void SetAbortOnCollision(bool abortOnCollision)
+        {
+            m_abortOnCollision.store(abortOnCollision, std::memory_order_relaxed);
+        }
+
+        bool IsAbortingOnCollision() const
+        {
+            return m_abortOnCollision.load(std::memory_order_relaxed);
+        }
 
-        bool IsRegistered(std::string_view string);
-        bool IsRegistered(HashType hash);
+        std::size_t GetCollisionCount() const
+        {
+            return m_collisionCount.load(std::memory_order_relaxed);
+        }
+
+        std::size_t GetNameCount() const;
+        std::size_t GetArenaSize() const;
 
     private:
-        friend Name;
-        void Register(const Name& name, std::string_view string);
-        std::unordered_map<HashType, std::string> m_registry;
-#endif
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<HashType, std::string_view> entries;
+            std::vector<std::unique_ptr<char[]>> blocks;
+            char* blockCursor = nullptr;
+            std::size_t blockRemaining = 0;
+            std::size_t arenaSize = 0;
+        };
+
+        void ReportCollision(std::string_view registered, std::string_view string);
+
+        Shard& GetShard(HashType hash);
+        const Shard& GetShard(HashType hash) const;
+        std::string_view StoreString(Shard& shard, std::string_view string);
+
+    private:
+        Shard m_shards[ShardCount];
+        std::atomic<std::size_t> m_collisionCount = 0;
+        std::atomic<bool> m_abortOnCollision = false;
     };
 }
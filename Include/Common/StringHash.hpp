@@ -0,0 +1,185 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+/*
+    String Hash
+
+    Hashing of strings that can be evaluated at compile time. Kept free of other dependencies
+    so it can also be used by build tools, which need to calculate same hashes as engine does.
+
+    Hash is calculated with xxHash64 algorithm. Strings are consumed in eight byte words, which
+    are assembled from individual bytes during constant evaluation and read directly from
+    memory at run time, making hashing of long runtime strings much faster than with byte
+    serial functions. Both paths produce identical results.
+*/
+
+namespace Common
+{
+    namespace Detail
+    {
+        constexpr uint64_t HashPrime1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t HashPrime2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr uint64_t HashPrime3 = 0x165667B19E3779F9ull;
+        constexpr uint64_t HashPrime4 = 0x85EBCA77C2B2AE63ull;
+        constexpr uint64_t HashPrime5 = 0x27D4EB2F165667C5ull;
+
+        constexpr bool IsConstantEvaluated() noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+            return __builtin_is_constant_evaluated();
+#else
+            return true;
+#endif
+        }
+
+        constexpr uint64_t HashRotate(const uint64_t value, const int bits) noexcept
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        constexpr uint64_t HashRound(uint64_t accumulator, const uint64_t input) noexcept
+        {
+            accumulator += input * HashPrime2;
+            accumulator = HashRotate(accumulator, 31);
+            return accumulator * HashPrime1;
+        }
+
+        constexpr uint64_t HashMergeRound(uint64_t accumulator, const uint64_t value) noexcept
+        {
+            accumulator ^= HashRound(0, value);
+            return accumulator * HashPrime1 + HashPrime4;
+        }
+
+        struct HashConstantReader
+        {
+            template<typename Type>
+            static constexpr Type Read(const char* data) noexcept
+            {
+                Type value = 0;
+                for(std::size_t i = 0; i < sizeof(Type); ++i)
+                {
+                    value |= static_cast<Type>(static_cast<uint8_t>(data[i])) << (i * 8);
+                }
+
+                return value;
+            }
+        };
+
+        struct HashRuntimeReader
+        {
+            template<typename Type>
+            static Type Read(const char* data) noexcept
+            {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                return HashConstantReader::Read<Type>(data);
+#else
+                Type value;
+                std::memcpy(&value, data, sizeof(Type));
+                return value;
+#endif
+            }
+        };
+
+        template<typename Reader>
+        constexpr uint64_t XXHash64(const char* data, const std::size_t size) noexcept
+        {
+            const char* const end = data + size;
+            uint64_t hash = 0;
+
+            if(size >= 32)
+            {
+                uint64_t lanes[4] = { HashPrime1 + HashPrime2, HashPrime2, 0, 0 - HashPrime1 };
+
+                const char* const limit = end - 32;
+                do
+                {
+                    for(uint64_t& lane : lanes)
+                    {
+                        lane = HashRound(lane, Reader::template Read<uint64_t>(data));
+                        data += 8;
+                    }
+                }
+                while(data <= limit);
+
+                hash = HashRotate(lanes[0], 1) + HashRotate(lanes[1], 7) +
+                    HashRotate(lanes[2], 12) + HashRotate(lanes[3], 18);
+
+                for(const uint64_t lane : lanes)
+                {
+                    hash = HashMergeRound(hash, lane);
+                }
+            }
+            else
+            {
+                hash = HashPrime5;
+            }
+
+            hash += static_cast<uint64_t>(size);
+
+            while(end - data >= 8)
+            {
+                hash ^= HashRound(0, Reader::template Read<uint64_t>(data));
+                hash = HashRotate(hash, 27) * HashPrime1 + HashPrime4;
+                data += 8;
+            }
+
+            if(end - data >= 4)
+            {
+                hash ^= static_cast<uint64_t>(Reader::template Read<uint32_t>(data)) * HashPrime1;
+                hash = HashRotate(hash, 23) * HashPrime2 + HashPrime3;
+                data += 4;
+            }
+
+            while(data != end)
+            {
+                hash ^= static_cast<uint64_t>(static_cast<uint8_t>(*data)) * HashPrime5;
+                hash = HashRotate(hash, 11) * HashPrime1;
+                ++data;
+            }
+
+            hash ^= hash >> 33;
+            hash *= HashPrime2;
+            hash ^= hash >> 29;
+            hash *= HashPrime3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+    }
+
+    template<typename Type>
+    constexpr Type StringHash(const std::string_view string) noexcept
+    {
+        static_assert(std::is_same<Type, uint32_t>::value || std::is_same<Type, uint64_t>::value);
+
+        /*
+            Fast non-cryptographic hashing function for strings. Names are identified by their
+            64-bit hashes, for which collisions are detected by name registry at run time and by
+            reflection generator for names hashed at compile time. Hashes of 32-bit size are
+            folded from 64-bit ones and are more likely to collide.
+
+            Current implementation: xxHash64
+        */
+
+        const uint64_t hash = Detail::IsConstantEvaluated() ?
+            Detail::XXHash64<Detail::HashConstantReader>(string.data(), string.size()) :
+            Detail::XXHash64<Detail::HashRuntimeReader>(string.data(), string.size());
+
+        if constexpr(std::is_same<Type, uint32_t>::value)
+        {
+            return static_cast<uint32_t>(hash ^ (hash >> 32));
+        }
+        else
+        {
+            return hash;
+        }
+    }
+}
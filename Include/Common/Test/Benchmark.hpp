@@ -0,0 +1,72 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <fmt/core.h>
+
+/*
+    Benchmark
+
+    Helpers for benchmark test cases, which are skipped by default and are run by passing
+    --no-skip to test executable. Results are reported as lines in "Label: 0.0000 ms/unit"
+    format, optionally followed by details such as counters gathered during measurement.
+*/
+
+namespace Test
+{
+    class Stopwatch
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        Stopwatch() :
+            m_start(Clock::now())
+        {
+        }
+
+        void Restart()
+        {
+            m_start = Clock::now();
+        }
+
+        double GetMilliseconds() const
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+        }
+
+    private:
+        Clock::time_point m_start;
+    };
+
+    template<typename Function>
+    double MeasureMilliseconds(Function&& function)
+    {
+        Stopwatch stopwatch;
+        function();
+        return stopwatch.GetMilliseconds();
+    }
+
+    inline std::string FormatBenchmark(std::string_view label, double milliseconds,
+        std::string_view unit = {}, std::string_view details = {})
+    {
+        std::string result = fmt::format("{}: {:.4f} ms", label, milliseconds);
+
+        if(!unit.empty())
+        {
+            result += fmt::format("/{}", unit);
+        }
+
+        if(!details.empty())
+        {
+            result += fmt::format(", {}", details);
+        }
+
+        return result;
+    }
+}
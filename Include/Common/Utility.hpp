@@ -11,6 +11,7 @@
 #include <numeric>
 #include <filesystem>
 #include "Common/Debug.hpp"
+#include "Common/StringHash.hpp"
 
 /*
     Utility
@@ -87,28 +88,6 @@ namespace Common
     std::string StringTrimRight(const std::string text, const char* characters = " ");
     std::string StringTrim(const std::string text, const char* characters = " ");
 
-    template<typename Type>
-    constexpr Type StringHash(const std::string_view string) noexcept
-    {
-        static_assert(std::is_same<Type, uint32_t>::value || std::is_same<Type, uint64_t>::value);
-
-        /*
-            Small and simple hashing function for strings. May need to be replaced in case of
-            collisions. Use only if you can detect possible collisions, as t is obviously not
-            cryptographically secure.
-
-            Current implementation: djb2
-        */
-
-        Type hash = 5381;
-        for(char c : string)
-        {
-            hash = ((hash << 5) + hash) + c;
-        }
-
-        return hash;
-    }
-
     template<typename Type>
     constexpr Type CombineHash(const Type seed, const Type hash)
     {
@@ -13,6 +13,7 @@
 
 #include <cctype>
 #include <ctime>
+#include <chrono>
 #include <cstdint>
 
 #include <thread>
@@ -46,6 +47,7 @@ namespace fs = std::filesystem;
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/type_precision.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/euler_angles.hpp>
@@ -72,3 +74,33 @@ namespace fs = std::filesystem;
 #include <Common/Result.hpp>
 #include <Common/Name.hpp>
 #include <Common/Logger/Logger.hpp>
+
+namespace Reflection
+{
+    // Math types are serialized as packed components of their value type.
+    template<glm::length_t Length, typename Type, glm::qualifier Qualifier>
+    struct SerializedElements<glm::vec<Length, Type, Qualifier>>
+    {
+        using ElementType = Type;
+        static constexpr std::size_t Count = Length;
+    };
+
+    template<glm::length_t Columns, glm::length_t Rows, typename Type, glm::qualifier Qualifier>
+    struct SerializedElements<glm::mat<Columns, Rows, Type, Qualifier>>
+    {
+        using ElementType = Type;
+        static constexpr std::size_t Count = Columns * Rows;
+    };
+
+    template<typename Type, glm::qualifier Qualifier>
+    struct SerializedElements<glm::qua<Type, Qualifier>>
+    {
+        using ElementType = Type;
+        static constexpr std::size_t Count = 4;
+    };
+}
+
+REFLECTION_STATIC_TYPE(glm::vec2)
+REFLECTION_STATIC_TYPE(glm::vec3)
+REFLECTION_STATIC_TYPE(glm::vec4)
+REFLECTION_STATIC_TYPE(glm::quat)
@@ -44,6 +44,9 @@ namespace Core
         SystemType* Locate() const;
         SystemBase* Locate(Reflection::TypeIdentifier systemType) const;
 
+        template<typename SystemType>
+        bool Has() const;
+
         void ForEach(ForEachCallback callback);
         void ForEachReverse(ForEachCallback callback);
 
@@ -218,6 +221,17 @@ namespace Core
         return it->second;
     }
 
+    template<typename SystemBase>
+    template<typename SystemType>
+    bool SystemStorage<SystemBase>::Has() const
+    {
+        ASSERT(m_finalized, "Cannot locate systems while storage \"{}\" is not finalized!",
+            Reflection::GetName<SystemBase>().GetString());
+
+        // Check for optional system without asserting on its absence.
+        return m_systemMap.find(Reflection::GetIdentifier<SystemType>()) != m_systemMap.end();
+    }
+
     template<typename SystemBase>
     void SystemStorage<SystemBase>::ForEach(ForEachCallback callback)
     {
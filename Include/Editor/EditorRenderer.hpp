@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <Common/Event/EventReceiver.hpp>
 #include <Core/EngineSystem.hpp>
 #include <Graphics/RenderContext.hpp>
 #include <Graphics/Buffer.hpp>
@@ -26,10 +27,19 @@ namespace Graphics
     class RenderContext;
 }
 
+namespace Renderer
+{
+    class GameRenderer;
+    struct FramePacket;
+}
+
 /*
     Editor Renderer
 
-    Draws editor interface.
+    Draws editor interface. Interface draw data is copied into frame packet of game renderer at the
+    end of frame and drawn after game instance when packet is submitted, which happens on render
+    thread when enabled. User callbacks of draw commands are not supported, as they cannot be
+    called outside of game thread.
 */
 
 namespace Editor
@@ -46,10 +56,13 @@ namespace Editor
         bool OnAttach(const EditorSubsystemStorage& editorSubsystems) override;
         bool CreateResources(const Core::EngineSystemStorage& engineSystems);
         void OnEndInterface() override;
+        void OnPacketSubmitted(const Renderer::FramePacket& packet);
 
     private:
         System::Window* m_window = nullptr;
         Graphics::RenderContext* m_renderContext = nullptr;
+        Renderer::GameRenderer* m_gameRenderer = nullptr;
+        Event::Receiver<void(const Renderer::FramePacket&)> m_packetSubmittedReceiver;
 
         std::unique_ptr<Graphics::VertexBuffer> m_vertexBuffer;
         std::unique_ptr<Graphics::IndexBuffer> m_indexBuffer;
@@ -13,7 +13,9 @@
 /*
     Engine Root
 
-    Main class that encapsulated all engine subsystems.
+    Main class that encapsulated all engine subsystems. Engine can be created headless with
+    "engine.headless" config variable, in which case it runs without window, OpenGL context and
+    rendering systems, but still processes game states along with their game instances.
 */
 
 namespace Engine
@@ -40,6 +42,21 @@ namespace Engine
 
         ErrorCode Run();
 
+        bool IsHeadless() const
+        {
+            return m_headless;
+        }
+
+        bool IsRecordingCommands() const
+        {
+            return m_recordCommands;
+        }
+
+        bool HasRenderer() const
+        {
+            return !m_headless || m_recordCommands;
+        }
+
         const Core::EngineSystemStorage& GetSystems() const
         {
             return m_engineSystems;
@@ -55,5 +72,7 @@ namespace Engine
 
     private:
         Core::EngineSystemStorage m_engineSystems;
+        bool m_headless = false;
+        bool m_recordCommands = false;
     };
 }
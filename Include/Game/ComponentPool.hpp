@@ -68,9 +68,11 @@ namespace Game
             using BaseIterator = typename ComponentList::iterator;
 
         public:
-            ComponentIterator(const BaseIterator& iterator, const BaseIterator& end);
+            ComponentIterator(const BaseIterator& begin, const BaseIterator& iterator, const BaseIterator& end);
 
             ComponentType& operator*();
+            EntityHandle GetEntityHandle() const;
+            ComponentIndex GetComponentIndex() const;
             bool operator==(const ComponentIterator& other) const;
             bool operator!=(const ComponentIterator& other) const;
             ComponentIterator& operator++();
@@ -79,6 +81,7 @@ namespace Game
             void EnsureValid();
 
         private:
+            BaseIterator m_begin; // Beginning of container that we are iterating over.
             BaseIterator m_iterator; // Iterator that we are wrapping around.
             BaseIterator m_end; // End of container that we are iterating over.
         };
@@ -139,8 +142,8 @@ namespace Game
     }
 
     template<typename ComponentType>
-    ComponentPool<ComponentType>::ComponentIterator::ComponentIterator(const BaseIterator& iterator, const BaseIterator& end) :
-        m_iterator(iterator), m_end(end)
+    ComponentPool<ComponentType>::ComponentIterator::ComponentIterator(const BaseIterator& begin, const BaseIterator& iterator, const BaseIterator& end) :
+        m_begin(begin), m_iterator(iterator), m_end(end)
     {
         this->EnsureValid();
     }
@@ -151,6 +154,18 @@ namespace Game
         return m_iterator->component;
     }
 
+    template<typename ComponentType>
+    EntityHandle ComponentPool<ComponentType>::ComponentIterator::GetEntityHandle() const
+    {
+        return m_iterator->entity;
+    }
+
+    template<typename ComponentType>
+    typename ComponentPool<ComponentType>::ComponentIndex ComponentPool<ComponentType>::ComponentIterator::GetComponentIndex() const
+    {
+        return static_cast<ComponentIndex>(m_iterator - m_begin);
+    }
+
     template<typename ComponentType>
     bool ComponentPool<ComponentType>::ComponentIterator::operator==(const ComponentIterator& other) const
     {
@@ -213,6 +228,7 @@ namespace Game
         ComponentEntry& componentEntry = m_entries[componentIndex];
         ASSERT(componentEntry.flags == ComponentFlags::Unused);
         componentEntry.flags = ComponentFlags::Exists;
+        componentEntry.entity = entity;
         return Common::Success(&componentEntry.component);
     }
 
@@ -276,6 +292,7 @@ namespace Game
         // Mark component as unused.
         ASSERT(componentEntry.flags & ComponentFlags::Exists);
         componentEntry.flags = ComponentFlags::Unused;
+        componentEntry.entity = EntityHandle();
 
         // Recreate component storage in place.
         ComponentType* component = &componentEntry.component;
@@ -291,13 +308,13 @@ namespace Game
     template<typename ComponentType>
     typename ComponentPool<ComponentType>::ComponentIterator ComponentPool<ComponentType>::Begin()
     {
-        return ComponentIterator(m_entries.begin(), m_entries.end());
+        return ComponentIterator(m_entries.begin(), m_entries.begin(), m_entries.end());
     }
 
     template<typename ComponentType>
     typename ComponentPool<ComponentType>::ComponentIterator ComponentPool<ComponentType>::End()
     {
-        return ComponentIterator(m_entries.end(), m_entries.end());
+        return ComponentIterator(m_entries.begin(), m_entries.end(), m_entries.end());
     }
 
     template<typename ComponentType>
@@ -19,6 +19,8 @@ namespace Game
 
     class CameraComponent final : public Component
     {
+        REFLECTION_ENABLE(CameraComponent, Component)
+
     public:
         struct ProjectionTypes
         {
@@ -57,3 +59,10 @@ namespace Game
         float m_fov = 90.0f;
     };
 }
+
+REFLECTION_TYPE_BEGIN(Game::CameraComponent, Game::Component)
+    REFLECTION_FIELD(m_viewSize)
+    REFLECTION_FIELD(m_nearPlane)
+    REFLECTION_FIELD(m_farPlane)
+    REFLECTION_FIELD(m_fov)
+REFLECTION_TYPE_END
@@ -0,0 +1,76 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include "Game/Component.hpp"
+
+/*
+    Script Component
+
+    Attaches script behavior loaded by script system to entity (see ScriptSystem). Entity is
+    dispatched to its behavior every tick, unless it is sleeping. Sleeping entity is skipped
+    until its wake time passes or until it is woken up explicitly.
+*/
+
+namespace Game
+{
+    class ScriptComponent final : public Component
+    {
+        REFLECTION_ENABLE(ScriptComponent, Component)
+
+    public:
+        static constexpr uint32_t InvalidBehaviorIndex = std::numeric_limits<uint32_t>::max();
+
+    public:
+        ScriptComponent();
+        ~ScriptComponent();
+
+        void SetBehavior(Common::Name behavior)
+        {
+            m_behavior = behavior;
+            m_behaviorIndex = InvalidBehaviorIndex;
+        }
+
+        void Sleep()
+        {
+            m_wakeTime = std::numeric_limits<double>::infinity();
+        }
+
+        void Wake()
+        {
+            m_wakeTime = 0.0;
+        }
+
+        bool IsSleeping(double time) const
+        {
+            return m_wakeTime > time;
+        }
+
+        Common::Name GetBehavior() const
+        {
+            return m_behavior;
+        }
+
+        EntityHandle GetEntity() const
+        {
+            return m_entity;
+        }
+
+    private:
+        friend class ScriptSystem;
+
+        bool OnInitialize(ComponentSystem* componentSystem,
+            const EntityHandle& entitySelf) override;
+
+    private:
+        EntityHandle m_entity;
+        Common::Name m_behavior;
+        uint32_t m_behaviorIndex = InvalidBehaviorIndex;
+        double m_wakeTime = 0.0;
+    };
+}
+
+REFLECTION_TYPE(Game::ScriptComponent, Game::Component)
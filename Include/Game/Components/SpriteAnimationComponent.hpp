@@ -11,7 +11,10 @@
 /*
     Sprite Animation Component
 
-    Playback control for animated sequence of sprites.
+    Playback control for animated sequence of sprites. Animations should be played by their
+    indices resolved once from animation list, instead of looking up their names each time.
+    Index of currently displayed frame is tracked, so sprite texture view is only updated
+    when it changes (see SpriteSystem).
 */
 
 namespace Game
@@ -44,7 +47,8 @@ namespace Game
         void ResetInterpolation();
         void Tick(float timeDelta);
 
-        void Play(std::string animationName, bool loop);
+        void Play(std::string_view animationName, bool loop);
+        void PlayByIndex(uint32_t animationIndex, bool loop);
         void Pause();
         void Resume();
         void Stop();
@@ -77,6 +81,16 @@ namespace Game
             return m_currentSpriteAnimation;
         }
 
+        void SetCurrentFrameIndex(uint32_t frameIndex)
+        {
+            m_currentFrameIndex = frameIndex;
+        }
+
+        uint32_t GetCurrentFrameIndex() const
+        {
+            return m_currentFrameIndex;
+        }
+
     private:
         bool OnInitialize(ComponentSystem* componentSystem,
             const EntityHandle& entitySelf) override;
@@ -86,6 +100,7 @@ namespace Game
         SpriteAnimationListPtr m_spriteAnimationList = nullptr;
         const SpriteAnimation* m_currentSpriteAnimation = nullptr;
         PlaybackFlags::Type m_playbackInfo = PlaybackFlags::None;
+        uint32_t m_currentFrameIndex = SpriteAnimation::InvalidFrameIndex;
         float m_currentAnimationTime = 0.0f;
         float m_previousAnimationTime = 0.0f;
     };
@@ -21,6 +21,8 @@ namespace Game
 
     class SpriteComponent final : public Component
     {
+        REFLECTION_ENABLE(SpriteComponent, Component)
+
     public:
         SpriteComponent();
         ~SpriteComponent();
@@ -94,3 +96,10 @@ namespace Game
         bool m_filtered = true;
     };
 }
+
+REFLECTION_TYPE_BEGIN(Game::SpriteComponent, Game::Component)
+    REFLECTION_FIELD(m_rectangle)
+    REFLECTION_FIELD(m_color)
+    REFLECTION_FIELD(m_transparent)
+    REFLECTION_FIELD(m_filtered)
+REFLECTION_TYPE_END
@@ -6,10 +6,15 @@
 #pragma once
 
 #include <Core/SystemStorage.hpp>
+#include <Core/EngineSystem.hpp>
 #include "Game/GameSystem.hpp"
 
 /*
     Game Instance
+
+    Game instances can be created with access to engine systems, which lets game systems use
+    engine services such as scheduled garbage collection of their script states. Game instances
+    created without them remain fully functional, with such services being left out.
 */
 
 namespace Game
@@ -23,7 +28,14 @@ namespace Game
         };
 
         using CreateResult = Common::Result<std::unique_ptr<GameInstance>, CreateErrors>;
+
+        struct CreateFromParams
+        {
+            const Core::EngineSystemStorage* engineSystems = nullptr;
+        };
+
         static CreateResult Create();
+        static CreateResult Create(const CreateFromParams& params);
 
     public:
         ~GameInstance();
@@ -0,0 +1,160 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <Common/Event/EventReceiver.hpp>
+#include <Core/EngineSystem.hpp>
+#include "Game/GameSystem.hpp"
+#include "Game/EntityHandle.hpp"
+
+namespace Script
+{
+    class ScriptState;
+    class ScriptBindings;
+}
+
+/*
+    Script System
+
+    Dispatches script behaviors of entities with script components (see ScriptComponent). Each
+    behavior is a script chunk loaded under its own name, executed in separate environment that
+    falls back to global table. Instead of calling script for every entity, awake entities that
+    share behavior are gathered into packed batch table and behavior is entered only once per
+    tick, which keeps cost of crossing between native code and scripts independent of number of
+    entities. Behavior can define any of the following functions:
+
+        function Update(batch, timeDelta)
+            for i = 1, batch.count do
+                local transform = batch.transforms[i]
+                -- batch.entities[i] holds identifier of entity
+            end
+        end
+
+        function Run(entity, transform, timeDelta)
+            while true do
+                timeDelta = coroutine.yield(1.0) -- Sleep for one second.
+            end
+        end
+
+    Update receives whole batch at once, with transform components passed as object handles
+    to be used with reflected field bindings (see Script::ScriptBindings). Run is started as
+    coroutine for each entity and is resumed with time delta every tick that entity is awake.
+    Number of seconds yielded from coroutine puts entity to sleep for that long. Entities can
+    also be put to sleep from Update by calling Sleep(index, seconds) with index of entity in
+    batch, where omitting seconds makes entity sleep until woken. Sleeping entities are not
+    gathered into batches at all, so idle entities cost nothing beside checking their wake time.
+
+    When coroutine started by Run finishes or raises error, entity of behavior without Update is
+    put to sleep until woken, which starts new coroutine for it. Behaviors that also define Update
+    keep entity awake, so Update continues to be called for it, while its finished coroutine is
+    not started again.
+
+    Each entity keeps single object handle for its transform component, which is pointed at
+    component for duration of dispatch and cleared afterwards, as component pool can reallocate
+    between ticks. Handles kept by scripts past dispatch (including ones held by coroutines that
+    are resumed later) raise script error when used instead of accessing stale memory.
+
+    When created with engine systems (see GameInstance::CreateFromParams), script state uses
+    bindings of engine and is registered with script garbage collector, which schedules its
+    collection within frame budget instead of letting Lua pause at arbitrary allocations.
+
+    Script state is only created once first behavior is loaded, so game instances that never
+    use scripts do not allocate Lua state or bind reflected types for it.
+*/
+
+namespace Game
+{
+    class EntitySystem;
+    class ComponentSystem;
+    class ScriptComponent;
+    class TransformComponent;
+
+    class ScriptSystem final : public GameSystem
+    {
+        REFLECTION_ENABLE(ScriptSystem, GameSystem)
+
+    public:
+        struct TickStats
+        {
+            std::size_t dispatchCalls = 0;
+            std::size_t dispatchedEntities = 0;
+            std::size_t sleepingEntities = 0;
+            std::size_t failedDispatches = 0;
+        };
+
+    public:
+        ScriptSystem(const Core::EngineSystemStorage* engineSystems = nullptr);
+        ~ScriptSystem() override;
+
+        bool LoadBehavior(Common::Name name, std::string_view source);
+        void Sleep(ScriptComponent& component, float seconds);
+
+        Script::ScriptState* GetScriptState() const
+        {
+            return m_scriptState.get();
+        }
+
+        const Script::ScriptBindings* GetScriptBindings() const
+        {
+            return m_scriptBindings;
+        }
+
+        const TickStats& GetTickStats() const
+        {
+            return m_tickStats;
+        }
+
+        double GetTime() const
+        {
+            return m_time;
+        }
+
+    private:
+        struct Behavior
+        {
+            Common::Name name;
+            int environmentReference = 0;
+            int batchReference = 0;
+            int batchSize = 0;
+            std::vector<ScriptComponent*> components;
+            std::vector<TransformComponent*> transforms;
+        };
+
+        using BehaviorList = std::vector<Behavior>;
+        using BehaviorLookup = std::unordered_map<Common::Name, uint32_t>;
+
+        bool OnAttach(const GameSystemStorage& gameSystems) override;
+        void OnTick(float timeDelta) override;
+        void OnEntityDestroyed(EntityHandle entity);
+
+        bool CreateScriptState();
+        bool ResolveBehavior(ScriptComponent& component);
+        bool DispatchBehavior(Behavior& behavior, float timeDelta);
+        void ClearHandles(const Behavior& behavior);
+
+    private:
+        const Core::EngineSystemStorage* m_engineSystems = nullptr;
+        EntitySystem* m_entitySystem = nullptr;
+        ComponentSystem* m_componentSystem = nullptr;
+        Event::Receiver<void(EntityHandle)> m_entityDestroyReceiver;
+
+        std::unique_ptr<Script::ScriptBindings> m_ownedScriptBindings;
+        const Script::ScriptBindings* m_scriptBindings = nullptr;
+        std::unique_ptr<Script::ScriptState> m_scriptState;
+        int m_dispatchReference = 0;
+        int m_sleepersReference = 0;
+        int m_threadsReference = 0;
+        int m_handlesReference = 0;
+
+        BehaviorList m_behaviors;
+        BehaviorLookup m_behaviorLookup;
+
+        double m_time = 0.0;
+        TickStats m_tickStats;
+    };
+}
+
+REFLECTION_TYPE(Game::ScriptSystem, Game::GameSystem)
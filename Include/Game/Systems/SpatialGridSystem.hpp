@@ -0,0 +1,149 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <Common/Event/EventReceiver.hpp>
+#include "Game/GameSystem.hpp"
+#include "Game/EntityHandle.hpp"
+
+/*
+    Spatial Grid System
+
+    Uniform hash grid of entity bounds on XY plane that accelerates range and visibility queries.
+    Bounds are derived from transform components as conservative boxes around rotated unit quads
+    and are updated incrementally each tick, looking up proxies only for entities whose transforms
+    have changed and touching grid cells only for entities that have moved across cell boundaries.
+    Query results are written into caller provided buffers.
+*/
+
+namespace Game
+{
+    class EntitySystem;
+    class ComponentSystem;
+
+    class SpatialGridSystem final : public GameSystem
+    {
+        REFLECTION_ENABLE(SpatialGridSystem, GameSystem)
+
+    public:
+        struct Bounds
+        {
+            glm::vec2 min = glm::vec2(0.0f);
+            glm::vec2 max = glm::vec2(0.0f);
+        };
+
+        struct RayHit
+        {
+            EntityHandle entity;
+            float distance = 0.0f;
+        };
+
+        using EntityList = std::vector<EntityHandle>;
+        using RayHitList = std::vector<RayHit>;
+
+    public:
+        SpatialGridSystem();
+        ~SpatialGridSystem() override;
+
+        void SetCellSize(float cellSize);
+        void Update();
+
+        std::size_t QueryAabb(const glm::vec2& min, const glm::vec2& max, EntityList& results);
+        std::size_t QueryRadius(const glm::vec2& center, float radius, EntityList& results);
+        std::size_t QueryRay(const glm::vec2& origin, const glm::vec2& direction,
+            float maxDistance, RayHitList& results);
+
+        float GetCellSize() const
+        {
+            return m_cellSize;
+        }
+
+        std::size_t GetEntityCount() const
+        {
+            return m_proxyLookup.size();
+        }
+
+        std::size_t GetCellCount() const
+        {
+            return m_cells.size();
+        }
+
+        std::size_t GetLastUpdateRebucketCount() const
+        {
+            return m_lastUpdateRebucketCount;
+        }
+
+    private:
+        using ProxyIndex = uint32_t;
+        using CellKey = uint64_t;
+        using CellEntries = std::vector<ProxyIndex>;
+        using CellMap = std::unordered_map<CellKey, CellEntries>;
+        using ProxyLookup = std::unordered_map<EntityHandle, ProxyIndex>;
+
+        struct CellRange
+        {
+            bool operator==(const CellRange& other) const;
+            bool operator!=(const CellRange& other) const;
+
+            glm::ivec2 min = glm::ivec2(0);
+            glm::ivec2 max = glm::ivec2(-1);
+        };
+
+        struct Proxy
+        {
+            EntityHandle entity;
+            Bounds bounds;
+            CellRange cells;
+            std::size_t slotIndex = 0;
+            uint32_t queryStamp = 0;
+        };
+
+        struct TransformSlot
+        {
+            EntityHandle entity;
+            glm::vec3 position = glm::vec3(0.0f);
+            glm::vec3 scale = glm::vec3(0.0f);
+            ProxyIndex proxyIndex = 0;
+            uint32_t updateStamp = 0;
+        };
+
+        bool OnAttach(const GameSystemStorage& gameSystems) override;
+        void OnTick(float timeDelta) override;
+        void OnEntityDestroyed(EntityHandle entity);
+
+        template<typename Visitor>
+        void VisitProxies(const Bounds& bounds, Visitor&& visitor);
+
+        CellRange CalculateCellRange(const Bounds& bounds) const;
+        static CellKey CalculateCellKey(int x, int y);
+
+        void InsertProxy(ProxyIndex proxyIndex);
+        void RemoveProxy(ProxyIndex proxyIndex);
+        void MoveProxy(ProxyIndex proxyIndex, const Bounds& bounds);
+        void ReleaseProxy(ProxyIndex proxyIndex);
+        uint32_t NextQueryStamp();
+
+    private:
+        EntitySystem* m_entitySystem = nullptr;
+        ComponentSystem* m_componentSystem = nullptr;
+        Event::Receiver<void(EntityHandle)> m_entityDestroyReceiver;
+
+        float m_cellSize = 4.0f;
+        float m_inverseCellSize = 1.0f / 4.0f;
+
+        std::vector<Proxy> m_proxies;
+        std::vector<ProxyIndex> m_freeProxies;
+        std::vector<TransformSlot> m_transformSlots;
+        ProxyLookup m_proxyLookup;
+        CellMap m_cells;
+
+        uint32_t m_queryStamp = 0;
+        uint32_t m_updateStamp = 0;
+        std::size_t m_lastUpdateRebucketCount = 0;
+    };
+}
+
+REFLECTION_TYPE(Game::SpatialGridSystem, Game::GameSystem)
@@ -9,6 +9,10 @@
 
 /*
     Sprite System
+
+    Ticks playback of sprite animations and evaluates their frames for rendering in single pass
+    over packed component pool. Sprite texture views are only updated for animations with frame
+    index that changed since previous evaluation.
 */
 
 namespace Game
@@ -23,12 +27,20 @@ namespace Game
         SpriteSystem();
         ~SpriteSystem() override;
 
+        void UpdateAnimationFrames(float timeAlpha);
+
+        std::size_t GetLastFrameUpdateCount() const
+        {
+            return m_lastFrameUpdateCount;
+        }
+
     private:
         bool OnAttach(const GameSystemStorage& gameSystems) override;
         void OnTick(float timeDelta) override;
 
     private:
         ComponentSystem* m_componentSystem = nullptr;
+        std::size_t m_lastFrameUpdateCount = 0;
     };
 }
 
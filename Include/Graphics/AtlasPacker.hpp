@@ -0,0 +1,109 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+/*
+    Atlas Packer
+
+    Allocates rectangles inside atlas page of fixed size using skyline bottom-left heuristic.
+    Skyline is a list of horizontal segments that describe top edge of already allocated area.
+    New rectangle is placed on top of segment where it ends lowest, preferring narrower segments
+    on ties to waste less space. Allocated rectangles cannot be freed individually, so owner of
+    packer reclaims space by repacking live rectangles into new page.
+
+    Each rectangle is surrounded by padding which can be filled by extruding its edge pixels, so
+    filtered and mipmapped samples do not bleed into neighboring rectangles. Packer does not use
+    OpenGL and works without GPU.
+*/
+
+namespace Graphics
+{
+    class AtlasPacker final : private Common::NonCopyable
+    {
+    public:
+        enum class BleedPolicy
+        {
+            // Padding is left transparent.
+            Transparent,
+
+            // Padding repeats edge pixels of rectangle.
+            Extrude,
+        };
+
+        struct CreateFromParams
+        {
+            int width = 0;
+            int height = 0;
+            int padding = 0;
+        };
+
+        enum class CreateErrors
+        {
+            InvalidArgument,
+        };
+
+        using CreateResult = Common::Result<std::unique_ptr<AtlasPacker>, CreateErrors>;
+        static CreateResult Create(const CreateFromParams& params);
+
+        static void CopyPadded(const uint8_t* source, int width, int height, int channels,
+            int padding, BleedPolicy bleedPolicy, uint8_t* destination);
+
+    public:
+        ~AtlasPacker();
+
+        std::optional<glm::ivec4> Allocate(int width, int height);
+        bool CanAllocate(int width, int height) const;
+        void Reset();
+
+        float GetOccupancy() const;
+
+        int64_t GetAllocatedArea() const
+        {
+            return m_allocatedArea;
+        }
+
+        int GetWidth() const
+        {
+            return m_width;
+        }
+
+        int GetHeight() const
+        {
+            return m_height;
+        }
+
+        int GetPadding() const
+        {
+            return m_padding;
+        }
+
+    private:
+        AtlasPacker();
+
+        struct SkylineNode
+        {
+            int x = 0;
+            int y = 0;
+            int width = 0;
+        };
+
+        struct Placement
+        {
+            std::size_t nodeIndex = 0;
+            int y = 0;
+        };
+
+        std::optional<int> FitNode(std::size_t nodeIndex, int width, int height) const;
+        std::optional<Placement> FindPlacement(int width, int height) const;
+
+    private:
+        std::vector<SkylineNode> m_skyline;
+        int64_t m_allocatedArea = 0;
+        int m_width = 0;
+        int m_height = 0;
+        int m_padding = 0;
+    };
+}
@@ -0,0 +1,203 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <Core/EngineSystem.hpp>
+
+/*
+    Command Recorder
+
+    Recording OpenGL backend that plugs into GL function dispatch table and replaces entry points
+    used by engine with functions that only record compact command stream and per frame stats.
+    No GPU work is performed and context state is emulated just enough for queries made by
+    graphics objects to succeed, which allows renderer to run on machines without GPU for
+    benchmarks and golden command stream tests. Queries are answered by emulated context and
+    counted in frame stats, but are not recorded. Only single recorder can be installed at a time.
+    When attached as engine system, recorder is installed until destroyed and command stream
+    with stats is reset at the beginning of every frame. Engine frames can be disabled when frames
+    are delimited by render thread instead, which must then be the only thread issuing commands.
+*/
+
+namespace Graphics
+{
+    struct CommandRecorderDispatch;
+
+    class CommandRecorder final : public Core::EngineSystem
+    {
+        REFLECTION_ENABLE(CommandRecorder, Core::EngineSystem)
+
+    public:
+        enum class CommandType : uint8_t
+        {
+            ActiveTexture,
+            AttachShader,
+            BindBuffer,
+            BindSampler,
+            BindTexture,
+            BindVertexArray,
+            BlendEquationSeparate,
+            BlendFuncSeparate,
+            BufferData,
+            Clear,
+            ClearColor,
+            ClearDepthf,
+            CompileShader,
+            CompressedTexImage2D,
+            CreateProgram,
+            CreateShader,
+            DeleteBuffers,
+            DeleteProgram,
+            DeleteSamplers,
+            DeleteShader,
+            DeleteTextures,
+            DeleteVertexArrays,
+            DepthMask,
+            DetachShader,
+            Disable,
+            DrawArrays,
+            DrawArraysInstanced,
+            DrawElements,
+            Enable,
+            EnableVertexAttribArray,
+            GenBuffers,
+            GenSamplers,
+            GenTextures,
+            GenVertexArrays,
+            GenerateMipmap,
+            LinkProgram,
+            PixelStorei,
+            ProgramBinary,
+            ProgramParameteri,
+            SamplerParameterf,
+            SamplerParameterfv,
+            SamplerParameteri,
+            Scissor,
+            ShaderSource,
+            TexImage2D,
+            TexParameteri,
+            TexSubImage2D,
+            Uniform1i,
+            Uniform2fv,
+            UniformMatrix4fv,
+            UseProgram,
+            VertexAttribDivisor,
+            VertexAttribPointer,
+            Viewport,
+
+            Count,
+        };
+
+        enum class ArgumentType : uint8_t
+        {
+            Integer,
+            Enum,
+            Float,
+        };
+
+        struct Argument
+        {
+            ArgumentType type = ArgumentType::Integer;
+
+            union
+            {
+                int64_t integer = 0;
+                float real;
+            };
+        };
+
+        struct Command
+        {
+            CommandType type = CommandType::Count;
+            uint32_t argumentOffset = 0;
+            uint32_t argumentCount = 0;
+        };
+
+        struct FrameStats
+        {
+            std::size_t commandCount = 0;
+            std::size_t queries = 0;
+            std::size_t drawCalls = 0;
+            std::size_t drawnInstances = 0;
+            std::size_t bufferBytesUploaded = 0;
+            std::size_t textureBytesUploaded = 0;
+            std::size_t stateChanges = 0;
+            std::size_t redundantStateChanges = 0;
+            std::size_t programSwitches = 0;
+            std::size_t uniformUpdates = 0;
+        };
+
+        using CommandList = std::vector<Command>;
+        using ArgumentList = std::vector<Argument>;
+
+    public:
+        CommandRecorder();
+        ~CommandRecorder() override;
+
+        bool Install();
+        void Uninstall();
+
+        void BeginFrame();
+        void EndFrame();
+        void ClearCommands();
+
+        void SetRecordingCommands(bool enabled);
+        void SetEngineFrames(bool enabled);
+        std::string FormatCommands() const;
+        std::string FormatCommand(const Command& command) const;
+
+        static const char* GetCommandName(CommandType type);
+        static CommandRecorder* GetInstalled();
+
+        bool IsInstalled() const
+        {
+            return m_installed;
+        }
+
+        const CommandList& GetCommands() const
+        {
+            return m_commands;
+        }
+
+        const ArgumentList& GetArguments() const
+        {
+            return m_arguments;
+        }
+
+        const FrameStats& GetFrameStats() const
+        {
+            return m_frameStats;
+        }
+
+        const FrameStats& GetLastFrameStats() const
+        {
+            return m_lastFrameStats;
+        }
+
+    private:
+        friend CommandRecorderDispatch;
+        struct ContextState;
+
+        bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
+        void OnBeginFrame() override;
+        void OnEndFrame() override;
+
+        void Record(CommandType type, std::initializer_list<Argument> arguments);
+
+    private:
+        CommandList m_commands;
+        ArgumentList m_arguments;
+        FrameStats m_frameStats;
+        FrameStats m_lastFrameStats;
+
+        std::unique_ptr<ContextState> m_contextState;
+        std::vector<void*> m_savedDispatch;
+        bool m_recordingCommands = true;
+        bool m_engineFrames = true;
+        bool m_installed = false;
+    };
+}
+
+REFLECTION_TYPE(Graphics::CommandRecorder, Core::EngineSystem)
@@ -0,0 +1,171 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <Core/EngineSystem.hpp>
+#include "Graphics/AtlasPacker.hpp"
+
+/*
+    Dynamic Atlas
+
+    Packs small textures into shared atlas pages when they are loaded, so sprites that use
+    different textures can still be drawn in single instanced batch. Packed texture holds atlas
+    region instead of its own OpenGL object, which is only created if texture is updated later.
+    Texture views resolve page and coordinates of their region once and keep them until layout
+    version of atlas changes. Textures are not packed when they are larger than
+    "render.atlasMaxRegionSize", have fewer than three channels, or were loaded with atlas
+    packing disabled (e.g. when sampled with repeating coordinates).
+
+    Pages are mipmapped and regions are surrounded by "render.atlasPadding" pixels of extruded
+    edges, so filtering does not bleed between regions for first few mip levels. Mip chains of pages
+    that regions were placed into are regenerated once in UpdateMipmaps(), which is called by game
+    renderer before each frame packet samples pages, instead of after every inserted region.
+
+    Allocated space in page is never written over, as page may still be referenced by frame
+    packets in flight. Region is released when its texture is destroyed and pages without any live
+    regions are evicted. When region does not fit and "render.atlasMaxPages" limit has been reached,
+    live regions from all pages are repacked into new pages from pixel copies kept by regions.
+    Moved regions update their page and rectangle, and layout version is incremented so texture
+    views resolve them again. Same happens when region is released by texture being updated.
+
+    Packing uploads pixels and needs OpenGL context, same as creating texture does.
+*/
+
+namespace Graphics
+{
+    class RenderContext;
+    class Texture;
+
+    class AtlasRegion final : private Common::NonCopyable
+    {
+    public:
+        using ConstTexturePtr = std::shared_ptr<const Texture>;
+
+    public:
+        glm::vec4 MapTextureRect(const glm::vec4& textureRect) const;
+        std::vector<uint8_t> CopyPixels(int channels) const;
+
+        const ConstTexturePtr& GetPage() const
+        {
+            return m_page;
+        }
+
+        const Texture* GetPagePtr() const
+        {
+            return m_page.get();
+        }
+
+        glm::ivec4 GetPixelRect() const
+        {
+            return m_pixelRect;
+        }
+
+        glm::vec4 GetTextureRect() const
+        {
+            return m_textureRect;
+        }
+
+    private:
+        friend class DynamicAtlas;
+
+        ConstTexturePtr m_page;
+        glm::ivec4 m_pixelRect = glm::ivec4(0);
+        glm::vec4 m_textureRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        // Padded pixels for repacking.
+        std::vector<uint8_t> m_pixels;
+        int m_paddedWidth = 0;
+        int m_paddedHeight = 0;
+        int m_padding = 0;
+    };
+
+    class DynamicAtlas final : public Core::EngineSystem
+    {
+        REFLECTION_ENABLE(DynamicAtlas, Core::EngineSystem)
+
+    public:
+        using RegionPtr = std::shared_ptr<const AtlasRegion>;
+
+        struct Stats
+        {
+            std::size_t pageCount = 0;
+            std::size_t regionCount = 0;
+            std::size_t packedRegions = 0;
+            std::size_t rejectedRegions = 0;
+            std::size_t evictedPages = 0;
+            std::size_t defragmentations = 0;
+            std::size_t movedRegions = 0;
+            int64_t regionArea = 0;
+            int64_t pageArea = 0;
+
+            float GetPackingEfficiency() const
+            {
+                return pageArea != 0 ? static_cast<float>(regionArea) / pageArea : 0.0f;
+            }
+        };
+
+    public:
+        DynamicAtlas();
+        ~DynamicAtlas() override;
+
+        RegionPtr Insert(const uint8_t* pixels, int width, int height, int channels);
+        bool CanInsert(int width, int height, int channels) const;
+        void Release(const RegionPtr& region);
+        void EvictUnused();
+        bool Defragment();
+        void UpdateMipmaps();
+
+        Stats GetStats() const;
+
+        bool IsEnabled() const
+        {
+            return m_enabled;
+        }
+
+        int GetPageSize() const
+        {
+            return m_pageSize;
+        }
+
+        uint64_t GetLayoutVersion() const
+        {
+            return m_layoutVersion;
+        }
+
+    private:
+        bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
+
+        using TexturePtr = std::shared_ptr<Texture>;
+        using RegionWeakPtr = std::weak_ptr<AtlasRegion>;
+
+        struct Page
+        {
+            TexturePtr texture;
+            std::unique_ptr<AtlasPacker> packer;
+            std::vector<RegionWeakPtr> regions;
+            bool mipmapsDirty = false;
+        };
+
+        std::unique_ptr<Page> CreatePage() const;
+        TexturePtr CreatePageTexture() const;
+        std::unique_ptr<AtlasPacker> CreatePacker() const;
+        void AssignRegion(Page& page, const std::shared_ptr<AtlasRegion>& region, glm::ivec4 pixelRect);
+
+    private:
+        RenderContext* m_renderContext = nullptr;
+        std::vector<std::unique_ptr<Page>> m_pages;
+        uint64_t m_layoutVersion = 1;
+        Stats m_stats;
+
+        bool m_enabled = true;
+        int m_pageSize = 1024;
+        int m_maxRegionSize = 128;
+        int m_padding = 2;
+        std::size_t m_maxPages = 4;
+    };
+}
+
+REFLECTION_TYPE(Graphics::DynamicAtlas, Core::EngineSystem)
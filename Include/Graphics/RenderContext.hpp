@@ -16,7 +16,13 @@ namespace System
 /*
     Render Context
 
-    Manages internal state of rendering system.
+    Manages internal state of rendering system. Pushed render states are kept in storage that is
+    reused between frames, and popping state only restores groups changed since it was pushed.
+    Also queries compressed texture formats that context can sample from.
+
+    Context may be owned by render thread while game thread creates, updates or destroys resources.
+    Resources call AcquireContext() before issuing OpenGL calls, which takes context back through
+    callback set by renderer (see RenderThread). Callback is not set when context never moves.
 */
 
 namespace Graphics
@@ -25,11 +31,16 @@ namespace Graphics
     {
         REFLECTION_ENABLE(RenderContext, Core::EngineSystem)
 
+    public:
+        using AcquireCallback = std::function<void()>;
+
     public:
         RenderContext();
         ~RenderContext() override;
 
         void MakeCurrent();
+        void AcquireContext();
+        void SetAcquireCallback(AcquireCallback callback);
         RenderState& PushState();
         void PopState();
 
@@ -38,14 +49,24 @@ namespace Graphics
             return m_currentState;
         }
 
+        std::size_t GetPushedStateCount() const
+        {
+            return m_pushedStateCount;
+        }
+
+        bool IsCompressedFormatSupported(GLenum format) const;
+
     private:
         bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
 
     private:
         System::Window* m_window = nullptr;
+        AcquireCallback m_acquireCallback;
 
         RenderState m_currentState;
-        std::stack<RenderState> m_pushedStates;
+        std::vector<RenderState> m_pushedStates;
+        std::size_t m_pushedStateCount = 0;
+        std::vector<GLenum> m_compressedFormats;
     };
 }
 
@@ -7,6 +7,11 @@
 
 /*
     Render state
+
+    Caches OpenGL state so redundant calls can be skipped. Each state group that was changed
+    since last time dirty groups were cleared is tracked in a bitmask, which allows pushed states
+    to be restored by comparing and applying only groups that were actually modified. Checking
+    errors after each OpenGL call stalls pipeline and is enabled by default only in debug builds.
 */
 
 namespace Graphics
@@ -14,13 +19,21 @@ namespace Graphics
     namespace OpenGL
     {
         bool CheckErrors();
+        void SetErrorChecks(bool enabled);
+        bool AreErrorChecksEnabled();
+
+    #ifndef NDEBUG
+        const bool DefaultErrorChecks = true;
+    #else
+        const bool DefaultErrorChecks = false;
+    #endif
 
         const GLenum InvalidEnum = GL_INVALID_ENUM;
         const GLuint InvalidHandle = 0;
         const GLuint InvalidAttribute = -1;
         const GLuint InvalidUniform = -1;
 
-        static const GLenum Capabilities[] =
+        constexpr GLenum Capabilities[] =
         {
             GL_BLEND,
             GL_CULL_FACE,
@@ -32,7 +45,7 @@ namespace Graphics
         const std::size_t CapabilityCount =
             Common::StaticArraySize(Capabilities);
 
-        static const std::tuple<GLenum, GLenum> BufferBindingTargets[] =
+        constexpr std::tuple<GLenum, GLenum> BufferBindingTargets[] =
         {
             { GL_ARRAY_BUFFER, GL_ARRAY_BUFFER_BINDING },
             { GL_ELEMENT_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER_BINDING },
@@ -41,7 +54,7 @@ namespace Graphics
         const std::size_t BufferBindingTargetCount =
             Common::StaticArraySize(BufferBindingTargets);
 
-        static const std::tuple<GLenum, GLenum> TextureBindingTargets[] =
+        constexpr std::tuple<GLenum, GLenum> TextureBindingTargets[] =
         {
             { GL_TEXTURE_2D, GL_TEXTURE_BINDING_2D },
         };
@@ -49,7 +62,7 @@ namespace Graphics
         const std::size_t TextureBindingTargetCount =
             Common::StaticArraySize(TextureBindingTargets);
 
-        static const GLenum PixelStoreParameters[] =
+        constexpr GLenum PixelStoreParameters[] =
         {
             GL_PACK_ALIGNMENT,
             GL_UNPACK_ALIGNMENT,
@@ -57,8 +70,79 @@ namespace Graphics
 
         const std::size_t PixelStoreParameterCount =
             Common::StaticArraySize(PixelStoreParameters);
+
+        // Indices into state arrays above, or array size for unsupported values.
+        constexpr std::size_t GetCapabilityIndex(GLenum cap)
+        {
+            switch(cap)
+            {
+            case GL_BLEND: return 0;
+            case GL_CULL_FACE: return 1;
+            case GL_DEPTH_TEST: return 2;
+            case GL_SCISSOR_TEST: return 3;
+            case GL_STENCIL_TEST: return 4;
+            default: return CapabilityCount;
+            }
+        }
+
+        constexpr std::size_t GetBufferBindingTargetIndex(GLenum target)
+        {
+            switch(target)
+            {
+            case GL_ARRAY_BUFFER: return 0;
+            case GL_ELEMENT_ARRAY_BUFFER: return 1;
+            default: return BufferBindingTargetCount;
+            }
+        }
+
+        constexpr std::size_t GetTextureBindingTargetIndex(GLenum target)
+        {
+            switch(target)
+            {
+            case GL_TEXTURE_2D: return 0;
+            default: return TextureBindingTargetCount;
+            }
+        }
+
+        constexpr std::size_t GetPixelStoreParameterIndex(GLenum pname)
+        {
+            switch(pname)
+            {
+            case GL_PACK_ALIGNMENT: return 0;
+            case GL_UNPACK_ALIGNMENT: return 1;
+            default: return PixelStoreParameterCount;
+            }
+        }
     }
 
+    struct StateGroups
+    {
+        enum
+        {
+            None = 0,
+
+            Capabilities = 1 << 0,
+            VertexArray = 1 << 1,
+            BufferBindings = 1 << 2,
+            ActiveTexture = 1 << 3,
+            TextureBindings = 1 << 4,
+            SamplerBindings = 1 << 5,
+            PixelStore = 1 << 6,
+            Program = 1 << 7,
+            Viewport = 1 << 8,
+            ClearDepth = 1 << 9,
+            ClearColor = 1 << 10,
+            DepthMask = 1 << 11,
+            BlendFunc = 1 << 12,
+            BlendEquation = 1 << 13,
+            Scissor = 1 << 14,
+
+            All = (1 << 15) - 1,
+        };
+
+        using Type = uint16_t;
+    };
+
     class RenderState final : public Common::Resettable<RenderState>
     {
     public:
@@ -66,7 +150,7 @@ namespace Graphics
         ~RenderState();
 
         void Save();
-        void Apply(RenderState& other);
+        void Apply(const RenderState& other, StateGroups::Type groups = StateGroups::All);
 
         void Enable(GLenum cap);
         void Disable(GLenum cap);
@@ -119,7 +203,20 @@ namespace Graphics
         void DrawArrays(GLenum mode, GLint first, GLsizei count);
         void DrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
 
+        void SetDirtyGroups(StateGroups::Type groups)
+        {
+            m_dirtyGroups = groups;
+        }
+
+        StateGroups::Type GetDirtyGroups() const
+        {
+            return m_dirtyGroups;
+        }
+
     private:
+        // State groups changed since dirty groups were last cleared.
+        StateGroups::Type m_dirtyGroups = StateGroups::None;
+
         // glEnable
         GLboolean m_capabilities[OpenGL::CapabilityCount];
 
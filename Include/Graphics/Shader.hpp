@@ -6,21 +6,28 @@
 #pragma once
 
 #include "Graphics/RenderContext.hpp"
+#include "Graphics/ShaderPreprocessor.hpp"
 
 namespace System
 {
     class FileHandle;
+    class FileSystem;
 }
 
 /*
     Shader
     
-    Loads and links GLSL shaders into an OpenGL program object.
+    Loads and links GLSL shaders into an OpenGL program object. Source code is expanded by shader
+    preprocessor into code for each stage first. Active uniforms are reflected once after linking
+    into a table keyed by name hash, so uniform handles can be resolved once and reused without
+    querying OpenGL. Writes made through uniform batch share a single program bind that is
+    reverted when batch goes out of scope. See shader variants for keyword permutations.
 */
 
 namespace Graphics
 {
     class RenderContext;
+    class ShaderCache;
 
     class Shader final : private Common::NonCopyable
     {
@@ -28,18 +35,33 @@ namespace Graphics
         struct LoadFromString
         {
             RenderContext* renderContext = nullptr;
+            ShaderCache* shaderCache = nullptr;
+            ShaderPreprocessor::IncludeCallback includeCallback;
+            std::vector<std::string> defines;
+            fs::path sourcePath;
             std::string shaderCode;
         };
 
         struct LoadFromFile
         {
             RenderContext* renderContext = nullptr;
+            ShaderCache* shaderCache = nullptr;
+            System::FileSystem* fileSystem = nullptr;
+            std::vector<std::string> defines;
+        };
+
+        struct LoadFromSource
+        {
+            RenderContext* renderContext = nullptr;
+            ShaderCache* shaderCache = nullptr;
+            ShaderPreprocessor::ExpandedSource source;
         };
 
         enum class CreateErrors
         {
             InvalidArgument,
             InvalidFileContents,
+            FailedPreprocessing,
             FailedShaderCreation,
             FailedShaderCompilation,
             FailedProgramCreation,
@@ -48,17 +70,59 @@ namespace Graphics
 
         using CreateResult = Common::Result<std::unique_ptr<Shader>, CreateErrors>;
         static CreateResult Create(const LoadFromString& params);
+        static CreateResult Create(const LoadFromSource& params);
         static CreateResult Create(System::FileHandle& file, const LoadFromFile& params);
 
+    public:
+        struct Uniform
+        {
+            GLint location = static_cast<GLint>(OpenGL::InvalidUniform);
+            GLenum type = GL_NONE;
+            GLint size = 0;
+
+            bool IsValid() const
+            {
+                return location != static_cast<GLint>(OpenGL::InvalidUniform);
+            }
+        };
+
+        class UniformBatch : private Common::NonCopyable
+        {
+        public:
+            explicit UniformBatch(Shader& shader);
+            ~UniformBatch();
+
+            template<typename Type>
+            UniformBatch& Set(const Uniform& uniform, const Type& value);
+
+            template<typename Type>
+            UniformBatch& Set(Common::Name name, const Type& value);
+
+        private:
+            Shader& m_shader;
+            GLuint m_previousProgram = OpenGL::InvalidHandle;
+        };
+
+        using UniformMap = std::unordered_map<Common::Name, Uniform>;
+
     public:
         ~Shader();
 
         template<typename Type>
-        void SetUniform(std::string name, const Type& value);
+        void SetUniform(const Uniform& uniform, const Type& value);
+
+        template<typename Type>
+        void SetUniform(Common::Name name, const Type& value);
 
+        Uniform GetUniform(Common::Name name) const;
         GLint GetAttributeIndex(std::string name) const;
         GLint GetUniformIndex(std::string name) const;
 
+        const UniformMap& GetUniforms() const
+        {
+            return m_uniforms;
+        }
+
         GLuint GetHandle() const
         {
             return m_handle;
@@ -67,55 +131,72 @@ namespace Graphics
     private:
         Shader();
 
+        void ReflectUniforms();
+
+        template<typename Type>
+        static void WriteUniform(GLint location, const Type& value);
+
     private:
         RenderContext* m_renderContext = nullptr;
         GLuint m_handle = OpenGL::InvalidHandle;
+        UniformMap m_uniforms;
     };
 
     using ShaderPtr = std::shared_ptr<Shader>;
 
     template<>
-    inline void Shader::SetUniform(std::string name, const GLint& value)
+    inline void Shader::WriteUniform(GLint location, const GLint& value)
     {
-        // Change shader program.
-        GLuint previousProgram = m_renderContext->GetState().GetCurrentProgram();
-        m_renderContext->GetState().UseProgram(GetHandle());
-
-        // Set uniform variable.
-        glUniform1i(GetUniformIndex(name), value);
+        glUniform1i(location, value);
         OpenGL::CheckErrors();
-
-        // Revert to previous program.
-        m_renderContext->GetState().UseProgram(previousProgram);
     }
 
     template<>
-    inline void Shader::SetUniform(std::string name, const glm::vec2& value)
+    inline void Shader::WriteUniform(GLint location, const glm::vec2& value)
     {
-        // Change shader program.
-        GLuint previousProgram = m_renderContext->GetState().GetCurrentProgram();
-        m_renderContext->GetState().UseProgram(GetHandle());
+        glUniform2fv(location, 1, glm::value_ptr(value));
+        OpenGL::CheckErrors();
+    }
 
-        // Set uniform variable.
-        glUniform2fv(GetUniformIndex(name), 1, glm::value_ptr(value));
+    template<>
+    inline void Shader::WriteUniform(GLint location, const glm::mat4& value)
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
         OpenGL::CheckErrors();
+    }
 
-        // Revert to previous program.
-        m_renderContext->GetState().UseProgram(previousProgram);
+    template<typename Type>
+    void Shader::SetUniform(const Uniform& uniform, const Type& value)
+    {
+        // Writing to uniform requires its program to be current. Render state
+        // skips both program changes if this program is already in use.
+        if(uniform.IsValid())
+        {
+            UniformBatch(*this).Set(uniform, value);
+        }
     }
 
-    template<>
-    inline void Shader::SetUniform(std::string name, const glm::mat4& value)
+    template<typename Type>
+    void Shader::SetUniform(Common::Name name, const Type& value)
     {
-        // Change shader program.
-        GLuint previousProgram = m_renderContext->GetState().GetCurrentProgram();
-        m_renderContext->GetState().UseProgram(GetHandle());
+        SetUniform(GetUniform(name), value);
+    }
 
-        // Set uniform variable.
-        glUniformMatrix4fv(GetUniformIndex(name), 1, GL_FALSE, glm::value_ptr(value));
-        OpenGL::CheckErrors();
+    template<typename Type>
+    Shader::UniformBatch& Shader::UniformBatch::Set(const Uniform& uniform, const Type& value)
+    {
+        // Uniforms not found in linked program are silently ignored, same as OpenGL does.
+        if(uniform.IsValid())
+        {
+            WriteUniform(uniform.location, value);
+        }
 
-        // Revert to previous program.
-        m_renderContext->GetState().UseProgram(previousProgram);
+        return *this;
+    }
+
+    template<typename Type>
+    Shader::UniformBatch& Shader::UniformBatch::Set(Common::Name name, const Type& value)
+    {
+        return Set(m_shader.GetUniform(name), value);
     }
 }
@@ -0,0 +1,75 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <Core/EngineSystem.hpp>
+
+/*
+    Shader Cache
+
+    Stores linked shader program binaries on disk so they can be loaded on next launch instead of
+    compiling shader stages from source. Programs are keyed by hash of their preprocessed source
+    code (which includes defines) and driver identification strings. Cache files that do not match
+    their key, driver or supported binary formats, or that fail to link, are deleted and program
+    is compiled from source again. Cache is disabled when "render.shaderCacheDirectory" config
+    variable is empty or when driver does not support any program binary formats.
+*/
+
+namespace Graphics
+{
+    class ShaderCache final : public Core::EngineSystem
+    {
+        REFLECTION_ENABLE(ShaderCache, Core::EngineSystem)
+
+    public:
+        using ProgramKey = uint64_t;
+
+        struct Stats
+        {
+            std::size_t hits = 0;
+            std::size_t misses = 0;
+            std::size_t rejected = 0;
+            std::size_t stored = 0;
+            double loadSeconds = 0.0;
+            double savedSeconds = 0.0;
+        };
+
+    public:
+        ShaderCache();
+        ~ShaderCache() override;
+
+        ProgramKey CalculateKey(const std::vector<std::string_view>& sourceSegments) const;
+        bool LoadProgram(ProgramKey key, GLuint program);
+        void StoreProgram(ProgramKey key, GLuint program, double compileSeconds);
+        void LogStats() const;
+
+        fs::path GetProgramPath(ProgramKey key) const;
+
+        bool IsEnabled() const
+        {
+            return m_enabled;
+        }
+
+        const Stats& GetStats() const
+        {
+            return m_stats;
+        }
+
+    private:
+        bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
+
+        void RejectProgram(ProgramKey key, const char* reason);
+
+    private:
+        fs::path m_directory;
+        std::vector<GLint> m_binaryFormats;
+        uint64_t m_driverHash = 0;
+        bool m_enabled = false;
+        Stats m_stats;
+    };
+}
+
+REFLECTION_TYPE(Graphics::ShaderCache, Core::EngineSystem)
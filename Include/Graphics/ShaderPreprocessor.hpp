@@ -0,0 +1,161 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+namespace System
+{
+    class FileSystem;
+}
+
+/*
+    Shader Preprocessor
+
+    Prepares shader source code for compilation without any involvement of OpenGL. Files referenced
+    with #include "path" directives are inlined (relative to including file) and keywords declared
+    with #pragma keywords directive are collected for permutation expansion. Expanding source for
+    set of enabled keywords produces code for each shader stage found, with conditional blocks that
+    test keywords or stage defines using #ifdef, #ifndef or #if [!]defined(...) resolved in place.
+    Other conditions are left for GLSL compiler. Hash of expanded sources identifies variants with
+    identical code, so keywords that do not affect code can share single program.
+
+    Each file is inlined only once per stage, where it is first included after conditionals are
+    resolved, which makes include guards unnecessary. Inside blocks left for GLSL compiler files
+    are inlined again unless stage already includes them. Expanded code has #line directives that
+    refer to main file as source string 0 and to included files as their index plus one.
+
+    Example:
+        #version 300 es
+        #pragma keywords ALPHA_TEST VERTEX_COLOR
+        #include "Common.glsl"
+*/
+
+namespace Graphics
+{
+    class ShaderPreprocessor final : private Common::NonCopyable
+    {
+    public:
+        using KeywordMask = uint64_t;
+        using IncludeResult = Common::Result<std::string, void>;
+        using IncludeCallback = std::function<IncludeResult(const fs::path& path)>;
+
+        static constexpr std::size_t MaxKeywords = 64;
+        static constexpr std::size_t MaxPermutationKeywords = 16;
+
+        enum class Stage
+        {
+            Vertex,
+            Fragment,
+
+            Count,
+        };
+
+        static constexpr std::size_t StageCount = static_cast<std::size_t>(Stage::Count);
+
+        struct LoadFromString
+        {
+            IncludeCallback includeCallback;
+            fs::path sourcePath;
+            std::string shaderCode;
+        };
+
+        enum class CreateErrors
+        {
+            InvalidArgument,
+            InvalidDirective,
+            MissingInclude,
+            RecursiveInclude,
+            TooManyKeywords,
+        };
+
+        using CreateResult = Common::Result<std::unique_ptr<ShaderPreprocessor>, CreateErrors>;
+        static CreateResult Create(const LoadFromString& params);
+
+        static IncludeCallback CreateFileIncludeCallback(System::FileSystem* fileSystem);
+        static const char* GetStageDefine(Stage stage);
+
+    public:
+        struct ExpandedSource
+        {
+            std::string stages[StageCount];
+            uint64_t hash = 0;
+
+            const std::string& GetStage(Stage stage) const
+            {
+                return stages[static_cast<std::size_t>(stage)];
+            }
+        };
+
+        ExpandedSource Expand(KeywordMask keywords, const std::vector<std::string>& defines = {}) const;
+        KeywordMask GetKeywordMask(const std::vector<std::string>& keywords) const;
+        std::vector<KeywordMask> GetPermutations() const;
+
+        const std::vector<std::string>& GetKeywords() const
+        {
+            return m_keywords;
+        }
+
+        const std::vector<fs::path>& GetIncludedFiles() const
+        {
+            return m_includedFiles;
+        }
+
+        const std::string& GetVersion() const
+        {
+            return m_version;
+        }
+
+        const std::string& GetCode() const
+        {
+            return m_code;
+        }
+
+        KeywordMask GetAllKeywordsMask() const
+        {
+            return m_keywords.size() < MaxKeywords ?
+                (KeywordMask(1) << m_keywords.size()) - 1 : ~KeywordMask(0);
+        }
+
+    private:
+        ShaderPreprocessor();
+
+        using ProcessResult = Common::Result<void, CreateErrors>;
+
+        struct ProcessContext
+        {
+            IncludeCallback includeCallback;
+            std::vector<fs::path> includeStack;
+            std::vector<std::string> includeCode;
+            uint32_t codeLineCount = 0;
+        };
+
+        struct CodeSpan
+        {
+            uint32_t codeLine = 0;
+            uint32_t sourceString = 0;
+            uint32_t sourceLine = 0;
+        };
+
+        struct IncludeSpan
+        {
+            uint32_t fileIndex = 0;
+            uint32_t firstCodeLine = 0;
+            uint32_t endCodeLine = 0;
+        };
+
+        ProcessResult ProcessFile(std::string_view code, const fs::path& path,
+            uint32_t sourceString, ProcessContext& context);
+        std::string ResolveConditionals(KeywordMask keywords, Stage stage) const;
+        int FindKeyword(std::string_view keyword) const;
+
+    private:
+        std::string m_version;
+        std::string m_code;
+        std::vector<std::string> m_keywords;
+        std::vector<fs::path> m_includedFiles;
+        std::vector<CodeSpan> m_codeSpans;
+        std::vector<IncludeSpan> m_includeSpans;
+    };
+}
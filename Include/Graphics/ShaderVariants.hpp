@@ -0,0 +1,118 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include "Graphics/Shader.hpp"
+#include "Graphics/ShaderPreprocessor.hpp"
+
+namespace System
+{
+    class FileHandle;
+    class FileSystem;
+}
+
+/*
+    Shader Variants
+
+    Holds preprocessed shader source with its declared keywords and compiles shader program for
+    each requested combination of keywords lazily, on first use. Variants with identical expanded
+    source share same program. Set of variants known to be needed can be compiled ahead of time
+    with warm up, e.g. during loading, to avoid compilation stalls in the middle of frame.
+*/
+
+namespace Graphics
+{
+    class RenderContext;
+    class ShaderCache;
+
+    class ShaderVariants final : private Common::NonCopyable
+    {
+    public:
+        using KeywordMask = ShaderPreprocessor::KeywordMask;
+
+        struct LoadFromString
+        {
+            RenderContext* renderContext = nullptr;
+            ShaderCache* shaderCache = nullptr;
+            ShaderPreprocessor::IncludeCallback includeCallback;
+            std::vector<std::string> defines;
+            fs::path sourcePath;
+            std::string shaderCode;
+        };
+
+        struct LoadFromFile
+        {
+            RenderContext* renderContext = nullptr;
+            ShaderCache* shaderCache = nullptr;
+            System::FileSystem* fileSystem = nullptr;
+            std::vector<std::string> defines;
+        };
+
+        enum class CreateErrors
+        {
+            InvalidArgument,
+            InvalidFileContents,
+            FailedPreprocessing,
+        };
+
+        using CreateResult = Common::Result<std::unique_ptr<ShaderVariants>, CreateErrors>;
+        static CreateResult Create(const LoadFromString& params);
+        static CreateResult Create(System::FileHandle& file, const LoadFromFile& params);
+
+    public:
+        struct Stats
+        {
+            std::size_t requestedVariants = 0;
+            std::size_t compiledPrograms = 0;
+            std::size_t sharedPrograms = 0;
+            std::size_t failedPrograms = 0;
+        };
+
+    public:
+        ~ShaderVariants();
+
+        ShaderPtr GetVariant(KeywordMask keywords);
+        ShaderPtr GetVariant(const std::vector<std::string>& keywords);
+        std::size_t WarmUp(const std::vector<KeywordMask>& variants);
+        std::size_t WarmUpAll();
+
+        KeywordMask GetKeywordMask(const std::vector<std::string>& keywords) const
+        {
+            return m_preprocessor->GetKeywordMask(keywords);
+        }
+
+        const ShaderPreprocessor& GetPreprocessor() const
+        {
+            return *m_preprocessor;
+        }
+
+        const Stats& GetStats() const
+        {
+            return m_stats;
+        }
+
+    private:
+        struct Program
+        {
+            ShaderPreprocessor::ExpandedSource source;
+            ShaderPtr shader;
+        };
+
+        ShaderVariants();
+
+    private:
+        RenderContext* m_renderContext = nullptr;
+        ShaderCache* m_shaderCache = nullptr;
+        std::unique_ptr<ShaderPreprocessor> m_preprocessor;
+        std::vector<std::string> m_defines;
+
+        std::unordered_map<KeywordMask, ShaderPtr> m_variants;
+        std::unordered_multimap<uint64_t, Program> m_programs;
+        Stats m_stats;
+    };
+
+    using ShaderVariantsPtr = std::shared_ptr<ShaderVariants>;
+}
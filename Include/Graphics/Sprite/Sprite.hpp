@@ -11,6 +11,11 @@
     Structure that defines a textured quad. Consists of two parts - information that can be shared
     between different instances of sprites and data that is unique for each sprite. This is done to
     support efficient sprite sorting and rendering.
+
+    Sprite data can also be packed into compact instance layout that folds sprite rectangle into
+    2x3 affine transform and stores texture coordinates and color as normalized integers. Compact
+    layout only supports transforms on XY plane (with depth translation) and texture coordinates
+    within [0, 1] range, but uploads 40 instead of 112 bytes per sprite instance.
 */
 
 namespace Graphics
@@ -39,5 +44,17 @@ namespace Graphics
             glm::vec4 coords = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
             glm::vec4 color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
         } data;
+
+        struct CompactData
+        {
+            // Compact sprite data packed from full sprite data.
+            glm::vec4 basis = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+            glm::vec3 position = glm::vec3(0.0f);
+            glm::u16vec4 coords = glm::u16vec4(0, 0, 65535, 65535);
+            glm::u8vec4 color = glm::u8vec4(255, 255, 255, 255);
+        };
+
+        static CompactData PackData(const Data& data);
+        static Data UnpackData(const CompactData& compact);
     };
 }
@@ -15,6 +15,15 @@ namespace System
 
 /*
     Animation List
+
+    Animations are authored as Lua scripts and can be compiled into binary form (see Compile),
+    same as texture atlases they reference. Compiled files store animation name hashes in sorted
+    table with parallel animation array, and frames in single array that references atlas regions
+    by hash of their names. Index of animation is its position in sorted hash table, so indices
+    should be resolved once after all animations are added and then used for playback.
+
+    Each animation keeps table of cumulative frame end times, which is binary searched to find
+    frame at given time. Animations with frames of uniform duration compute frame index directly.
 */
 
 namespace Graphics
@@ -41,6 +50,8 @@ namespace Graphics
         static CreateResult Create();
         static CreateResult Create(System::FileHandle& file, const LoadFromFile& params);
 
+        static bool Compile(System::FileHandle& sourceFile, System::FileHandle& outputFile);
+
         struct Frame
         {
             Frame();
@@ -52,28 +63,47 @@ namespace Graphics
 
         struct Animation
         {
+            static constexpr uint32_t InvalidFrameIndex = std::numeric_limits<uint32_t>::max();
+
+            void AddFrame(TextureView textureView, float frameDuration);
+            uint32_t GetFrameIndexByTime(float animationTime) const;
             Frame GetFrameByTime(float animationTime) const;
 
             std::vector<Frame> frames;
+            std::vector<float> frameEndTimes;
+            float uniformFrameDuration = 0.0f;
             float duration = 0.0f;
         };
 
         using AnimationList = std::vector<Animation>;
-        using AnimationMap = std::unordered_map<std::string, std::uint32_t>;
+        using AnimationHashList = std::vector<uint64_t>;
 
         using AnimationIndexResult = Common::Result<uint32_t, void>;
 
+        struct CreateFromParams
+        {
+            std::vector<std::pair<std::string, Animation>> animations;
+        };
+
+        static CreateResult Create(const CreateFromParams& params);
+        static uint64_t GetAnimationHash(std::string_view animationName);
+
     public:
         ~SpriteAnimationList();
 
-        AnimationIndexResult GetAnimationIndex(std::string animationName) const;
+        AnimationIndexResult GetAnimationIndex(std::string_view animationName) const;
         const Animation* GetAnimationByIndex(std::size_t animationIndex) const;
 
+        std::size_t GetAnimationCount() const
+        {
+            return m_animationList.size();
+        }
+
     private:
         SpriteAnimationList();
 
     private:
         AnimationList m_animationList;
-        AnimationMap m_animationMap;
+        AnimationHashList m_animationHashes;
     };
 }
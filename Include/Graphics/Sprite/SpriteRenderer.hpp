@@ -9,7 +9,7 @@
 #include "Graphics/Buffer.hpp"
 #include "Graphics/VertexArray.hpp"
 #include "Graphics/Sampler.hpp"
-#include "Graphics/Shader.hpp"
+#include "Graphics/ShaderVariants.hpp"
 #include "Graphics/Sprite/Sprite.hpp"
 #include "Graphics/Sprite/SpriteDrawList.hpp"
 
@@ -21,6 +21,9 @@ namespace System
 
 /*
     Sprite Renderer
+
+    Draws sorted sprite lists in instanced batches. Instance data is uploaded either in full
+    layout or in compact layout selected with "render.spriteCompactInstances" config variable.
 */
 
 namespace Graphics
@@ -43,13 +46,18 @@ namespace Graphics
     private:
         RenderContext* m_renderContext = nullptr;
         std::size_t m_spriteBatchSize = 128;
+        bool m_compactInstances = false;
+        std::vector<Sprite::CompactData> m_compactData;
 
         std::unique_ptr<VertexBuffer> m_vertexBuffer;
         std::unique_ptr<InstanceBuffer> m_instanceBuffer;
         std::unique_ptr<VertexArray> m_vertexArray;
         std::unique_ptr<Sampler> m_nearestSampler;
         std::unique_ptr<Sampler> m_linearSampler;
+        std::shared_ptr<ShaderVariants> m_shaderVariants;
         std::shared_ptr<Shader> m_shader;
+        Shader::Uniform m_vertexTransformUniform;
+        Shader::Uniform m_textureDiffuseUniform;
     };
 }
 
@@ -0,0 +1,52 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <mutex>
+
+/*
+    Staging Buffer Pool
+
+    Recycles memory of buffers that pixel data is decoded into before it is uploaded to texture,
+    so streaming many images does not allocate and free large blocks for each of them. Acquired
+    buffer is empty with at least requested capacity, taken from smallest pooled buffer that is
+    large enough. Released buffers are kept until their total capacity would exceed pool size, in
+    which case buffer is freed instead. Pool can be accessed from multiple threads.
+*/
+
+namespace Graphics
+{
+    class StagingBufferPool final : private Common::NonCopyable
+    {
+    public:
+        using Buffer = std::vector<uint8_t>;
+
+        struct Stats
+        {
+            std::size_t acquiredBuffers = 0;
+            std::size_t reusedBuffers = 0;
+            std::size_t discardedBuffers = 0;
+            std::size_t pooledBuffers = 0;
+            std::size_t pooledBytes = 0;
+        };
+
+    public:
+        explicit StagingBufferPool(std::size_t maxPooledBytes);
+        ~StagingBufferPool();
+
+        Buffer Acquire(std::size_t size);
+        void Release(Buffer&& buffer);
+        void Clear();
+
+        Stats GetStats() const;
+
+    private:
+        mutable std::mutex m_mutex;
+        std::vector<Buffer> m_buffers;
+        std::size_t m_maxPooledBytes = 0;
+        Stats m_stats;
+    };
+}
@@ -11,17 +11,35 @@
 namespace System
 {
     class FileHandle;
+    enum class PixelFormat : uint32_t;
 }
 
 /*
     Texture
     
-    Encapsulates an OpenGL texture object which can be loaded from PNG file.
+    Encapsulates an OpenGL texture object which can be loaded from PNG file. Small textures can
+    also be packed into dynamic atlas page, which sprites are drawn from instead (see DynamicAtlas).
+    Packed texture has no OpenGL object of its own until its data is updated, which restores its
+    pixels from atlas copy and releases its region.
+    Large textures can be streamed, in which case texture is returned before its image is decoded
+    and shows low resolution placeholder until its upload completes (see TextureStreamer).
+
+    Block compressed textures are loaded from KTX2 files with all their mip levels (see KtxImage).
+    Levels are uploaded as they are when render context can sample from their format, otherwise
+    they are decoded on CPU and uploaded uncompressed. Compressed textures are never streamed or
+    packed into atlas, and their data cannot be updated.
+
+    Textures cooked by asset cooker are stored in same container with uncompressed pixel format,
+    under names of their source images. Their levels are uploaded straight from file data without
+    decoding, flipping or generating mipmaps.
 */
 
 namespace Graphics
 {
     class RenderContext;
+    class DynamicAtlas;
+    class AtlasRegion;
+    struct TextureStreamRequest;
 
     class Texture final : private Common::NonCopyable
     {
@@ -34,12 +52,15 @@ namespace Graphics
             int height = 0;
             bool mipmaps = true;
             const void* data = nullptr;
+            DynamicAtlas* dynamicAtlas = nullptr;
         };
 
         struct LoadFromFile
         {
             const Core::EngineSystemStorage* engineSystems = nullptr;
             bool mipmaps = true;
+            bool atlasPacking = true;
+            bool streaming = true;
         };
 
         enum class CreateErrors
@@ -54,9 +75,17 @@ namespace Graphics
         static CreateResult Create(const CreateFromParams& params);
         static CreateResult Create(System::FileHandle& file, const LoadFromFile& params);
 
+        static GLenum GetChannelFormat(int channels);
+        static int GetFormatChannels(GLenum format);
+        static GLenum GetCompressedFormat(System::PixelFormat format);
+
     public:
         ~Texture();
         void Update(const void* data);
+        void UpdateRegion(const void* data, int x, int y, int width, int height);
+        void UploadLevel(int level, const void* data);
+        void SetLevelRange(int baseLevel, int maxLevel);
+        void GenerateMipmaps();
 
         GLuint GetHandle() const
         {
@@ -73,15 +102,41 @@ namespace Graphics
             return m_height;
         }
 
+        GLenum GetFormat() const
+        {
+            return m_format;
+        }
+
+        bool IsCompressed() const
+        {
+            return m_compressed;
+        }
+
+        const AtlasRegion* GetAtlasRegion() const
+        {
+            return m_atlasRegion.get();
+        }
+
     private:
+        friend class TextureStreamer;
+
         Texture();
 
+        static CreateResult LoadKTX(System::FileHandle& file, const LoadFromFile& params);
+
+        bool CreateHandle(const void* data, bool mipmaps);
+        void Unpack(const void* data = nullptr);
+
     private:
         RenderContext* m_renderContext = nullptr;
         GLuint m_handle = OpenGL::InvalidHandle;
         GLenum m_format = OpenGL::InvalidEnum;
         int m_width = 0;
         int m_height = 0;
+        bool m_compressed = false;
+        DynamicAtlas* m_dynamicAtlas = nullptr;
+        std::shared_ptr<const AtlasRegion> m_atlasRegion;
+        std::shared_ptr<TextureStreamRequest> m_streamRequest;
     };
     
     using TexturePtr = std::shared_ptr<Texture>;
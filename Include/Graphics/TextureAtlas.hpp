@@ -16,6 +16,11 @@ namespace System
     Texture Atlas
 
     Stores multiple images that can be referenced by name in a single texture.
+
+    Atlases are authored as Lua scripts and can be compiled into binary form (see Compile), which
+    is loaded with a single read and without creating script state. Compiled files keep names of
+    their sources and are recognized by their header, so they can be placed in cooked directory.
+    Regions are stored in arrays sorted by hash of their names, which are not kept at runtime.
 */
 
 namespace Graphics
@@ -44,20 +49,32 @@ namespace Graphics
         static CreateResult Create();
         static CreateResult Create(System::FileHandle& file, const LoadFromFile& params);
 
+        static bool Compile(System::FileHandle& sourceFile, System::FileHandle& outputFile);
+
         using ConstTexturePtr = std::shared_ptr<const Texture>;
-        using RegionMap = std::unordered_map<std::string, glm::ivec4>;
+        using RegionHashList = std::vector<uint64_t>;
+        using RegionList = std::vector<glm::ivec4>;
+
+        static uint64_t GetRegionHash(std::string_view name);
 
     public:
         ~TextureAtlas();
 
-        bool AddRegion(std::string name, glm::ivec4 pixelCoords);
-        TextureView GetRegion(std::string name);
+        bool AddRegion(std::string_view name, glm::ivec4 pixelCoords);
+        TextureView GetRegion(std::string_view name) const;
+        TextureView GetRegionByHash(uint64_t hash) const;
+
+        std::size_t GetRegionCount() const
+        {
+            return m_regions.size();
+        }
 
     private:
         TextureAtlas();
 
     private:
         ConstTexturePtr m_texture;
-        RegionMap m_regions;
+        RegionHashList m_regionHashes;
+        RegionList m_regions;
     };
 };
@@ -0,0 +1,151 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+#include <Core/EngineSystem.hpp>
+#include "Graphics/Texture.hpp"
+#include "Graphics/StagingBufferPool.hpp"
+
+/*
+    Texture Streamer
+
+    Loads large textures without stalling thread that requested them. Texture is created right
+    away from image description in file header and samples low resolution placeholder mip level
+    until its image is available. Images are read and decoded by worker threads into staging
+    buffers from pool and queued for upload. Queued images are uploaded by ProcessUploads() on thread that owns
+    OpenGL context, which game renderer calls every frame before submitting frame packet.
+
+    Each frame uploads low resolution mip level of decoded image first, so texture quickly becomes
+    blurry rather than blank, followed by chunks of rows of full image with glTexSubImage2D() for
+    at most "render.textureUploadBudget" bytes and "render.textureUploadTime" milliseconds (at
+    least one chunk is always uploaded). Rows of each chunk add up to "render.textureUploadChunk"
+    bytes. Completed texture samples all of its mip levels, which are generated at that point.
+
+    Streaming is enabled with "render.textureStreaming" config variable and applies to images of
+    at least "render.textureStreamMinSize" bytes, smaller images are still loaded synchronously
+    so they can be packed into dynamic atlas. Images are decoded on calling thread when there are
+    no "render.textureStreamWorkers" (always on Emscripten).
+*/
+
+namespace System
+{
+    class FileSystem;
+}
+
+namespace Graphics
+{
+    class RenderContext;
+
+    struct TextureStreamRequest
+    {
+        // Cleared by texture when it is destroyed before request completes.
+        std::mutex mutex;
+        Texture* texture = nullptr;
+
+        // Description of image that is being streamed.
+        fs::path path;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        bool mipmaps = true;
+
+        // Mip level that placeholder is uploaded to.
+        int placeholderLevel = 0;
+
+        // Encoded file, which is read and decoded into staging buffer. Files that cannot
+        // be reopened from file system have their data read by requesting thread instead.
+        std::unique_ptr<System::FileHandle> file;
+        std::vector<uint8_t> fileData;
+        StagingBufferPool::Buffer pixels;
+        std::vector<uint8_t> placeholderPixels;
+        bool failed = false;
+
+        // Upload progress, which is only accessed by uploading thread.
+        bool placeholderUploaded = false;
+        int uploadedRows = 0;
+    };
+
+    class TextureStreamer final : public Core::EngineSystem
+    {
+        REFLECTION_ENABLE(TextureStreamer, Core::EngineSystem)
+
+    public:
+        struct Stats
+        {
+            std::size_t requestedTextures = 0;
+            std::size_t completedTextures = 0;
+            std::size_t failedTextures = 0;
+            std::size_t cancelledTextures = 0;
+            std::size_t pendingTextures = 0;
+            std::size_t uploadedChunks = 0;
+            std::size_t uploadedBytes = 0;
+            std::size_t lastFrameUploadedBytes = 0;
+            double lastFrameUploadTime = 0.0;
+            double decodeTime = 0.0;
+            StagingBufferPool::Stats stagingPool;
+        };
+
+        static bool IsSupported();
+
+    public:
+        TextureStreamer();
+        ~TextureStreamer() override;
+
+        Texture::CreateResult Stream(System::FileHandle& file, const Texture::LoadFromFile& params);
+        void ProcessUploads();
+        void Finish();
+
+        Stats GetStats() const;
+
+        bool IsEnabled() const
+        {
+            return m_enabled;
+        }
+
+        bool IsIdle() const;
+
+    private:
+        bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
+
+        using RequestPtr = std::shared_ptr<TextureStreamRequest>;
+
+        struct UploadBudget;
+
+        void WorkerMain();
+        void Decode(TextureStreamRequest& request);
+        void UploadQueue(UploadBudget& budget);
+        bool Upload(TextureStreamRequest& request, UploadBudget& budget);
+
+    private:
+        System::FileSystem* m_fileSystem = nullptr;
+        RenderContext* m_renderContext = nullptr;
+        std::unique_ptr<StagingBufferPool> m_stagingPool;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_workCondition;
+        std::condition_variable m_decodedCondition;
+        std::deque<RequestPtr> m_decodeQueue;
+        std::deque<RequestPtr> m_uploadQueue;
+        std::size_t m_decodingCount = 0;
+        std::vector<std::thread> m_workers;
+        bool m_stopping = false;
+        Stats m_stats;
+
+        bool m_enabled = false;
+        int m_workerCount = 2;
+        std::size_t m_minSize = 256 * 1024;
+        std::size_t m_uploadBudget = 4 * 1024 * 1024;
+        float m_uploadTime = 2.0f;
+        std::size_t m_uploadChunk = 256 * 1024;
+        std::size_t m_stagingPoolSize = 32 * 1024 * 1024;
+    };
+}
+
+REFLECTION_TYPE(Graphics::TextureStreamer, Core::EngineSystem)
@@ -9,6 +9,8 @@
     Texture View
 
     Utility object used to represent a rectangular area on image or texture.
+    Texture packed into dynamic atlas is drawn from its page instead, which view resolves
+    once and keeps until layout version of atlas changes (see DynamicAtlas).
 */
 
 namespace Graphics
@@ -37,11 +39,13 @@ namespace Graphics
         void SetTexture(ConstTexturePtr texture)
         {
             m_texture = texture;
+            m_atlasVersion = 0;
         }
 
         void SetTextureRect(const glm::vec4 normalRect)
         {
             m_textureRect = normalRect;
+            m_atlasVersion = 0;
         }
 
         void SetImageRect(const glm::ivec4 pixelRect);
@@ -63,8 +67,30 @@ namespace Graphics
 
         glm::ivec4 GetImageRect() const;
 
+        void ResolveAtlas(uint64_t atlasVersion) const;
+
+        const ConstTexturePtr& GetDrawTexture() const
+        {
+            return m_drawTexture;
+        }
+
+        const Texture* GetDrawTexturePtr() const
+        {
+            return m_drawTexture.get();
+        }
+
+        glm::vec4 GetDrawRect() const
+        {
+            return m_drawRect;
+        }
+
     private:
         ConstTexturePtr m_texture;
         glm::vec4 m_textureRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        // Resolved by layout version of dynamic atlas.
+        mutable ConstTexturePtr m_drawTexture;
+        mutable glm::vec4 m_drawRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+        mutable uint64_t m_atlasVersion = 0;
     };
 }
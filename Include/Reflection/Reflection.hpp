@@ -21,6 +21,7 @@
 #include "Reflection/ReflectionDeclare.hpp"
 #include "Reflection/ReflectionUtility.hpp"
 #include "Reflection/ReflectionTypes.hpp"
+#include "Reflection/ReflectionSerializer.hpp"
 
 namespace Reflection
 {
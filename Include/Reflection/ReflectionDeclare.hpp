@@ -32,13 +32,18 @@
         return GetTypeStorage().GetTypeInfo(); \
     }
 
+#define REFLECTION_TYPE_FRIEND \
+    template<typename> friend struct Reflection::Detail::TypeInfo;
+
 #define REFLECTION_ENABLE_BASE(ReflectedType) \
+    REFLECTION_TYPE_FRIEND \
     public: \
         REFLECTION_SUPER(Reflection::NullType) \
         REFLECTION_TYPE_STORAGE \
         REFLECTION_TYPE_INFO
     
 #define REFLECTION_ENABLE_DERIVED(ReflectedType, ReflectedBaseType) \
+    REFLECTION_TYPE_FRIEND \
     public: \
         REFLECTION_SUPER(ReflectedBaseType) \
         REFLECTION_TYPE_STORAGE \
@@ -121,6 +126,18 @@
     REFLECTION_TYPE_DEDUCE(__VA_ARGS__, REFLECTION_TYPE_DERIVED, REFLECTION_TYPE_BASE))
 #define REFLECTION_TYPE(...) REFLECTION_EXPAND(REFLECTION_TYPE_CHOOSER(__VA_ARGS__)(__VA_ARGS__))
 
+// Static type declaration macro for types that cannot be registered,
+// such as fundamental and math types used by reflected fields.
+#define REFLECTION_STATIC_TYPE(ReflectedType) \
+    REFLECTION_TYPE_INFO_BEGIN(ReflectedType, Reflection::NullType) \
+    REFLECTION_TYPE_INFO_END
+
+// Static type declaration macros for plain types with reflected fields, which are not
+// registered but can still be described at compile time, such as by serializer.
+#define REFLECTION_STATIC_TYPE_BEGIN(ReflectedType) \
+    REFLECTION_TYPE_INFO_BEGIN(ReflectedType, Reflection::NullType)
+#define REFLECTION_STATIC_TYPE_END REFLECTION_TYPE_INFO_END
+
 // Field declaration macros.
 #define REFLECTION_FIELD_BEGIN(Field) \
     template<typename ReflectedType, typename Dummy> \
@@ -190,7 +190,7 @@ namespace Reflection
 
 namespace Reflection
 {
-    using TypeIdentifier = uint32_t;
+    using TypeIdentifier = uint64_t;
     constexpr TypeIdentifier InvalidIdentifier = 0;
 
     struct NullType;
@@ -31,7 +31,19 @@ namespace Reflection
 
         using DynamicTypeList = std::vector<std::reference_wrapper<const DynamicTypeInfo>>;
         using ConstructFunction = void* (*)();
-        
+
+        struct MemberInfo
+        {
+            using AccessFunction = void* (*)(void* instance);
+
+            std::string_view name;
+            TypeIdentifier typeIdentifier = InvalidIdentifier;
+            AccessFunction accessFunction = nullptr;
+        };
+
+        using MemberList = std::vector<MemberInfo>;
+        using AncestorList = std::vector<const DynamicTypeInfo*>;
+
     public:
         DynamicTypeInfo() = default;
         ~DynamicTypeInfo() = default;
@@ -43,6 +55,22 @@ namespace Reflection
         bool IsBaseOf(TypeIdentifier identifier) const;
         bool IsDerivedFrom(TypeIdentifier identifier) const;
 
+        bool IsType(const DynamicTypeInfo& other) const
+        {
+            // Ancestors are indexed by their depth in hierarchy, so only one entry is compared.
+            return other.m_depth < m_ancestors.size() && m_ancestors[other.m_depth] == &other;
+        }
+
+        bool IsBaseOf(const DynamicTypeInfo& other) const
+        {
+            return other.IsDerivedFrom(*this);
+        }
+
+        bool IsDerivedFrom(const DynamicTypeInfo& other) const
+        {
+            return other.m_depth < m_depth && m_ancestors[other.m_depth] == &other;
+        }
+
         bool IsRegistered() const
         {
             return m_registered;
@@ -63,6 +91,12 @@ namespace Reflection
             return m_name;
         }
 
+        std::string_view GetTypeName() const
+        {
+            // Unlike name, type name string is available even with name registry disabled.
+            return m_typeName;
+        }
+
         TypeIdentifier GetIdentifier() const
         {
             return m_name.GetHash();
@@ -78,55 +112,105 @@ namespace Reflection
             return m_derivedTypes;
         }
 
+        const MemberList& GetMembers() const
+        {
+            return m_members;
+        }
+
+        const AncestorList& GetAncestors() const
+        {
+            return m_ancestors;
+        }
+
+        std::size_t GetDepth() const
+        {
+            return m_depth;
+        }
+
         template<typename OtherType>
         bool IsType() const
         {
-            return IsType(StaticType<OtherType>().Identifier);
+            return IsType(ResolveType<OtherType>());
         }
 
         template<typename OtherType>
         bool IsType(const OtherType& instance) const
         {
-            return IsType(instance.GetTypeInfo().GetIdentifier());
+            return IsType(instance.GetTypeInfo());
         }
 
         template<typename OtherType>
         bool IsBaseOf() const
         {
-            return IsBaseOf(StaticType<OtherType>().Identifier);
+            return IsBaseOf(ResolveType<OtherType>());
         }
 
         template<typename OtherType>
         bool IsBaseOf(const OtherType& instance) const
         {
-            return IsBaseOf(instance.GetTypeInfo().GetIdentifier());
+            return IsBaseOf(instance.GetTypeInfo());
         }
 
         template<typename OtherType>
         bool IsDerivedFrom() const
         {
-            return IsDerivedFrom(StaticType<OtherType>().Identifier);
+            return IsDerivedFrom(ResolveType<OtherType>());
         }
 
         template<typename OtherType>
         bool IsDerivedFrom(const OtherType& instance) const
         {
-            return IsDerivedFrom(instance.GetTypeInfo().GetIdentifier());
+            return IsDerivedFrom(instance.GetTypeInfo());
+        }
+
+        template<typename OtherType>
+        static const DynamicTypeInfo& ResolveType()
+        {
+            // Type info is taken from static storage of type to avoid registry lookup, unless
+            // type does not declare its own storage and would inherit one from its base type.
+            constexpr TypeIdentifier identifier = StaticType<OtherType>().Identifier;
+
+            if constexpr(HasTypeStorage<OtherType>::value)
+            {
+                const DynamicTypeInfo& typeInfo = OtherType::GetTypeStorage().GetTypeInfo();
+                if(typeInfo.m_registered && typeInfo.GetIdentifier() == identifier)
+                    return typeInfo;
+            }
+
+            return Detail::GetRegistry().LookupType(identifier);
         }
 
     private:
+        template<typename Type, typename = void>
+        struct HasTypeStorage : std::false_type
+        {
+        };
+
+        template<typename Type>
+        struct HasTypeStorage<Type, std::void_t<decltype(Type::GetTypeStorage())>> : std::true_type
+        {
+        };
+
         void Register(const Common::Name& name,
+            std::string_view typeName,
             ConstructFunction constructFunction,
-            DynamicTypeInfo* baseType);
+            DynamicTypeInfo* baseType,
+            MemberList&& members);
 
         void AddDerivedType(const DynamicTypeInfo& typeInfo);
 
     private:
         bool m_registered = false;
         Common::Name m_name = NAME_CONSTEXPR("<UnregisteredType>");
+        std::string_view m_typeName = "<UnregisteredType>";
         ConstructFunction m_constructFunction = nullptr;
         const DynamicTypeInfo* m_baseType = &Invalid;
         DynamicTypeList m_derivedTypes;
+        MemberList m_members;
+
+        // Base types from root of hierarchy down to this type, which is placed at its depth.
+        AncestorList m_ancestors;
+        std::size_t m_depth = 0;
     };
 
     class DynamicTypeStorage
@@ -29,6 +29,11 @@ namespace Reflection
 
         const DynamicTypeInfo& LookupType(TypeIdentifier identifier) const override;
 
+        const TypeInfoMap& GetTypes() const
+        {
+            return m_types;
+        }
+
     private:
         DynamicTypeInfo* FindTypeInfo(TypeIdentifier identifier);
 
@@ -108,7 +113,28 @@ namespace Reflection
             };
         }
 
-        dynamicType.Register(NAME_CONSTEXPR(StaticType.Name), constructFunction, baseType);
+        // Describe reflected fields, so they can be accessed without knowing type at compile time.
+        // Field types are identified only when they are reflected, including static only types.
+        DynamicTypeInfo::MemberList members;
+        members.reserve(StaticType.Members.Count);
+
+        ForEach(StaticType.Members, [&members](auto member)
+        {
+            using MemberType = decltype(member);
+            using FieldType = typename MemberType::Type;
+
+            DynamicTypeInfo::MemberInfo& memberInfo = members.emplace_back();
+            memberInfo.name = MemberType::Name;
+            memberInfo.typeIdentifier = Detail::TypeInfo<FieldType>::Reflected ?
+                StaticTypeInfo<FieldType>::Identifier : InvalidIdentifier;
+            memberInfo.accessFunction = [](void* instance) -> void*
+            {
+                return &(static_cast<Type*>(instance)->*MemberType::Pointer);
+            };
+        });
+
+        dynamicType.Register(NAME_CONSTEXPR(StaticType.Name), StaticType.Name,
+            constructFunction, baseType, std::move(members));
         LOG_TRACE("Registered type: \"{}\" ({})", StaticType.Name, dynamicType.GetIdentifier());
 
         return true;
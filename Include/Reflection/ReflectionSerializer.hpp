@@ -0,0 +1,585 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <Common/Result.hpp>
+#include <Common/NonCopyable.hpp>
+#include "Reflection/ReflectionDynamic.hpp"
+#include "Reflection/ReflectionTypes.hpp"
+
+/*
+    Reflection Serializer
+
+    Binary serialization of reflected types driven by their reflected members. Base type
+    members are written before members of derived type, while fields that are not reflected
+    are skipped. Strings and vectors are prefixed with their length.
+
+    Types that are trivially copyable and whose reflected members cover every byte of them
+    (which means no padding or unreflected fields) are copied with single memory copy, as are
+    arithmetic types and vectors or arrays of such types. Booleans are stored as single byte
+    that is validated when read, as not every byte value is valid representation of bool, so
+    types containing them are never memory copied. Values are stored in native byte order,
+    which is little endian on all supported platforms.
+
+    Types that are not reflected cannot be serialized, unless they declare themselves as packed
+    elements of single type by specializing SerializedElements, which is how math vectors,
+    matrices and quaternions are described (see Core.hpp). Such types are memory copied when
+    their elements are and when elements cover every byte of them.
+
+    Serialized objects are preceded by schema hash calculated at compile time from names and
+    types of serialized members, which detects data written by different version of type.
+    Reader deserializes directly into existing objects, reusing memory already allocated
+    by their strings and vectors, without making any intermediate copies.
+*/
+
+namespace Reflection
+{
+    template<typename Type>
+    struct SerializedElements
+    {
+        // Specializations define ElementType and Count of elements packed in type.
+    };
+
+    namespace Detail
+    {
+        using SizeType = uint32_t;
+
+        // Elements of zero serialized size cannot be bounded by remaining data.
+        constexpr std::size_t MaxEmptyElementCount = 65536;
+
+        template<typename Type>
+        struct IsVector : std::false_type
+        {
+        };
+
+        template<typename ElementType, typename AllocatorType>
+        struct IsVector<std::vector<ElementType, AllocatorType>> : std::true_type
+        {
+        };
+
+        template<typename Type>
+        struct IsArray : std::false_type
+        {
+        };
+
+        template<typename ElementType, std::size_t Size>
+        struct IsArray<std::array<ElementType, Size>> : std::true_type
+        {
+        };
+
+        template<typename Type, typename = void>
+        struct HasSerializedElements : std::false_type
+        {
+        };
+
+        template<typename Type>
+        struct HasSerializedElements<Type, std::void_t<typename SerializedElements<Type>::ElementType>>
+            : std::true_type
+        {
+        };
+
+        template<typename Type>
+        constexpr bool IsSerializedMembers()
+        {
+            return TypeInfo<Type>::Reflected && !std::is_arithmetic<Type>::value &&
+                !HasSerializedElements<Type>::value;
+        }
+
+        template<typename Type, std::size_t Index>
+        using MemberDescriptionAt = std::tuple_element_t<Index,
+            typename std::decay_t<decltype(StaticTypeInfo<Type>::Members)>::TupleType>;
+
+        template<typename Type>
+        constexpr bool IsMemoryCopyable();
+
+        template<typename Type>
+        constexpr std::size_t MinimumSerializedSize();
+
+        template<typename Type>
+        constexpr uint64_t CalculateSchemaHash();
+
+        template<typename Type, std::size_t... Indices>
+        constexpr bool AreMembersMemoryCopyable(std::index_sequence<Indices...>)
+        {
+            return (true && ... && IsMemoryCopyable<typename MemberDescriptionAt<Type, Indices>::Type>());
+        }
+
+        template<typename Type, std::size_t... Indices>
+        constexpr std::size_t SumMemberSizes(std::index_sequence<Indices...>)
+        {
+            return (std::size_t(0) + ... + sizeof(typename MemberDescriptionAt<Type, Indices>::Type));
+        }
+
+        template<typename Type, std::size_t... Indices>
+        constexpr std::size_t SumMinimumMemberSizes(std::index_sequence<Indices...>)
+        {
+            return (std::size_t(0) + ... +
+                MinimumSerializedSize<typename MemberDescriptionAt<Type, Indices>::Type>());
+        }
+
+        template<typename Type, std::size_t... Indices>
+        constexpr uint64_t CombineMemberSchemaHashes(uint64_t hash, std::index_sequence<Indices...>)
+        {
+            ((hash = Common::CombineHash(Common::CombineHash(hash,
+                Common::StringHash<uint64_t>(MemberDescriptionAt<Type, Indices>::Name)),
+                CalculateSchemaHash<typename MemberDescriptionAt<Type, Indices>::Type>())), ...);
+
+            return hash;
+        }
+
+        template<typename Type>
+        constexpr std::size_t ReflectedMemberSize()
+        {
+            using BaseType = typename StaticTypeInfo<Type>::BaseType;
+            constexpr auto MemberIndices = std::make_index_sequence<StaticTypeInfo<Type>::Members.Count>();
+
+            if constexpr(std::is_same<BaseType, NullType>::value)
+            {
+                return SumMemberSizes<Type>(MemberIndices);
+            }
+            else
+            {
+                return ReflectedMemberSize<BaseType>() + SumMemberSizes<Type>(MemberIndices);
+            }
+        }
+
+        template<typename Type>
+        constexpr bool AreReflectedMembersMemoryCopyable()
+        {
+            using BaseType = typename StaticTypeInfo<Type>::BaseType;
+            constexpr auto MemberIndices = std::make_index_sequence<StaticTypeInfo<Type>::Members.Count>();
+
+            if constexpr(std::is_same<BaseType, NullType>::value)
+            {
+                return AreMembersMemoryCopyable<Type>(MemberIndices);
+            }
+            else
+            {
+                return AreReflectedMembersMemoryCopyable<BaseType>() &&
+                    AreMembersMemoryCopyable<Type>(MemberIndices);
+            }
+        }
+
+        template<typename Type>
+        constexpr bool IsMemoryCopyable()
+        {
+            if constexpr(std::is_same<Type, bool>::value)
+            {
+                return false;
+            }
+            else if constexpr(std::is_arithmetic<Type>::value || std::is_enum<Type>::value)
+            {
+                return true;
+            }
+            else if constexpr(IsArray<Type>::value)
+            {
+                return IsMemoryCopyable<typename Type::value_type>();
+            }
+            else if constexpr(HasSerializedElements<Type>::value)
+            {
+                using Elements = SerializedElements<Type>;
+                return std::is_trivially_copyable<Type>::value &&
+                    sizeof(typename Elements::ElementType) * Elements::Count == sizeof(Type) &&
+                    IsMemoryCopyable<typename Elements::ElementType>();
+            }
+            else if constexpr(IsSerializedMembers<Type>())
+            {
+                // Padding and unreflected fields would be written along with reflected members.
+                return std::is_trivially_copyable<Type>::value &&
+                    ReflectedMemberSize<Type>() == sizeof(Type) &&
+                    AreReflectedMembersMemoryCopyable<Type>();
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        template<typename Type>
+        constexpr std::size_t MinimumSerializedSize()
+        {
+            if constexpr(IsMemoryCopyable<Type>())
+            {
+                return sizeof(Type);
+            }
+            else if constexpr(std::is_same<Type, bool>::value)
+            {
+                return sizeof(uint8_t);
+            }
+            else if constexpr(std::is_same<Type, std::string>::value || IsVector<Type>::value)
+            {
+                return sizeof(SizeType);
+            }
+            else if constexpr(IsArray<Type>::value)
+            {
+                return std::tuple_size<Type>::value * MinimumSerializedSize<typename Type::value_type>();
+            }
+            else if constexpr(HasSerializedElements<Type>::value)
+            {
+                using Elements = SerializedElements<Type>;
+                return Elements::Count * MinimumSerializedSize<typename Elements::ElementType>();
+            }
+            else
+            {
+                using BaseType = typename StaticTypeInfo<Type>::BaseType;
+                constexpr auto MemberIndices = std::make_index_sequence<StaticTypeInfo<Type>::Members.Count>();
+
+                if constexpr(std::is_same<BaseType, NullType>::value)
+                {
+                    return SumMinimumMemberSizes<Type>(MemberIndices);
+                }
+                else
+                {
+                    return MinimumSerializedSize<BaseType>() + SumMinimumMemberSizes<Type>(MemberIndices);
+                }
+            }
+        }
+
+        template<typename Type>
+        constexpr uint64_t CalculateSchemaHash()
+        {
+            if constexpr(std::is_enum<Type>::value)
+            {
+                return CalculateSchemaHash<std::underlying_type_t<Type>>();
+            }
+            else if constexpr(std::is_arithmetic<Type>::value)
+            {
+                uint64_t hash = Common::StringHash<uint64_t>(std::is_floating_point<Type>::value ?
+                    "float" : (std::is_signed<Type>::value ? "signed" : "unsigned"));
+                return Common::CombineHash<uint64_t>(hash, sizeof(Type));
+            }
+            else if constexpr(std::is_same<Type, std::string>::value)
+            {
+                return Common::StringHash<uint64_t>("string");
+            }
+            else if constexpr(IsVector<Type>::value)
+            {
+                return Common::CombineHash(Common::StringHash<uint64_t>("vector"),
+                    CalculateSchemaHash<typename Type::value_type>());
+            }
+            else if constexpr(IsArray<Type>::value)
+            {
+                uint64_t hash = Common::StringHash<uint64_t>("array");
+                hash = Common::CombineHash<uint64_t>(hash, std::tuple_size<Type>::value);
+                return Common::CombineHash(hash, CalculateSchemaHash<typename Type::value_type>());
+            }
+            else if constexpr(HasSerializedElements<Type>::value)
+            {
+                using Elements = SerializedElements<Type>;
+                uint64_t hash = Common::StringHash<uint64_t>("elements");
+                hash = Common::CombineHash<uint64_t>(hash, Elements::Count);
+                return Common::CombineHash(hash, CalculateSchemaHash<typename Elements::ElementType>());
+            }
+            else if constexpr(IsSerializedMembers<Type>())
+            {
+                using BaseType = typename StaticTypeInfo<Type>::BaseType;
+                constexpr auto MemberIndices = std::make_index_sequence<StaticTypeInfo<Type>::Members.Count>();
+
+                uint64_t hash = Common::StringHash<uint64_t>("members");
+                if constexpr(!std::is_same<BaseType, NullType>::value)
+                {
+                    hash = Common::CombineHash(hash, CalculateSchemaHash<BaseType>());
+                }
+
+                return CombineMemberSchemaHashes<Type>(hash, MemberIndices);
+            }
+            else
+            {
+                static_assert(IsSerializedMembers<Type>(), "Type is not serializable!");
+                return 0;
+            }
+        }
+    }
+
+    template<typename Type>
+    constexpr uint64_t SchemaHash()
+    {
+        return Detail::CalculateSchemaHash<std::decay_t<Type>>();
+    }
+
+    template<typename Type>
+    constexpr bool IsMemoryCopyable()
+    {
+        return Detail::IsMemoryCopyable<std::decay_t<Type>>();
+    }
+
+    class BinaryWriter final : private Common::NonCopyable
+    {
+    public:
+        BinaryWriter(std::vector<uint8_t>& buffer);
+        ~BinaryWriter();
+
+        void WriteBytes(const void* data, std::size_t size);
+        void WriteSize(std::size_t size);
+
+        template<typename Type>
+        void Serialize(const Type& object);
+
+        template<typename Type>
+        void WriteValue(const Type& value);
+
+        std::size_t GetSize() const
+        {
+            return m_buffer.size();
+        }
+
+    private:
+        template<typename Type>
+        void WriteMembers(const Type& object);
+
+    private:
+        std::vector<uint8_t>& m_buffer;
+    };
+
+    class BinaryReader final : private Common::NonCopyable
+    {
+    public:
+        enum class ReadErrors
+        {
+            SchemaMismatch,
+            UnexpectedEnd,
+        };
+
+        using ReadResult = Common::Result<void, ReadErrors>;
+
+        BinaryReader(const void* data, std::size_t size);
+        ~BinaryReader();
+
+        bool ReadBytes(void* data, std::size_t size);
+        bool ReadSize(std::size_t& size);
+
+        template<typename Type>
+        ReadResult Deserialize(Type& object);
+
+        template<typename Type>
+        bool ReadValue(Type& value);
+
+        std::size_t GetOffset() const
+        {
+            return m_offset;
+        }
+
+        std::size_t GetRemaining() const
+        {
+            return m_size - m_offset;
+        }
+
+    private:
+        template<typename Type>
+        bool ReadMembers(Type& object);
+
+    private:
+        const uint8_t* m_data = nullptr;
+        std::size_t m_size = 0;
+        std::size_t m_offset = 0;
+    };
+
+    template<typename Type>
+    void BinaryWriter::Serialize(const Type& object)
+    {
+        WriteValue(SchemaHash<Type>());
+        WriteValue(object);
+    }
+
+    template<typename Type>
+    void BinaryWriter::WriteValue(const Type& value)
+    {
+        if constexpr(Detail::IsMemoryCopyable<Type>())
+        {
+            WriteBytes(&value, sizeof(Type));
+        }
+        else if constexpr(std::is_same<Type, bool>::value)
+        {
+            const uint8_t byte = value ? 1 : 0;
+            WriteBytes(&byte, sizeof(byte));
+        }
+        else if constexpr(std::is_same<Type, std::string>::value)
+        {
+            WriteSize(value.size());
+            WriteBytes(value.data(), value.size());
+        }
+        else if constexpr(Detail::IsVector<Type>::value)
+        {
+            WriteSize(value.size());
+
+            if constexpr(Detail::IsMemoryCopyable<typename Type::value_type>())
+            {
+                WriteBytes(value.data(), value.size() * sizeof(typename Type::value_type));
+            }
+            else
+            {
+                for(const auto& element : value)
+                {
+                    WriteValue(element);
+                }
+            }
+        }
+        else if constexpr(Detail::IsArray<Type>::value)
+        {
+            for(const auto& element : value)
+            {
+                WriteValue(element);
+            }
+        }
+        else if constexpr(Detail::HasSerializedElements<Type>::value)
+        {
+            using ElementType = typename SerializedElements<Type>::ElementType;
+            const ElementType* elements = reinterpret_cast<const ElementType*>(&value);
+
+            for(std::size_t i = 0; i < SerializedElements<Type>::Count; ++i)
+            {
+                WriteValue(elements[i]);
+            }
+        }
+        else
+        {
+            static_assert(Detail::IsSerializedMembers<Type>(), "Type is not serializable!");
+            WriteMembers(value);
+        }
+    }
+
+    template<typename Type>
+    void BinaryWriter::WriteMembers(const Type& object)
+    {
+        using BaseType = typename StaticTypeInfo<Type>::BaseType;
+        if constexpr(!std::is_same<BaseType, NullType>::value)
+        {
+            WriteMembers(static_cast<const BaseType&>(object));
+        }
+
+        ForEach(StaticTypeInfo<Type>::Members, [this, &object](auto member)
+        {
+            using MemberType = decltype(member);
+            WriteValue(object.*MemberType::Pointer);
+        });
+    }
+
+    template<typename Type>
+    BinaryReader::ReadResult BinaryReader::Deserialize(Type& object)
+    {
+        uint64_t schemaHash = 0;
+        if(!ReadValue(schemaHash))
+            return Common::Failure(ReadErrors::UnexpectedEnd);
+
+        if(schemaHash != SchemaHash<Type>())
+            return Common::Failure(ReadErrors::SchemaMismatch);
+
+        if(!ReadValue(object))
+            return Common::Failure(ReadErrors::UnexpectedEnd);
+
+        return Common::Success();
+    }
+
+    template<typename Type>
+    bool BinaryReader::ReadValue(Type& value)
+    {
+        if constexpr(Detail::IsMemoryCopyable<Type>())
+        {
+            return ReadBytes(&value, sizeof(Type));
+        }
+        else if constexpr(std::is_same<Type, bool>::value)
+        {
+            // Bytes other than zero and one are not valid representation of bool.
+            uint8_t byte = 0;
+            if(!ReadBytes(&byte, sizeof(byte)) || byte > 1)
+                return false;
+
+            value = byte != 0;
+            return true;
+        }
+        else if constexpr(std::is_same<Type, std::string>::value)
+        {
+            std::size_t size = 0;
+            if(!ReadSize(size) || size > GetRemaining())
+                return false;
+
+            value.assign(reinterpret_cast<const char*>(m_data + m_offset), size);
+            m_offset += size;
+            return true;
+        }
+        else if constexpr(Detail::IsVector<Type>::value)
+        {
+            using ElementType = typename Type::value_type;
+            constexpr std::size_t ElementSize = Detail::MinimumSerializedSize<ElementType>();
+
+            // Validate size before resizing, so corrupted data cannot cause large allocation.
+            std::size_t size = 0;
+            if(!ReadSize(size))
+                return false;
+
+            if(ElementSize != 0 ? size > GetRemaining() / ElementSize : size > Detail::MaxEmptyElementCount)
+                return false;
+
+            value.resize(size);
+
+            if constexpr(Detail::IsMemoryCopyable<ElementType>())
+            {
+                return ReadBytes(value.data(), size * sizeof(ElementType));
+            }
+            else
+            {
+                for(auto& element : value)
+                {
+                    if(!ReadValue(element))
+                        return false;
+                }
+
+                return true;
+            }
+        }
+        else if constexpr(Detail::IsArray<Type>::value)
+        {
+            for(auto& element : value)
+            {
+                if(!ReadValue(element))
+                    return false;
+            }
+
+            return true;
+        }
+        else if constexpr(Detail::HasSerializedElements<Type>::value)
+        {
+            using ElementType = typename SerializedElements<Type>::ElementType;
+            ElementType* elements = reinterpret_cast<ElementType*>(&value);
+
+            for(std::size_t i = 0; i < SerializedElements<Type>::Count; ++i)
+            {
+                if(!ReadValue(elements[i]))
+                    return false;
+            }
+
+            return true;
+        }
+        else
+        {
+            static_assert(Detail::IsSerializedMembers<Type>(), "Type is not serializable!");
+            return ReadMembers(value);
+        }
+    }
+
+    template<typename Type>
+    bool BinaryReader::ReadMembers(Type& object)
+    {
+        using BaseType = typename StaticTypeInfo<Type>::BaseType;
+        if constexpr(!std::is_same<BaseType, NullType>::value)
+        {
+            if(!ReadMembers(static_cast<BaseType&>(object)))
+                return false;
+        }
+
+        bool success = true;
+        ForEach(StaticTypeInfo<Type>::Members, [this, &object, &success](auto member)
+        {
+            using MemberType = decltype(member);
+            success = success && ReadValue(object.*MemberType::Pointer);
+        });
+
+        return success;
+    }
+}
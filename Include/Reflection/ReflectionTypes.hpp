@@ -49,3 +49,9 @@ REFLECTION_TYPE(Reflection::NullType)
 REFLECTION_TYPE(Reflection::TypeAttribute)
 REFLECTION_TYPE(Reflection::FieldAttribute)
 REFLECTION_TYPE(Reflection::MethodAttribute)
+
+REFLECTION_STATIC_TYPE(bool)
+REFLECTION_STATIC_TYPE(int)
+REFLECTION_STATIC_TYPE(unsigned int)
+REFLECTION_STATIC_TYPE(float)
+REFLECTION_STATIC_TYPE(double)
@@ -133,7 +133,7 @@ namespace Reflection
     template<typename TargetType, typename SourceType>
     TargetType* Cast(SourceType* instance)
     {
-        if(instance && instance->GetTypeInfo().IsType(StaticType<TargetType>().Identifier))
+        if(instance && instance->GetTypeInfo().template IsType<TargetType>())
         {
             return reinterpret_cast<TargetType*>(instance);
         }
@@ -144,7 +144,7 @@ namespace Reflection
     template<typename TargetType, typename SourceType>
     std::unique_ptr<TargetType> Cast(std::unique_ptr<SourceType>& instance)
     {
-        if(instance && instance->GetTypeInfo().IsType(StaticType<TargetType>().Identifier))
+        if(instance && instance->GetTypeInfo().template IsType<TargetType>())
         {
             return std::unique_ptr<TargetType>(reinterpret_cast<TargetType*>(instance.release()));
         }
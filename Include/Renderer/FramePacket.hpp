@@ -0,0 +1,76 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <Graphics/Sprite/SpriteDrawList.hpp>
+
+namespace Graphics
+{
+    class Texture;
+}
+
+/*
+    Frame Packet
+
+    Snapshot of everything needed to draw game instance for single frame. Packet is extracted by
+    game thread and becomes immutable once published, so render thread can submit it while game
+    thread already simulates next frame. Textures referenced by sprites are kept alive by packet
+    until it has been submitted, even if their entities are destroyed in the meantime.
+
+    Packet also carries copy of interface draw data (e.g. editor), so interface can be drawn on
+    render thread after game instance. Each interface draw list references ranges of shared
+    vertex, index and command arrays, which keep their capacity between frames.
+*/
+
+namespace Renderer
+{
+    struct FramePacket final : private Common::NonCopyable
+    {
+        void Reset()
+        {
+            frameIndex = 0;
+            viewportRect = glm::ivec4(0);
+            cameraTransform = glm::mat4(1.0f);
+            clearMask = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT;
+            spriteDrawList.ClearSprites();
+            textureReferences.clear();
+            interfaceSize = glm::vec2(0.0f);
+            interfacePosition = glm::vec2(0.0f);
+            interfaceDrawLists.clear();
+            interfaceVertices.clear();
+            interfaceIndices.clear();
+            interfaceCommands.clear();
+        }
+
+        struct InterfaceDrawList
+        {
+            std::size_t vertexOffset = 0;
+            std::size_t vertexCount = 0;
+            std::size_t indexOffset = 0;
+            std::size_t indexCount = 0;
+            std::size_t commandOffset = 0;
+            std::size_t commandCount = 0;
+        };
+
+        // Render settings.
+        uint64_t frameIndex = 0;
+        glm::ivec4 viewportRect = glm::ivec4(0);
+        glm::mat4 cameraTransform = glm::mat4(1.0f);
+        GLbitfield clearMask = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT;
+
+        // Sorted sprite instances.
+        Graphics::SpriteDrawList spriteDrawList;
+        std::vector<std::shared_ptr<const Graphics::Texture>> textureReferences;
+
+        // Interface draw data.
+        glm::vec2 interfaceSize = glm::vec2(0.0f);
+        glm::vec2 interfacePosition = glm::vec2(0.0f);
+        std::vector<InterfaceDrawList> interfaceDrawLists;
+        std::vector<ImDrawVert> interfaceVertices;
+        std::vector<ImDrawIdx> interfaceIndices;
+        std::vector<ImDrawCmd> interfaceCommands;
+    };
+}
@@ -6,7 +6,14 @@
 #pragma once
 
 #include <Common/Event/EventReceiver.hpp>
+#include <Common/Event/EventDispatcher.hpp>
 #include <Core/EngineSystem.hpp>
+#include "Renderer/FramePacket.hpp"
+
+namespace Core
+{
+    class ConfigSystem;
+}
 
 namespace System
 {
@@ -17,6 +24,9 @@ namespace Graphics
 {
     class RenderContext;
     class SpriteRenderer;
+    class CommandRecorder;
+    class DynamicAtlas;
+    class TextureStreamer;
 }
 
 namespace Game
@@ -26,10 +36,20 @@ namespace Game
 
 /*
     Game Renderer
+
+    Draws game instance in two steps. Frame packet with camera and sprite instances is first
+    extracted from game instance on game thread and then submitted to OpenGL. Packets are passed
+    through render thread, which submits them on separate thread when enabled with
+    "render.threaded" config variable, with "render.frameLatency" frames of latency (one or two).
+    Render thread is not used on Emscripten. Packet of current frame stays open until end of frame,
+    so editor can add its interface to it, and is drawn with packetSubmitted event on render thread.
+    Resources created or destroyed on game thread take context back from render thread.
 */
 
 namespace Renderer
 {
+    class RenderThread;
+
     class GameRenderer final : public Core::EngineSystem
     {
         REFLECTION_ENABLE(GameRenderer, Core::EngineSystem)
@@ -48,10 +68,29 @@ namespace Renderer
         ~GameRenderer() override;
 
         void Draw(const DrawParams& drawParams);
+        void ExtractFramePacket(const DrawParams& drawParams, FramePacket& packet);
+        void SubmitFramePacket(const FramePacket& packet);
+        FramePacket& GetFramePacket();
+
+        RenderThread* GetRenderThread() const
+        {
+            return m_renderThread.get();
+        }
+
+    public:
+        struct Events
+        {
+            // Called on thread that submits frame packet after game instance has been drawn.
+            // This is good time to draw overlays such as interface from packet.
+            Event::Dispatcher<void(const FramePacket&)> packetSubmitted;
+        } events;
 
     private:
         bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
+        bool CreateRenderThread(Core::ConfigSystem* configSystem);
         void OnDrawGameInstance(Game::GameInstance* gameInstance, float timeAlpha);
+        void OnEndFrame() override;
+        void PublishFramePacket();
 
         struct Receivers
         {
@@ -62,6 +101,11 @@ namespace Renderer
         System::Window* m_window = nullptr;
         Graphics::RenderContext* m_renderContext = nullptr;
         Graphics::SpriteRenderer* m_spriteRenderer = nullptr;
+        Graphics::DynamicAtlas* m_dynamicAtlas = nullptr;
+        Graphics::TextureStreamer* m_textureStreamer = nullptr;
+        Graphics::CommandRecorder* m_commandRecorder = nullptr;
+        std::unique_ptr<RenderThread> m_renderThread;
+        FramePacket* m_framePacket = nullptr;
     };
 }
 
@@ -0,0 +1,130 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include "Renderer/FramePacket.hpp"
+
+/*
+    Render Thread
+
+    Pipelines frame packets between game thread that extracts them and render thread that submits
+    them, so simulation of one frame overlaps with submission of previous one. Packets are stored
+    in ring of frame latency plus one buffers, which results in double buffering for latency of one
+    frame and triple buffering for latency of two frames. Game thread waits for free buffer when it
+    gets too far ahead of render thread.
+
+    OpenGL context can be current on only one thread at a time. Context is owned by thread that
+    created render thread until the first packet is published, after which render thread takes it
+    over. Game thread can take context back (e.g. to create resources) by calling AcquireContext(),
+    which waits for all published packets to be submitted first. Context is then handed over again
+    with next published packet. It is also returned to destroying thread when render thread is
+    destroyed. Acquiring context on render thread itself does nothing, as it already owns it while
+    submitting (e.g. when last reference to texture is released by submitted packet).
+
+    When threading is disabled (always on Emscripten, where WebGL context belongs to main browser
+    thread), packets are submitted immediately after being published and context stays in place.
+*/
+
+namespace Renderer
+{
+    class RenderThread final : private Common::NonCopyable
+    {
+    public:
+        using SubmitCallback = std::function<void(const FramePacket&)>;
+        using ContextCallback = std::function<void()>;
+
+        static constexpr uint32_t MaxFrameLatency = 2;
+
+        struct CreateFromParams
+        {
+            SubmitCallback submitCallback;
+            ContextCallback acquireContext;
+            ContextCallback releaseContext;
+            uint32_t frameLatency = 1;
+            bool threaded = true;
+        };
+
+        enum class CreateErrors
+        {
+            InvalidArgument,
+        };
+
+        using CreateResult = Common::Result<std::unique_ptr<RenderThread>, CreateErrors>;
+        static CreateResult Create(const CreateFromParams& params);
+
+        static bool IsSupported();
+
+    public:
+        struct Stats
+        {
+            uint64_t publishedFrames = 0;
+            uint64_t submittedFrames = 0;
+            double gameWaitSeconds = 0.0;
+            double renderWaitSeconds = 0.0;
+            double submitSeconds = 0.0;
+        };
+
+    public:
+        ~RenderThread();
+
+        FramePacket& BeginPacket();
+        void EndPacket();
+        void Flush();
+
+        void AcquireContext();
+
+        Stats GetStats() const;
+
+        bool HasContext() const
+        {
+            return !IsThreaded() || m_callerOwnsContext;
+        }
+
+        bool IsThreaded() const
+        {
+            return m_thread.joinable();
+        }
+
+        uint32_t GetFrameLatency() const
+        {
+            return m_frameLatency;
+        }
+
+    private:
+        RenderThread();
+
+        void Run();
+        void Submit(FramePacket& packet);
+
+    private:
+        SubmitCallback m_submitCallback;
+        ContextCallback m_acquireContext;
+        ContextCallback m_releaseContext;
+        uint32_t m_frameLatency = 1;
+
+        // Ring of packets indexed by frame number.
+        std::vector<std::unique_ptr<FramePacket>> m_packets;
+
+        // State used only by game thread.
+        bool m_writingPacket = false;
+        bool m_callerOwnsContext = true;
+
+        // State shared with render thread and guarded by mutex.
+        mutable std::mutex m_mutex;
+        std::condition_variable m_gameCondition;
+        std::condition_variable m_renderCondition;
+        uint64_t m_publishedFrames = 0;
+        uint64_t m_submittedFrames = 0;
+        bool m_contextRequested = false;
+        bool m_renderOwnsContext = false;
+        bool m_stopping = false;
+        Stats m_stats;
+
+        std::thread m_thread;
+    };
+}
@@ -0,0 +1,108 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+/*
+    Script Allocator
+
+    Memory allocator for single Lua state that is passed as its lua_Alloc function. Small blocks are
+    served from free lists of fixed size classes, which are carved from pages that are only freed
+    when allocator is destroyed. Larger blocks, or all blocks when pooling is disabled, are passed
+    to system allocator. Allocations that would grow live memory over memory limit fail, which
+    raises memory error in Lua state. Shrinking allocations never fail on memory limit.
+
+    Lua also assumes that shrinking cannot fail at all. When block of smaller size class cannot
+    be allocated, pooled block is kept in place, as it is large enough for any smaller class it is
+    released into later, while block of system allocator becomes new page of that size class.
+*/
+
+namespace Script
+{
+    class ScriptAllocator final : private Common::NonCopyable
+    {
+    public:
+        static constexpr std::size_t PageSize = 64 * 1024;
+        static constexpr std::size_t MaxPooledSize = 256;
+
+        struct Stats
+        {
+            std::size_t bytesLive = 0;
+            std::size_t bytesPeak = 0;
+            std::size_t bytesReserved = 0;
+            std::size_t bytesAllocated = 0;
+            std::size_t allocations = 0;
+            std::size_t reallocations = 0;
+            std::size_t frees = 0;
+            std::size_t pooledAllocations = 0;
+            std::size_t failedAllocations = 0;
+        };
+
+        using PageAllocateFunction = void* (*)(std::size_t size);
+
+        static void* Allocate(void* userData, void* pointer, std::size_t oldSize, std::size_t newSize);
+
+    public:
+        ScriptAllocator(std::size_t memoryLimit, bool pooling);
+        ~ScriptAllocator();
+
+        void* Reallocate(void* pointer, std::size_t oldSize, std::size_t newSize);
+
+        void SetMemoryLimit(std::size_t memoryLimit)
+        {
+            m_memoryLimit = memoryLimit;
+        }
+
+        std::size_t GetMemoryLimit() const
+        {
+            return m_memoryLimit;
+        }
+
+        void SetPageAllocateFunction(PageAllocateFunction function)
+        {
+            m_pageAllocateFunction = function;
+        }
+
+        bool IsPooling() const
+        {
+            return m_pooling;
+        }
+
+        const Stats& GetStats() const
+        {
+            return m_stats;
+        }
+
+    private:
+        static constexpr std::size_t SizeClassCount = 12;
+        static constexpr std::size_t LargeSizeClass = SizeClassCount;
+
+        struct FreeBlock
+        {
+            FreeBlock* next = nullptr;
+        };
+
+        struct SizeClass
+        {
+            FreeBlock* freeList = nullptr;
+            uint8_t* pageCursor = nullptr;
+            uint8_t* pageEnd = nullptr;
+        };
+
+        std::size_t GetSizeClass(std::size_t size) const;
+        void* AllocateBlock(std::size_t sizeClass);
+        void ReleaseBlock(void* pointer, std::size_t sizeClass);
+        void AddPage(std::size_t sizeClass, void* page, std::size_t size);
+
+    private:
+        std::size_t m_memoryLimit = 0;
+        bool m_pooling = true;
+        PageAllocateFunction m_pageAllocateFunction = &std::malloc;
+
+        SizeClass m_sizeClasses[SizeClassCount];
+        std::vector<void*> m_pages;
+        Stats m_stats;
+    };
+}
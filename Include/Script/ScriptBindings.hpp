@@ -0,0 +1,103 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <lua.hpp>
+#include <Core/EngineSystem.hpp>
+
+/*
+    Script Bindings
+
+    Exposes fields of reflected types to scripts, using field descriptions that reflection records
+    when types declared with REFLECTION_FIELD() are registered. Accessors for fields of all
+    registered types are resolved once when engine starts and are indexed by integer. Script
+    states created with bindings (see ScriptState::CreateFromParams) get "Types" global table,
+    which maps type names to tables of their field indices, along with field access functions:
+
+        local Transform = Types["Game::TransformComponent"]
+        local x, y, z = GetField(transform, Transform.currentPosition)
+        SetField(transform, Transform.currentPosition, x + 1.0, y, z)
+
+    Objects are passed to scripts as small userdata handles pushed with PushObject(), which carry
+    index of object type along with pointer to object, so accessing field of object costs only an
+    array lookup instead of hashing field name. Fields of each type occupy contiguous range of
+    indices, and field index is checked against range of object type before field is accessed,
+    which turns use of another type's field index into script error. Handles can be pointed at
+    other object of same type with SetObject(), or cleared with null pointer when object they
+    refer to is about to be moved or destroyed, after which scripts can no longer access it.
+    Light userdata and handles of other libraries are rejected. Vector and quaternion
+    fields are read and written as multiple numbers (quaternion as x, y, z, w) to avoid allocating
+    tables. Fields of types other than bool, int, unsigned int, float, double and glm vectors
+    and quaternions are not bound.
+*/
+
+namespace Script
+{
+    class ScriptBindings final : public Core::EngineSystem
+    {
+        REFLECTION_ENABLE(ScriptBindings, Core::EngineSystem)
+
+    public:
+        using GetFunction = int (*)(lua_State* state, const void* field);
+        using SetFunction = void (*)(lua_State* state, int valueIndex, void* field);
+
+        struct FieldBinding
+        {
+            std::string_view name;
+            Reflection::DynamicTypeInfo::MemberInfo::AccessFunction accessFunction = nullptr;
+            GetFunction getFunction = nullptr;
+            SetFunction setFunction = nullptr;
+        };
+
+        struct TypeBinding
+        {
+            Reflection::TypeIdentifier identifier = Reflection::InvalidIdentifier;
+            std::string_view name;
+            std::size_t firstField = 0;
+            std::size_t fieldCount = 0;
+        };
+
+        using FieldList = std::vector<FieldBinding>;
+        using TypeList = std::vector<TypeBinding>;
+        using TypeLookup = std::unordered_map<Reflection::TypeIdentifier, uint32_t>;
+
+    public:
+        ScriptBindings();
+        ~ScriptBindings() override;
+
+        void BindTypes();
+        void Bind(lua_State* state) const;
+
+        bool PushObject(lua_State* state, Reflection::TypeIdentifier type, void* object) const;
+        static void SetObject(lua_State* state, int index, void* object);
+
+        template<typename Type>
+        bool PushObject(lua_State* state, Type* object) const
+        {
+            return PushObject(state, Reflection::GetIdentifier<Type>(), object);
+        }
+
+        const FieldList& GetFields() const
+        {
+            return m_fields;
+        }
+
+        const TypeList& GetTypes() const
+        {
+            return m_types;
+        }
+
+    private:
+        bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
+
+    private:
+        FieldList m_fields;
+        TypeList m_types;
+        TypeLookup m_typeLookup;
+    };
+}
+
+REFLECTION_TYPE(Script::ScriptBindings, Core::EngineSystem)
@@ -0,0 +1,80 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <lua.hpp>
+#include <Core/EngineSystem.hpp>
+
+/*
+    Script Cache
+
+    Stores precompiled Lua bytecode of executed scripts, so same scripts are not parsed and compiled
+    from source each time they are loaded. Chunks are keyed by hash of their source code, chunk name
+    and Lua version. Compiled chunks are kept in memory for lifetime of cache and also written to
+    disk when "script.cacheDirectory" config variable is set, to be loaded on next launch. Cache
+    files that do not match their key or fail to load are deleted and chunk is compiled again.
+    Cache can be accessed from multiple threads, although each Lua state must be used by one.
+*/
+
+namespace Script
+{
+    class ScriptCache final : public Core::EngineSystem
+    {
+        REFLECTION_ENABLE(ScriptCache, Core::EngineSystem)
+
+    public:
+        using ChunkKey = uint64_t;
+        using Bytecode = std::vector<char>;
+
+        struct Stats
+        {
+            std::size_t memoryHits = 0;
+            std::size_t diskHits = 0;
+            std::size_t misses = 0;
+            std::size_t rejected = 0;
+            std::size_t stored = 0;
+            double compileSeconds = 0.0;
+        };
+
+    public:
+        ScriptCache();
+        ~ScriptCache() override;
+
+        static ChunkKey CalculateKey(std::string_view source, std::string_view chunkName);
+
+        bool LoadChunk(lua_State* state, std::string_view source, const char* chunkName);
+        void Clear();
+        void LogStats() const;
+
+        fs::path GetChunkPath(ChunkKey key) const;
+
+        bool IsDiskEnabled() const
+        {
+            return !m_directory.empty();
+        }
+
+        Stats GetStats() const;
+
+    private:
+        bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
+
+        bool LoadBytecode(lua_State* state, ChunkKey key, const Bytecode& bytecode, const char* chunkName);
+        void StoreBytecode(ChunkKey key, Bytecode&& bytecode);
+        bool ReadChunkFile(ChunkKey key, Bytecode& bytecode);
+        void WriteChunkFile(ChunkKey key, const Bytecode& bytecode);
+        void RejectChunk(ChunkKey key, const char* reason);
+
+    private:
+        fs::path m_directory;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<ChunkKey, std::shared_ptr<const Bytecode>> m_chunks;
+        Stats m_stats;
+    };
+}
+
+REFLECTION_TYPE(Script::ScriptCache, Core::EngineSystem)
@@ -0,0 +1,121 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <Core/EngineSystem.hpp>
+
+/*
+    Script Garbage Collector
+
+    Schedules garbage collection of long lived script states at the end of each frame, so their
+    collection work is spread across frames instead of happening in unpredictable pauses. States
+    register with collector when created with it (see ScriptState::CreateFromParams) and stop
+    their automatic collection. Incremental steps are then run for each state until collection
+    keeps up with memory it allocated since previous frame, or until time budget set by
+    "script.gcBudget" config variable (in microseconds) runs out. Size of steps adapts to rate at
+    which each state allocates memory. At least one step is run for each state with pending work,
+    so collection always progresses even with budget being too small.
+
+    Generational collection is used instead when "script.gcMode" is set to "generational" and Lua
+    supports it, in which case states keep their automatic collection. Scheduler is disabled when
+    budget is zero. Collector and registered states must be used from main thread.
+*/
+
+namespace Script
+{
+    class ScriptState;
+
+    class ScriptGarbageCollector final : public Core::EngineSystem
+    {
+        REFLECTION_ENABLE(ScriptGarbageCollector, Core::EngineSystem)
+
+    public:
+        struct FrameStats
+        {
+            double microseconds = 0.0;
+            std::size_t steps = 0;
+            std::size_t completedCycles = 0;
+        };
+
+        struct Stats
+        {
+            std::size_t frames = 0;
+            std::size_t steps = 0;
+            std::size_t completedCycles = 0;
+            std::size_t framesOverBudget = 0;
+            double totalMicroseconds = 0.0;
+            double peakFrameMicroseconds = 0.0;
+        };
+
+    public:
+        ScriptGarbageCollector();
+        ~ScriptGarbageCollector() override;
+
+        void Register(ScriptState* scriptState);
+        void Unregister(ScriptState* scriptState);
+        void Collect();
+
+        void SetBudget(double microseconds)
+        {
+            m_budget = microseconds;
+        }
+
+        double GetBudget() const
+        {
+            return m_budget;
+        }
+
+        bool IsScheduling() const
+        {
+            return m_budget > 0.0 && !m_generational;
+        }
+
+        bool IsGenerational() const
+        {
+            return m_generational;
+        }
+
+        std::size_t GetStateCount() const
+        {
+            return m_states.size();
+        }
+
+        const FrameStats& GetFrameStats() const
+        {
+            return m_frameStats;
+        }
+
+        const Stats& GetStats() const
+        {
+            return m_stats;
+        }
+
+    private:
+        bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
+        void OnEndFrame() override;
+
+    private:
+        struct StateEntry
+        {
+            ScriptState* scriptState = nullptr;
+            std::size_t lastBytesAllocated = 0;
+            double allocationRate = 0.0;
+            double collectionDebt = 0.0;
+        };
+
+        std::vector<StateEntry> m_states;
+        std::size_t m_nextState = 0;
+
+        double m_budget = 1000.0;
+        double m_stepMultiplier = 2.0;
+        bool m_generational = false;
+
+        FrameStats m_frameStats;
+        Stats m_stats;
+    };
+}
+
+REFLECTION_TYPE(Script::ScriptGarbageCollector, Core::EngineSystem)
@@ -0,0 +1,133 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <lua.hpp>
+
+/*
+    Script Profiler
+
+    Sampling profiler for single Lua state, owned by script state and started at runtime (see
+    ScriptState::GetProfiler). By default, sampler thread wakes up once per sample period and
+    arms one shot count hook with lua_sethook, which Lua allows to be done asynchronously. Hook
+    captures call stack of running function as one sample and removes itself, so scripts run
+    without any hook between samples, which makes profiling cheap enough to be left enabled at
+    low sample rates. Hooks that stay installed make Lua check them for every instruction, which
+    alone slows scripts down considerably. When instruction interval is set instead, count hook
+    stays installed and samples deterministically after every interval of executed instructions.
+
+    Samples are aggregated per function (self and total samples) and per line, and whole call
+    stacks are counted for folded stack export that can be passed to flame graph tools:
+
+        main chunk (script:0);Update (script:4);Move (script:12) 42
+
+    Functions are identified by their source and line at which they are defined, and are named
+    after first call that sampled them, falling back to global that holds them.
+
+    Lua sets hooks for each thread separately, so profiler replaces resume and wrap functions of
+    coroutine library with ones that track coroutines (see TrackCoroutines), which script state
+    does when it opens the library. Sampler thread then arms hook of coroutine that is currently
+    running instead of main thread, and count hook is installed on every coroutine when it is
+    resumed. Hooks left on coroutines after profiler is stopped remove themselves when they are
+    next called. Coroutines resumed with lua_resume() from native code are not tracked. Profiler
+    and its state must be used from single thread.
+*/
+
+namespace Script
+{
+    class ScriptProfiler final : private Common::NonCopyable
+    {
+    public:
+        struct StartParams
+        {
+            double samplePeriod = 0.001;
+            int instructionInterval = 0;
+        };
+
+        struct FunctionStats
+        {
+            std::string name;
+            std::string source;
+            int lineDefined = 0;
+            std::size_t selfSamples = 0;
+            std::size_t totalSamples = 0;
+        };
+
+        struct LineStats
+        {
+            std::size_t function = 0;
+            int line = 0;
+            std::size_t samples = 0;
+        };
+
+        struct Report
+        {
+            std::size_t samples = 0;
+            std::vector<FunctionStats> functions;
+            std::vector<LineStats> lines;
+        };
+
+    public:
+        explicit ScriptProfiler(lua_State* state);
+        ~ScriptProfiler();
+
+        void TrackCoroutines();
+        int Resume(lua_State* state, lua_State* thread, int argumentCount);
+
+        void Start(const StartParams& params);
+        void Stop();
+        void Clear();
+
+        Report CreateReport() const;
+        std::string ExportFoldedStacks() const;
+
+        bool IsRunning() const
+        {
+            return m_running;
+        }
+
+        std::size_t GetSampleCount() const
+        {
+            return m_sampleCount;
+        }
+
+    private:
+        using FrameIndex = uint32_t;
+        using FrameStack = std::vector<FrameIndex>;
+        using FrameLookup = std::unordered_map<std::string, FrameIndex>;
+        using LineLookup = std::unordered_map<uint64_t, std::size_t>;
+        using StackLookup = std::map<FrameStack, std::size_t>;
+
+        static void Hook(lua_State* state, lua_Debug* debug);
+        void RunSampler(std::chrono::steady_clock::duration samplePeriod);
+        void Sample(lua_State* state);
+        FrameIndex ResolveFrame(lua_State* state, lua_Debug& debug);
+
+    private:
+        lua_State* m_state = nullptr;
+        bool m_running = false;
+        bool m_oneShotHook = false;
+        int m_instructionInterval = 0;
+
+        // State shared with sampler thread and guarded by mutex.
+        std::thread m_samplerThread;
+        std::mutex m_samplerMutex;
+        std::condition_variable m_samplerCondition;
+        lua_State* m_runningThread = nullptr;
+        bool m_samplerExit = false;
+
+        std::vector<FunctionStats> m_functions;
+        FrameLookup m_frameLookup;
+        LineLookup m_lines;
+        StackLookup m_stacks;
+
+        FrameStack m_stack;
+        std::string m_frameKey;
+        std::size_t m_sampleCount = 0;
+    };
+}
@@ -7,6 +7,8 @@
 
 #include <lua.hpp>
 #include <Core/EngineSystem.hpp>
+#include "Script/ScriptAllocator.hpp"
+#include "Script/ScriptProfiler.hpp"
 
 namespace System
 {
@@ -16,14 +18,39 @@ namespace System
 /*
     State
 
-    Holds and manages Lua scripting state.
+    Holds and manages Lua scripting state. Scripts are executed through script cache when one is
+    provided, which loads their precompiled bytecode instead of compiling source code. Global table
+    is captured after state is initialized, so state can be reset and reused for another script.
+
+    Each state allocates its memory through own allocator, which pools small blocks and accounts
+    for memory used by state. Memory limit can be set to fail allocations of scripts that use
+    too much memory (see ScriptAllocator). Long lived states should be created with garbage
+    collector, which schedules their collection within frame time budget. States created with
+    script bindings can access fields of reflected types (see ScriptBindings). Cost of scripts
+    executed in state can be measured by starting its sampling profiler (see ScriptProfiler).
+    Only base library is loaded by default, with coroutine library being loaded on request so
+    its coroutines can be tracked by profiler.
 */
 
 namespace Script
 {
+    class ScriptCache;
+    class ScriptGarbageCollector;
+    class ScriptBindings;
+
     class ScriptState final : private Common::NonCopyable
     {
     public:
+        struct CreateFromParams
+        {
+            ScriptCache* scriptCache = nullptr;
+            ScriptGarbageCollector* garbageCollector = nullptr;
+            const ScriptBindings* scriptBindings = nullptr;
+            std::size_t memoryLimit = 0;
+            bool pooledAllocator = true;
+            bool coroutineLibrary = false;
+        };
+
         struct LoadFromText
         {
             std::string scriptText;
@@ -46,23 +73,50 @@ namespace Script
         using CreateResult = Common::Result<std::unique_ptr<ScriptState>, CreateErrors>;
 
         static CreateResult Create();
+        static CreateResult Create(const CreateFromParams& params);
         static CreateResult Create(System::FileHandle& file, const LoadFromFile& params);
 
     public:
         ~ScriptState();
 
-        bool Execute(std::string script);
+        bool Execute(std::string_view script, const char* chunkName = "=script");
+        void Reset();
 
         void PrintError();
         void CleanStack();
         bool CollectGarbage(bool singleStep);
 
+        ScriptAllocator& GetAllocator()
+        {
+            return *m_allocator;
+        }
+
+        const ScriptAllocator& GetAllocator() const
+        {
+            return *m_allocator;
+        }
+
+        ScriptProfiler& GetProfiler()
+        {
+            return *m_profiler;
+        }
+
+        const ScriptProfiler& GetProfiler() const
+        {
+            return *m_profiler;
+        }
+
         operator lua_State*();
 
     private:
         ScriptState();
 
     private:
+        std::unique_ptr<ScriptAllocator> m_allocator;
+        std::unique_ptr<ScriptProfiler> m_profiler;
         lua_State* m_state = nullptr;
+        ScriptCache* m_scriptCache = nullptr;
+        ScriptGarbageCollector* m_garbageCollector = nullptr;
+        int m_pristineGlobals = LUA_NOREF;
     };
 }
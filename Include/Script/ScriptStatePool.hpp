@@ -0,0 +1,76 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <Core/EngineSystem.hpp>
+
+/*
+    Script State Pool
+
+    Hands out initialized Lua states for short lived scripts, such as resource definitions that are
+    executed once and then read. Acquired states are returned to pool when their pointer is
+    destroyed, where they are reset to their pristine state (see ScriptState::Reset) and kept
+    until pool size set by "script.statePoolSize" config variable is reached, in which case state
+    is closed instead. States created by pool execute scripts through script cache, and have their
+    memory limited by "script.stateMemoryLimit" config variable when it is set.
+*/
+
+namespace Script
+{
+    class ScriptState;
+    class ScriptCache;
+
+    class ScriptStatePool final : public Core::EngineSystem
+    {
+        REFLECTION_ENABLE(ScriptStatePool, Core::EngineSystem)
+
+    public:
+        struct StateDeleter
+        {
+            void operator()(ScriptState* state) const;
+
+            ScriptStatePool* pool = nullptr;
+        };
+
+        using StatePtr = std::unique_ptr<ScriptState, StateDeleter>;
+
+        struct Stats
+        {
+            std::size_t acquiredStates = 0;
+            std::size_t reusedStates = 0;
+            std::size_t discardedStates = 0;
+            std::size_t pooledStates = 0;
+        };
+
+        static StatePtr AcquireFrom(ScriptStatePool* pool);
+
+    public:
+        ScriptStatePool();
+        ~ScriptStatePool() override;
+
+        StatePtr Acquire();
+        void Clear();
+
+        Stats GetStats() const;
+
+    private:
+        bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
+
+        void Release(ScriptState* state);
+
+    private:
+        ScriptCache* m_scriptCache = nullptr;
+        std::size_t m_maxPooledStates = 8;
+        std::size_t m_stateMemoryLimit = 0;
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<ScriptState>> m_states;
+        Stats m_stats;
+    };
+}
+
+REFLECTION_TYPE(Script::ScriptStatePool, Core::EngineSystem)
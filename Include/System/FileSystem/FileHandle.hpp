@@ -62,13 +62,13 @@ namespace System
         template<typename Type>
         bool Read(Type& value)
         {
-            return Read(&value, sizeof(Type)) == sizeof(Type);
+            return Read(reinterpret_cast<uint8_t*>(&value), sizeof(Type)) == sizeof(Type);
         }
 
         template<typename Type>
         bool Write(const Type& value)
         {
-            return Write(&value, sizeof(Type)) == sizeof(Type);
+            return Write(reinterpret_cast<const uint8_t*>(&value), sizeof(Type)) == sizeof(Type);
         }
 
     protected:
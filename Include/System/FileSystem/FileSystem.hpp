@@ -47,6 +47,11 @@ namespace System
         FileDepot::OpenFileResult OpenFile(fs::path filePath,
             OpenFlags::Type openFlags = OpenFlags::Read);
 
+        bool IsCookedDirectoryMounted() const
+        {
+            return m_cookedDirectoryMounted;
+        }
+
     private:
         bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
 
@@ -60,6 +65,7 @@ namespace System
 
     private:
         MountedDepotList m_mountedDepots;
+        bool m_cookedDirectoryMounted = false;
     };
 }
 
@@ -5,6 +5,43 @@
 
 #pragma once
 
+#include "System/FileSystem/FileHandle.hpp"
+
 /*
     Memory File Handle
+
+    File handle over buffer that has already been read into memory. Allows contents of file to be
+    parsed away from file system (e.g. on worker thread) by code that expects file handle.
 */
+
+namespace System
+{
+    class MemoryFileHandle final : public FileHandle
+    {
+    public:
+        using Data = std::vector<uint8_t>;
+
+        static std::unique_ptr<MemoryFileHandle> Create(const fs::path& path,
+            Data data, OpenFlags::Type openFlags = OpenFlags::Read);
+
+    public:
+        ~MemoryFileHandle();
+
+        uint64_t Tell() override;
+        uint64_t Seek(uint64_t offset, SeekMode mode) override;
+        uint64_t Read(uint8_t* data, uint64_t bytes) override;
+        uint64_t Write(const uint8_t* data, uint64_t bytes) override;
+
+        bool IsGood() const override;
+        uint64_t GetSize() const override;
+
+        Data ReleaseData();
+
+    private:
+        MemoryFileHandle(const fs::path& path, OpenFlags::Type flags);
+
+    private:
+        Data m_data;
+        uint64_t m_position = 0;
+    };
+}
@@ -8,7 +8,8 @@
 /*
     Image
 
-    Loads image data from arbitrary formats.
+    Loads image data from arbitrary formats. Image description can be read from file header
+    without decoding pixels, which allows resources for image to be created before it is decoded.
 */
 
 namespace System
@@ -18,8 +19,20 @@ namespace System
     class Image final
     {
     public:
+        using Data = std::vector<uint8_t>;
+
         struct LoadFromFile
         {
+            // Optional buffer whose memory is reused for pixels instead of allocating.
+            // Buffer is given back to caller when image fails to load.
+            Data* storage = nullptr;
+        };
+
+        struct Info
+        {
+            int width = 0;
+            int height = 0;
+            int channels = 0;
         };
 
         enum class CreateErrors
@@ -33,11 +46,14 @@ namespace System
         using CreateResult = Common::Result<std::unique_ptr<Image>, CreateErrors>;
         static CreateResult Create(FileHandle& file, const LoadFromFile& params);
 
-        using Data = std::vector<uint8_t>;
+        using InfoResult = Common::Result<Info, CreateErrors>;
+        static InfoResult ReadInfo(FileHandle& file);
 
     public:
         ~Image();
 
+        Data ReleaseData();
+
         const uint8_t* GetData() const
         {
             return m_data.data();
@@ -62,6 +78,7 @@ namespace System
         Image();
 
         Common::FailureResult<CreateErrors> LoadPNG(FileHandle& file);
+        static InfoResult ReadInfoPNG(FileHandle& file);
 
     private:
         Data m_data;
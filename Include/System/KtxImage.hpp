@@ -0,0 +1,120 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include "System/PixelFormat.hpp"
+
+/*
+    KTX Image
+
+    Container for texture data in formats that can be uploaded to GPU without decoding, including
+    all mip levels of image. Files follow layout of KTX2 format with header, level index and
+    key/value data, followed by levels stored from smallest to largest. Data format descriptor is
+    not written and is ignored when present, as pixel format alone describes supported formats.
+    Supercompression, array layers, cube faces and volume images are not supported.
+
+    Whole file is read at once and levels are accessed in place. Level data must be stored with
+    rows from bottom to top, same as loaded images are, which is declared with "ru" value of
+    "KTXorientation" key. Files with other orientation are rejected, as compressed blocks would
+    have to be decoded to be flipped.
+
+    Files are also produced by asset cooker from source images, with uncompressed pixel formats
+    and names of their source files. Such files are recognized by their identifier instead of
+    extension (see IsKtxFile), allowing cooked directory to shadow source assets.
+*/
+
+namespace System
+{
+    class FileHandle;
+
+    class KtxImage final
+    {
+    public:
+        using Data = std::vector<uint8_t>;
+        using KeyValues = std::map<std::string, std::string>;
+
+        struct CreateFromParams
+        {
+            PixelFormat format = PixelFormat::Unknown;
+            int width = 0;
+            int height = 0;
+
+            // Data of each mip level, starting with full size image.
+            std::vector<Data> levels;
+            KeyValues keyValues;
+        };
+
+        enum class CreateErrors
+        {
+            InvalidArgument,
+            FailedFileRead,
+            InvalidHeader,
+            UnsupportedFormat,
+            UnsupportedFeature,
+            InvalidLevelData,
+        };
+
+        using CreateResult = Common::Result<std::unique_ptr<KtxImage>, CreateErrors>;
+        static CreateResult Create(const CreateFromParams& params);
+        static CreateResult Create(FileHandle& file);
+
+        static bool IsKtxFile(FileHandle& file);
+
+    public:
+        ~KtxImage();
+
+        bool Write(FileHandle& file) const;
+
+        const uint8_t* GetLevelData(int level) const;
+        std::size_t GetLevelSize(int level) const;
+        int GetLevelWidth(int level) const;
+        int GetLevelHeight(int level) const;
+        const std::string* FindValue(const std::string& key) const;
+
+        PixelFormat GetFormat() const
+        {
+            return m_format;
+        }
+
+        int GetWidth() const
+        {
+            return m_width;
+        }
+
+        int GetHeight() const
+        {
+            return m_height;
+        }
+
+        int GetLevelCount() const
+        {
+            return static_cast<int>(m_levels.size());
+        }
+
+        const KeyValues& GetKeyValues() const
+        {
+            return m_keyValues;
+        }
+
+    private:
+        KtxImage();
+
+        struct Level
+        {
+            std::size_t offset = 0;
+            std::size_t size = 0;
+        };
+
+    private:
+        Data m_data;
+        std::vector<Level> m_levels;
+        KeyValues m_keyValues;
+
+        PixelFormat m_format = PixelFormat::Unknown;
+        int m_width = 0;
+        int m_height = 0;
+    };
+}
@@ -0,0 +1,64 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+/*
+    Pixel Format
+
+    Formats of texture data stored in image containers, including block compressed formats that
+    can be uploaded to GPU as they are. Values match Vulkan format enumeration used by KTX2 files.
+    Block compressed formats store 4x4 blocks of pixels with fixed size, so they take between half
+    and one eighth of memory of uncompressed RGBA8 pixels. ETC2 and EAC formats are required by
+    OpenGL ES 3.0, while BC formats are available as extensions on most desktop GPUs.
+
+    Reference decoder converts block compressed data to 8-bit pixels with number of channels given
+    by format info, which is used when context cannot sample from format and for testing. Decoded
+    11-bit EAC channels are rounded to 8 bits. HDR formats (BC6H) are not supported.
+*/
+
+namespace System
+{
+    enum class PixelFormat : uint32_t
+    {
+        Unknown = 0,
+
+        // Uncompressed formats.
+        R8 = 9,
+        RG8 = 16,
+        RGB8 = 23,
+        RGBA8 = 37,
+
+        // BC formats (S3TC, RGTC and BPTC).
+        BC1 = 133,
+        BC2 = 135,
+        BC3 = 137,
+        BC4 = 139,
+        BC5 = 141,
+        BC7 = 145,
+
+        // ETC2 and EAC formats.
+        ETC2_RGB8 = 147,
+        ETC2_RGB8A1 = 149,
+        ETC2_RGBA8 = 151,
+        EAC_R11 = 153,
+        EAC_RG11 = 155,
+    };
+
+    struct PixelFormatInfo
+    {
+        const char* name = "Unknown";
+        int blockSize = 0;
+        int blockBytes = 0;
+        int channels = 0;
+        bool compressed = false;
+    };
+
+    const PixelFormatInfo& GetPixelFormatInfo(PixelFormat format);
+    PixelFormat FindPixelFormat(std::string_view name);
+
+    std::size_t CalculateLevelSize(PixelFormat format, int width, int height);
+    bool DecodePixels(PixelFormat format, const uint8_t* data, int width, int height, uint8_t* pixels);
+}
@@ -11,6 +11,8 @@
     Platform
 
     Main platform context that must be initialized first before other system classes can be used.
+    Platform can be headless when "engine.headless" config variable is set, in which case GLFW
+    library is not initialized and systems depending on it run without window and OpenGL context.
 */
 
 namespace System
@@ -23,11 +25,17 @@ namespace System
         Platform();
         ~Platform() override;
 
+        bool IsHeadless() const
+        {
+            return m_headless;
+        }
+
     private:
         bool OnAttach(const Core::EngineSystemStorage& engineSystems) override;
 
     private:
         bool m_attached = false;
+        bool m_headless = false;
     };
 }
 
@@ -9,7 +9,7 @@
 
 #ifndef __EMSCRIPTEN__
     // Use precise time counters on platforms that support it.
-    // Emscripten does not implement GLFW function for reading high frequency clock.
+    // Precise counters read monotonic clock that does not require GLFW to be initialized.
     #define USE_PRECISE_TIME_COUNTERS
 #endif
 
@@ -18,6 +18,9 @@
 
     Keeps track of time and provides utilities such as automatic
     calculation of delta time between ticks and frame rate measurement.
+    Timer can be driven by synthetic clock that advances by fixed step
+    specified with "timer.syntheticStep" config variable on every frame,
+    which makes frame times deterministic e.g. for headless simulation.
 */
 
 namespace System
@@ -43,10 +46,13 @@ namespace System
         void Advance(const Timer& timer);
         void Reset();
 
+        void SetSyntheticStep(double seconds);
+
         float GetDeltaSeconds() const;
         double GetElapsedSeconds() const;
         TimeUnit GetCurrentTimeUnits() const;
         TimeUnit GetPreviousTimeUnits() const;
+        bool IsSynthetic() const;
 
         static TimeUnit ConvertToUnits(double seconds);
         static double ConvertToSeconds(TimeUnit units);
@@ -62,6 +68,7 @@ namespace System
         TimeUnit m_currentTimeUnits;
         TimeUnit m_previousTimeUnits;
 
+        TimeUnit m_syntheticStepUnits = TimeUnit(0);
         float m_maxUpdateDelta = 1.0f;
     };
 }
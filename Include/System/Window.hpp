@@ -15,7 +15,11 @@ struct GLFWwindow;
     Window
 
     Creates and handles a multimedia window that also manages its own OpenGL context along with
-    input. Supports creation of multiple windows and OpenGL contexts.
+    input. Supports creation of multiple windows and OpenGL contexts. On headless platform window
+    acts as null window without OpenGL context that only tracks its size and close requests.
+
+    Window presents its frame at the end of each engine frame, unless presentation is taken over by
+    render thread that owns OpenGL context and presents frames as it finishes submitting them.
 */
 
 namespace System
@@ -55,6 +59,7 @@ namespace System
         ~Window() override;
 
         void MakeContextCurrent();
+        void ReleaseContext();
         void ProcessEvents();
         void Present();
         void Close();
@@ -62,6 +67,11 @@ namespace System
         void SetTitle(std::string title);
         void SetVisibility(bool show);
 
+        void SetPresentOnEndFrame(bool enabled)
+        {
+            m_presentOnEndFrame = enabled;
+        }
+
         WindowContext& GetContext()
         {
             return m_context;
@@ -85,6 +95,11 @@ namespace System
         bool ShouldClose() const;
         bool IsFocused() const;
 
+        bool IsHeadless() const
+        {
+            return m_headless;
+        }
+
     public:
         Event::Broker events;
 
@@ -103,7 +118,10 @@ namespace System
         WindowContext m_context;
 
         std::string m_title;
+        bool m_headless = false;
+        bool m_closeRequested = false;
         bool m_sizeChanged = false;
+        bool m_presentOnEndFrame = true;
         int m_width = 0;
         int m_height = 0;
     };
@@ -11,8 +11,10 @@ using namespace Common;
 NameRegistry::NameRegistry()
 {
 #ifdef NAME_REGISTRY_ENABLED
-    m_registry.emplace(Common::StringHash<HashType>(""), "");
+    m_abortOnCollision = true;
 #endif
+
+    Register(Common::StringHash<HashType>(""), "");
 }
 
 NameRegistry::~NameRegistry() = default;
@@ -23,44 +25,149 @@ NameRegistry& NameRegistry::GetInstance()
     return instance;
 }
 
-#ifdef NAME_REGISTRY_ENABLED
-
-void NameRegistry::Register(std::string_view string)
+NameRegistry::HashType NameRegistry::Register(std::string_view string)
 {
-    Name registrar(string);
+    const HashType hash = Common::StringHash<HashType>(string);
+    Register(hash, string);
+    return hash;
 }
 
-void NameRegistry::Register(const Name& name, std::string_view string)
+void NameRegistry::Register(HashType hash, std::string_view string)
 {
-    auto it = m_registry.find(name.GetHash());
-    if(it != m_registry.end())
+    Shard& shard = GetShard(hash);
+
+    // Most registrations are for names that already exist, which only need shared lock.
     {
-        ASSERT(it->second == string, "Detected name hash collision!");
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+        auto it = shard.entries.find(hash);
+        if(it != shard.entries.end())
+        {
+            if(it->second != string)
+            {
+                ReportCollision(it->second, string);
+            }
+
+            return;
+        }
     }
-    else
+
+    // Check again after acquiring exclusive lock, as other thread could register name in between.
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(hash);
+    if(it != shard.entries.end())
     {
-        auto result = m_registry.emplace(name.GetHash(), string);
-        ASSERT(result.second, "Name registry insertion failed!");
+        if(it->second != string)
+        {
+            lock.unlock();
+            ReportCollision(it->second, string);
+        }
+
+        return;
     }
+
+    auto result = shard.entries.emplace(hash, StoreString(shard, string));
+    ASSERT(result.second, "Name registry insertion failed!");
 }
 
-std::string_view NameRegistry::Lookup(HashType hash)
+void NameRegistry::ReportCollision(std::string_view registered, std::string_view string)
 {
-    auto it = m_registry.find(hash);
-    if(it == m_registry.end())
+    m_collisionCount.fetch_add(1, std::memory_order_relaxed);
+
+    if(m_abortOnCollision.load(std::memory_order_relaxed))
+    {
+        LOG_FATAL("Detected name hash collision between \"{}\" and \"{}\"!", registered, string);
+        std::abort();
+    }
+
+    LOG_ERROR("Detected name hash collision between \"{}\" and \"{}\"!", registered, string);
+}
+
+std::string_view NameRegistry::Lookup(HashType hash) const
+{
+    const Shard& shard = GetShard(hash);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(hash);
+    if(it == shard.entries.end())
         return {};
 
     return it->second;
 }
 
-bool NameRegistry::IsRegistered(std::string_view string)
+bool NameRegistry::IsRegistered(std::string_view string) const
 {
     return IsRegistered(Common::StringHash<HashType>(string));
 }
 
-bool NameRegistry::IsRegistered(HashType hash)
+bool NameRegistry::IsRegistered(HashType hash) const
+{
+    const Shard& shard = GetShard(hash);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.entries.find(hash) != shard.entries.end();
+}
+
+std::size_t NameRegistry::GetNameCount() const
+{
+    std::size_t count = 0;
+    for(const Shard& shard : m_shards)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        count += shard.entries.size();
+    }
+
+    return count;
+}
+
+std::size_t NameRegistry::GetArenaSize() const
+{
+    std::size_t size = 0;
+    for(const Shard& shard : m_shards)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        size += shard.arenaSize;
+    }
+
+    return size;
+}
+
+NameRegistry::Shard& NameRegistry::GetShard(HashType hash)
 {
-    return m_registry.find(hash) != m_registry.end();
+    // Mix upper bits in, as lower bits of hash are also used by buckets of shard map.
+    return m_shards[(hash ^ (hash >> 32)) % ShardCount];
 }
 
-#endif // NAME_REGISTRY_ENABLED
+const NameRegistry::Shard& NameRegistry::GetShard(HashType hash) const
+{
+    return m_shards[(hash ^ (hash >> 32)) % ShardCount];
+}
+
+std::string_view NameRegistry::StoreString(Shard& shard, std::string_view string)
+{
+    if(string.empty())
+        return {};
+
+    // Strings that do not fit into block get their own, leaving current block in use.
+    if(string.size() > ArenaBlockSize)
+    {
+        shard.blocks.push_back(std::make_unique<char[]>(string.size()));
+        shard.arenaSize += string.size();
+        std::memcpy(shard.blocks.back().get(), string.data(), string.size());
+        return std::string_view(shard.blocks.back().get(), string.size());
+    }
+
+    if(string.size() > shard.blockRemaining)
+    {
+        shard.blocks.push_back(std::make_unique<char[]>(ArenaBlockSize));
+        shard.blockCursor = shard.blocks.back().get();
+        shard.blockRemaining = ArenaBlockSize;
+        shard.arenaSize += ArenaBlockSize;
+    }
+
+    char* bytes = shard.blockCursor;
+    std::memcpy(bytes, string.data(), string.size());
+    shard.blockCursor += string.size();
+    shard.blockRemaining -= string.size();
+    return std::string_view(bytes, string.size());
+}
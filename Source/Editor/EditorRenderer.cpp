@@ -7,7 +7,10 @@
 #include "Editor/EditorRenderer.hpp"
 #include <Core/SystemStorage.hpp>
 #include <System/Window.hpp>
+#include <System/FileSystem/FileSystem.hpp>
 #include <System/ResourceManager.hpp>
+#include <Graphics/ShaderCache.hpp>
+#include <Renderer/GameRenderer.hpp>
 using namespace Editor;
 
 namespace
@@ -16,8 +19,19 @@ namespace
     const char* LogCreateResourcesFailed = "Failed to create editor renderer resources! {}";
 }
 
-EditorRenderer::EditorRenderer() = default;
-EditorRenderer::~EditorRenderer() = default;
+EditorRenderer::EditorRenderer()
+{
+    m_packetSubmittedReceiver.Bind<EditorRenderer, &EditorRenderer::OnPacketSubmitted>(this);
+}
+
+EditorRenderer::~EditorRenderer()
+{
+    // Wait for render thread to submit remaining packets before unsubscribing from them.
+    if(m_renderContext != nullptr)
+    {
+        m_renderContext->AcquireContext();
+    }
+}
 
 bool EditorRenderer::OnAttach(const EditorSubsystemStorage& editorSubsystems)
 {
@@ -43,6 +57,20 @@ bool EditorRenderer::OnAttach(const EditorSubsystemStorage& editorSubsystems)
         return false;
     }
 
+    m_gameRenderer = editorContext->GetEngineSystems().Locate<Renderer::GameRenderer>();
+    if(m_gameRenderer == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate game renderer.");
+        return false;
+    }
+
+    // Subscribe to packets submitted by game renderer.
+    if(!m_packetSubmittedReceiver.Subscribe(m_gameRenderer->events.packetSubmitted))
+    {
+        LOG_ERROR(LogAttachFailed, "Could not subscribe to game renderer events.");
+        return false;
+    }
+
     // Create graphics resources.
     if(!CreateResources(editorContext->GetEngineSystems()))
     {
@@ -169,6 +197,8 @@ bool EditorRenderer::CreateResources(const Core::EngineSystemStorage& engineSyst
     // Shader.
     Graphics::Shader::LoadFromFile shaderParams;
     shaderParams.renderContext = m_renderContext;
+    shaderParams.shaderCache = engineSystems.Locate<Graphics::ShaderCache>();
+    shaderParams.fileSystem = engineSystems.Locate<System::FileSystem>();
 
     m_shader = engineSystems.Locate<System::ResourceManager>()->Acquire<Graphics::Shader>(
         "Data/Engine/Shaders/Interface.shader", shaderParams).UnwrapOr(nullptr);
@@ -193,6 +223,43 @@ void EditorRenderer::OnEndInterface()
     if(drawData == nullptr)
         return;
 
+    // Copy draw data into frame packet, as ImGui reuses it for next frame.
+    Renderer::FramePacket& packet = m_gameRenderer->GetFramePacket();
+    packet.interfaceSize = glm::vec2(m_window->GetWidth(), m_window->GetHeight());
+    packet.interfacePosition = glm::vec2(drawData->DisplayPos.x, drawData->DisplayPos.y);
+
+    for(int list = 0; list < drawData->CmdListsCount; ++list)
+    {
+        const ImDrawList* commandList = drawData->CmdLists[list];
+
+        Renderer::FramePacket::InterfaceDrawList& drawList = packet.interfaceDrawLists.emplace_back();
+        drawList.vertexOffset = packet.interfaceVertices.size();
+        drawList.vertexCount = commandList->VtxBuffer.Size;
+        drawList.indexOffset = packet.interfaceIndices.size();
+        drawList.indexCount = commandList->IdxBuffer.Size;
+        drawList.commandOffset = packet.interfaceCommands.size();
+        drawList.commandCount = 0;
+
+        packet.interfaceVertices.insert(packet.interfaceVertices.end(),
+            commandList->VtxBuffer.begin(), commandList->VtxBuffer.end());
+        packet.interfaceIndices.insert(packet.interfaceIndices.end(),
+            commandList->IdxBuffer.begin(), commandList->IdxBuffer.end());
+
+        for(const ImDrawCmd& drawCommand : commandList->CmdBuffer)
+        {
+            ASSERT(drawCommand.UserCallback == nullptr, "Draw command callbacks are not supported!");
+
+            packet.interfaceCommands.push_back(drawCommand);
+            drawList.commandCount += 1;
+        }
+    }
+}
+
+void EditorRenderer::OnPacketSubmitted(const Renderer::FramePacket& packet)
+{
+    if(packet.interfaceDrawLists.empty())
+        return;
+
     // Draw vertices from draw data.
     auto& renderState = m_renderContext->PushState();
     SCOPE_GUARD([this]
@@ -200,8 +267,8 @@ void EditorRenderer::OnEndInterface()
         m_renderContext->PopState();
     });
 
-    int windowWidth = m_window->GetWidth();
-    int windowHeight = m_window->GetHeight();
+    int windowWidth = (int)packet.interfaceSize.x;
+    int windowHeight = (int)packet.interfaceSize.y;
     renderState.Viewport(0, 0, windowWidth, windowHeight);
 
     renderState.Enable(GL_BLEND);
@@ -211,52 +278,45 @@ void EditorRenderer::OnEndInterface()
     renderState.BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
     renderState.Enable(GL_SCISSOR_TEST);
 
-    m_shader->SetUniform("vertexTransform",
-        glm::ortho(0.0f, (float)windowWidth, (float)windowHeight, 0.0f));
-    m_shader->SetUniform("textureDiffuse", 0);
     renderState.UseProgram(m_shader->GetHandle());
+    Graphics::Shader::UniformBatch(*m_shader)
+        .Set(NAME_CONSTEXPR("vertexTransform"),
+            glm::ortho(0.0f, (float)windowWidth, (float)windowHeight, 0.0f))
+        .Set(NAME_CONSTEXPR("textureDiffuse"), 0);
 
     renderState.BindSampler(0, m_sampler->GetHandle());
 
-    ImVec2 position = drawData->DisplayPos;
-    for(int list = 0; list < drawData->CmdListsCount; ++list)
+    glm::vec2 position = packet.interfacePosition;
+    for(const Renderer::FramePacket::InterfaceDrawList& drawList : packet.interfaceDrawLists)
     {
-        const ImDrawList* commandList = drawData->CmdLists[list];
         const ImDrawIdx* indexBufferOffset = 0;
 
-        m_vertexBuffer->Update(commandList->VtxBuffer.Data, commandList->VtxBuffer.Size);
-        m_indexBuffer->Update(commandList->IdxBuffer.Data, commandList->IdxBuffer.Size);
+        m_vertexBuffer->Update(packet.interfaceVertices.data() + drawList.vertexOffset, drawList.vertexCount);
+        m_indexBuffer->Update(packet.interfaceIndices.data() + drawList.indexOffset, drawList.indexCount);
 
-        for(int command = 0; command < commandList->CmdBuffer.Size; ++command)
+        for(std::size_t command = 0; command < drawList.commandCount; ++command)
         {
-            const ImDrawCmd* drawCommand = &commandList->CmdBuffer[command];
-
-            if(drawCommand->UserCallback)
-            {
-                drawCommand->UserCallback(commandList, drawCommand);
-            }
-            else
-            {
-                ImVec4 clipRect;
-                clipRect.x = drawCommand->ClipRect.x - position.x;
-                clipRect.y = drawCommand->ClipRect.y - position.y;
-                clipRect.z = drawCommand->ClipRect.z - position.x;
-                clipRect.w = drawCommand->ClipRect.w - position.y;
-
-                glm::ivec4 scissorRect;
-                scissorRect.x = (int)clipRect.x;
-                scissorRect.y = (int)(windowHeight - clipRect.w);
-                scissorRect.z = (int)(clipRect.z - clipRect.x);
-                scissorRect.w = (int)(clipRect.w - clipRect.y);
-
-                renderState.Scissor(scissorRect.x, scissorRect.y, scissorRect.z, scissorRect.w);
-                renderState.ActiveTexture(GL_TEXTURE0);
-                renderState.BindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)drawCommand->TextureId);
-                renderState.BindVertexArray(m_vertexArray->GetHandle());
-                renderState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer->GetHandle());
-                renderState.DrawElements(GL_TRIANGLES,
-                    (GLsizei)drawCommand->ElemCount, GL_UNSIGNED_SHORT, indexBufferOffset);
-            }
+            const ImDrawCmd* drawCommand = &packet.interfaceCommands[drawList.commandOffset + command];
+
+            ImVec4 clipRect;
+            clipRect.x = drawCommand->ClipRect.x - position.x;
+            clipRect.y = drawCommand->ClipRect.y - position.y;
+            clipRect.z = drawCommand->ClipRect.z - position.x;
+            clipRect.w = drawCommand->ClipRect.w - position.y;
+
+            glm::ivec4 scissorRect;
+            scissorRect.x = (int)clipRect.x;
+            scissorRect.y = (int)(windowHeight - clipRect.w);
+            scissorRect.z = (int)(clipRect.z - clipRect.x);
+            scissorRect.w = (int)(clipRect.w - clipRect.y);
+
+            renderState.Scissor(scissorRect.x, scissorRect.y, scissorRect.z, scissorRect.w);
+            renderState.ActiveTexture(GL_TEXTURE0);
+            renderState.BindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)drawCommand->TextureId);
+            renderState.BindVertexArray(m_vertexArray->GetHandle());
+            renderState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer->GetHandle());
+            renderState.DrawElements(GL_TRIANGLES,
+                (GLsizei)drawCommand->ElemCount, GL_UNSIGNED_SHORT, indexBufferOffset);
 
             indexBufferOffset += drawCommand->ElemCount;
         }
@@ -15,10 +15,19 @@
 #include <System/ResourceManager.hpp>
 #include <System/InputManager.hpp>
 #include <System/Window.hpp>
+#include <Script/ScriptCache.hpp>
+#include <Script/ScriptStatePool.hpp>
+#include <Script/ScriptGarbageCollector.hpp>
+#include <Script/ScriptBindings.hpp>
 #include <Graphics/RenderContext.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/ShaderCache.hpp>
+#include <Graphics/DynamicAtlas.hpp>
+#include <Graphics/TextureStreamer.hpp>
 #include <Graphics/Texture.hpp>
 #include <Graphics/Sprite/SpriteRenderer.hpp>
 #include <Renderer/GameRenderer.hpp>
+#include <Renderer/RenderThread.hpp>
 #include <Game/GameFramework.hpp>
 #include <Editor/EditorSystem.hpp>
 using namespace Engine;
@@ -65,6 +74,16 @@ Root::CreateResult Root::Create(const ConfigVariables& configVars)
         return Common::Failure(failureResult.Unwrap());
     }
 
+    // Report how many shaders loaded during startup came from cache.
+    if(engine->HasRenderer())
+    {
+        auto* shaderCache = engine->m_engineSystems.Locate<Graphics::ShaderCache>();
+        if(shaderCache->IsEnabled())
+        {
+            shaderCache->LogStats();
+        }
+    }
+
     return Common::Success(std::move(engine));
 }
 
@@ -76,6 +95,9 @@ Common::Result<void, Root::CreateErrors> Root::CreateEngineSystems(const ConfigV
     if(auto config = std::make_unique<Core::ConfigSystem>())
     {
         config->Load(configVars);
+        m_headless = config->Get<bool>(NAME_CONSTEXPR("engine.headless")).UnwrapOr(false);
+        m_recordCommands = config->Get<bool>(NAME_CONSTEXPR("render.recordCommands")).UnwrapOr(false);
+
         m_engineSystems.Attach(std::move(config));
     }
     else
@@ -85,7 +107,7 @@ Common::Result<void, Root::CreateErrors> Root::CreateEngineSystems(const ConfigV
     }
 
     // Create remaining engine systems.
-    const std::vector<Reflection::TypeIdentifier> defaultEngineSystemTypes =
+    std::vector<Reflection::TypeIdentifier> defaultEngineSystemTypes =
     {
         Reflection::GetIdentifier<Core::EngineMetrics>(),
         Reflection::GetIdentifier<System::Platform>(),
@@ -94,13 +116,47 @@ Common::Result<void, Root::CreateErrors> Root::CreateEngineSystems(const ConfigV
         Reflection::GetIdentifier<System::Window>(),
         Reflection::GetIdentifier<System::InputManager>(),
         Reflection::GetIdentifier<System::ResourceManager>(),
+        Reflection::GetIdentifier<Script::ScriptCache>(),
+        Reflection::GetIdentifier<Script::ScriptStatePool>(),
+        Reflection::GetIdentifier<Script::ScriptGarbageCollector>(),
+        Reflection::GetIdentifier<Script::ScriptBindings>(),
         Reflection::GetIdentifier<Game::GameFramework>(),
-        Reflection::GetIdentifier<Graphics::RenderContext>(),
-        Reflection::GetIdentifier<Graphics::SpriteRenderer>(),
-        Reflection::GetIdentifier<Renderer::GameRenderer>(),
-        Reflection::GetIdentifier<Editor::EditorSystem>(),
     };
 
+    // Headless engine has no OpenGL context to render with.
+    // Game instances are still ticked but nothing draws them unless commands are recorded.
+    if(HasRenderer())
+    {
+        // Render context is created right after window, so it outlives resources and game states
+        // that acquire context from it when they are destroyed.
+        auto windowType = std::find(defaultEngineSystemTypes.begin(), defaultEngineSystemTypes.end(),
+            Reflection::GetIdentifier<System::Window>());
+        defaultEngineSystemTypes.insert(windowType + 1, Reflection::GetIdentifier<Graphics::RenderContext>());
+
+        defaultEngineSystemTypes.insert(defaultEngineSystemTypes.end(),
+        {
+            Reflection::GetIdentifier<Graphics::ShaderCache>(),
+            Reflection::GetIdentifier<Graphics::DynamicAtlas>(),
+            Reflection::GetIdentifier<Graphics::TextureStreamer>(),
+            Reflection::GetIdentifier<Graphics::SpriteRenderer>(),
+            Reflection::GetIdentifier<Renderer::GameRenderer>(),
+        });
+    }
+
+    if(!m_headless)
+    {
+        defaultEngineSystemTypes.push_back(Reflection::GetIdentifier<Editor::EditorSystem>());
+    }
+
+    // Recording backend replaces OpenGL entry points before any system uses them and is
+    // destroyed last, after all graphics resources have been released. This lets renderer
+    // run in headless mode and produce command stream without GPU.
+    if(m_recordCommands)
+    {
+        defaultEngineSystemTypes.insert(defaultEngineSystemTypes.begin(),
+            Reflection::GetIdentifier<Graphics::CommandRecorder>());
+    }
+
     if(!m_engineSystems.CreateFromTypes(defaultEngineSystemTypes))
     {
         LOG_ERROR(LogCreateSystemsFailed, "Could not populate system storage.");
@@ -120,6 +176,10 @@ Common::Result<void, Root::CreateErrors> Root::LoadDefaultResources()
 {
     LOG_PROFILE_SCOPE("Load default engine resources");
 
+    // Default resources are currently only needed by renderer.
+    if(!HasRenderer())
+        return Common::Success();
+
     // Locate systems needed to load resources.
     auto* fileSystem = m_engineSystems.Locate<System::FileSystem>();
     auto* resourceManager = m_engineSystems.Locate<System::ResourceManager>();
@@ -186,19 +246,30 @@ Root::ErrorCode Root::Run()
     /*
         Initiates main loop that exits only when application requests to be closed. Before main
         loop is run we have to set window context as current, then timer is reset on the first
-        iteration to exclude time accumulated during initialization.
+        iteration to exclude time accumulated during initialization. Main loop can also be limited
+        to number of frames specified with "engine.frameLimit" config variable, which is useful
+        for running headless simulations with synthetic timer.
     */
 
+    auto* config = m_engineSystems.Locate<Core::ConfigSystem>();
     auto* timer = m_engineSystems.Locate<System::Timer>();
     auto* window = m_engineSystems.Locate<System::Window>();
     auto* gameFramework = m_engineSystems.Locate<Game::GameFramework>();
 
+    const int frameLimit = config->Get<int>(NAME_CONSTEXPR("engine.frameLimit")).UnwrapOr(0);
+
     window->MakeContextCurrent();
     timer->Reset();
 
 #ifndef __EMSCRIPTEN__
-    while(true)
+    for(int frameCount = 0; ; ++frameCount)
     {
+        if(frameLimit > 0 && frameCount >= frameLimit)
+        {
+            LOG_INFO("Exiting main loop because frame limit has been reached.");
+            break;
+        }
+
         if(!window->ShouldClose())
         {
             LOG_INFO("Exiting main loop because window has been requested to close.");
@@ -213,6 +284,13 @@ Root::ErrorCode Root::Run()
 
         ProcessFrame();
     }
+
+    // Take context back from render thread after it submits remaining frames.
+    if(HasRenderer())
+    {
+        auto* gameRenderer = m_engineSystems.Locate<Renderer::GameRenderer>();
+        gameRenderer->GetRenderThread()->AcquireContext();
+    }
 #else
     auto mainLoopIteration = [](void* engine)
     {
@@ -0,0 +1,24 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Game/Precompiled.hpp"
+#include "Game/Components/ScriptComponent.hpp"
+#include "Game/Components/TransformComponent.hpp"
+#include "Game/ComponentSystem.hpp"
+using namespace Game;
+
+ScriptComponent::ScriptComponent() = default;
+ScriptComponent::~ScriptComponent() = default;
+
+bool ScriptComponent::OnInitialize(ComponentSystem* componentSystem, const EntityHandle& entitySelf)
+{
+    // Transform component is not cached, because its pool can be
+    // reallocated. Script system resolves it for each dispatch instead.
+    if(componentSystem->Lookup<TransformComponent>(entitySelf).IsFailure())
+        return false;
+
+    m_entity = entitySelf;
+    return true;
+}
@@ -71,7 +71,7 @@ void SpriteAnimationComponent::Tick(float timeDelta)
     }
 }
 
-void SpriteAnimationComponent::Play(std::string animationName, bool loop)
+void SpriteAnimationComponent::Play(std::string_view animationName, bool loop)
 {
     if(!m_spriteAnimationList)
     {
@@ -82,18 +82,7 @@ void SpriteAnimationComponent::Play(std::string animationName, bool loop)
 
     if(auto animationIndexResult = m_spriteAnimationList->GetAnimationIndex(animationName))
     {
-        uint32_t animationIndex = animationIndexResult.Unwrap();
-        m_currentSpriteAnimation = m_spriteAnimationList->GetAnimationByIndex(animationIndex);
-        ASSERT(m_currentSpriteAnimation, "Sprite animation retrieved via its index is null!");
-
-        m_playbackInfo = PlaybackFlags::Playing;
-        m_currentAnimationTime = 0.0f;
-        m_previousAnimationTime = 0.0f;
-
-        if(loop)
-        {
-            m_playbackInfo |= PlaybackFlags::Loop;
-        }
+        PlayByIndex(animationIndexResult.Unwrap(), loop);
     }
     else
     {
@@ -101,6 +90,32 @@ void SpriteAnimationComponent::Play(std::string animationName, bool loop)
     }
 }
 
+void SpriteAnimationComponent::PlayByIndex(uint32_t animationIndex, bool loop)
+{
+    if(!m_spriteAnimationList)
+    {
+        LOG_ERROR("Cannot play sprite animation without sprite animation list set!");
+        return;
+    }
+
+    m_currentSpriteAnimation = m_spriteAnimationList->GetAnimationByIndex(animationIndex);
+    if(m_currentSpriteAnimation == nullptr)
+    {
+        LOG_ERROR("Could not find sprite animation with {} index to play!", animationIndex);
+        return;
+    }
+
+    m_playbackInfo = PlaybackFlags::Playing;
+    m_currentFrameIndex = SpriteAnimation::InvalidFrameIndex;
+    m_currentAnimationTime = 0.0f;
+    m_previousAnimationTime = 0.0f;
+
+    if(loop)
+    {
+        m_playbackInfo |= PlaybackFlags::Loop;
+    }
+}
+
 void SpriteAnimationComponent::Pause()
 {
     m_playbackInfo &= ~PlaybackFlags::Playing;
@@ -117,6 +132,7 @@ void SpriteAnimationComponent::Resume()
 void SpriteAnimationComponent::Stop()
 {
     m_currentSpriteAnimation = nullptr;
+    m_currentFrameIndex = SpriteAnimation::InvalidFrameIndex;
     m_playbackInfo = PlaybackFlags::None;
     m_currentAnimationTime = 0.0f;
     m_previousAnimationTime = 0.0f;
@@ -10,6 +10,8 @@
 #include "Game/Systems/IdentitySystem.hpp"
 #include "Game/Systems/InterpolationSystem.hpp"
 #include "Game/Systems/SpriteSystem.hpp"
+#include "Game/Systems/SpatialGridSystem.hpp"
+#include "Game/Systems/ScriptSystem.hpp"
 using namespace Game;
 
 namespace
@@ -21,6 +23,11 @@ GameInstance::GameInstance() = default;
 GameInstance::~GameInstance() = default;
 
 GameInstance::CreateResult GameInstance::Create()
+{
+    return Create(CreateFromParams());
+}
+
+GameInstance::CreateResult GameInstance::Create(const CreateFromParams& params)
 {
     LOG_PROFILE_SCOPE("Create game instance");
 
@@ -35,6 +42,7 @@ GameInstance::CreateResult GameInstance::Create()
         Reflection::GetIdentifier<IdentitySystem>(),
         Reflection::GetIdentifier<InterpolationSystem>(),
         Reflection::GetIdentifier<SpriteSystem>(),
+        Reflection::GetIdentifier<SpatialGridSystem>(),
     };
 
     if(!instance->m_gameSystems.CreateFromTypes(defaultGameSystemTypes))
@@ -43,6 +51,13 @@ GameInstance::CreateResult GameInstance::Create()
         return Common::Failure(CreateErrors::FailedSystemCreation);
     }
 
+    // Script system is given engine systems before it attaches and creates its script state.
+    if(!instance->m_gameSystems.Attach(std::make_unique<ScriptSystem>(params.engineSystems)))
+    {
+        LOG_ERROR(LogCreateSystemsFailed, "Could not attach script system.");
+        return Common::Failure(CreateErrors::FailedSystemCreation);
+    }
+
     if(!instance->m_gameSystems.Finalize())
     {
         LOG_ERROR(LogCreateSystemsFailed, "Could not finalize system storage.");
@@ -0,0 +1,449 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Game/Precompiled.hpp"
+#include "Game/Systems/ScriptSystem.hpp"
+#include "Game/Components/ScriptComponent.hpp"
+#include "Game/Components/TransformComponent.hpp"
+#include "Game/ComponentSystem.hpp"
+#include "Game/EntitySystem.hpp"
+#include "Game/GameInstance.hpp"
+#include <Script/ScriptState.hpp>
+#include <Script/ScriptBindings.hpp>
+#include <Script/ScriptGarbageCollector.hpp>
+using namespace Game;
+
+namespace
+{
+    /*
+        Dispatcher enters behavior once per tick with whole batch of awake entities. Coroutines
+        of entities are kept in threads table indexed by entity identifier and are resumed from
+        script side, so switching between them does not involve native code. Finished coroutines
+        of behaviors with update function are marked with false, so they are not started again. Batch indices of
+        entities that should go to sleep are collected into sleepers table as pairs of index and
+        number of seconds, which are applied to script components once dispatch finishes.
+    */
+
+    const char* DispatcherScript = R"(
+        local Threads, Sleepers = {}, { count = 0 }
+        local create, resume, status = coroutine.create, coroutine.resume, coroutine.status
+        local huge, tostring = 1.0 / 0.0, tostring
+
+        function Sleep(index, seconds)
+            local count = Sleepers.count
+            Sleepers[count + 1] = index
+            Sleepers[count + 2] = seconds or huge
+            Sleepers.count = count + 2
+        end
+
+        local function Finish(entity, index, update)
+            if update then
+                Threads[entity] = false
+            else
+                Threads[entity] = nil
+                Sleep(index)
+            end
+        end
+
+        local function Dispatch(behavior, batch, timeDelta)
+            Sleepers.count = 0
+
+            local update = behavior.Update
+            if update then
+                update(batch, timeDelta)
+            end
+
+            local failures, failure = 0, nil
+            local run = behavior.Run
+            if run then
+                local entities, transforms = batch.entities, batch.transforms
+                for i = 1, batch.count do
+                    local entity = entities[i]
+                    local thread = Threads[entity]
+                    if thread == nil then
+                        thread = create(run)
+                        Threads[entity] = thread
+                    end
+
+                    if thread then
+                        local success, seconds = resume(thread, entity, transforms[i], timeDelta)
+                        if not success then
+                            failures, failure = failures + 1, failure or tostring(seconds)
+                            Finish(entity, i, update)
+                        elseif status(thread) == "dead" then
+                            Finish(entity, i, update)
+                        elseif seconds then
+                            Sleep(i, seconds)
+                        end
+                    end
+                end
+            end
+
+            return failures, failure
+        end
+
+        return Dispatch, Sleepers, Threads
+    )";
+}
+
+ScriptSystem::ScriptSystem(const Core::EngineSystemStorage* engineSystems) :
+    m_engineSystems(engineSystems)
+{
+    m_entityDestroyReceiver.Bind<ScriptSystem, &ScriptSystem::OnEntityDestroyed>(this);
+}
+
+ScriptSystem::~ScriptSystem() = default;
+
+bool ScriptSystem::OnAttach(const GameSystemStorage& gameSystems)
+{
+    ASSERT(m_entitySystem == nullptr);
+    ASSERT(m_componentSystem == nullptr);
+
+    // Retrieve needed game systems.
+    m_entitySystem = gameSystems.Locate<EntitySystem>();
+    if(m_entitySystem == nullptr)
+    {
+        LOG_ERROR("Could not retrieve entity system!");
+        return false;
+    }
+
+    m_componentSystem = gameSystems.Locate<ComponentSystem>();
+    if(m_componentSystem == nullptr)
+    {
+        LOG_ERROR("Could not retrieve component system!");
+        return false;
+    }
+
+    // Subscribe to entity destroy event so coroutines of destroyed entities can be released.
+    if(!m_entityDestroyReceiver.Subscribe(m_entitySystem->events.entityDestroy))
+    {
+        LOG_ERROR("Failed to subscribe to entity system!");
+        return false;
+    }
+
+    return true;
+}
+
+bool ScriptSystem::LoadBehavior(Common::Name name, std::string_view source)
+{
+    ASSERT(m_componentSystem, "Script system is not attached!");
+
+    if(m_behaviorLookup.find(name) != m_behaviorLookup.end())
+    {
+        LOG_WARNING("Script behavior \"{}\" is already loaded!", name.GetString());
+        return false;
+    }
+
+    // Script state is created with first loaded behavior, so game
+    // instances that do not use scripts never pay for Lua state.
+    if(m_scriptState == nullptr && !CreateScriptState())
+    {
+        LOG_ERROR("Could not create script state for behavior \"{}\"!", name.GetString());
+        return false;
+    }
+
+    // Load behavior chunk with its own environment that falls back to global table.
+    lua_State* state = *m_scriptState;
+    const std::string chunkName = "=" + name.GetString();
+
+    if(luaL_loadbufferx(state, source.data(), source.size(), chunkName.c_str(), "t") != LUA_OK)
+    {
+        m_scriptState->PrintError();
+        LOG_ERROR("Could not load script behavior \"{}\"!", name.GetString());
+        return false;
+    }
+
+    lua_newtable(state);
+    lua_createtable(state, 0, 1);
+    lua_pushglobaltable(state);
+    lua_setfield(state, -2, "__index");
+    lua_setmetatable(state, -2);
+
+    lua_pushvalue(state, -1);
+    lua_setupvalue(state, -3, 1);
+
+    lua_insert(state, -2);
+    if(lua_pcall(state, 0, 0, 0) != LUA_OK)
+    {
+        m_scriptState->PrintError();
+        lua_pop(state, 1);
+
+        LOG_ERROR("Could not execute script behavior \"{}\"!", name.GetString());
+        return false;
+    }
+
+    // Create batch table that is reused for every dispatch of behavior.
+    Behavior behavior;
+    behavior.name = name;
+    behavior.environmentReference = luaL_ref(state, LUA_REGISTRYINDEX);
+
+    lua_createtable(state, 0, 3);
+    lua_newtable(state);
+    lua_setfield(state, -2, "entities");
+    lua_newtable(state);
+    lua_setfield(state, -2, "transforms");
+    lua_pushinteger(state, 0);
+    lua_setfield(state, -2, "count");
+    behavior.batchReference = luaL_ref(state, LUA_REGISTRYINDEX);
+
+    m_behaviorLookup.emplace(name, static_cast<uint32_t>(m_behaviors.size()));
+    m_behaviors.push_back(std::move(behavior));
+    return true;
+}
+
+bool ScriptSystem::CreateScriptState()
+{
+    ASSERT(m_scriptState == nullptr);
+
+    // Use bindings and garbage collector of engine when available. Game instance can be
+    // created without access to engine systems, in which case reflected types are bound
+    // for script state of this system alone and Lua collects garbage on its own.
+    Script::ScriptState::CreateFromParams params;
+
+    if(m_engineSystems != nullptr)
+    {
+        m_scriptBindings = m_engineSystems->Locate<Script::ScriptBindings>();
+        params.garbageCollector = m_engineSystems->Locate<Script::ScriptGarbageCollector>();
+    }
+
+    if(m_scriptBindings == nullptr)
+    {
+        m_ownedScriptBindings = std::make_unique<Script::ScriptBindings>();
+        m_ownedScriptBindings->BindTypes();
+        m_scriptBindings = m_ownedScriptBindings.get();
+    }
+
+    params.scriptBindings = m_scriptBindings;
+    params.coroutineLibrary = true;
+
+    m_scriptState = Script::ScriptState::Create(params).UnwrapOr(nullptr);
+    if(m_scriptState == nullptr)
+    {
+        LOG_ERROR("Could not create script state!");
+        return false;
+    }
+
+    // Load dispatcher and keep references to values that it returns.
+    lua_State* state = *m_scriptState;
+    if(luaL_loadbufferx(state, DispatcherScript, std::strlen(DispatcherScript), "=dispatcher", "t") != LUA_OK
+        || lua_pcall(state, 0, 3, 0) != LUA_OK)
+    {
+        m_scriptState->PrintError();
+        m_scriptState = nullptr;
+
+        LOG_ERROR("Could not load script dispatcher!");
+        return false;
+    }
+
+    m_threadsReference = luaL_ref(state, LUA_REGISTRYINDEX);
+    m_sleepersReference = luaL_ref(state, LUA_REGISTRYINDEX);
+    m_dispatchReference = luaL_ref(state, LUA_REGISTRYINDEX);
+
+    // Create table of transform handles indexed by entity identifier.
+    lua_newtable(state);
+    m_handlesReference = luaL_ref(state, LUA_REGISTRYINDEX);
+    return true;
+}
+
+void ScriptSystem::Sleep(ScriptComponent& component, float seconds)
+{
+    component.m_wakeTime = m_time + seconds;
+}
+
+void ScriptSystem::OnTick(float timeDelta)
+{
+    m_time += timeDelta;
+    m_tickStats = TickStats();
+
+    for(Behavior& behavior : m_behaviors)
+    {
+        behavior.components.clear();
+        behavior.transforms.clear();
+    }
+
+    // Gather awake entities into batches of their behaviors. Transform components are
+    // looked up for each dispatch, as their pool can be reallocated between ticks.
+    auto& transformPool = m_componentSystem->GetPool<TransformComponent>();
+    for(auto& scriptComponent : m_componentSystem->GetPool<ScriptComponent>())
+    {
+        if(scriptComponent.IsSleeping(m_time))
+        {
+            ++m_tickStats.sleepingEntities;
+            continue;
+        }
+
+        if(!ResolveBehavior(scriptComponent))
+            continue;
+
+        auto* transformComponent = transformPool.LookupComponent(
+            scriptComponent.m_entity).UnwrapOr(nullptr);
+        if(transformComponent == nullptr)
+            continue;
+
+        Behavior& behavior = m_behaviors[scriptComponent.m_behaviorIndex];
+        behavior.components.push_back(&scriptComponent);
+        behavior.transforms.push_back(transformComponent);
+    }
+
+    // Enter each behavior once with its whole batch.
+    for(Behavior& behavior : m_behaviors)
+    {
+        if(behavior.components.empty())
+            continue;
+
+        if(!DispatchBehavior(behavior, timeDelta))
+        {
+            ++m_tickStats.failedDispatches;
+        }
+
+        ++m_tickStats.dispatchCalls;
+        m_tickStats.dispatchedEntities += behavior.components.size();
+    }
+}
+
+void ScriptSystem::OnEntityDestroyed(EntityHandle entity)
+{
+    if(m_scriptState == nullptr)
+        return;
+
+    lua_State* state = *m_scriptState;
+    lua_rawgeti(state, LUA_REGISTRYINDEX, m_threadsReference);
+    lua_pushnil(state);
+    lua_rawseti(state, -2, entity.GetIdentifier());
+    lua_pop(state, 1);
+
+    lua_rawgeti(state, LUA_REGISTRYINDEX, m_handlesReference);
+    lua_pushnil(state);
+    lua_rawseti(state, -2, entity.GetIdentifier());
+    lua_pop(state, 1);
+}
+
+bool ScriptSystem::ResolveBehavior(ScriptComponent& component)
+{
+    if(component.m_behaviorIndex != ScriptComponent::InvalidBehaviorIndex)
+        return true;
+
+    // Behaviors are never unloaded, so resolved index can be cached in component.
+    auto it = m_behaviorLookup.find(component.m_behavior);
+    if(it == m_behaviorLookup.end())
+        return false;
+
+    component.m_behaviorIndex = it->second;
+    return true;
+}
+
+bool ScriptSystem::DispatchBehavior(Behavior& behavior, float timeDelta)
+{
+    lua_State* state = *m_scriptState;
+    const int count = static_cast<int>(behavior.components.size());
+
+    // Fill packed arrays of batch, pointing handle of each entity at its transform.
+    lua_rawgeti(state, LUA_REGISTRYINDEX, m_dispatchReference);
+    lua_rawgeti(state, LUA_REGISTRYINDEX, behavior.environmentReference);
+    lua_rawgeti(state, LUA_REGISTRYINDEX, behavior.batchReference);
+
+    lua_getfield(state, -1, "entities");
+    lua_getfield(state, -2, "transforms");
+    lua_rawgeti(state, LUA_REGISTRYINDEX, m_handlesReference);
+
+    for(int i = 0; i < count; ++i)
+    {
+        const auto identifier = behavior.components[i]->m_entity.GetIdentifier();
+        lua_pushinteger(state, identifier);
+        lua_rawseti(state, -4, i + 1);
+
+        if(lua_rawgeti(state, -1, identifier) == LUA_TNIL)
+        {
+            lua_pop(state, 1);
+            m_scriptBindings->PushObject(state, behavior.transforms[i]);
+            lua_pushvalue(state, -1);
+            lua_rawseti(state, -3, identifier);
+        }
+        else
+        {
+            Script::ScriptBindings::SetObject(state, -1, behavior.transforms[i]);
+        }
+
+        lua_rawseti(state, -3, i + 1);
+    }
+
+    // Clear elements left from previous larger batch, so they cannot be used.
+    for(int i = count; i < behavior.batchSize; ++i)
+    {
+        lua_pushnil(state);
+        lua_rawseti(state, -4, i + 1);
+        lua_pushnil(state);
+        lua_rawseti(state, -3, i + 1);
+    }
+
+    behavior.batchSize = count;
+
+    lua_pop(state, 3);
+    lua_pushinteger(state, count);
+    lua_setfield(state, -2, "count");
+
+    lua_pushnumber(state, timeDelta);
+    const int result = lua_pcall(state, 3, 2, 0);
+    ClearHandles(behavior);
+
+    if(result != LUA_OK)
+    {
+        LOG_ERROR("Script behavior \"{}\" failed! {}", behavior.name.GetString(), lua_tostring(state, -1));
+        lua_pop(state, 1);
+        return false;
+    }
+
+    if(lua_tointeger(state, -2) != 0)
+    {
+        LOG_ERROR("Script behavior \"{}\" failed for {} entities! {}", behavior.name.GetString(),
+            lua_tointeger(state, -2), lua_tostring(state, -1));
+    }
+
+    lua_pop(state, 2);
+
+    // Put entities requested by script to sleep.
+    lua_rawgeti(state, LUA_REGISTRYINDEX, m_sleepersReference);
+    lua_getfield(state, -1, "count");
+    const int sleeperCount = static_cast<int>(lua_tointeger(state, -1));
+    lua_pop(state, 1);
+
+    for(int i = 1; i < sleeperCount; i += 2)
+    {
+        lua_rawgeti(state, -1, i);
+        lua_rawgeti(state, -2, i + 1);
+
+        const lua_Integer index = lua_tointeger(state, -2);
+        const lua_Number seconds = lua_tonumber(state, -1);
+        lua_pop(state, 2);
+
+        if(index >= 1 && index <= count)
+        {
+            behavior.components[index - 1]->m_wakeTime = m_time + seconds;
+        }
+    }
+
+    lua_pop(state, 1);
+    return true;
+}
+
+void ScriptSystem::ClearHandles(const Behavior& behavior)
+{
+    // Transform pool can reallocate before next dispatch, so handles
+    // stop referring to components once dispatch of batch finishes.
+    lua_State* state = *m_scriptState;
+    lua_rawgeti(state, LUA_REGISTRYINDEX, m_handlesReference);
+
+    for(const ScriptComponent* component : behavior.components)
+    {
+        if(lua_rawgeti(state, -1, component->m_entity.GetIdentifier()) != LUA_TNIL)
+        {
+            Script::ScriptBindings::SetObject(state, -1, nullptr);
+        }
+
+        lua_pop(state, 1);
+    }
+
+    lua_pop(state, 1);
+}
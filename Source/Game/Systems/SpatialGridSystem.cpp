@@ -0,0 +1,542 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Game/Precompiled.hpp"
+#include "Game/Systems/SpatialGridSystem.hpp"
+#include "Game/Components/TransformComponent.hpp"
+#include "Game/ComponentSystem.hpp"
+#include "Game/EntitySystem.hpp"
+#include "Game/GameInstance.hpp"
+using namespace Game;
+
+namespace
+{
+    bool IntersectBounds(const SpatialGridSystem::Bounds& bounds,
+        const glm::vec2& min, const glm::vec2& max)
+    {
+        return bounds.min.x <= max.x && bounds.max.x >= min.x
+            && bounds.min.y <= max.y && bounds.max.y >= min.y;
+    }
+
+    bool IntersectRay(const SpatialGridSystem::Bounds& bounds, const glm::vec2& origin,
+        const glm::vec2& inverseDirection, float maxDistance, float& distance)
+    {
+        // Slab test that also handles rays starting inside bounds.
+        float enter = 0.0f;
+        float exit = maxDistance;
+
+        for(int axis = 0; axis < 2; ++axis)
+        {
+            // Ray parallel to slab only intersects it when starting between its planes.
+            // Multiplying distance to plane by infinity would otherwise result in NaN on edges.
+            if(std::isinf(inverseDirection[axis]))
+            {
+                if(origin[axis] < bounds.min[axis] || origin[axis] > bounds.max[axis])
+                    return false;
+
+                continue;
+            }
+
+            const float t0 = (bounds.min[axis] - origin[axis]) * inverseDirection[axis];
+            const float t1 = (bounds.max[axis] - origin[axis]) * inverseDirection[axis];
+            enter = std::max(enter, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+        }
+
+        if(enter > exit)
+            return false;
+
+        distance = enter;
+        return true;
+    }
+}
+
+bool SpatialGridSystem::CellRange::operator==(const CellRange& other) const
+{
+    return min == other.min && max == other.max;
+}
+
+bool SpatialGridSystem::CellRange::operator!=(const CellRange& other) const
+{
+    return min != other.min || max != other.max;
+}
+
+SpatialGridSystem::SpatialGridSystem()
+{
+    m_entityDestroyReceiver.Bind<SpatialGridSystem, &SpatialGridSystem::OnEntityDestroyed>(this);
+}
+
+SpatialGridSystem::~SpatialGridSystem() = default;
+
+bool SpatialGridSystem::OnAttach(const GameSystemStorage& gameSystems)
+{
+    ASSERT(m_entitySystem == nullptr);
+    ASSERT(m_componentSystem == nullptr);
+
+    // Retrieve needed game systems.
+    m_entitySystem = gameSystems.Locate<EntitySystem>();
+    if(m_entitySystem == nullptr)
+    {
+        LOG_ERROR("Could not retrieve entity system!");
+        return false;
+    }
+
+    m_componentSystem = gameSystems.Locate<ComponentSystem>();
+    if(m_componentSystem == nullptr)
+    {
+        LOG_ERROR("Could not retrieve component system!");
+        return false;
+    }
+
+    // Subscribe to entity destroy event so we can remove entities from the grid right away.
+    if(!m_entityDestroyReceiver.Subscribe(m_entitySystem->events.entityDestroy))
+    {
+        LOG_ERROR("Failed to subscribe to entity system!");
+        return false;
+    }
+
+    return true;
+}
+
+void SpatialGridSystem::OnTick(float timeDelta)
+{
+    Update();
+}
+
+void SpatialGridSystem::OnEntityDestroyed(EntityHandle entity)
+{
+    auto it = m_proxyLookup.find(entity);
+    if(it != m_proxyLookup.end())
+    {
+        ReleaseProxy(it->second);
+    }
+}
+
+void SpatialGridSystem::SetCellSize(float cellSize)
+{
+    if(cellSize <= 0.0f)
+    {
+        LOG_WARNING("Attempted to set invalid spatial grid cell size!");
+        return;
+    }
+
+    if(cellSize == m_cellSize)
+        return;
+
+    m_cellSize = cellSize;
+    m_inverseCellSize = 1.0f / cellSize;
+
+    // Rebuild cells for all proxies using new cell size.
+    m_cells.clear();
+
+    for(ProxyIndex proxyIndex = 0; proxyIndex < m_proxies.size(); ++proxyIndex)
+    {
+        Proxy& proxy = m_proxies[proxyIndex];
+        if(!proxy.entity.IsValid())
+            continue;
+
+        proxy.cells = CalculateCellRange(proxy.bounds);
+        InsertProxy(proxyIndex);
+    }
+}
+
+void SpatialGridSystem::Update()
+{
+    /*
+        Synchronize grid with current transforms. Transforms are mirrored in slots indexed the same
+        as their component pool entries, so unmoved entities are skipped by comparing against
+        transform stored in their slot without looking them up. Proxies of moved entities are
+        rebucketed only when the range of cells they overlap changes, otherwise only their bounds
+        are refreshed. Proxies whose slots were not visited belong to entities that no longer
+        have transform component.
+    */
+
+    ++m_updateStamp;
+    m_lastUpdateRebucketCount = 0;
+
+    std::size_t transformCount = 0;
+
+    auto& transformPool = m_componentSystem->GetPool<TransformComponent>();
+    for(auto it = transformPool.Begin(); it != transformPool.End(); ++it)
+    {
+        const TransformComponent& transform = *it;
+        const EntityHandle entity = it.GetEntityHandle();
+        const std::size_t slotIndex = it.GetComponentIndex();
+
+        if(slotIndex >= m_transformSlots.size())
+        {
+            m_transformSlots.resize(slotIndex + 1);
+        }
+
+        TransformSlot& slot = m_transformSlots[slotIndex];
+        slot.updateStamp = m_updateStamp;
+        ++transformCount;
+
+        if(slot.entity == entity && slot.position == transform.GetPosition()
+            && slot.scale == transform.GetScale())
+        {
+            continue;
+        }
+
+        // Release proxy of previous entity if component entry has been reused.
+        if(slot.entity.IsValid() && slot.entity != entity)
+        {
+            ReleaseProxy(slot.proxyIndex);
+        }
+
+        slot.position = transform.GetPosition();
+        slot.scale = transform.GetScale();
+
+        // Calculate conservative bounds of rotated unit quad.
+        const glm::vec2 position(slot.position);
+        const glm::vec2 extent(0.5f * glm::length(glm::vec2(slot.scale)));
+
+        Bounds bounds;
+        bounds.min = position - extent;
+        bounds.max = position + extent;
+
+        if(slot.entity == entity)
+        {
+            MoveProxy(slot.proxyIndex, bounds);
+            continue;
+        }
+
+        // Find existing proxy of entity whose transform has been recreated or allocate new one.
+        slot.entity = entity;
+
+        auto [lookupIt, inserted] = m_proxyLookup.try_emplace(entity);
+        if(!inserted)
+        {
+            Proxy& proxy = m_proxies[lookupIt->second];
+            m_transformSlots[proxy.slotIndex].entity = EntityHandle();
+            slot.proxyIndex = lookupIt->second;
+            proxy.slotIndex = slotIndex;
+
+            MoveProxy(lookupIt->second, bounds);
+            continue;
+        }
+
+        if(m_freeProxies.empty())
+        {
+            lookupIt->second = Common::NumericalCast<ProxyIndex>(m_proxies.size());
+            m_proxies.emplace_back();
+        }
+        else
+        {
+            lookupIt->second = m_freeProxies.back();
+            m_freeProxies.pop_back();
+        }
+
+        slot.proxyIndex = lookupIt->second;
+
+        Proxy& proxy = m_proxies[lookupIt->second];
+        proxy.entity = entity;
+        proxy.bounds = bounds;
+        proxy.cells = CalculateCellRange(bounds);
+        proxy.slotIndex = slotIndex;
+        InsertProxy(lookupIt->second);
+
+        ++m_lastUpdateRebucketCount;
+    }
+
+    // Release proxies whose transforms have disappeared.
+    // Each visited transform has its own proxy, so there are none to release if counts match.
+    ASSERT(m_proxyLookup.size() == m_proxies.size() - m_freeProxies.size(),
+        "Proxy lookup is out of sync with proxy list!");
+
+    if(m_proxyLookup.size() == transformCount)
+        return;
+
+    for(ProxyIndex proxyIndex = 0; proxyIndex < m_proxies.size(); ++proxyIndex)
+    {
+        const Proxy& proxy = m_proxies[proxyIndex];
+        if(proxy.entity.IsValid() && m_transformSlots[proxy.slotIndex].updateStamp != m_updateStamp)
+        {
+            ReleaseProxy(proxyIndex);
+        }
+    }
+}
+
+template<typename Visitor>
+void SpatialGridSystem::VisitProxies(const Bounds& bounds, Visitor&& visitor)
+{
+    /*
+        Calls visitor once for each proxy in cells overlapped by bounds. Proxies spanning
+        multiple cells are deduplicated using query stamps instead of a set of visited proxies.
+    */
+
+    const uint32_t queryStamp = NextQueryStamp();
+
+    auto VisitCell = [this, &visitor, queryStamp](const CellEntries& entries)
+    {
+        for(ProxyIndex proxyIndex : entries)
+        {
+            Proxy& proxy = m_proxies[proxyIndex];
+            if(proxy.queryStamp == queryStamp)
+                continue;
+
+            proxy.queryStamp = queryStamp;
+            visitor(static_cast<const Proxy&>(proxy));
+        }
+    };
+
+    const CellRange range = CalculateCellRange(bounds);
+    const uint64_t rangeCellCount =
+        uint64_t(range.max.x - range.min.x + 1) * uint64_t(range.max.y - range.min.y + 1);
+
+    if(rangeCellCount <= m_cells.size())
+    {
+        // Visit only cells overlapped by bounds.
+        for(int y = range.min.y; y <= range.max.y; ++y)
+        {
+            for(int x = range.min.x; x <= range.max.x; ++x)
+            {
+                auto it = m_cells.find(CalculateCellKey(x, y));
+                if(it != m_cells.end())
+                {
+                    VisitCell(it->second);
+                }
+            }
+        }
+    }
+    else
+    {
+        // Bounds cover more cells than there are occupied, visit occupied cells instead.
+        for(const auto& cell : m_cells)
+        {
+            VisitCell(cell.second);
+        }
+    }
+}
+
+std::size_t SpatialGridSystem::QueryAabb(
+    const glm::vec2& min, const glm::vec2& max, EntityList& results)
+{
+    ASSERT(min.x <= max.x && min.y <= max.y, "Invalid query bounds!");
+
+    const std::size_t initialCount = results.size();
+
+    Bounds queryBounds;
+    queryBounds.min = min;
+    queryBounds.max = max;
+
+    VisitProxies(queryBounds, [&results, &min, &max](const Proxy& proxy)
+    {
+        if(IntersectBounds(proxy.bounds, min, max))
+        {
+            results.push_back(proxy.entity);
+        }
+    });
+
+    return results.size() - initialCount;
+}
+
+std::size_t SpatialGridSystem::QueryRadius(
+    const glm::vec2& center, float radius, EntityList& results)
+{
+    ASSERT(radius >= 0.0f, "Invalid query radius!");
+
+    const std::size_t initialCount = results.size();
+    const float radiusSquared = radius * radius;
+
+    // Visit cells overlapped by bounding box of the circle and test distance to bounds.
+    Bounds queryBounds;
+    queryBounds.min = center - glm::vec2(radius);
+    queryBounds.max = center + glm::vec2(radius);
+
+    VisitProxies(queryBounds, [&results, &center, radiusSquared](const Proxy& proxy)
+    {
+        const glm::vec2 closest = glm::clamp(center, proxy.bounds.min, proxy.bounds.max);
+        if(glm::length2(closest - center) <= radiusSquared)
+        {
+            results.push_back(proxy.entity);
+        }
+    });
+
+    return results.size() - initialCount;
+}
+
+std::size_t SpatialGridSystem::QueryRay(const glm::vec2& origin,
+    const glm::vec2& direction, float maxDistance, RayHitList& results)
+{
+    /*
+        Traverse cells along the ray using digital differential analyzer and test each proxy
+        in visited cells against the ray. Hits are appended in order of increasing distance.
+    */
+
+    CHECK_ARGUMENT_OR_RETURN(glm::length2(direction) > 0.0f, 0);
+    CHECK_ARGUMENT_OR_RETURN(maxDistance >= 0.0f && std::isfinite(maxDistance), 0);
+
+    const std::size_t initialCount = results.size();
+    const uint32_t queryStamp = NextQueryStamp();
+
+    const glm::vec2 rayDirection = glm::normalize(direction);
+    const glm::vec2 inverseDirection = 1.0f / rayDirection;
+
+    // Setup traversal starting from cell that contains ray origin.
+    // Step direction is taken from sign bit, so negative zero components step consistently
+    // with their infinite inverse. Ray never crosses boundaries along axis it is parallel to.
+    glm::ivec2 cell = glm::ivec2(glm::floor(origin * m_inverseCellSize));
+    glm::ivec2 step;
+    glm::vec2 tDelta;
+    glm::vec2 tMax;
+
+    for(int axis = 0; axis < 2; ++axis)
+    {
+        step[axis] = std::signbit(rayDirection[axis]) ? -1 : 1;
+
+        if(std::isinf(inverseDirection[axis]))
+        {
+            tDelta[axis] = std::numeric_limits<float>::infinity();
+            tMax[axis] = std::numeric_limits<float>::infinity();
+            continue;
+        }
+
+        const float nextBoundary = float(cell[axis] + (step[axis] > 0 ? 1 : 0)) * m_cellSize;
+        tDelta[axis] = std::abs(m_cellSize * inverseDirection[axis]);
+        tMax[axis] = (nextBoundary - origin[axis]) * inverseDirection[axis];
+    }
+
+    float traveled = 0.0f;
+    while(traveled <= maxDistance)
+    {
+        auto it = m_cells.find(CalculateCellKey(cell.x, cell.y));
+        if(it != m_cells.end())
+        {
+            for(ProxyIndex proxyIndex : it->second)
+            {
+                Proxy& proxy = m_proxies[proxyIndex];
+                if(proxy.queryStamp == queryStamp)
+                    continue;
+
+                proxy.queryStamp = queryStamp;
+
+                float distance = 0.0f;
+                if(IntersectRay(proxy.bounds, origin, inverseDirection, maxDistance, distance))
+                {
+                    results.push_back({ proxy.entity, distance });
+                }
+            }
+        }
+
+        // Step into neighboring cell crossed first by the ray.
+        if(tMax.x < tMax.y)
+        {
+            traveled = tMax.x;
+            tMax.x += tDelta.x;
+            cell.x += step.x;
+        }
+        else
+        {
+            traveled = tMax.y;
+            tMax.y += tDelta.y;
+            cell.y += step.y;
+        }
+    }
+
+    std::sort(results.begin() + initialCount, results.end(),
+        [](const RayHit& a, const RayHit& b)
+        {
+            return a.distance < b.distance;
+        });
+
+    return results.size() - initialCount;
+}
+
+SpatialGridSystem::CellRange SpatialGridSystem::CalculateCellRange(const Bounds& bounds) const
+{
+    CellRange range;
+    range.min = glm::ivec2(glm::floor(bounds.min * m_inverseCellSize));
+    range.max = glm::ivec2(glm::floor(bounds.max * m_inverseCellSize));
+    return range;
+}
+
+SpatialGridSystem::CellKey SpatialGridSystem::CalculateCellKey(int x, int y)
+{
+    return (CellKey(uint32_t(x)) << 32) | CellKey(uint32_t(y));
+}
+
+void SpatialGridSystem::InsertProxy(ProxyIndex proxyIndex)
+{
+    const CellRange& range = m_proxies[proxyIndex].cells;
+    for(int y = range.min.y; y <= range.max.y; ++y)
+    {
+        for(int x = range.min.x; x <= range.max.x; ++x)
+        {
+            m_cells[CalculateCellKey(x, y)].push_back(proxyIndex);
+        }
+    }
+}
+
+void SpatialGridSystem::RemoveProxy(ProxyIndex proxyIndex)
+{
+    const CellRange& range = m_proxies[proxyIndex].cells;
+    for(int y = range.min.y; y <= range.max.y; ++y)
+    {
+        for(int x = range.min.x; x <= range.max.x; ++x)
+        {
+            auto it = m_cells.find(CalculateCellKey(x, y));
+            ASSERT(it != m_cells.end(), "Proxy cell is missing from the grid!");
+
+            // Swap and pop proxy as order of entries in a cell does not matter.
+            CellEntries& entries = it->second;
+            auto entryIt = std::find(entries.begin(), entries.end(), proxyIndex);
+            ASSERT(entryIt != entries.end(), "Proxy entry is missing from its cell!");
+
+            *entryIt = entries.back();
+            entries.pop_back();
+
+            if(entries.empty())
+            {
+                m_cells.erase(it);
+            }
+        }
+    }
+}
+
+void SpatialGridSystem::MoveProxy(ProxyIndex proxyIndex, const Bounds& bounds)
+{
+    Proxy& proxy = m_proxies[proxyIndex];
+    proxy.bounds = bounds;
+
+    // Move proxy between cells only if it crossed cell boundaries.
+    const CellRange cells = CalculateCellRange(bounds);
+    if(cells != proxy.cells)
+    {
+        RemoveProxy(proxyIndex);
+        proxy.cells = cells;
+        InsertProxy(proxyIndex);
+
+        ++m_lastUpdateRebucketCount;
+    }
+}
+
+void SpatialGridSystem::ReleaseProxy(ProxyIndex proxyIndex)
+{
+    Proxy& proxy = m_proxies[proxyIndex];
+    ASSERT(proxy.entity.IsValid(), "Releasing unused proxy!");
+
+    RemoveProxy(proxyIndex);
+    m_transformSlots[proxy.slotIndex].entity = EntityHandle();
+    m_proxyLookup.erase(proxy.entity);
+    m_freeProxies.push_back(proxyIndex);
+    proxy = Proxy();
+}
+
+uint32_t SpatialGridSystem::NextQueryStamp()
+{
+    // Reset stamps on wrap around so stale stamps cannot match new queries.
+    if(++m_queryStamp == 0)
+    {
+        for(Proxy& proxy : m_proxies)
+        {
+            proxy.queryStamp = 0;
+        }
+
+        m_queryStamp = 1;
+    }
+
+    return m_queryStamp;
+}
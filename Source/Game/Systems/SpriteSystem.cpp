@@ -38,3 +38,36 @@ void SpriteSystem::OnTick(const float timeDelta)
         spriteAnimationComponent.Tick(timeDelta);
     }
 }
+
+void SpriteSystem::UpdateAnimationFrames(const float timeAlpha)
+{
+    using SpriteAnimation = SpriteAnimationComponent::SpriteAnimation;
+
+    // Evaluate frames of all playing animations at interpolated time.
+    std::size_t frameUpdateCount = 0;
+
+    for(auto& spriteAnimationComponent : m_componentSystem->GetPool<SpriteAnimationComponent>())
+    {
+        if(!spriteAnimationComponent.IsPlaying())
+            continue;
+
+        const SpriteAnimation* spriteAnimation = spriteAnimationComponent.GetCurrentSpriteAnimation();
+        ASSERT(spriteAnimation, "Sprite animation is null despite being played!");
+
+        const uint32_t frameIndex = spriteAnimation->GetFrameIndexByTime(
+            spriteAnimationComponent.CalculateAnimationTime(timeAlpha));
+
+        // Update sprite texture view only when displayed frame changes.
+        if(frameIndex == spriteAnimationComponent.GetCurrentFrameIndex())
+            continue;
+
+        spriteAnimationComponent.SetCurrentFrameIndex(frameIndex);
+        spriteAnimationComponent.GetSpriteComponent()->SetTextureView(
+            frameIndex != SpriteAnimation::InvalidFrameIndex ?
+                spriteAnimation->frames[frameIndex].textureView : Graphics::TextureView());
+
+        ++frameUpdateCount;
+    }
+
+    m_lastFrameUpdateCount = frameUpdateCount;
+}
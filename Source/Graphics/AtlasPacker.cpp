@@ -0,0 +1,208 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Graphics/Precompiled.hpp"
+#include "Graphics/AtlasPacker.hpp"
+using namespace Graphics;
+
+AtlasPacker::AtlasPacker() = default;
+AtlasPacker::~AtlasPacker() = default;
+
+AtlasPacker::CreateResult AtlasPacker::Create(const CreateFromParams& params)
+{
+    // Validate arguments.
+    CHECK_ARGUMENT_OR_RETURN(params.width > 0,
+        Common::Failure(CreateErrors::InvalidArgument));
+    CHECK_ARGUMENT_OR_RETURN(params.height > 0,
+        Common::Failure(CreateErrors::InvalidArgument));
+    CHECK_ARGUMENT_OR_RETURN(params.padding >= 0,
+        Common::Failure(CreateErrors::InvalidArgument));
+
+    // Create instance.
+    auto instance = std::unique_ptr<AtlasPacker>(new AtlasPacker());
+    instance->m_width = params.width;
+    instance->m_height = params.height;
+    instance->m_padding = params.padding;
+    instance->Reset();
+
+    return Common::Success(std::move(instance));
+}
+
+void AtlasPacker::CopyPadded(const uint8_t* source, int width, int height, int channels,
+    int padding, BleedPolicy bleedPolicy, uint8_t* destination)
+{
+    ASSERT(source != nullptr && destination != nullptr, "Invalid pixel data!");
+    ASSERT(width > 0 && height > 0 && channels > 0 && padding >= 0, "Invalid image size!");
+
+    const int paddedWidth = width + padding * 2;
+    const int paddedHeight = height + padding * 2;
+    const std::size_t rowSize = static_cast<std::size_t>(width) * channels;
+    const std::size_t paddedRowSize = static_cast<std::size_t>(paddedWidth) * channels;
+
+    for(int y = 0; y < paddedHeight; ++y)
+    {
+        uint8_t* destinationRow = destination + y * paddedRowSize;
+        const int sourceY = y - padding;
+
+        // Rows above and below image are either cleared or copied from nearest edge row.
+        if(bleedPolicy == BleedPolicy::Transparent && (sourceY < 0 || sourceY >= height))
+        {
+            std::memset(destinationRow, 0, paddedRowSize);
+            continue;
+        }
+
+        const uint8_t* sourceRow = source + std::clamp(sourceY, 0, height - 1) * rowSize;
+        std::memcpy(destinationRow + padding * channels, sourceRow, rowSize);
+
+        for(int x = 0; x < padding; ++x)
+        {
+            uint8_t* left = destinationRow + x * channels;
+            uint8_t* right = destinationRow + (padding + width + x) * channels;
+
+            if(bleedPolicy == BleedPolicy::Extrude)
+            {
+                std::memcpy(left, sourceRow, channels);
+                std::memcpy(right, sourceRow + rowSize - channels, channels);
+            }
+            else
+            {
+                std::memset(left, 0, channels);
+                std::memset(right, 0, channels);
+            }
+        }
+    }
+}
+
+std::optional<glm::ivec4> AtlasPacker::Allocate(int width, int height)
+{
+    ASSERT(width > 0 && height > 0, "Invalid rectangle size!");
+
+    // Padding is allocated together with rectangle.
+    const int paddedWidth = width + m_padding * 2;
+    const int paddedHeight = height + m_padding * 2;
+
+    std::optional<Placement> placement = FindPlacement(paddedWidth, paddedHeight);
+    if(!placement)
+        return std::nullopt;
+
+    // Insert new segment on top of placed rectangle.
+    SkylineNode newNode;
+    newNode.x = m_skyline[placement->nodeIndex].x;
+    newNode.y = placement->y + paddedHeight;
+    newNode.width = paddedWidth;
+    m_skyline.insert(m_skyline.begin() + placement->nodeIndex, newNode);
+
+    // Shrink or remove following segments that are now covered by new segment.
+    for(std::size_t i = placement->nodeIndex + 1; i < m_skyline.size();)
+    {
+        const SkylineNode& previous = m_skyline[i - 1];
+        SkylineNode& current = m_skyline[i];
+
+        const int overlap = previous.x + previous.width - current.x;
+        if(overlap <= 0)
+            break;
+
+        if(overlap < current.width)
+        {
+            current.x += overlap;
+            current.width -= overlap;
+            break;
+        }
+
+        m_skyline.erase(m_skyline.begin() + i);
+    }
+
+    // Merge neighboring segments at same height.
+    for(std::size_t i = 1; i < m_skyline.size();)
+    {
+        if(m_skyline[i - 1].y == m_skyline[i].y)
+        {
+            m_skyline[i - 1].width += m_skyline[i].width;
+            m_skyline.erase(m_skyline.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    m_allocatedArea += static_cast<int64_t>(paddedWidth) * paddedHeight;
+
+    // Return rectangle without its padding.
+    glm::ivec4 rectangle;
+    rectangle.x = newNode.x + m_padding;
+    rectangle.y = placement->y + m_padding;
+    rectangle.z = rectangle.x + width;
+    rectangle.w = rectangle.y + height;
+    return rectangle;
+}
+
+bool AtlasPacker::CanAllocate(int width, int height) const
+{
+    return FindPlacement(width + m_padding * 2, height + m_padding * 2).has_value();
+}
+
+void AtlasPacker::Reset()
+{
+    m_skyline.clear();
+    m_skyline.push_back({ 0, 0, m_width });
+    m_allocatedArea = 0;
+}
+
+float AtlasPacker::GetOccupancy() const
+{
+    return static_cast<float>(m_allocatedArea) /
+        (static_cast<float>(m_width) * static_cast<float>(m_height));
+}
+
+std::optional<int> AtlasPacker::FitNode(std::size_t nodeIndex, int width, int height) const
+{
+    if(m_skyline[nodeIndex].x + width > m_width)
+        return std::nullopt;
+
+    // Rectangle rests on highest segment that it spans.
+    int y = m_skyline[nodeIndex].y;
+    int remainingWidth = width;
+
+    for(std::size_t i = nodeIndex; remainingWidth > 0; ++i)
+    {
+        ASSERT(i < m_skyline.size(), "Skyline does not cover page width!");
+
+        y = std::max(y, m_skyline[i].y);
+        if(y + height > m_height)
+            return std::nullopt;
+
+        remainingWidth -= m_skyline[i].width;
+    }
+
+    return y;
+}
+
+std::optional<AtlasPacker::Placement> AtlasPacker::FindPlacement(int width, int height) const
+{
+    if(width > m_width || height > m_height)
+        return std::nullopt;
+
+    std::optional<Placement> bestPlacement;
+    int bestTop = std::numeric_limits<int>::max();
+    int bestWidth = std::numeric_limits<int>::max();
+
+    for(std::size_t i = 0; i < m_skyline.size(); ++i)
+    {
+        std::optional<int> y = FitNode(i, width, height);
+        if(!y)
+            continue;
+
+        const int top = *y + height;
+        if(top < bestTop || (top == bestTop && m_skyline[i].width < bestWidth))
+        {
+            bestPlacement = Placement{ i, *y };
+            bestTop = top;
+            bestWidth = m_skyline[i].width;
+        }
+    }
+
+    return bestPlacement;
+}
@@ -17,6 +17,7 @@ Buffer::~Buffer()
 {
     if(m_handle != OpenGL::InvalidHandle)
     {
+        m_renderContext->AcquireContext();
         glDeleteBuffers(1, &m_handle);
         OpenGL::CheckErrors();
     }
@@ -33,8 +34,12 @@ Buffer::BufferResult Buffer::Initialize(GLenum type, const CreateFromParams& par
     CHECK_ARGUMENT_OR_RETURN(params.elementSize != 0,
         Common::Failure(BufferErrors::InvalidArgument));
 
+    // Save render context reference, which is also needed to release handle.
+    m_renderContext = params.renderContext;
+
     // Create buffer handle.
     ASSERT(m_handle == OpenGL::InvalidHandle);
+    m_renderContext->AcquireContext();
 
     glGenBuffers(1, &m_handle);
     OpenGL::CheckErrors();
@@ -64,9 +69,6 @@ Buffer::BufferResult Buffer::Initialize(GLenum type, const CreateFromParams& par
     m_elementSize = params.elementSize;
     m_elementCount = params.elementCount;
 
-    // Save render context reference.
-    m_renderContext = params.renderContext;
-
     return Common::Success();
 }
 
@@ -76,6 +78,7 @@ void Buffer::Update(const void* data, std::size_t elementCount)
     ASSERT_ALWAYS_ARGUMENT(elementCount > 0);
 
     // Upload new buffer data.
+    m_renderContext->AcquireContext();
     glBindBuffer(m_type, m_handle);
     glBufferData(m_type, m_elementSize * elementCount, data, m_usage);
     glBindBuffer(m_type, m_renderContext->GetState().GetBufferBinding(m_type));
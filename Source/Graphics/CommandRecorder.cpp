@@ -0,0 +1,1473 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Graphics/Precompiled.hpp"
+#include "Graphics/CommandRecorder.hpp"
+using namespace Graphics;
+
+namespace
+{
+    const char* LogAttachFailed = "Failed to attach command recorder! {}";
+
+    CommandRecorder* InstalledRecorder = nullptr;
+
+    // Program binaries produced by emulated context contain source code of linked shaders.
+    const GLenum RecordedProgramBinaryFormat = 0x5245;
+
+    // Emulated context supports compressed formats required by OpenGL ES 3.0.
+    const GLenum RecordedCompressedFormats[] =
+    {
+        GL_COMPRESSED_R11_EAC,
+        GL_COMPRESSED_SIGNED_R11_EAC,
+        GL_COMPRESSED_RG11_EAC,
+        GL_COMPRESSED_SIGNED_RG11_EAC,
+        GL_COMPRESSED_RGB8_ETC2,
+        GL_COMPRESSED_SRGB8_ETC2,
+        GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+        GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+        GL_COMPRESSED_RGBA8_ETC2_EAC,
+        GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC,
+    };
+
+    const char* CommandNames[] =
+    {
+        "glActiveTexture",
+        "glAttachShader",
+        "glBindBuffer",
+        "glBindSampler",
+        "glBindTexture",
+        "glBindVertexArray",
+        "glBlendEquationSeparate",
+        "glBlendFuncSeparate",
+        "glBufferData",
+        "glClear",
+        "glClearColor",
+        "glClearDepthf",
+        "glCompileShader",
+        "glCompressedTexImage2D",
+        "glCreateProgram",
+        "glCreateShader",
+        "glDeleteBuffers",
+        "glDeleteProgram",
+        "glDeleteSamplers",
+        "glDeleteShader",
+        "glDeleteTextures",
+        "glDeleteVertexArrays",
+        "glDepthMask",
+        "glDetachShader",
+        "glDisable",
+        "glDrawArrays",
+        "glDrawArraysInstanced",
+        "glDrawElements",
+        "glEnable",
+        "glEnableVertexAttribArray",
+        "glGenBuffers",
+        "glGenSamplers",
+        "glGenTextures",
+        "glGenVertexArrays",
+        "glGenerateMipmap",
+        "glLinkProgram",
+        "glPixelStorei",
+        "glProgramBinary",
+        "glProgramParameteri",
+        "glSamplerParameterf",
+        "glSamplerParameterfv",
+        "glSamplerParameteri",
+        "glScissor",
+        "glShaderSource",
+        "glTexImage2D",
+        "glTexParameteri",
+        "glTexSubImage2D",
+        "glUniform1i",
+        "glUniform2fv",
+        "glUniformMatrix4fv",
+        "glUseProgram",
+        "glVertexAttribDivisor",
+        "glVertexAttribPointer",
+        "glViewport",
+    };
+
+    static_assert(Common::StaticArraySize(CommandNames) ==
+        static_cast<std::size_t>(CommandRecorder::CommandType::Count),
+        "Command name table does not match command types!");
+
+    CommandRecorder::Argument Integer(int64_t value)
+    {
+        CommandRecorder::Argument argument;
+        argument.type = CommandRecorder::ArgumentType::Integer;
+        argument.integer = value;
+        return argument;
+    }
+
+    CommandRecorder::Argument Enum(GLenum value)
+    {
+        CommandRecorder::Argument argument;
+        argument.type = CommandRecorder::ArgumentType::Enum;
+        argument.integer = value;
+        return argument;
+    }
+
+    CommandRecorder::Argument Float(GLfloat value)
+    {
+        CommandRecorder::Argument argument;
+        argument.type = CommandRecorder::ArgumentType::Float;
+        argument.real = value;
+        return argument;
+    }
+
+    std::size_t CalculateTextureBytes(GLsizei width, GLsizei height, GLenum format, GLenum type)
+    {
+        std::size_t pixelBytes = 0;
+
+        switch(type)
+        {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            pixelBytes = 2;
+            break;
+
+        default:
+            {
+                std::size_t componentBytes = 1;
+                switch(type)
+                {
+                case GL_UNSIGNED_SHORT:
+                case GL_SHORT:
+                case GL_HALF_FLOAT:
+                    componentBytes = 2;
+                    break;
+
+                case GL_UNSIGNED_INT:
+                case GL_INT:
+                case GL_FLOAT:
+                    componentBytes = 4;
+                    break;
+                }
+
+                std::size_t componentCount = 4;
+                switch(format)
+                {
+                case GL_RED:
+                case GL_ALPHA:
+                case GL_LUMINANCE:
+                case GL_DEPTH_COMPONENT:
+                    componentCount = 1;
+                    break;
+
+                case GL_RG:
+                case GL_LUMINANCE_ALPHA:
+                    componentCount = 2;
+                    break;
+
+                case GL_RGB:
+                    componentCount = 3;
+                    break;
+                }
+
+                pixelBytes = componentBytes * componentCount;
+            }
+            break;
+        }
+
+        return pixelBytes * std::max(0, width) * std::max(0, height);
+    }
+
+    struct DeclaredUniform
+    {
+        std::string name;
+        GLenum type = GL_NONE;
+        GLint size = 1;
+    };
+
+    GLenum GetUniformType(std::string_view typeName)
+    {
+        static const std::pair<std::string_view, GLenum> UniformTypes[] =
+        {
+            { "float", GL_FLOAT },
+            { "vec2", GL_FLOAT_VEC2 },
+            { "vec3", GL_FLOAT_VEC3 },
+            { "vec4", GL_FLOAT_VEC4 },
+            { "int", GL_INT },
+            { "ivec2", GL_INT_VEC2 },
+            { "ivec3", GL_INT_VEC3 },
+            { "ivec4", GL_INT_VEC4 },
+            { "uint", GL_UNSIGNED_INT },
+            { "bool", GL_BOOL },
+            { "mat2", GL_FLOAT_MAT2 },
+            { "mat3", GL_FLOAT_MAT3 },
+            { "mat4", GL_FLOAT_MAT4 },
+            { "sampler2D", GL_SAMPLER_2D },
+            { "sampler3D", GL_SAMPLER_3D },
+            { "samplerCube", GL_SAMPLER_CUBE },
+            { "sampler2DArray", GL_SAMPLER_2D_ARRAY },
+        };
+
+        for(const auto& uniformType : UniformTypes)
+        {
+            if(uniformType.first == typeName)
+                return uniformType.second;
+        }
+
+        return GL_NONE;
+    }
+
+    void ParseUniformDeclarations(const std::string& source, std::vector<DeclaredUniform>& uniforms)
+    {
+        /*
+            Collects uniform declarations from shader source so emulated context can report
+            active uniforms after linking. This is not a GLSL parser and it does not evaluate
+            preprocessor directives, so uniforms from inactive branches are reported as well.
+        */
+
+        std::vector<std::string_view> tokens;
+
+        std::size_t index = 0;
+        while(index < source.size())
+        {
+            const char character = source[index];
+
+            if(source.compare(index, 2, "//") == 0)
+            {
+                index = std::min(source.find('\n', index), source.size());
+            }
+            else if(source.compare(index, 2, "/*") == 0)
+            {
+                index = std::min(source.find("*/", index), source.size() - 2) + 2;
+            }
+            else if(std::isalnum(static_cast<unsigned char>(character)) || character == '_')
+            {
+                std::size_t tokenEnd = index;
+                while(tokenEnd < source.size() && (std::isalnum(
+                    static_cast<unsigned char>(source[tokenEnd])) || source[tokenEnd] == '_'))
+                {
+                    ++tokenEnd;
+                }
+
+                tokens.emplace_back(source.data() + index, tokenEnd - index);
+                index = tokenEnd;
+            }
+            else
+            {
+                if(!std::isspace(static_cast<unsigned char>(character)))
+                {
+                    tokens.emplace_back(source.data() + index, 1);
+                }
+
+                ++index;
+            }
+        }
+
+        for(std::size_t i = 0; i < tokens.size(); ++i)
+        {
+            if(tokens[i] != "uniform")
+                continue;
+
+            std::size_t typeIndex = i + 1;
+            while(typeIndex < tokens.size() && (tokens[typeIndex] == "lowp"
+                || tokens[typeIndex] == "mediump" || tokens[typeIndex] == "highp"))
+            {
+                ++typeIndex;
+            }
+
+            // Uniform blocks are not supported.
+            const std::size_t nameIndex = typeIndex + 1;
+            if(nameIndex >= tokens.size() || tokens[nameIndex] == "{")
+                continue;
+
+            DeclaredUniform uniform;
+            uniform.name = std::string(tokens[nameIndex]);
+            uniform.type = GetUniformType(tokens[typeIndex]);
+
+            if(nameIndex + 3 < tokens.size() && tokens[nameIndex + 1] == "["
+                && tokens[nameIndex + 3] == "]")
+            {
+                uniform.size = std::max(1, std::atoi(std::string(tokens[nameIndex + 2]).c_str()));
+            }
+
+            auto declared = std::find_if(uniforms.begin(), uniforms.end(),
+                [&uniform](const DeclaredUniform& other)
+                {
+                    return other.name == uniform.name;
+                });
+
+            if(declared == uniforms.end())
+            {
+                uniforms.push_back(std::move(uniform));
+            }
+        }
+    }
+}
+
+struct CommandRecorder::ContextState
+{
+    static const GLuint TextureUnitCount = 32;
+
+    std::unordered_map<GLenum, GLboolean> capabilities;
+    GLuint vertexArrayBinding = 0;
+    GLuint arrayBufferBinding = 0;
+    GLuint elementArrayBufferBinding = 0;
+    GLenum activeTexture = GL_TEXTURE0;
+    GLuint textureBindings[TextureUnitCount] = {};
+    GLuint samplerBindings[TextureUnitCount] = {};
+    GLint packAlignment = 4;
+    GLint unpackAlignment = 4;
+    GLuint currentProgram = 0;
+    std::array<GLint, 4> viewport = { 0, 0, 0, 0 };
+    std::array<GLint, 4> scissorBox = { 0, 0, 0, 0 };
+    GLfloat clearDepth = 1.0f;
+    std::array<GLfloat, 4> clearColor = { 0.0f, 0.0f, 0.0f, 0.0f };
+    GLboolean depthMask = GL_TRUE;
+    std::array<GLenum, 4> blendFunc = { GL_ONE, GL_ZERO, GL_ONE, GL_ZERO };
+    std::array<GLenum, 2> blendEquation = { GL_FUNC_ADD, GL_FUNC_ADD };
+
+    GLuint nextObjectName = 1;
+    std::unordered_map<GLuint, std::string> shaderSources;
+    std::unordered_map<GLuint, std::vector<GLuint>> attachedShaders;
+    std::unordered_map<GLuint, std::string> programBinaries;
+    std::unordered_map<GLuint, std::vector<DeclaredUniform>> programUniforms;
+    std::unordered_map<GLuint, std::unordered_map<std::string, GLint>> uniformLocations;
+    std::unordered_map<GLuint, std::unordered_map<std::string, GLint>> attributeLocations;
+
+    GLuint GetActiveTextureUnit() const
+    {
+        GLuint unit = activeTexture - GL_TEXTURE0;
+        ASSERT(unit < TextureUnitCount, "Active texture unit is out of emulated range!");
+        return std::min(unit, TextureUnitCount - 1);
+    }
+};
+
+struct Graphics::CommandRecorderDispatch
+{
+    /*
+        Recording functions that replace GL entry points in dispatch table.
+        Functions that change context state are counted as state changes and
+        additionally as redundant ones when they set already current value.
+    */
+
+    static CommandRecorder& Recorder()
+    {
+        ASSERT(InstalledRecorder != nullptr, "Recording function called without installed recorder!");
+        return *InstalledRecorder;
+    }
+
+    static CommandRecorder::ContextState& State()
+    {
+        return *Recorder().m_contextState;
+    }
+
+    static CommandRecorder::FrameStats& Stats()
+    {
+        return Recorder().m_frameStats;
+    }
+
+    template<typename Type>
+    static void ChangeState(Type& current, const Type& value)
+    {
+        Stats().stateChanges += 1;
+
+        if(current == value)
+        {
+            Stats().redundantStateChanges += 1;
+        }
+
+        current = value;
+    }
+
+    static void GenerateNames(GLsizei count, GLuint* names)
+    {
+        for(GLsizei i = 0; i < count; ++i)
+        {
+            names[i] = State().nextObjectName++;
+        }
+    }
+
+    static void CountQuery()
+    {
+        Stats().queries += 1;
+    }
+
+    // Object creation and destruction.
+    static void APIENTRY GenBuffers(GLsizei n, GLuint* buffers)
+    {
+        GenerateNames(n, buffers);
+        Recorder().Record(CommandRecorder::CommandType::GenBuffers, { Integer(n), Integer(buffers[0]) });
+    }
+
+    static void APIENTRY DeleteBuffers(GLsizei n, const GLuint* buffers)
+    {
+        Recorder().Record(CommandRecorder::CommandType::DeleteBuffers, { Integer(n), Integer(buffers[0]) });
+    }
+
+    static void APIENTRY GenTextures(GLsizei n, GLuint* textures)
+    {
+        GenerateNames(n, textures);
+        Recorder().Record(CommandRecorder::CommandType::GenTextures, { Integer(n), Integer(textures[0]) });
+    }
+
+    static void APIENTRY DeleteTextures(GLsizei n, const GLuint* textures)
+    {
+        Recorder().Record(CommandRecorder::CommandType::DeleteTextures, { Integer(n), Integer(textures[0]) });
+    }
+
+    static void APIENTRY GenSamplers(GLsizei count, GLuint* samplers)
+    {
+        GenerateNames(count, samplers);
+        Recorder().Record(CommandRecorder::CommandType::GenSamplers, { Integer(count), Integer(samplers[0]) });
+    }
+
+    static void APIENTRY DeleteSamplers(GLsizei count, const GLuint* samplers)
+    {
+        Recorder().Record(CommandRecorder::CommandType::DeleteSamplers, { Integer(count), Integer(samplers[0]) });
+    }
+
+    static void APIENTRY GenVertexArrays(GLsizei n, GLuint* arrays)
+    {
+        GenerateNames(n, arrays);
+        Recorder().Record(CommandRecorder::CommandType::GenVertexArrays, { Integer(n), Integer(arrays[0]) });
+    }
+
+    static void APIENTRY DeleteVertexArrays(GLsizei n, const GLuint* arrays)
+    {
+        Recorder().Record(CommandRecorder::CommandType::DeleteVertexArrays, { Integer(n), Integer(arrays[0]) });
+    }
+
+    static GLuint APIENTRY CreateShader(GLenum type)
+    {
+        GLuint shader = State().nextObjectName++;
+        Recorder().Record(CommandRecorder::CommandType::CreateShader, { Enum(type), Integer(shader) });
+        return shader;
+    }
+
+    static void APIENTRY DeleteShader(GLuint shader)
+    {
+        State().shaderSources.erase(shader);
+        Recorder().Record(CommandRecorder::CommandType::DeleteShader, { Integer(shader) });
+    }
+
+    static GLuint APIENTRY CreateProgram()
+    {
+        GLuint program = State().nextObjectName++;
+        Recorder().Record(CommandRecorder::CommandType::CreateProgram, { Integer(program) });
+        return program;
+    }
+
+    static void APIENTRY DeleteProgram(GLuint program)
+    {
+        State().attachedShaders.erase(program);
+        State().programBinaries.erase(program);
+        State().programUniforms.erase(program);
+        State().uniformLocations.erase(program);
+        State().attributeLocations.erase(program);
+        Recorder().Record(CommandRecorder::CommandType::DeleteProgram, { Integer(program) });
+    }
+
+    // Shader compilation.
+    static void APIENTRY ShaderSource(GLuint shader, GLsizei count,
+        const GLchar* const* string, const GLint* length)
+    {
+        std::string& source = State().shaderSources[shader];
+        source.clear();
+
+        for(GLsizei i = 0; i < count; ++i)
+        {
+            if(length != nullptr && length[i] >= 0)
+            {
+                source.append(string[i], length[i]);
+            }
+            else
+            {
+                source.append(string[i]);
+            }
+        }
+
+        Recorder().Record(CommandRecorder::CommandType::ShaderSource, { Integer(shader), Integer(count) });
+    }
+
+    static void APIENTRY CompileShader(GLuint shader)
+    {
+        Recorder().Record(CommandRecorder::CommandType::CompileShader, { Integer(shader) });
+    }
+
+    static void APIENTRY AttachShader(GLuint program, GLuint shader)
+    {
+        State().attachedShaders[program].push_back(shader);
+        Recorder().Record(CommandRecorder::CommandType::AttachShader, { Integer(program), Integer(shader) });
+    }
+
+    static void APIENTRY DetachShader(GLuint program, GLuint shader)
+    {
+        std::vector<GLuint>& shaders = State().attachedShaders[program];
+        shaders.erase(std::remove(shaders.begin(), shaders.end(), shader), shaders.end());
+        Recorder().Record(CommandRecorder::CommandType::DetachShader, { Integer(program), Integer(shader) });
+    }
+
+    static void LinkUniforms(GLuint program, const std::string& binary)
+    {
+        // Assign uniform locations in order of declaration.
+        std::vector<DeclaredUniform>& uniforms = State().programUniforms[program];
+        uniforms.clear();
+        ParseUniformDeclarations(binary, uniforms);
+
+        std::unordered_map<std::string, GLint>& locations = State().uniformLocations[program];
+        locations.clear();
+
+        GLint nextLocation = 0;
+        for(const DeclaredUniform& uniform : uniforms)
+        {
+            locations.emplace(uniform.name, nextLocation);
+
+            if(uniform.size > 1)
+            {
+                for(GLint element = 0; element < uniform.size; ++element)
+                {
+                    locations.emplace(fmt::format("{}[{}]", uniform.name, element),
+                        nextLocation + element);
+                }
+            }
+
+            nextLocation += uniform.size;
+        }
+
+        State().programBinaries[program] = binary;
+    }
+
+    static void APIENTRY LinkProgram(GLuint program)
+    {
+        std::string binary;
+        for(GLuint shader : State().attachedShaders[program])
+        {
+            binary += State().shaderSources[shader];
+        }
+
+        LinkUniforms(program, binary);
+        Recorder().Record(CommandRecorder::CommandType::LinkProgram, { Integer(program) });
+    }
+
+    static void APIENTRY ProgramParameteri(GLuint program, GLenum pname, GLint value)
+    {
+        Recorder().Record(CommandRecorder::CommandType::ProgramParameteri,
+            { Integer(program), Enum(pname), Integer(value) });
+    }
+
+    static void APIENTRY ProgramBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+    {
+        ASSERT(binaryFormat == RecordedProgramBinaryFormat, "Unsupported program binary format!");
+        LinkUniforms(program, std::string(static_cast<const char*>(binary), length));
+        Recorder().Record(CommandRecorder::CommandType::ProgramBinary,
+            { Integer(program), Enum(binaryFormat), Integer(length) });
+    }
+
+    static void APIENTRY GetProgramBinary(GLuint program, GLsizei bufSize,
+        GLsizei* length, GLenum* binaryFormat, void* binary)
+    {
+        CountQuery();
+
+        const std::string& programBinary = State().programBinaries[program];
+        GLsizei binaryLength = std::min(static_cast<GLsizei>(programBinary.size()), bufSize);
+        std::copy_n(programBinary.data(), binaryLength, static_cast<char*>(binary));
+
+        if(length != nullptr)
+        {
+            *length = binaryLength;
+        }
+
+        *binaryFormat = RecordedProgramBinaryFormat;
+    }
+
+    static const GLubyte* APIENTRY GetString(GLenum name)
+    {
+        CountQuery();
+
+        const char* string = "";
+        switch(name)
+        {
+        case GL_VENDOR:
+            string = "Engine";
+            break;
+
+        case GL_RENDERER:
+            string = "Command Recorder";
+            break;
+
+        case GL_VERSION:
+            string = "OpenGL ES 3.0 Command Recorder";
+            break;
+
+        case GL_SHADING_LANGUAGE_VERSION:
+            string = "OpenGL ES GLSL ES 3.00";
+            break;
+        }
+
+        return reinterpret_cast<const GLubyte*>(string);
+    }
+
+    static void APIENTRY GetShaderiv(GLuint shader, GLenum pname, GLint* params)
+    {
+        CountQuery();
+        *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+    }
+
+    static void APIENTRY GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+    {
+        CountQuery();
+
+        if(length != nullptr)
+        {
+            *length = 0;
+        }
+
+        if(bufSize > 0)
+        {
+            infoLog[0] = '\0';
+        }
+    }
+
+    static void APIENTRY GetProgramiv(GLuint program, GLenum pname, GLint* params)
+    {
+        CountQuery();
+
+        switch(pname)
+        {
+        case GL_LINK_STATUS:
+            *params = GL_TRUE;
+            break;
+
+        case GL_PROGRAM_BINARY_LENGTH:
+            *params = static_cast<GLint>(State().programBinaries[program].size());
+            break;
+
+        case GL_ACTIVE_UNIFORMS:
+            *params = static_cast<GLint>(State().programUniforms[program].size());
+            break;
+
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+            *params = 0;
+            for(const DeclaredUniform& uniform : State().programUniforms[program])
+            {
+                // Array uniforms are reported with "[0]" suffix and null terminator.
+                GLint nameLength = static_cast<GLint>(uniform.name.size()) + 1;
+                *params = std::max(*params, uniform.size > 1 ? nameLength + 3 : nameLength);
+            }
+            break;
+
+        default:
+            *params = 0;
+            break;
+        }
+    }
+
+    static void APIENTRY GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+    {
+        GetShaderInfoLog(program, bufSize, length, infoLog);
+    }
+
+    static void APIENTRY GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize,
+        GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+    {
+        CountQuery();
+
+        const std::vector<DeclaredUniform>& uniforms = State().programUniforms[program];
+        ASSERT(index < uniforms.size(), "Active uniform index is out of range!");
+
+        const DeclaredUniform& uniform = uniforms[std::min<std::size_t>(index, uniforms.size() - 1)];
+        std::string uniformName = uniform.size > 1 ? uniform.name + "[0]" : uniform.name;
+
+        GLsizei nameLength = std::min(static_cast<GLsizei>(uniformName.size()), std::max(bufSize - 1, 0));
+        std::copy_n(uniformName.data(), nameLength, name);
+
+        if(bufSize > 0)
+        {
+            name[nameLength] = '\0';
+        }
+
+        if(length != nullptr)
+        {
+            *length = nameLength;
+        }
+
+        *size = uniform.size;
+        *type = uniform.type;
+    }
+
+    static GLint APIENTRY GetUniformLocation(GLuint program, const GLchar* name)
+    {
+        CountQuery();
+
+        const std::unordered_map<std::string, GLint>& locations = State().uniformLocations[program];
+        auto it = locations.find(name);
+        return it != locations.end() ? it->second : -1;
+    }
+
+    static GLint APIENTRY GetAttribLocation(GLuint program, const GLchar* name)
+    {
+        CountQuery();
+
+        std::unordered_map<std::string, GLint>& locations = State().attributeLocations[program];
+        auto result = locations.emplace(name, static_cast<GLint>(locations.size()));
+        return result.first->second;
+    }
+
+    // Uniforms.
+    static void APIENTRY Uniform1i(GLint location, GLint v0)
+    {
+        Stats().uniformUpdates += 1;
+        Recorder().Record(CommandRecorder::CommandType::Uniform1i, { Integer(location), Integer(v0) });
+    }
+
+    static void APIENTRY Uniform2fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        Stats().uniformUpdates += 1;
+        Recorder().Record(CommandRecorder::CommandType::Uniform2fv, { Integer(location), Integer(count) });
+    }
+
+    static void APIENTRY UniformMatrix4fv(GLint location, GLsizei count,
+        GLboolean transpose, const GLfloat* value)
+    {
+        Stats().uniformUpdates += 1;
+        Recorder().Record(CommandRecorder::CommandType::UniformMatrix4fv,
+            { Integer(location), Integer(count), Integer(transpose) });
+    }
+
+    // Buffers and vertex arrays.
+    static void APIENTRY BindBuffer(GLenum target, GLuint buffer)
+    {
+        switch(target)
+        {
+        case GL_ARRAY_BUFFER:
+            ChangeState(State().arrayBufferBinding, buffer);
+            break;
+
+        case GL_ELEMENT_ARRAY_BUFFER:
+            ChangeState(State().elementArrayBufferBinding, buffer);
+            break;
+
+        default:
+            Stats().stateChanges += 1;
+            break;
+        }
+
+        Recorder().Record(CommandRecorder::CommandType::BindBuffer, { Enum(target), Integer(buffer) });
+    }
+
+    static void APIENTRY BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+    {
+        Stats().bufferBytesUploaded += data != nullptr ? static_cast<std::size_t>(size) : 0;
+        Recorder().Record(CommandRecorder::CommandType::BufferData,
+            { Enum(target), Integer(size), Enum(usage) });
+    }
+
+    static void APIENTRY BindVertexArray(GLuint array)
+    {
+        ChangeState(State().vertexArrayBinding, array);
+        Recorder().Record(CommandRecorder::CommandType::BindVertexArray, { Integer(array) });
+    }
+
+    static void APIENTRY EnableVertexAttribArray(GLuint index)
+    {
+        Recorder().Record(CommandRecorder::CommandType::EnableVertexAttribArray, { Integer(index) });
+    }
+
+    static void APIENTRY VertexAttribPointer(GLuint index, GLint size, GLenum type,
+        GLboolean normalized, GLsizei stride, const void* pointer)
+    {
+        Recorder().Record(CommandRecorder::CommandType::VertexAttribPointer,
+            { Integer(index), Integer(size), Enum(type), Integer(normalized),
+            Integer(stride), Integer(reinterpret_cast<intptr_t>(pointer)) });
+    }
+
+    static void APIENTRY VertexAttribDivisor(GLuint index, GLuint divisor)
+    {
+        Recorder().Record(CommandRecorder::CommandType::VertexAttribDivisor,
+            { Integer(index), Integer(divisor) });
+    }
+
+    // Textures and samplers.
+    static void APIENTRY ActiveTexture(GLenum texture)
+    {
+        ChangeState(State().activeTexture, texture);
+        Recorder().Record(CommandRecorder::CommandType::ActiveTexture, { Enum(texture) });
+    }
+
+    static void APIENTRY BindTexture(GLenum target, GLuint texture)
+    {
+        if(target == GL_TEXTURE_2D)
+        {
+            ChangeState(State().textureBindings[State().GetActiveTextureUnit()], texture);
+        }
+        else
+        {
+            Stats().stateChanges += 1;
+        }
+
+        Recorder().Record(CommandRecorder::CommandType::BindTexture, { Enum(target), Integer(texture) });
+    }
+
+    static void APIENTRY BindSampler(GLuint unit, GLuint sampler)
+    {
+        ASSERT(unit < CommandRecorder::ContextState::TextureUnitCount);
+        ChangeState(State().samplerBindings[std::min(unit,
+            CommandRecorder::ContextState::TextureUnitCount - 1)], sampler);
+        Recorder().Record(CommandRecorder::CommandType::BindSampler, { Integer(unit), Integer(sampler) });
+    }
+
+    static void APIENTRY TexImage2D(GLenum target, GLint level, GLint internalformat,
+        GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+    {
+        if(pixels != nullptr)
+        {
+            Stats().textureBytesUploaded += CalculateTextureBytes(width, height, format, type);
+        }
+
+        Recorder().Record(CommandRecorder::CommandType::TexImage2D,
+            { Enum(target), Integer(level), Enum(internalformat), Integer(width),
+            Integer(height), Enum(format), Enum(type) });
+    }
+
+    static void APIENTRY CompressedTexImage2D(GLenum target, GLint level, GLenum internalformat,
+        GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data)
+    {
+        if(data != nullptr)
+        {
+            Stats().textureBytesUploaded += imageSize;
+        }
+
+        Recorder().Record(CommandRecorder::CommandType::CompressedTexImage2D,
+            { Enum(target), Integer(level), Enum(internalformat), Integer(width),
+            Integer(height), Integer(imageSize) });
+    }
+
+    static void APIENTRY TexParameteri(GLenum target, GLenum pname, GLint param)
+    {
+        Recorder().Record(CommandRecorder::CommandType::TexParameteri,
+            { Enum(target), Enum(pname), Integer(param) });
+    }
+
+    static void APIENTRY TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
+        GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+    {
+        Stats().textureBytesUploaded += CalculateTextureBytes(width, height, format, type);
+        Recorder().Record(CommandRecorder::CommandType::TexSubImage2D,
+            { Enum(target), Integer(level), Integer(xoffset), Integer(yoffset),
+            Integer(width), Integer(height), Enum(format), Enum(type) });
+    }
+
+    static void APIENTRY GenerateMipmap(GLenum target)
+    {
+        Recorder().Record(CommandRecorder::CommandType::GenerateMipmap, { Enum(target) });
+    }
+
+    static void APIENTRY SamplerParameteri(GLuint sampler, GLenum pname, GLint param)
+    {
+        Recorder().Record(CommandRecorder::CommandType::SamplerParameteri,
+            { Integer(sampler), Enum(pname), Integer(param) });
+    }
+
+    static void APIENTRY SamplerParameterf(GLuint sampler, GLenum pname, GLfloat param)
+    {
+        Recorder().Record(CommandRecorder::CommandType::SamplerParameterf,
+            { Integer(sampler), Enum(pname), Float(param) });
+    }
+
+    static void APIENTRY SamplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* param)
+    {
+        Recorder().Record(CommandRecorder::CommandType::SamplerParameterfv,
+            { Integer(sampler), Enum(pname), Float(param[0]) });
+    }
+
+    static void APIENTRY GetSamplerParameteriv(GLuint sampler, GLenum pname, GLint* params)
+    {
+        CountQuery();
+
+        switch(pname)
+        {
+        case GL_TEXTURE_MIN_FILTER:
+            *params = GL_NEAREST_MIPMAP_LINEAR;
+            break;
+
+        case GL_TEXTURE_MAG_FILTER:
+            *params = GL_LINEAR;
+            break;
+
+        case GL_TEXTURE_WRAP_S:
+        case GL_TEXTURE_WRAP_T:
+        case GL_TEXTURE_WRAP_R:
+            *params = GL_REPEAT;
+            break;
+
+        case GL_TEXTURE_COMPARE_MODE:
+            *params = GL_NONE;
+            break;
+
+        case GL_TEXTURE_COMPARE_FUNC:
+            *params = GL_LEQUAL;
+            break;
+
+        default:
+            *params = 0;
+            break;
+        }
+    }
+
+    static void APIENTRY GetSamplerParameterfv(GLuint sampler, GLenum pname, GLfloat* params)
+    {
+        CountQuery();
+
+        switch(pname)
+        {
+        case GL_TEXTURE_MIN_LOD:
+            *params = -1000.0f;
+            break;
+
+        case GL_TEXTURE_MAX_LOD:
+            *params = 1000.0f;
+            break;
+
+        default:
+            *params = 0.0f;
+            break;
+        }
+    }
+
+    static void APIENTRY PixelStorei(GLenum pname, GLint param)
+    {
+        switch(pname)
+        {
+        case GL_PACK_ALIGNMENT:
+            ChangeState(State().packAlignment, param);
+            break;
+
+        case GL_UNPACK_ALIGNMENT:
+            ChangeState(State().unpackAlignment, param);
+            break;
+
+        default:
+            Stats().stateChanges += 1;
+            break;
+        }
+
+        Recorder().Record(CommandRecorder::CommandType::PixelStorei, { Enum(pname), Integer(param) });
+    }
+
+    // Fixed function state.
+    static void APIENTRY Enable(GLenum cap)
+    {
+        ChangeState(State().capabilities[cap], static_cast<GLboolean>(GL_TRUE));
+        Recorder().Record(CommandRecorder::CommandType::Enable, { Enum(cap) });
+    }
+
+    static void APIENTRY Disable(GLenum cap)
+    {
+        ChangeState(State().capabilities[cap], static_cast<GLboolean>(GL_FALSE));
+        Recorder().Record(CommandRecorder::CommandType::Disable, { Enum(cap) });
+    }
+
+    static GLboolean APIENTRY IsEnabled(GLenum cap)
+    {
+        CountQuery();
+
+        auto it = State().capabilities.find(cap);
+        return it != State().capabilities.end() ? it->second : static_cast<GLboolean>(GL_FALSE);
+    }
+
+    static void APIENTRY UseProgram(GLuint program)
+    {
+        if(State().currentProgram != program)
+        {
+            Stats().programSwitches += 1;
+        }
+
+        ChangeState(State().currentProgram, program);
+        Recorder().Record(CommandRecorder::CommandType::UseProgram, { Integer(program) });
+    }
+
+    static void APIENTRY Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        ChangeState(State().viewport, { x, y, width, height });
+        Recorder().Record(CommandRecorder::CommandType::Viewport,
+            { Integer(x), Integer(y), Integer(width), Integer(height) });
+    }
+
+    static void APIENTRY Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        ChangeState(State().scissorBox, { x, y, width, height });
+        Recorder().Record(CommandRecorder::CommandType::Scissor,
+            { Integer(x), Integer(y), Integer(width), Integer(height) });
+    }
+
+    static void APIENTRY ClearDepthf(GLfloat d)
+    {
+        ChangeState(State().clearDepth, d);
+        Recorder().Record(CommandRecorder::CommandType::ClearDepthf, { Float(d) });
+    }
+
+    static void APIENTRY ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+    {
+        ChangeState(State().clearColor, { red, green, blue, alpha });
+        Recorder().Record(CommandRecorder::CommandType::ClearColor,
+            { Float(red), Float(green), Float(blue), Float(alpha) });
+    }
+
+    static void APIENTRY DepthMask(GLboolean flag)
+    {
+        ChangeState(State().depthMask, flag);
+        Recorder().Record(CommandRecorder::CommandType::DepthMask, { Integer(flag) });
+    }
+
+    static void APIENTRY BlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB,
+        GLenum sfactorAlpha, GLenum dfactorAlpha)
+    {
+        ChangeState(State().blendFunc, { sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha });
+        Recorder().Record(CommandRecorder::CommandType::BlendFuncSeparate,
+            { Enum(sfactorRGB), Enum(dfactorRGB), Enum(sfactorAlpha), Enum(dfactorAlpha) });
+    }
+
+    static void APIENTRY BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
+    {
+        ChangeState(State().blendEquation, { modeRGB, modeAlpha });
+        Recorder().Record(CommandRecorder::CommandType::BlendEquationSeparate,
+            { Enum(modeRGB), Enum(modeAlpha) });
+    }
+
+    // Drawing.
+    static void APIENTRY Clear(GLbitfield mask)
+    {
+        Recorder().Record(CommandRecorder::CommandType::Clear, { Enum(mask) });
+    }
+
+    static void APIENTRY DrawArrays(GLenum mode, GLint first, GLsizei count)
+    {
+        Stats().drawCalls += 1;
+        Stats().drawnInstances += 1;
+        Recorder().Record(CommandRecorder::CommandType::DrawArrays,
+            { Enum(mode), Integer(first), Integer(count) });
+    }
+
+    static void APIENTRY DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+    {
+        Stats().drawCalls += 1;
+        Stats().drawnInstances += instancecount;
+        Recorder().Record(CommandRecorder::CommandType::DrawArraysInstanced,
+            { Enum(mode), Integer(first), Integer(count), Integer(instancecount) });
+    }
+
+    static void APIENTRY DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+    {
+        Stats().drawCalls += 1;
+        Stats().drawnInstances += 1;
+        Recorder().Record(CommandRecorder::CommandType::DrawElements,
+            { Enum(mode), Integer(count), Enum(type), Integer(reinterpret_cast<intptr_t>(indices)) });
+    }
+
+    // State queries.
+    static GLenum APIENTRY GetError()
+    {
+        CountQuery();
+        return GL_NO_ERROR;
+    }
+
+    static void APIENTRY GetIntegerv(GLenum pname, GLint* data)
+    {
+        CountQuery();
+
+        const CommandRecorder::ContextState& state = State();
+
+        switch(pname)
+        {
+        case GL_VERTEX_ARRAY_BINDING:
+            *data = state.vertexArrayBinding;
+            break;
+
+        case GL_ARRAY_BUFFER_BINDING:
+            *data = state.arrayBufferBinding;
+            break;
+
+        case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+            *data = state.elementArrayBufferBinding;
+            break;
+
+        case GL_ACTIVE_TEXTURE:
+            *data = state.activeTexture;
+            break;
+
+        case GL_TEXTURE_BINDING_2D:
+            *data = state.textureBindings[state.GetActiveTextureUnit()];
+            break;
+
+        case GL_SAMPLER_BINDING:
+            *data = state.samplerBindings[state.GetActiveTextureUnit()];
+            break;
+
+        case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
+            *data = CommandRecorder::ContextState::TextureUnitCount;
+            break;
+
+        case GL_NUM_PROGRAM_BINARY_FORMATS:
+            *data = 1;
+            break;
+
+        case GL_PROGRAM_BINARY_FORMATS:
+            *data = RecordedProgramBinaryFormat;
+            break;
+
+        case GL_NUM_COMPRESSED_TEXTURE_FORMATS:
+            *data = static_cast<GLint>(Common::StaticArraySize(RecordedCompressedFormats));
+            break;
+
+        case GL_COMPRESSED_TEXTURE_FORMATS:
+            std::copy(std::begin(RecordedCompressedFormats), std::end(RecordedCompressedFormats), data);
+            break;
+
+        case GL_PACK_ALIGNMENT:
+            *data = state.packAlignment;
+            break;
+
+        case GL_UNPACK_ALIGNMENT:
+            *data = state.unpackAlignment;
+            break;
+
+        case GL_CURRENT_PROGRAM:
+            *data = state.currentProgram;
+            break;
+
+        case GL_VIEWPORT:
+            std::copy(state.viewport.begin(), state.viewport.end(), data);
+            break;
+
+        case GL_SCISSOR_BOX:
+            std::copy(state.scissorBox.begin(), state.scissorBox.end(), data);
+            break;
+
+        case GL_BLEND_SRC_RGB:
+            *data = state.blendFunc[0];
+            break;
+
+        case GL_BLEND_DST_RGB:
+            *data = state.blendFunc[1];
+            break;
+
+        case GL_BLEND_SRC_ALPHA:
+            *data = state.blendFunc[2];
+            break;
+
+        case GL_BLEND_DST_ALPHA:
+            *data = state.blendFunc[3];
+            break;
+
+        case GL_BLEND_EQUATION_RGB:
+            *data = state.blendEquation[0];
+            break;
+
+        case GL_BLEND_EQUATION_ALPHA:
+            *data = state.blendEquation[1];
+            break;
+
+        default:
+            *data = 0;
+            break;
+        }
+    }
+
+    static void APIENTRY GetFloatv(GLenum pname, GLfloat* data)
+    {
+        CountQuery();
+
+        switch(pname)
+        {
+        case GL_DEPTH_CLEAR_VALUE:
+            *data = State().clearDepth;
+            break;
+
+        case GL_COLOR_CLEAR_VALUE:
+            std::copy(State().clearColor.begin(), State().clearColor.end(), data);
+            break;
+
+        default:
+            *data = 0.0f;
+            break;
+        }
+    }
+
+    static void APIENTRY GetBooleanv(GLenum pname, GLboolean* data)
+    {
+        CountQuery();
+
+        switch(pname)
+        {
+        case GL_DEPTH_WRITEMASK:
+            *data = State().depthMask;
+            break;
+
+        default:
+            {
+                auto it = State().capabilities.find(pname);
+                *data = it != State().capabilities.end() ? it->second : static_cast<GLboolean>(GL_FALSE);
+            }
+            break;
+        }
+    }
+
+    template<typename Visitor>
+    static void ForEachEntry(Visitor&& visitor)
+    {
+        visitor(glad_glActiveTexture, &ActiveTexture);
+        visitor(glad_glAttachShader, &AttachShader);
+        visitor(glad_glBindBuffer, &BindBuffer);
+        visitor(glad_glBindSampler, &BindSampler);
+        visitor(glad_glBindTexture, &BindTexture);
+        visitor(glad_glBindVertexArray, &BindVertexArray);
+        visitor(glad_glBlendEquationSeparate, &BlendEquationSeparate);
+        visitor(glad_glBlendFuncSeparate, &BlendFuncSeparate);
+        visitor(glad_glBufferData, &BufferData);
+        visitor(glad_glClear, &Clear);
+        visitor(glad_glClearColor, &ClearColor);
+        visitor(glad_glClearDepthf, &ClearDepthf);
+        visitor(glad_glCompileShader, &CompileShader);
+        visitor(glad_glCompressedTexImage2D, &CompressedTexImage2D);
+        visitor(glad_glCreateProgram, &CreateProgram);
+        visitor(glad_glCreateShader, &CreateShader);
+        visitor(glad_glDeleteBuffers, &DeleteBuffers);
+        visitor(glad_glDeleteProgram, &DeleteProgram);
+        visitor(glad_glDeleteSamplers, &DeleteSamplers);
+        visitor(glad_glDeleteShader, &DeleteShader);
+        visitor(glad_glDeleteTextures, &DeleteTextures);
+        visitor(glad_glDeleteVertexArrays, &DeleteVertexArrays);
+        visitor(glad_glDepthMask, &DepthMask);
+        visitor(glad_glDetachShader, &DetachShader);
+        visitor(glad_glDisable, &Disable);
+        visitor(glad_glDrawArrays, &DrawArrays);
+        visitor(glad_glDrawArraysInstanced, &DrawArraysInstanced);
+        visitor(glad_glDrawElements, &DrawElements);
+        visitor(glad_glEnable, &Enable);
+        visitor(glad_glEnableVertexAttribArray, &EnableVertexAttribArray);
+        visitor(glad_glGenBuffers, &GenBuffers);
+        visitor(glad_glGenSamplers, &GenSamplers);
+        visitor(glad_glGenTextures, &GenTextures);
+        visitor(glad_glGenVertexArrays, &GenVertexArrays);
+        visitor(glad_glGenerateMipmap, &GenerateMipmap);
+        visitor(glad_glGetActiveUniform, &GetActiveUniform);
+        visitor(glad_glGetAttribLocation, &GetAttribLocation);
+        visitor(glad_glGetBooleanv, &GetBooleanv);
+        visitor(glad_glGetError, &GetError);
+        visitor(glad_glGetFloatv, &GetFloatv);
+        visitor(glad_glGetIntegerv, &GetIntegerv);
+        visitor(glad_glGetProgramInfoLog, &GetProgramInfoLog);
+        visitor(glad_glGetProgramBinary, &GetProgramBinary);
+        visitor(glad_glGetProgramiv, &GetProgramiv);
+        visitor(glad_glGetSamplerParameterfv, &GetSamplerParameterfv);
+        visitor(glad_glGetSamplerParameteriv, &GetSamplerParameteriv);
+        visitor(glad_glGetShaderInfoLog, &GetShaderInfoLog);
+        visitor(glad_glGetShaderiv, &GetShaderiv);
+        visitor(glad_glGetString, &GetString);
+        visitor(glad_glGetUniformLocation, &GetUniformLocation);
+        visitor(glad_glIsEnabled, &IsEnabled);
+        visitor(glad_glLinkProgram, &LinkProgram);
+        visitor(glad_glPixelStorei, &PixelStorei);
+        visitor(glad_glProgramBinary, &ProgramBinary);
+        visitor(glad_glProgramParameteri, &ProgramParameteri);
+        visitor(glad_glSamplerParameterf, &SamplerParameterf);
+        visitor(glad_glSamplerParameterfv, &SamplerParameterfv);
+        visitor(glad_glSamplerParameteri, &SamplerParameteri);
+        visitor(glad_glScissor, &Scissor);
+        visitor(glad_glShaderSource, &ShaderSource);
+        visitor(glad_glTexImage2D, &TexImage2D);
+        visitor(glad_glTexParameteri, &TexParameteri);
+        visitor(glad_glTexSubImage2D, &TexSubImage2D);
+        visitor(glad_glUniform1i, &Uniform1i);
+        visitor(glad_glUniform2fv, &Uniform2fv);
+        visitor(glad_glUniformMatrix4fv, &UniformMatrix4fv);
+        visitor(glad_glUseProgram, &UseProgram);
+        visitor(glad_glVertexAttribDivisor, &VertexAttribDivisor);
+        visitor(glad_glVertexAttribPointer, &VertexAttribPointer);
+        visitor(glad_glViewport, &Viewport);
+    }
+};
+
+CommandRecorder::CommandRecorder() :
+    m_contextState(std::make_unique<ContextState>())
+{
+}
+
+CommandRecorder::~CommandRecorder()
+{
+    Uninstall();
+}
+
+bool CommandRecorder::OnAttach(const Core::EngineSystemStorage& engineSystems)
+{
+    if(!Install())
+    {
+        LOG_ERROR(LogAttachFailed, "Could not install recording backend.");
+        return false;
+    }
+
+    return true;
+}
+
+void CommandRecorder::OnBeginFrame()
+{
+    if(m_engineFrames)
+    {
+        BeginFrame();
+    }
+}
+
+void CommandRecorder::OnEndFrame()
+{
+    if(m_engineFrames)
+    {
+        EndFrame();
+    }
+}
+
+bool CommandRecorder::Install()
+{
+    if(m_installed)
+        return true;
+
+    if(InstalledRecorder != nullptr)
+    {
+        LOG_ERROR("Another command recorder is already installed!");
+        return false;
+    }
+
+    // Swap GL entry points with recording functions and save previous ones.
+    m_savedDispatch.clear();
+    CommandRecorderDispatch::ForEachEntry([this](auto& entry, auto function)
+    {
+        m_savedDispatch.push_back(reinterpret_cast<void*>(entry));
+        entry = function;
+    });
+
+    InstalledRecorder = this;
+    m_installed = true;
+
+    LOG_INFO("Installed recording OpenGL backend.");
+    return true;
+}
+
+void CommandRecorder::Uninstall()
+{
+    if(!m_installed)
+        return;
+
+    // Restore previously saved GL entry points.
+    ASSERT(InstalledRecorder == this);
+    std::size_t entryIndex = 0;
+    CommandRecorderDispatch::ForEachEntry([this, &entryIndex](auto& entry, auto function)
+    {
+        using EntryType = std::remove_reference_t<decltype(entry)>;
+        entry = reinterpret_cast<EntryType>(m_savedDispatch[entryIndex++]);
+    });
+
+    ASSERT(entryIndex == m_savedDispatch.size());
+    m_savedDispatch.clear();
+
+    InstalledRecorder = nullptr;
+    m_installed = false;
+}
+
+void CommandRecorder::BeginFrame()
+{
+    ClearCommands();
+    m_frameStats = FrameStats();
+}
+
+void CommandRecorder::EndFrame()
+{
+    m_lastFrameStats = m_frameStats;
+}
+
+void CommandRecorder::ClearCommands()
+{
+    m_commands.clear();
+    m_arguments.clear();
+}
+
+void CommandRecorder::SetRecordingCommands(bool enabled)
+{
+    // Stats are still collected when command stream is not recorded.
+    m_recordingCommands = enabled;
+}
+
+void CommandRecorder::SetEngineFrames(bool enabled)
+{
+    // Render thread delimits recorded frames itself, as engine frames run on game thread.
+    m_engineFrames = enabled;
+}
+
+void CommandRecorder::Record(CommandType type, std::initializer_list<Argument> arguments)
+{
+    m_frameStats.commandCount += 1;
+
+    if(!m_recordingCommands)
+        return;
+
+    Command& command = m_commands.emplace_back();
+    command.type = type;
+    command.argumentOffset = static_cast<uint32_t>(m_arguments.size());
+    command.argumentCount = static_cast<uint32_t>(arguments.size());
+    m_arguments.insert(m_arguments.end(), arguments);
+}
+
+std::string CommandRecorder::FormatCommand(const Command& command) const
+{
+    ASSERT(command.argumentOffset + command.argumentCount <= m_arguments.size());
+
+    std::string text = GetCommandName(command.type);
+    text += "(";
+
+    for(uint32_t i = 0; i < command.argumentCount; ++i)
+    {
+        const Argument& argument = m_arguments[command.argumentOffset + i];
+
+        if(i != 0)
+        {
+            text += ", ";
+        }
+
+        switch(argument.type)
+        {
+        case ArgumentType::Integer:
+            text += fmt::format("{}", argument.integer);
+            break;
+
+        case ArgumentType::Enum:
+            text += fmt::format("{:#06x}", argument.integer);
+            break;
+
+        case ArgumentType::Float:
+            text += fmt::format("{}", argument.real);
+            break;
+        }
+    }
+
+    text += ")";
+    return text;
+}
+
+std::string CommandRecorder::FormatCommands() const
+{
+    std::string text;
+    for(const Command& command : m_commands)
+    {
+        text += FormatCommand(command);
+        text += "\n";
+    }
+
+    return text;
+}
+
+const char* CommandRecorder::GetCommandName(CommandType type)
+{
+    const std::size_t index = static_cast<std::size_t>(type);
+    ASSERT(index < Common::StaticArraySize(CommandNames), "Invalid command type!");
+    return index < Common::StaticArraySize(CommandNames) ? CommandNames[index] : "Invalid";
+}
+
+CommandRecorder* CommandRecorder::GetInstalled()
+{
+    return InstalledRecorder;
+}
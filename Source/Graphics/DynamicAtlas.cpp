@@ -0,0 +1,473 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Graphics/Precompiled.hpp"
+#include "Graphics/DynamicAtlas.hpp"
+#include "Graphics/RenderContext.hpp"
+#include "Graphics/Texture.hpp"
+#include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
+using namespace Graphics;
+
+namespace
+{
+    const char* LogAttachFailed = "Failed to attach dynamic atlas! {}";
+
+    const int PageChannels = 4;
+}
+
+glm::vec4 AtlasRegion::MapTextureRect(const glm::vec4& textureRect) const
+{
+    // Transform rectangle from texture space to region of atlas page.
+    const glm::vec2 offset(m_textureRect.x, m_textureRect.y);
+    const glm::vec2 scale(m_textureRect.z - m_textureRect.x, m_textureRect.w - m_textureRect.y);
+
+    glm::vec4 pageRect;
+    pageRect.x = offset.x + textureRect.x * scale.x;
+    pageRect.y = offset.y + textureRect.y * scale.y;
+    pageRect.z = offset.x + textureRect.z * scale.x;
+    pageRect.w = offset.y + textureRect.w * scale.y;
+    return pageRect;
+}
+
+std::vector<uint8_t> AtlasRegion::CopyPixels(int channels) const
+{
+    ASSERT(channels == 3 || channels == PageChannels, "Unexpected number of region channels!");
+
+    // Strip padding and alpha channel that page format added.
+    const int width = m_paddedWidth - m_padding * 2;
+    const int height = m_paddedHeight - m_padding * 2;
+    std::vector<uint8_t> pixels(static_cast<std::size_t>(width) * height * channels);
+
+    for(int y = 0; y < height; ++y)
+    {
+        const uint8_t* sourceRow = &m_pixels[(static_cast<std::size_t>(y + m_padding) *
+            m_paddedWidth + m_padding) * PageChannels];
+        uint8_t* row = &pixels[static_cast<std::size_t>(y) * width * channels];
+
+        for(int x = 0; x < width; ++x)
+        {
+            std::memcpy(&row[x * channels], &sourceRow[x * PageChannels], channels);
+        }
+    }
+
+    return pixels;
+}
+
+DynamicAtlas::DynamicAtlas() = default;
+DynamicAtlas::~DynamicAtlas() = default;
+
+bool DynamicAtlas::OnAttach(const Core::EngineSystemStorage& engineSystems)
+{
+    // Locate needed engine systems.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(configSystem == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate config system.");
+        return false;
+    }
+
+    m_renderContext = engineSystems.Locate<Graphics::RenderContext>();
+    if(m_renderContext == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate render context.");
+        return false;
+    }
+
+    // Read atlas configuration.
+    m_enabled = configSystem->Get<bool>(
+        NAME_CONSTEXPR("render.dynamicAtlas")).UnwrapOr(m_enabled);
+    m_pageSize = configSystem->Get<int>(
+        NAME_CONSTEXPR("render.atlasPageSize")).UnwrapOr(m_pageSize);
+    m_maxRegionSize = configSystem->Get<int>(
+        NAME_CONSTEXPR("render.atlasMaxRegionSize")).UnwrapOr(m_maxRegionSize);
+    m_padding = configSystem->Get<int>(
+        NAME_CONSTEXPR("render.atlasPadding")).UnwrapOr(m_padding);
+    m_maxPages = configSystem->Get<std::size_t>(
+        NAME_CONSTEXPR("render.atlasMaxPages")).UnwrapOr(m_maxPages);
+
+    if(m_pageSize <= 0 || m_maxRegionSize <= 0 || m_padding < 0 || m_maxPages == 0)
+    {
+        LOG_ERROR(LogAttachFailed, "Invalid atlas configuration.");
+        return false;
+    }
+
+    // Largest region with its padding must always fit into empty page.
+    m_maxRegionSize = std::min(m_maxRegionSize, m_pageSize - m_padding * 2);
+
+    if(!m_enabled)
+    {
+        LOG_INFO("Dynamic atlas is disabled.");
+    }
+
+    return true;
+}
+
+bool DynamicAtlas::CanInsert(int width, int height, int channels) const
+{
+    return m_enabled && (channels == 3 || channels == 4) &&
+        width > 0 && height > 0 && width <= m_maxRegionSize && height <= m_maxRegionSize;
+}
+
+DynamicAtlas::RegionPtr DynamicAtlas::Insert(const uint8_t* pixels, int width, int height, int channels)
+{
+    ASSERT_ALWAYS_ARGUMENT(pixels != nullptr);
+
+    if(!CanInsert(width, height, channels))
+        return nullptr;
+
+    LOG_PROFILE_SCOPE("Insert dynamic atlas region");
+
+    // Convert pixels to format of atlas pages.
+    std::vector<uint8_t> convertedPixels;
+    const uint8_t* pagePixels = pixels;
+
+    if(channels != PageChannels)
+    {
+        const std::size_t pixelCount = static_cast<std::size_t>(width) * height;
+        convertedPixels.resize(pixelCount * PageChannels);
+
+        for(std::size_t i = 0; i < pixelCount; ++i)
+        {
+            std::memcpy(&convertedPixels[i * PageChannels], &pixels[i * channels], channels);
+            convertedPixels[i * PageChannels + 3] = 255;
+        }
+
+        pagePixels = convertedPixels.data();
+    }
+
+    // Keep padded copy of pixels, which is also used when region is moved.
+    auto region = std::make_shared<AtlasRegion>();
+    region->m_paddedWidth = width + m_padding * 2;
+    region->m_paddedHeight = height + m_padding * 2;
+    region->m_padding = m_padding;
+    region->m_pixels.resize(static_cast<std::size_t>(region->m_paddedWidth) *
+        region->m_paddedHeight * PageChannels);
+
+    AtlasPacker::CopyPadded(pagePixels, width, height, PageChannels,
+        m_padding, AtlasPacker::BleedPolicy::Extrude, region->m_pixels.data());
+
+    // Find space in existing pages first.
+    EvictUnused();
+
+    auto PlaceInPages = [this, &region, width, height]()
+    {
+        for(auto& page : m_pages)
+        {
+            if(std::optional<glm::ivec4> pixelRect = page->packer->Allocate(width, height))
+            {
+                AssignRegion(*page, region, *pixelRect);
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    if(PlaceInPages())
+    {
+        m_stats.packedRegions += 1;
+        return region;
+    }
+
+    // Reclaim space of released regions when new page cannot be added.
+    if(m_pages.size() >= m_maxPages && Defragment() && PlaceInPages())
+    {
+        m_stats.packedRegions += 1;
+        return region;
+    }
+
+    if(m_pages.size() >= m_maxPages)
+    {
+        m_stats.rejectedRegions += 1;
+        return nullptr;
+    }
+
+    std::unique_ptr<Page> page = CreatePage();
+    if(page == nullptr)
+    {
+        m_stats.rejectedRegions += 1;
+        return nullptr;
+    }
+
+    m_pages.push_back(std::move(page));
+
+    if(!PlaceInPages())
+    {
+        ASSERT(false, "Region does not fit into empty page!");
+        m_stats.rejectedRegions += 1;
+        return nullptr;
+    }
+
+    m_stats.packedRegions += 1;
+    return region;
+}
+
+void DynamicAtlas::Release(const RegionPtr& region)
+{
+    ASSERT_ALWAYS_ARGUMENT(region != nullptr);
+
+    // Forget region right away, so its space can be reclaimed while texture is still alive.
+    for(auto& page : m_pages)
+    {
+        if(page->texture != region->m_page)
+            continue;
+
+        page->regions.erase(std::remove_if(page->regions.begin(), page->regions.end(),
+            [&region](const RegionWeakPtr& pageRegion)
+            {
+                return pageRegion.lock() == region;
+            }), page->regions.end());
+    }
+
+    // Texture views that resolved region must stop drawing from it.
+    m_layoutVersion += 1;
+}
+
+void DynamicAtlas::EvictUnused()
+{
+    for(auto it = m_pages.begin(); it != m_pages.end();)
+    {
+        Page& page = **it;
+
+        // Forget regions whose textures have been destroyed.
+        page.regions.erase(std::remove_if(page.regions.begin(), page.regions.end(),
+            [](const RegionWeakPtr& region)
+            {
+                return region.expired();
+            }), page.regions.end());
+
+        // Page texture is released once frame packets referencing it are done with it.
+        if(page.regions.empty())
+        {
+            it = m_pages.erase(it);
+            m_stats.evictedPages += 1;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+bool DynamicAtlas::Defragment()
+{
+    LOG_PROFILE_SCOPE("Defragment dynamic atlas");
+
+    EvictUnused();
+
+    // Gather live regions, there is nothing to reclaim if no region has been released.
+    std::vector<std::shared_ptr<AtlasRegion>> regions;
+    int64_t allocatedArea = 0;
+    int64_t regionArea = 0;
+
+    for(auto& page : m_pages)
+    {
+        allocatedArea += page->packer->GetAllocatedArea();
+
+        for(const RegionWeakPtr& weakRegion : page->regions)
+        {
+            if(auto region = weakRegion.lock())
+            {
+                regionArea += static_cast<int64_t>(region->m_paddedWidth) * region->m_paddedHeight;
+                regions.push_back(std::move(region));
+            }
+        }
+    }
+
+    if(regionArea == allocatedArea)
+        return false;
+
+    // Skyline packs tallest regions first most tightly.
+    std::sort(regions.begin(), regions.end(), [](const auto& left, const auto& right)
+    {
+        if(left->m_paddedHeight != right->m_paddedHeight)
+            return left->m_paddedHeight > right->m_paddedHeight;
+
+        return left->m_paddedWidth > right->m_paddedWidth;
+    });
+
+    // Lay out regions before creating any page, so failure leaves atlas intact.
+    // Old pages are kept alive until repack completes, so number of new pages is limited too.
+    std::vector<std::unique_ptr<AtlasPacker>> packers;
+    std::vector<std::pair<std::size_t, glm::ivec4>> placements;
+    placements.reserve(regions.size());
+
+    for(const auto& region : regions)
+    {
+        const int width = region->m_paddedWidth - m_padding * 2;
+        const int height = region->m_paddedHeight - m_padding * 2;
+
+        // Try earlier pages first, as smaller regions can still fill their gaps.
+        std::size_t packerIndex = 0;
+        std::optional<glm::ivec4> pixelRect;
+
+        for(; packerIndex < packers.size(); ++packerIndex)
+        {
+            pixelRect = packers[packerIndex]->Allocate(width, height);
+            if(pixelRect)
+                break;
+        }
+
+        if(!pixelRect)
+        {
+            if(packers.size() >= m_maxPages)
+            {
+                LOG_WARNING("Could not defragment dynamic atlas within {} pages!", m_maxPages);
+                return false;
+            }
+
+            std::unique_ptr<AtlasPacker> packer = CreatePacker();
+            if(packer == nullptr)
+                return false;
+
+            packers.push_back(std::move(packer));
+            pixelRect = packers.back()->Allocate(width, height);
+            ASSERT(pixelRect, "Region does not fit into empty page!");
+        }
+
+        placements.emplace_back(packerIndex, *pixelRect);
+    }
+
+    std::vector<std::unique_ptr<Page>> newPages;
+    for(auto& packer : packers)
+    {
+        auto page = std::make_unique<Page>();
+        page->texture = CreatePageTexture();
+        page->packer = std::move(packer);
+
+        if(page->texture == nullptr)
+        {
+            LOG_ERROR("Could not create page for defragmented atlas!");
+            return false;
+        }
+
+        newPages.push_back(std::move(page));
+    }
+
+    // Move regions to their new pages.
+    for(std::size_t i = 0; i < regions.size(); ++i)
+    {
+        AssignRegion(*newPages[placements[i].first], regions[i], placements[i].second);
+    }
+
+    m_stats.evictedPages += m_pages.size();
+    m_stats.movedRegions += regions.size();
+    m_stats.defragmentations += 1;
+    m_pages = std::move(newPages);
+    m_layoutVersion += 1;
+
+    LOG_INFO("Defragmented dynamic atlas by repacking {} regions into {} pages.",
+        regions.size(), m_pages.size());
+
+    return true;
+}
+
+DynamicAtlas::Stats DynamicAtlas::GetStats() const
+{
+    Stats stats = m_stats;
+    stats.pageCount = m_pages.size();
+    stats.pageArea = static_cast<int64_t>(m_pages.size()) * m_pageSize * m_pageSize;
+
+    for(const auto& page : m_pages)
+    {
+        for(const RegionWeakPtr& weakRegion : page->regions)
+        {
+            if(auto region = weakRegion.lock())
+            {
+                stats.regionCount += 1;
+                stats.regionArea += static_cast<int64_t>(region->m_paddedWidth) *
+                    region->m_paddedHeight;
+            }
+        }
+    }
+
+    return stats;
+}
+
+void DynamicAtlas::UpdateMipmaps()
+{
+    // Regenerate mip chain once per page, however many regions were inserted into it.
+    for(auto& page : m_pages)
+    {
+        if(page->mipmapsDirty)
+        {
+            page->texture->GenerateMipmaps();
+            page->mipmapsDirty = false;
+        }
+    }
+}
+
+std::unique_ptr<DynamicAtlas::Page> DynamicAtlas::CreatePage() const
+{
+    auto page = std::make_unique<Page>();
+
+    page->texture = CreatePageTexture();
+    if(page->texture == nullptr)
+        return nullptr;
+
+    page->packer = CreatePacker();
+    if(page->packer == nullptr)
+        return nullptr;
+
+    return page;
+}
+
+DynamicAtlas::TexturePtr DynamicAtlas::CreatePageTexture() const
+{
+    LOG_PROFILE_SCOPE("Create dynamic atlas page");
+
+    // Clear page, as unused space is averaged into lower mip levels.
+    std::vector<uint8_t> clearPixels(
+        static_cast<std::size_t>(m_pageSize) * m_pageSize * PageChannels, 0);
+
+    Texture::CreateFromParams textureParams;
+    textureParams.renderContext = m_renderContext;
+    textureParams.format = GL_RGBA;
+    textureParams.width = m_pageSize;
+    textureParams.height = m_pageSize;
+    textureParams.mipmaps = true;
+    textureParams.data = clearPixels.data();
+
+    TexturePtr texture = Texture::Create(textureParams).UnwrapOr(nullptr);
+    if(texture == nullptr)
+    {
+        LOG_ERROR("Could not create dynamic atlas page texture!");
+        return nullptr;
+    }
+
+    return texture;
+}
+
+std::unique_ptr<AtlasPacker> DynamicAtlas::CreatePacker() const
+{
+    AtlasPacker::CreateFromParams packerParams;
+    packerParams.width = m_pageSize;
+    packerParams.height = m_pageSize;
+    packerParams.padding = m_padding;
+
+    std::unique_ptr<AtlasPacker> packer = AtlasPacker::Create(packerParams).UnwrapOr(nullptr);
+    if(packer == nullptr)
+    {
+        LOG_ERROR("Could not create dynamic atlas page packer!");
+        return nullptr;
+    }
+
+    return packer;
+}
+
+void DynamicAtlas::AssignRegion(Page& page, const std::shared_ptr<AtlasRegion>& region, glm::ivec4 pixelRect)
+{
+    // Page rows are stored bottom to top like loaded images, so pixel and texture space match.
+    region->m_page = page.texture;
+    region->m_pixelRect = pixelRect;
+    region->m_textureRect = glm::vec4(pixelRect) / static_cast<float>(m_pageSize);
+    page.regions.push_back(region);
+    page.mipmapsDirty = true;
+
+    page.texture->UpdateRegion(region->m_pixels.data(),
+        pixelRect.x - m_padding, pixelRect.y - m_padding,
+        region->m_paddedWidth, region->m_paddedHeight);
+}
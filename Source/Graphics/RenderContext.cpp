@@ -6,6 +6,7 @@
 #include "Graphics/Precompiled.hpp"
 #include "Graphics/RenderContext.hpp"
 #include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
 #include <System/Window.hpp>
 using namespace Graphics;
 
@@ -15,6 +16,13 @@ RenderContext::~RenderContext() = default;
 bool RenderContext::OnAttach(const Core::EngineSystemStorage& engineSystems)
 {
     // Retrieve needed engine systems.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(!configSystem)
+    {
+        LOG_ERROR("Failed to locate config system!");
+        return false;
+    }
+
     m_window = engineSystems.Locate<System::Window>();
     if(!m_window)
     {
@@ -28,26 +36,79 @@ bool RenderContext::OnAttach(const Core::EngineSystemStorage& engineSystems)
     m_window->MakeContextCurrent();
     m_currentState.Save();
 
+    // Query compressed texture formats supported by context.
+    GLint compressedFormatCount = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &compressedFormatCount);
+    OpenGL::CheckErrors();
+
+    if(compressedFormatCount > 0)
+    {
+        std::vector<GLint> compressedFormats(compressedFormatCount);
+        glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, compressedFormats.data());
+        OpenGL::CheckErrors();
+
+        m_compressedFormats.assign(compressedFormats.begin(), compressedFormats.end());
+    }
+
+    // Error checks are expensive and disabled by default in release builds.
+    OpenGL::SetErrorChecks(configSystem->Get<bool>(
+        NAME_CONSTEXPR("render.checkErrors")).UnwrapOr(OpenGL::DefaultErrorChecks));
+
     return true;
 }
 
+bool RenderContext::IsCompressedFormatSupported(GLenum format) const
+{
+    return std::find(m_compressedFormats.begin(), m_compressedFormats.end(),
+        format) != m_compressedFormats.end();
+}
+
 void RenderContext::MakeCurrent()
 {
     m_window->MakeContextCurrent();
 }
 
+void RenderContext::AcquireContext()
+{
+    if(m_acquireCallback)
+    {
+        m_acquireCallback();
+    }
+}
+
+void RenderContext::SetAcquireCallback(AcquireCallback callback)
+{
+    m_acquireCallback = std::move(callback);
+}
+
 RenderState& RenderContext::PushState()
 {
-    // Push copy of current state.
-    m_pushedStates.push(m_currentState);
+    // Push copy of current state, reusing storage of previously popped states.
+    if(m_pushedStateCount == m_pushedStates.size())
+    {
+        m_pushedStates.push_back(m_currentState);
+    }
+    else
+    {
+        m_pushedStates[m_pushedStateCount] = m_currentState;
+    }
+
+    m_pushedStateCount += 1;
+
+    // Track groups changed from now on.
+    m_currentState.SetDirtyGroups(StateGroups::None);
     return m_currentState;
 }
 
 void RenderContext::PopState()
 {
-    ASSERT(!m_pushedStates.empty(), "Trying to pop non existing render state!");
+    ASSERT(m_pushedStateCount != 0, "Trying to pop non existing render state!");
 
-    // Discard current state and apply last pushed state.
-    m_currentState.Apply(m_pushedStates.top());
-    m_pushedStates.pop();
+    // Discard current state and apply last pushed state only for groups that were changed.
+    // Restored groups match pushed state, so dirty groups of pushed state are carried over
+    // for state that may have been pushed before it.
+    const RenderState& pushedState = m_pushedStates[m_pushedStateCount - 1];
+    m_currentState.Apply(pushedState, m_currentState.GetDirtyGroups());
+    m_currentState.SetDirtyGroups(pushedState.GetDirtyGroups());
+    m_pushedStateCount -= 1;
 }
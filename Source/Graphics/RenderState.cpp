@@ -7,8 +7,53 @@
 #include "Graphics/RenderState.hpp"
 using namespace Graphics;
 
+namespace
+{
+    bool ErrorChecksEnabled = OpenGL::DefaultErrorChecks;
+
+    template<typename Array, std::size_t Count, typename IndexFunction>
+    constexpr bool ValidateIndices(const Array (&values)[Count], IndexFunction getIndex)
+    {
+        for(std::size_t i = 0; i < Count; ++i)
+        {
+            if(getIndex(values[i]) != i)
+                return false;
+        }
+
+        return true;
+    }
+
+    constexpr GLenum GetTarget(const std::tuple<GLenum, GLenum>& binding)
+    {
+        return std::get<0>(binding);
+    }
+
+    static_assert(ValidateIndices(OpenGL::Capabilities, [](GLenum cap) constexpr
+        { return OpenGL::GetCapabilityIndex(cap); }), "Capability indices do not match!");
+    static_assert(ValidateIndices(OpenGL::BufferBindingTargets, [](const auto& binding) constexpr
+        { return OpenGL::GetBufferBindingTargetIndex(GetTarget(binding)); }), "Buffer target indices do not match!");
+    static_assert(ValidateIndices(OpenGL::TextureBindingTargets, [](const auto& binding) constexpr
+        { return OpenGL::GetTextureBindingTargetIndex(GetTarget(binding)); }), "Texture target indices do not match!");
+    static_assert(ValidateIndices(OpenGL::PixelStoreParameters, [](GLenum pname) constexpr
+        { return OpenGL::GetPixelStoreParameterIndex(pname); }), "Pixel store indices do not match!");
+}
+
+void OpenGL::SetErrorChecks(bool enabled)
+{
+    ErrorChecksEnabled = enabled;
+}
+
+bool OpenGL::AreErrorChecksEnabled()
+{
+    return ErrorChecksEnabled;
+}
+
 bool OpenGL::CheckErrors()
 {
+    // Querying errors forces synchronization with driver.
+    if(!ErrorChecksEnabled)
+        return false;
+
     bool errorFound = false;
 
     GLenum error = GL_NO_ERROR;
@@ -200,100 +245,132 @@ void RenderState::Save()
     m_scissorBox = std::tie(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
 }
 
-void RenderState::Apply(RenderState& other)
+void RenderState::Apply(const RenderState& other, StateGroups::Type groups)
 {
-    // glEnable
-    for(std::size_t i = 0; i < OpenGL::CapabilityCount; ++i)
+    // Only groups that could differ are compared, with each
+    // state still skipping its call if value already matches.
+    if(groups & StateGroups::Capabilities)
     {
-        if(other.m_capabilities[i] == GL_TRUE)
-        {
-            Enable(OpenGL::Capabilities[i]);
-        }
-        else
+        for(std::size_t i = 0; i < OpenGL::CapabilityCount; ++i)
         {
-            Disable(OpenGL::Capabilities[i]);
+            if(other.m_capabilities[i] == GL_TRUE)
+            {
+                Enable(OpenGL::Capabilities[i]);
+            }
+            else
+            {
+                Disable(OpenGL::Capabilities[i]);
+            }
         }
     }
 
-    // glBindVertexArray
-    BindVertexArray(other.m_vertexArrayBinding);
-
-    // glBindBuffer
-    for(std::size_t i = 0; i < OpenGL::BufferBindingTargetCount; ++i)
+    if(groups & StateGroups::VertexArray)
     {
-        BindBuffer(std::get<0>(OpenGL::BufferBindingTargets[i]), other.m_bufferBindings[i]);
+        BindVertexArray(other.m_vertexArrayBinding);
     }
 
-    // glActiveTexture
-    ActiveTexture(other.m_activeTexture);
+    if(groups & StateGroups::BufferBindings)
+    {
+        for(std::size_t i = 0; i < OpenGL::BufferBindingTargetCount; ++i)
+        {
+            BindBuffer(std::get<0>(OpenGL::BufferBindingTargets[i]), other.m_bufferBindings[i]);
+        }
+    }
 
-    // glBindTexture
-    for(std::size_t i = 0; i < OpenGL::TextureBindingTargetCount; ++i)
+    if(groups & StateGroups::ActiveTexture)
     {
-        BindTexture(std::get<0>(OpenGL::TextureBindingTargets[i]), other.m_textureBindings[i]);
+        ActiveTexture(other.m_activeTexture);
     }
 
-    // glBindSampler
-    ASSERT(m_samplerBindings.size() == other.m_samplerBindings.size(), 
-        "Different sampler binding array sizes between states!");
+    if(groups & StateGroups::TextureBindings)
+    {
+        for(std::size_t i = 0; i < OpenGL::TextureBindingTargetCount; ++i)
+        {
+            BindTexture(std::get<0>(OpenGL::TextureBindingTargets[i]), other.m_textureBindings[i]);
+        }
+    }
 
-    for(std::size_t i = 0; i < m_samplerBindings.size(); ++i)
+    if(groups & StateGroups::SamplerBindings)
     {
-        BindSampler(Common::NumericalCast<GLuint>(i), other.m_samplerBindings[i]);
+        ASSERT(m_samplerBindings.size() == other.m_samplerBindings.size(),
+            "Different sampler binding array sizes between states!");
+
+        for(std::size_t i = 0; i < m_samplerBindings.size(); ++i)
+        {
+            BindSampler(Common::NumericalCast<GLuint>(i), other.m_samplerBindings[i]);
+        }
     }
 
-    // glPixelStore
-    for(std::size_t i = 0; i < OpenGL::PixelStoreParameterCount; ++i)
+    if(groups & StateGroups::PixelStore)
     {
-        PixelStore(OpenGL::PixelStoreParameters[i], other.m_pixelStore[i]);
+        for(std::size_t i = 0; i < OpenGL::PixelStoreParameterCount; ++i)
+        {
+            PixelStore(OpenGL::PixelStoreParameters[i], other.m_pixelStore[i]);
+        }
     }
 
-    // glUseProgram
-    UseProgram(other.m_currentProgram);
+    if(groups & StateGroups::Program)
+    {
+        UseProgram(other.m_currentProgram);
+    }
 
-    // glViewport
-    Viewport(
-        std::get<0>(other.m_viewport),
-        std::get<1>(other.m_viewport),
-        std::get<2>(other.m_viewport),
-        std::get<3>(other.m_viewport)
-    );
+    if(groups & StateGroups::Viewport)
+    {
+        Viewport(
+            std::get<0>(other.m_viewport),
+            std::get<1>(other.m_viewport),
+            std::get<2>(other.m_viewport),
+            std::get<3>(other.m_viewport)
+        );
+    }
 
-    // glClearDepth
-    ClearDepth(other.m_clearDepth);
+    if(groups & StateGroups::ClearDepth)
+    {
+        ClearDepth(other.m_clearDepth);
+    }
 
-    // glClearColor
-    ClearColor(
-        std::get<0>(other.m_clearColor),
-        std::get<1>(other.m_clearColor),
-        std::get<2>(other.m_clearColor),
-        std::get<3>(other.m_clearColor)
-    );
+    if(groups & StateGroups::ClearColor)
+    {
+        ClearColor(
+            std::get<0>(other.m_clearColor),
+            std::get<1>(other.m_clearColor),
+            std::get<2>(other.m_clearColor),
+            std::get<3>(other.m_clearColor)
+        );
+    }
 
-    // glDepthMask
-    DepthMask(other.m_depthMask);
+    if(groups & StateGroups::DepthMask)
+    {
+        DepthMask(other.m_depthMask);
+    }
 
-    // glBlendFuncSeparate
-    BlendFuncSeparate(
-        std::get<0>(other.m_blendFuncSeparate),
-        std::get<1>(other.m_blendFuncSeparate),
-        std::get<2>(other.m_blendFuncSeparate),
-        std::get<3>(other.m_blendFuncSeparate)
-    );
+    if(groups & StateGroups::BlendFunc)
+    {
+        BlendFuncSeparate(
+            std::get<0>(other.m_blendFuncSeparate),
+            std::get<1>(other.m_blendFuncSeparate),
+            std::get<2>(other.m_blendFuncSeparate),
+            std::get<3>(other.m_blendFuncSeparate)
+        );
+    }
 
-    // glBlendEquationSeparate
-    BlendEquationSeparate(
-        std::get<0>(other.m_blendEquationSeparate),
-        std::get<1>(other.m_blendEquationSeparate)
-    );
+    if(groups & StateGroups::BlendEquation)
+    {
+        BlendEquationSeparate(
+            std::get<0>(other.m_blendEquationSeparate),
+            std::get<1>(other.m_blendEquationSeparate)
+        );
+    }
 
-    // glScissor
-    Scissor(
-        std::get<0>(other.m_scissorBox),
-        std::get<1>(other.m_scissorBox),
-        std::get<2>(other.m_scissorBox),
-        std::get<3>(other.m_scissorBox)
-    );
+    if(groups & StateGroups::Scissor)
+    {
+        Scissor(
+            std::get<0>(other.m_scissorBox),
+            std::get<1>(other.m_scissorBox),
+            std::get<2>(other.m_scissorBox),
+            std::get<3>(other.m_scissorBox)
+        );
+    }
 }
 
 void RenderState::Enable(GLenum cap)
@@ -306,14 +383,12 @@ void RenderState::Enable(GLenum cap)
     glEnable(cap);
     OpenGL::CheckErrors();
 
-    // Save changed state.
-    for(std::size_t i = 0; i < OpenGL::CapabilityCount; ++i)
+    // Save changed state, which is not tracked for unsupported enums.
+    const std::size_t index = OpenGL::GetCapabilityIndex(cap);
+    if(index < OpenGL::CapabilityCount)
     {
-        if(OpenGL::Capabilities[i] == cap)
-        {
-            m_capabilities[i] = GL_TRUE;
-            break;
-        }
+        m_capabilities[index] = GL_TRUE;
+        m_dirtyGroups |= StateGroups::Capabilities;
     }
 }
 
@@ -327,27 +402,25 @@ void RenderState::Disable(GLenum cap)
     glDisable(cap);
     OpenGL::CheckErrors();
 
-    // Save changed state.
-    for(std::size_t i = 0; i < OpenGL::CapabilityCount; ++i)
+    // Save changed state, which is not tracked for unsupported enums.
+    const std::size_t index = OpenGL::GetCapabilityIndex(cap);
+    if(index < OpenGL::CapabilityCount)
     {
-        if(OpenGL::Capabilities[i] == cap)
-        {
-            m_capabilities[i] = GL_FALSE;
-            break;
-        }
+        m_capabilities[index] = GL_FALSE;
+        m_dirtyGroups |= StateGroups::Capabilities;
     }
 }
 
 GLboolean RenderState::IsEnabled(GLenum cap) const
 {
-    for(std::size_t i = 0; i < OpenGL::CapabilityCount; ++i)
+    const std::size_t index = OpenGL::GetCapabilityIndex(cap);
+    if(index >= OpenGL::CapabilityCount)
     {
-        if(OpenGL::Capabilities[i] == cap)
-            return m_capabilities[i];
+        ASSERT(false, "Unsupported capability!");
+        return GL_FALSE;
     }
 
-    ASSERT(false, "Unsupported capability!");
-    return GL_FALSE;
+    return m_capabilities[index];
 }
 
 void RenderState::BindVertexArray(GLuint array)
@@ -362,6 +435,7 @@ void RenderState::BindVertexArray(GLuint array)
 
     // Save changed state.
     m_vertexArrayBinding = array;
+    m_dirtyGroups |= StateGroups::VertexArray;
 }
 
 GLuint RenderState::GetVertexArrayBinding() const
@@ -379,27 +453,25 @@ void RenderState::BindBuffer(GLenum target, GLuint buffer)
     glBindBuffer(target, buffer);
     OpenGL::CheckErrors();
 
-    // Save changed state.
-    for(std::size_t i = 0; i < OpenGL::BufferBindingTargetCount; ++i)
+    // Save changed state, which is not tracked for unsupported enums.
+    const std::size_t index = OpenGL::GetBufferBindingTargetIndex(target);
+    if(index < OpenGL::BufferBindingTargetCount)
     {
-        if(std::get<0>(OpenGL::BufferBindingTargets[i]) == target)
-        {
-            m_bufferBindings[i] = buffer;
-            break;
-        }
+        m_bufferBindings[index] = buffer;
+        m_dirtyGroups |= StateGroups::BufferBindings;
     }
 }
 
 GLuint RenderState::GetBufferBinding(GLenum target) const
 {
-    for(std::size_t i = 0; i < OpenGL::BufferBindingTargetCount; ++i)
+    const std::size_t index = OpenGL::GetBufferBindingTargetIndex(target);
+    if(index >= OpenGL::BufferBindingTargetCount)
     {
-        if(std::get<0>(OpenGL::BufferBindingTargets[i]) == target)
-            return m_bufferBindings[i];
+        ASSERT(false, "Unsupported buffer binding target!");
+        return OpenGL::InvalidHandle;
     }
 
-    ASSERT(false, "Unsupported buffer binding target!");
-    return OpenGL::InvalidHandle;
+    return m_bufferBindings[index];
 }
 
 void RenderState::ActiveTexture(GLenum texture)
@@ -414,6 +486,7 @@ void RenderState::ActiveTexture(GLenum texture)
 
     // Save changed state.
     m_activeTexture = texture;
+    m_dirtyGroups |= StateGroups::ActiveTexture;
 }
 
 GLenum RenderState::GetActiveTexture() const
@@ -431,27 +504,25 @@ void RenderState::BindTexture(GLenum target, GLuint texture)
     glBindTexture(target, texture);
     OpenGL::CheckErrors();
 
-    // Save changed state.
-    for(std::size_t i = 0; i < OpenGL::TextureBindingTargetCount; ++i)
+    // Save changed state, which is not tracked for unsupported enums.
+    const std::size_t index = OpenGL::GetTextureBindingTargetIndex(target);
+    if(index < OpenGL::TextureBindingTargetCount)
     {
-        if(std::get<0>(OpenGL::TextureBindingTargets[i]) == target)
-        {
-            m_textureBindings[i] = texture;
-            break;
-        }
+        m_textureBindings[index] = texture;
+        m_dirtyGroups |= StateGroups::TextureBindings;
     }
 }
 
 GLuint RenderState::GetTextureBinding(GLenum target) const
 {
-    for(std::size_t i = 0; i < OpenGL::TextureBindingTargetCount; ++i)
+    const std::size_t index = OpenGL::GetTextureBindingTargetIndex(target);
+    if(index >= OpenGL::TextureBindingTargetCount)
     {
-        if(std::get<0>(OpenGL::TextureBindingTargets[i]) == target)
-            return m_textureBindings[i];
+        ASSERT(false, "Unsupported texture binding target!");
+        return OpenGL::InvalidHandle;
     }
 
-    ASSERT(false, "Unsupported texture binding target!");
-    return OpenGL::InvalidHandle;
+    return m_textureBindings[index];
 }
 
 void RenderState::BindSampler(GLuint unit, GLuint sampler)
@@ -466,6 +537,7 @@ void RenderState::BindSampler(GLuint unit, GLuint sampler)
 
     // Save changed state.
     m_samplerBindings[unit] = sampler;
+    m_dirtyGroups |= StateGroups::SamplerBindings;
 }
 
 GLuint RenderState::GetSamplerBinding(GLuint unit) const
@@ -485,27 +557,25 @@ void RenderState::PixelStore(GLenum pname, GLint param)
     glPixelStorei(pname, param);
     OpenGL::CheckErrors();
 
-    // Save changed state.
-    for(std::size_t i = 0; i < OpenGL::PixelStoreParameterCount; ++i)
+    // Save changed state, which is not tracked for unsupported enums.
+    const std::size_t index = OpenGL::GetPixelStoreParameterIndex(pname);
+    if(index < OpenGL::PixelStoreParameterCount)
     {
-        if(OpenGL::PixelStoreParameters[i] == pname)
-        {
-            m_pixelStore[i] = param;
-            break;
-        }
+        m_pixelStore[index] = param;
+        m_dirtyGroups |= StateGroups::PixelStore;
     }
 }
 
 GLint RenderState::GetPixelStore(GLenum pname) const
 {
-    for(std::size_t i = 0; i < OpenGL::PixelStoreParameterCount; ++i)
+    const std::size_t index = OpenGL::GetPixelStoreParameterIndex(pname);
+    if(index >= OpenGL::PixelStoreParameterCount)
     {
-        if(OpenGL::PixelStoreParameters[i] == pname)
-            return m_pixelStore[i];
+        ASSERT(false, "Unsupported pixel store parameter!");
+        return 0;
     }
 
-    ASSERT(false, "Unsupported pixel store parameter!");
-    return 0;
+    return m_pixelStore[index];
 }
 
 void RenderState::UseProgram(GLuint program)
@@ -520,6 +590,7 @@ void RenderState::UseProgram(GLuint program)
 
     // Save changed state.
     m_currentProgram = program;
+    m_dirtyGroups |= StateGroups::Program;
 }
 
 GLuint RenderState::GetCurrentProgram() const
@@ -539,6 +610,7 @@ void RenderState::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
 
     // Save changed state.
     m_viewport = std::tie(x, y, width, height);
+    m_dirtyGroups |= StateGroups::Viewport;
 }
 
 std::tuple<GLint, GLint, GLsizei, GLsizei> RenderState::GetViewport() const
@@ -558,6 +630,7 @@ void RenderState::ClearDepth(GLfloat depth)
 
     // Save changed state.
     m_clearDepth = depth;
+    m_dirtyGroups |= StateGroups::ClearDepth;
 }
 
 GLfloat RenderState::GetClearDepth() const
@@ -577,6 +650,7 @@ void RenderState::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat a
 
     // Save changed state.
     m_clearColor = std::tie(red, green, blue, alpha);
+    m_dirtyGroups |= StateGroups::ClearColor;
 }
 
 std::tuple<GLfloat, GLfloat, GLfloat, GLfloat> RenderState::GetClearColor() const
@@ -596,6 +670,7 @@ void RenderState::DepthMask(GLboolean flag)
 
     // Save changed state.
     m_depthMask = flag;
+    m_dirtyGroups |= StateGroups::DepthMask;
 }
 
 GLboolean RenderState::GetDepthMask() const
@@ -621,6 +696,7 @@ void RenderState::BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlph
 
     // Save changed state.
     m_blendFuncSeparate = std::tie(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    m_dirtyGroups |= StateGroups::BlendFunc;
 }
 
 std::tuple<GLenum, GLenum, GLenum, GLenum> RenderState::GetBlendFuncSeparate() const
@@ -640,6 +716,7 @@ void RenderState::BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
 
     // Save changed state.
     m_blendEquationSeparate = std::tie(modeRGB, modeAlpha);
+    m_dirtyGroups |= StateGroups::BlendEquation;
 }
 
 std::tuple<GLenum, GLenum> RenderState::GetBlendEquationSeperate() const
@@ -659,6 +736,7 @@ void RenderState::Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
 
     // Save changed state.
     m_scissorBox = std::tie(x, y, width, height);
+    m_dirtyGroups |= StateGroups::Scissor;
 }
 
 std::tuple<GLint, GLint, GLsizei, GLsizei> RenderState::GetScissorBox() const
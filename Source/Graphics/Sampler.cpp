@@ -80,6 +80,7 @@ Sampler::~Sampler()
 {
     if(m_handle != OpenGL::InvalidHandle)
     {
+        m_renderContext->AcquireContext();
         glDeleteSamplers(1, &m_handle);
         OpenGL::CheckErrors();
     }
@@ -96,7 +97,11 @@ Sampler::CreateResult Sampler::Create(const CreateFromParams& params)
     // Create class instance.
     auto instance = std::unique_ptr<Sampler>(new Sampler());
 
+    // Save render context reference, which is also needed to release handle.
+    instance->m_renderContext = params.renderContext;
+
     // Create sampler handle.
+    params.renderContext->AcquireContext();
     glGenSamplers(1, &instance->m_handle);
     OpenGL::CheckErrors();
 
@@ -152,8 +157,5 @@ Sampler::CreateResult Sampler::Create(const CreateFromParams& params)
         glSamplerParameteri(instance->m_handle, GL_TEXTURE_COMPARE_FUNC, params.textureCompareFunc);
     }
 
-    // Save render context reference.
-    instance->m_renderContext = params.renderContext;
-
     return Common::Success(std::move(instance));
 }
@@ -6,6 +6,7 @@
 #include "Graphics/Precompiled.hpp"
 #include "Graphics/Shader.hpp"
 #include "Graphics/RenderContext.hpp"
+#include "Graphics/ShaderCache.hpp"
 #include <System/FileSystem/FileHandle.hpp>
 using namespace Graphics;
 
@@ -14,14 +15,14 @@ namespace
     struct ShaderType
     {
         const char* name;
-        const char* define;
+        ShaderPreprocessor::Stage stage;
         GLenum type;
     };
 
     const ShaderType ShaderTypes[] =
     {
-        { "vertex shader",   "VERTEX_SHADER",   GL_VERTEX_SHADER   },
-        { "fragment shader", "FRAGMENT_SHADER", GL_FRAGMENT_SHADER },
+        { "vertex shader",   ShaderPreprocessor::Stage::Vertex,   GL_VERTEX_SHADER   },
+        { "fragment shader", ShaderPreprocessor::Stage::Fragment, GL_FRAGMENT_SHADER },
     };
 
     const int ShaderTypeCount = Common::StaticArraySize(ShaderTypes);
@@ -32,6 +33,7 @@ Shader::~Shader()
 {
     if(m_handle != OpenGL::InvalidHandle)
     {
+        m_renderContext->AcquireContext();
         glDeleteProgram(m_handle);
         OpenGL::CheckErrors();
     }
@@ -47,10 +49,83 @@ Shader::CreateResult Shader::Create(const LoadFromString& params)
     CHECK_ARGUMENT_OR_RETURN(!params.shaderCode.empty(),
         Common::Failure(CreateErrors::InvalidArgument));
 
+    // Preprocess shader code and expand it for provided defines.
+    ShaderPreprocessor::LoadFromString preprocessorParams;
+    preprocessorParams.includeCallback = params.includeCallback;
+    preprocessorParams.sourcePath = params.sourcePath;
+    preprocessorParams.shaderCode = params.shaderCode;
+
+    auto preprocessor = ShaderPreprocessor::Create(preprocessorParams).UnwrapOr(nullptr);
+    if(preprocessor == nullptr)
+    {
+        LOG_ERROR("Could not preprocess shader code!");
+        return Common::Failure(CreateErrors::FailedPreprocessing);
+    }
+
+    LoadFromSource sourceParams;
+    sourceParams.renderContext = params.renderContext;
+    sourceParams.shaderCache = params.shaderCache;
+    sourceParams.source = preprocessor->Expand(0, params.defines);
+    return Create(sourceParams);
+}
+
+Shader::CreateResult Shader::Create(const LoadFromSource& params)
+{
+    LOG_PROFILE_SCOPE("Create shader program");
+
+    // Check arguments.
+    CHECK_ARGUMENT_OR_RETURN(params.renderContext,
+        Common::Failure(CreateErrors::InvalidArgument));
+
     // Create instance.
     auto instance = std::unique_ptr<Shader>(new Shader());
     instance->m_renderContext = params.renderContext;
 
+    // Collect source code of each shader stage found.
+    std::vector<std::string_view> programSourceSegments;
+    for(const std::string& stageSource : params.source.stages)
+    {
+        if(!stageSource.empty())
+        {
+            programSourceSegments.push_back(stageSource);
+        }
+    }
+
+    // Check if any shader objects were found.
+    if(programSourceSegments.empty())
+    {
+        LOG_ERROR("Could not find any shader objects!");
+        return Common::Failure(CreateErrors::FailedShaderCompilation);
+    }
+
+    // Create shader program.
+    params.renderContext->AcquireContext();
+    instance->m_handle = glCreateProgram();
+    OpenGL::CheckErrors();
+
+    if(instance->m_handle == OpenGL::InvalidHandle)
+    {
+        LOG_ERROR("Shader program could not be created!");
+        return Common::Failure(CreateErrors::FailedProgramCreation);
+    }
+
+    // Load linked program binary from cache if available.
+    ShaderCache* shaderCache = params.shaderCache;
+    ShaderCache::ProgramKey programKey = 0;
+
+    if(shaderCache != nullptr && shaderCache->IsEnabled())
+    {
+        programKey = shaderCache->CalculateKey(programSourceSegments);
+
+        if(shaderCache->LoadProgram(programKey, instance->m_handle))
+        {
+            instance->ReflectUniforms();
+            return Common::Success(std::move(instance));
+        }
+    }
+
+    const auto compileStart = std::chrono::steady_clock::now();
+
     // Create array of shader objects for each type that can be linked.
     GLuint shaderObjects[ShaderTypeCount] = { 0 };
     SCOPE_GUARD([&shaderObjects]
@@ -62,32 +137,16 @@ Shader::CreateResult Shader::Create(const LoadFromString& params)
         }
     });
 
-    // Create mutable copy of the provided shader code.
-    std::string shaderCode = params.shaderCode;
-
-    // Extract shader version.
-    std::string shaderVersion;
-    std::size_t versionStart = shaderCode.find("#version ");
-    std::size_t versionEnd = shaderCode.find('\n', versionStart);
-
-    if(versionStart != std::string::npos)
-    {
-        shaderVersion = shaderCode.substr(versionStart, versionEnd - versionStart + 1);
-        shaderCode.erase(versionStart, versionEnd + 1);
-    }
-
     // Compile shader objects.
-    bool shaderObjectsFound = false;
     for(unsigned int i = 0; i < ShaderTypeCount; ++i)
     {
         const ShaderType& shaderType = ShaderTypes[i];
+        const std::string& shaderSource = params.source.GetStage(shaderType.stage);
         GLuint& shaderObject = shaderObjects[i];
 
         // Compile shader object if found.
-        if(shaderCode.find(shaderType.define) != std::string::npos)
+        if(!shaderSource.empty())
         {
-            shaderObjectsFound = true;
-
             LOG_PROFILE_SCOPE("Compile {}", shaderType.name);
 
             // Create shader object.
@@ -100,24 +159,9 @@ Shader::CreateResult Shader::Create(const LoadFromString& params)
                 return Common::Failure(CreateErrors::FailedShaderCreation);
             }
 
-            // Prepare preprocessor define.
-            std::string shaderDefine = "#define ";
-            shaderDefine += shaderType.define;
-            shaderDefine += "\n";
-
             // Compile shader object code.
-            const char* shaderCodeSegments[] =
-            {
-                shaderVersion.c_str(),
-                shaderDefine.c_str(),
-                shaderCode.c_str(),
-            };
-
-            const std::size_t shaderCodeSegmentCount = Common::StaticArraySize(shaderCodeSegments);
-
-            glShaderSource(shaderObject,
-                Common::NumericalCast<GLsizei>(shaderCodeSegmentCount),
-                (const GLchar**)&shaderCodeSegments, nullptr);
+            const GLchar* shaderCode = shaderSource.c_str();
+            glShaderSource(shaderObject, 1, &shaderCode, nullptr);
             OpenGL::CheckErrors();
 
             glCompileShader(shaderObject);
@@ -151,23 +195,6 @@ Shader::CreateResult Shader::Create(const LoadFromString& params)
         }
     }
 
-    // Check if any shader objects were found.
-    if(shaderObjectsFound == false)
-    {
-        LOG_ERROR("Could not find any shader objects!");
-        return Common::Failure(CreateErrors::FailedShaderCompilation);
-    }
-
-    // Create shader program.
-    instance->m_handle = glCreateProgram();
-    OpenGL::CheckErrors();
-
-    if(instance->m_handle == OpenGL::InvalidHandle)
-    {
-        LOG_ERROR("Shader program could not be created!");
-        return Common::Failure(CreateErrors::FailedProgramCreation);
-    }
-
     // Attach compiled shader objects.
     for(unsigned int & shaderObject : shaderObjects)
     {
@@ -182,6 +209,13 @@ Shader::CreateResult Shader::Create(const LoadFromString& params)
     {
         LOG_PROFILE_SCOPE("Link shader");
 
+        // Request program binary to be retrievable for shader cache.
+        if(shaderCache != nullptr && shaderCache->IsEnabled())
+        {
+            glProgramParameteri(instance->m_handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            OpenGL::CheckErrors();
+        }
+
         // Create link result handle.
         glLinkProgram(instance->m_handle);
         OpenGL::CheckErrors();
@@ -223,6 +257,16 @@ Shader::CreateResult Shader::Create(const LoadFromString& params)
         return Common::Failure(CreateErrors::FailedProgramLinkage);
     }
 
+    // Store linked program binary in cache.
+    if(shaderCache != nullptr && shaderCache->IsEnabled())
+    {
+        const std::chrono::duration<double> compileTime = std::chrono::steady_clock::now() - compileStart;
+        shaderCache->StoreProgram(programKey, instance->m_handle, compileTime.count());
+    }
+
+    // Reflect active uniforms of linked program.
+    instance->ReflectUniforms();
+
     return Common::Success(std::move(instance));
 }
 
@@ -249,10 +293,84 @@ Shader::CreateResult Shader::Create(System::FileHandle& file, const LoadFromFile
     // Create instance.
     LoadFromString compileParams;
     compileParams.renderContext = params.renderContext;
+    compileParams.shaderCache = params.shaderCache;
+    compileParams.defines = params.defines;
+    compileParams.sourcePath = file.GetPath();
     compileParams.shaderCode = std::move(shaderCode);
+
+    if(params.fileSystem != nullptr)
+    {
+        compileParams.includeCallback = ShaderPreprocessor::CreateFileIncludeCallback(params.fileSystem);
+    }
+
     return Create(compileParams);
 }
 
+void Shader::ReflectUniforms()
+{
+    ASSERT(m_handle != OpenGL::InvalidHandle);
+    ASSERT(m_uniforms.empty());
+
+    GLint uniformCount = 0;
+    glGetProgramiv(m_handle, GL_ACTIVE_UNIFORMS, &uniformCount);
+    OpenGL::CheckErrors();
+
+    GLint uniformNameLength = 0;
+    glGetProgramiv(m_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &uniformNameLength);
+    OpenGL::CheckErrors();
+
+    std::vector<GLchar> uniformName(std::max(uniformNameLength, 1));
+    m_uniforms.reserve(uniformCount);
+
+    for(GLint i = 0; i < uniformCount; ++i)
+    {
+        Uniform uniform;
+        GLsizei nameLength = 0;
+        glGetActiveUniform(m_handle, i, Common::NumericalCast<GLsizei>(uniformName.size()),
+            &nameLength, &uniform.size, &uniform.type, uniformName.data());
+        OpenGL::CheckErrors();
+
+        // Array uniforms are reported with subscript of their first element,
+        // which we strip so they can be referenced by their declared name.
+        std::string_view name(uniformName.data(), nameLength);
+        if(name.size() > 3 && name.substr(name.size() - 3) == "[0]")
+        {
+            name.remove_suffix(3);
+        }
+
+        // Uniforms that belong to uniform blocks have no location.
+        uniform.location = glGetUniformLocation(m_handle, uniformName.data());
+        OpenGL::CheckErrors();
+
+        if(!uniform.IsValid())
+            continue;
+
+        m_uniforms.emplace(Common::Name(name), uniform);
+    }
+}
+
+Shader::Uniform Shader::GetUniform(Common::Name name) const
+{
+    auto it = m_uniforms.find(name);
+    if(it == m_uniforms.end())
+        return Uniform();
+
+    return it->second;
+}
+
+Shader::UniformBatch::UniformBatch(Shader& shader) :
+    m_shader(shader)
+{
+    RenderState& renderState = m_shader.m_renderContext->GetState();
+    m_previousProgram = renderState.GetCurrentProgram();
+    renderState.UseProgram(m_shader.GetHandle());
+}
+
+Shader::UniformBatch::~UniformBatch()
+{
+    m_shader.m_renderContext->GetState().UseProgram(m_previousProgram);
+}
+
 GLint Shader::GetAttributeIndex(std::string name) const
 {
     ASSERT(!name.empty(), "Attribute name cannot be empty!");
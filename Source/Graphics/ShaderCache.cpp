@@ -0,0 +1,299 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Graphics/Precompiled.hpp"
+#include "Graphics/ShaderCache.hpp"
+#include "Graphics/RenderState.hpp"
+#include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
+using namespace Graphics;
+
+namespace
+{
+    const char* LogAttachFailed = "Failed to attach shader cache! {}";
+
+    const uint32_t CacheFileMagic = 0x48534350; // "PCSH"
+    const uint32_t CacheFileVersion = 1;
+
+    struct CacheFileHeader
+    {
+        uint32_t magic = CacheFileMagic;
+        uint32_t version = CacheFileVersion;
+        uint64_t programKey = 0;
+        uint64_t driverHash = 0;
+        uint32_t binaryFormat = 0;
+        uint32_t binaryLength = 0;
+        double compileSeconds = 0.0;
+    };
+
+    double SecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::string_view GetDriverString(GLenum name)
+    {
+        const GLubyte* string = glGetString(name);
+        OpenGL::CheckErrors();
+
+        return string != nullptr ? std::string_view(reinterpret_cast<const char*>(string)) : "";
+    }
+}
+
+ShaderCache::ShaderCache() = default;
+ShaderCache::~ShaderCache()
+{
+    if(m_enabled)
+    {
+        LogStats();
+    }
+}
+
+bool ShaderCache::OnAttach(const Core::EngineSystemStorage& engineSystems)
+{
+    // Locate needed engine systems.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(configSystem == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate config system.");
+        return false;
+    }
+
+    // Cache is optional and missing support only disables it.
+    m_directory = configSystem->Get<std::string>(
+        NAME_CONSTEXPR("render.shaderCacheDirectory")).UnwrapOr("");
+
+    if(m_directory.empty())
+    {
+        LOG_INFO("Shader cache is disabled.");
+        return true;
+    }
+
+    GLint binaryFormatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+    OpenGL::CheckErrors();
+
+    if(binaryFormatCount <= 0)
+    {
+        LOG_INFO("Shader cache is disabled because program binaries are not supported.");
+        return true;
+    }
+
+    m_binaryFormats.resize(binaryFormatCount);
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, m_binaryFormats.data());
+    OpenGL::CheckErrors();
+
+    // Binaries are only valid for driver that produced them.
+    const GLenum DriverStrings[] =
+    {
+        GL_VENDOR,
+        GL_RENDERER,
+        GL_VERSION,
+        GL_SHADING_LANGUAGE_VERSION,
+    };
+
+    m_driverHash = Common::StringHash<uint64_t>("");
+    for(GLenum driverString : DriverStrings)
+    {
+        m_driverHash = Common::CombineHash(m_driverHash,
+            Common::StringHash<uint64_t>(GetDriverString(driverString)));
+    }
+
+    std::error_code error;
+    fs::create_directories(m_directory, error);
+    if(error)
+    {
+        LOG_WARNING("Shader cache is disabled because \"{}\" directory could not be created! {}",
+            m_directory.generic_string(), error.message());
+        return true;
+    }
+
+    LOG_INFO("Shader cache is using \"{}\" directory.", m_directory.generic_string());
+    m_enabled = true;
+    return true;
+}
+
+ShaderCache::ProgramKey ShaderCache::CalculateKey(const std::vector<std::string_view>& sourceSegments) const
+{
+    ProgramKey key = m_driverHash;
+    for(const std::string_view& segment : sourceSegments)
+    {
+        key = Common::CombineHash(key, Common::StringHash<uint64_t>(segment));
+    }
+
+    return key;
+}
+
+fs::path ShaderCache::GetProgramPath(ProgramKey key) const
+{
+    return m_directory / fmt::format("{:016x}.bin", key);
+}
+
+bool ShaderCache::LoadProgram(ProgramKey key, GLuint program)
+{
+    if(!m_enabled)
+        return false;
+
+    LOG_PROFILE_SCOPE("Load cached shader program");
+
+    const auto loadStart = std::chrono::steady_clock::now();
+    const fs::path programPath = GetProgramPath(key);
+
+    std::ifstream file(programPath, std::ios::binary);
+    if(!file.is_open())
+    {
+        m_stats.misses += 1;
+        return false;
+    }
+
+    // Validate cache file header before handing binary to driver.
+    CacheFileHeader header;
+    if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        file.close();
+        RejectProgram(key, "Could not read header.");
+        return false;
+    }
+
+    if(header.magic != CacheFileMagic || header.version != CacheFileVersion)
+    {
+        file.close();
+        RejectProgram(key, "Unknown file format.");
+        return false;
+    }
+
+    if(header.programKey != key || header.driverHash != m_driverHash)
+    {
+        file.close();
+        RejectProgram(key, "Program key or driver mismatch.");
+        return false;
+    }
+
+    if(std::find(m_binaryFormats.begin(), m_binaryFormats.end(),
+        static_cast<GLint>(header.binaryFormat)) == m_binaryFormats.end())
+    {
+        file.close();
+        RejectProgram(key, "Unsupported binary format.");
+        return false;
+    }
+
+    std::vector<char> binary(header.binaryLength);
+    if(binary.empty() || !file.read(binary.data(), binary.size()) || file.peek() != EOF)
+    {
+        file.close();
+        RejectProgram(key, "Invalid binary length.");
+        return false;
+    }
+
+    file.close();
+
+    // Driver can still reject binary, in which case program is left unlinked.
+    glProgramBinary(program, header.binaryFormat, binary.data(),
+        Common::NumericalCast<GLsizei>(binary.size()));
+    OpenGL::CheckErrors();
+
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    OpenGL::CheckErrors();
+
+    if(linkStatus == GL_FALSE)
+    {
+        RejectProgram(key, "Binary rejected by driver.");
+        return false;
+    }
+
+    const double loadSeconds = SecondsSince(loadStart);
+    m_stats.hits += 1;
+    m_stats.loadSeconds += loadSeconds;
+    m_stats.savedSeconds += std::max(0.0, header.compileSeconds - loadSeconds);
+    return true;
+}
+
+void ShaderCache::StoreProgram(ProgramKey key, GLuint program, double compileSeconds)
+{
+    if(!m_enabled)
+        return;
+
+    LOG_PROFILE_SCOPE("Store cached shader program");
+
+    GLint binaryLength = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    OpenGL::CheckErrors();
+
+    if(binaryLength <= 0)
+    {
+        LOG_WARNING("Shader program binary could not be retrieved!");
+        return;
+    }
+
+    CacheFileHeader header;
+    header.programKey = key;
+    header.driverHash = m_driverHash;
+    header.compileSeconds = compileSeconds;
+
+    std::vector<char> binary(binaryLength);
+    GLenum binaryFormat = GL_NONE;
+    glGetProgramBinary(program, binaryLength, &binaryLength, &binaryFormat, binary.data());
+    OpenGL::CheckErrors();
+
+    header.binaryFormat = binaryFormat;
+    header.binaryLength = Common::NumericalCast<uint32_t>(binaryLength);
+
+    // Write to temporary file first, so interrupted writes never leave
+    // partial cache file that would be picked up on next launch.
+    const fs::path programPath = GetProgramPath(key);
+    fs::path temporaryPath = programPath;
+    temporaryPath += ".tmp";
+
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), header.binaryLength);
+
+        if(!file.good())
+        {
+            file.close();
+            LOG_WARNING("Shader program binary could not be written to \"{}\" file!",
+                temporaryPath.generic_string());
+
+            std::error_code error;
+            fs::remove(temporaryPath, error);
+            return;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporaryPath, programPath, error);
+    if(error)
+    {
+        LOG_WARNING("Shader program binary could not be moved to \"{}\" file! {}",
+            programPath.generic_string(), error.message());
+
+        fs::remove(temporaryPath, error);
+        return;
+    }
+
+    m_stats.stored += 1;
+}
+
+void ShaderCache::RejectProgram(ProgramKey key, const char* reason)
+{
+    // Delete invalid cache file so it gets replaced once program is compiled from source.
+    const fs::path programPath = GetProgramPath(key);
+    LOG_WARNING("Discarding cached shader program \"{}\"! {}", programPath.generic_string(), reason);
+
+    std::error_code error;
+    fs::remove(programPath, error);
+
+    m_stats.rejected += 1;
+    m_stats.misses += 1;
+}
+
+void ShaderCache::LogStats() const
+{
+    LOG_INFO("Shader cache: {} hits, {} misses ({} rejected), {} stored, "
+        "loaded in {:.4f}s, saved {:.4f}s.", m_stats.hits, m_stats.misses, m_stats.rejected,
+        m_stats.stored, m_stats.loadSeconds, m_stats.savedSeconds);
+}
@@ -0,0 +1,723 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Graphics/Precompiled.hpp"
+#include "Graphics/ShaderPreprocessor.hpp"
+#include <System/FileSystem/FileSystem.hpp>
+using namespace Graphics;
+
+namespace
+{
+    const char* StageDefines[] =
+    {
+        "VERTEX_SHADER",
+        "FRAGMENT_SHADER",
+    };
+
+    static_assert(Common::StaticArraySize(StageDefines) == ShaderPreprocessor::StageCount,
+        "Stage define table does not match number of shader stages!");
+
+    struct Directive
+    {
+        std::string_view name;
+        std::string_view arguments;
+    };
+
+    bool IsIdentifierCharacter(char character)
+    {
+        return std::isalnum(static_cast<unsigned char>(character)) || character == '_';
+    }
+
+    std::string_view TrimLeft(std::string_view text)
+    {
+        std::size_t start = text.find_first_not_of(" \t");
+        return start != std::string_view::npos ? text.substr(start) : std::string_view();
+    }
+
+    std::string_view TrimRight(std::string_view text)
+    {
+        std::size_t end = text.find_last_not_of(" \t");
+        return end != std::string_view::npos ? text.substr(0, end + 1) : std::string_view();
+    }
+
+    std::string_view ReadIdentifier(std::string_view& text)
+    {
+        std::size_t length = 0;
+        while(length < text.size() && IsIdentifierCharacter(text[length]))
+        {
+            ++length;
+        }
+
+        std::string_view identifier = text.substr(0, length);
+        text.remove_prefix(length);
+        return identifier;
+    }
+
+    bool ParseDirective(std::string_view line, Directive& directive)
+    {
+        line = TrimLeft(line);
+        if(line.empty() || line.front() != '#')
+            return false;
+
+        line = TrimLeft(line.substr(1));
+        directive.name = ReadIdentifier(line);
+
+        // Trailing line comments are not part of directive arguments.
+        std::string_view arguments = line;
+        std::size_t commentStart = arguments.find("//");
+        if(commentStart != std::string_view::npos)
+        {
+            arguments = arguments.substr(0, commentStart);
+        }
+
+        directive.arguments = TrimRight(TrimLeft(arguments));
+        return true;
+    }
+
+    bool ContainsIdentifier(std::string_view text, std::string_view identifier)
+    {
+        std::size_t position = text.find(identifier);
+        while(position != std::string_view::npos)
+        {
+            const std::size_t end = position + identifier.size();
+            const bool startsWord = position == 0 || !IsIdentifierCharacter(text[position - 1]);
+            const bool endsWord = end == text.size() || !IsIdentifierCharacter(text[end]);
+
+            if(startsWord && endsWord)
+                return true;
+
+            position = text.find(identifier, position + 1);
+        }
+
+        return false;
+    }
+
+    template<typename Function>
+    void ForEachLine(std::string_view text, Function function)
+    {
+        std::size_t lineStart = 0;
+        while(lineStart < text.size())
+        {
+            std::size_t lineEnd = text.find('\n', lineStart);
+            if(lineEnd == std::string_view::npos)
+            {
+                lineEnd = text.size();
+            }
+
+            std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+            if(!line.empty() && line.back() == '\r')
+            {
+                line.remove_suffix(1);
+            }
+
+            if(!function(line))
+                return;
+
+            lineStart = lineEnd + 1;
+        }
+    }
+
+    void AppendLine(std::string& output, std::string_view line)
+    {
+        output.append(line);
+        output += '\n';
+    }
+
+    void AppendDefine(std::string& output, std::string_view define)
+    {
+        output += "#define ";
+        output.append(define);
+        output += '\n';
+    }
+}
+
+ShaderPreprocessor::ShaderPreprocessor() = default;
+
+ShaderPreprocessor::CreateResult ShaderPreprocessor::Create(const LoadFromString& params)
+{
+    LOG_PROFILE_SCOPE("Preprocess shader");
+
+    // Check arguments.
+    CHECK_ARGUMENT_OR_RETURN(!params.shaderCode.empty(),
+        Common::Failure(CreateErrors::InvalidArgument));
+
+    // Create instance.
+    auto instance = std::unique_ptr<ShaderPreprocessor>(new ShaderPreprocessor());
+
+    // Inline included files and collect declared keywords.
+    ProcessContext context;
+    context.includeCallback = params.includeCallback;
+    if(auto result = instance->ProcessFile(params.shaderCode, params.sourcePath, 0, context); !result)
+    {
+        return Common::Failure(result.UnwrapFailure());
+    }
+
+    return Common::Success(std::move(instance));
+}
+
+ShaderPreprocessor::IncludeCallback ShaderPreprocessor::CreateFileIncludeCallback(System::FileSystem* fileSystem)
+{
+    ASSERT(fileSystem != nullptr, "Include callback needs valid file system reference!");
+
+    return [fileSystem](const fs::path& path) -> IncludeResult
+    {
+        auto fileResult = fileSystem->OpenFile(path, System::FileHandle::OpenFlags::Read);
+        if(!fileResult)
+        {
+            LOG_ERROR("Could not open \"{}\" shader include file!", path.generic_string());
+            return Common::Failure();
+        }
+
+        return Common::Success(fileResult.Unwrap()->ReadAsTextString());
+    };
+}
+
+const char* ShaderPreprocessor::GetStageDefine(Stage stage)
+{
+    ASSERT(stage < Stage::Count);
+    return StageDefines[static_cast<std::size_t>(stage)];
+}
+
+ShaderPreprocessor::ProcessResult ShaderPreprocessor::ProcessFile(std::string_view code,
+    const fs::path& path, uint32_t sourceString, ProcessContext& context)
+{
+    context.includeStack.push_back(path);
+    SCOPE_GUARD([&context]
+    {
+        context.includeStack.pop_back();
+    });
+
+    // Code spans map lines of inlined code back to source lines for #line directives.
+    // New span starts after any source line that does not end up in inlined code.
+    uint32_t sourceLine = 0;
+    bool spanBroken = true;
+
+    auto AppendCodeLine = [&](std::string_view line)
+    {
+        if(spanBroken)
+        {
+            m_codeSpans.push_back({ context.codeLineCount, sourceString, sourceLine });
+            spanBroken = false;
+        }
+
+        AppendLine(m_code, line);
+        ++context.codeLineCount;
+    };
+
+    std::optional<CreateErrors> error;
+    ForEachLine(code, [&](std::string_view line)
+    {
+        ++sourceLine;
+
+        Directive directive;
+        if(!ParseDirective(line, directive))
+        {
+            AppendCodeLine(line);
+            return true;
+        }
+
+        // Version directive must come first in compiled code, so it is extracted
+        // from main file and placed ahead of defines when source is expanded.
+        if(directive.name == "version")
+        {
+            spanBroken = true;
+            if(context.includeStack.size() == 1 && m_version.empty())
+            {
+                AppendLine(m_version, TrimRight(TrimLeft(line)));
+            }
+            else
+            {
+                LOG_WARNING("Ignoring version directive in \"{}\" shader file.", path.generic_string());
+            }
+
+            return true;
+        }
+
+        if(directive.name == "include")
+        {
+            std::string_view argument = directive.arguments;
+            const char closingQuote = argument.empty() ? '\0' :
+                argument.front() == '"' ? '"' : argument.front() == '<' ? '>' : '\0';
+
+            if(closingQuote == '\0' || argument.size() < 3 || argument.back() != closingQuote)
+            {
+                LOG_ERROR("Invalid include directive in \"{}\" shader file!", path.generic_string());
+                error = CreateErrors::InvalidDirective;
+                return false;
+            }
+
+            argument = argument.substr(1, argument.size() - 2);
+            fs::path includePath = (path.parent_path() / fs::path(argument)).lexically_normal();
+
+            const auto& includeStack = context.includeStack;
+            if(std::find(includeStack.begin(), includeStack.end(), includePath) != includeStack.end())
+            {
+                LOG_ERROR("Recursive include of \"{}\" file in \"{}\" shader file!",
+                    includePath.generic_string(), path.generic_string());
+                error = CreateErrors::RecursiveInclude;
+                return false;
+            }
+
+            // Files are loaded once, but inlined at every include site. Whether they are
+            // included again can only be decided once conditionals are resolved for stage.
+            auto includedFile = std::find(m_includedFiles.begin(), m_includedFiles.end(), includePath);
+            if(includedFile == m_includedFiles.end())
+            {
+                IncludeResult includeResult = context.includeCallback ?
+                    context.includeCallback(includePath) : IncludeResult(Common::Failure());
+
+                if(!includeResult)
+                {
+                    LOG_ERROR("Could not include \"{}\" file in \"{}\" shader file!",
+                        includePath.generic_string(), path.generic_string());
+                    error = CreateErrors::MissingInclude;
+                    return false;
+                }
+
+                m_includedFiles.push_back(includePath);
+                context.includeCode.push_back(includeResult.Unwrap());
+                includedFile = m_includedFiles.end() - 1;
+            }
+
+            const uint32_t fileIndex = static_cast<uint32_t>(std::distance(m_includedFiles.begin(), includedFile));
+            const std::size_t includeSpanIndex = m_includeSpans.size();
+            m_includeSpans.push_back({ fileIndex, context.codeLineCount, 0 });
+
+            // Copy is needed as processing nested includes can grow code storage.
+            const std::string includeCode = context.includeCode[fileIndex];
+            if(auto result = ProcessFile(includeCode, includePath, fileIndex + 1, context); !result)
+            {
+                error = result.UnwrapFailure();
+                return false;
+            }
+
+            m_includeSpans[includeSpanIndex].endCodeLine = context.codeLineCount;
+            spanBroken = true;
+            return true;
+        }
+
+        if(directive.name == "pragma")
+        {
+            std::string_view arguments = directive.arguments;
+            if(ReadIdentifier(arguments) == "keywords")
+            {
+                for(arguments = TrimLeft(arguments); !arguments.empty(); arguments = TrimLeft(arguments))
+                {
+                    std::string_view keyword = ReadIdentifier(arguments);
+                    if(keyword.empty())
+                    {
+                        LOG_ERROR("Invalid keyword in \"{}\" shader file!", path.generic_string());
+                        error = CreateErrors::InvalidDirective;
+                        return false;
+                    }
+
+                    if(FindKeyword(keyword) >= 0)
+                        continue;
+
+                    if(m_keywords.size() == MaxKeywords)
+                    {
+                        LOG_ERROR("Too many keywords declared in \"{}\" shader file!", path.generic_string());
+                        error = CreateErrors::TooManyKeywords;
+                        return false;
+                    }
+
+                    m_keywords.emplace_back(keyword);
+                }
+
+                spanBroken = true;
+                return true;
+            }
+        }
+
+        AppendCodeLine(line);
+        return true;
+    });
+
+    if(error.has_value())
+    {
+        return Common::Failure(*error);
+    }
+
+    return Common::Success();
+}
+
+std::string ShaderPreprocessor::ResolveConditionals(KeywordMask keywords, Stage stage) const
+{
+    // Returns state of symbol if it is known to be either defined or undefined.
+    auto GetSymbolState = [this, keywords, stage](std::string_view symbol) -> std::optional<bool>
+    {
+        for(std::size_t i = 0; i < StageCount; ++i)
+        {
+            if(symbol == StageDefines[i])
+                return i == static_cast<std::size_t>(stage);
+        }
+
+        int keywordIndex = FindKeyword(symbol);
+        if(keywordIndex >= 0)
+            return (keywords & (KeywordMask(1) << keywordIndex)) != 0;
+
+        return std::nullopt;
+    };
+
+    // Evaluates #ifdef, #ifndef and #if [!]defined(SYMBOL) for known symbols only.
+    auto EvaluateCondition = [&GetSymbolState](const Directive& directive) -> std::optional<bool>
+    {
+        std::string_view arguments = directive.arguments;
+        bool negate = directive.name == "ifndef";
+
+        if(directive.name == "if" || directive.name == "elif")
+        {
+            if(!arguments.empty() && arguments.front() == '!')
+            {
+                negate = true;
+                arguments = TrimLeft(arguments.substr(1));
+            }
+
+            if(ReadIdentifier(arguments) != "defined")
+                return std::nullopt;
+
+            arguments = TrimLeft(arguments);
+            const bool parenthesized = !arguments.empty() && arguments.front() == '(';
+            if(parenthesized)
+            {
+                arguments = TrimLeft(arguments.substr(1));
+            }
+
+            std::string_view symbol = ReadIdentifier(arguments);
+            arguments = TrimLeft(arguments);
+
+            if(parenthesized)
+            {
+                if(arguments.empty() || arguments.front() != ')')
+                    return std::nullopt;
+
+                arguments = TrimLeft(arguments.substr(1));
+            }
+
+            if(!arguments.empty())
+                return std::nullopt;
+
+            std::optional<bool> state = GetSymbolState(symbol);
+            return state.has_value() ? std::optional<bool>(*state != negate) : std::nullopt;
+        }
+
+        std::string_view symbol = ReadIdentifier(arguments);
+        if(!TrimLeft(arguments).empty())
+            return std::nullopt;
+
+        std::optional<bool> state = GetSymbolState(symbol);
+        return state.has_value() ? std::optional<bool>(*state != negate) : std::nullopt;
+    };
+
+    /*
+        Conditional blocks are either resolved (only active branch is emitted without
+        directives), passed through (directives and all branches are emitted for GLSL
+        compiler) or skipped (nested inside inactive branch of resolved block).
+    */
+
+    enum class BlockMode
+    {
+        Resolved,
+        PassThrough,
+        Skipped,
+    };
+
+    struct ConditionalBlock
+    {
+        BlockMode mode = BlockMode::Resolved;
+        bool active = false;
+        bool taken = false;
+    };
+
+    std::vector<ConditionalBlock> blocks;
+    auto IsActive = [&blocks]()
+    {
+        return blocks.empty() || blocks.back().active;
+    };
+
+    auto IsResolved = [&blocks]()
+    {
+        return std::all_of(blocks.begin(), blocks.end(), [](const ConditionalBlock& block)
+        {
+            return block.mode == BlockMode::Resolved;
+        });
+    };
+
+    std::string output;
+    output.reserve(m_code.size());
+
+    /*
+        Line directive is emitted whenever next line does not follow previous one in same
+        source string, which happens at start of code, at include boundaries and after
+        lines removed along with resolved conditionals. Line number given by directive
+        applies to line that follows it.
+    */
+
+    uint32_t codeLine = 0;
+    std::size_t codeSpanIndex = 0;
+    CodeSpan codeSpan;
+    CodeSpan expectedLine = { 0, 0, std::numeric_limits<uint32_t>::max() };
+
+    auto AppendSourceLine = [&](std::string_view line)
+    {
+        const uint32_t sourceLine = codeSpan.sourceLine + (codeLine - codeSpan.codeLine);
+        if(expectedLine.sourceString != codeSpan.sourceString || expectedLine.sourceLine != sourceLine)
+        {
+            output += fmt::format("#line {} {}\n", sourceLine, codeSpan.sourceString);
+        }
+
+        expectedLine.sourceString = codeSpan.sourceString;
+        expectedLine.sourceLine = sourceLine + 1;
+        AppendLine(output, line);
+    };
+
+    // Files are inlined once per stage, where they are first included by active code.
+    // Inclusion inside blocks left for GLSL compiler does not count, as it may not happen.
+    std::vector<bool> includedFiles(m_includedFiles.size(), false);
+    std::size_t includeSpanIndex = 0;
+    uint32_t skipEndCodeLine = 0;
+
+    ForEachLine(m_code, [&](std::string_view line)
+    {
+        SCOPE_GUARD([&codeLine]
+        {
+            ++codeLine;
+        });
+
+        while(codeSpanIndex < m_codeSpans.size() && m_codeSpans[codeSpanIndex].codeLine <= codeLine)
+        {
+            codeSpan = m_codeSpans[codeSpanIndex++];
+        }
+
+        for(; includeSpanIndex < m_includeSpans.size() &&
+            m_includeSpans[includeSpanIndex].firstCodeLine <= codeLine; ++includeSpanIndex)
+        {
+            const IncludeSpan& includeSpan = m_includeSpans[includeSpanIndex];
+            if(codeLine < skipEndCodeLine || !IsActive())
+                continue;
+
+            if(includedFiles[includeSpan.fileIndex])
+            {
+                skipEndCodeLine = includeSpan.endCodeLine;
+            }
+            else if(IsResolved())
+            {
+                includedFiles[includeSpan.fileIndex] = true;
+            }
+        }
+
+        if(codeLine < skipEndCodeLine)
+            return true;
+
+        Directive directive;
+        if(!ParseDirective(line, directive))
+        {
+            if(IsActive())
+            {
+                AppendSourceLine(line);
+            }
+
+            return true;
+        }
+
+        if(directive.name == "if" || directive.name == "ifdef" || directive.name == "ifndef")
+        {
+            ConditionalBlock& block = blocks.emplace_back();
+            if(blocks.size() > 1 && !blocks[blocks.size() - 2].active)
+            {
+                block.mode = BlockMode::Skipped;
+                return true;
+            }
+
+            std::optional<bool> condition = EvaluateCondition(directive);
+            if(condition.has_value())
+            {
+                block.active = *condition;
+                block.taken = *condition;
+            }
+            else
+            {
+                block.mode = BlockMode::PassThrough;
+                block.active = true;
+                AppendSourceLine(line);
+            }
+
+            return true;
+        }
+
+        // Unbalanced directives are left for GLSL compiler to report.
+        if(blocks.empty() || (directive.name != "elif" && directive.name != "else" && directive.name != "endif"))
+        {
+            if(IsActive())
+            {
+                AppendSourceLine(line);
+            }
+
+            return true;
+        }
+
+        ConditionalBlock& block = blocks.back();
+        if(directive.name == "endif")
+        {
+            if(block.mode == BlockMode::PassThrough)
+            {
+                AppendSourceLine(line);
+            }
+
+            blocks.pop_back();
+            return true;
+        }
+
+        if(block.mode == BlockMode::PassThrough)
+        {
+            AppendSourceLine(line);
+            return true;
+        }
+
+        if(block.mode == BlockMode::Skipped)
+            return true;
+
+        if(directive.name == "else")
+        {
+            block.active = !block.taken;
+            block.taken = true;
+            return true;
+        }
+
+        if(block.taken)
+        {
+            block.active = false;
+            return true;
+        }
+
+        std::optional<bool> condition = EvaluateCondition(directive);
+        if(condition.has_value())
+        {
+            block.active = *condition;
+            block.taken = *condition;
+        }
+        else
+        {
+            // Preceding branches were not taken, so remaining chain can
+            // be handed to GLSL compiler as if it was a new conditional.
+            block.mode = BlockMode::PassThrough;
+            block.active = true;
+
+            std::string_view indentation = line.substr(0, line.size() - TrimLeft(line).size());
+            AppendSourceLine(fmt::format("{}#if {}", indentation, directive.arguments));
+        }
+
+        return true;
+    });
+
+    return output;
+}
+
+ShaderPreprocessor::ExpandedSource ShaderPreprocessor::Expand(
+    KeywordMask keywords, const std::vector<std::string>& defines) const
+{
+    LOG_PROFILE_SCOPE("Expand shader source");
+
+    // Defines that name declared keywords enable them, so their blocks can be resolved.
+    std::vector<std::string_view> sourceDefines;
+    for(const std::string& define : defines)
+    {
+        int keywordIndex = FindKeyword(define);
+        if(keywordIndex >= 0)
+        {
+            keywords |= KeywordMask(1) << keywordIndex;
+        }
+        else
+        {
+            sourceDefines.push_back(define);
+        }
+    }
+
+    keywords &= GetAllKeywordsMask();
+
+    ExpandedSource expanded;
+    expanded.hash = Common::StringHash<uint64_t>(m_version);
+
+    for(std::size_t i = 0; i < StageCount; ++i)
+    {
+        const Stage stage = static_cast<Stage>(i);
+        const char* stageDefine = StageDefines[i];
+
+        if(!ContainsIdentifier(m_code, stageDefine))
+            continue;
+
+        std::string code = ResolveConditionals(keywords, stage);
+        std::string& source = expanded.stages[i];
+        source.reserve(m_version.size() + code.size() + 256);
+        source += m_version;
+
+        // Only defines that remaining code can still observe are emitted, so variants
+        // that differ by keywords without effect on this stage produce identical source.
+        if(ContainsIdentifier(code, stageDefine))
+        {
+            AppendDefine(source, stageDefine);
+        }
+
+        for(std::string_view define : sourceDefines)
+        {
+            AppendDefine(source, define);
+        }
+
+        for(std::size_t keywordIndex = 0; keywordIndex < m_keywords.size(); ++keywordIndex)
+        {
+            if((keywords & (KeywordMask(1) << keywordIndex)) == 0)
+                continue;
+
+            if(ContainsIdentifier(code, m_keywords[keywordIndex]))
+            {
+                AppendDefine(source, m_keywords[keywordIndex]);
+            }
+        }
+
+        source += code;
+
+        expanded.hash = Common::CombineHash<uint64_t>(expanded.hash, i);
+        expanded.hash = Common::CombineHash(expanded.hash, Common::StringHash<uint64_t>(source));
+    }
+
+    return expanded;
+}
+
+ShaderPreprocessor::KeywordMask ShaderPreprocessor::GetKeywordMask(const std::vector<std::string>& keywords) const
+{
+    KeywordMask mask = 0;
+    for(const std::string& keyword : keywords)
+    {
+        int keywordIndex = FindKeyword(keyword);
+        if(keywordIndex < 0)
+        {
+            LOG_WARNING("Shader does not declare \"{}\" keyword!", keyword);
+            continue;
+        }
+
+        mask |= KeywordMask(1) << keywordIndex;
+    }
+
+    return mask;
+}
+
+std::vector<ShaderPreprocessor::KeywordMask> ShaderPreprocessor::GetPermutations() const
+{
+    ASSERT(m_keywords.size() <= MaxPermutationKeywords, "Too many keywords to enumerate all permutations!");
+
+    std::vector<KeywordMask> permutations(std::size_t(1) << m_keywords.size());
+    for(std::size_t i = 0; i < permutations.size(); ++i)
+    {
+        permutations[i] = static_cast<KeywordMask>(i);
+    }
+
+    return permutations;
+}
+
+int ShaderPreprocessor::FindKeyword(std::string_view keyword) const
+{
+    auto it = std::find(m_keywords.begin(), m_keywords.end(), keyword);
+    return it != m_keywords.end() ? static_cast<int>(std::distance(m_keywords.begin(), it)) : -1;
+}
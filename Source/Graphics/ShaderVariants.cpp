@@ -0,0 +1,162 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Graphics/Precompiled.hpp"
+#include "Graphics/ShaderVariants.hpp"
+#include <System/FileSystem/FileHandle.hpp>
+using namespace Graphics;
+
+ShaderVariants::ShaderVariants() = default;
+ShaderVariants::~ShaderVariants() = default;
+
+ShaderVariants::CreateResult ShaderVariants::Create(const LoadFromString& params)
+{
+    LOG_PROFILE_SCOPE("Create shader variants");
+
+    // Check arguments.
+    CHECK_ARGUMENT_OR_RETURN(params.renderContext,
+        Common::Failure(CreateErrors::InvalidArgument));
+    CHECK_ARGUMENT_OR_RETURN(!params.shaderCode.empty(),
+        Common::Failure(CreateErrors::InvalidArgument));
+
+    // Create instance.
+    auto instance = std::unique_ptr<ShaderVariants>(new ShaderVariants());
+    instance->m_renderContext = params.renderContext;
+    instance->m_shaderCache = params.shaderCache;
+    instance->m_defines = params.defines;
+
+    // Preprocess shader code once for all variants.
+    ShaderPreprocessor::LoadFromString preprocessorParams;
+    preprocessorParams.includeCallback = params.includeCallback;
+    preprocessorParams.sourcePath = params.sourcePath;
+    preprocessorParams.shaderCode = params.shaderCode;
+
+    instance->m_preprocessor = ShaderPreprocessor::Create(preprocessorParams).UnwrapOr(nullptr);
+    if(instance->m_preprocessor == nullptr)
+    {
+        LOG_ERROR("Could not preprocess shader code!");
+        return Common::Failure(CreateErrors::FailedPreprocessing);
+    }
+
+    return Common::Success(std::move(instance));
+}
+
+ShaderVariants::CreateResult ShaderVariants::Create(System::FileHandle& file, const LoadFromFile& params)
+{
+    LOG_PROFILE_SCOPE("Load shader variants from \"{}\" file",
+        file.GetPath().generic_string());
+
+    LOG_INFO("Loading shader variants from \"{}\" file...",
+        file.GetPath().generic_string());
+
+    // Validate arguments.
+    CHECK_ARGUMENT_OR_RETURN(params.renderContext,
+        Common::Failure(CreateErrors::InvalidArgument));
+
+    // Load shader code from a file.
+    std::string shaderCode = file.ReadAsTextString();
+    if(shaderCode.empty())
+    {
+        LOG_ERROR("Shader file could not be read!");
+        return Common::Failure(CreateErrors::InvalidFileContents);
+    }
+
+    // Create instance.
+    LoadFromString createParams;
+    createParams.renderContext = params.renderContext;
+    createParams.shaderCache = params.shaderCache;
+    createParams.defines = params.defines;
+    createParams.sourcePath = file.GetPath();
+    createParams.shaderCode = std::move(shaderCode);
+
+    if(params.fileSystem != nullptr)
+    {
+        createParams.includeCallback = ShaderPreprocessor::CreateFileIncludeCallback(params.fileSystem);
+    }
+
+    return Create(createParams);
+}
+
+ShaderPtr ShaderVariants::GetVariant(KeywordMask keywords)
+{
+    // Bits of undeclared keywords have no meaning and would only produce duplicate entries.
+    keywords &= m_preprocessor->GetAllKeywordsMask();
+
+    auto variantIt = m_variants.find(keywords);
+    if(variantIt != m_variants.end())
+        return variantIt->second;
+
+    LOG_PROFILE_SCOPE("Create shader variant");
+
+    m_stats.requestedVariants += 1;
+
+    // Variants that expand to identical source share already compiled program. Source is
+    // compared on hash match, so colliding variants are never served wrong program.
+    ShaderPreprocessor::ExpandedSource source = m_preprocessor->Expand(keywords, m_defines);
+
+    auto programRange = m_programs.equal_range(source.hash);
+    for(auto programIt = programRange.first; programIt != programRange.second; ++programIt)
+    {
+        const ShaderPreprocessor::ExpandedSource& programSource = programIt->second.source;
+        if(std::equal(std::begin(programSource.stages), std::end(programSource.stages),
+            std::begin(source.stages)))
+        {
+            m_stats.sharedPrograms += 1;
+            m_variants.emplace(keywords, programIt->second.shader);
+            return programIt->second.shader;
+        }
+    }
+
+    Program program;
+    program.source = source;
+
+    Shader::LoadFromSource shaderParams;
+    shaderParams.renderContext = m_renderContext;
+    shaderParams.shaderCache = m_shaderCache;
+    shaderParams.source = std::move(source);
+
+    // Failed variant is remembered so it does not get compiled again on each request.
+    ShaderPtr shader = Shader::Create(shaderParams).UnwrapOr(nullptr);
+    if(shader != nullptr)
+    {
+        m_stats.compiledPrograms += 1;
+    }
+    else
+    {
+        LOG_ERROR("Could not create shader variant with {:#x} keyword mask!", keywords);
+        m_stats.failedPrograms += 1;
+    }
+
+    program.shader = shader;
+    m_programs.emplace(program.source.hash, std::move(program));
+    m_variants.emplace(keywords, shader);
+    return shader;
+}
+
+ShaderPtr ShaderVariants::GetVariant(const std::vector<std::string>& keywords)
+{
+    return GetVariant(m_preprocessor->GetKeywordMask(keywords));
+}
+
+std::size_t ShaderVariants::WarmUp(const std::vector<KeywordMask>& variants)
+{
+    LOG_PROFILE_SCOPE("Warm up shader variants");
+
+    std::size_t readyCount = 0;
+    for(KeywordMask keywords : variants)
+    {
+        if(GetVariant(keywords) != nullptr)
+        {
+            readyCount += 1;
+        }
+    }
+
+    return readyCount;
+}
+
+std::size_t ShaderVariants::WarmUpAll()
+{
+    return WarmUp(m_preprocessor->GetPermutations());
+}
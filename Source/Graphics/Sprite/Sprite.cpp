@@ -7,6 +7,8 @@
 #include "Graphics/Sprite/Sprite.hpp"
 using namespace Graphics;
 
+static_assert(sizeof(Sprite::CompactData) == 40, "Unexpected compact sprite data size!");
+
 bool Sprite::Info::operator==(const Info& other) const
 {
     return texture == other.texture
@@ -20,3 +22,34 @@ bool Sprite::Info::operator!=(const Info& other) const
         || transparent != other.transparent
         || filtered != other.filtered;
 }
+
+Sprite::CompactData Sprite::PackData(const Data& data)
+{
+    // Fold sprite rectangle into its transform.
+    glm::mat4 transform = glm::translate(data.transform,
+        glm::vec3(data.rectangle.x, data.rectangle.y, 0.0f));
+    transform = glm::scale(transform, glm::vec3(data.rectangle.z - data.rectangle.x,
+        data.rectangle.w - data.rectangle.y, 1.0f));
+
+    // Pack affine transform and normalized integer values.
+    CompactData compact;
+    compact.basis = glm::vec4(transform[0].x, transform[0].y, transform[1].x, transform[1].y);
+    compact.position = glm::vec3(transform[3]);
+    compact.coords = glm::u16vec4(glm::round(glm::clamp(data.coords, 0.0f, 1.0f) * 65535.0f));
+    compact.color = glm::u8vec4(glm::round(glm::clamp(data.color, 0.0f, 1.0f) * 255.0f));
+    return compact;
+}
+
+Sprite::Data Sprite::UnpackData(const CompactData& compact)
+{
+    // Expand affine transform with rectangle already applied.
+    Data data;
+    data.transform[0] = glm::vec4(compact.basis.x, compact.basis.y, 0.0f, 0.0f);
+    data.transform[1] = glm::vec4(compact.basis.z, compact.basis.w, 0.0f, 0.0f);
+    data.transform[2] = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+    data.transform[3] = glm::vec4(compact.position, 1.0f);
+    data.rectangle = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    data.coords = glm::vec4(compact.coords) / 65535.0f;
+    data.color = glm::vec4(compact.color) / 255.0f;
+    return data;
+}
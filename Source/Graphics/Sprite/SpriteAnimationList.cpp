@@ -7,10 +7,345 @@
 #include "Graphics/Sprite/SpriteAnimationList.hpp"
 #include "Graphics/TextureAtlas.hpp"
 #include <Core/SystemStorage.hpp>
+#include <System/FileSystem/FileHandle.hpp>
 #include <System/ResourceManager.hpp>
 #include <Script/ScriptState.hpp>
+#include <Script/ScriptStatePool.hpp>
 using namespace Graphics;
 
+namespace
+{
+    const uint32_t CompiledFileMagic = 0x4D494E41; // "ANIM"
+    const uint32_t CompiledFileVersion = 2;
+
+    struct CompiledFileHeader
+    {
+        uint32_t magic = CompiledFileMagic;
+        uint32_t version = CompiledFileVersion;
+        uint32_t textureAtlasPathLength = 0;
+        uint32_t animationCount = 0;
+        uint32_t frameCount = 0;
+    };
+
+    struct CompiledAnimationEntry
+    {
+        uint32_t firstFrame = 0;
+        uint32_t frameCount = 0;
+    };
+
+    struct FrameDefinition
+    {
+        std::string regionName;
+        float duration = 0.0f;
+    };
+
+    struct AnimationListDefinition
+    {
+        std::string textureAtlasPath;
+        std::vector<std::pair<std::string, std::vector<FrameDefinition>>> animations;
+    };
+
+    struct CompiledAnimationList
+    {
+        std::string textureAtlasPath;
+        std::vector<uint64_t> animationHashes;
+        std::vector<CompiledAnimationEntry> animations;
+        std::vector<uint64_t> frameRegionHashes;
+        std::vector<float> frameDurations;
+    };
+
+    using DefinitionResult = Common::Result<AnimationListDefinition,
+        SpriteAnimationList::CreateErrors>;
+
+    DefinitionResult LoadDefinition(System::FileHandle& file, Script::ScriptStatePool* statePool)
+    {
+        // Load resource script, using pooled state when available.
+        auto resourceScript = Script::ScriptStatePool::AcquireFrom(statePool);
+        if(resourceScript == nullptr || !resourceScript->Execute(file.ReadAsTextString(),
+            ("@" + file.GetPath().generic_string()).c_str()))
+        {
+            LOG_ERROR("Could not load sprite animation list resource file!");
+            return Common::Failure(SpriteAnimationList::CreateErrors::FailedResourceLoading);
+        }
+
+        // Get global table.
+        lua_getglobal(*resourceScript, "SpriteAnimationList");
+        SCOPE_GUARD([&resourceScript]
+        {
+            lua_pop(*resourceScript, 1);
+        });
+
+        if(!lua_istable(*resourceScript, -1))
+        {
+            LOG_ERROR("Table \"SpriteAnimationList\" is missing!");
+            return Common::Failure(SpriteAnimationList::CreateErrors::InvalidResourceContents);
+        }
+
+        AnimationListDefinition definition;
+
+        // Read texture atlas path.
+        {
+            lua_getfield(*resourceScript, -1, "TextureAtlas");
+            SCOPE_GUARD([&resourceScript]
+            {
+                lua_pop(*resourceScript, 1);
+            });
+
+            if(!lua_isstring(*resourceScript, -1))
+            {
+                LOG_ERROR("String \"SpriteAnimationList.TextureAtlas\" is missing!");
+                return Common::Failure(SpriteAnimationList::CreateErrors::InvalidResourceContents);
+            }
+
+            definition.textureAtlasPath = lua_tostring(*resourceScript, -1);
+        }
+
+        // Read animation entries.
+        lua_getfield(*resourceScript, -1, "Animations");
+        SCOPE_GUARD([&resourceScript]
+        {
+            lua_pop(*resourceScript, 1);
+        });
+
+        if(!lua_istable(*resourceScript, -1))
+        {
+            LOG_ERROR("Table \"SpriteAnimationList.Animations\" is missing!");
+            return Common::Failure(SpriteAnimationList::CreateErrors::InvalidResourceContents);
+        }
+
+        for(lua_pushnil(*resourceScript); lua_next(*resourceScript, -2); lua_pop(*resourceScript, 1))
+        {
+            // Check if key is a string.
+            if(!lua_isstring(*resourceScript, -2))
+            {
+                LOG_WARNING("Key \"SpriteAnimationList.Animations\" is not a string!");
+                LOG_WARNING("Skipping one ill formated sprite animation!");
+                continue;
+            }
+
+            std::string animationName = lua_tostring(*resourceScript, -2);
+
+            // Read animation frames.
+            std::vector<FrameDefinition> frames;
+
+            for(lua_pushnil(*resourceScript);
+                lua_next(*resourceScript, -2);
+                lua_pop(*resourceScript, 1))
+            {
+                // Make sure that we have a table.
+                if(!lua_istable(*resourceScript, -1))
+                {
+                    LOG_WARNING("Value in \"SpriteAnimationList.Animations[\"{}\"]\" "
+                        "is not a table!", animationName);
+                    LOG_WARNING("Skipping one ill formated sprite animation frame!");
+                    continue;
+                }
+
+                FrameDefinition frame;
+
+                // Get sequence frame.
+                {
+                    lua_pushinteger(*resourceScript, 1);
+                    lua_gettable(*resourceScript, -2);
+                    SCOPE_GUARD([&resourceScript]
+                    {
+                        lua_pop(*resourceScript, 1);
+                    });
+
+                    if(!lua_isstring(*resourceScript, -1))
+                    {
+                        LOG_WARNING("Field in \"SpriteAnimationList.Animations[{}][0]\" "
+                            "is not a string!", animationName);
+                        LOG_WARNING("Skipping one ill formated sprite animation frame!");
+                        continue;
+                    }
+
+                    frame.regionName = lua_tostring(*resourceScript, -1);
+                }
+
+                // Get frame duration.
+                {
+                    lua_pushinteger(*resourceScript, 2);
+                    lua_gettable(*resourceScript, -2);
+                    SCOPE_GUARD([&resourceScript]
+                    {
+                        lua_pop(*resourceScript, 1);
+                    });
+
+                    if(!lua_isnumber(*resourceScript, -1))
+                    {
+                        LOG_WARNING("Field in \"SpriteAnimationList.Animations[\"{}\"][1]\" "
+                            "is not a number!", animationName);
+                        LOG_WARNING("Skipping one ill formated sprite animation frame!");
+                        continue;
+                    }
+
+                    frame.duration = (float)lua_tonumber(*resourceScript, -1);
+                }
+
+                // Add frame to animation.
+                frames.emplace_back(std::move(frame));
+            }
+
+            // Add animation to list.
+            definition.animations.emplace_back(std::move(animationName), std::move(frames));
+        }
+
+        return Common::Success(std::move(definition));
+    }
+
+    bool CompileDefinition(const AnimationListDefinition& definition, CompiledAnimationList& compiled)
+    {
+        // Sort animations by hash of their names, which must not collide.
+        std::vector<std::pair<uint64_t, std::size_t>> order;
+        order.reserve(definition.animations.size());
+
+        for(std::size_t index = 0; index < definition.animations.size(); ++index)
+        {
+            order.emplace_back(SpriteAnimationList::GetAnimationHash(
+                definition.animations[index].first), index);
+        }
+
+        std::sort(order.begin(), order.end());
+
+        compiled.textureAtlasPath = definition.textureAtlasPath;
+        compiled.animationHashes.reserve(order.size());
+        compiled.animations.reserve(order.size());
+
+        for(std::size_t index = 0; index < order.size(); ++index)
+        {
+            const auto& [animationHash, animationIndex] = order[index];
+            const auto& [animationName, frames] = definition.animations[animationIndex];
+
+            if(!compiled.animationHashes.empty() && compiled.animationHashes.back() == animationHash)
+            {
+                LOG_ERROR("Hash of \"{}\" animation name collides with \"{}\" animation name!",
+                    animationName, definition.animations[order[index - 1].second].first);
+                return false;
+            }
+
+            // Store frames of all animations in single array.
+            CompiledAnimationEntry& entry = compiled.animations.emplace_back();
+            entry.firstFrame = Common::NumericalCast<uint32_t>(compiled.frameRegionHashes.size());
+            entry.frameCount = Common::NumericalCast<uint32_t>(frames.size());
+
+            for(const FrameDefinition& frame : frames)
+            {
+                compiled.frameRegionHashes.push_back(TextureAtlas::GetRegionHash(frame.regionName));
+                compiled.frameDurations.push_back(frame.duration);
+            }
+
+            compiled.animationHashes.push_back(animationHash);
+        }
+
+        return true;
+    }
+
+    bool IsCompiledFile(System::FileHandle& file)
+    {
+        // Peek at file magic and restore read position after.
+        const uint64_t position = file.Tell();
+        SCOPE_GUARD([&file, position]()
+        {
+            file.Seek(position);
+        });
+
+        uint32_t magic = 0;
+        file.Seek(0);
+        return file.Read(magic) && magic == CompiledFileMagic;
+    }
+
+    bool ReadCompiled(System::FileHandle& file, CompiledAnimationList& compiled)
+    {
+        // Read whole file at once and validate sizes of its arrays.
+        const std::vector<uint8_t> data = file.ReadAsBinaryArray();
+        if(data.size() != file.GetSize() || data.size() < sizeof(CompiledFileHeader))
+            return false;
+
+        CompiledFileHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if(header.magic != CompiledFileMagic || header.version != CompiledFileVersion)
+        {
+            LOG_ERROR("Unknown compiled sprite animation list format version!");
+            return false;
+        }
+
+        const std::size_t expectedSize = sizeof(header) + header.textureAtlasPathLength +
+            static_cast<std::size_t>(header.animationCount) *
+                (sizeof(uint64_t) + sizeof(CompiledAnimationEntry)) +
+            static_cast<std::size_t>(header.frameCount) * (sizeof(uint64_t) + sizeof(float));
+
+        if(data.size() != expectedSize)
+            return false;
+
+        // Copy arrays that are already sorted by name hash.
+        const uint8_t* input = data.data() + sizeof(header);
+        compiled.textureAtlasPath.assign(reinterpret_cast<const char*>(input),
+            header.textureAtlasPathLength);
+        input += header.textureAtlasPathLength;
+
+        compiled.animationHashes.resize(header.animationCount);
+        std::memcpy(compiled.animationHashes.data(), input, header.animationCount * sizeof(uint64_t));
+        input += header.animationCount * sizeof(uint64_t);
+
+        compiled.animations.resize(header.animationCount);
+        std::memcpy(compiled.animations.data(), input,
+            header.animationCount * sizeof(CompiledAnimationEntry));
+        input += header.animationCount * sizeof(CompiledAnimationEntry);
+
+        compiled.frameRegionHashes.resize(header.frameCount);
+        std::memcpy(compiled.frameRegionHashes.data(), input, header.frameCount * sizeof(uint64_t));
+        input += header.frameCount * sizeof(uint64_t);
+
+        compiled.frameDurations.resize(header.frameCount);
+        std::memcpy(compiled.frameDurations.data(), input, header.frameCount * sizeof(float));
+
+        // Validate frame ranges before they are used to index frame array.
+        for(const CompiledAnimationEntry& entry : compiled.animations)
+        {
+            if(entry.firstFrame > header.frameCount ||
+                entry.frameCount > header.frameCount - entry.firstFrame)
+            {
+                return false;
+            }
+        }
+
+        return std::adjacent_find(compiled.animationHashes.begin(), compiled.animationHashes.end(),
+            std::greater_equal<uint64_t>()) == compiled.animationHashes.end();
+    }
+
+    bool WriteCompiled(const CompiledAnimationList& compiled, System::FileHandle& file)
+    {
+        // Write header followed by texture atlas path, hash table, animation and frame arrays.
+        CompiledFileHeader header;
+        header.textureAtlasPathLength = Common::NumericalCast<uint32_t>(
+            compiled.textureAtlasPath.size());
+        header.animationCount = Common::NumericalCast<uint32_t>(compiled.animations.size());
+        header.frameCount = Common::NumericalCast<uint32_t>(compiled.frameDurations.size());
+
+        std::vector<uint8_t> data(sizeof(header) + header.textureAtlasPathLength +
+            header.animationCount * (sizeof(uint64_t) + sizeof(CompiledAnimationEntry)) +
+            header.frameCount * (sizeof(uint64_t) + sizeof(float)));
+
+        uint8_t* output = data.data();
+        std::memcpy(output, &header, sizeof(header));
+        output += sizeof(header);
+        std::memcpy(output, compiled.textureAtlasPath.data(), header.textureAtlasPathLength);
+        output += header.textureAtlasPathLength;
+        std::memcpy(output, compiled.animationHashes.data(), header.animationCount * sizeof(uint64_t));
+        output += header.animationCount * sizeof(uint64_t);
+        std::memcpy(output, compiled.animations.data(),
+            header.animationCount * sizeof(CompiledAnimationEntry));
+        output += header.animationCount * sizeof(CompiledAnimationEntry);
+        std::memcpy(output, compiled.frameRegionHashes.data(), header.frameCount * sizeof(uint64_t));
+        output += header.frameCount * sizeof(uint64_t);
+        std::memcpy(output, compiled.frameDurations.data(), header.frameCount * sizeof(float));
+
+        return file.Write(data.data(), data.size()) == data.size();
+    }
+}
+
 SpriteAnimationList::Frame::Frame() = default;
 SpriteAnimationList::Frame::Frame(TextureView&& textureView, float duration)
     : textureView(std::move(textureView))
@@ -18,19 +353,54 @@ SpriteAnimationList::Frame::Frame(TextureView&& textureView, float duration)
 {
 }
 
-SpriteAnimationList::Frame SpriteAnimationList::Animation::GetFrameByTime(float animationTime) const
+void SpriteAnimationList::Animation::AddFrame(TextureView textureView, float frameDuration)
 {
-    // Calculate current frame.
-    for(const auto& frame : frames)
+    ASSERT(frameDuration >= 0.0f, "Sprite animation frame has an invalid duration!");
+
+    // Frame durations are uniform until first frame with different duration is added.
+    if(frames.empty())
     {
-        if(animationTime <= frame.duration)
-            return frame;
+        uniformFrameDuration = frameDuration;
+    }
+    else if(uniformFrameDuration != frameDuration)
+    {
+        uniformFrameDuration = 0.0f;
+    }
+
+    frames.emplace_back(std::move(textureView), frameDuration);
+    duration += frameDuration;
+    frameEndTimes.push_back(duration);
+}
 
-        animationTime -= frame.duration;
+uint32_t SpriteAnimationList::Animation::GetFrameIndexByTime(float animationTime) const
+{
+    // Return invalid index if animation time does not correspond to any frame.
+    if(frames.empty() || animationTime > duration)
+        return InvalidFrameIndex;
+
+    // Frame that ends exactly at animation time is still current one.
+    if(uniformFrameDuration > 0.0f)
+    {
+        const float frameIndex = std::ceil(animationTime / uniformFrameDuration) - 1.0f;
+        return std::min(static_cast<uint32_t>(std::max(frameIndex, 0.0f)),
+            static_cast<uint32_t>(frames.size() - 1));
     }
 
+    auto it = std::lower_bound(frameEndTimes.begin(), frameEndTimes.end(), animationTime);
+    if(it == frameEndTimes.end())
+        return InvalidFrameIndex;
+
+    return static_cast<uint32_t>(std::distance(frameEndTimes.begin(), it));
+}
+
+SpriteAnimationList::Frame SpriteAnimationList::Animation::GetFrameByTime(float animationTime) const
+{
     // Return empty frame if animation time does not correspond to any.
-    return SpriteAnimationList::Frame();
+    const uint32_t frameIndex = GetFrameIndexByTime(animationTime);
+    if(frameIndex == InvalidFrameIndex)
+        return SpriteAnimationList::Frame();
+
+    return frames[frameIndex];
 }
 
 SpriteAnimationList::SpriteAnimationList() = default;
@@ -45,6 +415,45 @@ SpriteAnimationList::CreateResult SpriteAnimationList::Create()
     return Common::Success(std::move(instance));
 }
 
+SpriteAnimationList::CreateResult SpriteAnimationList::Create(const CreateFromParams& params)
+{
+    LOG_PROFILE_SCOPE("Create sprite animation list from {} animations", params.animations.size());
+
+    // Sort animations by name hash, same as compiled files store them.
+    std::vector<std::pair<uint64_t, std::size_t>> order;
+    order.reserve(params.animations.size());
+
+    for(std::size_t index = 0; index < params.animations.size(); ++index)
+    {
+        order.emplace_back(GetAnimationHash(params.animations[index].first), index);
+    }
+
+    std::sort(order.begin(), order.end());
+
+    // Create class instance.
+    auto instance = std::unique_ptr<SpriteAnimationList>(new SpriteAnimationList());
+    instance->m_animationHashes.reserve(order.size());
+    instance->m_animationList.reserve(order.size());
+
+    for(std::size_t index = 0; index < order.size(); ++index)
+    {
+        const auto& [animationHash, animationIndex] = order[index];
+        const auto& [animationName, animation] = params.animations[animationIndex];
+
+        if(!instance->m_animationHashes.empty() && instance->m_animationHashes.back() == animationHash)
+        {
+            LOG_ERROR("Hash of \"{}\" animation name collides with \"{}\" animation name!",
+                animationName, params.animations[order[index - 1].second].first);
+            return Common::Failure(CreateErrors::InvalidArgument);
+        }
+
+        instance->m_animationHashes.push_back(animationHash);
+        instance->m_animationList.push_back(animation);
+    }
+
+    return Common::Success(std::move(instance));
+}
+
 SpriteAnimationList::CreateResult SpriteAnimationList::Create(
     System::FileHandle& file, const LoadFromFile& params)
 {
@@ -71,168 +480,100 @@ SpriteAnimationList::CreateResult SpriteAnimationList::Create(
 
     auto instance = createResult.Unwrap();
 
-    // Load resource script.
-    Script::ScriptState::LoadFromFile resourceParams;
-    resourceParams.engineSystems = params.engineSystems;
-
-    auto resourceScript = Script::ScriptState::Create(file, resourceParams).UnwrapOr(nullptr);
-    if(resourceScript == nullptr)
-    {
-        LOG_ERROR("Could not load sprite animation list resource file!");
-        return Common::Failure(CreateErrors::FailedResourceLoading);
-    }
-
-    // Get global table.
-    lua_getglobal(*resourceScript, "SpriteAnimationList");
-    SCOPE_GUARD([&resourceScript]
-    {
-        lua_pop(*resourceScript, 1);
-    });
+    // Read animations from compiled file or from resource script.
+    CompiledAnimationList compiled;
 
-    if(!lua_istable(*resourceScript, -1))
+    if(IsCompiledFile(file))
     {
-        LOG_ERROR("Table \"SpriteAnimationList\" is missing!");
-        return Common::Failure(CreateErrors::InvalidResourceContents);
+        if(!ReadCompiled(file, compiled))
+        {
+            LOG_ERROR("Could not read compiled sprite animation list file!");
+            return Common::Failure(CreateErrors::InvalidResourceContents);
+        }
     }
-
-    // Load texture atlas.
-    std::shared_ptr<TextureAtlas> textureAtlas;
+    else
     {
-        lua_getfield(*resourceScript, -1, "TextureAtlas");
-        SCOPE_GUARD([&resourceScript]
+        auto definitionResult = LoadDefinition(file,
+            params.engineSystems->Locate<Script::ScriptStatePool>());
+        if(!definitionResult)
         {
-            lua_pop(*resourceScript, 1);
-        });
+            return Common::Failure(definitionResult.UnwrapFailure());
+        }
 
-        if(!lua_isstring(*resourceScript, -1))
+        if(!CompileDefinition(definitionResult.Unwrap(), compiled))
         {
-            LOG_ERROR("String \"SpriteAnimationList.TextureAtlas\" is missing!");
             return Common::Failure(CreateErrors::InvalidResourceContents);
         }
+    }
 
-        std::filesystem::path textureAtlasPath = lua_tostring(*resourceScript, -1);
+    // Load texture atlas.
+    TextureAtlas::LoadFromFile textureAtlasParams;
+    textureAtlasParams.engineSystems = params.engineSystems;
 
-        TextureAtlas::LoadFromFile textureAtlasParams;
-        textureAtlasParams.engineSystems = params.engineSystems;
-        textureAtlas = resourceManager->AcquireRelative<TextureAtlas>(
-            textureAtlasPath, file.GetPath(), textureAtlasParams).UnwrapOr(nullptr);
+    std::shared_ptr<TextureAtlas> textureAtlas = resourceManager->AcquireRelative<TextureAtlas>(
+        compiled.textureAtlasPath, file.GetPath(), textureAtlasParams).UnwrapOr(nullptr);
 
-        if(textureAtlas == nullptr)
-        {
-            LOG_ERROR("Could not load referenced texture atlas!");
-            return Common::Failure(CreateErrors::FailedResourceLoading);
-        }
+    if(textureAtlas == nullptr)
+    {
+        LOG_ERROR("Could not load referenced texture atlas!");
+        return Common::Failure(CreateErrors::FailedResourceLoading);
     }
 
-    // Read animation entries.
-    lua_getfield(*resourceScript, -1, "Animations");
-    SCOPE_GUARD([&resourceScript]
-    {
-        lua_pop(*resourceScript, 1);
-    });
+    // Resolve frames of animations in their sorted order.
+    instance->m_animationHashes = std::move(compiled.animationHashes);
+    instance->m_animationList.resize(compiled.animations.size());
 
-    if(!lua_istable(*resourceScript, -1))
+    for(std::size_t index = 0; index < compiled.animations.size(); ++index)
     {
-        LOG_ERROR("Table \"SpriteAnimationList.Animations\" is missing!");
-        return Common::Failure(CreateErrors::InvalidResourceContents);
-    }
+        const CompiledAnimationEntry& entry = compiled.animations[index];
+        Animation& animation = instance->m_animationList[index];
+        animation.frames.reserve(entry.frameCount);
+        animation.frameEndTimes.reserve(entry.frameCount);
 
-    for(lua_pushnil(*resourceScript); lua_next(*resourceScript, -2); lua_pop(*resourceScript, 1))
-    {
-        // Check if key is a string.
-        if(!lua_isstring(*resourceScript, -2))
+        for(uint32_t frame = entry.firstFrame; frame < entry.firstFrame + entry.frameCount; ++frame)
         {
-            LOG_WARNING("Key \"SpriteAnimationList.Animations\" is not a string!");
-            LOG_WARNING("Skipping one ill formated sprite animation!");
-            continue;
+            animation.AddFrame(textureAtlas->GetRegionByHash(compiled.frameRegionHashes[frame]),
+                compiled.frameDurations[frame]);
         }
+    }
 
-        std::string animationName = lua_tostring(*resourceScript, -2);
-
-        // Read animation frames.
-        Animation animation;
-
-        for(lua_pushnil(*resourceScript);
-            lua_next(*resourceScript, -2);
-            lua_pop(*resourceScript, 1))
-        {
-            // Make sure that we have a table.
-            if(!lua_istable(*resourceScript, -1))
-            {
-                LOG_WARNING("Value in \"SpriteAnimationList.Animations[\"{}\"]\" "
-                    "is not a table!", animationName);
-                LOG_WARNING("Skipping one ill formated sprite animation frame!");
-                continue;
-            }
-
-            // Get sequence frame.
-            TextureView textureView;
-
-            {
-                lua_pushinteger(*resourceScript, 1);
-                lua_gettable(*resourceScript, -2);
-                SCOPE_GUARD([&resourceScript]
-                {
-                    lua_pop(*resourceScript, 1);
-                });
-
-                if(!lua_isstring(*resourceScript, -1))
-                {
-                    LOG_WARNING("Field in \"SpriteAnimationList.Animations[{}][0]\" "
-                        "is not a string!", animationName);
-                    LOG_WARNING("Skipping one ill formated sprite animation frame!");
-                    continue;
-                }
-
-                textureView = textureAtlas->GetRegion(lua_tostring(*resourceScript, -1));
-            }
-
-            // Get frame duration.
-            float frameDuration = 0.0f;
-
-            {
-                lua_pushinteger(*resourceScript, 2);
-                lua_gettable(*resourceScript, -2);
-                SCOPE_GUARD([&resourceScript]
-                {
-                    lua_pop(*resourceScript, 1);
-                });
+    return Common::Success(std::move(instance));
+}
 
-                if(!lua_isnumber(*resourceScript, -1))
-                {
-                    LOG_WARNING("Field in \"SpriteAnimationList.Animations[\"{}\"][1]\" "
-                        "is not a number!", animationName);
-                    LOG_WARNING("Skipping one ill formated sprite animation frame!");
-                    continue;
-                }
+bool SpriteAnimationList::Compile(System::FileHandle& sourceFile, System::FileHandle& outputFile)
+{
+    LOG_PROFILE_SCOPE("Compile sprite animation list from \"{}\" file",
+        sourceFile.GetPath().generic_string());
 
-                frameDuration = (float)lua_tonumber(*resourceScript, -1);
-            }
+    auto definitionResult = LoadDefinition(sourceFile, nullptr);
+    if(!definitionResult)
+        return false;
 
-            // Add frame to animation.
-            animation.frames.emplace_back(std::move(textureView), frameDuration);
-            animation.duration += frameDuration;
-        }
+    CompiledAnimationList compiled;
+    if(!CompileDefinition(definitionResult.Unwrap(), compiled))
+        return false;
 
-        // Add animation to list.
-        instance->m_animationList.emplace_back(std::move(animation));
-        instance->m_animationMap.emplace(animationName,
-            Common::NumericalCast<uint32_t>(instance->m_animationList.size() - 1));
-    }
+    return WriteCompiled(compiled, outputFile);
+}
 
-    return Common::Success(std::move(instance));
+uint64_t SpriteAnimationList::GetAnimationHash(std::string_view animationName)
+{
+    return Common::StringHash<uint64_t>(animationName);
 }
 
 SpriteAnimationList::AnimationIndexResult
-    SpriteAnimationList::GetAnimationIndex(std::string animationName) const
+    SpriteAnimationList::GetAnimationIndex(std::string_view animationName) const
 {
-    auto it = m_animationMap.find(animationName);
-    if(it == m_animationMap.end())
+    // Index of animation is its position in sorted hash table.
+    const uint64_t hash = GetAnimationHash(animationName);
+    auto it = std::lower_bound(m_animationHashes.begin(), m_animationHashes.end(), hash);
+    if(it == m_animationHashes.end() || *it != hash)
     {
         return Common::Failure();
     }
 
-    return Common::Success(it->second);
+    return Common::Success(Common::NumericalCast<uint32_t>(
+        std::distance(m_animationHashes.begin(), it)));
 }
 
 const SpriteAnimationList::Animation*
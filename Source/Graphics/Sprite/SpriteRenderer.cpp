@@ -7,8 +7,10 @@
 #include "Graphics/Sprite/SpriteRenderer.hpp"
 #include "Graphics/RenderContext.hpp"
 #include "Graphics/Texture.hpp"
+#include "Graphics/ShaderCache.hpp"
 #include <Core/SystemStorage.hpp>
 #include <Core/ConfigSystem.hpp>
+#include <System/FileSystem/FileSystem.hpp>
 #include <System/ResourceManager.hpp>
 using namespace Graphics;
 
@@ -50,10 +52,21 @@ bool Graphics::SpriteRenderer::OnAttach(const Core::EngineSystemStorage& engineS
         return false;
     }
 
+    auto* shaderCache = engineSystems.Locate<Graphics::ShaderCache>();
+    if(shaderCache == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate shader cache.");
+        return false;
+    }
+
     m_spriteBatchSize = configSystem->Get<std::size_t>(
         NAME_CONSTEXPR("render.spriteBatchSize"))
         .UnwrapOr(m_spriteBatchSize);
 
+    m_compactInstances = configSystem->Get<bool>(
+        NAME_CONSTEXPR("render.spriteCompactInstances"))
+        .UnwrapOr(m_compactInstances);
+
     // Create vertex buffer.
     const SpriteVertex SpriteVertices[4] =
     {
@@ -81,7 +94,8 @@ bool Graphics::SpriteRenderer::OnAttach(const Core::EngineSystemStorage& engineS
     Buffer::CreateFromParams instanceBufferParams;
     instanceBufferParams.renderContext = m_renderContext;
     instanceBufferParams.usage = GL_STREAM_DRAW;
-    instanceBufferParams.elementSize = sizeof(Sprite::Data);
+    instanceBufferParams.elementSize = m_compactInstances ?
+        sizeof(Sprite::CompactData) : sizeof(Sprite::Data);
     instanceBufferParams.elementCount = m_spriteBatchSize;
     instanceBufferParams.data = nullptr;
 
@@ -112,9 +126,36 @@ bool Graphics::SpriteRenderer::OnAttach(const Core::EngineSystemStorage& engineS
         { m_instanceBuffer.get(), VertexArray::AttributeType::Vector4,   GL_FLOAT, false },
     };
 
+    const VertexArray::Attribute compactVertexAttributes[] =
+    {
+        /*
+            1: Position
+            2: Texture
+            3: Basis
+            4: Position
+            5: Coordinates
+            6: Color
+        */
+
+        { m_vertexBuffer.get(),   VertexArray::AttributeType::Vector2, GL_FLOAT,          false },
+        { m_vertexBuffer.get(),   VertexArray::AttributeType::Vector2, GL_FLOAT,          false },
+        { m_instanceBuffer.get(), VertexArray::AttributeType::Vector4, GL_FLOAT,          false },
+        { m_instanceBuffer.get(), VertexArray::AttributeType::Vector3, GL_FLOAT,          false },
+        { m_instanceBuffer.get(), VertexArray::AttributeType::Vector4, GL_UNSIGNED_SHORT, true  },
+        { m_instanceBuffer.get(), VertexArray::AttributeType::Vector4, GL_UNSIGNED_BYTE,  true  },
+    };
+
     VertexArray::FromArrayParams vertexArrayParams;
-    vertexArrayParams.attributeCount = Common::StaticArraySize(vertexAttributes);
-    vertexArrayParams.attributes = &vertexAttributes[0];
+    if(m_compactInstances)
+    {
+        vertexArrayParams.attributeCount = Common::StaticArraySize(compactVertexAttributes);
+        vertexArrayParams.attributes = &compactVertexAttributes[0];
+    }
+    else
+    {
+        vertexArrayParams.attributeCount = Common::StaticArraySize(vertexAttributes);
+        vertexArrayParams.attributes = &vertexAttributes[0];
+    }
 
     m_vertexArray = VertexArray::Create(m_renderContext, vertexArrayParams).UnwrapOr(nullptr);
     if(m_vertexArray == nullptr)
@@ -149,20 +190,42 @@ bool Graphics::SpriteRenderer::OnAttach(const Core::EngineSystemStorage& engineS
         return false;
     }
 
-    // Load shader.
-    Shader::LoadFromFile shaderParams;
+    // Load shader variants and compile variant for used instance layout ahead of first draw.
+    ShaderVariants::LoadFromFile shaderParams;
     shaderParams.renderContext = m_renderContext;
+    shaderParams.shaderCache = shaderCache;
+    shaderParams.fileSystem = engineSystems.Locate<System::FileSystem>();
 
-    m_shader = resourceManager->Acquire<Shader>(
+    m_shaderVariants = resourceManager->Acquire<ShaderVariants>(
         "Data/Engine/Shaders/Sprite.shader", shaderParams)
         .UnwrapOr(nullptr);
 
-    if(m_shader == nullptr)
+    if(m_shaderVariants == nullptr)
     {
         LOG_ERROR(LogAttachFailed, "Could not load sprite shader!");
         return false;
     }
 
+    std::vector<std::string> shaderKeywords;
+    if(m_compactInstances)
+    {
+        shaderKeywords.push_back("COMPACT_INSTANCE");
+    }
+
+    const ShaderVariants::KeywordMask shaderVariant = m_shaderVariants->GetKeywordMask(shaderKeywords);
+    m_shaderVariants->WarmUp({ shaderVariant });
+
+    m_shader = m_shaderVariants->GetVariant(shaderVariant);
+    if(m_shader == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not compile sprite shader!");
+        return false;
+    }
+
+    // Resolve shader uniforms once.
+    m_vertexTransformUniform = m_shader->GetUniform(NAME_CONSTEXPR("vertexTransform"));
+    m_textureDiffuseUniform = m_shader->GetUniform(NAME_CONSTEXPR("textureDiffuse"));
+
     return true;
 }
 
@@ -181,8 +244,9 @@ void SpriteRenderer::DrawSprites(const SpriteDrawList& sprites, const glm::mat4&
     renderState.UseProgram(m_shader->GetHandle());
 
     // Set shader uniforms.
-    m_shader->SetUniform("vertexTransform", transform);
-    m_shader->SetUniform("textureDiffuse", 0);
+    Shader::UniformBatch(*m_shader)
+        .Set(m_vertexTransformUniform, transform)
+        .Set(m_textureDiffuseUniform, 0);
 
     // Get sprite info and data arrays.
     const auto& spriteInfo = sprites.GetSpriteInfo();
@@ -217,7 +281,20 @@ void SpriteRenderer::DrawSprites(const SpriteDrawList& sprites, const glm::mat4&
         }
 
         // Update buffer with sprite data and instances.
-        m_instanceBuffer->Update(&spriteData[spritesDrawn], spritesBatched);
+        if(m_compactInstances)
+        {
+            m_compactData.resize(spritesBatched);
+            for(std::size_t i = 0; i < spritesBatched; ++i)
+            {
+                m_compactData[i] = Sprite::PackData(spriteData[spritesDrawn + i]);
+            }
+
+            m_instanceBuffer->Update(m_compactData.data(), spritesBatched);
+        }
+        else
+        {
+            m_instanceBuffer->Update(&spriteData[spritesDrawn], spritesBatched);
+        }
 
         // Set batch render state.
         if(batchInfo.transparent)
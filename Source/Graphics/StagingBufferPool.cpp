@@ -0,0 +1,87 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Graphics/Precompiled.hpp"
+#include "Graphics/StagingBufferPool.hpp"
+using namespace Graphics;
+
+StagingBufferPool::StagingBufferPool(std::size_t maxPooledBytes)
+    : m_maxPooledBytes(maxPooledBytes)
+{
+}
+
+StagingBufferPool::~StagingBufferPool() = default;
+
+StagingBufferPool::Buffer StagingBufferPool::Acquire(std::size_t size)
+{
+    Buffer buffer;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.acquiredBuffers += 1;
+
+        // Buffers are kept sorted by capacity, so first large enough buffer fits best.
+        auto it = std::lower_bound(m_buffers.begin(), m_buffers.end(), size,
+            [](const Buffer& buffer, std::size_t size)
+            {
+                return buffer.capacity() < size;
+            });
+
+        if(it != m_buffers.end())
+        {
+            buffer = std::move(*it);
+            m_buffers.erase(it);
+
+            m_stats.reusedBuffers += 1;
+            m_stats.pooledBytes -= buffer.capacity();
+        }
+    }
+
+    // Allocate outside of lock when pool has no buffer to reuse.
+    buffer.clear();
+    buffer.reserve(size);
+    return buffer;
+}
+
+void StagingBufferPool::Release(Buffer&& buffer)
+{
+    Buffer released = std::move(buffer);
+    if(released.capacity() == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_stats.pooledBytes + released.capacity() > m_maxPooledBytes)
+    {
+        m_stats.discardedBuffers += 1;
+        return;
+    }
+
+    m_stats.pooledBytes += released.capacity();
+
+    auto it = std::lower_bound(m_buffers.begin(), m_buffers.end(), released.capacity(),
+        [](const Buffer& buffer, std::size_t capacity)
+        {
+            return buffer.capacity() < capacity;
+        });
+
+    m_buffers.insert(it, std::move(released));
+}
+
+void StagingBufferPool::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers.clear();
+    m_stats.pooledBytes = 0;
+}
+
+StagingBufferPool::Stats StagingBufferPool::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Stats stats = m_stats;
+    stats.pooledBuffers = m_buffers.size();
+    return stats;
+}
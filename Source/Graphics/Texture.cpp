@@ -6,16 +6,41 @@
 #include "Graphics/Precompiled.hpp"
 #include "Graphics/Texture.hpp"
 #include "Graphics/RenderContext.hpp"
+#include "Graphics/DynamicAtlas.hpp"
+#include "Graphics/TextureStreamer.hpp"
 #include <Core/SystemStorage.hpp>
+#include <System/FileSystem/FileSystem.hpp>
 #include <System/FileSystem/FileHandle.hpp>
 #include <System/Image.hpp>
+#include <System/KtxImage.hpp>
 using namespace Graphics;
 
+namespace
+{
+    bool SetUnpackAlignment(GLenum format, int width)
+    {
+        // Rows of tightly packed pixel data are not always aligned to four bytes.
+        if((width * Texture::GetFormatChannels(format)) % 4 == 0)
+            return false;
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        return true;
+    }
+}
+
 Texture::Texture() = default;
 Texture::~Texture()
 {
+    // Stop streamer from uploading to texture that no longer exists.
+    if(m_streamRequest != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_streamRequest->mutex);
+        m_streamRequest->texture = nullptr;
+    }
+
     if(m_handle != OpenGL::InvalidHandle)
     {
+        m_renderContext->AcquireContext();
         glDeleteTextures(1, &m_handle);
         OpenGL::CheckErrors();
     }
@@ -37,51 +62,28 @@ Texture::CreateResult Texture::Create(const CreateFromParams& params)
 
     // Create class instance.
     auto instance = std::unique_ptr<Texture>(new Texture());
+    instance->m_renderContext = params.renderContext;
+    instance->m_format = params.format;
+    instance->m_width = params.width;
+    instance->m_height = params.height;
 
-    // Create texture handle.
-    glGenTextures(1, &instance->m_handle);
-    OpenGL::CheckErrors();
-
-    if(instance->m_handle == OpenGL::InvalidHandle)
-    {
-        LOG_ERROR("Texture could not be created!");
-        return Common::Failure(CreateErrors::FailedTextureCreation);
-    }
-
-    glBindTexture(GL_TEXTURE_2D, instance->m_handle);
-    OpenGL::CheckErrors();
-
-    SCOPE_GUARD([&params]
-    {
-        glBindTexture(GL_TEXTURE_2D,
-            params.renderContext->GetState().GetTextureBinding(GL_TEXTURE_2D));
-    });
-
-    if(params.format == GL_RED)
-    {
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        OpenGL::CheckErrors();
-    }
-
-    SCOPE_GUARD([&params]
+    // Pack small texture into shared atlas page for sprite batching.
+    // Packed texture is drawn from page, so it does not need its own texture object.
+    if(params.dynamicAtlas != nullptr && params.data != nullptr)
     {
-        glPixelStorei(GL_UNPACK_ALIGNMENT,
-            params.renderContext->GetState().GetPixelStore(GL_UNPACK_ALIGNMENT));
-    });
-
-    glTexImage2D(GL_TEXTURE_2D, 0, params.format, params.width, params.height,
-        0, params.format, GL_UNSIGNED_BYTE, params.data);
+        instance->m_atlasRegion = params.dynamicAtlas->Insert(
+            static_cast<const uint8_t*>(params.data), params.width, params.height,
+            GetFormatChannels(params.format));
 
-    if(params.mipmaps)
-    {
-        glGenerateMipmap(GL_TEXTURE_2D);
-        OpenGL::CheckErrors();
+        if(instance->m_atlasRegion != nullptr)
+        {
+            instance->m_dynamicAtlas = params.dynamicAtlas;
+            return Common::Success(std::move(instance));
+        }
     }
 
-    instance->m_renderContext = params.renderContext;
-    instance->m_format = params.format;
-    instance->m_width = params.width;
-    instance->m_height = params.height;
+    if(!instance->CreateHandle(params.data, params.mipmaps))
+        return Common::Failure(CreateErrors::FailedTextureCreation);
 
     return Common::Success(std::move(instance));
 }
@@ -92,12 +94,36 @@ Texture::CreateResult Texture::Create(System::FileHandle& file, const LoadFromFi
     LOG("Loading texture from \"{}\" file...", file.GetPath().generic_string());
 
     // Validate arguments.
+    // Engine without renderer has neither render context nor texture streamer.
     CHECK_ARGUMENT_OR_RETURN(params.engineSystems,
         Common::Failure(CreateErrors::InvalidArgument));
+    CHECK_ARGUMENT_OR_RETURN(params.engineSystems->Has<Graphics::RenderContext>(),
+        Common::Failure(CreateErrors::InvalidArgument));
+
+    // Block compressed and cooked textures are loaded with all their mip levels.
+    // Cooked textures keep names of their source images, so they are recognized by identifier,
+    // which is only read when cooked directory has been mounted over source assets.
+    auto* fileSystem = params.engineSystems->Locate<System::FileSystem>();
+    const bool cookedAssets = fileSystem != nullptr && fileSystem->IsCookedDirectoryMounted();
+
+    if(file.GetPath().extension() == ".ktx2" || (cookedAssets && System::KtxImage::IsKtxFile(file)))
+    {
+        return LoadKTX(file, params);
+    }
 
     // Retrieve needed engine systems.
     auto* renderContext = params.engineSystems->Locate<Graphics::RenderContext>();
 
+    // Large images are decoded and uploaded in background instead.
+    if(params.streaming)
+    {
+        auto* textureStreamer = params.engineSystems->Locate<Graphics::TextureStreamer>();
+        if(textureStreamer != nullptr && textureStreamer->IsEnabled())
+        {
+            return textureStreamer->Stream(file, params);
+        }
+    }
+
     // Load image from file.
     auto image = System::Image::Create(file, System::Image::LoadFromFile()).UnwrapOr(nullptr);
     if(image == nullptr)
@@ -107,26 +133,9 @@ Texture::CreateResult Texture::Create(System::FileHandle& file, const LoadFromFi
     }
     
     // Determine texture format.
-    GLenum textureFormat = GL_NONE;
-    switch(image->GetChannels())
+    GLenum textureFormat = GetChannelFormat(image->GetChannels());
+    if(textureFormat == GL_NONE)
     {
-    case 1:
-        textureFormat = GL_RED;
-        break;
-
-    case 2:
-        textureFormat = GL_RG;
-        break;
-
-    case 3:
-        textureFormat = GL_RGB;
-        break;
-
-    case 4:
-        textureFormat = GL_RGBA;
-        break;
-
-    default:
         LOG_ERROR("Unsupported number of image channels!");
         return Common::Failure(CreateErrors::UnsupportedImageFormat);
     }
@@ -139,16 +148,410 @@ Texture::CreateResult Texture::Create(System::FileHandle& file, const LoadFromFi
     createParams.format = textureFormat;
     createParams.mipmaps = params.mipmaps;
     createParams.data = image->GetData();
+
+    if(params.atlasPacking)
+    {
+        createParams.dynamicAtlas = params.engineSystems->Locate<Graphics::DynamicAtlas>();
+    }
+
     return Create(createParams);
 }
 
+Texture::CreateResult Texture::LoadKTX(System::FileHandle& file, const LoadFromFile& params)
+{
+    // Retrieve needed engine systems.
+    auto* renderContext = params.engineSystems->Locate<Graphics::RenderContext>();
+
+    // Load image with all its levels from file.
+    auto image = System::KtxImage::Create(file).UnwrapOr(nullptr);
+    if(image == nullptr)
+    {
+        LOG_ERROR("Could not create KTX image from file!");
+        return Common::Failure(CreateErrors::FailedImageLoad);
+    }
+
+    const System::PixelFormatInfo& formatInfo = System::GetPixelFormatInfo(image->GetFormat());
+    const int levelCount = image->GetLevelCount();
+
+    // Stored mip levels are skipped when texture is requested without mipmaps.
+    const int uploadLevelCount = params.mipmaps ? levelCount : 1;
+
+    std::size_t imageSize = 0;
+    std::size_t decodedSize = 0;
+    for(int level = 0; level < uploadLevelCount; ++level)
+    {
+        imageSize += image->GetLevelSize(level);
+        decodedSize += static_cast<std::size_t>(image->GetLevelWidth(level)) *
+            image->GetLevelHeight(level) * formatInfo.channels;
+    }
+
+    // Upload compressed levels as they are when context can sample from them.
+    const GLenum compressedFormat = GetCompressedFormat(image->GetFormat());
+    if(compressedFormat != GL_NONE && renderContext->IsCompressedFormatSupported(compressedFormat))
+    {
+        auto instance = std::unique_ptr<Texture>(new Texture());
+
+        instance->m_renderContext = renderContext;
+
+        renderContext->AcquireContext();
+        glGenTextures(1, &instance->m_handle);
+        OpenGL::CheckErrors();
+
+        if(instance->m_handle == OpenGL::InvalidHandle)
+        {
+            LOG_ERROR("Texture could not be created!");
+            return Common::Failure(CreateErrors::FailedTextureCreation);
+        }
+
+        instance->m_format = compressedFormat;
+        instance->m_width = image->GetWidth();
+        instance->m_height = image->GetHeight();
+        instance->m_compressed = true;
+
+        glBindTexture(GL_TEXTURE_2D, instance->m_handle);
+
+        for(int level = 0; level < uploadLevelCount; ++level)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, compressedFormat,
+                image->GetLevelWidth(level), image->GetLevelHeight(level), 0,
+                static_cast<GLsizei>(image->GetLevelSize(level)), image->GetLevelData(level));
+        }
+
+        glBindTexture(GL_TEXTURE_2D, renderContext->GetState().GetTextureBinding(GL_TEXTURE_2D));
+        OpenGL::CheckErrors();
+
+        // Mipmaps cannot be generated for compressed formats, so only uploaded levels are sampled.
+        instance->SetLevelRange(0, uploadLevelCount - 1);
+
+        LOG("Uploaded {} texture with {} levels using {} bytes instead of {} bytes.",
+            formatInfo.name, uploadLevelCount, imageSize, decodedSize);
+
+        return Common::Success(std::move(instance));
+    }
+
+    // Decode levels on CPU and upload them uncompressed otherwise. Levels of cooked textures
+    // are already stored in uncompressed format and are uploaded from file data in place.
+    if(formatInfo.compressed)
+    {
+        LOG_WARNING("Render context cannot sample from {} texture format, decoding it instead.",
+            formatInfo.name);
+    }
+
+    std::vector<uint8_t> pixels;
+    if(formatInfo.compressed)
+    {
+        pixels.resize(static_cast<std::size_t>(image->GetWidth()) *
+            image->GetHeight() * formatInfo.channels);
+    }
+
+    auto DecodeLevel = [&image, &pixels, &formatInfo](int level) -> const uint8_t*
+    {
+        if(!formatInfo.compressed)
+            return image->GetLevelData(level);
+
+        if(!System::DecodePixels(image->GetFormat(), image->GetLevelData(level),
+            image->GetLevelWidth(level), image->GetLevelHeight(level), pixels.data()))
+        {
+            return nullptr;
+        }
+
+        return pixels.data();
+    };
+
+    const uint8_t* levelData = DecodeLevel(0);
+    if(levelData == nullptr)
+    {
+        LOG_ERROR("Could not decode KTX image data!");
+        return Common::Failure(CreateErrors::FailedImageLoad);
+    }
+
+    CreateFromParams createParams;
+    createParams.renderContext = renderContext;
+    createParams.width = image->GetWidth();
+    createParams.height = image->GetHeight();
+    createParams.format = GetChannelFormat(formatInfo.channels);
+    createParams.mipmaps = params.mipmaps && levelCount == 1;
+    createParams.data = levelData;
+
+    if(params.atlasPacking)
+    {
+        createParams.dynamicAtlas = params.engineSystems->Locate<Graphics::DynamicAtlas>();
+    }
+
+    auto createResult = Create(createParams);
+    if(!createResult)
+        return createResult;
+
+    // Packed texture is sampled from mipmapped atlas page instead of its stored levels.
+    auto instance = createResult.Unwrap();
+    if(instance->m_atlasRegion != nullptr)
+        return Common::Success(std::move(instance));
+
+    if(uploadLevelCount > 1)
+    {
+        for(int level = 1; level < uploadLevelCount; ++level)
+        {
+            instance->UploadLevel(level, DecodeLevel(level));
+        }
+
+        instance->SetLevelRange(0, uploadLevelCount - 1);
+    }
+    else if(levelCount > 1)
+    {
+        instance->SetLevelRange(0, 0);
+    }
+
+    return Common::Success(std::move(instance));
+}
+
+GLenum Texture::GetChannelFormat(int channels)
+{
+    switch(channels)
+    {
+    case 1:
+        return GL_RED;
+
+    case 2:
+        return GL_RG;
+
+    case 3:
+        return GL_RGB;
+
+    case 4:
+        return GL_RGBA;
+
+    default:
+        return GL_NONE;
+    }
+}
+
+GLenum Texture::GetCompressedFormat(System::PixelFormat format)
+{
+    switch(format)
+    {
+    case System::PixelFormat::BC1:
+        return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+
+    case System::PixelFormat::BC2:
+        return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+
+    case System::PixelFormat::BC3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+    case System::PixelFormat::BC4:
+        return GL_COMPRESSED_RED_RGTC1_EXT;
+
+    case System::PixelFormat::BC5:
+        return GL_COMPRESSED_RED_GREEN_RGTC2_EXT;
+
+    case System::PixelFormat::BC7:
+        return GL_COMPRESSED_RGBA_BPTC_UNORM_EXT;
+
+    case System::PixelFormat::ETC2_RGB8:
+        return GL_COMPRESSED_RGB8_ETC2;
+
+    case System::PixelFormat::ETC2_RGB8A1:
+        return GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+
+    case System::PixelFormat::ETC2_RGBA8:
+        return GL_COMPRESSED_RGBA8_ETC2_EAC;
+
+    case System::PixelFormat::EAC_R11:
+        return GL_COMPRESSED_R11_EAC;
+
+    case System::PixelFormat::EAC_RG11:
+        return GL_COMPRESSED_RG11_EAC;
+
+    default:
+        return GL_NONE;
+    }
+}
+
+int Texture::GetFormatChannels(GLenum format)
+{
+    switch(format)
+    {
+    case GL_RED:
+        return 1;
+
+    case GL_RG:
+        return 2;
+
+    case GL_RGB:
+        return 3;
+
+    case GL_RGBA:
+        return 4;
+
+    default:
+        return 0;
+    }
+}
+
+bool Texture::CreateHandle(const void* data, bool mipmaps)
+{
+    ASSERT(m_handle == OpenGL::InvalidHandle, "Texture handle has already been created!");
+
+    // Create texture handle.
+    m_renderContext->AcquireContext();
+    glGenTextures(1, &m_handle);
+    OpenGL::CheckErrors();
+
+    if(m_handle == OpenGL::InvalidHandle)
+    {
+        LOG_ERROR("Texture could not be created!");
+        return false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_handle);
+    OpenGL::CheckErrors();
+
+    SCOPE_GUARD([this]
+    {
+        glBindTexture(GL_TEXTURE_2D,
+            m_renderContext->GetState().GetTextureBinding(GL_TEXTURE_2D));
+    });
+
+    const bool unaligned = SetUnpackAlignment(m_format, m_width);
+    OpenGL::CheckErrors();
+
+    SCOPE_GUARD([this, unaligned]
+    {
+        if(unaligned)
+        {
+            glPixelStorei(GL_UNPACK_ALIGNMENT,
+                m_renderContext->GetState().GetPixelStore(GL_UNPACK_ALIGNMENT));
+        }
+    });
+
+    glTexImage2D(GL_TEXTURE_2D, 0, m_format, m_width, m_height,
+        0, m_format, GL_UNSIGNED_BYTE, data);
+
+    if(mipmaps)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        OpenGL::CheckErrors();
+    }
+
+    return true;
+}
+
+void Texture::Unpack(const void* data)
+{
+    if(m_atlasRegion == nullptr)
+        return;
+
+    // Atlas copy would become stale, so texture is drawn on its own from now on.
+    // Texture object is created from atlas copy, unless its data is being replaced.
+    // Mipmaps are generated as texture has been sampled from mipmapped page so far.
+    std::vector<uint8_t> pixels;
+    if(data == nullptr)
+    {
+        pixels = m_atlasRegion->CopyPixels(GetFormatChannels(m_format));
+        data = pixels.data();
+    }
+
+    m_dynamicAtlas->Release(m_atlasRegion);
+    m_atlasRegion.reset();
+
+    if(!CreateHandle(data, true))
+    {
+        LOG_ERROR("Could not create texture for data unpacked from dynamic atlas!");
+    }
+}
+
 void Texture::Update(const void* data)
 {
     ASSERT_ALWAYS_ARGUMENT(data != nullptr);
+    ASSERT(!m_compressed, "Compressed texture data cannot be updated!");
+
+    // Packed texture is unpacked with new data right away.
+    if(m_atlasRegion != nullptr)
+    {
+        Unpack(data);
+        return;
+    }
 
     // Upload new texture data.
+    m_renderContext->AcquireContext();
     glBindTexture(GL_TEXTURE_2D, m_handle);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, m_format, GL_UNSIGNED_BYTE, data);
     glBindTexture(GL_TEXTURE_2D, m_renderContext->GetState().GetTextureBinding(GL_TEXTURE_2D));
     OpenGL::CheckErrors();
 }
+
+void Texture::UpdateRegion(const void* data, int x, int y, int width, int height)
+{
+    ASSERT_ALWAYS_ARGUMENT(data != nullptr);
+    ASSERT_ALWAYS_ARGUMENT(x >= 0 && y >= 0 && width > 0 && height > 0);
+    ASSERT_ALWAYS_ARGUMENT(x + width <= m_width && y + height <= m_height);
+    ASSERT(!m_compressed, "Compressed texture data cannot be updated!");
+    Unpack();
+    m_renderContext->AcquireContext();
+
+    // Upload texture data to rectangle with bottom-left origin.
+    const bool unaligned = SetUnpackAlignment(m_format, width);
+
+    glBindTexture(GL_TEXTURE_2D, m_handle);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, m_format, GL_UNSIGNED_BYTE, data);
+    glBindTexture(GL_TEXTURE_2D, m_renderContext->GetState().GetTextureBinding(GL_TEXTURE_2D));
+
+    if(unaligned)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT,
+            m_renderContext->GetState().GetPixelStore(GL_UNPACK_ALIGNMENT));
+    }
+
+    OpenGL::CheckErrors();
+}
+
+void Texture::UploadLevel(int level, const void* data)
+{
+    ASSERT_ALWAYS_ARGUMENT(level >= 0);
+    ASSERT(!m_compressed, "Compressed texture data cannot be updated!");
+    Unpack();
+    m_renderContext->AcquireContext();
+
+    // Allocate and upload mip level with size derived from base level.
+    const int width = std::max(1, m_width >> level);
+    const int height = std::max(1, m_height >> level);
+    const bool unaligned = SetUnpackAlignment(m_format, width);
+
+    glBindTexture(GL_TEXTURE_2D, m_handle);
+    glTexImage2D(GL_TEXTURE_2D, level, m_format, width, height,
+        0, m_format, GL_UNSIGNED_BYTE, data);
+    glBindTexture(GL_TEXTURE_2D, m_renderContext->GetState().GetTextureBinding(GL_TEXTURE_2D));
+
+    if(unaligned)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT,
+            m_renderContext->GetState().GetPixelStore(GL_UNPACK_ALIGNMENT));
+    }
+
+    OpenGL::CheckErrors();
+}
+
+void Texture::SetLevelRange(int baseLevel, int maxLevel)
+{
+    ASSERT_ALWAYS_ARGUMENT(baseLevel >= 0 && baseLevel <= maxLevel);
+    Unpack();
+    m_renderContext->AcquireContext();
+
+    // Restrict sampling to mip levels that have been uploaded.
+    glBindTexture(GL_TEXTURE_2D, m_handle);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+    glBindTexture(GL_TEXTURE_2D, m_renderContext->GetState().GetTextureBinding(GL_TEXTURE_2D));
+    OpenGL::CheckErrors();
+}
+
+void Texture::GenerateMipmaps()
+{
+    Unpack();
+    m_renderContext->AcquireContext();
+
+    glBindTexture(GL_TEXTURE_2D, m_handle);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, m_renderContext->GetState().GetTextureBinding(GL_TEXTURE_2D));
+    OpenGL::CheckErrors();
+}
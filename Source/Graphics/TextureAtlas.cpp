@@ -11,8 +11,240 @@
 #include <System/FileSystem/FileHandle.hpp>
 #include <System/ResourceManager.hpp>
 #include <Script/ScriptState.hpp>
+#include <Script/ScriptStatePool.hpp>
 using namespace Graphics;
 
+namespace
+{
+    const uint32_t CompiledFileMagic = 0x534C5441; // "ATLS"
+    const uint32_t CompiledFileVersion = 2;
+
+    struct CompiledFileHeader
+    {
+        uint32_t magic = CompiledFileMagic;
+        uint32_t version = CompiledFileVersion;
+        uint32_t texturePathLength = 0;
+        uint32_t regionCount = 0;
+    };
+
+    struct AtlasDefinition
+    {
+        std::string texturePath;
+        std::vector<std::pair<std::string, glm::ivec4>> regions;
+    };
+
+    struct CompiledAtlas
+    {
+        std::string texturePath;
+        TextureAtlas::RegionHashList regionHashes;
+        TextureAtlas::RegionList regions;
+    };
+
+    using DefinitionResult = Common::Result<AtlasDefinition, TextureAtlas::CreateErrors>;
+
+    DefinitionResult LoadDefinition(System::FileHandle& file, Script::ScriptStatePool* statePool)
+    {
+        // Load resource script, using pooled state when available.
+        auto resourceScript = Script::ScriptStatePool::AcquireFrom(statePool);
+        if(resourceScript == nullptr || !resourceScript->Execute(file.ReadAsTextString(),
+            ("@" + file.GetPath().generic_string()).c_str()))
+        {
+            LOG_ERROR("Could not load texture atlas resource file!");
+            return Common::Failure(TextureAtlas::CreateErrors::FailedResourceLoading);
+        }
+
+        // Get global table.
+        lua_getglobal(*resourceScript, "TextureAtlas");
+        SCOPE_GUARD([&resourceScript]
+        {
+            lua_pop(*resourceScript, 1);
+        });
+
+        if(!lua_istable(*resourceScript, -1))
+        {
+            LOG_ERROR("Table \"TextureAtlas\" is missing!");
+            return Common::Failure(TextureAtlas::CreateErrors::InvalidResourceContents);
+        }
+
+        AtlasDefinition definition;
+
+        // Read texture path.
+        {
+            lua_getfield(*resourceScript, -1, "Texture");
+            SCOPE_GUARD([&resourceScript]
+            {
+                lua_pop(*resourceScript, 1);
+            });
+
+            if(!lua_isstring(*resourceScript, -1))
+            {
+                LOG_ERROR("String \"TextureAtlas.Texture\" is missing!");
+                return Common::Failure(TextureAtlas::CreateErrors::InvalidResourceContents);
+            }
+
+            definition.texturePath = lua_tostring(*resourceScript, -1);
+        }
+
+        // Read texture regions.
+        lua_getfield(*resourceScript, -1, "Regions");
+        SCOPE_GUARD([&resourceScript]
+        {
+            lua_pop(*resourceScript, 1);
+        });
+
+        if(!lua_istable(*resourceScript, -1))
+        {
+            LOG_ERROR("Table \"TextureAtlas.Regions\" is missing!");
+            return Common::Failure(TextureAtlas::CreateErrors::InvalidResourceContents);
+        }
+
+        for(lua_pushnil(*resourceScript); lua_next(*resourceScript, -2); lua_pop(*resourceScript, 1))
+        {
+            // Check key type.
+            if(!lua_isstring(*resourceScript, -2))
+            {
+                LOG_WARNING("Key in \"TextureAtlas.Regions\" is not a string!");
+                continue;
+            }
+
+            std::string regionName = lua_tostring(*resourceScript, -2);
+
+            // Read region rectangle.
+            glm::ivec4 pixelCoords(0);
+
+            for(int i = 0; i < 4; ++i)
+            {
+                lua_pushinteger(*resourceScript, i + 1);
+                lua_gettable(*resourceScript, -2);
+
+                if(!lua_isinteger(*resourceScript, -1))
+                {
+                    LOG_WARNING("Value of \"TextureAtlas.Regions[\"{}\"][{}]\" is not an integer!",
+                        regionName, i);
+                }
+
+                pixelCoords[i] = Common::NumericalCast<int>(lua_tointeger(*resourceScript, -1));
+
+                lua_pop(*resourceScript, 1);
+            }
+
+            definition.regions.emplace_back(std::move(regionName), pixelCoords);
+        }
+
+        return Common::Success(std::move(definition));
+    }
+
+    bool CompileDefinition(const AtlasDefinition& definition, CompiledAtlas& compiled)
+    {
+        // Sort regions by hash of their names, which must not collide.
+        std::vector<std::pair<uint64_t, std::size_t>> order;
+        order.reserve(definition.regions.size());
+
+        for(std::size_t index = 0; index < definition.regions.size(); ++index)
+        {
+            order.emplace_back(TextureAtlas::GetRegionHash(definition.regions[index].first), index);
+        }
+
+        std::sort(order.begin(), order.end());
+
+        compiled.texturePath = definition.texturePath;
+        compiled.regionHashes.reserve(order.size());
+        compiled.regions.reserve(order.size());
+
+        for(std::size_t index = 0; index < order.size(); ++index)
+        {
+            const auto& [regionHash, regionIndex] = order[index];
+            const auto& [regionName, pixelCoords] = definition.regions[regionIndex];
+
+            if(!compiled.regionHashes.empty() && compiled.regionHashes.back() == regionHash)
+            {
+                LOG_ERROR("Hash of \"{}\" region name collides with \"{}\" region name!", regionName,
+                    definition.regions[order[index - 1].second].first);
+                return false;
+            }
+
+            compiled.regionHashes.push_back(regionHash);
+            compiled.regions.push_back(pixelCoords);
+        }
+
+        return true;
+    }
+
+    bool IsCompiledFile(System::FileHandle& file)
+    {
+        // Peek at file magic and restore read position after.
+        const uint64_t position = file.Tell();
+        SCOPE_GUARD([&file, position]()
+        {
+            file.Seek(position);
+        });
+
+        uint32_t magic = 0;
+        file.Seek(0);
+        return file.Read(magic) && magic == CompiledFileMagic;
+    }
+
+    bool ReadCompiled(System::FileHandle& file, CompiledAtlas& compiled)
+    {
+        // Read whole file at once and validate sizes of its arrays.
+        const std::vector<uint8_t> data = file.ReadAsBinaryArray();
+        if(data.size() != file.GetSize() || data.size() < sizeof(CompiledFileHeader))
+            return false;
+
+        CompiledFileHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if(header.magic != CompiledFileMagic || header.version != CompiledFileVersion)
+        {
+            LOG_ERROR("Unknown compiled texture atlas format version!");
+            return false;
+        }
+
+        const std::size_t expectedSize = sizeof(header) + header.texturePathLength +
+            static_cast<std::size_t>(header.regionCount) * (sizeof(uint64_t) + sizeof(glm::ivec4));
+
+        if(data.size() != expectedSize)
+            return false;
+
+        // Copy arrays that are already sorted by name hash.
+        const uint8_t* input = data.data() + sizeof(header);
+        compiled.texturePath.assign(reinterpret_cast<const char*>(input), header.texturePathLength);
+        input += header.texturePathLength;
+
+        compiled.regionHashes.resize(header.regionCount);
+        std::memcpy(compiled.regionHashes.data(), input, header.regionCount * sizeof(uint64_t));
+        input += header.regionCount * sizeof(uint64_t);
+
+        compiled.regions.resize(header.regionCount);
+        std::memcpy(compiled.regions.data(), input, header.regionCount * sizeof(glm::ivec4));
+
+        return std::adjacent_find(compiled.regionHashes.begin(), compiled.regionHashes.end(),
+            std::greater_equal<uint64_t>()) == compiled.regionHashes.end();
+    }
+
+    bool WriteCompiled(const CompiledAtlas& compiled, System::FileHandle& file)
+    {
+        // Write header followed by texture path, hash table and region array.
+        CompiledFileHeader header;
+        header.texturePathLength = Common::NumericalCast<uint32_t>(compiled.texturePath.size());
+        header.regionCount = Common::NumericalCast<uint32_t>(compiled.regions.size());
+
+        std::vector<uint8_t> data(sizeof(header) + header.texturePathLength +
+            header.regionCount * (sizeof(uint64_t) + sizeof(glm::ivec4)));
+
+        uint8_t* output = data.data();
+        std::memcpy(output, &header, sizeof(header));
+        output += sizeof(header);
+        std::memcpy(output, compiled.texturePath.data(), header.texturePathLength);
+        output += header.texturePathLength;
+        std::memcpy(output, compiled.regionHashes.data(), header.regionCount * sizeof(uint64_t));
+        output += header.regionCount * sizeof(uint64_t);
+        std::memcpy(output, compiled.regions.data(), header.regionCount * sizeof(glm::ivec4));
+
+        return file.Write(data.data(), data.size()) == data.size();
+    }
+}
+
 TextureAtlas::TextureAtlas() = default;
 TextureAtlas::~TextureAtlas() = default;
 
@@ -50,120 +282,91 @@ TextureAtlas::CreateResult TextureAtlas::Create(System::FileHandle& file, const
 
     auto instance = createResult.Unwrap();
 
-    // Load resource script.
-    Script::ScriptState::LoadFromFile resourceParams;
-    resourceParams.engineSystems = params.engineSystems;
+    // Read regions from compiled file or from resource script.
+    CompiledAtlas compiled;
 
-    auto resourceScript = Script::ScriptState::Create(file, resourceParams).UnwrapOr(nullptr);
-    if(resourceScript == nullptr)
+    if(IsCompiledFile(file))
     {
-        LOG_ERROR("Could not load texture atlas resource file!");
-        return Common::Failure(CreateErrors::FailedResourceLoading);
-    }
-
-    // Get global table.
-    lua_getglobal(*resourceScript, "TextureAtlas");
-    SCOPE_GUARD([&resourceScript]
-    {
-        lua_pop(*resourceScript, 1);
-    });
-
-    if(!lua_istable(*resourceScript, -1))
-    {
-        LOG_ERROR("Table \"TextureAtlas\" is missing!");
-        return Common::Failure(CreateErrors::InvalidResourceContents);
+        if(!ReadCompiled(file, compiled))
+        {
+            LOG_ERROR("Could not read compiled texture atlas file!");
+            return Common::Failure(CreateErrors::InvalidResourceContents);
+        }
     }
-
-    // Load texture.
+    else
     {
-        lua_getfield(*resourceScript, -1, "Texture");
-        SCOPE_GUARD([&resourceScript]
+        auto definitionResult = LoadDefinition(file,
+            params.engineSystems->Locate<Script::ScriptStatePool>());
+        if(!definitionResult)
         {
-            lua_pop(*resourceScript, 1);
-        });
+            return Common::Failure(definitionResult.UnwrapFailure());
+        }
 
-        if(!lua_isstring(*resourceScript, -1))
+        if(!CompileDefinition(definitionResult.Unwrap(), compiled))
         {
-            LOG_ERROR("String \"TextureAtlas.Texture\" is missing!");
             return Common::Failure(CreateErrors::InvalidResourceContents);
         }
-
-        std::filesystem::path texturePath = lua_tostring(*resourceScript, -1);
-
-        Texture::LoadFromFile textureParams;
-        textureParams.engineSystems = params.engineSystems;
-        textureParams.mipmaps = true;
-
-        instance->m_texture = resourceManager->AcquireRelative<Graphics::Texture>(
-            texturePath, file.GetPath(), textureParams).UnwrapEither();
     }
 
-    // Read texture regions.
-    lua_getfield(*resourceScript, -1, "Regions");
-    SCOPE_GUARD([&resourceScript]
-    {
-        lua_pop(*resourceScript, 1);
-    });
-
-    if(!lua_istable(*resourceScript, -1))
-    {
-        LOG_ERROR("Table \"TextureAtlas.Regions\" is missing!");
-        return Common::Failure(CreateErrors::InvalidResourceContents);
-    }
+    instance->m_regionHashes = std::move(compiled.regionHashes);
+    instance->m_regions = std::move(compiled.regions);
 
-    for(lua_pushnil(*resourceScript); lua_next(*resourceScript, -2); lua_pop(*resourceScript, 1))
-    {
-        // Check key type.
-        if(!lua_isstring(*resourceScript, -2))
-        {
-            LOG_WARNING("Key in \"TextureAtlas.Regions\" is not a string!");
-            continue;
-        }
+    // Load texture.
+    Texture::LoadFromFile textureParams;
+    textureParams.engineSystems = params.engineSystems;
+    textureParams.mipmaps = true;
 
-        std::string regionName = lua_tostring(*resourceScript, -2);
+    instance->m_texture = resourceManager->AcquireRelative<Graphics::Texture>(
+        compiled.texturePath, file.GetPath(), textureParams).UnwrapEither();
 
-        // Read region rectangle.
-        glm::ivec4 pixelCoords(0);
+    return Common::Success(std::move(instance));
+}
 
-        for(int i = 0; i < 4; ++i)
-        {
-            lua_pushinteger(*resourceScript, i + 1);
-            lua_gettable(*resourceScript, -2);
+bool TextureAtlas::Compile(System::FileHandle& sourceFile, System::FileHandle& outputFile)
+{
+    LOG_PROFILE_SCOPE("Compile texture atlas from \"{}\" file",
+        sourceFile.GetPath().generic_string());
 
-            if(!lua_isinteger(*resourceScript, -1))
-            {
-                LOG_WARNING("Value of \"TextureAtlas.Regions[\"{}\"][{}]\" is not an integer!",
-                    regionName, i);
-            }
+    auto definitionResult = LoadDefinition(sourceFile, nullptr);
+    if(!definitionResult)
+        return false;
 
-            pixelCoords[i] = Common::NumericalCast<int>(lua_tointeger(*resourceScript, -1));
+    CompiledAtlas compiled;
+    if(!CompileDefinition(definitionResult.Unwrap(), compiled))
+        return false;
 
-            lua_pop(*resourceScript, 1);
-        }
+    return WriteCompiled(compiled, outputFile);
+}
 
-        // Add new texture region.
-        if(!instance->AddRegion(regionName, pixelCoords))
-        {
-            LOG_WARNING("Could not add region with \"{}\" name!", regionName);
-            continue;
-        }
-    }
+uint64_t TextureAtlas::GetRegionHash(std::string_view name)
+{
+    return Common::StringHash<uint64_t>(name);
+}
 
-    return Common::Success(std::move(instance));
+bool TextureAtlas::AddRegion(std::string_view name, glm::ivec4 pixelCoords)
+{
+    // Keep regions sorted by name hash for binary search.
+    const uint64_t hash = GetRegionHash(name);
+    auto it = std::lower_bound(m_regionHashes.begin(), m_regionHashes.end(), hash);
+    if(it != m_regionHashes.end() && *it == hash)
+        return false;
+
+    m_regions.insert(m_regions.begin() + std::distance(m_regionHashes.begin(), it), pixelCoords);
+    m_regionHashes.insert(it, hash);
+    return true;
 }
 
-bool TextureAtlas::AddRegion(std::string name, glm::ivec4 pixelCoords)
+TextureView TextureAtlas::GetRegion(std::string_view name) const
 {
-    auto result = m_regions.emplace(name, pixelCoords);
-    return result.second;
+    return GetRegionByHash(GetRegionHash(name));
 }
 
-TextureView TextureAtlas::GetRegion(std::string name)
+TextureView TextureAtlas::GetRegionByHash(uint64_t hash) const
 {
-    auto it = m_regions.find(name);
-    if(it != m_regions.end())
+    auto it = std::lower_bound(m_regionHashes.begin(), m_regionHashes.end(), hash);
+    if(it != m_regionHashes.end() && *it == hash)
     {
-        return TextureView(m_texture, it->second);
+        return TextureView(m_texture, m_regions[std::distance(m_regionHashes.begin(), it)]);
     }
     else
     {
@@ -0,0 +1,547 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Graphics/Precompiled.hpp"
+#include "Graphics/TextureStreamer.hpp"
+#include "Graphics/RenderContext.hpp"
+#include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
+#include <System/FileSystem/FileSystem.hpp>
+#include <System/FileSystem/MemoryFileHandle.hpp>
+#include <System/Image.hpp>
+using namespace Graphics;
+
+namespace
+{
+    const char* LogAttachFailed = "Failed to attach texture streamer! {}";
+
+    // Largest dimension of placeholder mip level.
+    const int PlaceholderSize = 16;
+
+    using Clock = std::chrono::steady_clock;
+
+    int CalculatePlaceholderLevel(int width, int height)
+    {
+        int level = 0;
+        while(std::max(width >> level, height >> level) > PlaceholderSize)
+        {
+            ++level;
+        }
+
+        return level;
+    }
+
+    int CalculateMaxLevel(int width, int height)
+    {
+        int level = 0;
+        while(std::max(width >> level, height >> level) > 1)
+        {
+            ++level;
+        }
+
+        return level;
+    }
+
+    std::vector<uint8_t> Downsample(const uint8_t* pixels, int width, int height,
+        int channels, int level)
+    {
+        // Average block of source pixels covered by each pixel of mip level.
+        const int levelWidth = std::max(1, width >> level);
+        const int levelHeight = std::max(1, height >> level);
+
+        std::vector<uint8_t> levelPixels(
+            static_cast<std::size_t>(levelWidth) * levelHeight * channels);
+        uint32_t sums[4];
+
+        for(int y = 0; y < levelHeight; ++y)
+        {
+            const int y0 = y * height / levelHeight;
+            const int y1 = (y + 1) * height / levelHeight;
+
+            for(int x = 0; x < levelWidth; ++x)
+            {
+                const int x0 = x * width / levelWidth;
+                const int x1 = (x + 1) * width / levelWidth;
+
+                std::fill(std::begin(sums), std::end(sums), 0u);
+                for(int sy = y0; sy < y1; ++sy)
+                {
+                    const uint8_t* row = pixels + (static_cast<std::size_t>(sy) * width + x0) * channels;
+                    for(int sx = x0; sx < x1; ++sx, row += channels)
+                    {
+                        for(int c = 0; c < channels; ++c)
+                        {
+                            sums[c] += row[c];
+                        }
+                    }
+                }
+
+                const uint32_t count = static_cast<uint32_t>((x1 - x0) * (y1 - y0));
+                uint8_t* levelPixel = &levelPixels[(static_cast<std::size_t>(y) * levelWidth + x) * channels];
+                for(int c = 0; c < channels; ++c)
+                {
+                    levelPixel[c] = static_cast<uint8_t>((sums[c] + count / 2) / count);
+                }
+            }
+        }
+
+        return levelPixels;
+    }
+}
+
+struct TextureStreamer::UploadBudget
+{
+    Clock::time_point start = Clock::now();
+    std::size_t bytes = 0;
+    std::size_t chunks = 0;
+    std::size_t maxBytes = 0;
+    double maxSeconds = 0.0;
+    bool unbounded = false;
+
+    bool IsExhausted() const
+    {
+        // Always make progress by uploading at least one chunk.
+        if(unbounded || chunks == 0)
+            return false;
+
+        return bytes >= maxBytes ||
+            std::chrono::duration<double>(Clock::now() - start).count() >= maxSeconds;
+    }
+};
+
+bool TextureStreamer::IsSupported()
+{
+#ifndef __EMSCRIPTEN__
+    return true;
+#else
+    return false;
+#endif
+}
+
+TextureStreamer::TextureStreamer() = default;
+TextureStreamer::~TextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_workCondition.notify_all();
+
+    for(std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+bool TextureStreamer::OnAttach(const Core::EngineSystemStorage& engineSystems)
+{
+    // Locate needed engine systems.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(configSystem == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate config system.");
+        return false;
+    }
+
+    m_fileSystem = engineSystems.Locate<System::FileSystem>();
+    if(m_fileSystem == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate file system.");
+        return false;
+    }
+
+    m_renderContext = engineSystems.Locate<Graphics::RenderContext>();
+    if(m_renderContext == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate render context.");
+        return false;
+    }
+
+    // Read streaming configuration.
+    m_enabled = configSystem->Get<bool>(
+        NAME_CONSTEXPR("render.textureStreaming")).UnwrapOr(m_enabled);
+    m_workerCount = configSystem->Get<int>(
+        NAME_CONSTEXPR("render.textureStreamWorkers")).UnwrapOr(m_workerCount);
+    m_minSize = configSystem->Get<std::size_t>(
+        NAME_CONSTEXPR("render.textureStreamMinSize")).UnwrapOr(m_minSize);
+    m_uploadBudget = configSystem->Get<std::size_t>(
+        NAME_CONSTEXPR("render.textureUploadBudget")).UnwrapOr(m_uploadBudget);
+    m_uploadTime = configSystem->Get<float>(
+        NAME_CONSTEXPR("render.textureUploadTime")).UnwrapOr(m_uploadTime);
+    m_uploadChunk = configSystem->Get<std::size_t>(
+        NAME_CONSTEXPR("render.textureUploadChunk")).UnwrapOr(m_uploadChunk);
+    m_stagingPoolSize = configSystem->Get<std::size_t>(
+        NAME_CONSTEXPR("render.stagingPoolSize")).UnwrapOr(m_stagingPoolSize);
+
+    if(m_workerCount < 0 || m_uploadBudget == 0 || m_uploadTime <= 0.0f || m_uploadChunk == 0)
+    {
+        LOG_ERROR(LogAttachFailed, "Invalid texture streaming configuration.");
+        return false;
+    }
+
+    m_stagingPool = std::make_unique<StagingBufferPool>(m_stagingPoolSize);
+
+    if(!m_enabled)
+        return true;
+
+    // Decode images on calling thread when worker threads are not available.
+    if(!IsSupported())
+    {
+        m_workerCount = 0;
+    }
+
+    for(int i = 0; i < m_workerCount; ++i)
+    {
+        m_workers.emplace_back(&TextureStreamer::WorkerMain, this);
+    }
+
+    LOG_INFO("Texture streaming enabled with {} decode workers.", m_workerCount);
+    return true;
+}
+
+Texture::CreateResult TextureStreamer::Stream(System::FileHandle& file, const Texture::LoadFromFile& params)
+{
+    LOG_PROFILE_SCOPE("Stream texture from \"{}\" file", file.GetPath().generic_string());
+
+    Texture::LoadFromFile loadParams = params;
+    loadParams.streaming = false;
+
+    // Small images are loaded right away, as are images with unreadable header so error is reported.
+    System::Image::InfoResult infoResult = System::Image::ReadInfo(file);
+    if(!infoResult)
+        return Texture::Create(file, loadParams);
+
+    const System::Image::Info info = infoResult.Unwrap();
+    const std::size_t imageSize = static_cast<std::size_t>(info.width) * info.height * info.channels;
+    if(imageSize < m_minSize)
+        return Texture::Create(file, loadParams);
+
+    const GLenum textureFormat = Texture::GetChannelFormat(info.channels);
+    if(textureFormat == GL_NONE)
+    {
+        LOG_ERROR("Unsupported number of image channels!");
+        return Common::Failure(Texture::CreateErrors::UnsupportedImageFormat);
+    }
+
+    // Allocate texture storage without data.
+    Texture::CreateFromParams createParams;
+    createParams.renderContext = m_renderContext;
+    createParams.format = textureFormat;
+    createParams.width = info.width;
+    createParams.height = info.height;
+    createParams.mipmaps = false;
+
+    auto textureResult = Texture::Create(createParams);
+    if(!textureResult)
+        return textureResult;
+
+    std::unique_ptr<Texture> texture = textureResult.Unwrap();
+
+    // Sample blank placeholder level until decoded image arrives.
+    auto request = std::make_shared<TextureStreamRequest>();
+    request->path = file.GetPath();
+    request->width = info.width;
+    request->height = info.height;
+    request->channels = info.channels;
+    request->mipmaps = params.mipmaps;
+    request->placeholderLevel = CalculatePlaceholderLevel(info.width, info.height);
+
+    // File is reopened so it can be read by worker after caller closes its handle. Files that
+    // do not come from file system (or no longer match it) are read on this thread instead.
+    request->file = m_fileSystem->OpenFile(file.GetPath(),
+        System::FileHandle::OpenFlags::Read).UnwrapOr(nullptr);
+
+    if(request->file == nullptr || request->file->GetSize() != file.GetSize())
+    {
+        request->file = nullptr;
+        request->fileData = file.ReadAsBinaryArray();
+    }
+
+    const int placeholderWidth = std::max(1, info.width >> request->placeholderLevel);
+    const int placeholderHeight = std::max(1, info.height >> request->placeholderLevel);
+    std::vector<uint8_t> blankPixels(
+        static_cast<std::size_t>(placeholderWidth) * placeholderHeight * info.channels, 0);
+
+    texture->UploadLevel(request->placeholderLevel, blankPixels.data());
+    texture->SetLevelRange(request->placeholderLevel, request->placeholderLevel);
+
+    request->texture = texture.get();
+    texture->m_streamRequest = request;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.requestedTextures += 1;
+    }
+
+    // Queue image for decoding.
+    if(m_workers.empty())
+    {
+        Decode(*request);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_uploadQueue.push_back(std::move(request));
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_decodeQueue.push_back(std::move(request));
+        }
+
+        m_workCondition.notify_one();
+    }
+
+    return Common::Success(std::move(texture));
+}
+
+void TextureStreamer::WorkerMain()
+{
+    while(true)
+    {
+        RequestPtr request;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workCondition.wait(lock, [this]()
+            {
+                return m_stopping || !m_decodeQueue.empty();
+            });
+
+            if(m_stopping)
+                return;
+
+            request = std::move(m_decodeQueue.front());
+            m_decodeQueue.pop_front();
+            m_decodingCount += 1;
+        }
+
+        Decode(*request);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_decodingCount -= 1;
+            m_uploadQueue.push_back(std::move(request));
+        }
+
+        m_decodedCondition.notify_all();
+    }
+}
+
+void TextureStreamer::Decode(TextureStreamRequest& request)
+{
+    // Skip decoding for texture that has already been destroyed.
+    {
+        std::lock_guard<std::mutex> lock(request.mutex);
+        if(request.texture == nullptr)
+        {
+            request.file = nullptr;
+            request.fileData.clear();
+            return;
+        }
+    }
+
+    LOG_PROFILE_SCOPE("Decode streamed texture");
+    const Clock::time_point start = Clock::now();
+
+    // Read encoded file unless its data was already read by requesting thread.
+    if(request.file != nullptr)
+    {
+        request.fileData = request.file->ReadAsBinaryArray();
+        request.file = nullptr;
+    }
+
+    // Decode pixels into staging buffer from pool.
+    auto file = System::MemoryFileHandle::Create(request.path, std::move(request.fileData));
+
+    StagingBufferPool::Buffer storage = m_stagingPool->Acquire(
+        static_cast<std::size_t>(request.width) * request.height * request.channels);
+
+    System::Image::LoadFromFile imageParams;
+    imageParams.storage = &storage;
+
+    auto image = System::Image::Create(*file, imageParams).UnwrapOr(nullptr);
+    if(image != nullptr && image->GetWidth() == request.width &&
+        image->GetHeight() == request.height && image->GetChannels() == request.channels)
+    {
+        request.pixels = image->ReleaseData();
+        request.placeholderPixels = Downsample(request.pixels.data(), request.width,
+            request.height, request.channels, request.placeholderLevel);
+    }
+    else
+    {
+        // Return staging buffer to pool, same as when request is cancelled.
+        m_stagingPool->Release(image != nullptr ? image->ReleaseData() : std::move(storage));
+        request.failed = true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.decodeTime += std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void TextureStreamer::ProcessUploads()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_uploadQueue.empty())
+        {
+            m_stats.lastFrameUploadedBytes = 0;
+            m_stats.lastFrameUploadTime = 0.0;
+            return;
+        }
+    }
+
+    LOG_PROFILE_SCOPE("Process texture uploads");
+
+    UploadBudget budget;
+    budget.maxBytes = m_uploadBudget;
+    budget.maxSeconds = m_uploadTime / 1000.0;
+    UploadQueue(budget);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.lastFrameUploadedBytes = budget.bytes;
+    m_stats.lastFrameUploadTime = std::chrono::duration<double>(Clock::now() - budget.start).count();
+}
+
+void TextureStreamer::Finish()
+{
+    LOG_PROFILE_SCOPE("Finish texture streaming");
+
+    while(true)
+    {
+        // Wait for workers to decode all queued images.
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_decodedCondition.wait(lock, [this]()
+            {
+                return m_decodeQueue.empty() && m_decodingCount == 0;
+            });
+
+            if(m_uploadQueue.empty())
+                return;
+        }
+
+        UploadBudget budget;
+        budget.unbounded = true;
+        UploadQueue(budget);
+    }
+}
+
+void TextureStreamer::UploadQueue(UploadBudget& budget)
+{
+    while(!budget.IsExhausted())
+    {
+        RequestPtr request;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_uploadQueue.empty())
+                break;
+
+            request = m_uploadQueue.front();
+        }
+
+        // Request stays in front of queue until all of its chunks are uploaded.
+        if(!Upload(*request, budget))
+            break;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_uploadQueue.pop_front();
+    }
+}
+
+bool TextureStreamer::Upload(TextureStreamRequest& request, UploadBudget& budget)
+{
+    std::lock_guard<std::mutex> requestLock(request.mutex);
+
+    auto ReleaseStaging = [this, &request]()
+    {
+        m_stagingPool->Release(std::move(request.pixels));
+        request.placeholderPixels = std::vector<uint8_t>();
+    };
+
+    if(request.texture == nullptr)
+    {
+        ReleaseStaging();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.cancelledTextures += 1;
+        return true;
+    }
+
+    if(request.failed)
+    {
+        LOG_ERROR("Could not decode streamed texture from \"{}\" file!",
+            request.path.generic_string());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.failedTextures += 1;
+        return true;
+    }
+
+    Texture& texture = *request.texture;
+    const std::size_t uploadedBytes = budget.bytes;
+    const std::size_t uploadedChunks = budget.chunks;
+
+    // Replace blank placeholder with downsampled image first.
+    if(!request.placeholderUploaded)
+    {
+        texture.UploadLevel(request.placeholderLevel, request.placeholderPixels.data());
+        request.placeholderUploaded = true;
+        budget.bytes += request.placeholderPixels.size();
+    }
+
+    // Upload bands of full resolution rows in chunks.
+    const std::size_t rowSize = static_cast<std::size_t>(request.width) * request.channels;
+    const int chunkRows = static_cast<int>(std::max<std::size_t>(1, m_uploadChunk / rowSize));
+
+    while(request.uploadedRows < request.height && !budget.IsExhausted())
+    {
+        const int rows = std::min(chunkRows, request.height - request.uploadedRows);
+        texture.UpdateRegion(request.pixels.data() + request.uploadedRows * rowSize,
+            0, request.uploadedRows, request.width, rows);
+
+        request.uploadedRows += rows;
+        budget.bytes += rows * rowSize;
+        budget.chunks += 1;
+    }
+
+    const bool complete = request.uploadedRows == request.height;
+    if(complete)
+    {
+        // Sample full resolution image with all of its mip levels.
+        texture.SetLevelRange(0, request.mipmaps ?
+            CalculateMaxLevel(request.width, request.height) : 0);
+
+        if(request.mipmaps)
+        {
+            texture.GenerateMipmaps();
+        }
+
+        ReleaseStaging();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.uploadedBytes += budget.bytes - uploadedBytes;
+    m_stats.uploadedChunks += budget.chunks - uploadedChunks;
+    m_stats.completedTextures += complete ? 1 : 0;
+    return complete;
+}
+
+TextureStreamer::Stats TextureStreamer::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Stats stats = m_stats;
+    stats.pendingTextures = m_decodeQueue.size() + m_decodingCount + m_uploadQueue.size();
+    stats.stagingPool = m_stagingPool ? m_stagingPool->GetStats() : StagingBufferPool::Stats();
+    return stats;
+}
+
+bool TextureStreamer::IsIdle() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_decodeQueue.empty() && m_decodingCount == 0 && m_uploadQueue.empty();
+}
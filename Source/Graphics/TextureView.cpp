@@ -6,6 +6,7 @@
 #include "Graphics/Precompiled.hpp"
 #include "Graphics/TextureView.hpp"
 #include "Graphics/Texture.hpp"
+#include "Graphics/DynamicAtlas.hpp"
 using namespace Graphics;
 
 TextureView::TextureView() = default;
@@ -41,6 +42,9 @@ TextureView& TextureView::operator=(TextureView&& other)
 {
     std::swap(m_texture, other.m_texture);
     std::swap(m_textureRect, other.m_textureRect);
+    std::swap(m_drawTexture, other.m_drawTexture);
+    std::swap(m_drawRect, other.m_drawRect);
+    std::swap(m_atlasVersion, other.m_atlasVersion);
     return *this;
 }
 
@@ -63,6 +67,8 @@ void TextureView::SetImageRect(const glm::ivec4 imageRect)
     {
         m_textureRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
     }
+
+    m_atlasVersion = 0;
 }
 
 glm::ivec4 TextureView::GetImageRect() const
@@ -84,3 +90,26 @@ glm::ivec4 TextureView::GetImageRect() const
 
     return rectangle;
 }
+
+void TextureView::ResolveAtlas(uint64_t atlasVersion) const
+{
+    ASSERT(atlasVersion != 0, "Invalid atlas layout version!");
+
+    if(m_atlasVersion == atlasVersion)
+        return;
+
+    // Map rectangle onto atlas page when texture is packed.
+    const AtlasRegion* atlasRegion = m_texture ? m_texture->GetAtlasRegion() : nullptr;
+    if(atlasRegion != nullptr)
+    {
+        m_drawTexture = atlasRegion->GetPage();
+        m_drawRect = atlasRegion->MapTextureRect(m_textureRect);
+    }
+    else
+    {
+        m_drawTexture = m_texture;
+        m_drawRect = m_textureRect;
+    }
+
+    m_atlasVersion = atlasVersion;
+}
@@ -82,6 +82,7 @@ VertexArray::~VertexArray()
 {
     if(m_handle != OpenGL::InvalidHandle)
     {
+        m_renderContext->AcquireContext();
         glDeleteVertexArrays(1, &m_handle);
         OpenGL::CheckErrors();
     }
@@ -117,7 +118,11 @@ VertexArray::CreateResult VertexArray::Create(
     // Create class instance.
     auto instance = std::unique_ptr<VertexArray>(new VertexArray());
 
+    // Save render context reference, which is also needed to release handle.
+    instance->m_renderContext = renderContext;
+
     // Create vertex array object.
+    renderContext->AcquireContext();
     glGenVertexArrays(1, &instance->m_handle);
     OpenGL::CheckErrors();
 
@@ -192,8 +197,5 @@ VertexArray::CreateResult VertexArray::Create(
         }
     }
 
-    // Save render context reference.
-    instance->m_renderContext = renderContext;
-
     return Common::Success(std::move(instance));
 }
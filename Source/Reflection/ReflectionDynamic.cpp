@@ -11,14 +11,16 @@ using namespace Reflection;
 
 const DynamicTypeInfo DynamicTypeInfo::Invalid{};
 
-void DynamicTypeInfo::Register(const Common::Name& name,
-    const ConstructFunction constructFunction, DynamicTypeInfo* baseType)
+void DynamicTypeInfo::Register(const Common::Name& name, const std::string_view typeName,
+    const ConstructFunction constructFunction, DynamicTypeInfo* baseType, MemberList&& members)
 {
     ASSERT(!m_registered, "Cannot register same dynamic type info twice!");
 
     m_registered = true;
     m_name = name;
+    m_typeName = typeName;
     m_constructFunction = constructFunction;
+    m_members = std::move(members);
 
     if(!IsNullType())
     {
@@ -27,11 +29,20 @@ void DynamicTypeInfo::Register(const Common::Name& name,
 
         m_baseType = baseType;
         baseType->AddDerivedType(*this);
+
+        // Ancestors are complete once registered, as base types are registered before derived.
+        if(!baseType->IsNullType())
+        {
+            m_ancestors = baseType->m_ancestors;
+            m_depth = baseType->m_depth + 1;
+        }
     }
     else
     {
         m_baseType = this;
     }
+
+    m_ancestors.push_back(this);
 }
 
 void DynamicTypeInfo::AddDerivedType(const DynamicTypeInfo& typeInfo)
@@ -73,8 +84,7 @@ bool DynamicTypeInfo::IsType(const TypeIdentifier identifier) const
 
 bool DynamicTypeInfo::IsBaseOf(const TypeIdentifier identifier) const
 {
-    const DynamicTypeInfo& typeInfo = Reflection::GetRegistry().LookupType(identifier);
-    return typeInfo.IsDerivedFrom(GetIdentifier());
+    return IsBaseOf(Reflection::GetRegistry().LookupType(identifier));
 }
 
 bool DynamicTypeInfo::IsDerivedFrom(const TypeIdentifier identifier) const
@@ -82,16 +92,5 @@ bool DynamicTypeInfo::IsDerivedFrom(const TypeIdentifier identifier) const
     if(!m_registered)
         return false;
 
-    const DynamicTypeInfo* baseType = m_baseType;
-    while(!baseType->IsNullType())
-    {
-        if(baseType->GetIdentifier() == identifier)
-        {
-            return true;
-        }
-
-        baseType = &baseType->GetBaseType();
-    }
-
-    return false;
+    return IsDerivedFrom(Reflection::GetRegistry().LookupType(identifier));
 }
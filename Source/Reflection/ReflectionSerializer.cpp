@@ -0,0 +1,59 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Reflection/ReflectionSerializer.hpp"
+using namespace Reflection;
+
+BinaryWriter::BinaryWriter(std::vector<uint8_t>& buffer) :
+    m_buffer(buffer)
+{
+}
+
+BinaryWriter::~BinaryWriter() = default;
+
+void BinaryWriter::WriteBytes(const void* data, const std::size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+}
+
+void BinaryWriter::WriteSize(const std::size_t size)
+{
+    const Detail::SizeType sizeValue = Common::NumericalCast<Detail::SizeType>(size);
+    WriteBytes(&sizeValue, sizeof(sizeValue));
+}
+
+BinaryReader::BinaryReader(const void* data, const std::size_t size) :
+    m_data(static_cast<const uint8_t*>(data)),
+    m_size(size)
+{
+    ASSERT(m_data != nullptr || m_size == 0, "Serialized data is null!");
+}
+
+BinaryReader::~BinaryReader() = default;
+
+bool BinaryReader::ReadBytes(void* data, const std::size_t size)
+{
+    if(size > GetRemaining())
+        return false;
+
+    if(size != 0)
+    {
+        std::memcpy(data, m_data + m_offset, size);
+        m_offset += size;
+    }
+
+    return true;
+}
+
+bool BinaryReader::ReadSize(std::size_t& size)
+{
+    Detail::SizeType sizeValue = 0;
+    if(!ReadBytes(&sizeValue, sizeof(sizeValue)))
+        return false;
+
+    size = sizeValue;
+    return true;
+}
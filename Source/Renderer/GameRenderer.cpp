@@ -5,19 +5,25 @@
 
 #include "Renderer/Precompiled.hpp"
 #include "Renderer/GameRenderer.hpp"
+#include "Renderer/RenderThread.hpp"
 #include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
 #include <System/Window.hpp>
 #include <Graphics/RenderContext.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/Texture.hpp>
+#include <Graphics/DynamicAtlas.hpp>
+#include <Graphics/TextureStreamer.hpp>
 #include <Graphics/Sprite/SpriteRenderer.hpp>
 #include <Game/Components/TransformComponent.hpp>
 #include <Game/Components/CameraComponent.hpp>
 #include <Game/Components/SpriteComponent.hpp>
-#include <Game/Components/SpriteAnimationComponent.hpp>
 #include <Game/GameFramework.hpp>
 #include <Game/GameInstance.hpp>
 #include <Game/EntitySystem.hpp>
 #include <Game/ComponentSystem.hpp>
 #include <Game/Systems/IdentitySystem.hpp>
+#include <Game/Systems/SpriteSystem.hpp>
 using namespace Renderer;
 
 namespace
@@ -30,11 +36,25 @@ GameRenderer::GameRenderer()
     m_receivers.drawGameInstance.Bind<GameRenderer, &GameRenderer::OnDrawGameInstance>(this);
 }
 
-GameRenderer::~GameRenderer() = default;
+GameRenderer::~GameRenderer()
+{
+    // Render context outlives render thread that it acquires context from.
+    if(m_renderThread != nullptr && m_renderThread->IsThreaded())
+    {
+        m_renderContext->SetAcquireCallback(nullptr);
+    }
+}
 
 bool GameRenderer::OnAttach(const Core::EngineSystemStorage& engineSystems)
 {
     // Retrieve needed engine systems.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(!configSystem)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate config system.");
+        return false;
+    }
+
     m_window = engineSystems.Locate<System::Window>();
     if(!m_window)
     {
@@ -49,6 +69,20 @@ bool GameRenderer::OnAttach(const Core::EngineSystemStorage& engineSystems)
         return false;
     }
 
+    m_dynamicAtlas = engineSystems.Locate<Graphics::DynamicAtlas>();
+    if(!m_dynamicAtlas)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate dynamic atlas.");
+        return false;
+    }
+
+    m_textureStreamer = engineSystems.Locate<Graphics::TextureStreamer>();
+    if(!m_textureStreamer)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate texture streamer.");
+        return false;
+    }
+
     m_spriteRenderer = engineSystems.Locate<Graphics::SpriteRenderer>();
     if(!m_spriteRenderer)
     {
@@ -63,6 +97,9 @@ bool GameRenderer::OnAttach(const Core::EngineSystemStorage& engineSystems)
         return false;
     }
 
+    // Recorder is optional and only present when recording commands.
+    m_commandRecorder = engineSystems.Locate<Graphics::CommandRecorder>();
+
     // Subscribe to events.
     if(!m_receivers.drawGameInstance.Subscribe(gameFramework->events.drawGameInstance))
     {
@@ -70,6 +107,83 @@ bool GameRenderer::OnAttach(const Core::EngineSystemStorage& engineSystems)
         return false;
     }
 
+    // Create render thread that frame packets are submitted through.
+    if(!CreateRenderThread(configSystem))
+    {
+        LOG_ERROR(LogAttachFailed, "Could not create render thread.");
+        return false;
+    }
+
+    return true;
+}
+
+bool GameRenderer::CreateRenderThread(Core::ConfigSystem* configSystem)
+{
+    const bool threaded = configSystem->Get<bool>(
+        NAME_CONSTEXPR("render.threaded")).UnwrapOr(false) && RenderThread::IsSupported();
+    const int frameLatency = configSystem->Get<int>(
+        NAME_CONSTEXPR("render.frameLatency")).UnwrapOr(1);
+
+    RenderThread::CreateFromParams renderThreadParams;
+    renderThreadParams.threaded = threaded;
+    renderThreadParams.frameLatency = static_cast<uint32_t>(
+        std::clamp(frameLatency, 1, static_cast<int>(RenderThread::MaxFrameLatency)));
+
+    renderThreadParams.submitCallback = [this, threaded](const FramePacket& packet)
+    {
+        // Render thread delimits recorded frames and presents them, as it owns the context.
+        if(threaded && m_commandRecorder)
+        {
+            m_commandRecorder->BeginFrame();
+        }
+
+        SubmitFramePacket(packet);
+        events.packetSubmitted.Dispatch(packet);
+
+        if(threaded)
+        {
+            m_window->Present();
+
+            if(m_commandRecorder)
+            {
+                m_commandRecorder->EndFrame();
+            }
+        }
+    };
+
+    renderThreadParams.acquireContext = [window = m_window]()
+    {
+        window->MakeContextCurrent();
+    };
+
+    renderThreadParams.releaseContext = [window = m_window]()
+    {
+        window->ReleaseContext();
+    };
+
+    m_renderThread = RenderThread::Create(renderThreadParams).UnwrapOr(nullptr);
+    if(m_renderThread == nullptr)
+        return false;
+
+    if(m_renderThread->IsThreaded())
+    {
+        // Resources take context back before making calls on game thread.
+        m_renderContext->SetAcquireCallback([renderThread = m_renderThread.get()]()
+        {
+            renderThread->AcquireContext();
+        });
+
+        m_window->SetPresentOnEndFrame(false);
+
+        if(m_commandRecorder)
+        {
+            m_commandRecorder->SetEngineFrames(false);
+        }
+
+        LOG_INFO("Using render thread with {} frame(s) of latency.",
+            m_renderThread->GetFrameLatency());
+    }
+
     return true;
 }
 
@@ -82,14 +196,56 @@ void GameRenderer::OnDrawGameInstance(Game::GameInstance* gameInstance, float ti
     drawParams.gameInstance = gameInstance;
     drawParams.cameraName = "Camera";
     drawParams.timeAlpha = timeAlpha;
-    Draw(drawParams);
+
+    // Packet from previous draw in the same frame is published first.
+    PublishFramePacket();
+
+    // Packet is published at the end of frame and then submitted immediately
+    // or by render thread when enabled.
+    m_framePacket = &m_renderThread->BeginPacket();
+    ExtractFramePacket(drawParams, *m_framePacket);
+}
+
+void GameRenderer::OnEndFrame()
+{
+    PublishFramePacket();
+}
+
+FramePacket& GameRenderer::GetFramePacket()
+{
+    // Packet is started without clearing when game instance has not been drawn in this frame.
+    if(m_framePacket == nullptr)
+    {
+        m_framePacket = &m_renderThread->BeginPacket();
+        m_framePacket->clearMask = 0;
+    }
+
+    return *m_framePacket;
+}
+
+void GameRenderer::PublishFramePacket()
+{
+    if(m_framePacket == nullptr)
+        return;
+
+    m_framePacket = nullptr;
+    m_renderThread->EndPacket();
 }
 
 void GameRenderer::Draw(const DrawParams& drawParams)
 {
-    // Clear frame buffer.
-    m_renderContext->GetState().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Draw immediately on calling thread, which needs context back from render thread.
+    // Packet that is still open is published first, so frames are drawn in order.
+    PublishFramePacket();
+    m_renderThread->AcquireContext();
+
+    FramePacket packet;
+    ExtractFramePacket(drawParams, packet);
+    SubmitFramePacket(packet);
+}
 
+void GameRenderer::ExtractFramePacket(const DrawParams& drawParams, FramePacket& packet)
+{
     // Checks if game instance is null.
     if(!drawParams.gameInstance)
     {
@@ -107,43 +263,14 @@ void GameRenderer::Draw(const DrawParams& drawParams)
     ASSERT(componentSystem && identitySystem, "Critical systems missing from game instance!");
 
     // Update sprite components for rendering.
-    for(auto& spriteAnimationComponent : componentSystem->GetPool<Game::SpriteAnimationComponent>())
+    auto* spriteSystem = drawParams.gameInstance->GetSystems().Locate<Game::SpriteSystem>();
+    if(spriteSystem != nullptr)
     {
-        // Update sprite texture view using currently playing animation.
-        if(spriteAnimationComponent.IsPlaying())
-        {
-            Game::SpriteComponent* spriteComponent =
-                spriteAnimationComponent.GetSpriteComponent();
-
-            const Game::SpriteAnimationComponent::SpriteAnimation* spriteAnimation =
-                spriteAnimationComponent.GetCurrentSpriteAnimation();
-
-            float animationTime = spriteAnimationComponent
-                .CalculateAnimationTime(drawParams.timeAlpha);
-
-            ASSERT(spriteAnimation, "Sprite animation is null despite being played!");
-            spriteComponent->SetTextureView(
-                spriteAnimation->GetFrameByTime(animationTime).textureView);
-        }
+        spriteSystem->UpdateAnimationFrames(drawParams.timeAlpha);
     }
 
-    // Push render state.
-    auto& renderState = m_renderContext->PushState();
-    SCOPE_GUARD([this]
-    {
-        m_renderContext->PopState();
-    });
-
     // Setup drawing viewport.
-    renderState.Viewport(
-        drawParams.viewportRect.x,
-        drawParams.viewportRect.y,
-        drawParams.viewportRect.z,
-        drawParams.viewportRect.w
-    );
-
-    // Base camera transform.
-    glm::mat4 cameraTransform(1.0f);
+    packet.viewportRect = drawParams.viewportRect;
 
     // Retrieve transform from camera entity.
     auto cameraEntityResult = identitySystem->GetEntityByName(drawParams.cameraName);
@@ -161,7 +288,7 @@ void GameRenderer::Draw(const DrawParams& drawParams)
             viewportSize.y = drawParams.viewportRect.w - drawParams.viewportRect.y;
 
             // Calculate camera transform.
-            cameraTransform = cameraComponentResult.Unwrap()->CalculateTransform(viewportSize);
+            packet.cameraTransform = cameraComponentResult.Unwrap()->CalculateTransform(viewportSize);
         }
         else
         {
@@ -174,31 +301,76 @@ void GameRenderer::Draw(const DrawParams& drawParams)
         LOG_WARNING("Could not retrieve \"{}\" camera entity.", drawParams.cameraName);
     }
 
-    // Create list of sprites that will be drawn.
-    Graphics::SpriteDrawList spriteDrawList;
-
     // Iterate all sprite components.
+    // Views only resolve textures packed into atlas again after its layout changes.
+    // Pages that had regions placed into them since last packet get their mipmaps generated.
+    m_dynamicAtlas->UpdateMipmaps();
+    const uint64_t atlasVersion = m_dynamicAtlas->GetLayoutVersion();
+    const Graphics::Texture* lastTexture = nullptr;
+
     for(auto& spriteComponent : componentSystem->GetPool<Game::SpriteComponent>())
     {
         // Retrieve transform component.
         Game::TransformComponent* transformComponent = spriteComponent.GetTransformComponent();
         ASSERT(transformComponent != nullptr, "Required transform component is missing!");
 
+        // Draw packed textures from their atlas page, so sprites using them can be batched.
+        const Graphics::TextureView& textureView = spriteComponent.GetTextureView();
+        textureView.ResolveAtlas(atlasVersion);
+
+        const Graphics::Texture* texture = textureView.GetDrawTexturePtr();
+
+        // Keep texture alive until packet is submitted.
+        // Consecutive sprites often share texture, so only changes are referenced.
+        if(texture != lastTexture)
+        {
+            lastTexture = texture;
+            packet.textureReferences.push_back(textureView.GetDrawTexture());
+        }
+
         // Add sprite to draw list.
         Graphics::Sprite sprite;
-        sprite.info.texture = spriteComponent.GetTextureView().GetTexturePtr();
+        sprite.info.texture = texture;
         sprite.info.transparent = spriteComponent.IsTransparent();
         sprite.info.filtered = spriteComponent.IsFiltered();
         sprite.data.transform = transformComponent->CalculateMatrix(drawParams.timeAlpha);
         sprite.data.rectangle = spriteComponent.GetRectangle();
-        sprite.data.coords = spriteComponent.GetTextureView().GetTextureRect();
+        sprite.data.coords = textureView.GetDrawRect();
         sprite.data.color = spriteComponent.GetColor();
-        spriteDrawList.AddSprite(sprite);
+        packet.spriteDrawList.AddSprite(sprite);
     }
 
     // Sort sprite draw list.
-    spriteDrawList.SortSprites();
+    packet.spriteDrawList.SortSprites();
+}
+
+void GameRenderer::SubmitFramePacket(const FramePacket& packet)
+{
+    // Upload streamed textures within frame budget.
+    m_textureStreamer->ProcessUploads();
+
+    // Clear frame buffer.
+    m_renderContext->GetState().Clear(packet.clearMask);
+
+    // Nothing else to draw for empty packet.
+    if(packet.spriteDrawList.GetSpriteCount() == 0)
+        return;
+
+    // Push render state.
+    auto& renderState = m_renderContext->PushState();
+    SCOPE_GUARD([this]
+    {
+        m_renderContext->PopState();
+    });
+
+    // Setup drawing viewport.
+    renderState.Viewport(
+        packet.viewportRect.x,
+        packet.viewportRect.y,
+        packet.viewportRect.z,
+        packet.viewportRect.w
+    );
 
     // Draw sprite components.
-    m_spriteRenderer->DrawSprites(spriteDrawList, cameraTransform);
+    m_spriteRenderer->DrawSprites(packet.spriteDrawList, packet.cameraTransform);
 }
@@ -0,0 +1,272 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Renderer/Precompiled.hpp"
+#include "Renderer/RenderThread.hpp"
+using namespace Renderer;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double Seconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double>(duration).count();
+    }
+}
+
+RenderThread::RenderThread() = default;
+
+RenderThread::~RenderThread()
+{
+    if(!m_thread.joinable())
+        return;
+
+    // Render thread submits remaining packets and releases context before exiting.
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_renderCondition.notify_one();
+    m_thread.join();
+
+    if(!m_callerOwnsContext && m_acquireContext)
+    {
+        m_acquireContext();
+    }
+}
+
+RenderThread::CreateResult RenderThread::Create(const CreateFromParams& params)
+{
+    LOG_PROFILE_SCOPE("Create render thread");
+
+    // Check arguments.
+    CHECK_ARGUMENT_OR_RETURN(params.submitCallback,
+        Common::Failure(CreateErrors::InvalidArgument));
+    CHECK_ARGUMENT_OR_RETURN(params.frameLatency >= 1 && params.frameLatency <= MaxFrameLatency,
+        Common::Failure(CreateErrors::InvalidArgument));
+
+    // Create instance.
+    auto instance = std::unique_ptr<RenderThread>(new RenderThread());
+    instance->m_submitCallback = params.submitCallback;
+    instance->m_acquireContext = params.acquireContext;
+    instance->m_releaseContext = params.releaseContext;
+
+    if(params.threaded && !IsSupported())
+    {
+        LOG_INFO("Render thread is not supported on this platform, "
+            "frames will be submitted on game thread.");
+    }
+
+    // Single packet is enough when it is submitted right after being published.
+    const bool threaded = params.threaded && IsSupported();
+    instance->m_frameLatency = threaded ? params.frameLatency : 0;
+    instance->m_packets.resize(instance->m_frameLatency + 1);
+
+    for(auto& packet : instance->m_packets)
+    {
+        packet = std::make_unique<FramePacket>();
+    }
+
+    // Start render thread last, after all its state has been initialized.
+    if(threaded)
+    {
+        instance->m_thread = std::thread(&RenderThread::Run, instance.get());
+    }
+
+    return Common::Success(std::move(instance));
+}
+
+bool RenderThread::IsSupported()
+{
+#ifndef __EMSCRIPTEN__
+    return true;
+#else
+    return false;
+#endif
+}
+
+FramePacket& RenderThread::BeginPacket()
+{
+    ASSERT(!m_writingPacket, "Previous frame packet has not been published!");
+
+    if(IsThreaded())
+    {
+        // Wait until render thread is at most frame latency behind, freeing next buffer.
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        Clock::time_point waitStart = Clock::now();
+        m_gameCondition.wait(lock, [this]()
+        {
+            return m_publishedFrames - m_submittedFrames < m_packets.size();
+        });
+
+        m_stats.gameWaitSeconds += Seconds(Clock::now() - waitStart);
+    }
+
+    // Published frame count is only modified by game thread.
+    const uint64_t frameIndex = m_publishedFrames;
+    FramePacket& packet = *m_packets[frameIndex % m_packets.size()];
+    packet.Reset();
+    packet.frameIndex = frameIndex;
+
+    m_writingPacket = true;
+    return packet;
+}
+
+void RenderThread::EndPacket()
+{
+    ASSERT(m_writingPacket, "Frame packet has not been started!");
+    m_writingPacket = false;
+
+    if(!IsThreaded())
+    {
+        Clock::time_point submitStart = Clock::now();
+        Submit(*m_packets.front());
+
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_stats.submitSeconds += Seconds(Clock::now() - submitStart);
+        m_publishedFrames += 1;
+        m_submittedFrames += 1;
+        return;
+    }
+
+    // Hand context over to render thread before it needs it for submission.
+    if(m_callerOwnsContext)
+    {
+        if(m_releaseContext)
+        {
+            m_releaseContext();
+        }
+
+        m_callerOwnsContext = false;
+    }
+
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        m_publishedFrames += 1;
+    }
+
+    m_renderCondition.notify_one();
+}
+
+void RenderThread::Flush()
+{
+    if(!IsThreaded())
+        return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_gameCondition.wait(lock, [this]()
+    {
+        return m_submittedFrames == m_publishedFrames;
+    });
+}
+
+void RenderThread::AcquireContext()
+{
+    // Render thread already owns context while submitting. Packet that is being written can stay
+    // open, as render thread does not read it until it is published.
+    if(!IsThreaded() || std::this_thread::get_id() == m_thread.get_id() || m_callerOwnsContext)
+        return;
+
+    // Render thread releases context once all published packets have been submitted.
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_contextRequested = true;
+        m_renderCondition.notify_one();
+
+        m_gameCondition.wait(lock, [this]()
+        {
+            return m_submittedFrames == m_publishedFrames && !m_renderOwnsContext;
+        });
+
+        m_contextRequested = false;
+    }
+
+    if(m_acquireContext)
+    {
+        m_acquireContext();
+    }
+
+    m_callerOwnsContext = true;
+}
+
+RenderThread::Stats RenderThread::GetStats() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    Stats stats = m_stats;
+    stats.publishedFrames = m_publishedFrames;
+    stats.submittedFrames = m_submittedFrames;
+    return stats;
+}
+
+void RenderThread::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while(true)
+    {
+        Clock::time_point waitStart = Clock::now();
+        m_renderCondition.wait(lock, [this]()
+        {
+            return m_stopping || m_submittedFrames != m_publishedFrames ||
+                (m_contextRequested && m_renderOwnsContext);
+        });
+
+        m_stats.renderWaitSeconds += Seconds(Clock::now() - waitStart);
+
+        // Submit packets in order they were published.
+        if(m_submittedFrames != m_publishedFrames)
+        {
+            FramePacket& packet = *m_packets[m_submittedFrames % m_packets.size()];
+            const bool acquireContext = !m_renderOwnsContext;
+            m_renderOwnsContext = true;
+            lock.unlock();
+
+            if(acquireContext && m_acquireContext)
+            {
+                m_acquireContext();
+            }
+
+            Clock::time_point submitStart = Clock::now();
+            Submit(packet);
+            Clock::duration submitTime = Clock::now() - submitStart;
+
+            lock.lock();
+            m_stats.submitSeconds += Seconds(submitTime);
+            m_submittedFrames += 1;
+            m_gameCondition.notify_all();
+            continue;
+        }
+
+        // Give context away only after all packets have been submitted.
+        if(m_renderOwnsContext && (m_contextRequested || m_stopping))
+        {
+            lock.unlock();
+
+            if(m_releaseContext)
+            {
+                m_releaseContext();
+            }
+
+            lock.lock();
+            m_renderOwnsContext = false;
+            m_gameCondition.notify_all();
+        }
+
+        if(m_stopping)
+            break;
+    }
+}
+
+void RenderThread::Submit(FramePacket& packet)
+{
+    m_submitCallback(packet);
+
+    // Textures are released on thread that owns context, as last reference can destroy them.
+    packet.textureReferences.clear();
+}
@@ -0,0 +1,206 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Script/Precompiled.hpp"
+#include "Script/ScriptAllocator.hpp"
+using namespace Script;
+
+namespace
+{
+    // Block sizes of size classes, aligned to maximum fundamental alignment.
+    const std::size_t SizeClassBlockSizes[] =
+    {
+        16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256,
+    };
+}
+
+ScriptAllocator::ScriptAllocator(std::size_t memoryLimit, bool pooling)
+    : m_memoryLimit(memoryLimit)
+    , m_pooling(pooling)
+{
+    static_assert(std::size(SizeClassBlockSizes) == SizeClassCount);
+    static_assert(alignof(std::max_align_t) <= 16, "Size classes are not aligned!");
+}
+
+ScriptAllocator::~ScriptAllocator()
+{
+    // Blocks that are still allocated are freed along with their pages.
+    for(void* page : m_pages)
+    {
+        std::free(page);
+    }
+}
+
+void* ScriptAllocator::Allocate(void* userData, void* pointer, std::size_t oldSize, std::size_t newSize)
+{
+    ASSERT(userData != nullptr, "Script allocator is null!");
+    return static_cast<ScriptAllocator*>(userData)->Reallocate(pointer, oldSize, newSize);
+}
+
+void* ScriptAllocator::Reallocate(void* pointer, std::size_t oldSize, std::size_t newSize)
+{
+    /*
+        Implements lua_Alloc semantics. When pointer is null, old size encodes type of allocated
+        object instead of block size. Block is moved between size classes when resized, as
+        size class of freed block is determined only from size that Lua passes for it.
+    */
+
+    if(pointer == nullptr)
+    {
+        oldSize = 0;
+    }
+
+    // Free block.
+    if(newSize == 0)
+    {
+        if(pointer != nullptr)
+        {
+            ReleaseBlock(pointer, GetSizeClass(oldSize));
+            m_stats.bytesLive -= oldSize;
+            m_stats.frees += 1;
+        }
+
+        return nullptr;
+    }
+
+    // Check memory limit only for growing blocks.
+    if(newSize > oldSize && m_memoryLimit != 0 && m_stats.bytesLive - oldSize + newSize > m_memoryLimit)
+    {
+        m_stats.failedAllocations += 1;
+        return nullptr;
+    }
+
+    const std::size_t oldSizeClass = GetSizeClass(oldSize);
+    const std::size_t newSizeClass = GetSizeClass(newSize);
+    void* newPointer = nullptr;
+
+    if(pointer != nullptr && oldSizeClass == newSizeClass)
+    {
+        // Block of same size class can be kept as it is.
+        newPointer = newSizeClass == LargeSizeClass ? std::realloc(pointer, newSize) : pointer;
+    }
+    else
+    {
+        newPointer = newSizeClass == LargeSizeClass ? std::malloc(newSize) : AllocateBlock(newSizeClass);
+
+        if(newPointer != nullptr && pointer != nullptr)
+        {
+            std::memcpy(newPointer, pointer, std::min(oldSize, newSize));
+            ReleaseBlock(pointer, oldSizeClass);
+        }
+    }
+
+    if(newPointer == nullptr && pointer != nullptr && newSize <= oldSize)
+    {
+        // Shrinking must not fail, so block is kept where it is. Block of system allocator that
+        // is moved into size class becomes its page, so it is freed along with other pages.
+        if(oldSizeClass == LargeSizeClass && newSizeClass != LargeSizeClass)
+        {
+            AddPage(newSizeClass, pointer, oldSize);
+            newPointer = AllocateBlock(newSizeClass);
+            ASSERT(newPointer == pointer, "Adopted block was not allocated from its page!");
+        }
+        else
+        {
+            newPointer = pointer;
+        }
+    }
+
+    if(newPointer == nullptr)
+    {
+        m_stats.failedAllocations += 1;
+        return nullptr;
+    }
+
+    // Update memory statistics.
+    m_stats.bytesLive = m_stats.bytesLive - oldSize + newSize;
+    m_stats.bytesPeak = std::max(m_stats.bytesPeak, m_stats.bytesLive);
+    m_stats.bytesAllocated += newSize > oldSize ? newSize - oldSize : 0;
+
+    if(pointer == nullptr)
+    {
+        m_stats.allocations += 1;
+
+        if(newSizeClass != LargeSizeClass)
+        {
+            m_stats.pooledAllocations += 1;
+        }
+    }
+    else
+    {
+        m_stats.reallocations += 1;
+    }
+
+    return newPointer;
+}
+
+std::size_t ScriptAllocator::GetSizeClass(std::size_t size) const
+{
+    if(!m_pooling || size == 0 || size > MaxPooledSize)
+        return LargeSizeClass;
+
+    // Size classes are 16 bytes apart up to 128 bytes and 32 bytes apart after.
+    if(size <= 128)
+        return (size - 1) / 16;
+
+    return 8 + (size - 129) / 32;
+}
+
+void* ScriptAllocator::AllocateBlock(std::size_t sizeClass)
+{
+    ASSERT(sizeClass < SizeClassCount, "Invalid size class!");
+    SizeClass& pool = m_sizeClasses[sizeClass];
+
+    // Reuse most recently freed block.
+    if(pool.freeList != nullptr)
+    {
+        FreeBlock* block = pool.freeList;
+        pool.freeList = block->next;
+        return block;
+    }
+
+    // Carve new block from current page, allocating new page once it is exhausted.
+    const std::size_t blockSize = SizeClassBlockSizes[sizeClass];
+    if(pool.pageCursor == nullptr || pool.pageCursor + blockSize > pool.pageEnd)
+    {
+        void* page = m_pageAllocateFunction(PageSize);
+        if(page == nullptr)
+            return nullptr;
+
+        AddPage(sizeClass, page, PageSize);
+    }
+
+    void* block = pool.pageCursor;
+    pool.pageCursor += blockSize;
+    return block;
+}
+
+void ScriptAllocator::ReleaseBlock(void* pointer, std::size_t sizeClass)
+{
+    if(sizeClass == LargeSizeClass)
+    {
+        std::free(pointer);
+        return;
+    }
+
+    ASSERT(sizeClass < SizeClassCount, "Invalid size class!");
+    SizeClass& pool = m_sizeClasses[sizeClass];
+
+    FreeBlock* block = static_cast<FreeBlock*>(pointer);
+    block->next = pool.freeList;
+    pool.freeList = block;
+}
+
+void ScriptAllocator::AddPage(std::size_t sizeClass, void* page, std::size_t size)
+{
+    ASSERT(sizeClass < SizeClassCount, "Invalid size class!");
+    SizeClass& pool = m_sizeClasses[sizeClass];
+
+    m_pages.push_back(page);
+    m_stats.bytesReserved += size;
+
+    pool.pageCursor = static_cast<uint8_t*>(page);
+    pool.pageEnd = pool.pageCursor + size;
+}
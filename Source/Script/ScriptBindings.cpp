@@ -0,0 +1,298 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Script/Precompiled.hpp"
+#include "Script/ScriptBindings.hpp"
+using namespace Script;
+
+namespace
+{
+    template<typename Type>
+    int GetNumber(lua_State* state, const void* field)
+    {
+        lua_pushnumber(state, static_cast<lua_Number>(*static_cast<const Type*>(field)));
+        return 1;
+    }
+
+    template<typename Type>
+    void SetNumber(lua_State* state, int valueIndex, void* field)
+    {
+        *static_cast<Type*>(field) = static_cast<Type>(luaL_checknumber(state, valueIndex));
+    }
+
+    template<typename Type>
+    int GetInteger(lua_State* state, const void* field)
+    {
+        lua_pushinteger(state, static_cast<lua_Integer>(*static_cast<const Type*>(field)));
+        return 1;
+    }
+
+    template<typename Type>
+    void SetInteger(lua_State* state, int valueIndex, void* field)
+    {
+        *static_cast<Type*>(field) = static_cast<Type>(luaL_checkinteger(state, valueIndex));
+    }
+
+    int GetBoolean(lua_State* state, const void* field)
+    {
+        lua_pushboolean(state, *static_cast<const bool*>(field));
+        return 1;
+    }
+
+    void SetBoolean(lua_State* state, int valueIndex, void* field)
+    {
+        *static_cast<bool*>(field) = lua_toboolean(state, valueIndex) != 0;
+    }
+
+    template<typename Type>
+    int GetVector(lua_State* state, const void* field)
+    {
+        // Components of glm quaternion are stored in x, y, z, w order like vectors.
+        const Type& vector = *static_cast<const Type*>(field);
+        for(int i = 0; i < Type::length(); ++i)
+        {
+            lua_pushnumber(state, static_cast<lua_Number>(vector[i]));
+        }
+
+        return Type::length();
+    }
+
+    template<typename Type>
+    void SetVector(lua_State* state, int valueIndex, void* field)
+    {
+        Type& vector = *static_cast<Type*>(field);
+        for(int i = 0; i < Type::length(); ++i)
+        {
+            vector[i] = static_cast<typename Type::value_type>(luaL_checknumber(state, valueIndex + i));
+        }
+    }
+
+    // Metatable that identifies userdata created as object handles.
+    const char* ObjectMetatable = "Script::ObjectHandle";
+
+    struct ObjectHandle
+    {
+        void* object = nullptr;
+        uint32_t typeIndex = 0;
+    };
+
+    const ScriptBindings::FieldBinding* CheckField(lua_State* state, void*& object)
+    {
+        const auto* scriptBindings = static_cast<const ScriptBindings*>(
+            lua_touserdata(state, lua_upvalueindex(1)));
+        ASSERT(scriptBindings != nullptr, "Script bindings are null!");
+
+        // Only handles created by bindings are accepted, as they carry type of object.
+        const auto* handle = static_cast<const ObjectHandle*>(luaL_checkudata(state, 1, ObjectMetatable));
+        luaL_argcheck(state, handle->object != nullptr, 1, "object is no longer valid");
+        object = handle->object;
+
+        // Field index must be within range of fields that belong to object type.
+        const ScriptBindings::TypeBinding& typeBinding = scriptBindings->GetTypes()[handle->typeIndex];
+        const lua_Integer fieldIndex = luaL_checkinteger(state, 2);
+
+        if(fieldIndex < static_cast<lua_Integer>(typeBinding.firstField) ||
+            fieldIndex >= static_cast<lua_Integer>(typeBinding.firstField + typeBinding.fieldCount))
+        {
+            lua_pushlstring(state, typeBinding.name.data(), typeBinding.name.size());
+            luaL_argerror(state, 2, lua_pushfstring(state, "field index %d does not belong to \"%s\"",
+                static_cast<int>(fieldIndex), lua_tostring(state, -1)));
+        }
+
+        return &scriptBindings->GetFields()[static_cast<std::size_t>(fieldIndex)];
+    }
+
+    extern "C"
+    {
+        // Pushes value of field at index from second argument for object handle from first argument.
+        static int LuaGetField(lua_State* L)
+        {
+            void* object = nullptr;
+            const ScriptBindings::FieldBinding* field = CheckField(L, object);
+            return field->getFunction(L, field->accessFunction(object));
+        }
+
+        // Sets value of field at index from second argument for object handle from first argument,
+        // from values passed as remaining arguments.
+        static int LuaSetField(lua_State* L)
+        {
+            void* object = nullptr;
+            const ScriptBindings::FieldBinding* field = CheckField(L, object);
+            field->setFunction(L, 3, field->accessFunction(object));
+            return 0;
+        }
+    }
+}
+
+ScriptBindings::ScriptBindings() = default;
+ScriptBindings::~ScriptBindings() = default;
+
+bool ScriptBindings::OnAttach(const Core::EngineSystemStorage& engineSystems)
+{
+    BindTypes();
+    return true;
+}
+
+void ScriptBindings::BindTypes()
+{
+    /*
+        Resolve accessors of all reflected fields that can be bound. Fields of each type are
+        stored next to each other, so type binding only needs to refer to range of them.
+    */
+
+    LOG_PROFILE_SCOPE("Bind reflected types");
+
+    m_fields.clear();
+    m_types.clear();
+    m_typeLookup.clear();
+
+    for(const auto& [identifier, typeInfo] : Reflection::GetRegistry().GetTypes())
+    {
+        TypeBinding typeBinding;
+        typeBinding.identifier = identifier;
+        typeBinding.name = typeInfo.GetTypeName();
+        typeBinding.firstField = m_fields.size();
+
+        for(const auto& member : typeInfo.GetMembers())
+        {
+            FieldBinding fieldBinding;
+            fieldBinding.name = member.name;
+            fieldBinding.accessFunction = member.accessFunction;
+
+            switch(member.typeIdentifier)
+            {
+            case Reflection::GetIdentifier<bool>():
+                fieldBinding.getFunction = &GetBoolean;
+                fieldBinding.setFunction = &SetBoolean;
+                break;
+
+            case Reflection::GetIdentifier<int>():
+                fieldBinding.getFunction = &GetInteger<int>;
+                fieldBinding.setFunction = &SetInteger<int>;
+                break;
+
+            case Reflection::GetIdentifier<unsigned int>():
+                fieldBinding.getFunction = &GetInteger<unsigned int>;
+                fieldBinding.setFunction = &SetInteger<unsigned int>;
+                break;
+
+            case Reflection::GetIdentifier<float>():
+                fieldBinding.getFunction = &GetNumber<float>;
+                fieldBinding.setFunction = &SetNumber<float>;
+                break;
+
+            case Reflection::GetIdentifier<double>():
+                fieldBinding.getFunction = &GetNumber<double>;
+                fieldBinding.setFunction = &SetNumber<double>;
+                break;
+
+            case Reflection::GetIdentifier<glm::vec2>():
+                fieldBinding.getFunction = &GetVector<glm::vec2>;
+                fieldBinding.setFunction = &SetVector<glm::vec2>;
+                break;
+
+            case Reflection::GetIdentifier<glm::vec3>():
+                fieldBinding.getFunction = &GetVector<glm::vec3>;
+                fieldBinding.setFunction = &SetVector<glm::vec3>;
+                break;
+
+            case Reflection::GetIdentifier<glm::vec4>():
+                fieldBinding.getFunction = &GetVector<glm::vec4>;
+                fieldBinding.setFunction = &SetVector<glm::vec4>;
+                break;
+
+            case Reflection::GetIdentifier<glm::quat>():
+                fieldBinding.getFunction = &GetVector<glm::quat>;
+                fieldBinding.setFunction = &SetVector<glm::quat>;
+                break;
+
+            default:
+                continue;
+            }
+
+            m_fields.push_back(fieldBinding);
+        }
+
+        typeBinding.fieldCount = m_fields.size() - typeBinding.firstField;
+        if(typeBinding.fieldCount != 0)
+        {
+            m_typeLookup.emplace(identifier, static_cast<uint32_t>(m_types.size()));
+            m_types.push_back(typeBinding);
+        }
+    }
+
+    LOG_INFO("Bound {} fields of {} reflected types for scripts.", m_fields.size(), m_types.size());
+}
+
+void ScriptBindings::Bind(lua_State* state) const
+{
+    ASSERT(state != nullptr, "Lua state is null!");
+
+    // Create table of field indices for each bound type.
+    lua_createtable(state, 0, static_cast<int>(m_types.size()));
+
+    for(const TypeBinding& typeBinding : m_types)
+    {
+        lua_pushlstring(state, typeBinding.name.data(), typeBinding.name.size());
+        lua_createtable(state, 0, static_cast<int>(typeBinding.fieldCount));
+
+        for(std::size_t i = 0; i < typeBinding.fieldCount; ++i)
+        {
+            const std::size_t fieldIndex = typeBinding.firstField + i;
+            const FieldBinding& fieldBinding = m_fields[fieldIndex];
+
+            lua_pushlstring(state, fieldBinding.name.data(), fieldBinding.name.size());
+            lua_pushinteger(state, static_cast<lua_Integer>(fieldIndex));
+            lua_rawset(state, -3);
+        }
+
+        lua_rawset(state, -3);
+    }
+
+    lua_setglobal(state, "Types");
+
+    // Create metatable that marks userdata as object handle.
+    luaL_newmetatable(state, ObjectMetatable);
+    lua_pushboolean(state, 0);
+    lua_setfield(state, -2, "__metatable");
+    lua_pop(state, 1);
+
+    // Register field access functions that refer back to bindings.
+    lua_pushlightuserdata(state, const_cast<ScriptBindings*>(this));
+    lua_pushcclosure(state, LuaGetField, 1);
+    lua_setglobal(state, "GetField");
+
+    lua_pushlightuserdata(state, const_cast<ScriptBindings*>(this));
+    lua_pushcclosure(state, LuaSetField, 1);
+    lua_setglobal(state, "SetField");
+}
+
+bool ScriptBindings::PushObject(lua_State* state, Reflection::TypeIdentifier type, void* object) const
+{
+    ASSERT(state != nullptr, "Lua state is null!");
+
+    auto it = m_typeLookup.find(type);
+    if(it == m_typeLookup.end())
+    {
+        lua_pushnil(state);
+        return false;
+    }
+
+    auto* handle = static_cast<ObjectHandle*>(lua_newuserdata(state, sizeof(ObjectHandle)));
+    handle->object = object;
+    handle->typeIndex = it->second;
+    luaL_setmetatable(state, ObjectMetatable);
+    return true;
+}
+
+void ScriptBindings::SetObject(lua_State* state, int index, void* object)
+{
+    ASSERT(state != nullptr, "Lua state is null!");
+
+    // Type of handle stays the same, so object must be of same type.
+    auto* handle = static_cast<ObjectHandle*>(luaL_testudata(state, index, ObjectMetatable));
+    ASSERT(handle != nullptr, "Value is not object handle!");
+    handle->object = object;
+}
@@ -0,0 +1,329 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Script/Precompiled.hpp"
+#include "Script/ScriptCache.hpp"
+#include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
+using namespace Script;
+
+namespace
+{
+    const char* LogAttachFailed = "Failed to attach script cache! {}";
+
+    const uint32_t CacheFileMagic = 0x43554C53; // "SLUC"
+    const uint32_t CacheFileVersion = 1;
+
+    struct CacheFileHeader
+    {
+        uint32_t magic = CacheFileMagic;
+        uint32_t version = CacheFileVersion;
+        uint64_t chunkKey = 0;
+        uint64_t bytecodeLength = 0;
+    };
+
+    double SecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    extern "C"
+    {
+        // Appends piece of dumped chunk to bytecode array.
+        static int LuaBytecodeWriter(lua_State* L, const void* data, size_t size, void* userData)
+        {
+            auto* bytecode = static_cast<ScriptCache::Bytecode*>(userData);
+            const char* bytes = static_cast<const char*>(data);
+            bytecode->insert(bytecode->end(), bytes, bytes + size);
+            return 0;
+        }
+    }
+}
+
+ScriptCache::ScriptCache() = default;
+ScriptCache::~ScriptCache()
+{
+    LogStats();
+}
+
+bool ScriptCache::OnAttach(const Core::EngineSystemStorage& engineSystems)
+{
+    // Locate needed engine systems.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(configSystem == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate config system.");
+        return false;
+    }
+
+    // Disk cache is optional and chunks are only kept in memory without it.
+    m_directory = configSystem->Get<std::string>(
+        NAME_CONSTEXPR("script.cacheDirectory")).UnwrapOr("");
+
+    if(m_directory.empty())
+        return true;
+
+    std::error_code error;
+    fs::create_directories(m_directory, error);
+    if(error)
+    {
+        LOG_WARNING("Script cache is not stored on disk because \"{}\" directory could not be created! {}",
+            m_directory.generic_string(), error.message());
+
+        m_directory.clear();
+        return true;
+    }
+
+    LOG_INFO("Script cache is using \"{}\" directory.", m_directory.generic_string());
+    return true;
+}
+
+ScriptCache::ChunkKey ScriptCache::CalculateKey(std::string_view source, std::string_view chunkName)
+{
+    // Bytecode format differs between Lua versions and includes chunk name for debug info.
+    ChunkKey key = Common::StringHash<uint64_t>(LUA_RELEASE);
+    key = Common::CombineHash(key, Common::StringHash<uint64_t>(chunkName));
+    key = Common::CombineHash(key, Common::StringHash<uint64_t>(source));
+    return key;
+}
+
+fs::path ScriptCache::GetChunkPath(ChunkKey key) const
+{
+    return m_directory / fmt::format("{:016x}.luac", key);
+}
+
+bool ScriptCache::LoadChunk(lua_State* state, std::string_view source, const char* chunkName)
+{
+    /*
+        Push function of loaded chunk on top of stack, same as luaL_loadbuffer() does. Look for
+        compiled chunk in memory first, then on disk, and compile it from source if neither has
+        it. On failure, error message is pushed on top of stack instead.
+    */
+
+    ASSERT(state != nullptr, "Lua state is null!");
+    ASSERT(chunkName != nullptr, "Chunk name is null!");
+
+    const ChunkKey key = CalculateKey(source, chunkName);
+
+    // Load bytecode stored in memory, which can be replaced while it is being loaded.
+    std::shared_ptr<const Bytecode> storedBytecode;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        auto it = m_chunks.find(key);
+        if(it != m_chunks.end())
+        {
+            storedBytecode = it->second;
+        }
+    }
+
+    if(storedBytecode && LoadBytecode(state, key, *storedBytecode, chunkName))
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stats.memoryHits += 1;
+        return true;
+    }
+
+    // Load bytecode stored on disk.
+    Bytecode bytecode;
+    if(ReadChunkFile(key, bytecode) && LoadBytecode(state, key, bytecode, chunkName))
+    {
+        StoreBytecode(key, std::move(bytecode));
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stats.diskHits += 1;
+        return true;
+    }
+
+    // Compile chunk from source, leaving error message on stack if it fails.
+    const auto compileStart = std::chrono::steady_clock::now();
+
+    if(luaL_loadbufferx(state, source.data(), source.size(), chunkName, "t") != 0)
+        return false;
+
+    bytecode.clear();
+    if(lua_dump(state, LuaBytecodeWriter, &bytecode, 0) != 0 || bytecode.empty())
+    {
+        LOG_WARNING("Script chunk \"{}\" could not be dumped to bytecode!", chunkName);
+        return true;
+    }
+
+    const double compileSeconds = SecondsSince(compileStart);
+    WriteChunkFile(key, bytecode);
+    StoreBytecode(key, std::move(bytecode));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stats.misses += 1;
+    m_stats.compileSeconds += compileSeconds;
+    return true;
+}
+
+bool ScriptCache::LoadBytecode(lua_State* state, ChunkKey key,
+    const Bytecode& bytecode, const char* chunkName)
+{
+    // Only binary chunks are accepted, so cached data is never parsed as source.
+    // Lua state does not keep reference to bytecode after loading it.
+    if(luaL_loadbufferx(state, bytecode.data(), bytecode.size(), chunkName, "b") != 0)
+    {
+        LOG_WARNING("Cached script chunk \"{}\" could not be loaded! {}",
+            chunkName, lua_tostring(state, -1));
+
+        lua_pop(state, 1);
+        RejectChunk(key, "Bytecode rejected by Lua.");
+        return false;
+    }
+
+    return true;
+}
+
+void ScriptCache::StoreBytecode(ChunkKey key, Bytecode&& bytecode)
+{
+    auto storedBytecode = std::make_shared<const Bytecode>(std::move(bytecode));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_chunks[key] = std::move(storedBytecode);
+}
+
+bool ScriptCache::ReadChunkFile(ChunkKey key, Bytecode& bytecode)
+{
+    if(!IsDiskEnabled())
+        return false;
+
+    std::ifstream file(GetChunkPath(key), std::ios::binary);
+    if(!file.is_open())
+        return false;
+
+    // Validate cache file header before handing bytecode to Lua.
+    CacheFileHeader header;
+    if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        file.close();
+        RejectChunk(key, "Could not read header.");
+        return false;
+    }
+
+    if(header.magic != CacheFileMagic || header.version != CacheFileVersion)
+    {
+        file.close();
+        RejectChunk(key, "Unknown file format.");
+        return false;
+    }
+
+    if(header.chunkKey != key)
+    {
+        file.close();
+        RejectChunk(key, "Chunk key mismatch.");
+        return false;
+    }
+
+    // Length stored in header must match remaining file size before anything is allocated for it.
+    const std::streamoff bytecodeOffset = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streamoff fileSize = file.tellg();
+    file.seekg(bytecodeOffset, std::ios::beg);
+
+    if(bytecodeOffset < 0 || fileSize < bytecodeOffset || header.bytecodeLength == 0 ||
+        header.bytecodeLength != static_cast<uint64_t>(fileSize - bytecodeOffset))
+    {
+        file.close();
+        RejectChunk(key, "Invalid bytecode length.");
+        return false;
+    }
+
+    bytecode.resize(static_cast<std::size_t>(header.bytecodeLength));
+    if(!file.read(bytecode.data(), bytecode.size()) || file.peek() != EOF)
+    {
+        file.close();
+        RejectChunk(key, "Invalid bytecode length.");
+        return false;
+    }
+
+    return true;
+}
+
+void ScriptCache::WriteChunkFile(ChunkKey key, const Bytecode& bytecode)
+{
+    if(!IsDiskEnabled())
+        return;
+
+    CacheFileHeader header;
+    header.chunkKey = key;
+    header.bytecodeLength = bytecode.size();
+
+    // Write to temporary file first, so interrupted writes never leave
+    // partial cache file that would be picked up on next launch.
+    const fs::path chunkPath = GetChunkPath(key);
+    fs::path temporaryPath = chunkPath;
+    temporaryPath += fmt::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(bytecode.data(), bytecode.size());
+
+        if(!file.good())
+        {
+            file.close();
+            LOG_WARNING("Script chunk bytecode could not be written to \"{}\" file!",
+                temporaryPath.generic_string());
+
+            std::error_code error;
+            fs::remove(temporaryPath, error);
+            return;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporaryPath, chunkPath, error);
+    if(error)
+    {
+        LOG_WARNING("Script chunk bytecode could not be moved to \"{}\" file! {}",
+            chunkPath.generic_string(), error.message());
+
+        fs::remove(temporaryPath, error);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stats.stored += 1;
+}
+
+void ScriptCache::RejectChunk(ChunkKey key, const char* reason)
+{
+    // Delete invalid cache file so it gets replaced once chunk is compiled from source.
+    if(IsDiskEnabled())
+    {
+        const fs::path chunkPath = GetChunkPath(key);
+        LOG_WARNING("Discarding cached script chunk \"{}\"! {}", chunkPath.generic_string(), reason);
+
+        std::error_code error;
+        fs::remove(chunkPath, error);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_chunks.erase(key);
+    m_stats.rejected += 1;
+}
+
+void ScriptCache::Clear()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_chunks.clear();
+}
+
+ScriptCache::Stats ScriptCache::GetStats() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void ScriptCache::LogStats() const
+{
+    const Stats stats = GetStats();
+    LOG_INFO("Script cache: {} memory hits, {} disk hits, {} misses ({} rejected), {} stored, "
+        "compiled in {:.4f}s.", stats.memoryHits, stats.diskHits, stats.misses, stats.rejected,
+        stats.stored, stats.compileSeconds);
+}
@@ -0,0 +1,201 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Script/Precompiled.hpp"
+#include "Script/ScriptGarbageCollector.hpp"
+#include "Script/ScriptState.hpp"
+#include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
+using namespace Script;
+
+namespace
+{
+    const char* LogAttachFailed = "Failed to attach script garbage collector! {}";
+
+    // Collection work is spread over few steps per frame, so budget can stop it in between.
+    const double TargetStepsPerFrame = 4.0;
+    const int MinStepKilobytes = 1;
+    const int MaxStepKilobytes = 1024;
+
+    // Weight of current frame in averaged allocation rate.
+    const double AllocationRateWeight = 0.25;
+
+    double MicrosecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+ScriptGarbageCollector::ScriptGarbageCollector() = default;
+ScriptGarbageCollector::~ScriptGarbageCollector()
+{
+    ASSERT(m_states.empty(), "Script states are still registered with garbage collector!");
+}
+
+bool ScriptGarbageCollector::OnAttach(const Core::EngineSystemStorage& engineSystems)
+{
+    // Locate needed engine systems.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(configSystem == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate config system.");
+        return false;
+    }
+
+    // Read collection configuration.
+    m_budget = configSystem->Get<double>(
+        NAME_CONSTEXPR("script.gcBudget")).UnwrapOr(m_budget);
+    m_stepMultiplier = configSystem->Get<double>(
+        NAME_CONSTEXPR("script.gcStepMultiplier")).UnwrapOr(m_stepMultiplier);
+
+    const std::string mode = configSystem->Get<std::string>(
+        NAME_CONSTEXPR("script.gcMode")).UnwrapOr("incremental");
+
+    if(m_budget < 0.0 || m_stepMultiplier <= 0.0)
+    {
+        LOG_ERROR(LogAttachFailed, "Invalid garbage collection configuration.");
+        return false;
+    }
+
+    if(mode == "generational")
+    {
+#if LUA_VERSION_NUM >= 504
+        m_generational = true;
+#else
+        LOG_WARNING("Generational garbage collection is not supported by {}, "
+            "using incremental collection instead.", LUA_RELEASE);
+#endif
+    }
+    else if(mode != "incremental")
+    {
+        LOG_ERROR(LogAttachFailed, "Unknown garbage collection mode.");
+        return false;
+    }
+
+    return true;
+}
+
+void ScriptGarbageCollector::Register(ScriptState* scriptState)
+{
+    ASSERT(scriptState != nullptr, "Script state is null!");
+
+    auto it = std::find_if(m_states.begin(), m_states.end(),
+        [scriptState](const StateEntry& entry)
+        {
+            return entry.scriptState == scriptState;
+        });
+
+    if(it != m_states.end())
+        return;
+
+    StateEntry entry;
+    entry.scriptState = scriptState;
+    entry.lastBytesAllocated = scriptState->GetAllocator().GetStats().bytesAllocated;
+    m_states.push_back(entry);
+
+    // Set collection mode of state, which only runs on its own when not scheduled.
+#if LUA_VERSION_NUM >= 504
+    if(m_generational)
+    {
+        lua_gc(*scriptState, LUA_GCGEN, 0, 0);
+    }
+#endif
+
+    if(IsScheduling())
+    {
+        lua_gc(*scriptState, LUA_GCSTOP, 0);
+    }
+}
+
+void ScriptGarbageCollector::Unregister(ScriptState* scriptState)
+{
+    auto it = std::find_if(m_states.begin(), m_states.end(),
+        [scriptState](const StateEntry& entry)
+        {
+            return entry.scriptState == scriptState;
+        });
+
+    if(it == m_states.end())
+        return;
+
+    m_states.erase(it);
+    m_nextState = m_states.empty() ? 0 : m_nextState % m_states.size();
+    lua_gc(*scriptState, LUA_GCRESTART, 0);
+}
+
+void ScriptGarbageCollector::OnEndFrame()
+{
+    Collect();
+}
+
+void ScriptGarbageCollector::Collect()
+{
+    /*
+        Run incremental collection steps for registered states within time budget. Each state owes
+        collection work proportional to memory it allocated since last frame. Owed work is paid
+        with steps sized from averaged allocation rate of state, so states that allocate more take
+        larger steps. States are visited starting from different one each frame, so states at the
+        end do not always get remaining budget. Work that is not paid is carried to next frame.
+    */
+
+    m_frameStats = FrameStats();
+
+    if(!IsScheduling() || m_states.empty())
+        return;
+
+    LOG_PROFILE_SCOPE("Collect script garbage");
+
+    const auto frameStart = std::chrono::steady_clock::now();
+
+    for(std::size_t visit = 0; visit < m_states.size(); ++visit)
+    {
+        StateEntry& entry = m_states[(m_nextState + visit) % m_states.size()];
+        lua_State* state = *entry.scriptState;
+
+        // Update allocation rate from bytes allocated since last frame.
+        const std::size_t bytesAllocated = entry.scriptState->GetAllocator().GetStats().bytesAllocated;
+        const double allocatedSinceLastFrame = static_cast<double>(bytesAllocated - entry.lastBytesAllocated);
+        entry.lastBytesAllocated = bytesAllocated;
+
+        entry.allocationRate = glm::mix(entry.allocationRate, allocatedSinceLastFrame, AllocationRateWeight);
+        entry.collectionDebt += allocatedSinceLastFrame * m_stepMultiplier;
+
+        if(entry.collectionDebt <= 0.0)
+            continue;
+
+        const int stepKilobytes = glm::clamp(static_cast<int>(entry.allocationRate * m_stepMultiplier
+            / (TargetStepsPerFrame * 1024.0)), MinStepKilobytes, MaxStepKilobytes);
+
+        // Basic step discards debt that stopped collector accumulated from allocations.
+        bool cycleCompleted = lua_gc(state, LUA_GCSTEP, 0) != 0;
+        m_frameStats.steps += 1;
+
+        while(!cycleCompleted && entry.collectionDebt > 0.0 && MicrosecondsSince(frameStart) < m_budget)
+        {
+            cycleCompleted = lua_gc(state, LUA_GCSTEP, stepKilobytes) != 0;
+            entry.collectionDebt -= stepKilobytes * 1024.0;
+            m_frameStats.steps += 1;
+        }
+
+        // Garbage allocated before cycle ended has been collected.
+        if(cycleCompleted)
+        {
+            entry.collectionDebt = 0.0;
+            m_frameStats.completedCycles += 1;
+        }
+    }
+
+    m_nextState = (m_nextState + 1) % m_states.size();
+
+    // Update collection statistics.
+    m_frameStats.microseconds = MicrosecondsSince(frameStart);
+
+    m_stats.frames += 1;
+    m_stats.steps += m_frameStats.steps;
+    m_stats.completedCycles += m_frameStats.completedCycles;
+    m_stats.framesOverBudget += m_frameStats.microseconds > m_budget ? 1 : 0;
+    m_stats.totalMicroseconds += m_frameStats.microseconds;
+    m_stats.peakFrameMicroseconds = std::max(m_stats.peakFrameMicroseconds, m_frameStats.microseconds);
+}
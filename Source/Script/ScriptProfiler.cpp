@@ -0,0 +1,431 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Script/Precompiled.hpp"
+#include "Script/ScriptProfiler.hpp"
+using namespace Script;
+
+namespace
+{
+    ScriptProfiler*& GetStateProfiler(lua_State* state)
+    {
+        // Extra space of main thread is copied to each coroutine when it is created.
+        static_assert(LUA_EXTRASPACE >= sizeof(ScriptProfiler*), "Not enough extra space in Lua state!");
+        return *static_cast<ScriptProfiler**>(lua_getextraspace(state));
+    }
+
+    bool FindGlobalName(lua_State* state, lua_Debug& debug, std::string& name)
+    {
+        // Functions called from native code have no name, so look them up in global table.
+        if(lua_getinfo(state, "f", &debug) == 0)
+            return false;
+
+        bool found = false;
+        lua_pushglobaltable(state);
+        lua_pushnil(state);
+
+        while(lua_next(state, -2) != 0)
+        {
+            if(lua_type(state, -2) == LUA_TSTRING && lua_rawequal(state, -1, -4))
+            {
+                name = lua_tostring(state, -2);
+                found = true;
+                lua_pop(state, 2);
+                break;
+            }
+
+            lua_pop(state, 1);
+        }
+
+        lua_pop(state, 2);
+        return found;
+    }
+
+    std::string FormatFrame(const ScriptProfiler::FunctionStats& function)
+    {
+        std::string frame = fmt::format("{} ({}:{})", function.name, function.source, function.lineDefined);
+        std::replace(frame.begin(), frame.end(), ';', ':');
+        return frame;
+    }
+
+    extern "C"
+    {
+        // Resumes coroutine from first argument with remaining arguments, same as coroutine.resume.
+        static int LuaResume(lua_State* L)
+        {
+            lua_State* thread = lua_tothread(L, 1);
+            luaL_argcheck(L, thread != nullptr, 1, "coroutine expected");
+
+            const int resultCount = GetStateProfiler(L)->Resume(L, thread, lua_gettop(L) - 1);
+            if(resultCount < 0)
+            {
+                lua_pushboolean(L, 0);
+                lua_insert(L, -2);
+                return 2;
+            }
+
+            lua_pushboolean(L, 1);
+            lua_insert(L, -(resultCount + 1));
+            return resultCount + 1;
+        }
+
+        // Resumes coroutine from upvalue with arguments, same as function returned by coroutine.wrap.
+        static int LuaWrapCall(lua_State* L)
+        {
+            lua_State* thread = lua_tothread(L, lua_upvalueindex(1));
+
+            const int resultCount = GetStateProfiler(L)->Resume(L, thread, lua_gettop(L));
+            if(resultCount < 0)
+            {
+                if(lua_type(L, -1) == LUA_TSTRING)
+                {
+                    luaL_where(L, 1);
+                    lua_insert(L, -2);
+                    lua_concat(L, 2);
+                }
+
+                return lua_error(L);
+            }
+
+            return resultCount;
+        }
+
+        // Creates coroutine from function in first argument and returns function that resumes it.
+        static int LuaWrap(lua_State* L)
+        {
+            luaL_checktype(L, 1, LUA_TFUNCTION);
+            lua_State* thread = lua_newthread(L);
+            lua_pushvalue(L, 1);
+            lua_xmove(L, thread, 1);
+            lua_pushcclosure(L, LuaWrapCall, 1);
+            return 1;
+        }
+    }
+}
+
+ScriptProfiler::ScriptProfiler(lua_State* state) :
+    m_state(state)
+{
+    ASSERT(m_state != nullptr, "Lua state is null!");
+    GetStateProfiler(m_state) = this;
+}
+
+ScriptProfiler::~ScriptProfiler()
+{
+    Stop();
+}
+
+void ScriptProfiler::TrackCoroutines()
+{
+    // Replace functions that resume coroutines in loaded coroutine library.
+    if(lua_getglobal(m_state, LUA_COLIBNAME) == LUA_TTABLE)
+    {
+        lua_pushcfunction(m_state, LuaResume);
+        lua_setfield(m_state, -2, "resume");
+        lua_pushcfunction(m_state, LuaWrap);
+        lua_setfield(m_state, -2, "wrap");
+    }
+
+    lua_pop(m_state, 1);
+}
+
+int ScriptProfiler::Resume(lua_State* state, lua_State* thread, int argumentCount)
+{
+    /*
+        Hooks are set for each thread separately. Count hook is installed on coroutines when they
+        are resumed, unless they already have it from being created while it was installed, and
+        hook left from previous run is removed. Sampler thread arms one shot hook of coroutine
+        that is currently running, so it is tracked for duration of resume.
+    */
+
+    if(m_running && !m_oneShotHook)
+    {
+        if(lua_gethook(thread) != &ScriptProfiler::Hook || lua_gethookcount(thread) != m_instructionInterval)
+        {
+            lua_sethook(thread, &ScriptProfiler::Hook, LUA_MASKCOUNT, m_instructionInterval);
+        }
+    }
+    else if(!m_running && lua_gethook(thread) != nullptr)
+    {
+        lua_sethook(thread, nullptr, 0, 0);
+    }
+
+    // Move arguments to coroutine and results back, same as coroutine library does.
+    if(!lua_checkstack(thread, argumentCount))
+    {
+        lua_pushliteral(state, "too many arguments to resume");
+        return -1;
+    }
+
+    if(lua_status(thread) == LUA_OK && lua_gettop(thread) == 0)
+    {
+        lua_pushliteral(state, "cannot resume dead coroutine");
+        return -1;
+    }
+
+    lua_xmove(state, thread, argumentCount);
+
+    const bool tracking = m_running && m_oneShotHook;
+    lua_State* previousThread = nullptr;
+
+    if(tracking)
+    {
+        std::lock_guard<std::mutex> lock(m_samplerMutex);
+        previousThread = m_runningThread;
+        m_runningThread = thread;
+    }
+
+#if LUA_VERSION_NUM >= 504
+    int resultCount = 0;
+    const int status = lua_resume(thread, state, argumentCount, &resultCount);
+#else
+    const int status = lua_resume(thread, state, argumentCount);
+#endif
+
+    if(tracking)
+    {
+        std::lock_guard<std::mutex> lock(m_samplerMutex);
+        m_runningThread = previousThread;
+    }
+
+    if(status == LUA_OK || status == LUA_YIELD)
+    {
+#if LUA_VERSION_NUM < 504
+        const int resultCount = lua_gettop(thread);
+#endif
+        if(!lua_checkstack(state, resultCount + 1))
+        {
+            lua_pop(thread, resultCount);
+            lua_pushliteral(state, "too many results to resume");
+            return -1;
+        }
+
+        lua_xmove(thread, state, resultCount);
+        return resultCount;
+    }
+
+    lua_xmove(thread, state, 1);
+    return -1;
+}
+
+void ScriptProfiler::Start(const StartParams& params)
+{
+    Stop();
+
+    m_running = true;
+    m_oneShotHook = params.instructionInterval <= 0;
+    m_instructionInterval = params.instructionInterval;
+
+    if(m_oneShotHook)
+    {
+        ASSERT(params.samplePeriod > 0.0, "Invalid sample period!");
+
+        m_samplerExit = false;
+        m_samplerThread = std::thread(&ScriptProfiler::RunSampler, this,
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(params.samplePeriod)));
+    }
+    else
+    {
+        lua_sethook(m_state, &ScriptProfiler::Hook, LUA_MASKCOUNT, params.instructionInterval);
+    }
+}
+
+void ScriptProfiler::Stop()
+{
+    if(m_samplerThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_samplerMutex);
+            m_samplerExit = true;
+        }
+
+        m_samplerCondition.notify_one();
+        m_samplerThread.join();
+    }
+
+    if(m_running)
+    {
+        lua_sethook(m_state, nullptr, 0, 0);
+        m_runningThread = nullptr;
+        m_running = false;
+    }
+}
+
+void ScriptProfiler::Clear()
+{
+    m_functions.clear();
+    m_frameLookup.clear();
+    m_lines.clear();
+    m_stacks.clear();
+    m_sampleCount = 0;
+}
+
+void ScriptProfiler::Hook(lua_State* state, lua_Debug* debug)
+{
+    // Hooks left on coroutines after profiler was stopped remove themselves.
+    ScriptProfiler* profiler = GetStateProfiler(state);
+    if(profiler == nullptr || !profiler->m_running)
+    {
+        lua_sethook(state, nullptr, 0, 0);
+        return;
+    }
+
+    // Remove one shot hook until sampler thread installs it again.
+    if(profiler->m_oneShotHook)
+    {
+        lua_sethook(state, nullptr, 0, 0);
+    }
+
+    profiler->Sample(state);
+}
+
+void ScriptProfiler::RunSampler(std::chrono::steady_clock::duration samplePeriod)
+{
+    std::unique_lock<std::mutex> lock(m_samplerMutex);
+    while(!m_samplerCondition.wait_for(lock, samplePeriod, [this]() { return m_samplerExit; }))
+    {
+        // Running coroutine stays alive while it is tracked, as its resume holds mutex to stop tracking.
+        lua_State* thread = m_runningThread != nullptr ? m_runningThread : m_state;
+        lua_sethook(thread, &ScriptProfiler::Hook, LUA_MASKCOUNT, 1);
+    }
+}
+
+void ScriptProfiler::Sample(lua_State* state)
+{
+    // Capture call stack from currently running function.
+    lua_Debug frame;
+    int currentLine = 0;
+    m_stack.clear();
+
+    for(int level = 0; lua_getstack(state, level, &frame) != 0; ++level)
+    {
+        if(lua_getinfo(state, level == 0 ? "Snl" : "Sn", &frame) == 0)
+            break;
+
+        if(level == 0)
+        {
+            currentLine = frame.currentline;
+        }
+
+        m_stack.push_back(ResolveFrame(state, frame));
+    }
+
+    if(m_stack.empty())
+        return;
+
+    // Count sample once for each function on stack, even if it recurses.
+    ++m_sampleCount;
+    ++m_functions[m_stack.front()].selfSamples;
+
+    for(std::size_t i = 0; i < m_stack.size(); ++i)
+    {
+        if(std::find(m_stack.begin(), m_stack.begin() + i, m_stack[i]) == m_stack.begin() + i)
+        {
+            ++m_functions[m_stack[i]].totalSamples;
+        }
+    }
+
+    if(currentLine > 0)
+    {
+        const uint64_t lineKey = (static_cast<uint64_t>(m_stack.front()) << 32) | static_cast<uint32_t>(currentLine);
+        ++m_lines[lineKey];
+    }
+
+    // Stacks are stored from outermost function for folded export.
+    std::reverse(m_stack.begin(), m_stack.end());
+    ++m_stacks[m_stack];
+}
+
+ScriptProfiler::FrameIndex ScriptProfiler::ResolveFrame(lua_State* state, lua_Debug& debug)
+{
+    // Native functions share source, so they are told apart by their names instead.
+    const bool native = std::strcmp(debug.what, "C") == 0;
+    const char* name = debug.name != nullptr ? debug.name : "?";
+
+    m_frameKey.assign(debug.short_src);
+    m_frameKey.push_back(':');
+    m_frameKey.append(native ? name : std::to_string(debug.linedefined));
+
+    auto it = m_frameLookup.find(m_frameKey);
+    if(it != m_frameLookup.end())
+        return it->second;
+
+    FunctionStats function;
+    function.source = debug.short_src;
+    function.lineDefined = debug.linedefined;
+
+    if(debug.name != nullptr)
+    {
+        function.name = debug.name;
+    }
+    else if(std::strcmp(debug.what, "main") == 0)
+    {
+        function.name = "main chunk";
+    }
+    else if(native || !FindGlobalName(state, debug, function.name))
+    {
+        function.name = native ? "[C]" : "anonymous";
+    }
+
+    const FrameIndex frameIndex = static_cast<FrameIndex>(m_functions.size());
+    m_functions.push_back(std::move(function));
+    m_frameLookup.emplace(m_frameKey, frameIndex);
+    return frameIndex;
+}
+
+ScriptProfiler::Report ScriptProfiler::CreateReport() const
+{
+    Report report;
+    report.samples = m_sampleCount;
+    report.functions = m_functions;
+
+    for(const auto& [lineKey, samples] : m_lines)
+    {
+        LineStats lineStats;
+        lineStats.function = static_cast<std::size_t>(lineKey >> 32);
+        lineStats.line = static_cast<int>(lineKey & 0xFFFFFFFF);
+        lineStats.samples = samples;
+        report.lines.push_back(lineStats);
+    }
+
+    // Lines keep referring to functions by index, so only lines are sorted.
+    std::sort(report.lines.begin(), report.lines.end(),
+        [](const LineStats& a, const LineStats& b)
+        {
+            return a.samples > b.samples;
+        });
+
+    return report;
+}
+
+std::string ScriptProfiler::ExportFoldedStacks() const
+{
+    std::vector<std::string> frames;
+    frames.reserve(m_functions.size());
+
+    for(const FunctionStats& function : m_functions)
+    {
+        frames.push_back(FormatFrame(function));
+    }
+
+    std::string output;
+    for(const auto& [stack, samples] : m_stacks)
+    {
+        for(std::size_t i = 0; i < stack.size(); ++i)
+        {
+            if(i != 0)
+            {
+                output.push_back(';');
+            }
+
+            output.append(frames[stack[i]]);
+        }
+
+        output.append(fmt::format(" {}\n", samples));
+    }
+
+    return output;
+}
@@ -5,6 +5,9 @@
 
 #include "Script/Precompiled.hpp"
 #include "Script/ScriptState.hpp"
+#include "Script/ScriptCache.hpp"
+#include "Script/ScriptGarbageCollector.hpp"
+#include "Script/ScriptBindings.hpp"
 #include <Core/SystemStorage.hpp>
 #include <System/FileSystem/FileHandle.hpp>
 using namespace Script;
@@ -25,12 +28,33 @@ namespace
 
             return 0;
         }
+
+        // Logs unprotected error before Lua aborts.
+        static int LuaPanic(lua_State* L)
+        {
+            ASSERT(L != nullptr, "Lua state is null!");
+
+            LOG_FATAL("Unprotected error in Lua state: {}",
+                lua_isstring(L, -1) ? lua_tostring(L, -1) : "Unknown error");
+
+            return 0;
+        }
     }
 }
 
 ScriptState::ScriptState() = default;
 ScriptState::~ScriptState()
 {
+    if(m_garbageCollector)
+    {
+        m_garbageCollector->Unregister(this);
+    }
+
+    if(m_profiler)
+    {
+        m_profiler->Stop();
+    }
+
     if(m_state)
     {
         lua_close(m_state);
@@ -38,14 +62,21 @@ ScriptState::~ScriptState()
 }
 
 ScriptState::CreateResult ScriptState::Create()
+{
+    return Create(CreateFromParams());
+}
+
+ScriptState::CreateResult ScriptState::Create(const CreateFromParams& params)
 {
     LOG_PROFILE_SCOPE("Create script state");
 
     // Create instance.
     auto instance = std::unique_ptr<ScriptState>(new ScriptState());
 
-    // Create Lua state.
-    instance->m_state = luaL_newstate();
+    // Create Lua state with its own allocator.
+    instance->m_allocator = std::make_unique<ScriptAllocator>(
+        params.memoryLimit, params.pooledAllocator);
+    instance->m_state = lua_newstate(ScriptAllocator::Allocate, instance->m_allocator.get());
 
     if(instance->m_state == nullptr)
     {
@@ -53,6 +84,11 @@ ScriptState::CreateResult ScriptState::Create()
         return Common::Failure(CreateErrors::FailedLuaStateCreation);
     }
 
+    lua_atpanic(instance->m_state, LuaPanic);
+
+    // Create profiler that can be started at runtime.
+    instance->m_profiler = std::make_unique<ScriptProfiler>(instance->m_state);
+
     // Load base library.
     lua_pushcfunction(instance->m_state, luaopen_base);
     lua_pushstring(instance->m_state, "");
@@ -64,10 +100,47 @@ ScriptState::CreateResult ScriptState::Create()
         return Common::Failure(CreateErrors::FailedLuaLibraryLoading);
     }
 
+    // Load coroutine library, with coroutines tracked by profiler.
+    if(params.coroutineLibrary)
+    {
+        luaL_requiref(instance->m_state, LUA_COLIBNAME, luaopen_coroutine, 1);
+        lua_pop(instance->m_state, 1);
+        instance->m_profiler->TrackCoroutines();
+    }
+
     // Register logging function.
     lua_pushcfunction(instance->m_state, LuaLog);
     lua_setglobal(instance->m_state, "Log");
 
+    // Register bindings for reflected types.
+    if(params.scriptBindings)
+    {
+        params.scriptBindings->Bind(instance->m_state);
+    }
+
+    // Capture copy of initialized global table that state is restored to on reset.
+    lua_newtable(instance->m_state);
+    lua_pushglobaltable(instance->m_state);
+    lua_pushnil(instance->m_state);
+
+    while(lua_next(instance->m_state, -2) != 0)
+    {
+        lua_pushvalue(instance->m_state, -2);
+        lua_insert(instance->m_state, -2);
+        lua_rawset(instance->m_state, -5);
+    }
+
+    lua_pop(instance->m_state, 1);
+    instance->m_pristineGlobals = luaL_ref(instance->m_state, LUA_REGISTRYINDEX);
+    instance->m_scriptCache = params.scriptCache;
+
+    // Register long lived state for scheduled garbage collection.
+    if(params.garbageCollector)
+    {
+        instance->m_garbageCollector = params.garbageCollector;
+        instance->m_garbageCollector->Register(instance.get());
+    }
+
     // Make sure that we did not leave anything on the stack.
     ASSERT(lua_gettop(instance->m_state) == 0, "Lua stack is not empty!");
 
@@ -87,7 +160,10 @@ ScriptState::CreateResult ScriptState::Create(System::FileHandle& file, const Lo
         Common::Failure(CreateErrors::InvalidArgument));
 
     // Call base create method to retrieve new instance.
-    auto createResult = Create();
+    CreateFromParams createParams;
+    createParams.scriptCache = params.engineSystems->Locate<ScriptCache>();
+
+    auto createResult = Create(createParams);
     if(!createResult)
     {
         return createResult;
@@ -97,8 +173,9 @@ ScriptState::CreateResult ScriptState::Create(System::FileHandle& file, const Lo
 
     // Execute script file.
     std::string scriptCode = file.ReadAsTextString();
+    std::string chunkName = "@" + file.GetPath().generic_string();
 
-    if(!instance->Execute(scriptCode))
+    if(!instance->Execute(scriptCode, chunkName.c_str()))
     {
         LOG_ERROR("Could not execute script file!");
         instance->PrintError();
@@ -108,9 +185,21 @@ ScriptState::CreateResult ScriptState::Create(System::FileHandle& file, const Lo
     return Common::Success(std::move(instance));
 }
 
-bool ScriptState::Execute(std::string script)
+bool ScriptState::Execute(std::string_view script, const char* chunkName)
 {
-    if(luaL_dostring(m_state, script.c_str()) != 0)
+    // Load script chunk from cached bytecode or compile it from source.
+    bool chunkLoaded = false;
+
+    if(m_scriptCache != nullptr)
+    {
+        chunkLoaded = m_scriptCache->LoadChunk(m_state, script, chunkName);
+    }
+    else
+    {
+        chunkLoaded = luaL_loadbufferx(m_state, script.data(), script.size(), chunkName, "t") == 0;
+    }
+
+    if(!chunkLoaded || lua_pcall(m_state, 0, LUA_MULTRET, 0) != 0)
     {
         LOG_ERROR("Could not execute script!");
         PrintError();
@@ -120,6 +209,51 @@ bool ScriptState::Execute(std::string script)
     return true;
 }
 
+void ScriptState::Reset()
+{
+    /*
+        Restore global table to its initialized state, removing globals that were added since and
+        restoring ones that were replaced. Changes made to contents of tables referenced by pristine
+        globals are not reverted. Collect garbage afterwards, so state does not hold on to memory
+        that was used by previous script.
+    */
+
+    lua_settop(m_state, 0);
+    lua_pushglobaltable(m_state);
+    lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_pristineGlobals);
+
+    // Clearing existing fields is allowed during traversal.
+    lua_pushnil(m_state);
+    while(lua_next(m_state, 1) != 0)
+    {
+        lua_pop(m_state, 1);
+        lua_pushvalue(m_state, -1);
+
+        if(lua_rawget(m_state, 2) == LUA_TNIL)
+        {
+            lua_pushvalue(m_state, -2);
+            lua_pushnil(m_state);
+            lua_rawset(m_state, 1);
+        }
+
+        lua_pop(m_state, 1);
+    }
+
+    lua_pushnil(m_state);
+    while(lua_next(m_state, 2) != 0)
+    {
+        lua_pushvalue(m_state, -2);
+        lua_insert(m_state, -2);
+        lua_rawset(m_state, 1);
+    }
+
+    lua_pushnil(m_state);
+    lua_setmetatable(m_state, 1);
+    lua_settop(m_state, 0);
+
+    lua_gc(m_state, LUA_GCCOLLECT, 0);
+}
+
 void ScriptState::PrintError()
 {
     // Make sure that there is a string on top of the stack.
@@ -0,0 +1,132 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "Script/Precompiled.hpp"
+#include "Script/ScriptStatePool.hpp"
+#include "Script/ScriptState.hpp"
+#include "Script/ScriptCache.hpp"
+#include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
+using namespace Script;
+
+namespace
+{
+    const char* LogAttachFailed = "Failed to attach script state pool! {}";
+}
+
+void ScriptStatePool::StateDeleter::operator()(ScriptState* state) const
+{
+    // States acquired without pool are simply destroyed.
+    if(pool != nullptr)
+    {
+        pool->Release(state);
+    }
+    else
+    {
+        delete state;
+    }
+}
+
+ScriptStatePool::StatePtr ScriptStatePool::AcquireFrom(ScriptStatePool* pool)
+{
+    if(pool != nullptr)
+        return pool->Acquire();
+
+    return StatePtr(ScriptState::Create().UnwrapOr(nullptr).release());
+}
+
+ScriptStatePool::ScriptStatePool() = default;
+ScriptStatePool::~ScriptStatePool() = default;
+
+bool ScriptStatePool::OnAttach(const Core::EngineSystemStorage& engineSystems)
+{
+    // Locate needed engine systems.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(configSystem == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate config system.");
+        return false;
+    }
+
+    m_scriptCache = engineSystems.Locate<ScriptCache>();
+    if(m_scriptCache == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate script cache.");
+        return false;
+    }
+
+    // Read pool configuration.
+    m_maxPooledStates = configSystem->Get<std::size_t>(
+        NAME_CONSTEXPR("script.statePoolSize")).UnwrapOr(m_maxPooledStates);
+    m_stateMemoryLimit = configSystem->Get<std::size_t>(
+        NAME_CONSTEXPR("script.stateMemoryLimit")).UnwrapOr(m_stateMemoryLimit);
+
+    return true;
+}
+
+ScriptStatePool::StatePtr ScriptStatePool::Acquire()
+{
+    // Take most recently released state, which was already reset.
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stats.acquiredStates += 1;
+
+        if(!m_states.empty())
+        {
+            StatePtr state(m_states.back().release(), StateDeleter{ this });
+            m_states.pop_back();
+
+            m_stats.reusedStates += 1;
+            m_stats.pooledStates = m_states.size();
+            return state;
+        }
+    }
+
+    // Create new state outside of lock, as it can take a while.
+    ScriptState::CreateFromParams createParams;
+    createParams.scriptCache = m_scriptCache;
+    createParams.memoryLimit = m_stateMemoryLimit;
+
+    auto createResult = ScriptState::Create(createParams);
+    if(!createResult)
+    {
+        LOG_ERROR("Could not create pooled script state!");
+        return StatePtr(nullptr, StateDeleter{ this });
+    }
+
+    return StatePtr(createResult.Unwrap().release(), StateDeleter{ this });
+}
+
+void ScriptStatePool::Release(ScriptState* state)
+{
+    if(state == nullptr)
+        return;
+
+    std::unique_ptr<ScriptState> releasedState(state);
+    releasedState->Reset();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_states.size() >= m_maxPooledStates)
+    {
+        m_stats.discardedStates += 1;
+        return;
+    }
+
+    m_states.push_back(std::move(releasedState));
+    m_stats.pooledStates = m_states.size();
+}
+
+void ScriptStatePool::Clear()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_states.clear();
+    m_stats.pooledStates = 0;
+}
+
+ScriptStatePool::Stats ScriptStatePool::GetStats() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -7,6 +7,8 @@
 #include "System/FileSystem/FileSystem.hpp"
 #include "System/FileSystem/NativeFileDepot.hpp"
 #include <Build/Build.hpp>
+#include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
 using namespace System;
 
 namespace
@@ -19,6 +21,14 @@ FileSystem::~FileSystem() = default;
 
 bool FileSystem::OnAttach(const Core::EngineSystemStorage& engineSystems)
 {
+    // Locate needed engine systems.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(configSystem == nullptr)
+    {
+        LOG_ERROR(AttachError, "Could not locate config system.");
+        return false;
+    }
+
     // Mount native working directory.
     LOG("Current working directory: {}", fs::current_path().generic_string());
 
@@ -72,6 +82,29 @@ bool FileSystem::OnAttach(const Core::EngineSystemStorage& engineSystems)
         }
     }
 
+    // Mount cooked asset directory last, so cooked files take precedence over their sources.
+    const fs::path cookedDirectory = configSystem->Get<std::string>(
+        NAME_CONSTEXPR("engine.cookedDirectory")).UnwrapOr("");
+
+    if(!cookedDirectory.empty())
+    {
+        if(auto cookedDirectoryDepot = NativeFileDepot::Create(cookedDirectory))
+        {
+            if(!MountDepot("./", cookedDirectoryDepot.Unwrap()))
+            {
+                LOG_ERROR(AttachError, "Could not mount cooked asset directory.");
+                return false;
+            }
+
+            m_cookedDirectoryMounted = true;
+        }
+        else
+        {
+            LOG_WARNING("Cooked asset directory \"{}\" could not be mounted, loading source assets instead.",
+                cookedDirectory.generic_string());
+        }
+    }
+
     return true;
 }
 
@@ -2,3 +2,117 @@
     Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
     Software distributed under the permissive MIT License.
 */
+
+#include "System/Precompiled.hpp"
+#include "System/FileSystem/MemoryFileHandle.hpp"
+using namespace System;
+
+MemoryFileHandle::MemoryFileHandle(const fs::path& path, OpenFlags::Type flags)
+    : FileHandle(path, flags)
+{
+}
+
+MemoryFileHandle::~MemoryFileHandle() = default;
+
+std::unique_ptr<MemoryFileHandle> MemoryFileHandle::Create(const fs::path& path,
+    Data data, OpenFlags::Type openFlags)
+{
+    // Create class instance.
+    auto instance = std::unique_ptr<MemoryFileHandle>(new MemoryFileHandle(path, openFlags));
+
+    if(openFlags & OpenFlags::Truncate)
+    {
+        data.clear();
+    }
+
+    instance->m_data = std::move(data);
+
+    if(openFlags & OpenFlags::Append)
+    {
+        instance->m_position = instance->m_data.size();
+    }
+
+    return instance;
+}
+
+uint64_t MemoryFileHandle::Tell()
+{
+    return m_position;
+}
+
+uint64_t MemoryFileHandle::Seek(uint64_t offset, SeekMode mode)
+{
+    // Offset is applied as signed value relative to current position and end of file.
+    switch(mode)
+    {
+    case FileHandle::SeekMode::Begin:
+        m_position = offset;
+        break;
+
+    case FileHandle::SeekMode::Current:
+        m_position += offset;
+        break;
+
+    case FileHandle::SeekMode::End:
+        m_position = m_data.size() + offset;
+        break;
+
+    default:
+        ASSERT(false, "Unknown seek mode!");
+        break;
+    }
+
+    m_position = std::min<uint64_t>(m_position, m_data.size());
+    return m_position;
+}
+
+uint64_t MemoryFileHandle::Read(uint8_t* data, uint64_t bytes)
+{
+    if(!(GetFlags() & OpenFlags::Read))
+        return 0;
+
+    const uint64_t readBytes = std::min<uint64_t>(bytes, m_data.size() - m_position);
+    if(readBytes != 0)
+    {
+        std::memcpy(data, m_data.data() + m_position, readBytes);
+        m_position += readBytes;
+    }
+
+    return readBytes;
+}
+
+uint64_t MemoryFileHandle::Write(const uint8_t* data, uint64_t bytes)
+{
+    if(!(GetFlags() & OpenFlags::Write))
+        return 0;
+
+    if(GetFlags() & OpenFlags::Append)
+    {
+        m_position = m_data.size();
+    }
+
+    if(m_position + bytes > m_data.size())
+    {
+        m_data.resize(m_position + bytes);
+    }
+
+    std::memcpy(m_data.data() + m_position, data, bytes);
+    m_position += bytes;
+    return bytes;
+}
+
+bool MemoryFileHandle::IsGood() const
+{
+    return m_position <= m_data.size();
+}
+
+uint64_t MemoryFileHandle::GetSize() const
+{
+    return m_data.size();
+}
+
+MemoryFileHandle::Data MemoryFileHandle::ReleaseData()
+{
+    m_position = 0;
+    return std::move(m_data);
+}
@@ -24,6 +24,22 @@ Image::CreateResult Image::Create(FileHandle& file, const LoadFromFile& params)
     // Create class instance.
     auto instance = std::unique_ptr<Image>(new Image());
 
+    if(params.storage != nullptr)
+    {
+        instance->m_data = std::move(*params.storage);
+        instance->m_data.clear();
+    }
+
+    // Give storage back to caller, so its memory is not lost with failed instance.
+    auto ReturnStorage = [&instance, &params]()
+    {
+        if(params.storage != nullptr)
+        {
+            *params.storage = std::move(instance->m_data);
+            params.storage->clear();
+        }
+    };
+
     // Load image data from format.
     fs::path extension = file.GetPath().extension();
     if(extension == ".png")
@@ -32,6 +48,7 @@ Image::CreateResult Image::Create(FileHandle& file, const LoadFromFile& params)
         {
             LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
                 "Could not load PNG image data.");
+            ReturnStorage();
             return Common::Failure(failureResult.Unwrap());
         }
     }
@@ -39,12 +56,133 @@ Image::CreateResult Image::Create(FileHandle& file, const LoadFromFile& params)
     {
         LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
              "Unknown image file format.");
+        ReturnStorage();
         return Common::Failure(CreateErrors::UnknownExtension);
     }
 
     return Common::Success(std::move(instance));
 }
 
+Image::InfoResult Image::ReadInfo(FileHandle& file)
+{
+    // Read description from file header and restore file position.
+    const uint64_t position = file.Tell();
+    SCOPE_GUARD([&file, position]
+    {
+        file.Seek(position, FileHandle::SeekMode::Begin);
+    });
+
+    fs::path extension = file.GetPath().extension();
+    if(extension == ".png")
+    {
+        return ReadInfoPNG(file);
+    }
+
+    LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+        "Unknown image file format.");
+    return Common::Failure(CreateErrors::UnknownExtension);
+}
+
+Image::Data Image::ReleaseData()
+{
+    m_width = 0;
+    m_height = 0;
+    m_channels = 0;
+    return std::move(m_data);
+}
+
+Image::InfoResult Image::ReadInfoPNG(FileHandle& file)
+{
+    // Parse chunks directly, as libpng would need to be set up for reading whole file.
+    const size_t png_sig_size = 8;
+    png_byte png_sig[png_sig_size];
+
+    if(file.Read(png_sig, png_sig_size) != png_sig_size ||
+        png_sig_cmp(png_sig, 0, png_sig_size) != 0)
+    {
+        LOG_ERROR("File path does not contain valid PNG file!");
+        return Common::Failure(CreateErrors::FailedPngLoad);
+    }
+
+    auto ReadChunkHeader = [&file](uint32_t& length, png_byte (&type)[4])
+    {
+        png_byte header[8];
+        if(file.Read(header, sizeof(header)) != sizeof(header))
+            return false;
+
+        length = png_get_uint_32(header);
+        std::memcpy(type, header + 4, sizeof(type));
+        return true;
+    };
+
+    uint32_t length = 0;
+    png_byte type[4];
+    png_byte header[13];
+
+    if(!ReadChunkHeader(length, type) || std::memcmp(type, "IHDR", 4) != 0 ||
+        length != sizeof(header) || file.Read(header, sizeof(header)) != sizeof(header))
+    {
+        LOG_ERROR("Could not read PNG image header!");
+        return Common::Failure(CreateErrors::FailedPngLoad);
+    }
+
+    Info info;
+    info.width = static_cast<int>(png_get_uint_32(header));
+    info.height = static_cast<int>(png_get_uint_32(header + 4));
+
+    // Channels match what LoadPNG() expands image data to.
+    const png_byte format = header[9];
+    switch(format)
+    {
+    case PNG_COLOR_TYPE_GRAY:
+        info.channels = 1;
+        break;
+
+    case PNG_COLOR_TYPE_GRAY_ALPHA:
+        info.channels = 2;
+        break;
+
+    case PNG_COLOR_TYPE_RGB:
+        info.channels = 3;
+        break;
+
+    case PNG_COLOR_TYPE_RGBA:
+        info.channels = 4;
+        break;
+
+    case PNG_COLOR_TYPE_PALETTE:
+    {
+        // Palette is expanded with alpha if transparency chunk precedes image data.
+        info.channels = 3;
+        file.Seek(4, FileHandle::SeekMode::Current);
+
+        while(ReadChunkHeader(length, type) && std::memcmp(type, "IDAT", 4) != 0)
+        {
+            if(std::memcmp(type, "tRNS", 4) == 0)
+            {
+                info.channels = 4;
+                break;
+            }
+
+            file.Seek(static_cast<uint64_t>(length) + 4, FileHandle::SeekMode::Current);
+        }
+    }
+    break;
+
+    default:
+        LOG_ERROR("Unsupported image format!");
+        return Common::Failure(CreateErrors::FailedPngLoad);
+    }
+
+    if(info.width <= 0 || info.height <= 0)
+    {
+        LOG_ERROR("Invalid PNG image size!");
+        return Common::Failure(CreateErrors::FailedPngLoad);
+    }
+
+    return Common::Success(info);
+}
+
 Common::FailureResult<Image::CreateErrors> Image::LoadPNG(FileHandle& file)
 {
     LOG_PROFILE_SCOPE("Load PNG image data from \"{}\" file", file.GetPath().generic_string());
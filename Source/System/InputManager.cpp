@@ -56,6 +56,10 @@ bool InputManager::OnAttach(const Core::EngineSystemStorage& engineSystems)
 
     m_windowContext->inputManager = this;
 
+    // Headless window has no input events and input state remains at rest.
+    if(window->IsHeadless())
+        return true;
+
     // Set window input callbacks.
     GLFWwindow* windowHandle = m_windowContext->handle;
     glfwSetKeyCallback(windowHandle, InputManager::KeyboardKeyCallback);
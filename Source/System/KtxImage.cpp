@@ -0,0 +1,369 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "System/Precompiled.hpp"
+#include "System/KtxImage.hpp"
+#include "System/FileSystem/FileHandle.hpp"
+using namespace System;
+
+namespace
+{
+    const char* LogLoadFromFileFailed = "Failed to load KTX image from \"{}\" file! {}";
+
+    const uint8_t Identifier[12] =
+    {
+        0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'
+    };
+
+    const std::size_t HeaderSize = 80;
+    const std::size_t LevelIndexEntrySize = 24;
+    const char* OrientationKey = "KTXorientation";
+    const char* OrientationValue = "ru";
+
+    uint32_t ReadUint32(const uint8_t* data)
+    {
+        return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    uint64_t ReadUint64(const uint8_t* data)
+    {
+        return ReadUint32(data) | (static_cast<uint64_t>(ReadUint32(data + 4)) << 32);
+    }
+
+    void WriteUint32(KtxImage::Data& data, uint32_t value)
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            data.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    void WriteUint64(KtxImage::Data& data, uint64_t value)
+    {
+        WriteUint32(data, static_cast<uint32_t>(value));
+        WriteUint32(data, static_cast<uint32_t>(value >> 32));
+    }
+
+    std::size_t AlignOffset(std::size_t offset, std::size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    std::size_t GetLevelAlignment(PixelFormat format)
+    {
+        // Least common multiple of block size and four bytes.
+        const std::size_t blockBytes = GetPixelFormatInfo(format).blockBytes;
+        return blockBytes % 4 == 0 ? blockBytes : blockBytes % 2 == 0 ? blockBytes * 2 : blockBytes * 4;
+    }
+
+    int CalculateLevelDimension(int size, int level)
+    {
+        return std::max(1, size >> level);
+    }
+}
+
+KtxImage::KtxImage() = default;
+KtxImage::~KtxImage() = default;
+
+KtxImage::CreateResult KtxImage::Create(const CreateFromParams& params)
+{
+    // Validate arguments.
+    CHECK_ARGUMENT_OR_RETURN(GetPixelFormatInfo(params.format).blockSize != 0,
+        Common::Failure(CreateErrors::InvalidArgument));
+    CHECK_ARGUMENT_OR_RETURN(params.width > 0 && params.height > 0,
+        Common::Failure(CreateErrors::InvalidArgument));
+    CHECK_ARGUMENT_OR_RETURN(!params.levels.empty(),
+        Common::Failure(CreateErrors::InvalidArgument));
+    CHECK_ARGUMENT_OR_RETURN(params.levels.size() <= 32,
+        Common::Failure(CreateErrors::InvalidArgument));
+
+    // Create instance with levels stored next to each other.
+    auto instance = std::unique_ptr<KtxImage>(new KtxImage());
+    instance->m_format = params.format;
+    instance->m_width = params.width;
+    instance->m_height = params.height;
+    instance->m_keyValues = params.keyValues;
+    instance->m_keyValues[OrientationKey] = OrientationValue;
+
+    for(std::size_t level = 0; level < params.levels.size(); ++level)
+    {
+        const Data& levelData = params.levels[level];
+        const std::size_t expectedSize = CalculateLevelSize(params.format,
+            CalculateLevelDimension(params.width, static_cast<int>(level)),
+            CalculateLevelDimension(params.height, static_cast<int>(level)));
+
+        if(levelData.size() != expectedSize)
+        {
+            LOG_ERROR("Invalid size of level {} data for KTX image!", level);
+            return Common::Failure(CreateErrors::InvalidLevelData);
+        }
+
+        Level& entry = instance->m_levels.emplace_back();
+        entry.offset = instance->m_data.size();
+        entry.size = levelData.size();
+        instance->m_data.insert(instance->m_data.end(), levelData.begin(), levelData.end());
+    }
+
+    return Common::Success(std::move(instance));
+}
+
+bool KtxImage::IsKtxFile(FileHandle& file)
+{
+    // Peek at file identifier and restore read position after.
+    const uint64_t position = file.Tell();
+    SCOPE_GUARD([&file, position]()
+    {
+        file.Seek(position);
+    });
+
+    uint8_t identifier[sizeof(Identifier)] = {};
+    file.Seek(0);
+    if(file.Read(identifier, sizeof(identifier)) != sizeof(identifier))
+        return false;
+
+    return std::memcmp(identifier, Identifier, sizeof(Identifier)) == 0;
+}
+
+KtxImage::CreateResult KtxImage::Create(FileHandle& file)
+{
+    LOG_PROFILE_SCOPE("Load KTX image from \"{}\" file", file.GetPath().generic_string());
+    LOG("Loading KTX image from \"{}\" file...", file.GetPath().generic_string());
+
+    // Read whole file at once, as levels are referenced in place.
+    auto instance = std::unique_ptr<KtxImage>(new KtxImage());
+    instance->m_data = file.ReadAsBinaryArray();
+
+    const Data& data = instance->m_data;
+    if(data.size() != file.GetSize())
+    {
+        LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+            "Could not read file data.");
+        return Common::Failure(CreateErrors::FailedFileRead);
+    }
+
+    if(data.size() < HeaderSize || std::memcmp(data.data(), Identifier, sizeof(Identifier)) != 0)
+    {
+        LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+            "File does not contain valid KTX2 header.");
+        return Common::Failure(CreateErrors::InvalidHeader);
+    }
+
+    // Read header fields.
+    const uint8_t* header = data.data() + sizeof(Identifier);
+    const uint32_t format = ReadUint32(header + 0);
+    const uint32_t width = ReadUint32(header + 8);
+    const uint32_t height = ReadUint32(header + 12);
+    const uint32_t depth = ReadUint32(header + 16);
+    const uint32_t layerCount = ReadUint32(header + 20);
+    const uint32_t faceCount = ReadUint32(header + 24);
+    const uint32_t levelCount = std::max(ReadUint32(header + 28), 1u);
+    const uint32_t supercompression = ReadUint32(header + 32);
+    const uint32_t keyValueOffset = ReadUint32(header + 44);
+    const uint32_t keyValueLength = ReadUint32(header + 48);
+
+    instance->m_format = static_cast<PixelFormat>(format);
+    if(GetPixelFormatInfo(instance->m_format).blockSize == 0)
+    {
+        LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+            fmt::format("Unsupported pixel format {}.", format));
+        return Common::Failure(CreateErrors::UnsupportedFormat);
+    }
+
+    if(width == 0 || height == 0 || width > 65536 || height > 65536 || levelCount > 32)
+    {
+        LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+            "Invalid image dimensions.");
+        return Common::Failure(CreateErrors::InvalidHeader);
+    }
+
+    if(depth != 0 || layerCount != 0 || faceCount != 1 || supercompression != 0)
+    {
+        LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+            "Only single uncompressed 2D image is supported.");
+        return Common::Failure(CreateErrors::UnsupportedFeature);
+    }
+
+    instance->m_width = static_cast<int>(width);
+    instance->m_height = static_cast<int>(height);
+
+    // Read key/value pairs.
+    if(static_cast<uint64_t>(keyValueOffset) + keyValueLength > data.size())
+    {
+        LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+            "Key/value data is out of bounds.");
+        return Common::Failure(CreateErrors::InvalidHeader);
+    }
+
+    std::size_t keyValuePosition = keyValueOffset;
+    const std::size_t keyValueEnd = static_cast<std::size_t>(keyValueOffset) + keyValueLength;
+
+    while(keyValuePosition + 4 <= keyValueEnd)
+    {
+        const std::size_t entryLength = ReadUint32(data.data() + keyValuePosition);
+        const std::size_t entryOffset = keyValuePosition + 4;
+
+        if(entryLength > keyValueEnd - entryOffset)
+        {
+            LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+                "Key/value entry is out of bounds.");
+            return Common::Failure(CreateErrors::InvalidHeader);
+        }
+
+        // Key is terminated with null character and value may end with one as well.
+        const char* entry = reinterpret_cast<const char*>(data.data() + entryOffset);
+        const std::size_t keyLength = std::find(entry, entry + entryLength, '\0') - entry;
+
+        if(keyLength < entryLength)
+        {
+            std::size_t valueLength = entryLength - keyLength - 1;
+            if(valueLength != 0 && entry[keyLength + valueLength] == '\0')
+            {
+                valueLength -= 1;
+            }
+
+            instance->m_keyValues[std::string(entry, keyLength)] =
+                std::string(entry + keyLength + 1, valueLength);
+        }
+
+        keyValuePosition = AlignOffset(entryOffset + entryLength, 4);
+    }
+
+    const std::string* orientation = instance->FindValue(OrientationKey);
+    if(orientation == nullptr || orientation->compare(0, 2, OrientationValue) != 0)
+    {
+        LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+            "Image rows must be stored from bottom to top.");
+        return Common::Failure(CreateErrors::UnsupportedFeature);
+    }
+
+    // Read level index and validate level data.
+    if(HeaderSize + levelCount * LevelIndexEntrySize > data.size())
+    {
+        LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+            "Level index is out of bounds.");
+        return Common::Failure(CreateErrors::InvalidHeader);
+    }
+
+    for(uint32_t level = 0; level < levelCount; ++level)
+    {
+        const uint8_t* indexEntry = data.data() + HeaderSize + level * LevelIndexEntrySize;
+        const uint64_t offset = ReadUint64(indexEntry);
+        const uint64_t size = ReadUint64(indexEntry + 8);
+
+        const std::size_t expectedSize = CalculateLevelSize(instance->m_format,
+            CalculateLevelDimension(instance->m_width, static_cast<int>(level)),
+            CalculateLevelDimension(instance->m_height, static_cast<int>(level)));
+
+        if(size != expectedSize || offset > data.size() || size > data.size() - offset)
+        {
+            LOG_ERROR(LogLoadFromFileFailed, file.GetPath().generic_string(),
+                fmt::format("Invalid data of level {}.", level));
+            return Common::Failure(CreateErrors::InvalidLevelData);
+        }
+
+        Level& entry = instance->m_levels.emplace_back();
+        entry.offset = static_cast<std::size_t>(offset);
+        entry.size = static_cast<std::size_t>(size);
+    }
+
+    return Common::Success(std::move(instance));
+}
+
+bool KtxImage::Write(FileHandle& file) const
+{
+    // Compute key/value data, with keys sorted by map.
+    Data keyValueData;
+    for(const auto& [key, value] : m_keyValues)
+    {
+        WriteUint32(keyValueData, static_cast<uint32_t>(key.size() + value.size() + 2));
+        keyValueData.insert(keyValueData.end(), key.begin(), key.end());
+        keyValueData.push_back('\0');
+        keyValueData.insert(keyValueData.end(), value.begin(), value.end());
+        keyValueData.push_back('\0');
+        keyValueData.resize(AlignOffset(keyValueData.size(), 4), 0);
+    }
+
+    // Lay out levels after header from smallest to largest.
+    const std::size_t keyValueOffset = HeaderSize + m_levels.size() * LevelIndexEntrySize;
+    const std::size_t alignment = GetLevelAlignment(m_format);
+
+    std::vector<std::size_t> levelOffsets(m_levels.size());
+    std::size_t offset = keyValueOffset + keyValueData.size();
+
+    for(std::size_t level = m_levels.size(); level-- > 0;)
+    {
+        offset = AlignOffset(offset, alignment);
+        levelOffsets[level] = offset;
+        offset += m_levels[level].size;
+    }
+
+    // Write header and index.
+    Data data(Identifier, Identifier + sizeof(Identifier));
+    data.reserve(offset);
+
+    WriteUint32(data, static_cast<uint32_t>(m_format));
+    WriteUint32(data, 1);
+    WriteUint32(data, static_cast<uint32_t>(m_width));
+    WriteUint32(data, static_cast<uint32_t>(m_height));
+    WriteUint32(data, 0);
+    WriteUint32(data, 0);
+    WriteUint32(data, 1);
+    WriteUint32(data, static_cast<uint32_t>(m_levels.size()));
+    WriteUint32(data, 0);
+
+    WriteUint32(data, 0);
+    WriteUint32(data, 0);
+    WriteUint32(data, static_cast<uint32_t>(keyValueOffset));
+    WriteUint32(data, static_cast<uint32_t>(keyValueData.size()));
+    WriteUint64(data, 0);
+    WriteUint64(data, 0);
+
+    for(std::size_t level = 0; level < m_levels.size(); ++level)
+    {
+        WriteUint64(data, levelOffsets[level]);
+        WriteUint64(data, m_levels[level].size);
+        WriteUint64(data, m_levels[level].size);
+    }
+
+    data.insert(data.end(), keyValueData.begin(), keyValueData.end());
+
+    for(std::size_t level = m_levels.size(); level-- > 0;)
+    {
+        data.resize(levelOffsets[level], 0);
+        const uint8_t* levelData = GetLevelData(static_cast<int>(level));
+        data.insert(data.end(), levelData, levelData + m_levels[level].size);
+    }
+
+    ASSERT(data.size() == offset, "Unexpected size of written KTX image!");
+    return file.Write(data.data(), data.size()) == data.size();
+}
+
+const uint8_t* KtxImage::GetLevelData(int level) const
+{
+    ASSERT(level >= 0 && level < GetLevelCount(), "Invalid level index!");
+    return m_data.data() + m_levels[level].offset;
+}
+
+std::size_t KtxImage::GetLevelSize(int level) const
+{
+    ASSERT(level >= 0 && level < GetLevelCount(), "Invalid level index!");
+    return m_levels[level].size;
+}
+
+int KtxImage::GetLevelWidth(int level) const
+{
+    return CalculateLevelDimension(m_width, level);
+}
+
+int KtxImage::GetLevelHeight(int level) const
+{
+    return CalculateLevelDimension(m_height, level);
+}
+
+const std::string* KtxImage::FindValue(const std::string& key) const
+{
+    auto it = m_keyValues.find(key);
+    return it != m_keyValues.end() ? &it->second : nullptr;
+}
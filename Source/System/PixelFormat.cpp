@@ -0,0 +1,909 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include "System/Precompiled.hpp"
+#include "System/PixelFormat.hpp"
+using namespace System;
+
+namespace
+{
+    const PixelFormatInfo FormatInfos[] =
+    {
+        { "R8", 1, 1, 1, false },
+        { "RG8", 1, 2, 2, false },
+        { "RGB8", 1, 3, 3, false },
+        { "RGBA8", 1, 4, 4, false },
+        { "BC1", 4, 8, 4, true },
+        { "BC2", 4, 16, 4, true },
+        { "BC3", 4, 16, 4, true },
+        { "BC4", 4, 8, 1, true },
+        { "BC5", 4, 16, 2, true },
+        { "BC7", 4, 16, 4, true },
+        { "ETC2_RGB8", 4, 8, 3, true },
+        { "ETC2_RGB8A1", 4, 8, 4, true },
+        { "ETC2_RGBA8", 4, 16, 4, true },
+        { "EAC_R11", 4, 8, 1, true },
+        { "EAC_RG11", 4, 16, 2, true },
+    };
+
+    const PixelFormat Formats[] =
+    {
+        PixelFormat::R8,
+        PixelFormat::RG8,
+        PixelFormat::RGB8,
+        PixelFormat::RGBA8,
+        PixelFormat::BC1,
+        PixelFormat::BC2,
+        PixelFormat::BC3,
+        PixelFormat::BC4,
+        PixelFormat::BC5,
+        PixelFormat::BC7,
+        PixelFormat::ETC2_RGB8,
+        PixelFormat::ETC2_RGB8A1,
+        PixelFormat::ETC2_RGBA8,
+        PixelFormat::EAC_R11,
+        PixelFormat::EAC_RG11,
+    };
+
+    static_assert(std::size(FormatInfos) == std::size(Formats));
+
+    // Decoded block of 4x4 pixels with up to four channels, stored in rows.
+    using Block = uint8_t[16][4];
+
+    uint8_t Clamp255(int value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+
+    uint64_t ReadBigEndian64(const uint8_t* data)
+    {
+        uint64_t value = 0;
+        for(int i = 0; i < 8; ++i)
+        {
+            value = (value << 8) | data[i];
+        }
+
+        return value;
+    }
+
+    uint64_t ReadLittleEndian64(const uint8_t* data)
+    {
+        uint64_t value = 0;
+        for(int i = 7; i >= 0; --i)
+        {
+            value = (value << 8) | data[i];
+        }
+
+        return value;
+    }
+
+    uint32_t Bits(uint64_t value, int highBit, int count)
+    {
+        return static_cast<uint32_t>((value >> (highBit - count + 1)) & ((1ull << count) - 1));
+    }
+
+    /*
+        BC1, BC2, BC3, BC4 and BC5
+    */
+
+    void DecodeColorBC(const uint8_t* data, bool allowTransparent, Block& pixels)
+    {
+        const uint32_t color0 = data[0] | (data[1] << 8);
+        const uint32_t color1 = data[2] | (data[3] << 8);
+
+        auto Expand565 = [](uint32_t color, uint8_t* rgb)
+        {
+            const uint32_t red = (color >> 11) & 31;
+            const uint32_t green = (color >> 5) & 63;
+            const uint32_t blue = color & 31;
+            rgb[0] = static_cast<uint8_t>((red << 3) | (red >> 2));
+            rgb[1] = static_cast<uint8_t>((green << 2) | (green >> 4));
+            rgb[2] = static_cast<uint8_t>((blue << 3) | (blue >> 2));
+        };
+
+        uint8_t palette[4][4] = {};
+        Expand565(color0, palette[0]);
+        Expand565(color1, palette[1]);
+        palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+        // Smaller first color selects three color mode with transparent black.
+        for(int channel = 0; channel < 3; ++channel)
+        {
+            const int first = palette[0][channel];
+            const int second = palette[1][channel];
+
+            if(color0 > color1 || !allowTransparent)
+            {
+                palette[2][channel] = static_cast<uint8_t>((2 * first + second) / 3);
+                palette[3][channel] = static_cast<uint8_t>((first + 2 * second) / 3);
+            }
+            else
+            {
+                palette[2][channel] = static_cast<uint8_t>((first + second) / 2);
+                palette[3][channel] = 0;
+            }
+        }
+
+        if(color0 <= color1 && allowTransparent)
+        {
+            palette[3][3] = 0;
+        }
+
+        const uint32_t indices = data[4] | (data[5] << 8) | (data[6] << 16) | (data[7] << 24);
+        for(int i = 0; i < 16; ++i)
+        {
+            std::memcpy(pixels[i], palette[(indices >> (i * 2)) & 3], 4);
+        }
+    }
+
+    void DecodeAlphaBC(const uint8_t* data, Block& pixels, int channel)
+    {
+        const int first = data[0];
+        const int second = data[1];
+
+        // Larger first value selects eight interpolated values, otherwise six with both extremes.
+        int values[8] = { first, second };
+        if(first > second)
+        {
+            for(int i = 2; i < 8; ++i)
+            {
+                values[i] = ((8 - i) * first + (i - 1) * second) / 7;
+            }
+        }
+        else
+        {
+            for(int i = 2; i < 6; ++i)
+            {
+                values[i] = ((6 - i) * first + (i - 1) * second) / 5;
+            }
+
+            values[6] = 0;
+            values[7] = 255;
+        }
+
+        const uint64_t indices = ReadLittleEndian64(data) >> 16;
+        for(int i = 0; i < 16; ++i)
+        {
+            pixels[i][channel] = static_cast<uint8_t>(values[(indices >> (i * 3)) & 7]);
+        }
+    }
+
+    void DecodeExplicitAlphaBC(const uint8_t* data, Block& pixels)
+    {
+        const uint64_t alpha = ReadLittleEndian64(data);
+        for(int i = 0; i < 16; ++i)
+        {
+            pixels[i][3] = static_cast<uint8_t>(((alpha >> (i * 4)) & 15) * 17);
+        }
+    }
+
+    /*
+        BC7
+    */
+
+    class BitReader
+    {
+    public:
+        explicit BitReader(const uint8_t* data) :
+            m_low(ReadLittleEndian64(data)),
+            m_high(ReadLittleEndian64(data + 8))
+        {
+        }
+
+        uint32_t Read(int count)
+        {
+            uint32_t value = 0;
+            for(int i = 0; i < count; ++i, ++m_position)
+            {
+                const uint64_t word = m_position < 64 ? m_low : m_high;
+                value |= static_cast<uint32_t>((word >> (m_position & 63)) & 1) << i;
+            }
+
+            return value;
+        }
+
+    private:
+        uint64_t m_low;
+        uint64_t m_high;
+        int m_position = 0;
+    };
+
+    struct ModeBC7
+    {
+        int subsets;
+        int partitionBits;
+        int rotationBits;
+        int indexSelectionBits;
+        int colorBits;
+        int alphaBits;
+        int endpointBits;
+        int sharedBits;
+        int indexBits;
+        int secondaryIndexBits;
+    };
+
+    const ModeBC7 ModesBC7[8] =
+    {
+        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+    };
+
+    // Subset of each pixel for two subset partitions, one bit per pixel.
+    const uint16_t PartitionsBC7Two[64] =
+    {
+        0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+        0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+        0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+        0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+        0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+        0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+        0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+        0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+    };
+
+    // Subset of each pixel for three subset partitions, two bits per pixel.
+    const uint32_t PartitionsBC7Three[64] =
+    {
+        0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+        0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+        0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+        0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+        0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+        0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+        0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+        0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254,
+    };
+
+    // Pixels whose index omits its most significant bit, besides first pixel of block.
+    const uint8_t AnchorsBC7Two[64] =
+    {
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+        15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+        15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+        6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+    };
+
+    const uint8_t AnchorsBC7ThreeSecond[64] =
+    {
+        3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+        3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+        8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+        3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3,
+    };
+
+    const uint8_t AnchorsBC7ThreeThird[64] =
+    {
+        15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+        15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+        15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+        15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8,
+    };
+
+    const int WeightsBC7Two[4] = { 0, 21, 43, 64 };
+    const int WeightsBC7Three[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    const int WeightsBC7Four[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    int InterpolateBC7(int first, int second, int index, int indexBits)
+    {
+        const int* weights = indexBits == 2 ? WeightsBC7Two :
+            indexBits == 3 ? WeightsBC7Three : WeightsBC7Four;
+
+        return ((64 - weights[index]) * first + weights[index] * second + 32) >> 6;
+    }
+
+    void DecodeBC7(const uint8_t* data, Block& pixels)
+    {
+        BitReader bits(data);
+
+        // Mode is encoded as number of zero bits before first set bit.
+        int modeIndex = 0;
+        while(modeIndex < 8 && bits.Read(1) == 0)
+        {
+            ++modeIndex;
+        }
+
+        if(modeIndex == 8)
+        {
+            // Reserved mode decodes to transparent black.
+            std::memset(pixels, 0, sizeof(Block));
+            return;
+        }
+
+        const ModeBC7& mode = ModesBC7[modeIndex];
+        const uint32_t partition = bits.Read(mode.partitionBits);
+        const uint32_t rotation = bits.Read(mode.rotationBits);
+        const uint32_t indexSelection = bits.Read(mode.indexSelectionBits);
+
+        // Endpoints are stored channel by channel, followed by their unique or shared bits.
+        const int endpointCount = mode.subsets * 2;
+        int endpoints[6][4] = {};
+
+        for(int channel = 0; channel < 3; ++channel)
+        {
+            for(int endpoint = 0; endpoint < endpointCount; ++endpoint)
+            {
+                endpoints[endpoint][channel] = static_cast<int>(bits.Read(mode.colorBits));
+            }
+        }
+
+        for(int endpoint = 0; endpoint < endpointCount; ++endpoint)
+        {
+            endpoints[endpoint][3] = static_cast<int>(bits.Read(mode.alphaBits));
+        }
+
+        int colorBits = mode.colorBits;
+        int alphaBits = mode.alphaBits;
+
+        if(mode.endpointBits != 0 || mode.sharedBits != 0)
+        {
+            int endpointBits[6] = {};
+            if(mode.endpointBits != 0)
+            {
+                for(int endpoint = 0; endpoint < endpointCount; ++endpoint)
+                {
+                    endpointBits[endpoint] = static_cast<int>(bits.Read(1));
+                }
+            }
+            else
+            {
+                for(int subset = 0; subset < mode.subsets; ++subset)
+                {
+                    endpointBits[subset * 2] = endpointBits[subset * 2 + 1] =
+                        static_cast<int>(bits.Read(1));
+                }
+            }
+
+            for(int endpoint = 0; endpoint < endpointCount; ++endpoint)
+            {
+                for(int channel = 0; channel < 4; ++channel)
+                {
+                    endpoints[endpoint][channel] = (endpoints[endpoint][channel] << 1) | endpointBits[endpoint];
+                }
+            }
+
+            colorBits += 1;
+            alphaBits += alphaBits != 0 ? 1 : 0;
+        }
+
+        // Expand endpoints to eight bits by replicating their most significant bits.
+        for(int endpoint = 0; endpoint < endpointCount; ++endpoint)
+        {
+            for(int channel = 0; channel < 4; ++channel)
+            {
+                const int precision = channel < 3 ? colorBits : alphaBits;
+                int& value = endpoints[endpoint][channel];
+
+                if(precision == 0)
+                {
+                    value = 255;
+                }
+                else
+                {
+                    value <<= 8 - precision;
+                    value |= value >> precision;
+                }
+            }
+        }
+
+        // Find subset of each pixel and anchors of subsets.
+        int subsets[16] = {};
+        int anchors[3] = { 0, 0, 0 };
+
+        if(mode.subsets == 2)
+        {
+            for(int i = 0; i < 16; ++i)
+            {
+                subsets[i] = (PartitionsBC7Two[partition] >> i) & 1;
+            }
+
+            anchors[1] = AnchorsBC7Two[partition];
+        }
+        else if(mode.subsets == 3)
+        {
+            for(int i = 0; i < 16; ++i)
+            {
+                subsets[i] = (PartitionsBC7Three[partition] >> (i * 2)) & 3;
+            }
+
+            anchors[1] = AnchorsBC7ThreeSecond[partition];
+            anchors[2] = AnchorsBC7ThreeThird[partition];
+        }
+
+        auto IsAnchor = [&](int pixel)
+        {
+            return pixel == 0 || (mode.subsets > 1 && pixel == anchors[1]) ||
+                (mode.subsets > 2 && pixel == anchors[2]);
+        };
+
+        int indices[16] = {};
+        for(int i = 0; i < 16; ++i)
+        {
+            indices[i] = static_cast<int>(bits.Read(mode.indexBits - (IsAnchor(i) ? 1 : 0)));
+        }
+
+        int secondaryIndices[16] = {};
+        if(mode.secondaryIndexBits != 0)
+        {
+            for(int i = 0; i < 16; ++i)
+            {
+                secondaryIndices[i] = static_cast<int>(bits.Read(mode.secondaryIndexBits - (i == 0 ? 1 : 0)));
+            }
+        }
+
+        // Interpolate endpoints, using secondary indices for alpha when present.
+        for(int i = 0; i < 16; ++i)
+        {
+            const int* first = endpoints[subsets[i] * 2];
+            const int* second = endpoints[subsets[i] * 2 + 1];
+
+            int colorIndex = indices[i];
+            int colorIndexBits = mode.indexBits;
+            int alphaIndex = indices[i];
+            int alphaIndexBits = mode.indexBits;
+
+            if(mode.secondaryIndexBits != 0)
+            {
+                alphaIndex = secondaryIndices[i];
+                alphaIndexBits = mode.secondaryIndexBits;
+
+                if(indexSelection != 0)
+                {
+                    std::swap(colorIndex, alphaIndex);
+                    std::swap(colorIndexBits, alphaIndexBits);
+                }
+            }
+
+            for(int channel = 0; channel < 3; ++channel)
+            {
+                pixels[i][channel] = static_cast<uint8_t>(
+                    InterpolateBC7(first[channel], second[channel], colorIndex, colorIndexBits));
+            }
+
+            pixels[i][3] = static_cast<uint8_t>(
+                InterpolateBC7(first[3], second[3], alphaIndex, alphaIndexBits));
+
+            if(rotation != 0)
+            {
+                std::swap(pixels[i][3], pixels[i][rotation - 1]);
+            }
+        }
+    }
+
+    /*
+        ETC2 and EAC
+    */
+
+    const int ModifiersETC[8][2] =
+    {
+        { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 },
+        { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 },
+    };
+
+    const int DistancesETC[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+    const int ModifiersEAC[16][8] =
+    {
+        { -3, -6, -9, -15, 2, 5, 8, 14 },
+        { -3, -7, -10, -13, 2, 6, 9, 12 },
+        { -2, -5, -8, -13, 1, 4, 7, 12 },
+        { -2, -4, -6, -13, 1, 3, 5, 12 },
+        { -3, -6, -8, -12, 2, 5, 7, 11 },
+        { -3, -7, -9, -11, 2, 6, 8, 10 },
+        { -4, -7, -8, -11, 3, 6, 7, 10 },
+        { -3, -5, -8, -11, 2, 4, 7, 10 },
+        { -2, -6, -8, -10, 1, 5, 7, 9 },
+        { -2, -5, -8, -10, 1, 4, 7, 9 },
+        { -2, -4, -8, -10, 1, 3, 7, 9 },
+        { -2, -5, -7, -10, 1, 4, 6, 9 },
+        { -3, -4, -7, -10, 2, 3, 6, 9 },
+        { -1, -2, -3, -10, 0, 1, 2, 9 },
+        { -4, -6, -8, -9, 3, 5, 7, 8 },
+        { -3, -5, -7, -9, 2, 4, 6, 8 },
+    };
+
+    // Pixel indices of ETC blocks are stored in columns, while decoded block is stored in rows.
+    int ColumnToRow(int pixel)
+    {
+        return (pixel & 3) * 4 + (pixel >> 2);
+    }
+
+    int ExtendBits(int value, int bits)
+    {
+        value <<= 8 - bits;
+        return value | (value >> bits);
+    }
+
+    void DecodeColorETC(const uint8_t* data, bool punchthrough, Block& pixels)
+    {
+        const uint64_t block = ReadBigEndian64(data);
+        const bool differential = Bits(block, 33, 1) != 0;
+        const bool opaque = !punchthrough || differential;
+
+        auto IndexOf = [&block](int pixel)
+        {
+            return static_cast<int>((Bits(block, 16 + pixel, 1) << 1) | Bits(block, pixel, 1));
+        };
+
+        auto WritePaint = [&pixels, opaque](int pixel, const int* color, int index)
+        {
+            uint8_t* output = pixels[ColumnToRow(pixel)];
+            if(!opaque && index == 2)
+            {
+                std::memset(output, 0, 4);
+                return;
+            }
+
+            output[0] = Clamp255(color[0]);
+            output[1] = Clamp255(color[1]);
+            output[2] = Clamp255(color[2]);
+            output[3] = 255;
+        };
+
+        int baseColors[2][3] = {};
+
+        if(!differential && !punchthrough)
+        {
+            // Individual mode with two four bit colors.
+            for(int channel = 0; channel < 3; ++channel)
+            {
+                baseColors[0][channel] = static_cast<int>(Bits(block, 63 - channel * 8, 4)) * 17;
+                baseColors[1][channel] = static_cast<int>(Bits(block, 59 - channel * 8, 4)) * 17;
+            }
+        }
+        else
+        {
+            // Differential mode, where overflow of second color selects one of other modes.
+            int overflow = -1;
+            for(int channel = 0; channel < 3; ++channel)
+            {
+                const int base = static_cast<int>(Bits(block, 63 - channel * 8, 5));
+                int delta = static_cast<int>(Bits(block, 58 - channel * 8, 3));
+                delta = delta >= 4 ? delta - 8 : delta;
+
+                if(base + delta < 0 || base + delta > 31)
+                {
+                    overflow = channel;
+                    break;
+                }
+
+                baseColors[0][channel] = ExtendBits(base, 5);
+                baseColors[1][channel] = ExtendBits(base + delta, 5);
+            }
+
+            if(overflow == 0)
+            {
+                // T mode with single color and three colors around second color.
+                const int first[3] =
+                {
+                    static_cast<int>((Bits(block, 60, 2) << 2) | Bits(block, 57, 2)) * 17,
+                    static_cast<int>(Bits(block, 55, 4)) * 17,
+                    static_cast<int>(Bits(block, 51, 4)) * 17,
+                };
+
+                const int second[3] =
+                {
+                    static_cast<int>(Bits(block, 47, 4)) * 17,
+                    static_cast<int>(Bits(block, 43, 4)) * 17,
+                    static_cast<int>(Bits(block, 39, 4)) * 17,
+                };
+
+                const int distance = DistancesETC[(Bits(block, 35, 2) << 1) | Bits(block, 32, 1)];
+
+                int paints[4][3];
+                for(int channel = 0; channel < 3; ++channel)
+                {
+                    paints[0][channel] = first[channel];
+                    paints[1][channel] = second[channel] + distance;
+                    paints[2][channel] = second[channel];
+                    paints[3][channel] = second[channel] - distance;
+                }
+
+                for(int pixel = 0; pixel < 16; ++pixel)
+                {
+                    const int index = IndexOf(pixel);
+                    WritePaint(pixel, paints[index], index);
+                }
+
+                return;
+            }
+
+            if(overflow == 1)
+            {
+                // H mode with two colors around each of two colors.
+                const int first[3] =
+                {
+                    static_cast<int>(Bits(block, 62, 4)),
+                    static_cast<int>((Bits(block, 58, 3) << 1) | Bits(block, 52, 1)),
+                    static_cast<int>((Bits(block, 51, 1) << 3) | Bits(block, 49, 3)),
+                };
+
+                const int second[3] =
+                {
+                    static_cast<int>(Bits(block, 46, 4)),
+                    static_cast<int>(Bits(block, 42, 4)),
+                    static_cast<int>(Bits(block, 38, 4)),
+                };
+
+                // Least significant bit of distance is implied by order of colors.
+                const int firstValue = (first[0] << 8) | (first[1] << 4) | first[2];
+                const int secondValue = (second[0] << 8) | (second[1] << 4) | second[2];
+                const int distance = DistancesETC[(Bits(block, 34, 1) << 2) |
+                    (Bits(block, 32, 1) << 1) | (firstValue >= secondValue ? 1 : 0)];
+
+                int paints[4][3];
+                for(int channel = 0; channel < 3; ++channel)
+                {
+                    paints[0][channel] = first[channel] * 17 + distance;
+                    paints[1][channel] = first[channel] * 17 - distance;
+                    paints[2][channel] = second[channel] * 17 + distance;
+                    paints[3][channel] = second[channel] * 17 - distance;
+                }
+
+                for(int pixel = 0; pixel < 16; ++pixel)
+                {
+                    const int index = IndexOf(pixel);
+                    WritePaint(pixel, paints[index], index);
+                }
+
+                return;
+            }
+
+            if(overflow == 2)
+            {
+                // Planar mode with colors interpolated from three corners.
+                const int origin[3] =
+                {
+                    ExtendBits(static_cast<int>(Bits(block, 62, 6)), 6),
+                    ExtendBits(static_cast<int>((Bits(block, 56, 1) << 6) | Bits(block, 54, 6)), 7),
+                    ExtendBits(static_cast<int>((Bits(block, 48, 1) << 5) |
+                        (Bits(block, 44, 2) << 3) | Bits(block, 41, 3)), 6),
+                };
+
+                const int horizontal[3] =
+                {
+                    ExtendBits(static_cast<int>((Bits(block, 38, 5) << 1) | Bits(block, 32, 1)), 6),
+                    ExtendBits(static_cast<int>(Bits(block, 31, 7)), 7),
+                    ExtendBits(static_cast<int>(Bits(block, 24, 6)), 6),
+                };
+
+                const int vertical[3] =
+                {
+                    ExtendBits(static_cast<int>(Bits(block, 18, 6)), 6),
+                    ExtendBits(static_cast<int>(Bits(block, 12, 7)), 7),
+                    ExtendBits(static_cast<int>(Bits(block, 5, 6)), 6),
+                };
+
+                for(int y = 0; y < 4; ++y)
+                {
+                    for(int x = 0; x < 4; ++x)
+                    {
+                        uint8_t* output = pixels[y * 4 + x];
+                        for(int channel = 0; channel < 3; ++channel)
+                        {
+                            output[channel] = Clamp255((x * (horizontal[channel] - origin[channel]) +
+                                y * (vertical[channel] - origin[channel]) + 4 * origin[channel] + 2) >> 2);
+                        }
+
+                        output[3] = 255;
+                    }
+                }
+
+                return;
+            }
+        }
+
+        // Individual and differential modes offset base color of each half of block.
+        const bool flip = Bits(block, 32, 1) != 0;
+        const int tables[2] =
+        {
+            static_cast<int>(Bits(block, 39, 3)),
+            static_cast<int>(Bits(block, 36, 3)),
+        };
+
+        for(int pixel = 0; pixel < 16; ++pixel)
+        {
+            const int x = pixel >> 2;
+            const int y = pixel & 3;
+            const int subblock = flip ? (y >= 2 ? 1 : 0) : (x >= 2 ? 1 : 0);
+            const int index = IndexOf(pixel);
+
+            const int* modifiers = ModifiersETC[tables[subblock]];
+            int modifier = (index & 1) ? modifiers[1] : modifiers[0];
+            modifier = (index & 2) ? -modifier : modifier;
+
+            // Punchthrough blocks without opaque bit replace smaller modifiers.
+            if(!opaque && (index & 1) == 0)
+            {
+                modifier = 0;
+            }
+
+            const int color[3] =
+            {
+                baseColors[subblock][0] + modifier,
+                baseColors[subblock][1] + modifier,
+                baseColors[subblock][2] + modifier,
+            };
+
+            WritePaint(pixel, color, index);
+        }
+    }
+
+    void DecodeAlphaEAC(const uint8_t* data, Block& pixels, int channel)
+    {
+        const uint64_t block = ReadBigEndian64(data);
+        const int base = static_cast<int>(Bits(block, 63, 8));
+        const int multiplier = static_cast<int>(Bits(block, 55, 4));
+        const int* modifiers = ModifiersEAC[Bits(block, 51, 4)];
+
+        for(int pixel = 0; pixel < 16; ++pixel)
+        {
+            const int modifier = modifiers[Bits(block, 47 - pixel * 3, 3)];
+            pixels[ColumnToRow(pixel)][channel] = Clamp255(base + modifier * multiplier);
+        }
+    }
+
+    void DecodeRedEAC(const uint8_t* data, Block& pixels, int channel)
+    {
+        const uint64_t block = ReadBigEndian64(data);
+        const int base = static_cast<int>(Bits(block, 63, 8));
+        const int multiplier = static_cast<int>(Bits(block, 55, 4));
+        const int* modifiers = ModifiersEAC[Bits(block, 51, 4)];
+
+        for(int pixel = 0; pixel < 16; ++pixel)
+        {
+            // Eleven bit value, where zero multiplier still applies modifier with its lowest precision.
+            const int modifier = modifiers[Bits(block, 47 - pixel * 3, 3)];
+            const int scaled = multiplier != 0 ? modifier * multiplier * 8 : modifier;
+            const int value = std::clamp(base * 8 + 4 + scaled, 0, 2047);
+
+            pixels[ColumnToRow(pixel)][channel] = static_cast<uint8_t>((value * 255 + 1023) / 2047);
+        }
+    }
+
+    void DecodeBlock(PixelFormat format, const uint8_t* data, Block& pixels)
+    {
+        switch(format)
+        {
+        case PixelFormat::BC1:
+            DecodeColorBC(data, true, pixels);
+            break;
+
+        case PixelFormat::BC2:
+            DecodeColorBC(data + 8, false, pixels);
+            DecodeExplicitAlphaBC(data, pixels);
+            break;
+
+        case PixelFormat::BC3:
+            DecodeColorBC(data + 8, false, pixels);
+            DecodeAlphaBC(data, pixels, 3);
+            break;
+
+        case PixelFormat::BC4:
+            DecodeAlphaBC(data, pixels, 0);
+            break;
+
+        case PixelFormat::BC5:
+            DecodeAlphaBC(data, pixels, 0);
+            DecodeAlphaBC(data + 8, pixels, 1);
+            break;
+
+        case PixelFormat::BC7:
+            DecodeBC7(data, pixels);
+            break;
+
+        case PixelFormat::ETC2_RGB8:
+            DecodeColorETC(data, false, pixels);
+            break;
+
+        case PixelFormat::ETC2_RGB8A1:
+            DecodeColorETC(data, true, pixels);
+            break;
+
+        case PixelFormat::ETC2_RGBA8:
+            DecodeColorETC(data + 8, false, pixels);
+            DecodeAlphaEAC(data, pixels, 3);
+            break;
+
+        case PixelFormat::EAC_R11:
+            DecodeRedEAC(data, pixels, 0);
+            break;
+
+        case PixelFormat::EAC_RG11:
+            DecodeRedEAC(data, pixels, 0);
+            DecodeRedEAC(data + 8, pixels, 1);
+            break;
+
+        default:
+            ASSERT(false, "Unknown block compressed format!");
+            break;
+        }
+    }
+}
+
+const PixelFormatInfo& System::GetPixelFormatInfo(PixelFormat format)
+{
+    for(std::size_t i = 0; i < std::size(Formats); ++i)
+    {
+        if(Formats[i] == format)
+            return FormatInfos[i];
+    }
+
+    static const PixelFormatInfo UnknownInfo;
+    return UnknownInfo;
+}
+
+PixelFormat System::FindPixelFormat(std::string_view name)
+{
+    for(std::size_t i = 0; i < std::size(Formats); ++i)
+    {
+        if(name == FormatInfos[i].name)
+            return Formats[i];
+    }
+
+    return PixelFormat::Unknown;
+}
+
+std::size_t System::CalculateLevelSize(PixelFormat format, int width, int height)
+{
+    const PixelFormatInfo& info = GetPixelFormatInfo(format);
+    if(info.blockSize == 0 || width <= 0 || height <= 0)
+        return 0;
+
+    // Partial blocks along edges are stored whole.
+    const std::size_t blocksX = (width + info.blockSize - 1) / info.blockSize;
+    const std::size_t blocksY = (height + info.blockSize - 1) / info.blockSize;
+    return blocksX * blocksY * info.blockBytes;
+}
+
+bool System::DecodePixels(PixelFormat format, const uint8_t* data, int width, int height, uint8_t* pixels)
+{
+    ASSERT(data != nullptr && pixels != nullptr, "Invalid pixel data!");
+
+    const PixelFormatInfo& info = GetPixelFormatInfo(format);
+    if(info.blockSize == 0 || width <= 0 || height <= 0)
+        return false;
+
+    if(!info.compressed)
+    {
+        std::memcpy(pixels, data, CalculateLevelSize(format, width, height));
+        return true;
+    }
+
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const std::size_t rowSize = static_cast<std::size_t>(width) * info.channels;
+
+    for(int blockY = 0; blockY < blocksY; ++blockY)
+    {
+        for(int blockX = 0; blockX < blocksX; ++blockX)
+        {
+            Block block;
+            std::memset(block, 0, sizeof(Block));
+            DecodeBlock(format, data, block);
+            data += info.blockBytes;
+
+            // Copy decoded pixels that lie within image.
+            const int columns = std::min(4, width - blockX * 4);
+            const int rows = std::min(4, height - blockY * 4);
+
+            for(int y = 0; y < rows; ++y)
+            {
+                uint8_t* output = pixels + (blockY * 4 + y) * rowSize + blockX * 4 * info.channels;
+                for(int x = 0; x < columns; ++x)
+                {
+                    std::memcpy(output + x * info.channels, block[y * 4 + x], info.channels);
+                }
+            }
+        }
+    }
+
+    return true;
+}
@@ -5,6 +5,8 @@
 
 #include "System/Precompiled.hpp"
 #include "System/Platform.hpp"
+#include <Core/SystemStorage.hpp>
+#include <Core/ConfigSystem.hpp>
 using namespace System;
 
 namespace
@@ -35,6 +37,21 @@ Platform::~Platform()
 
 bool Platform::OnAttach(const Core::EngineSystemStorage& engineSystems)
 {
+    // Headless platform does not use GLFW library at all.
+    auto* configSystem = engineSystems.Locate<Core::ConfigSystem>();
+    if(configSystem == nullptr)
+    {
+        LOG_ERROR("Failed to attach platform! Could not locate config system.");
+        return false;
+    }
+
+    m_headless = configSystem->Get<bool>(NAME_CONSTEXPR("engine.headless")).UnwrapOr(false);
+    if(m_headless)
+    {
+        LOG_INFO("Running headless platform without GLFW library.");
+        return true;
+    }
+
     if(InstanceCounter == 0)
     {
         // Initialize GLFW library for first instance.
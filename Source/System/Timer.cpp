@@ -38,6 +38,12 @@ bool Timer::OnAttach(const Core::EngineSystemStorage& engineSystems)
 
     m_maxUpdateDelta = std::max(0.0f, m_maxUpdateDelta);
 
+    double syntheticStep = configSystem->Get<float>(
+        NAME_CONSTEXPR("timer.syntheticStep"))
+        .UnwrapOr(0.0f);
+
+    SetSyntheticStep(syntheticStep);
+
     return true;
 }
 
@@ -49,7 +55,8 @@ void Timer::OnBeginFrame()
 Timer::TimeUnit Timer::ReadClockUnits()
 {
 #ifdef USE_PRECISE_TIME_COUNTERS
-    TimeUnit units = glfwGetTimerValue();
+    TimeUnit units = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 #else
     TimeUnit units = glfwGetTime();
 #endif
@@ -61,7 +68,7 @@ Timer::TimeUnit Timer::ReadClockUnits()
 Timer::TimeUnit Timer::ReadClockFrequency()
 {
 #ifdef USE_PRECISE_TIME_COUNTERS
-    TimeUnit frequency = glfwGetTimerFrequency();
+    TimeUnit frequency = std::nano::den;
 #else
     TimeUnit frequency = 1.0;
 #endif
@@ -73,7 +80,7 @@ Timer::TimeUnit Timer::ReadClockFrequency()
 Timer::TimeUnit System::Timer::ConvertToUnits(double seconds)
 {
 #ifdef USE_PRECISE_TIME_COUNTERS
-    return static_cast<TimeUnit>(seconds * glfwGetTimerFrequency() + 0.5);
+    return static_cast<TimeUnit>(seconds * ReadClockFrequency() + 0.5);
 #else
     return seconds;
 #endif
@@ -82,7 +89,7 @@ Timer::TimeUnit System::Timer::ConvertToUnits(double seconds)
 double Timer::ConvertToSeconds(TimeUnit units)
 {
 #ifdef USE_PRECISE_TIME_COUNTERS
-    return static_cast<double>(units) / glfwGetTimerFrequency();
+    return static_cast<double>(units) / ReadClockFrequency();
 #else
     return units;
 #endif
@@ -92,7 +99,15 @@ float Timer::Advance(float maxDeltaSeconds)
 {
     // Remember time points of two last ticks.
     m_previousTimeUnits = m_currentTimeUnits;
-    m_currentTimeUnits = ReadClockUnits();
+
+    if(IsSynthetic())
+    {
+        m_currentTimeUnits += m_syntheticStepUnits;
+    }
+    else
+    {
+        m_currentTimeUnits = ReadClockUnits();
+    }
 
     // Clamp maximum possible delta time by limiting how far back previous time counter can go.
     if(maxDeltaSeconds >= 0.0f)
@@ -120,6 +135,13 @@ void Timer::Reset()
     m_previousTimeUnits = m_currentTimeUnits;
 }
 
+void Timer::SetSyntheticStep(double seconds)
+{
+    // Zero step reverts back to reading real clock.
+    m_syntheticStepUnits = ConvertToUnits(std::max(0.0, seconds));
+    Reset();
+}
+
 float Timer::GetDeltaSeconds() const
 {
     // Calculate elapsed time in ticks since the last frame.
@@ -144,3 +166,8 @@ Timer::TimeUnit Timer::GetPreviousTimeUnits() const
 {
     return m_previousTimeUnits;
 }
+
+bool Timer::IsSynthetic() const
+{
+    return m_syntheticStepUnits != TimeUnit(0);
+}
@@ -6,6 +6,7 @@
 
 #include "System/Precompiled.hpp"
 #include "System/Window.hpp"
+#include "System/Platform.hpp"
 #include <Core/SystemStorage.hpp>
 #include <Core/ConfigSystem.hpp>
 using namespace System;
@@ -47,6 +48,13 @@ bool Window::OnAttach(const Core::EngineSystemStorage& engineSystems)
         return false;
     }
 
+    auto* platform = engineSystems.Locate<System::Platform>();
+    if(platform == nullptr)
+    {
+        LOG_ERROR(LogAttachFailed, "Could not locate platform.");
+        return false;
+    }
+
     m_title = config->Get<std::string>(NAME_CONSTEXPR("window.title")).UnwrapOr("Game");
     int width = config->Get<int>(NAME_CONSTEXPR("window.width")).UnwrapOr(1024);
     int height = config->Get<int>(NAME_CONSTEXPR("window.height")).UnwrapOr(576);
@@ -60,6 +68,17 @@ bool Window::OnAttach(const Core::EngineSystemStorage& engineSystems)
     width = std::max(0, width);
     height = std::max(0, height);
 
+    // Headless window only pretends to have requested size.
+    m_headless = platform->IsHeadless();
+    if(m_headless)
+    {
+        m_width = width;
+        m_height = height;
+
+        LOG_INFO("Using headless window without OpenGL context.");
+        return true;
+    }
+
     // Setup window hints.
     glfwWindowHint(GLFW_RED_BITS, 8);
     glfwWindowHint(GLFW_GREEN_BITS, 8);
@@ -129,17 +148,34 @@ void Window::OnBeginFrame()
 
 void Window::OnEndFrame()
 {
-    Present();
+    if(m_presentOnEndFrame)
+    {
+        Present();
+    }
 }
 
 void Window::MakeContextCurrent()
 {
+    if(m_headless)
+        return;
+
     ASSERT(m_context.handle);
     glfwMakeContextCurrent(m_context.handle);
 }
 
+void Window::ReleaseContext()
+{
+    if(m_headless)
+        return;
+
+    glfwMakeContextCurrent(nullptr);
+}
+
 void Window::ProcessEvents()
 {
+    if(m_headless)
+        return;
+
     // Poll window events.
     ASSERT(m_context.handle);
     glfwPollEvents();
@@ -155,6 +191,9 @@ void Window::ProcessEvents()
 
 void Window::Present()
 {
+    if(m_headless)
+        return;
+
     ASSERT(m_context.handle);
     glfwSwapBuffers(m_context.handle);
 
@@ -169,12 +208,24 @@ void Window::Present()
 
 void Window::Close()
 {
+    if(m_headless)
+    {
+        m_closeRequested = true;
+        return;
+    }
+
     ASSERT(m_context.handle);
     glfwSetWindowShouldClose(m_context.handle, GL_TRUE);
 }
 
 void Window::SetTitle(std::string title)
 {
+    if(m_headless)
+    {
+        m_title = title;
+        return;
+    }
+
     ASSERT(m_context.handle);
     glfwSetWindowTitle(m_context.handle, title.c_str());
     m_title = title;
@@ -182,6 +233,9 @@ void Window::SetTitle(std::string title)
 
 void Window::SetVisibility(bool show)
 {
+    if(m_headless)
+        return;
+
     ASSERT(m_context.handle);
 
     if(show)
@@ -196,12 +250,18 @@ void Window::SetVisibility(bool show)
 
 bool Window::ShouldClose() const
 {
+    if(m_headless)
+        return !m_closeRequested;
+
     ASSERT(m_context.handle);
     return glfwWindowShouldClose(m_context.handle) == 0;
 }
 
 bool Window::IsFocused() const
 {
+    if(m_headless)
+        return true;
+
     ASSERT(m_context.handle);
     return glfwGetWindowAttrib(m_context.handle, GLFW_FOCUSED) > 0;
 }
@@ -0,0 +1,205 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <thread>
+#include <mutex>
+#include <Common/Name.hpp>
+#include <Common/NameRegistry.hpp>
+#include <Common/Test/Benchmark.hpp>
+
+namespace
+{
+    std::vector<std::string> CreateStrings(std::size_t count, const char* prefix)
+    {
+        std::vector<std::string> strings;
+        strings.reserve(count);
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            strings.push_back(fmt::format("{}{}", prefix, i));
+        }
+
+        return strings;
+    }
+
+    template<typename Function>
+    void RunThreads(std::size_t threadCount, Function&& function)
+    {
+        std::vector<std::thread> threads;
+        for(std::size_t i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back(function, i);
+        }
+
+        for(std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
+
+DOCTEST_TEST_CASE("Name Registry")
+{
+    Common::NameRegistry registry;
+    registry.SetAbortOnCollision(false);
+
+    DOCTEST_SUBCASE("Register And Lookup")
+    {
+        const auto hash = registry.Register("Player");
+        DOCTEST_CHECK_EQ(hash, Common::StringHash<Common::NameRegistry::HashType>("Player"));
+        DOCTEST_CHECK(registry.IsRegistered("Player"));
+        DOCTEST_CHECK(registry.IsRegistered(hash));
+        DOCTEST_CHECK_EQ(registry.Lookup(hash), "Player");
+
+        DOCTEST_CHECK(registry.IsRegistered(""));
+        DOCTEST_CHECK_FALSE(registry.IsRegistered("Enemy"));
+        DOCTEST_CHECK(registry.Lookup(Common::StringHash<Common::NameRegistry::HashType>("Enemy")).empty());
+
+        // Registering same string again does not add new entry.
+        const std::size_t nameCount = registry.GetNameCount();
+        registry.Register(std::string("Player"));
+        DOCTEST_CHECK_EQ(registry.GetNameCount(), nameCount);
+        DOCTEST_CHECK_EQ(registry.GetCollisionCount(), 0);
+    }
+
+    DOCTEST_SUBCASE("Arena Storage")
+    {
+        // Looked up strings remain valid as arena grows.
+        const std::string_view first = registry.Lookup(registry.Register("First"));
+        const std::string longString(Common::NameRegistry::ArenaBlockSize * 2, 'x');
+        const std::string_view longView = registry.Lookup(registry.Register(longString));
+
+        for(const std::string& string : CreateStrings(10000, "Name"))
+        {
+            registry.Register(string);
+        }
+
+        DOCTEST_CHECK_EQ(first, "First");
+        DOCTEST_CHECK_EQ(longView, longString);
+        DOCTEST_CHECK_EQ(registry.GetNameCount(), 10003);
+        DOCTEST_CHECK_GE(registry.GetArenaSize(), longString.size() + 10000 * 5);
+    }
+
+    DOCTEST_SUBCASE("Collisions")
+    {
+        // Registering different string under same hash is counted as collision.
+        const auto hash = registry.Register("Original");
+        registry.Register(hash, "Colliding");
+        registry.Register(hash, "Original");
+
+        DOCTEST_CHECK_EQ(registry.GetCollisionCount(), 1);
+        DOCTEST_CHECK_EQ(registry.Lookup(hash), "Original");
+        DOCTEST_CHECK_FALSE(registry.IsAbortingOnCollision());
+    }
+
+    DOCTEST_SUBCASE("Concurrent Interning")
+    {
+        // Threads register overlapping sets of names while looking them up.
+        const std::vector<std::string> strings = CreateStrings(20000, "Shared");
+        std::atomic<std::size_t> mismatches = 0;
+
+        RunThreads(8, [&](std::size_t threadIndex)
+        {
+            for(std::size_t i = 0; i < strings.size(); ++i)
+            {
+                const std::string& string = strings[(i * 7 + threadIndex * 2503) % strings.size()];
+                if(registry.Lookup(registry.Register(string)) != string)
+                {
+                    ++mismatches;
+                }
+            }
+        });
+
+        DOCTEST_CHECK_EQ(mismatches.load(), 0);
+        DOCTEST_CHECK_EQ(registry.GetNameCount(), strings.size() + 1);
+        DOCTEST_CHECK_EQ(registry.GetCollisionCount(), 0);
+    }
+
+#ifdef NAME_REGISTRY_ENABLED
+    DOCTEST_SUBCASE("Global Instance")
+    {
+        Common::Name name("NameRegistryTest");
+        DOCTEST_CHECK_EQ(Common::NameRegistry::GetInstance().Lookup(name.GetHash()), "NameRegistryTest");
+        DOCTEST_CHECK(Common::NameRegistry::GetInstance().IsAbortingOnCollision());
+    }
+#endif
+}
+
+DOCTEST_TEST_CASE("Name Registry Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to compare interning and looking up names from multiple threads in
+        sharded registry, against unordered map of strings guarded by single mutex.
+    */
+
+    using HashType = Common::NameRegistry::HashType;
+
+    const std::size_t nameCount = 100000;
+    const std::size_t operationCount = 1000000;
+    const std::vector<std::string> strings = CreateStrings(nameCount, "BenchmarkName");
+
+    for(std::size_t threadCount : { 1, 2, 4, 8 })
+    {
+        const std::size_t operationsPerThread = operationCount / threadCount;
+
+        // Registering strings that are already registered is most common operation.
+        std::atomic<std::size_t> shardedLength = 0;
+        Common::NameRegistry registry;
+
+        const double shardedTime = Test::MeasureMilliseconds([&]()
+        {
+            RunThreads(threadCount, [&](std::size_t threadIndex)
+            {
+                std::size_t length = 0;
+                for(std::size_t i = 0; i < operationsPerThread; ++i)
+                {
+                    const std::string& string = strings[(i * 31 + threadIndex * 7919) % nameCount];
+                    length += registry.Lookup(registry.Register(string)).size();
+                }
+
+                shardedLength += length;
+            });
+        });
+
+        std::atomic<std::size_t> mutexLength = 0;
+        std::mutex mutex;
+        std::unordered_map<HashType, std::string> map;
+
+        const double mutexTime = Test::MeasureMilliseconds([&]()
+        {
+            RunThreads(threadCount, [&](std::size_t threadIndex)
+            {
+                std::size_t length = 0;
+                for(std::size_t i = 0; i < operationsPerThread; ++i)
+                {
+                    const std::string& string = strings[(i * 31 + threadIndex * 7919) % nameCount];
+                    const HashType hash = Common::StringHash<HashType>(string);
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto it = map.find(hash);
+                    if(it == map.end())
+                    {
+                        it = map.emplace(hash, string).first;
+                    }
+
+                    length += it->second.size();
+                }
+
+                mutexLength += length;
+            });
+        });
+
+        DOCTEST_CHECK_EQ(shardedLength.load(), mutexLength.load());
+
+        const std::string details = fmt::format("{} operations", operationCount);
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("Sharded registry, {} threads", threadCount),
+            shardedTime, {}, details));
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("Single mutex, {} threads", threadCount),
+            mutexTime, {}, details));
+    }
+}
@@ -5,7 +5,9 @@
 
 #define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
 #include <doctest/doctest.h>
+
 #include <Common/Utility.hpp>
+#include <Common/Test/Benchmark.hpp>
 
 DOCTEST_TEST_CASE("Utility")
 {
@@ -99,6 +101,27 @@ DOCTEST_TEST_CASE("Utility")
         DOCTEST_CHECK_NE(Common::StringHash<uint32_t>("Armored orange"), 0);
         DOCTEST_CHECK_NE(Common::StringHash<uint64_t>("Naked banana"),
             Common::StringHash<uint64_t>("Dressed apple"));
+
+        // Hashes calculated at compile time match reference xxHash64 values.
+        static_assert(Common::StringHash<uint64_t>("") == 0xEF46DB3751D8E999ull);
+        static_assert(Common::StringHash<uint64_t>("a") == 0xD24EC4F1A98C6E5Bull);
+        static_assert(Common::StringHash<uint64_t>("abc") == 0x44BC2CF5AD770999ull);
+
+        // Runtime path reading words from memory matches compile time path for all lengths.
+        std::string string;
+        for(std::size_t length = 0; length <= 100; ++length)
+        {
+            DOCTEST_CHECK_EQ(Common::StringHash<uint64_t>(string),
+                Common::Detail::XXHash64<Common::Detail::HashConstantReader>(
+                    string.data(), string.size()));
+
+            string.push_back(static_cast<char>('!' + length * 7 % 90));
+        }
+
+        constexpr uint64_t hash = Common::StringHash<uint64_t>("Armored orange");
+        DOCTEST_CHECK_EQ(Common::StringHash<uint64_t>(std::string("Armored orange")), hash);
+        DOCTEST_CHECK_EQ(Common::StringHash<uint32_t>("Armored orange"),
+            static_cast<uint32_t>(hash ^ (hash >> 32)));
     }
 
     DOCTEST_SUBCASE("CRC")
@@ -190,3 +213,83 @@ DOCTEST_TEST_CASE("Utility")
         }
     }
 }
+
+DOCTEST_TEST_CASE("String Hash Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure throughput of hashing runtime strings of various lengths,
+        compared to byte serial djb2 and FNV-1a hashes, as well as to compile time path of
+        current hash called at run time.
+    */
+
+    auto HashDjb2 = [](std::string_view string)
+    {
+        uint64_t hash = 5381;
+        for(char c : string)
+        {
+            hash = ((hash << 5) + hash) + c;
+        }
+
+        return hash;
+    };
+
+    auto HashFnv1a = [](std::string_view string)
+    {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for(char c : string)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+        }
+
+        return hash;
+    };
+
+    auto HashConstant = [](std::string_view string)
+    {
+        return Common::Detail::XXHash64<Common::Detail::HashConstantReader>(
+            string.data(), string.size());
+    };
+
+    auto HashRuntime = [](std::string_view string)
+    {
+        return Common::StringHash<uint64_t>(string);
+    };
+
+    const std::size_t totalBytes = 256 * 1024 * 1024;
+
+    for(std::size_t length : { 8, 16, 32, 64, 256, 1024, 4096 })
+    {
+        std::vector<std::string> strings;
+        for(std::size_t i = 0; i < 64; ++i)
+        {
+            std::string& string = strings.emplace_back(length, ' ');
+            for(std::size_t j = 0; j < length; ++j)
+            {
+                string[j] = static_cast<char>('a' + (i * 31 + j * 7) % 26);
+            }
+        }
+
+        const std::size_t iterationCount = totalBytes / length;
+
+        auto Measure = [&](const char* name, auto&& function)
+        {
+            uint64_t result = 0;
+            const double time = Test::MeasureMilliseconds([&]()
+            {
+                for(std::size_t i = 0; i < iterationCount; ++i)
+                {
+                    result += function(strings[i % strings.size()]);
+                }
+            });
+
+            DOCTEST_CHECK_NE(result, 0);
+            DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("Length {}, {}", length, name), time, {},
+                fmt::format("{:.0f} MB/s", totalBytes / (1024.0 * 1024.0) / (time / 1000.0))));
+        };
+
+        Measure("djb2", HashDjb2);
+        Measure("FNV-1a", HashFnv1a);
+        Measure("xxHash64 constant path", HashConstant);
+        Measure("xxHash64 runtime path", HashRuntime);
+    }
+}
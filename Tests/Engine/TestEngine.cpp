@@ -0,0 +1,14 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_IMPLEMENT
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+int main(const int argc, char* argv[])
+{
+    // Reflection is initialized by engine root.
+    return doctest::Context(argc, argv).run();
+}
@@ -0,0 +1,38 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#pragma once
+
+#include <Engine.hpp>
+#include <Script/ScriptState.hpp>
+
+/*
+    Test Engine Header
+
+    Factories shared by engine tests. Engine is created headless, with config variables of test
+    applied after defaults so they can override them. Recording engine also records OpenGL commands
+    in place of missing render context.
+*/
+
+namespace Test
+{
+    inline std::unique_ptr<Engine::Root> CreateEngine(Engine::Root::ConfigVariables configVars = {})
+    {
+        configVars.insert(configVars.begin(), { "engine.headless", "true" });
+        return Engine::Root::Create(configVars).UnwrapOr(nullptr);
+    }
+
+    inline std::unique_ptr<Engine::Root> CreateRecordingEngine(Engine::Root::ConfigVariables configVars = {})
+    {
+        configVars.insert(configVars.begin(), { "render.recordCommands", "true" });
+        return CreateEngine(std::move(configVars));
+    }
+
+    inline std::unique_ptr<Script::ScriptState> CreateScriptState(
+        const Script::ScriptState::CreateFromParams& params = {})
+    {
+        return Script::ScriptState::Create(params).UnwrapOr(nullptr);
+    }
+}
@@ -0,0 +1,121 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <Core/ReflectionGenerated.hpp>
+#include <System/ReflectionGenerated.hpp>
+#include <Game/ReflectionGenerated.hpp>
+#include <System/Window.hpp>
+#include <System/Timer.hpp>
+#include <Game/GameFramework.hpp>
+#include <Game/GameInstance.hpp>
+#include <Game/GameState.hpp>
+#include <Game/EntitySystem.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    class HeadlessTestState final : public Game::GameState
+    {
+    public:
+        HeadlessTestState(System::Window* window, int closeAfterFrames)
+            : m_window(window), m_closeAfterFrames(closeAfterFrames)
+        {
+            m_gameInstance = Game::GameInstance::Create().UnwrapOr(nullptr);
+            DOCTEST_REQUIRE(m_gameInstance);
+        }
+
+        void Update(const float timeDelta) override
+        {
+            updateCount += 1;
+            updateTime += timeDelta;
+
+            if(m_closeAfterFrames > 0 && updateCount >= m_closeAfterFrames)
+            {
+                m_window->Close();
+            }
+        }
+
+        void Tick(const float tickTime) override
+        {
+            // Game instance has been ticked before game state.
+            auto* entitySystem = m_gameInstance->GetSystems().Locate<Game::EntitySystem>();
+            DOCTEST_CHECK_EQ(entitySystem->GetEntityCount(), static_cast<std::size_t>(tickCount));
+            entitySystem->CreateEntity();
+
+            tickCount += 1;
+        }
+
+        void Draw(const float timeAlpha) override
+        {
+            drawCount += 1;
+        }
+
+        Game::GameInstance* GetGameInstance() const override
+        {
+            return m_gameInstance.get();
+        }
+
+    public:
+        int updateCount = 0;
+        int tickCount = 0;
+        int drawCount = 0;
+        double updateTime = 0.0;
+
+    private:
+        std::unique_ptr<Game::GameInstance> m_gameInstance;
+        System::Window* m_window = nullptr;
+        int m_closeAfterFrames = 0;
+    };
+}
+
+DOCTEST_TEST_CASE("Headless Engine")
+{
+    std::unique_ptr<Engine::Root> engine = Test::CreateEngine(
+    {
+        { "engine.frameLimit", "8" },
+        { "timer.syntheticStep", "0.25" },
+    });
+    DOCTEST_REQUIRE(engine);
+    DOCTEST_CHECK(engine->IsHeadless());
+
+    auto* window = engine->GetSystems().Locate<System::Window>();
+    DOCTEST_REQUIRE(window);
+    DOCTEST_CHECK(window->IsHeadless());
+    DOCTEST_CHECK(window->ShouldClose());
+
+    auto* timer = engine->GetSystems().Locate<System::Timer>();
+    DOCTEST_REQUIRE(timer);
+    DOCTEST_CHECK(timer->IsSynthetic());
+
+    auto* gameFramework = engine->GetSystems().Locate<Game::GameFramework>();
+    DOCTEST_REQUIRE(gameFramework);
+
+    DOCTEST_SUBCASE("Frame Limit")
+    {
+        auto gameState = std::make_shared<HeadlessTestState>(window, 0);
+        DOCTEST_REQUIRE(gameFramework->ChangeGameState(gameState));
+        DOCTEST_CHECK_EQ(engine->Run(), 0);
+
+        DOCTEST_CHECK_EQ(gameState->updateCount, 8);
+        DOCTEST_CHECK_EQ(gameState->tickCount, 8);
+        DOCTEST_CHECK_EQ(gameState->drawCount, 8);
+        DOCTEST_CHECK_EQ(gameState->updateTime, doctest::Approx(2.0));
+    }
+
+    DOCTEST_SUBCASE("Window Close")
+    {
+        auto gameState = std::make_shared<HeadlessTestState>(window, 3);
+        DOCTEST_REQUIRE(gameFramework->ChangeGameState(gameState));
+        DOCTEST_CHECK_EQ(engine->Run(), 0);
+
+        DOCTEST_CHECK_FALSE(window->ShouldClose());
+        DOCTEST_CHECK_EQ(gameState->updateCount, 3);
+        DOCTEST_CHECK_EQ(gameState->updateTime, doctest::Approx(0.75));
+    }
+}
@@ -0,0 +1,157 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <random>
+#include <Engine.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/Sprite/SpriteRenderer.hpp>
+#include <Graphics/Sprite/SpriteDrawList.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    std::unique_ptr<Engine::Root> CreateRecordingEngine(const char* compactInstances)
+    {
+        return Test::CreateRecordingEngine(
+        {
+            { "render.spriteBatchSize", "128" },
+            { "render.spriteCompactInstances", compactInstances },
+        });
+    }
+
+    void FillSpriteList(Graphics::SpriteDrawList& spriteList, std::size_t spriteCount)
+    {
+        std::mt19937 random(1337);
+        std::uniform_real_distribution<float> positionDistribution(-1000.0f, 1000.0f);
+
+        spriteList.ReserveSprites(spriteCount);
+
+        for(std::size_t i = 0; i < spriteCount; ++i)
+        {
+            Graphics::Sprite sprite;
+            sprite.info.transparent = i % 3 == 0;
+            sprite.data.transform = glm::translate(glm::mat4(1.0f), glm::vec3(
+                positionDistribution(random), positionDistribution(random), 0.0f));
+            spriteList.AddSprite(sprite);
+        }
+
+        spriteList.SortSprites();
+    }
+}
+
+DOCTEST_TEST_CASE("Recorded Sprite Renderer")
+{
+    std::unique_ptr<Engine::Root> engine = CreateRecordingEngine("false");
+    DOCTEST_REQUIRE(engine);
+    DOCTEST_CHECK(engine->IsHeadless());
+    DOCTEST_CHECK(engine->HasRenderer());
+
+    auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+    DOCTEST_REQUIRE(recorder);
+    DOCTEST_CHECK(recorder->IsInstalled());
+
+    auto* spriteRenderer = engine->GetSystems().Locate<Graphics::SpriteRenderer>();
+    DOCTEST_REQUIRE(spriteRenderer);
+
+    DOCTEST_SUBCASE("Golden Stream")
+    {
+        Graphics::SpriteDrawList spriteList;
+        FillSpriteList(spriteList, 4);
+
+        recorder->BeginFrame();
+        spriteRenderer->DrawSprites(spriteList, glm::mat4(1.0f));
+        recorder->EndFrame();
+
+        // Opaque batch is drawn first, followed by transparent batch.
+        const char* expectedStream =
+            "glBlendFuncSeparate(0x0302, 0x0303, 0x0302, 0x0303)\n"
+            "glBindVertexArray(3)\n"
+            "glUseProgram(7)\n"
+            "glUniformMatrix4fv(0, 1, 0)\n"
+            "glUniform1i(1, 0)\n"
+            "glBindBuffer(0x8892, 2)\n"
+            "glBufferData(0x8892, 224, 0x88e0)\n"
+            "glBindBuffer(0x8892, 0)\n"
+            "glDrawArraysInstanced(0x0005, 0, 4, 2)\n"
+            "glBindBuffer(0x8892, 2)\n"
+            "glBufferData(0x8892, 224, 0x88e0)\n"
+            "glBindBuffer(0x8892, 0)\n"
+            "glEnable(0x0be2)\n"
+            "glDepthMask(0)\n"
+            "glDrawArraysInstanced(0x0005, 0, 4, 2)\n"
+            "glDisable(0x0be2)\n"
+            "glBindVertexArray(0)\n"
+            "glUseProgram(0)\n"
+            "glDepthMask(1)\n"
+            "glBlendFuncSeparate(0x0001, 0x0000, 0x0001, 0x0000)\n";
+
+        DOCTEST_CHECK_EQ(recorder->FormatCommands(), expectedStream);
+    }
+
+    DOCTEST_SUBCASE("Frame Stats")
+    {
+        Graphics::SpriteDrawList spriteList;
+        FillSpriteList(spriteList, 1000);
+
+        recorder->BeginFrame();
+        spriteRenderer->DrawSprites(spriteList, glm::mat4(1.0f));
+        recorder->EndFrame();
+
+        // Opaque and transparent sprites are split into separate instanced batches.
+        const Graphics::CommandRecorder::FrameStats& stats = recorder->GetLastFrameStats();
+        DOCTEST_CHECK_EQ(stats.drawCalls, 3 + 6);
+        DOCTEST_CHECK_EQ(stats.drawnInstances, 1000);
+        DOCTEST_CHECK_EQ(stats.bufferBytesUploaded, 1000 * sizeof(Graphics::Sprite::Data));
+        DOCTEST_CHECK_EQ(stats.uniformUpdates, 2);
+        DOCTEST_CHECK_EQ(stats.programSwitches, 2);
+    }
+}
+
+DOCTEST_TEST_CASE("Recorded Sprite Renderer Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure CPU cost of submitting 100k sprites
+        with full and compact instance layouts on recording backend.
+    */
+
+    const std::size_t spriteCount = 100000;
+    const int frameCount = 50;
+
+    for(const char* compactInstances : { "false", "true" })
+    {
+        std::unique_ptr<Engine::Root> engine = CreateRecordingEngine(compactInstances);
+        DOCTEST_REQUIRE(engine);
+
+        auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+        auto* spriteRenderer = engine->GetSystems().Locate<Graphics::SpriteRenderer>();
+        recorder->SetRecordingCommands(false);
+
+        Graphics::SpriteDrawList spriteList;
+        FillSpriteList(spriteList, spriteCount);
+
+        double drawTime = 0.0;
+        for(int frame = 0; frame < frameCount; ++frame)
+        {
+            recorder->BeginFrame();
+            drawTime += Test::MeasureMilliseconds([&]()
+            {
+                spriteRenderer->DrawSprites(spriteList, glm::mat4(1.0f));
+            });
+            recorder->EndFrame();
+        }
+
+        const Graphics::CommandRecorder::FrameStats& stats = recorder->GetLastFrameStats();
+        DOCTEST_CHECK_EQ(stats.drawnInstances, spriteCount);
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("Draw (compact instances: {})",
+            compactInstances), drawTime / frameCount, "frame"));
+        DOCTEST_MESSAGE(fmt::format("Commands: {}, draw calls: {}, state changes: {} ({} redundant), "
+            "uploaded: {} KiB", stats.commandCount, stats.drawCalls, stats.stateChanges,
+            stats.redundantStateChanges, stats.bufferBytesUploaded / 1024));
+    }
+}
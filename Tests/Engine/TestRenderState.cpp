@@ -0,0 +1,197 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/RenderContext.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    void DrawWithStateChanges(Graphics::RenderContext& renderContext, GLuint program)
+    {
+        Graphics::RenderState& renderState = renderContext.PushState();
+        renderState.Enable(GL_BLEND);
+        renderState.BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+        renderState.UseProgram(program);
+        renderState.DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        renderContext.PopState();
+    }
+}
+
+DOCTEST_TEST_CASE("Render State Indices")
+{
+    static_assert(Graphics::OpenGL::GetCapabilityIndex(GL_DEPTH_TEST) == 2);
+    static_assert(Graphics::OpenGL::GetCapabilityIndex(GL_DITHER) == Graphics::OpenGL::CapabilityCount);
+    static_assert(Graphics::OpenGL::GetBufferBindingTargetIndex(GL_ELEMENT_ARRAY_BUFFER) == 1);
+    static_assert(Graphics::OpenGL::GetPixelStoreParameterIndex(GL_UNPACK_ALIGNMENT) == 1);
+
+    for(std::size_t i = 0; i < Graphics::OpenGL::CapabilityCount; ++i)
+    {
+        DOCTEST_CHECK_EQ(Graphics::OpenGL::GetCapabilityIndex(Graphics::OpenGL::Capabilities[i]), i);
+    }
+}
+
+DOCTEST_TEST_CASE("Render State Dirty Groups")
+{
+    std::unique_ptr<Engine::Root> engine = Test::CreateRecordingEngine();
+    DOCTEST_REQUIRE(engine);
+
+    auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+    auto* renderContext = engine->GetSystems().Locate<Graphics::RenderContext>();
+    Graphics::RenderState& renderState = renderContext->GetState();
+
+    DOCTEST_SUBCASE("Push And Pop")
+    {
+        recorder->BeginFrame();
+        renderContext->PushState();
+        DOCTEST_CHECK_EQ(renderState.GetDirtyGroups(), Graphics::StateGroups::None);
+
+        renderState.Enable(GL_BLEND);
+        renderState.UseProgram(7);
+        renderState.UseProgram(0);
+        DOCTEST_CHECK_EQ(renderState.GetDirtyGroups(),
+            Graphics::StateGroups::Capabilities | Graphics::StateGroups::Program);
+
+        renderContext->PopState();
+        recorder->EndFrame();
+
+        // Program was already changed back, so only capability is restored.
+        const char* expectedStream =
+            "glEnable(0x0be2)\n"
+            "glUseProgram(7)\n"
+            "glUseProgram(0)\n"
+            "glDisable(0x0be2)\n";
+
+        DOCTEST_CHECK_EQ(recorder->FormatCommands(), expectedStream);
+        DOCTEST_CHECK_EQ(renderContext->GetPushedStateCount(), 0);
+        DOCTEST_CHECK_FALSE(renderState.IsEnabled(GL_BLEND));
+    }
+
+    DOCTEST_SUBCASE("Nested")
+    {
+        renderContext->PushState();
+        renderState.DepthMask(GL_FALSE);
+
+        renderContext->PushState();
+        renderState.DepthMask(GL_TRUE);
+        renderState.Viewport(0, 0, 64, 64);
+        renderState.BindBuffer(GL_ARRAY_BUFFER, 5);
+        DOCTEST_CHECK_EQ(renderContext->GetPushedStateCount(), 2);
+
+        // Inner pop restores values from before inner push and keeps outer changes dirty.
+        renderContext->PopState();
+        DOCTEST_CHECK_EQ(renderState.GetDepthMask(), GL_FALSE);
+        DOCTEST_CHECK_EQ(renderState.GetBufferBinding(GL_ARRAY_BUFFER), 0);
+        DOCTEST_CHECK_EQ(renderState.GetViewport(), std::make_tuple(0, 0, 0, 0));
+        DOCTEST_CHECK_EQ(renderState.GetDirtyGroups(), Graphics::StateGroups::DepthMask);
+
+        renderContext->PopState();
+        DOCTEST_CHECK_EQ(renderState.GetDepthMask(), GL_TRUE);
+        DOCTEST_CHECK_EQ(renderContext->GetPushedStateCount(), 0);
+    }
+
+    DOCTEST_SUBCASE("Unchanged")
+    {
+        recorder->BeginFrame();
+        renderContext->PushState();
+        renderContext->PopState();
+        recorder->EndFrame();
+
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().commandCount, 0);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().queries, 0);
+    }
+
+    DOCTEST_SUBCASE("Error Checks")
+    {
+        DOCTEST_REQUIRE(Graphics::OpenGL::AreErrorChecksEnabled());
+
+        recorder->BeginFrame();
+        DrawWithStateChanges(*renderContext, 3);
+        recorder->EndFrame();
+
+        const Graphics::CommandRecorder::FrameStats checkedStats = recorder->GetLastFrameStats();
+        DOCTEST_CHECK_EQ(checkedStats.queries, checkedStats.commandCount);
+
+        Graphics::OpenGL::SetErrorChecks(false);
+        recorder->BeginFrame();
+        DrawWithStateChanges(*renderContext, 3);
+        recorder->EndFrame();
+        Graphics::OpenGL::SetErrorChecks(Graphics::OpenGL::DefaultErrorChecks);
+
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().commandCount, checkedStats.commandCount);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().queries, 0);
+    }
+}
+
+DOCTEST_TEST_CASE("Render State Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure CPU cost of push and pop pairs around draws that change
+        few states, restoring either all state groups or only dirty ones, with and without
+        error checks. Recording backend counts issued GL calls without storing them.
+    */
+
+    std::unique_ptr<Engine::Root> engine = Test::CreateRecordingEngine();
+    DOCTEST_REQUIRE(engine);
+
+    auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+    auto* renderContext = engine->GetSystems().Locate<Graphics::RenderContext>();
+    Graphics::RenderState& renderState = renderContext->GetState();
+    recorder->SetRecordingCommands(false);
+
+    const int pairCount = 10000;
+    const int frameCount = 20;
+
+    auto Measure = [&](const char* name, auto pushPop)
+    {
+        double frameTime = 0.0;
+        for(int frame = 0; frame < frameCount; ++frame)
+        {
+            recorder->BeginFrame();
+            frameTime += Test::MeasureMilliseconds([&]()
+            {
+                for(int i = 0; i < pairCount; ++i)
+                {
+                    pushPop(static_cast<GLuint>(i % 8 + 1));
+                }
+            });
+            recorder->EndFrame();
+        }
+
+        const Graphics::CommandRecorder::FrameStats& stats = recorder->GetLastFrameStats();
+        DOCTEST_MESSAGE(Test::FormatBenchmark(name, frameTime / frameCount, "frame",
+            fmt::format("{} push/pop pairs, {} commands, {} queries", pairCount, stats.commandCount, stats.queries)));
+    };
+
+    // Restores all groups, which is what popping state did before dirty tracking.
+    Graphics::RenderState pushedState;
+    auto FullRestore = [&](GLuint program)
+    {
+        pushedState = renderState;
+        renderState.Enable(GL_BLEND);
+        renderState.BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+        renderState.UseProgram(program);
+        renderState.DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        renderState.Apply(pushedState, Graphics::StateGroups::All);
+    };
+
+    auto DirtyRestore = [&](GLuint program)
+    {
+        DrawWithStateChanges(*renderContext, program);
+    };
+
+    Measure("Full restore with error checks", FullRestore);
+    Measure("Dirty restore with error checks", DirtyRestore);
+
+    Graphics::OpenGL::SetErrorChecks(false);
+    Measure("Full restore", FullRestore);
+    Measure("Dirty restore", DirtyRestore);
+    Graphics::OpenGL::SetErrorChecks(Graphics::OpenGL::DefaultErrorChecks);
+}
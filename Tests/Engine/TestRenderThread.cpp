@@ -0,0 +1,452 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <Engine.hpp>
+#include <System/Window.hpp>
+#include <Graphics/RenderContext.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/Texture.hpp>
+#include <Renderer/GameRenderer.hpp>
+#include <Renderer/RenderThread.hpp>
+#include <Game/GameFramework.hpp>
+#include <Game/GameInstance.hpp>
+#include <Game/GameState.hpp>
+#include <Game/EntitySystem.hpp>
+#include <Game/ComponentSystem.hpp>
+#include <Game/Systems/IdentitySystem.hpp>
+#include <Game/Components/TransformComponent.hpp>
+#include <Game/Components/CameraComponent.hpp>
+#include <Game/Components/SpriteComponent.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    using Clock = Test::Stopwatch::Clock;
+
+    void BusyWait(Clock::duration duration)
+    {
+        // Sleeping is too coarse to emulate workload of few milliseconds.
+        Clock::time_point end = Clock::now() + duration;
+        while(Clock::now() < end)
+        {
+        }
+    }
+
+    class ContextTracker
+    {
+    public:
+        void Acquire()
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            errors += m_owner != std::thread::id() ? 1 : 0;
+            m_owner = std::this_thread::get_id();
+        }
+
+        void Release()
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            errors += m_owner != std::this_thread::get_id() ? 1 : 0;
+            m_owner = std::thread::id();
+        }
+
+        bool IsOwnedByThisThread()
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            return m_owner == std::this_thread::get_id();
+        }
+
+        std::atomic<int> errors = 0;
+
+    private:
+        std::mutex m_mutex;
+        std::thread::id m_owner = std::this_thread::get_id();
+    };
+
+    class SpriteTestState final : public Game::GameState
+    {
+    public:
+        SpriteTestState(int spriteCount)
+        {
+            m_gameInstance = Game::GameInstance::Create().UnwrapOr(nullptr);
+            DOCTEST_REQUIRE(m_gameInstance);
+
+            auto* entitySystem = m_gameInstance->GetSystems().Locate<Game::EntitySystem>();
+            auto* componentSystem = m_gameInstance->GetSystems().Locate<Game::ComponentSystem>();
+            auto* identitySystem = m_gameInstance->GetSystems().Locate<Game::IdentitySystem>();
+
+            Game::EntityHandle cameraEntity = entitySystem->CreateEntity().Unwrap();
+            identitySystem->SetEntityName(cameraEntity, "Camera");
+            componentSystem->Create<Game::TransformComponent>(cameraEntity).Unwrap();
+            auto* camera = componentSystem->Create<Game::CameraComponent>(cameraEntity).Unwrap();
+            camera->SetupOrthogonal(glm::vec2(16.0f, 9.0f), 0.1f, 1000.0f);
+
+            for(int i = 0; i < spriteCount; ++i)
+            {
+                Game::EntityHandle entity = entitySystem->CreateEntity().Unwrap();
+                auto* transform = componentSystem->Create<Game::TransformComponent>(entity).Unwrap();
+                transform->SetPosition(glm::vec3(i, 0.0f, 0.0f));
+
+                auto* sprite = componentSystem->Create<Game::SpriteComponent>(entity).Unwrap();
+                sprite->SetTransparent(i % 2 == 0);
+            }
+
+            // Process entity creation commands.
+            m_gameInstance->Tick(0.0f);
+        }
+
+        void Update(const float timeDelta) override
+        {
+        }
+
+        void Tick(const float tickTime) override
+        {
+            BusyWait(tickCost);
+
+            auto* componentSystem = m_gameInstance->GetSystems().Locate<Game::ComponentSystem>();
+            for(auto& transform : componentSystem->GetPool<Game::TransformComponent>())
+            {
+                transform.SetPosition(transform.GetPosition() + glm::vec3(0.0f, 1.0f, 0.0f));
+            }
+        }
+
+        void Draw(const float timeAlpha) override
+        {
+        }
+
+        Game::GameInstance* GetGameInstance() const override
+        {
+            return m_gameInstance.get();
+        }
+
+    public:
+        Clock::duration tickCost = Clock::duration::zero();
+
+    private:
+        std::unique_ptr<Game::GameInstance> m_gameInstance;
+    };
+
+    std::unique_ptr<Engine::Root> CreateRecordingEngine(const char* threaded, const char* frameLimit)
+    {
+        return Test::CreateRecordingEngine(
+        {
+            { "engine.frameLimit", frameLimit },
+            { "timer.syntheticStep", "0.25" },
+            { "render.threaded", threaded },
+        });
+    }
+}
+
+DOCTEST_TEST_CASE("Render Thread")
+{
+    ContextTracker context;
+    std::vector<uint64_t> submittedFrames;
+    std::thread::id submitThread;
+
+    Renderer::RenderThread::CreateFromParams params;
+    params.acquireContext = [&context]() { context.Acquire(); };
+    params.releaseContext = [&context]() { context.Release(); };
+    params.submitCallback = [&](const Renderer::FramePacket& packet)
+    {
+        context.errors += context.IsOwnedByThisThread() ? 0 : 1;
+        submittedFrames.push_back(packet.frameIndex);
+        submitThread = std::this_thread::get_id();
+    };
+
+    DOCTEST_SUBCASE("Invalid Arguments")
+    {
+        params.frameLatency = 0;
+        DOCTEST_CHECK_FALSE(Renderer::RenderThread::Create(params));
+
+        params.frameLatency = Renderer::RenderThread::MaxFrameLatency + 1;
+        DOCTEST_CHECK_FALSE(Renderer::RenderThread::Create(params));
+
+        params.frameLatency = 1;
+        params.submitCallback = nullptr;
+        DOCTEST_CHECK_FALSE(Renderer::RenderThread::Create(params));
+    }
+
+    DOCTEST_SUBCASE("Single Threaded")
+    {
+        params.threaded = false;
+
+        auto renderThread = Renderer::RenderThread::Create(params).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(renderThread);
+        DOCTEST_CHECK_FALSE(renderThread->IsThreaded());
+        DOCTEST_CHECK_EQ(renderThread->GetFrameLatency(), 0);
+
+        // Packet is submitted on game thread as soon as it is published.
+        for(int frame = 0; frame < 3; ++frame)
+        {
+            renderThread->BeginPacket();
+            renderThread->EndPacket();
+            DOCTEST_CHECK_EQ(submittedFrames.size(), frame + 1);
+        }
+
+        DOCTEST_CHECK_EQ(submitThread, std::this_thread::get_id());
+        DOCTEST_CHECK_EQ(renderThread->GetStats().submittedFrames, 3);
+    }
+
+    for(uint32_t frameLatency = 1; frameLatency <= Renderer::RenderThread::MaxFrameLatency; ++frameLatency)
+    {
+        DOCTEST_SUBCASE(fmt::format("Frame Latency {}", frameLatency).c_str())
+        {
+            params.frameLatency = frameLatency;
+
+            auto renderThread = Renderer::RenderThread::Create(params).UnwrapOr(nullptr);
+            DOCTEST_REQUIRE(renderThread);
+            DOCTEST_CHECK(renderThread->IsThreaded());
+            DOCTEST_CHECK_EQ(renderThread->GetFrameLatency(), frameLatency);
+
+            // Game thread never gets more frames ahead than allowed latency.
+            const int frameCount = 32;
+            for(int frame = 0; frame < frameCount; ++frame)
+            {
+                Renderer::FramePacket& packet = renderThread->BeginPacket();
+                DOCTEST_CHECK_EQ(packet.frameIndex, frame);
+
+                Renderer::RenderThread::Stats stats = renderThread->GetStats();
+                DOCTEST_CHECK_LE(stats.publishedFrames - stats.submittedFrames, frameLatency);
+                renderThread->EndPacket();
+            }
+
+            renderThread->Flush();
+            DOCTEST_CHECK_EQ(renderThread->GetStats().submittedFrames, frameCount);
+            DOCTEST_CHECK_NE(submitThread, std::this_thread::get_id());
+            DOCTEST_CHECK_FALSE(context.IsOwnedByThisThread());
+
+            // Packets are submitted in order they were published.
+            std::vector<uint64_t> expectedFrames(frameCount);
+            std::iota(expectedFrames.begin(), expectedFrames.end(), 0);
+            DOCTEST_CHECK_EQ(submittedFrames, expectedFrames);
+        }
+    }
+
+    DOCTEST_SUBCASE("Context Ownership")
+    {
+        auto renderThread = Renderer::RenderThread::Create(params).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(renderThread);
+
+        // Context stays with game thread until first packet is published.
+        DOCTEST_CHECK(context.IsOwnedByThisThread());
+        renderThread->BeginPacket();
+        DOCTEST_CHECK(context.IsOwnedByThisThread());
+        renderThread->EndPacket();
+
+        // Acquired context is handed back with next packet.
+        renderThread->AcquireContext();
+        DOCTEST_CHECK(context.IsOwnedByThisThread());
+        DOCTEST_CHECK_EQ(submittedFrames.size(), 1);
+
+        renderThread->AcquireContext();
+        DOCTEST_CHECK(context.IsOwnedByThisThread());
+
+        renderThread->BeginPacket();
+        renderThread->EndPacket();
+        renderThread->Flush();
+        DOCTEST_CHECK_FALSE(context.IsOwnedByThisThread());
+
+        // Destroyed render thread returns context.
+        renderThread.reset();
+        DOCTEST_CHECK(context.IsOwnedByThisThread());
+        DOCTEST_CHECK_EQ(submittedFrames.size(), 2);
+    }
+
+    DOCTEST_CHECK_EQ(context.errors, 0);
+}
+
+DOCTEST_TEST_CASE("Threaded Game Renderer")
+{
+    // Same commands are submitted with and without render thread. Object names are not compared,
+    // as they depend on resources created by engines that ran before in the same process.
+    std::vector<Graphics::CommandRecorder::CommandType> recordedCommands[2];
+    Graphics::CommandRecorder::FrameStats recordedStats[2];
+    const char* threadedValues[2] = { "false", "true" };
+
+    for(int i = 0; i < 2; ++i)
+    {
+        std::unique_ptr<Engine::Root> engine = CreateRecordingEngine(threadedValues[i], "4");
+        DOCTEST_REQUIRE(engine);
+
+        auto* gameRenderer = engine->GetSystems().Locate<Renderer::GameRenderer>();
+        DOCTEST_REQUIRE(gameRenderer);
+        DOCTEST_CHECK_EQ(gameRenderer->GetRenderThread()->IsThreaded(), i == 1);
+
+        auto* gameFramework = engine->GetSystems().Locate<Game::GameFramework>();
+        DOCTEST_REQUIRE(gameFramework->ChangeGameState(std::make_shared<SpriteTestState>(8)));
+        DOCTEST_CHECK_EQ(engine->Run(), 0);
+
+        // Last frame has been submitted once main loop returns.
+        Renderer::RenderThread::Stats stats = gameRenderer->GetRenderThread()->GetStats();
+        DOCTEST_CHECK_EQ(stats.publishedFrames, 4);
+        DOCTEST_CHECK_EQ(stats.submittedFrames, 4);
+
+        auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+        for(const Graphics::CommandRecorder::Command& command : recorder->GetCommands())
+        {
+            recordedCommands[i].push_back(command.type);
+        }
+
+        recordedStats[i] = recorder->GetLastFrameStats();
+    }
+
+    DOCTEST_CHECK_FALSE(recordedCommands[0].empty());
+    DOCTEST_CHECK(recordedCommands[0] == recordedCommands[1]);
+    DOCTEST_CHECK_EQ(recordedStats[0].commandCount, recordedStats[1].commandCount);
+    DOCTEST_CHECK_EQ(recordedStats[0].drawnInstances, 8);
+    DOCTEST_CHECK_EQ(recordedStats[1].drawnInstances, 8);
+}
+
+DOCTEST_TEST_CASE("Threaded Resources")
+{
+    std::unique_ptr<Engine::Root> engine = CreateRecordingEngine("true", "1");
+    DOCTEST_REQUIRE(engine);
+
+    auto* renderContext = engine->GetSystems().Locate<Graphics::RenderContext>();
+    auto* gameRenderer = engine->GetSystems().Locate<Renderer::GameRenderer>();
+    Renderer::RenderThread* renderThread = gameRenderer->GetRenderThread();
+    DOCTEST_REQUIRE(renderThread->IsThreaded());
+
+    // Resources created on game thread take context back from render thread.
+    renderThread->BeginPacket();
+    renderThread->EndPacket();
+    DOCTEST_CHECK_FALSE(renderThread->HasContext());
+
+    const uint8_t pixels[4 * 4 * 4] = {};
+    Graphics::Texture::CreateFromParams textureParams;
+    textureParams.renderContext = renderContext;
+    textureParams.width = 4;
+    textureParams.height = 4;
+    textureParams.format = GL_RGBA;
+    textureParams.data = pixels;
+
+    auto texture = Graphics::Texture::Create(textureParams).UnwrapOr(nullptr);
+    DOCTEST_REQUIRE(texture);
+    DOCTEST_CHECK(renderThread->HasContext());
+    DOCTEST_CHECK_EQ(renderThread->GetStats().submittedFrames, 1);
+
+    // Same applies when they are destroyed.
+    renderThread->BeginPacket();
+    renderThread->EndPacket();
+    DOCTEST_CHECK_FALSE(renderThread->HasContext());
+
+    texture.reset();
+    DOCTEST_CHECK(renderThread->HasContext());
+    DOCTEST_CHECK_EQ(renderThread->GetStats().submittedFrames, 2);
+}
+
+DOCTEST_TEST_CASE("Interface Frame Packet")
+{
+    std::unique_ptr<Engine::Root> engine = CreateRecordingEngine("true", "1");
+    DOCTEST_REQUIRE(engine);
+
+    auto* gameRenderer = engine->GetSystems().Locate<Renderer::GameRenderer>();
+    Renderer::RenderThread* renderThread = gameRenderer->GetRenderThread();
+
+    // Interface added to packet of current frame is seen on render thread.
+    std::atomic<std::size_t> interfaceVertices = 0;
+    std::thread::id submitThread;
+
+    Event::Receiver<void(const Renderer::FramePacket&)> packetSubmitted;
+    packetSubmitted.Bind([&](const Renderer::FramePacket& packet)
+    {
+        interfaceVertices += packet.interfaceVertices.size();
+        submitThread = std::this_thread::get_id();
+    });
+
+    DOCTEST_REQUIRE(packetSubmitted.Subscribe(gameRenderer->events.packetSubmitted));
+
+    // Packet is started without clearing when no game instance has been drawn.
+    Renderer::FramePacket& packet = gameRenderer->GetFramePacket();
+    DOCTEST_CHECK_EQ(&gameRenderer->GetFramePacket(), &packet);
+    DOCTEST_CHECK_EQ(packet.clearMask, 0);
+    packet.interfaceVertices.resize(3);
+
+    auto* gameFramework = engine->GetSystems().Locate<Game::GameFramework>();
+    DOCTEST_REQUIRE(gameFramework->ChangeGameState(std::make_shared<SpriteTestState>(1)));
+    DOCTEST_CHECK_EQ(engine->Run(), 0);
+
+    // Open packet is published at the end of frame, before packet of drawn game instance.
+    DOCTEST_CHECK_EQ(renderThread->GetStats().submittedFrames, 2);
+    DOCTEST_CHECK_EQ(interfaceVertices, 3);
+    DOCTEST_CHECK_NE(submitThread, std::this_thread::get_id());
+}
+
+DOCTEST_TEST_CASE("Render Thread Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure frame rate of game loop where tick and render submission
+        each cost about half of frame at 60 FPS, with and without render thread.
+    */
+
+    const Clock::duration halfFrame = std::chrono::microseconds(8333);
+    const int frameCount = 120;
+
+    auto Measure = [&](const char* name, bool threaded, uint32_t frameLatency)
+    {
+        Renderer::RenderThread::CreateFromParams params;
+        params.threaded = threaded;
+        params.frameLatency = frameLatency;
+        params.submitCallback = [&](const Renderer::FramePacket& packet)
+        {
+            BusyWait(halfFrame);
+        };
+
+        auto renderThread = Renderer::RenderThread::Create(params).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(renderThread);
+
+        const double seconds = Test::MeasureMilliseconds([&]()
+        {
+            for(int frame = 0; frame < frameCount; ++frame)
+            {
+                BusyWait(halfFrame);
+                renderThread->BeginPacket();
+                renderThread->EndPacket();
+            }
+
+            renderThread->Flush();
+        }) / 1000.0;
+
+        Renderer::RenderThread::Stats stats = renderThread->GetStats();
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("{} game wait", name),
+            stats.gameWaitSeconds * 1000.0 / frameCount, "frame", fmt::format("{:.1f} FPS", frameCount / seconds)));
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("{} render wait", name),
+            stats.renderWaitSeconds * 1000.0 / frameCount, "frame"));
+    };
+
+    Measure("Single threaded", false, 1);
+    Measure("Render thread (double buffered)", true, 1);
+    Measure("Render thread (triple buffered)", true, 2);
+
+    // Same comparison for full engine loop, where submission of recorded sprites is cheap.
+    for(const char* threaded : { "false", "true" })
+    {
+        std::unique_ptr<Engine::Root> engine = CreateRecordingEngine(threaded, "120");
+        DOCTEST_REQUIRE(engine);
+
+        auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+        recorder->SetRecordingCommands(false);
+
+        auto gameState = std::make_shared<SpriteTestState>(1000);
+        gameState->tickCost = halfFrame;
+
+        auto* gameFramework = engine->GetSystems().Locate<Game::GameFramework>();
+        DOCTEST_REQUIRE(gameFramework->ChangeGameState(gameState));
+
+        Test::Stopwatch stopwatch;
+        DOCTEST_CHECK_EQ(engine->Run(), 0);
+        const double seconds = stopwatch.GetMilliseconds() / 1000.0;
+
+        auto* gameRenderer = engine->GetSystems().Locate<Renderer::GameRenderer>();
+        Renderer::RenderThread::Stats stats = gameRenderer->GetRenderThread()->GetStats();
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("Engine with 1000 sprites (threaded: {}) submit",
+            threaded), stats.submitSeconds * 1000.0 / stats.submittedFrames, "frame",
+            fmt::format("{:.1f} FPS", stats.submittedFrames / seconds)));
+    }
+}
@@ -0,0 +1,222 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <Script/ScriptAllocator.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    const char* AllocationScript = R"(
+        local objects = {}
+        for i = 1, 20000 do
+            objects[i % 500 + 1] = { x = i, y = i * 2, name = "object_" .. i }
+        end
+
+        local parts = {}
+        for i = 1, 2000 do
+            parts[#parts + 1] = tostring(i) .. ":" .. tostring(i * i)
+        end
+
+        Result = #objects
+    )";
+
+    std::unique_ptr<Script::ScriptState> CreateScriptState(std::size_t memoryLimit, bool pooledAllocator)
+    {
+        Script::ScriptState::CreateFromParams params;
+        params.memoryLimit = memoryLimit;
+        params.pooledAllocator = pooledAllocator;
+        return Test::CreateScriptState(params);
+    }
+
+    std::size_t GetLuaMemoryUsage(Script::ScriptState& scriptState)
+    {
+        return static_cast<std::size_t>(lua_gc(scriptState, LUA_GCCOUNT, 0)) * 1024
+            + static_cast<std::size_t>(lua_gc(scriptState, LUA_GCCOUNTB, 0));
+    }
+}
+
+DOCTEST_TEST_CASE("Script Allocator")
+{
+    DOCTEST_SUBCASE("Size Classes")
+    {
+        Script::ScriptAllocator allocator(0, true);
+
+        // Old size of new allocation is type of object and not its size.
+        auto* data = static_cast<uint8_t*>(allocator.Reallocate(nullptr, LUA_TTABLE, 24));
+        uint8_t* const firstBlock = data;
+        DOCTEST_REQUIRE(data);
+        for(uint8_t i = 0; i < 24; ++i)
+        {
+            data[i] = i;
+        }
+
+        // Contents are preserved when block moves between size classes and to system allocator.
+        data = static_cast<uint8_t*>(allocator.Reallocate(data, 24, 200));
+        DOCTEST_REQUIRE(data);
+        data = static_cast<uint8_t*>(allocator.Reallocate(data, 200, 4000));
+        DOCTEST_REQUIRE(data);
+        data = static_cast<uint8_t*>(allocator.Reallocate(data, 4000, 20));
+        DOCTEST_REQUIRE(data);
+
+        // Freed block is reused for next allocation of same size class.
+        DOCTEST_CHECK_EQ(data, firstBlock);
+
+        for(uint8_t i = 0; i < 20; ++i)
+        {
+            DOCTEST_CHECK_EQ(data[i], i);
+        }
+
+        Script::ScriptAllocator::Stats stats = allocator.GetStats();
+        DOCTEST_CHECK_EQ(stats.bytesLive, 20);
+        DOCTEST_CHECK_EQ(stats.bytesPeak, 4000);
+        DOCTEST_CHECK_EQ(stats.bytesReserved, Script::ScriptAllocator::PageSize * 2);
+        DOCTEST_CHECK_EQ(stats.allocations, 1);
+        DOCTEST_CHECK_EQ(stats.reallocations, 3);
+        DOCTEST_CHECK_EQ(stats.pooledAllocations, 1);
+
+        DOCTEST_CHECK_EQ(allocator.Reallocate(data, 20, 0), nullptr);
+        DOCTEST_CHECK_EQ(allocator.Reallocate(nullptr, LUA_TSTRING, 30), data);
+        DOCTEST_CHECK_EQ(allocator.GetStats().frees, 1);
+        DOCTEST_CHECK_EQ(allocator.GetStats().bytesLive, 30);
+    }
+
+    DOCTEST_SUBCASE("Failed Shrink")
+    {
+        Script::ScriptAllocator allocator(0, true);
+
+        auto* pooled = static_cast<uint8_t*>(allocator.Reallocate(nullptr, LUA_TTABLE, 200));
+        auto* large = static_cast<uint8_t*>(allocator.Reallocate(nullptr, LUA_TTABLE, 4000));
+        DOCTEST_REQUIRE(pooled);
+        DOCTEST_REQUIRE(large);
+        large[0] = 42;
+
+        // Shrinking blocks keeps them in place when no page can be allocated for smaller size class.
+        allocator.SetPageAllocateFunction([](std::size_t) -> void* { return nullptr; });
+        DOCTEST_CHECK_EQ(allocator.Reallocate(pooled, 200, 20), pooled);
+        DOCTEST_CHECK_EQ(allocator.Reallocate(large, 4000, 40), large);
+        DOCTEST_CHECK_EQ(large[0], 42);
+
+        Script::ScriptAllocator::Stats stats = allocator.GetStats();
+        DOCTEST_CHECK_EQ(stats.bytesLive, 60);
+        DOCTEST_CHECK_EQ(stats.failedAllocations, 0);
+        DOCTEST_CHECK_EQ(stats.bytesReserved, Script::ScriptAllocator::PageSize + 4000);
+
+        // Growing still fails, while freed blocks are reused by their new size classes.
+        DOCTEST_CHECK_EQ(allocator.Reallocate(nullptr, LUA_TTABLE, 100), nullptr);
+        DOCTEST_CHECK_EQ(allocator.GetStats().failedAllocations, 1);
+
+        DOCTEST_CHECK_EQ(allocator.Reallocate(pooled, 20, 0), nullptr);
+        DOCTEST_CHECK_EQ(allocator.Reallocate(large, 40, 0), nullptr);
+        DOCTEST_CHECK_EQ(allocator.Reallocate(nullptr, LUA_TSTRING, 20), pooled);
+        DOCTEST_CHECK_EQ(allocator.Reallocate(nullptr, LUA_TSTRING, 40), large);
+        DOCTEST_CHECK_EQ(allocator.Reallocate(nullptr, LUA_TSTRING, 40), large + 48);
+        DOCTEST_CHECK_EQ(allocator.GetStats().bytesLive, 100);
+    }
+
+    DOCTEST_SUBCASE("Memory Accounting")
+    {
+        for(bool pooledAllocator : { true, false })
+        {
+            auto scriptState = CreateScriptState(0, pooledAllocator);
+            DOCTEST_REQUIRE(scriptState);
+            DOCTEST_CHECK(scriptState->Execute(AllocationScript));
+
+            // Live bytes match memory usage that Lua reports.
+            const Script::ScriptAllocator::Stats& stats = scriptState->GetAllocator().GetStats();
+            DOCTEST_CHECK_EQ(stats.bytesLive, GetLuaMemoryUsage(*scriptState));
+            DOCTEST_CHECK_GE(stats.bytesPeak, stats.bytesLive);
+            DOCTEST_CHECK_GT(stats.allocations, 20000);
+            DOCTEST_CHECK_GT(stats.frees, 0);
+
+            if(pooledAllocator)
+            {
+                DOCTEST_CHECK_GT(stats.pooledAllocations, stats.allocations / 2);
+                DOCTEST_CHECK_GT(stats.bytesReserved, 0);
+            }
+            else
+            {
+                DOCTEST_CHECK_EQ(stats.pooledAllocations, 0);
+                DOCTEST_CHECK_EQ(stats.bytesReserved, 0);
+            }
+        }
+    }
+
+    DOCTEST_SUBCASE("Memory Limit")
+    {
+        auto scriptState = CreateScriptState(256 * 1024, true);
+        DOCTEST_REQUIRE(scriptState);
+
+        // Script that exceeds memory limit fails with memory error.
+        DOCTEST_CHECK_FALSE(scriptState->Execute(R"(
+            Objects = {}
+            for i = 1, 100000 do
+                Objects[i] = { i }
+            end
+        )"));
+
+        const Script::ScriptAllocator::Stats& stats = scriptState->GetAllocator().GetStats();
+        DOCTEST_CHECK_GT(stats.failedAllocations, 0);
+        DOCTEST_CHECK_LE(stats.bytesPeak, 256 * 1024);
+
+        // State remains usable once memory is released.
+        scriptState->Reset();
+        DOCTEST_CHECK(scriptState->Execute("Result = 1 + 2"));
+        DOCTEST_CHECK_LT(stats.bytesLive, 256 * 1024);
+
+        // Raising memory limit allows script to finish.
+        scriptState->GetAllocator().SetMemoryLimit(0);
+        DOCTEST_CHECK(scriptState->Execute(AllocationScript));
+    }
+}
+
+DOCTEST_TEST_CASE("Script Allocator Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure allocation heavy script executed with system allocator
+        without accounting, with accounting only, and with pooled allocator.
+    */
+
+    const int runCount = 50;
+
+    {
+        const double time = Test::MeasureMilliseconds([&]()
+        {
+            for(int i = 0; i < runCount; ++i)
+            {
+                lua_State* state = luaL_newstate();
+                luaL_requiref(state, "_G", luaopen_base, 1);
+                lua_pop(state, 1);
+
+                DOCTEST_CHECK_EQ(luaL_dostring(state, AllocationScript), 0);
+                lua_close(state);
+            }
+        });
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark("System allocator", time / runCount, "run"));
+    }
+
+    for(bool pooledAllocator : { false, true })
+    {
+        Script::ScriptAllocator::Stats stats;
+        const double time = Test::MeasureMilliseconds([&]()
+        {
+            for(int i = 0; i < runCount; ++i)
+            {
+                auto scriptState = CreateScriptState(0, pooledAllocator);
+                DOCTEST_CHECK(scriptState->Execute(AllocationScript));
+                stats = scriptState->GetAllocator().GetStats();
+            }
+        });
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(pooledAllocator ? "Pooled allocator" : "Accounting allocator",
+            time / runCount, "run", fmt::format("{} allocations ({} pooled), peak {} KiB, reserved {} KiB",
+            stats.allocations, stats.pooledAllocations, stats.bytesPeak / 1024, stats.bytesReserved / 1024)));
+    }
+}
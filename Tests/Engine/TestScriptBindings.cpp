@@ -0,0 +1,306 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <Script/ScriptBindings.hpp>
+#include <Game/Components/TransformComponent.hpp>
+#include <Game/Components/SpriteComponent.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    template<typename Type>
+    bool CallWithObject(Script::ScriptState& scriptState, const Script::ScriptBindings& scriptBindings,
+        const char* function, Type* object)
+    {
+        lua_getglobal(scriptState, function);
+        scriptBindings.PushObject(scriptState, object);
+        return lua_pcall(scriptState, 1, 0, 0) == LUA_OK;
+    }
+
+    const char* TransformScript = R"(
+        local Transform = Types["Game::TransformComponent"]
+        local Sprite = Types["Game::SpriteComponent"]
+
+        function MoveTransform(transform)
+            local x, y, z = GetField(transform, Transform.currentPosition)
+            SetField(transform, Transform.currentPosition, x + 1.0, y * 2.0, z - 3.0)
+            SetField(transform, Transform.currentScale, 2.0, 2.0, 2.0)
+        end
+
+        function HideSprite(sprite)
+            local r, g, b, a = GetField(sprite, Sprite.color)
+            SetField(sprite, Sprite.color, r, g, b, 0.0)
+            SetField(sprite, Sprite.transparent, not GetField(sprite, Sprite.transparent))
+        end
+
+        function InvalidField(transform)
+            GetField(transform, 1000000)
+        end
+
+        function SpriteFieldOfTransform(transform)
+            SetField(transform, Sprite.color, 0.0, 0.0, 0.0, 0.0)
+        end
+    )";
+
+    // Hand written binding that resolves fields by their names on every access.
+    const char* PositionMetatable = "TransformPosition";
+
+    int LuaTransformIndex(lua_State* state)
+    {
+        auto* transform = *static_cast<Game::TransformComponent**>(
+            luaL_checkudata(state, 1, PositionMetatable));
+        const char* key = luaL_checkstring(state, 2);
+
+        if(std::strcmp(key, "x") == 0)
+            lua_pushnumber(state, transform->GetPosition().x);
+        else if(std::strcmp(key, "y") == 0)
+            lua_pushnumber(state, transform->GetPosition().y);
+        else if(std::strcmp(key, "z") == 0)
+            lua_pushnumber(state, transform->GetPosition().z);
+        else
+            lua_pushnil(state);
+
+        return 1;
+    }
+
+    int LuaTransformNewIndex(lua_State* state)
+    {
+        auto* transform = *static_cast<Game::TransformComponent**>(
+            luaL_checkudata(state, 1, PositionMetatable));
+        const char* key = luaL_checkstring(state, 2);
+        const float value = static_cast<float>(luaL_checknumber(state, 3));
+
+        glm::vec3 position = transform->GetPosition();
+        if(std::strcmp(key, "x") == 0)
+            position.x = value;
+        else if(std::strcmp(key, "y") == 0)
+            position.y = value;
+        else if(std::strcmp(key, "z") == 0)
+            position.z = value;
+
+        transform->SetPosition(position);
+        return 0;
+    }
+}
+
+DOCTEST_TEST_CASE("Script Bindings")
+{
+    std::unique_ptr<Engine::Root> engine = Test::CreateEngine();
+    DOCTEST_REQUIRE(engine);
+
+    auto* scriptBindings = engine->GetSystems().Locate<Script::ScriptBindings>();
+    DOCTEST_REQUIRE(scriptBindings);
+
+    Script::ScriptState::CreateFromParams bindingParams;
+    bindingParams.scriptBindings = scriptBindings;
+
+    DOCTEST_SUBCASE("Bound Types")
+    {
+        // Only reflected types with fields of supported types are bound.
+        auto FindType = [scriptBindings](std::string_view name) -> const Script::ScriptBindings::TypeBinding*
+        {
+            for(const auto& typeBinding : scriptBindings->GetTypes())
+            {
+                if(typeBinding.name == name)
+                    return &typeBinding;
+            }
+
+            return nullptr;
+        };
+
+        const auto* transformBinding = FindType("Game::TransformComponent");
+        DOCTEST_REQUIRE(transformBinding);
+        DOCTEST_CHECK_EQ(transformBinding->fieldCount, 3);
+        DOCTEST_CHECK_EQ(scriptBindings->GetFields()[transformBinding->firstField].name, "currentRotation");
+
+        DOCTEST_CHECK(FindType("Game::SpriteComponent"));
+        DOCTEST_CHECK(FindType("Game::CameraComponent"));
+        DOCTEST_CHECK_FALSE(FindType("Game::Component"));
+        DOCTEST_CHECK_FALSE(FindType("Script::ScriptBindings"));
+    }
+
+    DOCTEST_SUBCASE("Field Access")
+    {
+        auto scriptState = Test::CreateScriptState(bindingParams);
+        DOCTEST_REQUIRE(scriptState);
+        DOCTEST_REQUIRE(scriptState->Execute(TransformScript));
+
+        Game::TransformComponent transform;
+        transform.SetPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+        DOCTEST_CHECK(CallWithObject(*scriptState, *scriptBindings, "MoveTransform", &transform));
+        DOCTEST_CHECK_EQ(transform.GetPosition(), glm::vec3(2.0f, 4.0f, 0.0f));
+        DOCTEST_CHECK_EQ(transform.GetScale(), glm::vec3(2.0f, 2.0f, 2.0f));
+
+        Game::SpriteComponent sprite;
+        DOCTEST_CHECK(CallWithObject(*scriptState, *scriptBindings, "HideSprite", &sprite));
+        DOCTEST_CHECK_EQ(sprite.GetColor(), glm::vec4(1.0f, 1.0f, 1.0f, 0.0f));
+        DOCTEST_CHECK(sprite.IsTransparent());
+
+        // Invalid field index raises script error instead of accessing memory.
+        DOCTEST_CHECK_FALSE(CallWithObject(*scriptState, *scriptBindings, "InvalidField", &transform));
+        scriptState->CleanStack();
+
+        // Bindings remain available after state is reset.
+        scriptState->Reset();
+        DOCTEST_CHECK(scriptState->Execute(TransformScript));
+    }
+
+    DOCTEST_SUBCASE("Object Type Checks")
+    {
+        auto scriptState = Test::CreateScriptState(bindingParams);
+        DOCTEST_REQUIRE(scriptState);
+        DOCTEST_REQUIRE(scriptState->Execute(TransformScript));
+
+        // Field index of another type is rejected before object is accessed.
+        Game::TransformComponent transform;
+        transform.SetPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+        DOCTEST_CHECK_FALSE(CallWithObject(*scriptState, *scriptBindings, "SpriteFieldOfTransform", &transform));
+        DOCTEST_CHECK_NE(std::string(lua_tostring(*scriptState, -1)).find("does not belong to"), std::string::npos);
+        DOCTEST_CHECK_EQ(transform.GetPosition(), glm::vec3(1.0f, 2.0f, 3.0f));
+        scriptState->CleanStack();
+
+        // Light userdata does not carry type of object and is rejected.
+        lua_getglobal(*scriptState, "MoveTransform");
+        lua_pushlightuserdata(*scriptState, &transform);
+        DOCTEST_CHECK_NE(lua_pcall(*scriptState, 1, 0, 0), LUA_OK);
+        DOCTEST_CHECK_EQ(transform.GetPosition(), glm::vec3(1.0f, 2.0f, 3.0f));
+        scriptState->CleanStack();
+
+        // Objects of types without bound fields cannot be pushed.
+        int value = 0;
+        DOCTEST_CHECK_FALSE(scriptBindings->PushObject(*scriptState, &value));
+        DOCTEST_CHECK(lua_isnil(*scriptState, -1));
+        scriptState->CleanStack();
+
+        // Handle can be pointed at another object, or cleared so scripts can no longer use it.
+        Game::TransformComponent otherTransform;
+        DOCTEST_REQUIRE(scriptBindings->PushObject(*scriptState, &transform));
+        lua_setglobal(*scriptState, "Handle");
+
+        lua_getglobal(*scriptState, "Handle");
+        Script::ScriptBindings::SetObject(*scriptState, -1, &otherTransform);
+        lua_pop(*scriptState, 1);
+        DOCTEST_CHECK(scriptState->Execute("MoveTransform(Handle)"));
+        DOCTEST_CHECK_EQ(otherTransform.GetPosition(), glm::vec3(1.0f, 0.0f, -3.0f));
+        DOCTEST_CHECK_EQ(transform.GetPosition(), glm::vec3(1.0f, 2.0f, 3.0f));
+
+        lua_getglobal(*scriptState, "Handle");
+        Script::ScriptBindings::SetObject(*scriptState, -1, nullptr);
+        lua_pop(*scriptState, 1);
+        DOCTEST_CHECK_FALSE(scriptState->Execute("MoveTransform(Handle)"));
+        scriptState->CleanStack();
+    }
+
+    DOCTEST_SUBCASE("State Without Bindings")
+    {
+        auto scriptState = Test::CreateScriptState();
+        DOCTEST_REQUIRE(scriptState);
+        DOCTEST_CHECK_FALSE(scriptState->Execute(TransformScript));
+    }
+}
+
+DOCTEST_TEST_CASE("Script Bindings Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to compare script updating positions of 10k transform components per
+        tick through reflected bindings with integer field indices, and through hand written
+        binding that resolves fields by their names.
+    */
+
+    const int entityCount = 10000;
+    const int tickCount = 100;
+
+    std::unique_ptr<Engine::Root> engine = Test::CreateEngine();
+    DOCTEST_REQUIRE(engine);
+
+    auto* scriptBindings = engine->GetSystems().Locate<Script::ScriptBindings>();
+    Script::ScriptState::CreateFromParams bindingParams;
+    bindingParams.scriptBindings = scriptBindings;
+
+    std::vector<Game::TransformComponent> transforms(entityCount);
+
+    auto RunTicks = [&](Script::ScriptState& scriptState, const char* label)
+    {
+        const double time = Test::MeasureMilliseconds([&]()
+        {
+            for(int tick = 0; tick < tickCount; ++tick)
+            {
+                lua_getglobal(scriptState, "Tick");
+                DOCTEST_CHECK_EQ(lua_pcall(scriptState, 0, 0, 0), LUA_OK);
+            }
+        });
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(label, time / tickCount, "tick",
+            fmt::format("{} entities", entityCount)));
+    };
+
+    {
+        auto scriptState = Test::CreateScriptState(bindingParams);
+        DOCTEST_REQUIRE(scriptState->Execute(R"(
+            local Position = Types["Game::TransformComponent"].currentPosition
+            Entities = {}
+
+            function Tick()
+                for i = 1, #Entities do
+                    local transform = Entities[i]
+                    local x, y, z = GetField(transform, Position)
+                    SetField(transform, Position, x + 0.5, y + 0.25, z)
+                end
+            end
+        )"));
+
+        lua_getglobal(*scriptState, "Entities");
+        for(int i = 0; i < entityCount; ++i)
+        {
+            scriptBindings->PushObject(*scriptState, &transforms[i]);
+            lua_rawseti(*scriptState, -2, i + 1);
+        }
+
+        lua_pop(*scriptState, 1);
+        RunTicks(*scriptState, "Reflected bindings");
+        DOCTEST_CHECK_EQ(transforms.back().GetPosition().x, 0.5f * tickCount);
+    }
+
+    {
+        auto scriptState = Test::CreateScriptState();
+        DOCTEST_REQUIRE(scriptState->Execute(R"(
+            Entities = {}
+
+            function Tick()
+                for i = 1, #Entities do
+                    local position = Entities[i]
+                    position.x = position.x + 0.5
+                    position.y = position.y + 0.25
+                end
+            end
+        )"));
+
+        luaL_newmetatable(*scriptState, PositionMetatable);
+        lua_pushcfunction(*scriptState, LuaTransformIndex);
+        lua_setfield(*scriptState, -2, "__index");
+        lua_pushcfunction(*scriptState, LuaTransformNewIndex);
+        lua_setfield(*scriptState, -2, "__newindex");
+        lua_pop(*scriptState, 1);
+
+        lua_getglobal(*scriptState, "Entities");
+        for(int i = 0; i < entityCount; ++i)
+        {
+            auto** userdata = static_cast<Game::TransformComponent**>(
+                lua_newuserdata(*scriptState, sizeof(Game::TransformComponent*)));
+            *userdata = &transforms[i];
+            luaL_setmetatable(*scriptState, PositionMetatable);
+            lua_rawseti(*scriptState, -2, i + 1);
+        }
+
+        lua_pop(*scriptState, 1);
+        RunTicks(*scriptState, "Name resolved bindings");
+        DOCTEST_CHECK_EQ(transforms.back().GetPosition().x, 2.0f * 0.5f * tickCount);
+    }
+}
@@ -0,0 +1,358 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <Script/ScriptCache.hpp>
+#include <Script/ScriptStatePool.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    const char* TestScript = R"(
+        Values = {}
+        for i = 1, 10 do
+            Values[i] = i * i
+        end
+        Result = Values[10] + 1
+    )";
+
+    std::unique_ptr<Engine::Root> CreateEngine(const fs::path& cacheDirectory,
+        std::size_t statePoolSize = 8)
+    {
+        return Test::CreateEngine(
+        {
+            { "script.cacheDirectory", cacheDirectory.generic_string() },
+            { "script.statePoolSize", std::to_string(statePoolSize) },
+        });
+    }
+
+    std::unique_ptr<Script::ScriptState> CreateScriptState(Script::ScriptCache* scriptCache)
+    {
+        Script::ScriptState::CreateFromParams params;
+        params.scriptCache = scriptCache;
+        return Test::CreateScriptState(params);
+    }
+
+    int GetGlobalType(Script::ScriptState& scriptState, const char* name)
+    {
+        lua_getglobal(scriptState, name);
+        const int type = lua_type(scriptState, -1);
+        lua_pop(scriptState, 1);
+        return type;
+    }
+
+    lua_Integer GetGlobalInteger(Script::ScriptState& scriptState, const char* name)
+    {
+        lua_getglobal(scriptState, name);
+        const lua_Integer value = lua_tointeger(scriptState, -1);
+        lua_pop(scriptState, 1);
+        return value;
+    }
+
+    std::string CreateLargeScript(int entryCount)
+    {
+        std::string script = "Entries = {\n";
+        for(int i = 0; i < entryCount; ++i)
+        {
+            script += fmt::format("    {{ name = \"entry_{}\", x = {}, y = {}, scale = {}.5 }},\n",
+                i, i * 3, i * 7, i % 10);
+        }
+
+        script += "}\n";
+        return script;
+    }
+}
+
+DOCTEST_TEST_CASE("Script Cache")
+{
+    const fs::path cacheDirectory = fs::temp_directory_path() / "EngineTestScriptCache";
+    fs::remove_all(cacheDirectory);
+
+    DOCTEST_SUBCASE("Memory Cache")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine("");
+        DOCTEST_REQUIRE(engine);
+
+        auto* scriptCache = engine->GetSystems().Locate<Script::ScriptCache>();
+        DOCTEST_REQUIRE(scriptCache);
+        DOCTEST_CHECK_FALSE(scriptCache->IsDiskEnabled());
+
+        // Script is compiled once and its bytecode is reused by other states.
+        for(int i = 0; i < 3; ++i)
+        {
+            auto scriptState = CreateScriptState(scriptCache);
+            DOCTEST_REQUIRE(scriptState);
+            DOCTEST_CHECK(scriptState->Execute(TestScript));
+            DOCTEST_CHECK_EQ(GetGlobalInteger(*scriptState, "Result"), 101);
+        }
+
+        Script::ScriptCache::Stats stats = scriptCache->GetStats();
+        DOCTEST_CHECK_EQ(stats.misses, 1);
+        DOCTEST_CHECK_EQ(stats.memoryHits, 2);
+        DOCTEST_CHECK_EQ(stats.stored, 0);
+
+        // Same source under different chunk name is compiled separately.
+        auto scriptState = CreateScriptState(scriptCache);
+        DOCTEST_CHECK(scriptState->Execute(TestScript, "=other"));
+        DOCTEST_CHECK_EQ(scriptCache->GetStats().misses, 2);
+    }
+
+    DOCTEST_SUBCASE("Disk Cache")
+    {
+        const Script::ScriptCache::ChunkKey key =
+            Script::ScriptCache::CalculateKey(TestScript, "=script");
+
+        {
+            std::unique_ptr<Engine::Root> engine = CreateEngine(cacheDirectory);
+            DOCTEST_REQUIRE(engine);
+
+            auto* scriptCache = engine->GetSystems().Locate<Script::ScriptCache>();
+            DOCTEST_REQUIRE(scriptCache->IsDiskEnabled());
+
+            auto scriptState = CreateScriptState(scriptCache);
+            DOCTEST_CHECK(scriptState->Execute(TestScript));
+            DOCTEST_CHECK_EQ(scriptCache->GetStats().stored, 1);
+            DOCTEST_CHECK(fs::exists(scriptCache->GetChunkPath(key)));
+        }
+
+        // Bytecode written by previous engine is loaded on next launch.
+        std::unique_ptr<Engine::Root> engine = CreateEngine(cacheDirectory);
+        DOCTEST_REQUIRE(engine);
+
+        auto* scriptCache = engine->GetSystems().Locate<Script::ScriptCache>();
+        auto scriptState = CreateScriptState(scriptCache);
+        DOCTEST_CHECK(scriptState->Execute(TestScript));
+        DOCTEST_CHECK_EQ(GetGlobalInteger(*scriptState, "Result"), 101);
+
+        Script::ScriptCache::Stats stats = scriptCache->GetStats();
+        DOCTEST_CHECK_EQ(stats.diskHits, 1);
+        DOCTEST_CHECK_EQ(stats.misses, 0);
+    }
+
+    DOCTEST_SUBCASE("Corrupted Cache File")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine(cacheDirectory);
+        DOCTEST_REQUIRE(engine);
+
+        auto* scriptCache = engine->GetSystems().Locate<Script::ScriptCache>();
+        const fs::path chunkPath = scriptCache->GetChunkPath(
+            Script::ScriptCache::CalculateKey(TestScript, "=script"));
+
+        {
+            std::ofstream file(chunkPath, std::ios::binary | std::ios::trunc);
+            file << "Not a cached chunk";
+        }
+
+        // Invalid cache file is discarded and replaced with freshly compiled chunk.
+        auto scriptState = CreateScriptState(scriptCache);
+        DOCTEST_CHECK(scriptState->Execute(TestScript));
+        DOCTEST_CHECK_EQ(GetGlobalInteger(*scriptState, "Result"), 101);
+
+        Script::ScriptCache::Stats stats = scriptCache->GetStats();
+        DOCTEST_CHECK_EQ(stats.rejected, 1);
+        DOCTEST_CHECK_EQ(stats.misses, 1);
+        DOCTEST_CHECK_EQ(stats.stored, 1);
+        DOCTEST_CHECK_GT(fs::file_size(chunkPath), 18);
+    }
+
+    DOCTEST_SUBCASE("Invalid Bytecode Length")
+    {
+        const Script::ScriptCache::ChunkKey key =
+            Script::ScriptCache::CalculateKey(TestScript, "=script");
+
+        fs::path chunkPath;
+
+        {
+            std::unique_ptr<Engine::Root> engine = CreateEngine(cacheDirectory);
+            DOCTEST_REQUIRE(engine);
+
+            auto* scriptCache = engine->GetSystems().Locate<Script::ScriptCache>();
+            auto scriptState = CreateScriptState(scriptCache);
+            DOCTEST_CHECK(scriptState->Execute(TestScript));
+            chunkPath = scriptCache->GetChunkPath(key);
+        }
+
+        {
+            // Overwrite bytecode length that follows magic, version and chunk key in header.
+            std::fstream file(chunkPath, std::ios::binary | std::ios::in | std::ios::out);
+            DOCTEST_REQUIRE(file.is_open());
+
+            const uint64_t bytecodeLength = std::numeric_limits<uint64_t>::max();
+            file.seekp(sizeof(uint32_t) * 2 + sizeof(uint64_t));
+            file.write(reinterpret_cast<const char*>(&bytecodeLength), sizeof(bytecodeLength));
+        }
+
+        // Length that does not match file size is rejected before bytecode is allocated.
+        std::unique_ptr<Engine::Root> engine = CreateEngine(cacheDirectory);
+        DOCTEST_REQUIRE(engine);
+
+        auto* scriptCache = engine->GetSystems().Locate<Script::ScriptCache>();
+        auto scriptState = CreateScriptState(scriptCache);
+        DOCTEST_CHECK(scriptState->Execute(TestScript));
+        DOCTEST_CHECK_EQ(GetGlobalInteger(*scriptState, "Result"), 101);
+
+        Script::ScriptCache::Stats stats = scriptCache->GetStats();
+        DOCTEST_CHECK_EQ(stats.rejected, 1);
+        DOCTEST_CHECK_EQ(stats.diskHits, 0);
+        DOCTEST_CHECK_EQ(stats.misses, 1);
+    }
+
+    DOCTEST_SUBCASE("Invalid Script")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine(cacheDirectory);
+        DOCTEST_REQUIRE(engine);
+
+        // Scripts that fail to compile are not stored.
+        auto* scriptCache = engine->GetSystems().Locate<Script::ScriptCache>();
+        auto scriptState = CreateScriptState(scriptCache);
+        DOCTEST_CHECK_FALSE(scriptState->Execute("Result = "));
+        DOCTEST_CHECK_EQ(scriptCache->GetStats().stored, 0);
+        DOCTEST_CHECK_EQ(lua_gettop(*scriptState), 0);
+    }
+
+    fs::remove_all(cacheDirectory);
+}
+
+DOCTEST_TEST_CASE("Script State Pool")
+{
+    std::unique_ptr<Engine::Root> engine = CreateEngine("", 1);
+    DOCTEST_REQUIRE(engine);
+
+    auto* statePool = engine->GetSystems().Locate<Script::ScriptStatePool>();
+    DOCTEST_REQUIRE(statePool);
+
+    DOCTEST_SUBCASE("Reset State")
+    {
+        {
+            Script::ScriptStatePool::StatePtr scriptState = statePool->Acquire();
+            DOCTEST_REQUIRE(scriptState);
+            DOCTEST_CHECK(scriptState->Execute(TestScript));
+            DOCTEST_CHECK(scriptState->Execute("print = nil; setmetatable(_G, {})"));
+            DOCTEST_CHECK_EQ(GetGlobalType(*scriptState, "print"), LUA_TNIL);
+        }
+
+        // Released state is reused with globals restored to their initialized state.
+        Script::ScriptStatePool::StatePtr scriptState = statePool->Acquire();
+        DOCTEST_REQUIRE(scriptState);
+        DOCTEST_CHECK_EQ(statePool->GetStats().reusedStates, 1);
+
+        DOCTEST_CHECK_EQ(GetGlobalType(*scriptState, "Values"), LUA_TNIL);
+        DOCTEST_CHECK_EQ(GetGlobalType(*scriptState, "Result"), LUA_TNIL);
+        DOCTEST_CHECK_EQ(GetGlobalType(*scriptState, "print"), LUA_TFUNCTION);
+        DOCTEST_CHECK_EQ(GetGlobalType(*scriptState, "Log"), LUA_TFUNCTION);
+
+        lua_pushglobaltable(*scriptState);
+        DOCTEST_CHECK_FALSE(lua_getmetatable(*scriptState, -1));
+        lua_pop(*scriptState, 1);
+
+        DOCTEST_CHECK(scriptState->Execute(TestScript));
+        DOCTEST_CHECK_EQ(GetGlobalInteger(*scriptState, "Result"), 101);
+    }
+
+    DOCTEST_SUBCASE("Pool Size")
+    {
+        {
+            Script::ScriptStatePool::StatePtr first = statePool->Acquire();
+            Script::ScriptStatePool::StatePtr second = statePool->Acquire();
+            DOCTEST_REQUIRE(first);
+            DOCTEST_REQUIRE(second);
+        }
+
+        // States released over pool size are closed.
+        Script::ScriptStatePool::Stats stats = statePool->GetStats();
+        DOCTEST_CHECK_EQ(stats.acquiredStates, 2);
+        DOCTEST_CHECK_EQ(stats.discardedStates, 1);
+        DOCTEST_CHECK_EQ(stats.pooledStates, 1);
+
+        statePool->Clear();
+        DOCTEST_CHECK_EQ(statePool->GetStats().pooledStates, 0);
+    }
+
+    DOCTEST_SUBCASE("Without Pool")
+    {
+        Script::ScriptStatePool::StatePtr scriptState = Script::ScriptStatePool::AcquireFrom(nullptr);
+        DOCTEST_REQUIRE(scriptState);
+        DOCTEST_CHECK(scriptState->Execute(TestScript));
+        DOCTEST_CHECK_EQ(statePool->GetStats().acquiredStates, 0);
+    }
+}
+
+DOCTEST_TEST_CASE("Script Cache Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure loading of one large and many small scripts from source,
+        from cached bytecode and from cached bytecode into pooled states.
+    */
+
+    const fs::path cacheDirectory = fs::temp_directory_path() / "EngineBenchmarkScriptCache";
+    fs::remove_all(cacheDirectory);
+
+    const int largeScriptCount = 20;
+    const int smallScriptCount = 1000;
+
+    const std::string largeScript = CreateLargeScript(20000);
+    std::vector<std::string> smallScripts;
+    for(int i = 0; i < smallScriptCount; ++i)
+    {
+        smallScripts.push_back(fmt::format("Script{} = true\n", i) + CreateLargeScript(20));
+    }
+
+    std::unique_ptr<Engine::Root> engine = CreateEngine(cacheDirectory);
+    DOCTEST_REQUIRE(engine);
+
+    auto* scriptCache = engine->GetSystems().Locate<Script::ScriptCache>();
+    auto* statePool = engine->GetSystems().Locate<Script::ScriptStatePool>();
+
+    auto MeasureStates = [&](const char* name, Script::ScriptCache* cache)
+    {
+        const double largeTime = Test::MeasureMilliseconds([&]()
+        {
+            for(int i = 0; i < largeScriptCount; ++i)
+            {
+                auto scriptState = CreateScriptState(cache);
+                DOCTEST_CHECK(scriptState->Execute(largeScript));
+            }
+        });
+
+        const double smallTime = Test::MeasureMilliseconds([&]()
+        {
+            for(const std::string& script : smallScripts)
+            {
+                auto scriptState = CreateScriptState(cache);
+                DOCTEST_CHECK(scriptState->Execute(script));
+            }
+        });
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("{} large", name),
+            largeTime / largeScriptCount, "script"));
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("{} small", name),
+            smallTime / smallScriptCount, "script"));
+    };
+
+    MeasureStates("Source", nullptr);
+    MeasureStates("Cache (cold)", scriptCache);
+    MeasureStates("Cache (memory)", scriptCache);
+
+    scriptCache->Clear();
+    MeasureStates("Cache (disk)", scriptCache);
+
+    const double pooledTime = Test::MeasureMilliseconds([&]()
+    {
+        for(const std::string& script : smallScripts)
+        {
+            Script::ScriptStatePool::StatePtr scriptState = statePool->Acquire();
+            DOCTEST_CHECK(scriptState->Execute(script));
+        }
+    });
+
+    DOCTEST_MESSAGE(Test::FormatBenchmark("Cache (memory) with pooled states small",
+        pooledTime / smallScriptCount, "script"));
+
+    fs::remove_all(cacheDirectory);
+}
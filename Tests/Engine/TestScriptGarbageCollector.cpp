@@ -0,0 +1,286 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <Script/ScriptAllocator.hpp>
+#include <Script/ScriptGarbageCollector.hpp>
+#include <Script/ScriptBindings.hpp>
+#include <Game/GameInstance.hpp>
+#include <Game/Systems/ScriptSystem.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    // Produces garbage every call while keeping small set of live objects.
+    const char* GarbageScript = R"(
+        Live = {}
+        Frame = 0
+
+        function Update()
+            Frame = Frame + 1
+            for i = 1, 500 do
+                Live[i % 100 + 1] = { x = i, y = Frame, name = "object_" .. i }
+            end
+        end
+    )";
+
+    std::unique_ptr<Engine::Root> CreateEngine(const std::string& budget,
+        const std::string& mode = "incremental")
+    {
+        return Test::CreateEngine(
+        {
+            { "script.gcBudget", budget },
+            { "script.gcMode", mode },
+        });
+    }
+
+    std::unique_ptr<Script::ScriptState> CreateScriptState(
+        Script::ScriptGarbageCollector* garbageCollector)
+    {
+        Script::ScriptState::CreateFromParams params;
+        params.garbageCollector = garbageCollector;
+
+        auto scriptState = Test::CreateScriptState(params);
+        if(scriptState && !scriptState->Execute(GarbageScript))
+            return nullptr;
+
+        return scriptState;
+    }
+
+    bool CallUpdate(Script::ScriptState& scriptState)
+    {
+        lua_getglobal(scriptState, "Update");
+        return lua_pcall(scriptState, 0, 0, 0) == LUA_OK;
+    }
+}
+
+DOCTEST_TEST_CASE("Script Garbage Collector")
+{
+    DOCTEST_SUBCASE("Registration")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine("1000");
+        DOCTEST_REQUIRE(engine);
+
+        auto* garbageCollector = engine->GetSystems().Locate<Script::ScriptGarbageCollector>();
+        DOCTEST_REQUIRE(garbageCollector);
+        DOCTEST_CHECK(garbageCollector->IsScheduling());
+
+        {
+            // Registered state no longer collects garbage on its own.
+            auto scriptState = CreateScriptState(garbageCollector);
+            DOCTEST_REQUIRE(scriptState);
+            DOCTEST_CHECK_EQ(garbageCollector->GetStateCount(), 1);
+            DOCTEST_CHECK_EQ(lua_gc(*scriptState, LUA_GCISRUNNING, 0), 0);
+
+            // State that is not created with collector is left alone.
+            auto otherState = CreateScriptState(nullptr);
+            DOCTEST_REQUIRE(otherState);
+            DOCTEST_CHECK_EQ(garbageCollector->GetStateCount(), 1);
+            DOCTEST_CHECK_NE(lua_gc(*otherState, LUA_GCISRUNNING, 0), 0);
+        }
+
+        // Destroyed state unregisters itself.
+        DOCTEST_CHECK_EQ(garbageCollector->GetStateCount(), 0);
+    }
+
+    DOCTEST_SUBCASE("Game Instance")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine("1000");
+        DOCTEST_REQUIRE(engine);
+
+        auto* garbageCollector = engine->GetSystems().Locate<Script::ScriptGarbageCollector>();
+        DOCTEST_REQUIRE(garbageCollector);
+
+        {
+            // Script state of game instance created with engine systems is scheduled.
+            Game::GameInstance::CreateFromParams params;
+            params.engineSystems = &engine->GetSystems();
+
+            auto gameInstance = Game::GameInstance::Create(params).UnwrapOr(nullptr);
+            DOCTEST_REQUIRE(gameInstance);
+
+            // Script state is created when first behavior is loaded.
+            auto* scriptSystem = gameInstance->GetSystems().Locate<Game::ScriptSystem>();
+            DOCTEST_REQUIRE(scriptSystem);
+            DOCTEST_CHECK_EQ(garbageCollector->GetStateCount(), 0);
+
+            DOCTEST_REQUIRE(scriptSystem->LoadBehavior("Empty", ""));
+            DOCTEST_CHECK_EQ(garbageCollector->GetStateCount(), 1);
+            DOCTEST_CHECK_EQ(lua_gc(*scriptSystem->GetScriptState(), LUA_GCISRUNNING, 0), 0);
+            DOCTEST_CHECK_EQ(scriptSystem->GetScriptBindings(),
+                engine->GetSystems().Locate<Script::ScriptBindings>());
+        }
+
+        DOCTEST_CHECK_EQ(garbageCollector->GetStateCount(), 0);
+    }
+
+    DOCTEST_SUBCASE("Scheduled Collection")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine("100000");
+        DOCTEST_REQUIRE(engine);
+
+        auto* garbageCollector = engine->GetSystems().Locate<Script::ScriptGarbageCollector>();
+        auto scriptState = CreateScriptState(garbageCollector);
+        DOCTEST_REQUIRE(scriptState);
+
+        // Without collection, memory keeps growing with produced garbage.
+        const Script::ScriptAllocator::Stats& stats = scriptState->GetAllocator().GetStats();
+        for(int frame = 0; frame < 10; ++frame)
+        {
+            DOCTEST_REQUIRE(CallUpdate(*scriptState));
+        }
+
+        const std::size_t uncollectedBytes = stats.bytesLive;
+
+        // Scheduled steps keep up with garbage produced each frame.
+        for(int frame = 0; frame < 50; ++frame)
+        {
+            DOCTEST_REQUIRE(CallUpdate(*scriptState));
+            garbageCollector->Collect();
+        }
+
+        DOCTEST_CHECK_LT(stats.bytesLive, uncollectedBytes);
+
+        Script::ScriptGarbageCollector::Stats collectorStats = garbageCollector->GetStats();
+        DOCTEST_CHECK_EQ(collectorStats.frames, 50);
+        DOCTEST_CHECK_GT(collectorStats.steps, 50);
+        DOCTEST_CHECK_GT(collectorStats.completedCycles, 0);
+        DOCTEST_CHECK_GE(collectorStats.peakFrameMicroseconds, garbageCollector->GetFrameStats().microseconds);
+    }
+
+    DOCTEST_SUBCASE("Exhausted Budget")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine("0.001");
+        DOCTEST_REQUIRE(engine);
+
+        auto* garbageCollector = engine->GetSystems().Locate<Script::ScriptGarbageCollector>();
+        auto firstState = CreateScriptState(garbageCollector);
+        auto secondState = CreateScriptState(garbageCollector);
+        DOCTEST_REQUIRE(firstState);
+        DOCTEST_REQUIRE(secondState);
+
+        // Each state with pending work is stepped at least once even without budget left.
+        DOCTEST_REQUIRE(CallUpdate(*firstState));
+        DOCTEST_REQUIRE(CallUpdate(*secondState));
+        garbageCollector->Collect();
+        DOCTEST_CHECK_GE(garbageCollector->GetFrameStats().steps, 2);
+
+        // Collection still completes over enough frames.
+        for(int frame = 0; frame < 2000 && garbageCollector->GetStats().completedCycles < 2; ++frame)
+        {
+            DOCTEST_REQUIRE(CallUpdate(*firstState));
+            DOCTEST_REQUIRE(CallUpdate(*secondState));
+            garbageCollector->Collect();
+        }
+
+        DOCTEST_CHECK_GE(garbageCollector->GetStats().completedCycles, 2);
+        DOCTEST_CHECK_GT(garbageCollector->GetStats().framesOverBudget, 0);
+    }
+
+    DOCTEST_SUBCASE("Disabled Scheduler")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine("0");
+        DOCTEST_REQUIRE(engine);
+
+        auto* garbageCollector = engine->GetSystems().Locate<Script::ScriptGarbageCollector>();
+        DOCTEST_CHECK_FALSE(garbageCollector->IsScheduling());
+
+        // States keep their automatic collection.
+        auto scriptState = CreateScriptState(garbageCollector);
+        DOCTEST_REQUIRE(scriptState);
+        DOCTEST_CHECK_NE(lua_gc(*scriptState, LUA_GCISRUNNING, 0), 0);
+
+        garbageCollector->Collect();
+        DOCTEST_CHECK_EQ(garbageCollector->GetStats().frames, 0);
+    }
+
+    DOCTEST_SUBCASE("Generational Mode")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine("1000", "generational");
+        DOCTEST_REQUIRE(engine);
+
+        auto* garbageCollector = engine->GetSystems().Locate<Script::ScriptGarbageCollector>();
+
+#if LUA_VERSION_NUM >= 504
+        DOCTEST_CHECK(garbageCollector->IsGenerational());
+        DOCTEST_CHECK_FALSE(garbageCollector->IsScheduling());
+#else
+        // Incremental collection is used when generational one is not supported.
+        DOCTEST_CHECK_FALSE(garbageCollector->IsGenerational());
+        DOCTEST_CHECK(garbageCollector->IsScheduling());
+#endif
+    }
+
+    DOCTEST_SUBCASE("Invalid Configuration")
+    {
+        DOCTEST_CHECK_FALSE(CreateEngine("1000", "unknown"));
+        DOCTEST_CHECK_FALSE(CreateEngine("-1"));
+    }
+}
+
+DOCTEST_TEST_CASE("Script Garbage Collector Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to compare per frame pauses of automatic Lua garbage collection with
+        collection scheduled within frame budget, for states producing garbage every frame.
+    */
+
+    const int stateCount = 8;
+    const int frameCount = 2000;
+
+    for(const char* budget : { "0", "250", "1000" })
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine(budget);
+        DOCTEST_REQUIRE(engine);
+
+        auto* garbageCollector = engine->GetSystems().Locate<Script::ScriptGarbageCollector>();
+
+        std::vector<std::unique_ptr<Script::ScriptState>> scriptStates;
+        for(int i = 0; i < stateCount; ++i)
+        {
+            scriptStates.push_back(CreateScriptState(garbageCollector));
+            DOCTEST_REQUIRE(scriptStates.back());
+        }
+
+        // Frame time includes script updates, which pay for automatic collection themselves.
+        double totalFrameTime = 0.0;
+        double peakFrameTime = 0.0;
+        std::size_t peakBytesLive = 0;
+
+        for(int frame = 0; frame < frameCount; ++frame)
+        {
+            const double frameTime = Test::MeasureMilliseconds([&]()
+            {
+                for(auto& scriptState : scriptStates)
+                {
+                    DOCTEST_CHECK(CallUpdate(*scriptState));
+                }
+
+                garbageCollector->Collect();
+            });
+
+            totalFrameTime += frameTime;
+            peakFrameTime = std::max(peakFrameTime, frameTime);
+
+            for(auto& scriptState : scriptStates)
+            {
+                peakBytesLive = std::max(peakBytesLive, scriptState->GetAllocator().GetStats().bytesLive);
+            }
+        }
+
+        const Script::ScriptGarbageCollector::Stats& stats = garbageCollector->GetStats();
+        DOCTEST_MESSAGE(Test::FormatBenchmark(
+            garbageCollector->IsScheduling() ? fmt::format("Budget {} us", budget) : std::string("Automatic"),
+            totalFrameTime / frameCount, "frame", fmt::format("{:.4f} ms peak frame, "
+            "{:.4f} ms average collection, {:.4f} ms peak collection, {} frames over budget, "
+            "peak {} KiB per state", peakFrameTime,
+            stats.frames ? stats.totalMicroseconds / stats.frames / 1000.0 : 0.0,
+            stats.peakFrameMicroseconds / 1000.0, stats.framesOverBudget, peakBytesLive / 1024)));
+    }
+}
@@ -0,0 +1,314 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <sstream>
+#include <Engine.hpp>
+#include <Script/ScriptProfiler.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    // Spends most of its time in hot function and little in cold one.
+    const char* WorkScript = R"(
+        function Hot(n)
+            local sum = 0
+            for i = 1, n do
+                sum = sum + i % 7
+            end
+            return sum
+        end
+
+        function Cold(n)
+            local sum = 0
+            for i = 1, n do
+                sum = sum + i
+            end
+            return sum
+        end
+
+        function Update()
+            return Hot(20000) + Cold(1000)
+        end
+    )";
+
+    std::unique_ptr<Script::ScriptState> CreateScriptState()
+    {
+        Script::ScriptState::CreateFromParams params;
+        params.coroutineLibrary = true;
+
+        auto scriptState = Test::CreateScriptState(params);
+        if(scriptState && !scriptState->Execute(WorkScript))
+            return nullptr;
+
+        return scriptState;
+    }
+
+    void CallUpdate(Script::ScriptState& scriptState, int count)
+    {
+        for(int i = 0; i < count; ++i)
+        {
+            lua_getglobal(scriptState, "Update");
+            DOCTEST_REQUIRE_EQ(lua_pcall(scriptState, 0, 0, 0), LUA_OK);
+        }
+    }
+
+    const Script::ScriptProfiler::FunctionStats* FindFunction(
+        const Script::ScriptProfiler::Report& report, std::string_view name)
+    {
+        for(const auto& function : report.functions)
+        {
+            if(function.name == name)
+                return &function;
+        }
+
+        return nullptr;
+    }
+}
+
+DOCTEST_TEST_CASE("Script Profiler")
+{
+    auto scriptState = CreateScriptState();
+    DOCTEST_REQUIRE(scriptState);
+
+    Script::ScriptProfiler& profiler = scriptState->GetProfiler();
+    DOCTEST_CHECK_FALSE(profiler.IsRunning());
+
+    DOCTEST_SUBCASE("Function And Line Samples")
+    {
+        // Profiler does not sample until it is started.
+        CallUpdate(*scriptState, 5);
+        DOCTEST_CHECK_EQ(profiler.GetSampleCount(), 0);
+
+        Script::ScriptProfiler::StartParams params;
+        params.instructionInterval = 100;
+        profiler.Start(params);
+        DOCTEST_CHECK(profiler.IsRunning());
+
+        CallUpdate(*scriptState, 5);
+        profiler.Stop();
+
+        const std::size_t sampleCount = profiler.GetSampleCount();
+        DOCTEST_CHECK_GT(sampleCount, 100);
+
+        // Samples stop once profiler is stopped.
+        CallUpdate(*scriptState, 5);
+        DOCTEST_CHECK_EQ(profiler.GetSampleCount(), sampleCount);
+
+        Script::ScriptProfiler::Report report = profiler.CreateReport();
+        DOCTEST_CHECK_EQ(report.samples, sampleCount);
+
+        const auto* hot = FindFunction(report, "Hot");
+        const auto* cold = FindFunction(report, "Cold");
+        const auto* update = FindFunction(report, "Update");
+        DOCTEST_REQUIRE(hot);
+        DOCTEST_REQUIRE(cold);
+        DOCTEST_REQUIRE(update);
+
+        DOCTEST_CHECK_GT(hot->selfSamples, cold->selfSamples * 5);
+        DOCTEST_CHECK_EQ(hot->lineDefined, 2);
+        DOCTEST_CHECK_EQ(hot->source, "script");
+        DOCTEST_CHECK_GE(update->totalSamples, hot->selfSamples + cold->selfSamples);
+
+        // Hottest line is found within loop of hot function.
+        DOCTEST_REQUIRE_FALSE(report.lines.empty());
+        const auto& hottestLine = report.lines.front();
+        DOCTEST_CHECK_EQ(report.functions[hottestLine.function].name, "Hot");
+        DOCTEST_CHECK_GE(hottestLine.line, 4);
+        DOCTEST_CHECK_LE(hottestLine.line, 6);
+
+        // Samples are cleared without stopping profiler.
+        profiler.Clear();
+        DOCTEST_CHECK_EQ(profiler.GetSampleCount(), 0);
+        DOCTEST_CHECK(profiler.CreateReport().functions.empty());
+    }
+
+    DOCTEST_SUBCASE("Folded Stacks")
+    {
+        Script::ScriptProfiler::StartParams params;
+        params.instructionInterval = 100;
+        profiler.Start(params);
+        CallUpdate(*scriptState, 3);
+        profiler.Stop();
+
+        // Each line holds stack from outermost function and number of its samples.
+        std::string folded = profiler.ExportFoldedStacks();
+        DOCTEST_CHECK_NE(folded.find("Update (script:18);Hot (script:2) "), std::string::npos);
+
+        std::size_t sampleSum = 0;
+        std::istringstream stream(folded);
+        for(std::string line; std::getline(stream, line);)
+        {
+            const std::size_t separator = line.rfind(' ');
+            DOCTEST_REQUIRE_NE(separator, std::string::npos);
+            sampleSum += std::stoul(line.substr(separator + 1));
+        }
+
+        DOCTEST_CHECK_EQ(sampleSum, profiler.GetSampleCount());
+    }
+
+    DOCTEST_SUBCASE("Sample Period")
+    {
+        // Samples are taken by hooks armed once per sample period.
+        Script::ScriptProfiler::StartParams params;
+        params.samplePeriod = 0.0001;
+        profiler.Start(params);
+
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now();
+        while(profiler.GetSampleCount() < 10 && Clock::now() - start < std::chrono::seconds(10))
+        {
+            CallUpdate(*scriptState, 1);
+        }
+
+        profiler.Stop();
+        DOCTEST_CHECK_GE(profiler.GetSampleCount(), 10);
+
+        Script::ScriptProfiler::Report report = profiler.CreateReport();
+        DOCTEST_CHECK(FindFunction(report, "Update"));
+
+        // Hook is no longer armed once profiler is stopped.
+        const std::size_t sampleCount = profiler.GetSampleCount();
+        CallUpdate(*scriptState, 5);
+        DOCTEST_CHECK_EQ(profiler.GetSampleCount(), sampleCount);
+    }
+
+    DOCTEST_SUBCASE("Coroutines")
+    {
+        Script::ScriptProfiler::StartParams params;
+        params.instructionInterval = 100;
+        profiler.Start(params);
+
+        // Coroutines created while profiler is running are sampled.
+        DOCTEST_REQUIRE(scriptState->Execute(R"(
+            local thread = coroutine.wrap(function()
+                Hot(20000)
+            end)
+
+            thread()
+        )"));
+
+        profiler.Stop();
+
+        Script::ScriptProfiler::Report report = profiler.CreateReport();
+        const auto* hot = FindFunction(report, "Hot");
+        DOCTEST_REQUIRE(hot);
+        DOCTEST_CHECK_GT(hot->selfSamples, 0);
+    }
+
+    DOCTEST_SUBCASE("Coroutines Created Before Start")
+    {
+        DOCTEST_REQUIRE(scriptState->Execute(R"(
+            Thread = coroutine.create(function()
+                while true do
+                    Hot(20000)
+                    coroutine.yield()
+                end
+            end)
+        )"));
+
+        // Coroutines get count hook when they are resumed.
+        Script::ScriptProfiler::StartParams params;
+        params.instructionInterval = 100;
+        profiler.Start(params);
+        DOCTEST_REQUIRE(scriptState->Execute("assert(coroutine.resume(Thread))"));
+        profiler.Stop();
+
+        Script::ScriptProfiler::Report report = profiler.CreateReport();
+        const auto* hot = FindFunction(report, "Hot");
+        DOCTEST_REQUIRE(hot);
+        DOCTEST_CHECK_GT(hot->selfSamples, 100);
+
+        // Hook of coroutine is removed once it is resumed after profiler is stopped.
+        const std::size_t sampleCount = profiler.GetSampleCount();
+        DOCTEST_REQUIRE(scriptState->Execute("assert(coroutine.resume(Thread))"));
+        DOCTEST_CHECK_EQ(profiler.GetSampleCount(), sampleCount);
+
+        lua_getglobal(*scriptState, "Thread");
+        DOCTEST_CHECK_EQ(lua_gethook(lua_tothread(*scriptState, -1)), nullptr);
+        lua_pop(*scriptState, 1);
+    }
+
+    DOCTEST_SUBCASE("Coroutines With Sample Period")
+    {
+        DOCTEST_REQUIRE(scriptState->Execute(R"(
+            local thread = coroutine.wrap(function()
+                while true do
+                    Hot(20000)
+                    coroutine.yield()
+                end
+            end)
+
+            function Update()
+                thread()
+            end
+        )"));
+
+        // Hook is armed for running coroutine, so samples are taken within it.
+        Script::ScriptProfiler::StartParams params;
+        params.samplePeriod = 0.0001;
+        profiler.Start(params);
+
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now();
+        while(profiler.GetSampleCount() < 20 && Clock::now() - start < std::chrono::seconds(10))
+        {
+            CallUpdate(*scriptState, 1);
+        }
+
+        profiler.Stop();
+        DOCTEST_CHECK_GE(profiler.GetSampleCount(), 20);
+
+        Script::ScriptProfiler::Report report = profiler.CreateReport();
+        const auto* hot = FindFunction(report, "Hot");
+        DOCTEST_REQUIRE(hot);
+        DOCTEST_CHECK_GE(hot->selfSamples * 2, profiler.GetSampleCount());
+    }
+}
+
+DOCTEST_TEST_CASE("Script Profiler Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure overhead of sampling script execution at different sample
+        periods and instruction intervals, compared to running same script without profiler.
+    */
+
+    const int updateCount = 200;
+
+    auto Measure = [&](double samplePeriod, int instructionInterval)
+    {
+        auto scriptState = CreateScriptState();
+        DOCTEST_REQUIRE(scriptState);
+
+        if(samplePeriod > 0.0 || instructionInterval > 0)
+        {
+            Script::ScriptProfiler::StartParams params;
+            params.instructionInterval = instructionInterval;
+            params.samplePeriod = samplePeriod;
+            scriptState->GetProfiler().Start(params);
+        }
+
+        const double time = Test::MeasureMilliseconds([&]()
+        {
+            CallUpdate(*scriptState, updateCount);
+        });
+
+        scriptState->GetProfiler().Stop();
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("Period {} ms, interval {} instructions",
+            samplePeriod * 1000.0, instructionInterval), time, {}, fmt::format("{} updates, {} samples",
+            updateCount, scriptState->GetProfiler().GetSampleCount())));
+    };
+
+    Measure(0.0, 0);
+    Measure(0.01, 0);
+    Measure(0.001, 0);
+    Measure(0.0001, 0);
+    Measure(0.0, 100000);
+    Measure(0.0, 1000);
+}
@@ -0,0 +1,236 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/RenderContext.hpp>
+#include <Graphics/Shader.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    const char* TestShaderCode =
+        "#version 300 es\n"
+        "#if defined(VERTEX_SHADER)\n"
+        "    uniform mat4 vertexTransform;\n"
+        "    uniform highp vec2 vertexOffsets[4];\n"
+        "    // uniform mat4 commentedTransform;\n"
+        "    void main() {}\n"
+        "#endif\n"
+        "#if defined(FRAGMENT_SHADER)\n"
+        "    uniform mat4 vertexTransform;\n"
+        "    uniform sampler2D textureDiffuse;\n"
+        "    uniform int textureIndex;\n"
+        "    void main() {}\n"
+        "#endif\n";
+
+    std::unique_ptr<Graphics::Shader> CreateTestShader(Graphics::RenderContext* renderContext)
+    {
+        Graphics::Shader::LoadFromString shaderParams;
+        shaderParams.renderContext = renderContext;
+        shaderParams.shaderCode = TestShaderCode;
+        return Graphics::Shader::Create(shaderParams).UnwrapOr(nullptr);
+    }
+
+    std::size_t CountCalls(const Graphics::CommandRecorder::FrameStats& stats)
+    {
+        return stats.commandCount + stats.queries;
+    }
+}
+
+DOCTEST_TEST_CASE("Shader Uniforms")
+{
+    std::unique_ptr<Engine::Root> engine = Test::CreateRecordingEngine();
+    DOCTEST_REQUIRE(engine);
+
+    auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+    auto* renderContext = engine->GetSystems().Locate<Graphics::RenderContext>();
+    DOCTEST_REQUIRE(recorder);
+    DOCTEST_REQUIRE(renderContext);
+
+    std::unique_ptr<Graphics::Shader> shader = CreateTestShader(renderContext);
+    DOCTEST_REQUIRE(shader);
+
+    DOCTEST_SUBCASE("Reflection")
+    {
+        DOCTEST_CHECK_EQ(shader->GetUniforms().size(), 4);
+
+        Graphics::Shader::Uniform vertexTransform = shader->GetUniform(NAME_CONSTEXPR("vertexTransform"));
+        DOCTEST_CHECK(vertexTransform.IsValid());
+        DOCTEST_CHECK_EQ(vertexTransform.type, GL_FLOAT_MAT4);
+        DOCTEST_CHECK_EQ(vertexTransform.size, 1);
+
+        Graphics::Shader::Uniform vertexOffsets = shader->GetUniform(NAME_CONSTEXPR("vertexOffsets"));
+        DOCTEST_CHECK(vertexOffsets.IsValid());
+        DOCTEST_CHECK_EQ(vertexOffsets.type, GL_FLOAT_VEC2);
+        DOCTEST_CHECK_EQ(vertexOffsets.size, 4);
+
+        Graphics::Shader::Uniform textureDiffuse = shader->GetUniform(NAME_CONSTEXPR("textureDiffuse"));
+        DOCTEST_CHECK(textureDiffuse.IsValid());
+        DOCTEST_CHECK_EQ(textureDiffuse.type, GL_SAMPLER_2D);
+        DOCTEST_CHECK_EQ(textureDiffuse.location, shader->GetUniformIndex("textureDiffuse"));
+
+        DOCTEST_CHECK_FALSE(shader->GetUniform(NAME_CONSTEXPR("commentedTransform")).IsValid());
+        DOCTEST_CHECK_FALSE(shader->GetUniform(NAME_CONSTEXPR("missingUniform")).IsValid());
+    }
+
+    DOCTEST_SUBCASE("Resolved Handle")
+    {
+        Graphics::Shader::Uniform textureIndex = shader->GetUniform(NAME_CONSTEXPR("textureIndex"));
+
+        recorder->BeginFrame();
+        shader->SetUniform(textureIndex, 3);
+        shader->SetUniform(NAME_CONSTEXPR("missingUniform"), 3);
+        recorder->EndFrame();
+
+        const std::string expectedStream = fmt::format(
+            "glUseProgram({0})\n"
+            "glUniform1i({1}, 3)\n"
+            "glUseProgram(0)\n",
+            shader->GetHandle(), textureIndex.location);
+
+        DOCTEST_CHECK_EQ(recorder->FormatCommands(), expectedStream);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().uniformUpdates, 1);
+    }
+
+    DOCTEST_SUBCASE("Batch")
+    {
+        recorder->BeginFrame();
+        Graphics::Shader::UniformBatch(*shader)
+            .Set(NAME_CONSTEXPR("vertexTransform"), glm::mat4(1.0f))
+            .Set(NAME_CONSTEXPR("vertexOffsets"), glm::vec2(1.0f, 2.0f))
+            .Set(NAME_CONSTEXPR("textureIndex"), 1);
+        recorder->EndFrame();
+
+        // Program is bound once and reverted after all uniforms are written.
+        const Graphics::CommandRecorder::FrameStats& stats = recorder->GetLastFrameStats();
+        DOCTEST_CHECK_EQ(stats.programSwitches, 2);
+        DOCTEST_CHECK_EQ(stats.uniformUpdates, 3);
+        DOCTEST_CHECK_EQ(stats.commandCount, 5);
+
+        // Uniform locations are not queried after linking.
+        recorder->SetRecordingCommands(false);
+        recorder->BeginFrame();
+        renderContext->GetState().UseProgram(shader->GetHandle());
+        Graphics::Shader::UniformBatch(*shader)
+            .Set(NAME_CONSTEXPR("vertexTransform"), glm::mat4(1.0f))
+            .Set(NAME_CONSTEXPR("textureIndex"), 1);
+        renderContext->GetState().UseProgram(0);
+        recorder->EndFrame();
+
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().programSwitches, 2);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().uniformUpdates, 2);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().queries, 4);
+    }
+}
+
+DOCTEST_TEST_CASE("Shader Uniforms Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to count GL calls issued per frame by scene of materials that each
+        write four uniforms, comparing per call name lookups with resolved handles in batches.
+        Query count includes error checks made after each call.
+    */
+
+    std::unique_ptr<Engine::Root> engine = Test::CreateRecordingEngine();
+    DOCTEST_REQUIRE(engine);
+
+    auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+    auto* renderContext = engine->GetSystems().Locate<Graphics::RenderContext>();
+    Graphics::RenderState& renderState = renderContext->GetState();
+    recorder->SetRecordingCommands(false);
+
+    const int materialCount = 1000;
+    std::vector<std::unique_ptr<Graphics::Shader>> shaders;
+    for(int i = 0; i < materialCount; ++i)
+    {
+        shaders.push_back(CreateTestShader(renderContext));
+        DOCTEST_REQUIRE(shaders.back());
+    }
+
+    const glm::mat4 transform(1.0f);
+    const glm::vec2 offset(1.0f, 2.0f);
+
+    // Uniform locations queried by name with program bound and reverted for each write.
+    auto SetByName = [&renderState](Graphics::Shader& shader, const char* name, auto write)
+    {
+        GLuint previousProgram = renderState.GetCurrentProgram();
+        renderState.UseProgram(shader.GetHandle());
+        write(shader.GetUniformIndex(name));
+        Graphics::OpenGL::CheckErrors();
+        renderState.UseProgram(previousProgram);
+    };
+
+    recorder->BeginFrame();
+    for(auto& shader : shaders)
+    {
+        SetByName(*shader, "vertexTransform", [&](GLint location)
+        {
+            glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(transform));
+        });
+
+        SetByName(*shader, "vertexOffsets", [&](GLint location)
+        {
+            glUniform2fv(location, 1, glm::value_ptr(offset));
+        });
+
+        SetByName(*shader, "textureDiffuse", [](GLint location)
+        {
+            glUniform1i(location, 0);
+        });
+
+        SetByName(*shader, "textureIndex", [](GLint location)
+        {
+            glUniform1i(location, 1);
+        });
+    }
+    recorder->EndFrame();
+
+    const Graphics::CommandRecorder::FrameStats nameStats = recorder->GetLastFrameStats();
+
+    // Uniform handles resolved once and written under single program bind.
+    struct MaterialUniforms
+    {
+        Graphics::Shader::Uniform vertexTransform;
+        Graphics::Shader::Uniform vertexOffsets;
+        Graphics::Shader::Uniform textureDiffuse;
+        Graphics::Shader::Uniform textureIndex;
+    };
+
+    std::vector<MaterialUniforms> materials;
+    for(auto& shader : shaders)
+    {
+        MaterialUniforms& material = materials.emplace_back();
+        material.vertexTransform = shader->GetUniform(NAME_CONSTEXPR("vertexTransform"));
+        material.vertexOffsets = shader->GetUniform(NAME_CONSTEXPR("vertexOffsets"));
+        material.textureDiffuse = shader->GetUniform(NAME_CONSTEXPR("textureDiffuse"));
+        material.textureIndex = shader->GetUniform(NAME_CONSTEXPR("textureIndex"));
+    }
+
+    recorder->BeginFrame();
+    for(std::size_t i = 0; i < shaders.size(); ++i)
+    {
+        Graphics::Shader::UniformBatch(*shaders[i])
+            .Set(materials[i].vertexTransform, transform)
+            .Set(materials[i].vertexOffsets, offset)
+            .Set(materials[i].textureDiffuse, 0)
+            .Set(materials[i].textureIndex, 1);
+    }
+    recorder->EndFrame();
+
+    const Graphics::CommandRecorder::FrameStats handleStats = recorder->GetLastFrameStats();
+
+    DOCTEST_CHECK_EQ(nameStats.uniformUpdates, handleStats.uniformUpdates);
+    DOCTEST_CHECK_LT(CountCalls(handleStats), CountCalls(nameStats));
+    DOCTEST_MESSAGE(fmt::format("Name lookups: {} GL calls/frame ({} commands, {} queries, {} program switches)",
+        CountCalls(nameStats), nameStats.commandCount, nameStats.queries, nameStats.programSwitches));
+    DOCTEST_MESSAGE(fmt::format("Batched handles: {} GL calls/frame ({} commands, {} queries, {} program switches)",
+        CountCalls(handleStats), handleStats.commandCount, handleStats.queries, handleStats.programSwitches));
+    DOCTEST_MESSAGE(fmt::format("Avoided: {} GL calls/frame",
+        CountCalls(nameStats) - CountCalls(handleStats)));
+}
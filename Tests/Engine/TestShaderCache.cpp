@@ -0,0 +1,199 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <set>
+#include <Engine.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/RenderContext.hpp>
+#include <Graphics/ShaderCache.hpp>
+#include <Graphics/Shader.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    const char* TestShaderCode =
+        "#version 300 es\n"
+        "#if defined(VERTEX_SHADER)\n"
+        "    uniform mat4 vertexTransform;\n"
+        "    void main() {}\n"
+        "#endif\n"
+        "#if defined(FRAGMENT_SHADER)\n"
+        "    uniform sampler2D textureDiffuse;\n"
+        "    void main() {}\n"
+        "#endif\n";
+
+    std::unique_ptr<Engine::Root> CreateCachingEngine(const fs::path& cacheDirectory)
+    {
+        return Test::CreateRecordingEngine(
+        {
+            { "render.shaderCacheDirectory", cacheDirectory.generic_string() },
+        });
+    }
+
+    std::unique_ptr<Graphics::Shader> CreateTestShader(const Engine::Root& engine,
+        std::vector<std::string> defines = {})
+    {
+        Graphics::Shader::LoadFromString shaderParams;
+        shaderParams.renderContext = engine.GetSystems().Locate<Graphics::RenderContext>();
+        shaderParams.shaderCache = engine.GetSystems().Locate<Graphics::ShaderCache>();
+        shaderParams.defines = std::move(defines);
+        shaderParams.shaderCode = TestShaderCode;
+        return Graphics::Shader::Create(shaderParams).UnwrapOr(nullptr);
+    }
+
+    bool HasCommand(const Graphics::CommandRecorder& recorder, Graphics::CommandRecorder::CommandType type)
+    {
+        const auto& commands = recorder.GetCommands();
+        return std::any_of(commands.begin(), commands.end(),
+            [type](const Graphics::CommandRecorder::Command& command)
+            {
+                return command.type == type;
+            });
+    }
+}
+
+DOCTEST_TEST_CASE("Shader Cache")
+{
+    const fs::path cacheDirectory = fs::temp_directory_path() / "EngineTestShaderCache";
+    fs::remove_all(cacheDirectory);
+
+    DOCTEST_SUBCASE("Disabled")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateCachingEngine("");
+        DOCTEST_REQUIRE(engine);
+
+        auto* shaderCache = engine->GetSystems().Locate<Graphics::ShaderCache>();
+        DOCTEST_REQUIRE(shaderCache);
+        DOCTEST_CHECK_FALSE(shaderCache->IsEnabled());
+        DOCTEST_CHECK(CreateTestShader(*engine));
+        DOCTEST_CHECK_EQ(shaderCache->GetStats().misses, 0);
+    }
+
+    DOCTEST_SUBCASE("Hit And Miss")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateCachingEngine(cacheDirectory);
+        DOCTEST_REQUIRE(engine);
+
+        auto* shaderCache = engine->GetSystems().Locate<Graphics::ShaderCache>();
+        auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+        DOCTEST_REQUIRE(shaderCache->IsEnabled());
+
+        // Default engine shaders are compiled and stored on first launch.
+        const Graphics::ShaderCache::Stats startupStats = shaderCache->GetStats();
+        DOCTEST_CHECK_EQ(startupStats.hits, 0);
+        DOCTEST_CHECK_GT(startupStats.misses, 0);
+        DOCTEST_CHECK_EQ(startupStats.stored, startupStats.misses);
+
+        recorder->BeginFrame();
+        std::unique_ptr<Graphics::Shader> compiledShader = CreateTestShader(*engine);
+        DOCTEST_REQUIRE(compiledShader);
+        DOCTEST_CHECK(HasCommand(*recorder, Graphics::CommandRecorder::CommandType::CompileShader));
+        DOCTEST_CHECK_EQ(shaderCache->GetStats().misses, startupStats.misses + 1);
+        DOCTEST_CHECK_EQ(shaderCache->GetStats().stored, startupStats.stored + 1);
+
+        // Same source is linked from cached binary without compiling.
+        recorder->BeginFrame();
+        std::unique_ptr<Graphics::Shader> cachedShader = CreateTestShader(*engine);
+        DOCTEST_REQUIRE(cachedShader);
+        DOCTEST_CHECK(HasCommand(*recorder, Graphics::CommandRecorder::CommandType::ProgramBinary));
+        DOCTEST_CHECK_FALSE(HasCommand(*recorder, Graphics::CommandRecorder::CommandType::CompileShader));
+        DOCTEST_CHECK_EQ(shaderCache->GetStats().hits, 1);
+
+        // Reflected uniforms must match compiled program.
+        DOCTEST_CHECK_EQ(cachedShader->GetUniforms().size(), 2);
+        DOCTEST_CHECK_EQ(cachedShader->GetUniform(NAME_CONSTEXPR("textureDiffuse")).location,
+            compiledShader->GetUniform(NAME_CONSTEXPR("textureDiffuse")).location);
+
+        // Different defines produce different program.
+        std::unique_ptr<Graphics::Shader> variantShader = CreateTestShader(*engine, { "VARIANT" });
+        DOCTEST_REQUIRE(variantShader);
+        DOCTEST_CHECK_EQ(shaderCache->GetStats().hits, 1);
+        DOCTEST_CHECK_EQ(shaderCache->GetStats().misses, startupStats.misses + 2);
+    }
+
+    DOCTEST_SUBCASE("Next Launch")
+    {
+        {
+            std::unique_ptr<Engine::Root> engine = CreateCachingEngine(cacheDirectory);
+            DOCTEST_REQUIRE(engine);
+        }
+
+        std::unique_ptr<Engine::Root> engine = CreateCachingEngine(cacheDirectory);
+        DOCTEST_REQUIRE(engine);
+
+        const Graphics::ShaderCache::Stats& stats =
+            engine->GetSystems().Locate<Graphics::ShaderCache>()->GetStats();
+        DOCTEST_CHECK_GT(stats.hits, 0);
+        DOCTEST_CHECK_EQ(stats.misses, 0);
+        DOCTEST_CHECK_EQ(stats.stored, 0);
+    }
+
+    DOCTEST_SUBCASE("Invalidation")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateCachingEngine(cacheDirectory);
+        DOCTEST_REQUIRE(engine);
+
+        auto* shaderCache = engine->GetSystems().Locate<Graphics::ShaderCache>();
+
+        // Find cache file written for test shader.
+        std::set<fs::path> startupPaths;
+        for(const auto& entry : fs::directory_iterator(cacheDirectory))
+        {
+            startupPaths.insert(entry.path());
+        }
+
+        DOCTEST_REQUIRE(CreateTestShader(*engine));
+
+        fs::path programPath;
+        for(const auto& entry : fs::directory_iterator(cacheDirectory))
+        {
+            if(startupPaths.count(entry.path()) == 0)
+            {
+                programPath = entry.path();
+            }
+        }
+
+        DOCTEST_REQUIRE_FALSE(programPath.empty());
+        const std::uintmax_t programSize = fs::file_size(programPath);
+
+        DOCTEST_SUBCASE("Truncated")
+        {
+            fs::resize_file(programPath, programSize - 1);
+        }
+
+        DOCTEST_SUBCASE("Corrupted Header")
+        {
+            std::fstream file(programPath, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(8);
+            file.put('\x7f');
+        }
+
+        DOCTEST_SUBCASE("Trailing Data")
+        {
+            std::ofstream file(programPath, std::ios::binary | std::ios::app);
+            file.put('\0');
+        }
+
+        // Invalid file is discarded and replaced after compiling from source.
+        const Graphics::ShaderCache::Stats statsBefore = shaderCache->GetStats();
+        std::unique_ptr<Graphics::Shader> shader = CreateTestShader(*engine);
+        DOCTEST_REQUIRE(shader);
+        DOCTEST_CHECK_EQ(shader->GetUniforms().size(), 2);
+
+        const Graphics::ShaderCache::Stats& stats = shaderCache->GetStats();
+        DOCTEST_CHECK_EQ(stats.hits, statsBefore.hits);
+        DOCTEST_CHECK_EQ(stats.rejected, statsBefore.rejected + 1);
+        DOCTEST_CHECK_EQ(stats.stored, statsBefore.stored + 1);
+        DOCTEST_CHECK_EQ(fs::file_size(programPath), programSize);
+
+        DOCTEST_REQUIRE(CreateTestShader(*engine));
+        DOCTEST_CHECK_EQ(shaderCache->GetStats().hits, statsBefore.hits + 1);
+    }
+
+    fs::remove_all(cacheDirectory);
+}
@@ -0,0 +1,114 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/RenderContext.hpp>
+#include <Graphics/ShaderVariants.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    const char* TestShaderCode =
+        "#version 300 es\n"
+        "#pragma keywords VERTEX_COLOR ALPHA_TEST UNUSED\n"
+        "#if defined(VERTEX_SHADER)\n"
+        "    uniform mat4 vertexTransform;\n"
+        "    void main() {}\n"
+        "#endif\n"
+        "#if defined(FRAGMENT_SHADER)\n"
+        "    #if defined(VERTEX_COLOR)\n"
+        "        uniform vec2 colorScale;\n"
+        "    #endif\n"
+        "    #if defined(ALPHA_TEST)\n"
+        "        uniform int alphaReference;\n"
+        "    #endif\n"
+        "    void main() {}\n"
+        "#endif\n";
+}
+
+DOCTEST_TEST_CASE("Shader Variants")
+{
+    std::unique_ptr<Engine::Root> engine = Test::CreateRecordingEngine();
+    DOCTEST_REQUIRE(engine);
+
+    auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+    DOCTEST_REQUIRE(recorder);
+
+    Graphics::ShaderVariants::LoadFromString params;
+    params.renderContext = engine->GetSystems().Locate<Graphics::RenderContext>();
+    params.shaderCode = TestShaderCode;
+
+    recorder->BeginFrame();
+    std::unique_ptr<Graphics::ShaderVariants> variants = Graphics::ShaderVariants::Create(params).UnwrapOr(nullptr);
+    DOCTEST_REQUIRE(variants);
+
+    // Nothing is compiled until variant is requested.
+    recorder->EndFrame();
+    DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().commandCount, 0);
+    DOCTEST_CHECK_EQ(variants->GetStats().compiledPrograms, 0);
+
+    DOCTEST_SUBCASE("Lazy Compilation")
+    {
+        Graphics::ShaderPtr alphaTest = variants->GetVariant(std::vector<std::string>{ "ALPHA_TEST" });
+        DOCTEST_REQUIRE(alphaTest);
+        DOCTEST_CHECK(alphaTest->GetUniform(NAME_CONSTEXPR("alphaReference")).IsValid());
+        DOCTEST_CHECK_FALSE(alphaTest->GetUniform(NAME_CONSTEXPR("colorScale")).IsValid());
+        DOCTEST_CHECK_EQ(variants->GetStats().compiledPrograms, 1);
+
+        // Requested variants are returned without compiling again.
+        recorder->BeginFrame();
+        DOCTEST_CHECK_EQ(variants->GetVariant(std::vector<std::string>{ "ALPHA_TEST" }), alphaTest);
+        recorder->EndFrame();
+
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().commandCount, 0);
+        DOCTEST_CHECK_EQ(variants->GetStats().requestedVariants, 1);
+    }
+
+    DOCTEST_SUBCASE("Deduplication")
+    {
+        const auto unused = variants->GetKeywordMask({ "UNUSED" });
+        const auto vertexColor = variants->GetKeywordMask({ "VERTEX_COLOR" });
+
+        // Keywords that do not change code share same program.
+        Graphics::ShaderPtr base = variants->GetVariant(0);
+        DOCTEST_CHECK_EQ(variants->GetVariant(unused), base);
+        DOCTEST_CHECK_NE(variants->GetVariant(vertexColor), base);
+        DOCTEST_CHECK_EQ(variants->GetVariant(vertexColor | unused), variants->GetVariant(vertexColor));
+
+        // Undeclared keyword bits are ignored.
+        DOCTEST_CHECK_EQ(variants->GetVariant(Graphics::ShaderVariants::KeywordMask(1) << 40), base);
+
+        const Graphics::ShaderVariants::Stats& stats = variants->GetStats();
+        DOCTEST_CHECK_EQ(stats.requestedVariants, 4);
+        DOCTEST_CHECK_EQ(stats.compiledPrograms, 2);
+        DOCTEST_CHECK_EQ(stats.sharedPrograms, 2);
+    }
+
+    DOCTEST_SUBCASE("Warm Up")
+    {
+        DOCTEST_CHECK_EQ(variants->WarmUpAll(), 8);
+
+        const Graphics::ShaderVariants::Stats& stats = variants->GetStats();
+        DOCTEST_CHECK_EQ(stats.requestedVariants, 8);
+        DOCTEST_CHECK_EQ(stats.compiledPrograms, 4);
+        DOCTEST_CHECK_EQ(stats.sharedPrograms, 4);
+        DOCTEST_CHECK_EQ(stats.failedPrograms, 0);
+
+        // Warmed up variants are ready for use without issuing GL commands.
+        recorder->BeginFrame();
+        for(Graphics::ShaderVariants::KeywordMask keywords : variants->GetPreprocessor().GetPermutations())
+        {
+            DOCTEST_CHECK(variants->GetVariant(keywords));
+        }
+        recorder->EndFrame();
+
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().commandCount, 0);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().queries, 0);
+    }
+}
@@ -0,0 +1,275 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <System/ResourceManager.hpp>
+#include <System/FileSystem/NativeFileHandle.hpp>
+#include <System/FileSystem/MemoryFileHandle.hpp>
+#include <Graphics/TextureAtlas.hpp>
+#include <Graphics/TextureView.hpp>
+#include <Graphics/Sprite/SpriteAnimationList.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    const char* AtlasScript = R"(
+        TextureAtlas =
+        {
+            Texture = "Missing.png",
+
+            Regions =
+            {
+                ["full"] = { 0, 0, 128, 128 },
+                ["frame_0"] = { 0, 0, 64, 64 },
+                ["frame_1"] = { 64, 0, 128, 64 },
+                ["frame_2"] = { 0, 64, 64, 128 },
+            },
+        }
+    )";
+
+    const char* AnimationScript = R"(
+        SpriteAnimationList =
+        {
+            TextureAtlas = "Test.atlas",
+
+            Animations =
+            {
+                ["idle"] =
+                {
+                    { "frame_0", 1.0 },
+                },
+
+                ["walk"] =
+                {
+                    { "frame_0", 0.25 },
+                    { "frame_1", 0.25 },
+                    { "frame_2", 0.5 },
+                    { "missing", 0.5 },
+                },
+            },
+        }
+    )";
+
+    std::unique_ptr<Engine::Root> CreateEngine(const fs::path& cookedDirectory)
+    {
+        return Test::CreateEngine(
+        {
+            { "render.recordCommands", "true" },
+            { "engine.cookedDirectory", cookedDirectory.generic_string() },
+        });
+    }
+
+    void WriteFile(const fs::path& path, std::string_view text)
+    {
+        auto file = System::NativeFileHandle::Create(path, path,
+            System::FileHandle::OpenFlags::Write | System::FileHandle::OpenFlags::Truncate).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(file);
+        DOCTEST_REQUIRE_EQ(file->Write(reinterpret_cast<const uint8_t*>(text.data()), text.size()),
+            text.size());
+    }
+
+    template<typename Type>
+    void CompileFile(const fs::path& sourcePath, const fs::path& outputPath)
+    {
+        auto sourceFile = System::NativeFileHandle::Create(sourcePath, sourcePath,
+            System::FileHandle::OpenFlags::Read).UnwrapOr(nullptr);
+        auto outputFile = System::NativeFileHandle::Create(outputPath, outputPath,
+            System::FileHandle::OpenFlags::Write | System::FileHandle::OpenFlags::Truncate).UnwrapOr(nullptr);
+
+        DOCTEST_REQUIRE(sourceFile);
+        DOCTEST_REQUIRE(outputFile);
+        DOCTEST_REQUIRE(Type::Compile(*sourceFile, *outputFile));
+    }
+
+    std::shared_ptr<Graphics::SpriteAnimationList> LoadAnimationList(Engine::Root& engine,
+        const fs::path& path)
+    {
+        auto* resourceManager = engine.GetSystems().Locate<System::ResourceManager>();
+
+        Graphics::SpriteAnimationList::LoadFromFile params;
+        params.engineSystems = &engine.GetSystems();
+
+        return resourceManager->Acquire<Graphics::SpriteAnimationList>(path, params).UnwrapOr(nullptr);
+    }
+
+    void CheckAnimationList(const Graphics::SpriteAnimationList& animationList)
+    {
+        DOCTEST_REQUIRE_EQ(animationList.GetAnimationCount(), 2);
+        DOCTEST_CHECK_FALSE(animationList.GetAnimationIndex("run"));
+
+        auto walkIndex = animationList.GetAnimationIndex("walk");
+        DOCTEST_REQUIRE(walkIndex);
+
+        const auto* walk = animationList.GetAnimationByIndex(walkIndex.Unwrap());
+        DOCTEST_REQUIRE(walk);
+        DOCTEST_REQUIRE_EQ(walk->frames.size(), 4);
+        DOCTEST_CHECK_EQ(walk->duration, doctest::Approx(1.5f));
+
+        // Frames keep their order and reference atlas regions, or nothing when missing.
+        DOCTEST_CHECK_NE(walk->frames[0].textureView.GetTexturePtr(), nullptr);
+        DOCTEST_CHECK_NE(walk->frames[1].textureView.GetTextureRect(), walk->frames[2].textureView.GetTextureRect());
+        DOCTEST_CHECK_EQ(walk->frames[2].duration, 0.5f);
+        DOCTEST_CHECK_EQ(walk->frames[3].textureView.GetTexturePtr(), nullptr);
+        DOCTEST_CHECK_EQ(walk->GetFrameByTime(0.4f).textureView.GetTextureRect(),
+            walk->frames[1].textureView.GetTextureRect());
+
+        auto idleIndex = animationList.GetAnimationIndex("idle");
+        DOCTEST_REQUIRE(idleIndex);
+        DOCTEST_CHECK_NE(idleIndex.Unwrap(), walkIndex.Unwrap());
+        DOCTEST_CHECK_EQ(animationList.GetAnimationByIndex(idleIndex.Unwrap())->frames.size(), 1);
+    }
+}
+
+DOCTEST_TEST_CASE("Compiled Sprite Resources")
+{
+    const fs::path testDirectory = fs::temp_directory_path() / "EngineTestSpriteResources";
+    const fs::path sourceDirectory = testDirectory / "Source";
+    const fs::path compiledDirectory = testDirectory / "Compiled";
+
+    fs::remove_all(testDirectory);
+    fs::create_directories(sourceDirectory);
+    fs::create_directories(compiledDirectory);
+
+    WriteFile(sourceDirectory / "Test.atlas", AtlasScript);
+    WriteFile(sourceDirectory / "Test.animation", AnimationScript);
+
+    CompileFile<Graphics::TextureAtlas>(sourceDirectory / "Test.atlas",
+        compiledDirectory / "Test.atlas");
+    CompileFile<Graphics::SpriteAnimationList>(sourceDirectory / "Test.animation",
+        compiledDirectory / "Test.animation");
+
+    DOCTEST_SUBCASE("Script And Compiled")
+    {
+        // Compiled files shadow source scripts under same names and load same animations.
+        std::vector<glm::vec4> frameRects[2];
+        const fs::path directories[2] = { sourceDirectory, compiledDirectory };
+
+        for(int i = 0; i < 2; ++i)
+        {
+            std::unique_ptr<Engine::Root> engine = CreateEngine(directories[i]);
+            DOCTEST_REQUIRE(engine);
+
+            auto animationList = LoadAnimationList(*engine, "Test.animation");
+            DOCTEST_REQUIRE(animationList);
+            CheckAnimationList(*animationList);
+
+            const auto* walk = animationList->GetAnimationByIndex(
+                animationList->GetAnimationIndex("walk").Unwrap());
+
+            for(const auto& frame : walk->frames)
+            {
+                frameRects[i].push_back(frame.textureView.GetTextureRect());
+            }
+        }
+
+        DOCTEST_CHECK_EQ(frameRects[0], frameRects[1]);
+        DOCTEST_CHECK_LT(fs::file_size(compiledDirectory / "Test.animation"),
+            fs::file_size(sourceDirectory / "Test.animation"));
+    }
+
+    DOCTEST_SUBCASE("Region Lookup")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine(compiledDirectory);
+        DOCTEST_REQUIRE(engine);
+
+        auto* resourceManager = engine->GetSystems().Locate<System::ResourceManager>();
+
+        Graphics::TextureAtlas::LoadFromFile params;
+        params.engineSystems = &engine->GetSystems();
+
+        auto textureAtlas = resourceManager->Acquire<Graphics::TextureAtlas>(
+            "Test.atlas", params).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(textureAtlas);
+        DOCTEST_CHECK_EQ(textureAtlas->GetRegionCount(), 4);
+
+        // Regions are found by name or by hash of their name.
+        DOCTEST_CHECK_NE(textureAtlas->GetRegion("full").GetTexturePtr(), nullptr);
+        DOCTEST_CHECK_EQ(textureAtlas->GetRegion("missing").GetTexturePtr(), nullptr);
+        DOCTEST_CHECK_EQ(textureAtlas->GetRegionByHash(Graphics::TextureAtlas::GetRegionHash("frame_1")).GetTextureRect(),
+            textureAtlas->GetRegion("frame_1").GetTextureRect());
+
+        DOCTEST_CHECK(textureAtlas->AddRegion("added", glm::ivec4(0, 0, 32, 32)));
+        DOCTEST_CHECK_FALSE(textureAtlas->AddRegion("full", glm::ivec4(0, 0, 32, 32)));
+        DOCTEST_CHECK_EQ(textureAtlas->GetRegionCount(), 5);
+        DOCTEST_CHECK_NE(textureAtlas->GetRegion("added").GetTexturePtr(), nullptr);
+    }
+
+    DOCTEST_SUBCASE("Invalid Compiled File")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine("");
+        DOCTEST_REQUIRE(engine);
+
+        Graphics::TextureAtlas::LoadFromFile params;
+        params.engineSystems = &engine->GetSystems();
+
+        // Truncated compiled file is rejected instead of being read past its end.
+        auto compiledFile = System::NativeFileHandle::Create(compiledDirectory / "Test.atlas",
+            compiledDirectory / "Test.atlas", System::FileHandle::OpenFlags::Read).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(compiledFile);
+
+        std::vector<uint8_t> data = compiledFile->ReadAsBinaryArray();
+        data.resize(data.size() - 4);
+
+        auto file = System::MemoryFileHandle::Create("Test.atlas", data);
+        DOCTEST_CHECK_EQ(Graphics::TextureAtlas::Create(*file, params).UnwrapFailure(),
+            Graphics::TextureAtlas::CreateErrors::InvalidResourceContents);
+    }
+
+    fs::remove_all(testDirectory);
+}
+
+DOCTEST_TEST_CASE("Compiled Sprite Resources Benchmark" * doctest::skip())
+{
+    // Compare loading of many animation lists from scripts and from compiled files.
+    const int animationListCount = 500;
+
+    const fs::path testDirectory = fs::temp_directory_path() / "EngineBenchmarkSpriteResources";
+    const fs::path sourceDirectory = testDirectory / "Source";
+    const fs::path compiledDirectory = testDirectory / "Compiled";
+
+    fs::remove_all(testDirectory);
+    fs::create_directories(sourceDirectory);
+    fs::create_directories(compiledDirectory);
+
+    WriteFile(sourceDirectory / "Test.atlas", AtlasScript);
+    CompileFile<Graphics::TextureAtlas>(sourceDirectory / "Test.atlas",
+        compiledDirectory / "Test.atlas");
+
+    for(int i = 0; i < animationListCount; ++i)
+    {
+        const std::string fileName = fmt::format("Test{}.animation", i);
+        WriteFile(sourceDirectory / fileName, AnimationScript);
+        CompileFile<Graphics::SpriteAnimationList>(sourceDirectory / fileName,
+            compiledDirectory / fileName);
+    }
+
+    auto Measure = [&](const char* name, const fs::path& directory)
+    {
+        std::unique_ptr<Engine::Root> engine = CreateEngine(directory);
+        DOCTEST_REQUIRE(engine);
+
+        std::vector<std::shared_ptr<Graphics::SpriteAnimationList>> animationLists;
+        const double milliseconds = Test::MeasureMilliseconds([&]()
+        {
+            for(int i = 0; i < animationListCount; ++i)
+            {
+                animationLists.push_back(LoadAnimationList(*engine, fmt::format("Test{}.animation", i)));
+                DOCTEST_CHECK(animationLists.back());
+            }
+        });
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(name, milliseconds, {},
+            fmt::format("{} animation lists", animationListCount)));
+    };
+
+    Measure("Script", sourceDirectory);
+    Measure("Compiled", compiledDirectory);
+
+    fs::remove_all(testDirectory);
+}
@@ -0,0 +1,439 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/RenderContext.hpp>
+#include <Graphics/DynamicAtlas.hpp>
+#include <Graphics/Texture.hpp>
+#include <Graphics/TextureView.hpp>
+#include <Renderer/GameRenderer.hpp>
+#include <Renderer/FramePacket.hpp>
+#include <Game/GameInstance.hpp>
+#include <Game/EntitySystem.hpp>
+#include <Game/ComponentSystem.hpp>
+#include <Game/Systems/IdentitySystem.hpp>
+#include <Game/Components/TransformComponent.hpp>
+#include <Game/Components/CameraComponent.hpp>
+#include <Game/Components/SpriteComponent.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    std::unique_ptr<Engine::Root> CreateRecordingEngine(const char* dynamicAtlas,
+        const char* pageSize = "64", const char* maxPages = "2")
+    {
+        return Test::CreateRecordingEngine(
+        {
+            { "render.dynamicAtlas", dynamicAtlas },
+            { "render.atlasPageSize", pageSize },
+            { "render.atlasMaxRegionSize", "32" },
+            { "render.atlasPadding", "2" },
+            { "render.atlasMaxPages", maxPages },
+        });
+    }
+
+    std::shared_ptr<Graphics::Texture> CreateTexture(Engine::Root& engine,
+        int width, int height, GLenum format = GL_RGBA)
+    {
+        std::vector<uint8_t> pixels(static_cast<std::size_t>(width) * height * 4, 255);
+
+        Graphics::Texture::CreateFromParams params;
+        params.renderContext = engine.GetSystems().Locate<Graphics::RenderContext>();
+        params.dynamicAtlas = engine.GetSystems().Locate<Graphics::DynamicAtlas>();
+        params.format = format;
+        params.width = width;
+        params.height = height;
+        params.mipmaps = false;
+        params.data = pixels.data();
+
+        return Graphics::Texture::Create(params).UnwrapOr(nullptr);
+    }
+
+    std::unique_ptr<Game::GameInstance> CreateSpriteGame(
+        const std::vector<std::shared_ptr<Graphics::Texture>>& textures, int spriteCount)
+    {
+        auto gameInstance = Game::GameInstance::Create().UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(gameInstance);
+
+        auto* entitySystem = gameInstance->GetSystems().Locate<Game::EntitySystem>();
+        auto* componentSystem = gameInstance->GetSystems().Locate<Game::ComponentSystem>();
+        auto* identitySystem = gameInstance->GetSystems().Locate<Game::IdentitySystem>();
+
+        Game::EntityHandle cameraEntity = entitySystem->CreateEntity().Unwrap();
+        identitySystem->SetEntityName(cameraEntity, "Camera");
+        componentSystem->Create<Game::TransformComponent>(cameraEntity).Unwrap();
+        auto* camera = componentSystem->Create<Game::CameraComponent>(cameraEntity).Unwrap();
+        camera->SetupOrthogonal(glm::vec2(16.0f, 9.0f), 0.1f, 1000.0f);
+
+        // Textures are interleaved, so sprites sorted by texture are not already sorted.
+        for(int i = 0; i < spriteCount; ++i)
+        {
+            Game::EntityHandle entity = entitySystem->CreateEntity().Unwrap();
+            auto* transform = componentSystem->Create<Game::TransformComponent>(entity).Unwrap();
+            transform->SetPosition(glm::vec3(i, 0.0f, 0.0f));
+
+            auto* sprite = componentSystem->Create<Game::SpriteComponent>(entity).Unwrap();
+            sprite->SetTextureView(Graphics::TextureView(textures[i % textures.size()],
+                glm::vec4(0.0f, 0.0f, 0.5f, 1.0f)));
+        }
+
+        // Process entity creation commands.
+        gameInstance->Tick(0.0f);
+        return gameInstance;
+    }
+
+    Graphics::CommandRecorder::FrameStats DrawSpriteGame(Engine::Root& engine,
+        Game::GameInstance* gameInstance, Renderer::FramePacket& packet)
+    {
+        auto* recorder = engine.GetSystems().Locate<Graphics::CommandRecorder>();
+        auto* gameRenderer = engine.GetSystems().Locate<Renderer::GameRenderer>();
+
+        Renderer::GameRenderer::DrawParams drawParams;
+        drawParams.gameInstance = gameInstance;
+        drawParams.viewportRect = glm::ivec4(0, 0, 1024, 576);
+
+        packet.Reset();
+        gameRenderer->ExtractFramePacket(drawParams, packet);
+
+        recorder->BeginFrame();
+        gameRenderer->SubmitFramePacket(packet);
+        recorder->EndFrame();
+
+        return recorder->GetLastFrameStats();
+    }
+}
+
+DOCTEST_TEST_CASE("Dynamic Atlas")
+{
+    std::unique_ptr<Engine::Root> engine = CreateRecordingEngine("true");
+    DOCTEST_REQUIRE(engine);
+
+    auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+    auto* dynamicAtlas = engine->GetSystems().Locate<Graphics::DynamicAtlas>();
+    DOCTEST_REQUIRE(dynamicAtlas->IsEnabled());
+    DOCTEST_CHECK_EQ(dynamicAtlas->GetPageSize(), 64);
+
+    DOCTEST_SUBCASE("Packing")
+    {
+        auto first = CreateTexture(*engine, 8, 8);
+        auto second = CreateTexture(*engine, 16, 8, GL_RGB);
+        DOCTEST_REQUIRE(first);
+        DOCTEST_REQUIRE(second);
+
+        // Both textures share single page and are separated by padding.
+        const Graphics::AtlasRegion* firstRegion = first->GetAtlasRegion();
+        const Graphics::AtlasRegion* secondRegion = second->GetAtlasRegion();
+        DOCTEST_REQUIRE(firstRegion);
+        DOCTEST_REQUIRE(secondRegion);
+        DOCTEST_CHECK_EQ(firstRegion->GetPagePtr(), secondRegion->GetPagePtr());
+        DOCTEST_CHECK_EQ(firstRegion->GetPixelRect(), glm::ivec4(2, 2, 10, 10));
+        DOCTEST_CHECK_EQ(secondRegion->GetPixelRect(), glm::ivec4(14, 2, 30, 10));
+
+        // Texture view coordinates are mapped into region of page.
+        const glm::vec4 mappedRect = secondRegion->MapTextureRect(glm::vec4(0.0f, 0.0f, 0.5f, 1.0f));
+        DOCTEST_CHECK_EQ(mappedRect.x, doctest::Approx(14.0f / 64.0f));
+        DOCTEST_CHECK_EQ(mappedRect.y, doctest::Approx(2.0f / 64.0f));
+        DOCTEST_CHECK_EQ(mappedRect.z, doctest::Approx(22.0f / 64.0f));
+        DOCTEST_CHECK_EQ(mappedRect.w, doctest::Approx(10.0f / 64.0f));
+
+        // Large and single channel textures are drawn on their own.
+        auto large = CreateTexture(*engine, 40, 8);
+        auto single = CreateTexture(*engine, 8, 8, GL_RED);
+        DOCTEST_CHECK_EQ(large->GetAtlasRegion(), nullptr);
+        DOCTEST_CHECK_EQ(single->GetAtlasRegion(), nullptr);
+
+        // Updating texture would make atlas copy stale.
+        std::vector<uint8_t> pixels(8 * 8 * 4, 0);
+        first->Update(pixels.data());
+        DOCTEST_CHECK_EQ(first->GetAtlasRegion(), nullptr);
+
+        const Graphics::DynamicAtlas::Stats stats = dynamicAtlas->GetStats();
+        DOCTEST_CHECK_EQ(stats.pageCount, 1);
+        DOCTEST_CHECK_EQ(stats.regionCount, 1);
+        DOCTEST_CHECK_EQ(stats.packedRegions, 2);
+        DOCTEST_CHECK_EQ(stats.regionArea, 20 * 12);
+        DOCTEST_CHECK_EQ(stats.GetPackingEfficiency(), doctest::Approx(20.0f * 12.0f / (64.0f * 64.0f)));
+    }
+
+    DOCTEST_SUBCASE("Uploads")
+    {
+        auto page = CreateTexture(*engine, 8, 8);
+        DOCTEST_REQUIRE(page->GetAtlasRegion());
+
+        recorder->BeginFrame();
+        auto texture = CreateTexture(*engine, 8, 8);
+        recorder->EndFrame();
+
+        // Padded region is uploaded into existing page, which has its mipmaps regenerated later.
+        // Packed texture does not create texture object of its own.
+        std::vector<Graphics::CommandRecorder::CommandType> commandTypes;
+        for(const Graphics::CommandRecorder::Command& command : recorder->GetCommands())
+        {
+            commandTypes.push_back(command.type);
+        }
+
+        const auto CountCommands = [&commandTypes](Graphics::CommandRecorder::CommandType type)
+        {
+            return std::count(commandTypes.begin(), commandTypes.end(), type);
+        };
+
+        DOCTEST_CHECK_EQ(CountCommands(Graphics::CommandRecorder::CommandType::TexImage2D), 0);
+        DOCTEST_CHECK_EQ(CountCommands(Graphics::CommandRecorder::CommandType::TexSubImage2D), 1);
+        DOCTEST_CHECK_EQ(CountCommands(Graphics::CommandRecorder::CommandType::GenerateMipmap), 0);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().textureBytesUploaded, 12 * 12 * 4);
+        DOCTEST_CHECK_EQ(texture->GetHandle(), Graphics::OpenGL::InvalidHandle);
+
+        // Texture object is created once packed texture is updated.
+        const uint64_t layoutVersion = dynamicAtlas->GetLayoutVersion();
+        std::vector<uint8_t> pixels(8 * 8 * 4, 0);
+
+        recorder->BeginFrame();
+        texture->UpdateRegion(pixels.data(), 0, 0, 4, 4);
+        recorder->EndFrame();
+
+        DOCTEST_CHECK_EQ(texture->GetAtlasRegion(), nullptr);
+        DOCTEST_CHECK_NE(texture->GetHandle(), Graphics::OpenGL::InvalidHandle);
+        DOCTEST_CHECK_GT(dynamicAtlas->GetLayoutVersion(), layoutVersion);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().textureBytesUploaded, (8 * 8 + 4 * 4) * 4);
+    }
+
+    DOCTEST_SUBCASE("Mipmaps")
+    {
+        std::vector<std::shared_ptr<Graphics::Texture>> textures;
+        for(int i = 0; i < 6; ++i)
+        {
+            textures.push_back(CreateTexture(*engine, 28, 28));
+            DOCTEST_REQUIRE(textures.back()->GetAtlasRegion());
+        }
+
+        // Mipmaps of each page are generated once for all regions placed into it.
+        recorder->BeginFrame();
+        dynamicAtlas->UpdateMipmaps();
+        recorder->EndFrame();
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().commandCount, 2 * 3);
+
+        recorder->BeginFrame();
+        dynamicAtlas->UpdateMipmaps();
+        recorder->EndFrame();
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().commandCount, 0);
+    }
+
+    DOCTEST_SUBCASE("Eviction")
+    {
+        std::vector<std::shared_ptr<Graphics::Texture>> textures;
+        for(int i = 0; i < 5; ++i)
+        {
+            textures.push_back(CreateTexture(*engine, 28, 28));
+            DOCTEST_REQUIRE(textures.back()->GetAtlasRegion());
+        }
+
+        // Four padded regions fill single page.
+        DOCTEST_CHECK_EQ(dynamicAtlas->GetStats().pageCount, 2);
+        DOCTEST_CHECK_NE(textures[0]->GetAtlasRegion()->GetPagePtr(),
+            textures[4]->GetAtlasRegion()->GetPagePtr());
+
+        // Page stays alive while frame packets still reference it.
+        std::shared_ptr<const Graphics::Texture> pageReference = textures[4]->GetAtlasRegion()->GetPage();
+        std::weak_ptr<const Graphics::Texture> page = pageReference;
+        textures.pop_back();
+
+        dynamicAtlas->EvictUnused();
+        DOCTEST_CHECK_EQ(dynamicAtlas->GetStats().pageCount, 1);
+        DOCTEST_CHECK_EQ(dynamicAtlas->GetStats().evictedPages, 1);
+        DOCTEST_CHECK_FALSE(page.expired());
+
+        pageReference.reset();
+        DOCTEST_CHECK(page.expired());
+    }
+
+    DOCTEST_SUBCASE("Defragmentation")
+    {
+        std::vector<std::shared_ptr<Graphics::Texture>> textures;
+        for(int i = 0; i < 8; ++i)
+        {
+            textures.push_back(CreateTexture(*engine, 28, 28));
+            DOCTEST_REQUIRE(textures.back()->GetAtlasRegion());
+        }
+
+        // Both pages are full and page limit has been reached.
+        DOCTEST_CHECK_EQ(dynamicAtlas->GetStats().pageCount, 2);
+        DOCTEST_CHECK_FALSE(CreateTexture(*engine, 28, 28)->GetAtlasRegion());
+        DOCTEST_CHECK_EQ(dynamicAtlas->GetStats().rejectedRegions, 1);
+
+        // Releasing every other texture leaves holes that can only be reclaimed by repacking.
+        for(std::size_t i = 0; i < textures.size(); i += 2)
+        {
+            textures[i] = nullptr;
+        }
+
+        // Views keep resolved page until atlas layout changes.
+        const Graphics::TextureView textureView(textures[1]);
+        textureView.ResolveAtlas(dynamicAtlas->GetLayoutVersion());
+        const Graphics::Texture* resolvedPage = textureView.GetDrawTexturePtr();
+        DOCTEST_CHECK_EQ(resolvedPage, textures[1]->GetAtlasRegion()->GetPagePtr());
+
+        auto texture = CreateTexture(*engine, 28, 28);
+        DOCTEST_REQUIRE(texture->GetAtlasRegion());
+
+        textureView.ResolveAtlas(dynamicAtlas->GetLayoutVersion());
+        DOCTEST_CHECK_NE(textureView.GetDrawTexturePtr(), resolvedPage);
+        DOCTEST_CHECK_EQ(textureView.GetDrawTexturePtr(), textures[1]->GetAtlasRegion()->GetPagePtr());
+
+        const Graphics::DynamicAtlas::Stats stats = dynamicAtlas->GetStats();
+        DOCTEST_CHECK_EQ(stats.defragmentations, 1);
+        DOCTEST_CHECK_EQ(stats.movedRegions, 4);
+        DOCTEST_CHECK_EQ(stats.pageCount, 2);
+        DOCTEST_CHECK_EQ(stats.regionCount, 5);
+
+        // Moved regions are tightly packed in first new page.
+        for(std::size_t i = 1; i < textures.size(); i += 2)
+        {
+            DOCTEST_CHECK_EQ(textures[i]->GetAtlasRegion()->GetPagePtr(),
+                textures[1]->GetAtlasRegion()->GetPagePtr());
+        }
+
+        DOCTEST_CHECK_NE(texture->GetAtlasRegion()->GetPagePtr(),
+            textures[1]->GetAtlasRegion()->GetPagePtr());
+
+        // Nothing to reclaim when all allocated space is used.
+        DOCTEST_CHECK_FALSE(dynamicAtlas->Defragment());
+    }
+
+    DOCTEST_SUBCASE("Defragmentation Page Limit")
+    {
+        // Regions inserted in this order fit into two pages, but not when sorted for repacking.
+        const glm::ivec2 sizes[] =
+        {
+            { 32, 16 }, { 4, 28 }, { 28, 32 }, { 4, 12 },
+            { 24, 16 }, { 32, 28 }, { 24, 28 }, { 32, 28 },
+        };
+
+        std::vector<std::shared_ptr<Graphics::Texture>> textures;
+        for(const glm::ivec2& size : sizes)
+        {
+            textures.push_back(CreateTexture(*engine, size.x, size.y));
+            DOCTEST_REQUIRE(textures.back()->GetAtlasRegion());
+        }
+
+        DOCTEST_CHECK_EQ(dynamicAtlas->GetStats().pageCount, 2);
+
+        std::vector<const Graphics::Texture*> pages;
+        for(const auto& texture : textures)
+        {
+            pages.push_back(texture->GetAtlasRegion()->GetPagePtr());
+        }
+
+        // Repack that would need more pages than limit allows is abandoned.
+        textures[4] = nullptr;
+        const uint64_t layoutVersion = dynamicAtlas->GetLayoutVersion();
+        DOCTEST_CHECK_FALSE(dynamicAtlas->Defragment());
+
+        const Graphics::DynamicAtlas::Stats stats = dynamicAtlas->GetStats();
+        DOCTEST_CHECK_EQ(stats.pageCount, 2);
+        DOCTEST_CHECK_EQ(stats.defragmentations, 0);
+        DOCTEST_CHECK_EQ(stats.movedRegions, 0);
+        DOCTEST_CHECK_EQ(dynamicAtlas->GetLayoutVersion(), layoutVersion);
+
+        for(std::size_t i = 0; i < textures.size(); ++i)
+        {
+            if(textures[i] != nullptr)
+            {
+                DOCTEST_CHECK_EQ(textures[i]->GetAtlasRegion()->GetPagePtr(), pages[i]);
+            }
+        }
+    }
+}
+
+DOCTEST_TEST_CASE("Dynamic Atlas Batching")
+{
+    // Sprites using different packed textures are drawn from single page in one batch.
+    Graphics::CommandRecorder::FrameStats frameStats[2];
+    const char* dynamicAtlasValues[2] = { "false", "true" };
+
+    for(int i = 0; i < 2; ++i)
+    {
+        std::unique_ptr<Engine::Root> engine = CreateRecordingEngine(dynamicAtlasValues[i], "256", "1");
+        DOCTEST_REQUIRE(engine);
+
+        std::vector<std::shared_ptr<Graphics::Texture>> textures;
+        for(int t = 0; t < 16; ++t)
+        {
+            textures.push_back(CreateTexture(*engine, 16, 16));
+            DOCTEST_CHECK_EQ(textures.back()->GetAtlasRegion() != nullptr, i == 1);
+        }
+
+        auto gameInstance = CreateSpriteGame(textures, 64);
+        Renderer::FramePacket packet;
+        frameStats[i] = DrawSpriteGame(*engine, gameInstance.get(), packet);
+
+        // Packet references page instead of texture of each interleaved sprite.
+        DOCTEST_CHECK_EQ(packet.textureReferences.size(), i == 1 ? 1 : 64);
+
+        // Sprite coordinates are remapped into page.
+        const Graphics::Sprite::Data& spriteData = packet.spriteDrawList.GetSpriteData()[0];
+        DOCTEST_CHECK_EQ(spriteData.coords.z - spriteData.coords.x,
+            doctest::Approx(i == 1 ? 8.0f / 256.0f : 0.5f));
+    }
+
+    DOCTEST_CHECK_EQ(frameStats[0].drawCalls, 16);
+    DOCTEST_CHECK_EQ(frameStats[1].drawCalls, 1);
+    DOCTEST_CHECK_EQ(frameStats[0].drawnInstances, 64);
+    DOCTEST_CHECK_EQ(frameStats[1].drawnInstances, 64);
+    DOCTEST_CHECK_LT(frameStats[1].stateChanges, frameStats[0].stateChanges);
+}
+
+DOCTEST_TEST_CASE("Dynamic Atlas Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure draw calls and submission cost of sprites that use many
+        small textures, with and without dynamic atlas, and packing efficiency of atlas pages.
+    */
+
+    const int textureCount = 256;
+    const int spriteCount = 4096;
+    const int frameCount = 20;
+
+    for(const char* dynamicAtlas : { "false", "true" })
+    {
+        std::unique_ptr<Engine::Root> engine = CreateRecordingEngine(dynamicAtlas, "1024", "8");
+        DOCTEST_REQUIRE(engine);
+
+        auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+        recorder->SetRecordingCommands(false);
+
+        std::vector<std::shared_ptr<Graphics::Texture>> textures;
+        for(int i = 0; i < textureCount; ++i)
+        {
+            textures.push_back(CreateTexture(*engine, 16 + i % 17, 16 + i % 13));
+        }
+
+        auto gameInstance = CreateSpriteGame(textures, spriteCount);
+        Renderer::FramePacket packet;
+        Graphics::CommandRecorder::FrameStats stats;
+
+        double drawTime = 0.0;
+        for(int frame = 0; frame < frameCount; ++frame)
+        {
+            drawTime += Test::MeasureMilliseconds([&]()
+            {
+                stats = DrawSpriteGame(*engine, gameInstance.get(), packet);
+            });
+        }
+
+        const Graphics::DynamicAtlas::Stats atlasStats =
+            engine->GetSystems().Locate<Graphics::DynamicAtlas>()->GetStats();
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("Extract and submit (dynamic atlas: {})",
+            dynamicAtlas), drawTime / frameCount, "frame", fmt::format("{} draw calls, {} state changes",
+            stats.drawCalls, stats.stateChanges)));
+        DOCTEST_MESSAGE(fmt::format("Atlas pages: {}, regions: {}, packing efficiency: {:.1f}%",
+            atlasStats.pageCount, atlasStats.regionCount, 100.0f * atlasStats.GetPackingEfficiency()));
+    }
+}
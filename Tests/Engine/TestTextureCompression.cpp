@@ -0,0 +1,489 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <System/FileSystem/FileSystem.hpp>
+#include <System/FileSystem/MemoryFileHandle.hpp>
+#include <System/KtxImage.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/RenderContext.hpp>
+#include <Graphics/Texture.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    std::vector<uint8_t> Decode(System::PixelFormat format, std::vector<uint8_t> data,
+        int width = 4, int height = 4)
+    {
+        std::vector<uint8_t> pixels(static_cast<std::size_t>(width) * height *
+            System::GetPixelFormatInfo(format).channels);
+
+        DOCTEST_REQUIRE(System::DecodePixels(format, data.data(), width, height, pixels.data()));
+        return pixels;
+    }
+
+    std::vector<uint8_t> Pixel(const std::vector<uint8_t>& pixels, int index, int channels)
+    {
+        return std::vector<uint8_t>(pixels.begin() + index * channels,
+            pixels.begin() + (index + 1) * channels);
+    }
+
+    std::vector<uint8_t> WriteKtx(System::PixelFormat format, int width, int height, int levelCount)
+    {
+        // Fill levels with repeated block, so they decode to uniform color.
+        const std::vector<uint8_t> block = format == System::PixelFormat::BC7 ?
+            std::vector<uint8_t>{ 0x40, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } :
+            std::vector<uint8_t>(System::GetPixelFormatInfo(format).blockBytes, 0x80);
+
+        System::KtxImage::CreateFromParams params;
+        params.format = format;
+        params.width = width;
+        params.height = height;
+        params.keyValues["Hash"] = "1234";
+
+        for(int level = 0; level < levelCount; ++level)
+        {
+            std::vector<uint8_t> data(System::CalculateLevelSize(format,
+                std::max(1, width >> level), std::max(1, height >> level)));
+
+            for(std::size_t offset = 0; offset < data.size(); offset += block.size())
+            {
+                std::copy(block.begin(), block.end(), data.begin() + offset);
+            }
+
+            params.levels.push_back(std::move(data));
+        }
+
+        auto image = System::KtxImage::Create(params).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(image);
+
+        auto file = System::MemoryFileHandle::Create("Texture.ktx2", {},
+            System::FileHandle::OpenFlags::Write);
+        DOCTEST_REQUIRE(image->Write(*file));
+        return file->ReleaseData();
+    }
+
+    std::vector<uint8_t> EncodePNG(int width, int height)
+    {
+        png_structp png_write_ptr = png_create_write_struct(
+            PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        png_infop png_info_ptr = png_create_info_struct(png_write_ptr);
+
+        std::vector<uint8_t> encoded;
+        auto png_write_function = [](png_structp png_ptr, png_bytep data, png_size_t length)
+        {
+            auto* encoded = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png_ptr));
+            encoded->insert(encoded->end(), data, data + length);
+        };
+
+        png_set_write_fn(png_write_ptr, &encoded, png_write_function, nullptr);
+        png_set_IHDR(png_write_ptr, png_info_ptr, width, height, 8, PNG_COLOR_TYPE_RGBA,
+            PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_write_info(png_write_ptr, png_info_ptr);
+
+        std::vector<uint8_t> row(static_cast<std::size_t>(width) * 4);
+        for(int y = 0; y < height; ++y)
+        {
+            for(std::size_t i = 0; i < row.size(); ++i)
+            {
+                row[i] = static_cast<uint8_t>(i + y);
+            }
+
+            png_write_row(png_write_ptr, row.data());
+        }
+
+        png_write_end(png_write_ptr, nullptr);
+        png_destroy_write_struct(&png_write_ptr, &png_info_ptr);
+        return encoded;
+    }
+
+    std::size_t CountCommands(const Graphics::CommandRecorder& recorder,
+        Graphics::CommandRecorder::CommandType type)
+    {
+        return std::count_if(recorder.GetCommands().begin(), recorder.GetCommands().end(),
+            [type](const Graphics::CommandRecorder::Command& command)
+            {
+                return command.type == type;
+            });
+    }
+}
+
+DOCTEST_TEST_CASE("Pixel Format")
+{
+    DOCTEST_SUBCASE("Level Size")
+    {
+        DOCTEST_CHECK_EQ(System::CalculateLevelSize(System::PixelFormat::RGBA8, 5, 3), 60);
+        DOCTEST_CHECK_EQ(System::CalculateLevelSize(System::PixelFormat::BC1, 4, 4), 8);
+        DOCTEST_CHECK_EQ(System::CalculateLevelSize(System::PixelFormat::BC1, 5, 1), 16);
+        DOCTEST_CHECK_EQ(System::CalculateLevelSize(System::PixelFormat::BC7, 64, 32), 2048);
+        DOCTEST_CHECK_EQ(System::CalculateLevelSize(System::PixelFormat::ETC2_RGB8, 1, 1), 8);
+        DOCTEST_CHECK_EQ(System::CalculateLevelSize(System::PixelFormat::Unknown, 4, 4), 0);
+        DOCTEST_CHECK_EQ(System::FindPixelFormat("ETC2_RGBA8"), System::PixelFormat::ETC2_RGBA8);
+        DOCTEST_CHECK_EQ(System::FindPixelFormat("BC6H"), System::PixelFormat::Unknown);
+    }
+
+    DOCTEST_SUBCASE("BC1")
+    {
+        // Red and blue endpoints with first four pixels selecting each palette color.
+        std::vector<uint8_t> pixels = Decode(System::PixelFormat::BC1,
+            { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0x00, 0x00, 0x00 });
+
+        DOCTEST_CHECK_EQ(Pixel(pixels, 0, 4), std::vector<uint8_t>{ 255, 0, 0, 255 });
+        DOCTEST_CHECK_EQ(Pixel(pixels, 1, 4), std::vector<uint8_t>{ 0, 0, 255, 255 });
+        DOCTEST_CHECK_EQ(Pixel(pixels, 2, 4), std::vector<uint8_t>{ 170, 0, 85, 255 });
+        DOCTEST_CHECK_EQ(Pixel(pixels, 3, 4), std::vector<uint8_t>{ 85, 0, 170, 255 });
+        DOCTEST_CHECK_EQ(Pixel(pixels, 15, 4), std::vector<uint8_t>{ 255, 0, 0, 255 });
+
+        // Swapped endpoints select three colors and transparent black.
+        pixels = Decode(System::PixelFormat::BC1,
+            { 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0x00, 0x00, 0x00 });
+
+        DOCTEST_CHECK_EQ(Pixel(pixels, 2, 4), std::vector<uint8_t>{ 127, 0, 127, 255 });
+        DOCTEST_CHECK_EQ(Pixel(pixels, 3, 4), std::vector<uint8_t>{ 0, 0, 0, 0 });
+    }
+
+    DOCTEST_SUBCASE("BC4")
+    {
+        // Eight interpolated values when first value is larger.
+        std::vector<uint8_t> pixels = Decode(System::PixelFormat::BC4,
+            { 255, 0, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 });
+
+        DOCTEST_CHECK_EQ(pixels[0], 218);
+        DOCTEST_CHECK_EQ(pixels[1], 0);
+        DOCTEST_CHECK_EQ(pixels[2], 255);
+
+        // Six interpolated values and both extremes otherwise.
+        pixels = Decode(System::PixelFormat::BC4,
+            { 0, 255, 0x3E, 0x00, 0x00, 0x00, 0x00, 0x00 });
+
+        DOCTEST_CHECK_EQ(pixels[0], 0);
+        DOCTEST_CHECK_EQ(pixels[1], 255);
+    }
+
+    DOCTEST_SUBCASE("BC7")
+    {
+        // Mode 6 with first pixel at first endpoint and last pixel at second endpoint.
+        std::vector<uint8_t> pixels = Decode(System::PixelFormat::BC7,
+            { 0x40, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+              0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0 });
+
+        DOCTEST_CHECK_EQ(Pixel(pixels, 0, 4), std::vector<uint8_t>{ 1, 255, 255, 255 });
+        DOCTEST_CHECK_EQ(Pixel(pixels, 15, 4), std::vector<uint8_t>{ 255, 255, 255, 255 });
+
+        // Reserved mode decodes to transparent black.
+        pixels = Decode(System::PixelFormat::BC7, std::vector<uint8_t>(16, 0));
+        DOCTEST_CHECK_EQ(Pixel(pixels, 5, 4), std::vector<uint8_t>{ 0, 0, 0, 0 });
+    }
+
+    DOCTEST_SUBCASE("ETC2")
+    {
+        // Alpha block followed by individual mode color block, with pixel indices stored in columns.
+        std::vector<uint8_t> pixels = Decode(System::PixelFormat::ETC2_RGBA8,
+            { 0x80, 0x10, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00,
+              0x88, 0x88, 0x88, 0x00, 0x00, 0x02, 0x00, 0x02 });
+
+        DOCTEST_CHECK_EQ(Pixel(pixels, 0, 4), std::vector<uint8_t>{ 138, 138, 138, 142 });
+        DOCTEST_CHECK_EQ(Pixel(pixels, 1, 4), std::vector<uint8_t>{ 138, 138, 138, 125 });
+        DOCTEST_CHECK_EQ(Pixel(pixels, 4, 4), std::vector<uint8_t>{ 128, 128, 128, 125 });
+
+        // Eleven bit channel is rounded to eight bits.
+        pixels = Decode(System::PixelFormat::EAC_R11,
+            { 0x80, 0x10, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00 });
+
+        DOCTEST_CHECK_EQ(pixels[0], 142);
+        DOCTEST_CHECK_EQ(pixels[1], 125);
+    }
+
+    DOCTEST_SUBCASE("Partial Blocks")
+    {
+        // Pixels outside of image are clipped.
+        std::vector<uint8_t> pixels = Decode(System::PixelFormat::BC4,
+            { 255, 0, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 }, 3, 1);
+
+        DOCTEST_CHECK_EQ(pixels, std::vector<uint8_t>{ 218, 0, 255 });
+    }
+}
+
+DOCTEST_TEST_CASE("KTX Image")
+{
+    DOCTEST_SUBCASE("Round Trip")
+    {
+        std::vector<uint8_t> data = WriteKtx(System::PixelFormat::BC1, 8, 4, 4);
+        auto file = System::MemoryFileHandle::Create("Texture.ktx2", data);
+
+        auto image = System::KtxImage::Create(*file).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(image);
+        DOCTEST_CHECK_EQ(image->GetFormat(), System::PixelFormat::BC1);
+        DOCTEST_CHECK_EQ(image->GetWidth(), 8);
+        DOCTEST_CHECK_EQ(image->GetHeight(), 4);
+        DOCTEST_CHECK_EQ(image->GetLevelCount(), 4);
+        DOCTEST_CHECK_EQ(image->GetLevelSize(0), 16);
+        DOCTEST_CHECK_EQ(image->GetLevelSize(3), 8);
+        DOCTEST_CHECK_EQ(image->GetLevelWidth(2), 2);
+        DOCTEST_CHECK_EQ(image->GetLevelHeight(2), 1);
+        DOCTEST_CHECK_EQ(image->GetLevelData(0)[0], 0x80);
+
+        DOCTEST_REQUIRE(image->FindValue("Hash"));
+        DOCTEST_CHECK_EQ(*image->FindValue("Hash"), "1234");
+        DOCTEST_REQUIRE(image->FindValue("KTXorientation"));
+        DOCTEST_CHECK_EQ(*image->FindValue("KTXorientation"), "ru");
+
+        // Levels are stored from smallest to largest with aligned offsets.
+        DOCTEST_CHECK_LT(image->GetLevelData(3), image->GetLevelData(0));
+        DOCTEST_CHECK_EQ((image->GetLevelData(0) - data.data()) % 8, 0);
+    }
+
+    DOCTEST_SUBCASE("Invalid Data")
+    {
+        System::KtxImage::CreateFromParams params;
+        params.format = System::PixelFormat::BC1;
+        params.width = 4;
+        params.height = 4;
+        params.levels.push_back(std::vector<uint8_t>(7));
+        DOCTEST_CHECK_EQ(System::KtxImage::Create(params).UnwrapFailure(),
+            System::KtxImage::CreateErrors::InvalidLevelData);
+
+        auto Load = [](std::vector<uint8_t> data)
+        {
+            auto file = System::MemoryFileHandle::Create("Texture.ktx2", std::move(data));
+            return System::KtxImage::Create(*file);
+        };
+
+        const std::vector<uint8_t> valid = WriteKtx(System::PixelFormat::BC1, 4, 4, 1);
+        DOCTEST_CHECK(Load(valid));
+
+        std::vector<uint8_t> data = valid;
+        data[1] = 'X';
+        DOCTEST_CHECK_EQ(Load(data).UnwrapFailure(), System::KtxImage::CreateErrors::InvalidHeader);
+
+        data = valid;
+        data[12] = 146;
+        DOCTEST_CHECK_EQ(Load(data).UnwrapFailure(), System::KtxImage::CreateErrors::UnsupportedFormat);
+
+        data = valid;
+        data.resize(data.size() - 1);
+        DOCTEST_CHECK_EQ(Load(data).UnwrapFailure(), System::KtxImage::CreateErrors::InvalidLevelData);
+
+        // Rows stored from top to bottom cannot be flipped without decoding.
+        data = valid;
+        auto orientation = std::search(data.begin(), data.end(), "ru", "ru" + 2);
+        DOCTEST_REQUIRE(orientation != data.end());
+        orientation[1] = 'd';
+        DOCTEST_CHECK_EQ(Load(data).UnwrapFailure(), System::KtxImage::CreateErrors::UnsupportedFeature);
+    }
+}
+
+DOCTEST_TEST_CASE("Compressed Texture")
+{
+    // Cooked textures are only recognized by their identifier when cooked directory is mounted.
+    std::unique_ptr<Engine::Root> engine = Test::CreateRecordingEngine(
+    {
+        { "engine.cookedDirectory", "./" },
+    });
+    DOCTEST_REQUIRE(engine);
+    DOCTEST_REQUIRE(engine->GetSystems().Locate<System::FileSystem>()->IsCookedDirectoryMounted());
+
+    auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+    auto* renderContext = engine->GetSystems().Locate<Graphics::RenderContext>();
+
+    Graphics::Texture::LoadFromFile params;
+    params.engineSystems = &engine->GetSystems();
+
+    DOCTEST_SUBCASE("Supported Format")
+    {
+        DOCTEST_REQUIRE(renderContext->IsCompressedFormatSupported(GL_COMPRESSED_RGBA8_ETC2_EAC));
+
+        // Stored levels are uploaded as they are, without generating mipmaps.
+        auto file = System::MemoryFileHandle::Create("Texture.ktx2",
+            WriteKtx(System::PixelFormat::ETC2_RGBA8, 64, 32, 7));
+
+        recorder->BeginFrame();
+        Graphics::TexturePtr texture = Graphics::Texture::Create(*file, params).UnwrapOr(nullptr);
+        recorder->EndFrame();
+
+        DOCTEST_REQUIRE(texture);
+        DOCTEST_CHECK(texture->IsCompressed());
+        DOCTEST_CHECK_EQ(texture->GetFormat(), GL_COMPRESSED_RGBA8_ETC2_EAC);
+        DOCTEST_CHECK_EQ(texture->GetWidth(), 64);
+        DOCTEST_CHECK_EQ(texture->GetHeight(), 32);
+        DOCTEST_CHECK_EQ(texture->GetAtlasRegion(), nullptr);
+
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::CompressedTexImage2D), 7);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexImage2D), 0);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::GenerateMipmap), 0);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexParameteri), 2);
+
+        // Compressed levels take quarter of memory of uncompressed ones.
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().textureBytesUploaded,
+            2048 + 512 + 128 + 32 + 16 + 16 + 16);
+    }
+
+    DOCTEST_SUBCASE("Supported Format Without Mipmaps")
+    {
+        // Stored mip levels are skipped and only base level is sampled.
+        auto file = System::MemoryFileHandle::Create("Texture.ktx2",
+            WriteKtx(System::PixelFormat::ETC2_RGBA8, 64, 32, 7));
+
+        params.mipmaps = false;
+
+        recorder->BeginFrame();
+        Graphics::TexturePtr texture = Graphics::Texture::Create(*file, params).UnwrapOr(nullptr);
+        recorder->EndFrame();
+
+        DOCTEST_REQUIRE(texture);
+        DOCTEST_CHECK(texture->IsCompressed());
+
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::CompressedTexImage2D), 1);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::GenerateMipmap), 0);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().textureBytesUploaded, 2048);
+
+        bool maxLevelSet = false;
+        for(const Graphics::CommandRecorder::Command& command : recorder->GetCommands())
+        {
+            const Graphics::CommandRecorder::Argument* arguments =
+                recorder->GetArguments().data() + command.argumentOffset;
+
+            if(command.type == Graphics::CommandRecorder::CommandType::TexParameteri &&
+                arguments[1].integer == GL_TEXTURE_MAX_LEVEL)
+            {
+                DOCTEST_CHECK_EQ(arguments[2].integer, 0);
+                maxLevelSet = true;
+            }
+        }
+
+        DOCTEST_CHECK(maxLevelSet);
+    }
+
+    DOCTEST_SUBCASE("Decoded Fallback")
+    {
+        DOCTEST_REQUIRE_FALSE(renderContext->IsCompressedFormatSupported(GL_COMPRESSED_RGBA_BPTC_UNORM_EXT));
+
+        // Levels are decoded on CPU and uploaded uncompressed.
+        auto file = System::MemoryFileHandle::Create("Texture.ktx2",
+            WriteKtx(System::PixelFormat::BC7, 256, 256, 3));
+
+        params.atlasPacking = false;
+
+        recorder->BeginFrame();
+        Graphics::TexturePtr texture = Graphics::Texture::Create(*file, params).UnwrapOr(nullptr);
+        recorder->EndFrame();
+
+        DOCTEST_REQUIRE(texture);
+        DOCTEST_CHECK_FALSE(texture->IsCompressed());
+        DOCTEST_CHECK_EQ(texture->GetFormat(), GL_RGBA);
+
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::CompressedTexImage2D), 0);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexImage2D), 3);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::GenerateMipmap), 0);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().textureBytesUploaded,
+            (256 * 256 + 128 * 128 + 64 * 64) * 4);
+    }
+
+    DOCTEST_SUBCASE("Cooked Texture")
+    {
+        // Cooked textures keep names of their source images and are uploaded without decoding.
+        auto file = System::MemoryFileHandle::Create("Texture.png",
+            WriteKtx(System::PixelFormat::RGBA8, 64, 32, 7));
+
+        params.atlasPacking = false;
+
+        recorder->BeginFrame();
+        Graphics::TexturePtr texture = Graphics::Texture::Create(*file, params).UnwrapOr(nullptr);
+        recorder->EndFrame();
+
+        DOCTEST_REQUIRE(texture);
+        DOCTEST_CHECK_FALSE(texture->IsCompressed());
+        DOCTEST_CHECK_EQ(texture->GetFormat(), GL_RGBA);
+        DOCTEST_CHECK_EQ(texture->GetWidth(), 64);
+        DOCTEST_CHECK_EQ(texture->GetHeight(), 32);
+
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexImage2D), 7);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::GenerateMipmap), 0);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::PixelStorei), 0);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().textureBytesUploaded,
+            (64 * 32 + 32 * 16 + 16 * 8 + 8 * 4 + 4 * 2 + 2 * 1 + 1 * 1) * 4);
+    }
+
+    DOCTEST_SUBCASE("Cooked Without Mipmaps")
+    {
+        // Stored mip levels are skipped and unaligned rows are uploaded with tight packing.
+        auto file = System::MemoryFileHandle::Create("Texture.png",
+            WriteKtx(System::PixelFormat::RGB8, 5, 3, 3));
+
+        params.atlasPacking = false;
+        params.mipmaps = false;
+
+        recorder->BeginFrame();
+        Graphics::TexturePtr texture = Graphics::Texture::Create(*file, params).UnwrapOr(nullptr);
+        recorder->EndFrame();
+
+        DOCTEST_REQUIRE(texture);
+        DOCTEST_CHECK_EQ(texture->GetFormat(), GL_RGB);
+
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexImage2D), 1);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::GenerateMipmap), 0);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::PixelStorei), 2);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().textureBytesUploaded, 5 * 3 * 3);
+    }
+
+    DOCTEST_SUBCASE("Invalid File")
+    {
+        auto file = System::MemoryFileHandle::Create("Texture.ktx2", { 1, 2, 3, 4 });
+        DOCTEST_CHECK_EQ(Graphics::Texture::Create(*file, params).UnwrapFailure(),
+            Graphics::Texture::CreateErrors::FailedImageLoad);
+    }
+}
+
+DOCTEST_TEST_CASE("Cooked Texture Benchmark" * doctest::skip())
+{
+    // Compare loading of project with many textures from source images and from cooked ones.
+    // Files are held in memory, so only decoding and upload preparation are measured.
+    const int textureCount = 500;
+    const int textureSize = 256;
+
+    std::vector<uint8_t> sourceData = EncodePNG(textureSize, textureSize);
+    std::vector<uint8_t> cookedData = WriteKtx(System::PixelFormat::RGBA8,
+        textureSize, textureSize, 9);
+
+    auto Measure = [&](const char* name, const std::vector<uint8_t>& data)
+    {
+        // Cooked textures are only recognized when cooked directory is mounted.
+        std::unique_ptr<Engine::Root> engine = Test::CreateRecordingEngine(
+        {
+            { "engine.cookedDirectory", "./" },
+        });
+        DOCTEST_REQUIRE(engine);
+
+        auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+        recorder->SetRecordingCommands(false);
+
+        Graphics::Texture::LoadFromFile params;
+        params.engineSystems = &engine->GetSystems();
+        params.atlasPacking = false;
+        params.streaming = false;
+
+        std::vector<Graphics::TexturePtr> textures;
+        const double milliseconds = Test::MeasureMilliseconds([&]()
+        {
+            for(int i = 0; i < textureCount; ++i)
+            {
+                auto file = System::MemoryFileHandle::Create("Texture.png", data);
+                textures.push_back(Graphics::Texture::Create(*file, params).UnwrapOr(nullptr));
+                DOCTEST_CHECK(textures.back());
+            }
+        });
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(name, milliseconds, {},
+            fmt::format("{} textures of {} bytes", textureCount, data.size())));
+    };
+
+    Measure("Source PNG", sourceData);
+    Measure("Cooked", cookedData);
+}
@@ -0,0 +1,413 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Engine.hpp>
+#include <System/FileSystem/FileSystem.hpp>
+#include <System/FileSystem/MemoryFileHandle.hpp>
+#include <System/Image.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/Texture.hpp>
+#include <Graphics/TextureStreamer.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestEngineHeader.hpp"
+
+namespace
+{
+    std::unique_ptr<Engine::Root> CreateStreamingEngine(const char* workers,
+        const char* uploadBudget = "32768", const char* uploadChunk = "16384")
+    {
+        return Test::CreateRecordingEngine(
+        {
+            { "render.textureStreaming", "true" },
+            { "render.textureStreamWorkers", workers },
+            { "render.textureStreamMinSize", "16384" },
+            { "render.textureUploadBudget", uploadBudget },
+            { "render.textureUploadTime", "1000" },
+            { "render.textureUploadChunk", uploadChunk },
+        });
+    }
+
+    std::vector<uint8_t> EncodePNG(int width, int height, int channels)
+    {
+        png_structp png_write_ptr = png_create_write_struct(
+            PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        png_infop png_info_ptr = png_create_info_struct(png_write_ptr);
+
+        std::vector<uint8_t> encoded;
+        auto png_write_function = [](png_structp png_ptr, png_bytep data, png_size_t length)
+        {
+            auto* encoded = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png_ptr));
+            encoded->insert(encoded->end(), data, data + length);
+        };
+
+        png_set_write_fn(png_write_ptr, &encoded, png_write_function, nullptr);
+        png_set_IHDR(png_write_ptr, png_info_ptr, width, height, 8,
+            channels == 4 ? PNG_COLOR_TYPE_RGBA : PNG_COLOR_TYPE_RGB,
+            PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_write_info(png_write_ptr, png_info_ptr);
+
+        // Horizontal gradient, so downsampled placeholder can be verified.
+        std::vector<uint8_t> row(static_cast<std::size_t>(width) * channels);
+        for(int x = 0; x < width; ++x)
+        {
+            for(int c = 0; c < channels; ++c)
+            {
+                row[x * channels + c] = static_cast<uint8_t>(x * 255 / (width - 1));
+            }
+        }
+
+        for(int y = 0; y < height; ++y)
+        {
+            png_write_row(png_write_ptr, row.data());
+        }
+
+        png_write_end(png_write_ptr, nullptr);
+        png_destroy_write_struct(&png_write_ptr, &png_info_ptr);
+        return encoded;
+    }
+
+    Graphics::TexturePtr StreamTexture(Engine::Root& engine, int width, int height,
+        int channels = 4, bool mipmaps = true)
+    {
+        auto file = System::MemoryFileHandle::Create("Streamed.png",
+            EncodePNG(width, height, channels));
+
+        Graphics::Texture::LoadFromFile params;
+        params.engineSystems = &engine.GetSystems();
+        params.mipmaps = mipmaps;
+
+        return Graphics::Texture::Create(*file, params).UnwrapOr(nullptr);
+    }
+
+    std::size_t CountCommands(const Graphics::CommandRecorder& recorder,
+        Graphics::CommandRecorder::CommandType type)
+    {
+        return std::count_if(recorder.GetCommands().begin(), recorder.GetCommands().end(),
+            [type](const Graphics::CommandRecorder::Command& command)
+            {
+                return command.type == type;
+            });
+    }
+}
+
+DOCTEST_TEST_CASE("Image Info")
+{
+    auto file = System::MemoryFileHandle::Create("Info.png", EncodePNG(48, 20, 3));
+
+    // Description is read from header without moving file position.
+    System::Image::Info info = System::Image::ReadInfo(*file).UnwrapOr(System::Image::Info());
+    DOCTEST_CHECK_EQ(info.width, 48);
+    DOCTEST_CHECK_EQ(info.height, 20);
+    DOCTEST_CHECK_EQ(info.channels, 3);
+    DOCTEST_CHECK_EQ(file->Tell(), 0);
+
+    // Decoded image reuses memory of provided storage.
+    System::Image::Data storage;
+    storage.reserve(48 * 20 * 3);
+    const uint8_t* storageMemory = storage.data();
+
+    System::Image::LoadFromFile imageParams;
+    imageParams.storage = &storage;
+
+    auto image = System::Image::Create(*file, imageParams).UnwrapOr(nullptr);
+    DOCTEST_REQUIRE(image);
+    DOCTEST_CHECK_EQ(image->GetData(), storageMemory);
+
+    System::Image::Data data = image->ReleaseData();
+    DOCTEST_CHECK_EQ(data.size(), 48 * 20 * 3);
+    DOCTEST_CHECK_EQ(data.data(), storageMemory);
+
+    auto textFile = System::MemoryFileHandle::Create("Info.txt", { 1, 2, 3 });
+    DOCTEST_CHECK_FALSE(System::Image::ReadInfo(*textFile));
+}
+
+DOCTEST_TEST_CASE("Texture Streamer")
+{
+    DOCTEST_SUBCASE("Budgeted Uploads")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateStreamingEngine("0");
+        DOCTEST_REQUIRE(engine);
+
+        auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+        auto* textureStreamer = engine->GetSystems().Locate<Graphics::TextureStreamer>();
+        DOCTEST_REQUIRE(textureStreamer->IsEnabled());
+
+        // Texture is returned with full size and blank placeholder level before upload.
+        recorder->BeginFrame();
+        Graphics::TexturePtr texture = StreamTexture(*engine, 256, 128);
+        recorder->EndFrame();
+
+        DOCTEST_REQUIRE(texture);
+        DOCTEST_CHECK_EQ(texture->GetWidth(), 256);
+        DOCTEST_CHECK_EQ(texture->GetHeight(), 128);
+        DOCTEST_CHECK_EQ(texture->GetAtlasRegion(), nullptr);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexImage2D), 2);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexParameteri), 2);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexSubImage2D), 0);
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().textureBytesUploaded, 16 * 8 * 4);
+
+        // Each frame uploads two chunks of sixteen rows within budget.
+        // First frame also replaces placeholder with downsampled image.
+        for(int frame = 0; frame < 4; ++frame)
+        {
+            DOCTEST_CHECK_EQ(textureStreamer->GetStats().completedTextures, 0);
+
+            recorder->BeginFrame();
+            textureStreamer->ProcessUploads();
+            recorder->EndFrame();
+
+            DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexSubImage2D), 2);
+            DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexImage2D),
+                frame == 0 ? 1 : 0);
+            DOCTEST_CHECK_EQ(textureStreamer->GetStats().lastFrameUploadedBytes,
+                2 * 16 * 256 * 4 + (frame == 0 ? 16 * 8 * 4 : 0));
+        }
+
+        // Completed texture samples all of its generated mip levels.
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::TexParameteri), 2);
+        DOCTEST_CHECK_EQ(CountCommands(*recorder, Graphics::CommandRecorder::CommandType::GenerateMipmap), 1);
+
+        Graphics::TextureStreamer::Stats stats = textureStreamer->GetStats();
+        DOCTEST_CHECK_EQ(stats.requestedTextures, 1);
+        DOCTEST_CHECK_EQ(stats.completedTextures, 1);
+        DOCTEST_CHECK_EQ(stats.pendingTextures, 0);
+        DOCTEST_CHECK_EQ(stats.uploadedChunks, 8);
+        DOCTEST_CHECK_EQ(stats.uploadedBytes, 256 * 128 * 4 + 16 * 8 * 4);
+        DOCTEST_CHECK_EQ(stats.stagingPool.pooledBuffers, 1);
+        DOCTEST_CHECK(textureStreamer->IsIdle());
+
+        // Nothing is uploaded once queue is empty.
+        recorder->BeginFrame();
+        textureStreamer->ProcessUploads();
+        recorder->EndFrame();
+        DOCTEST_CHECK_EQ(recorder->GetLastFrameStats().textureBytesUploaded, 0);
+    }
+
+    DOCTEST_SUBCASE("Minimum Chunk")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateStreamingEngine("0", "1", "65536");
+        DOCTEST_REQUIRE(engine);
+
+        auto* textureStreamer = engine->GetSystems().Locate<Graphics::TextureStreamer>();
+        Graphics::TexturePtr first = StreamTexture(*engine, 128, 128, 3, false);
+        Graphics::TexturePtr second = StreamTexture(*engine, 128, 128, 3, false);
+        DOCTEST_REQUIRE(first);
+        DOCTEST_REQUIRE(second);
+
+        // Budget smaller than chunk still uploads one chunk every frame.
+        int frames = 0;
+        while(!textureStreamer->IsIdle())
+        {
+            textureStreamer->ProcessUploads();
+            frames += 1;
+            DOCTEST_REQUIRE_LE(frames, 4);
+        }
+
+        DOCTEST_CHECK_EQ(frames, 2);
+        DOCTEST_CHECK_EQ(textureStreamer->GetStats().completedTextures, 2);
+        DOCTEST_CHECK_EQ(textureStreamer->GetStats().uploadedChunks, 2);
+    }
+
+    DOCTEST_SUBCASE("Small Textures")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateStreamingEngine("0");
+        DOCTEST_REQUIRE(engine);
+
+        // Images under minimum size are loaded synchronously and packed into atlas.
+        auto* textureStreamer = engine->GetSystems().Locate<Graphics::TextureStreamer>();
+        Graphics::TexturePtr texture = StreamTexture(*engine, 16, 16);
+        DOCTEST_REQUIRE(texture);
+        DOCTEST_CHECK_NE(texture->GetAtlasRegion(), nullptr);
+        DOCTEST_CHECK_EQ(textureStreamer->GetStats().requestedTextures, 0);
+        DOCTEST_CHECK(textureStreamer->IsIdle());
+    }
+
+    DOCTEST_SUBCASE("Without Renderer")
+    {
+        std::unique_ptr<Engine::Root> engine = Test::CreateEngine();
+        DOCTEST_REQUIRE(engine);
+        DOCTEST_REQUIRE_FALSE(engine->GetSystems().Has<Graphics::TextureStreamer>());
+
+        // Engine without render context fails to load textures instead of streaming them.
+        DOCTEST_CHECK_EQ(StreamTexture(*engine, 256, 128), nullptr);
+        DOCTEST_CHECK_EQ(StreamTexture(*engine, 16, 16), nullptr);
+    }
+
+    DOCTEST_SUBCASE("Worker Decode")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateStreamingEngine("2");
+        DOCTEST_REQUIRE(engine);
+
+        auto* textureStreamer = engine->GetSystems().Locate<Graphics::TextureStreamer>();
+
+        std::vector<Graphics::TexturePtr> textures;
+        for(int i = 0; i < 8; ++i)
+        {
+            textures.push_back(StreamTexture(*engine, 128, 64 + i));
+            DOCTEST_REQUIRE(textures.back());
+        }
+
+        // Destroyed texture is skipped instead of being uploaded.
+        textures.erase(textures.begin() + 3);
+        textureStreamer->Finish();
+
+        Graphics::TextureStreamer::Stats stats = textureStreamer->GetStats();
+        DOCTEST_CHECK_EQ(stats.requestedTextures, 8);
+        DOCTEST_CHECK_EQ(stats.completedTextures, 7);
+        DOCTEST_CHECK_EQ(stats.cancelledTextures, 1);
+        DOCTEST_CHECK_EQ(stats.failedTextures, 0);
+        DOCTEST_CHECK_EQ(stats.pendingTextures, 0);
+
+        // Staging buffers of completed uploads are decoded into again.
+        textures.push_back(StreamTexture(*engine, 128, 64));
+        textureStreamer->Finish();
+
+        stats = textureStreamer->GetStats();
+        DOCTEST_CHECK_EQ(stats.completedTextures, 8);
+        DOCTEST_CHECK_EQ(stats.stagingPool.reusedBuffers, 1);
+    }
+
+    DOCTEST_SUBCASE("Worker Decode Failure")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateStreamingEngine("2");
+        DOCTEST_REQUIRE(engine);
+
+        auto* textureStreamer = engine->GetSystems().Locate<Graphics::TextureStreamer>();
+
+        // Image with valid header is streamed, but its truncated pixel data fails to decode.
+        std::vector<uint8_t> encoded = EncodePNG(256, 64, 4);
+        encoded.resize(encoded.size() / 2);
+
+        auto file = System::MemoryFileHandle::Create("Streamed.png", std::move(encoded));
+
+        Graphics::Texture::LoadFromFile params;
+        params.engineSystems = &engine->GetSystems();
+
+        Graphics::TexturePtr texture = Graphics::Texture::Create(*file, params).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(texture);
+
+        textureStreamer->Finish();
+
+        // Staging buffer of failed decode is returned to pool.
+        Graphics::TextureStreamer::Stats stats = textureStreamer->GetStats();
+        DOCTEST_CHECK_EQ(stats.requestedTextures, 1);
+        DOCTEST_CHECK_EQ(stats.completedTextures, 0);
+        DOCTEST_CHECK_EQ(stats.failedTextures, 1);
+        DOCTEST_CHECK_EQ(stats.pendingTextures, 0);
+        DOCTEST_CHECK_EQ(stats.stagingPool.pooledBuffers, 1);
+        DOCTEST_CHECK_EQ(stats.stagingPool.pooledBytes, 256 * 64 * 4);
+    }
+
+    DOCTEST_SUBCASE("Worker File Read")
+    {
+        std::unique_ptr<Engine::Root> engine = CreateStreamingEngine("2");
+        DOCTEST_REQUIRE(engine);
+
+        auto* fileSystem = engine->GetSystems().Locate<System::FileSystem>();
+        auto* textureStreamer = engine->GetSystems().Locate<Graphics::TextureStreamer>();
+
+        const fs::path texturePath = "TestTextureStreamerFile.png";
+        {
+            const std::vector<uint8_t> encoded = EncodePNG(256, 64, 4);
+            std::ofstream file(texturePath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+        }
+
+        // Files from file system are reopened for workers to read after caller closes them.
+        Graphics::TexturePtr texture;
+        {
+            auto file = fileSystem->OpenFile(texturePath).UnwrapOr(nullptr);
+            DOCTEST_REQUIRE(file);
+
+            Graphics::Texture::LoadFromFile params;
+            params.engineSystems = &engine->GetSystems();
+            texture = Graphics::Texture::Create(*file, params).UnwrapOr(nullptr);
+            DOCTEST_REQUIRE(texture);
+        }
+
+        textureStreamer->Finish();
+
+        Graphics::TextureStreamer::Stats stats = textureStreamer->GetStats();
+        DOCTEST_CHECK_EQ(stats.requestedTextures, 1);
+        DOCTEST_CHECK_EQ(stats.completedTextures, 1);
+        DOCTEST_CHECK_EQ(stats.failedTextures, 0);
+        DOCTEST_CHECK_EQ(stats.uploadedBytes, 256 * 64 * 4 + 16 * 4 * 4);
+
+        fs::remove(texturePath);
+    }
+}
+
+DOCTEST_TEST_CASE("Texture Streamer Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to compare time that requesting thread is blocked for when loading large
+        textures synchronously and with streaming, and longest time spent uploading in one frame.
+    */
+
+    const int textureCount = 16;
+    const int textureSize = 1024;
+
+    std::vector<uint8_t> encoded = EncodePNG(textureSize, textureSize, 4);
+
+    auto Measure = [&](const char* name, bool streaming)
+    {
+        std::unique_ptr<Engine::Root> engine = Test::CreateRecordingEngine(
+        {
+            { "render.textureStreaming", streaming ? "true" : "false" },
+        });
+        DOCTEST_REQUIRE(engine);
+
+        auto* recorder = engine->GetSystems().Locate<Graphics::CommandRecorder>();
+        auto* textureStreamer = engine->GetSystems().Locate<Graphics::TextureStreamer>();
+        recorder->SetRecordingCommands(false);
+
+        Graphics::Texture::LoadFromFile params;
+        params.engineSystems = &engine->GetSystems();
+
+        std::vector<Graphics::TexturePtr> textures;
+        Test::Stopwatch stopwatch;
+
+        for(int i = 0; i < textureCount; ++i)
+        {
+            auto file = System::MemoryFileHandle::Create("Benchmark.png", encoded);
+            textures.push_back(Graphics::Texture::Create(*file, params).UnwrapOr(nullptr));
+            DOCTEST_CHECK(textures.back());
+        }
+
+        const double requestMilliseconds = stopwatch.GetMilliseconds();
+
+        // Upload streamed textures over frames, counting only frames that uploaded anything.
+        int frames = 0;
+        double maxFrameMilliseconds = 0.0;
+        while(!textureStreamer->IsIdle())
+        {
+            textureStreamer->ProcessUploads();
+
+            const Graphics::TextureStreamer::Stats stats = textureStreamer->GetStats();
+            if(stats.lastFrameUploadedBytes != 0)
+            {
+                maxFrameMilliseconds = std::max(maxFrameMilliseconds, stats.lastFrameUploadTime * 1000.0);
+                frames += 1;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        const double totalMilliseconds = stopwatch.GetMilliseconds();
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("{} request", name), requestMilliseconds,
+            {}, fmt::format("{} textures", textureCount)));
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("{} completion", name), totalMilliseconds,
+            {}, fmt::format("{} frames, longest frame upload {:.4f} ms", frames, maxFrameMilliseconds)));
+    };
+
+    Measure("Synchronous", false);
+    Measure("Streaming", true);
+}
@@ -0,0 +1,439 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Core/Core.hpp>
+#include <Core/ReflectionGenerated.hpp>
+#include <Game/ReflectionGenerated.hpp>
+#include <Game/GameInstance.hpp>
+#include <Game/EntitySystem.hpp>
+#include <Game/ComponentSystem.hpp>
+#include <Game/Components/TransformComponent.hpp>
+#include <Game/Components/ScriptComponent.hpp>
+#include <Game/Systems/ScriptSystem.hpp>
+#include <Script/ScriptState.hpp>
+#include <Script/ScriptBindings.hpp>
+#include <Common/Test/Benchmark.hpp>
+
+namespace
+{
+    struct TestScene
+    {
+        TestScene()
+        {
+            gameInstance = Game::GameInstance::Create().UnwrapOr(nullptr);
+            DOCTEST_REQUIRE(gameInstance);
+
+            entitySystem = gameInstance->GetSystems().Locate<Game::EntitySystem>();
+            componentSystem = gameInstance->GetSystems().Locate<Game::ComponentSystem>();
+            scriptSystem = gameInstance->GetSystems().Locate<Game::ScriptSystem>();
+            DOCTEST_REQUIRE(entitySystem);
+            DOCTEST_REQUIRE(componentSystem);
+            DOCTEST_REQUIRE(scriptSystem);
+        }
+
+        void CreateEntities(std::size_t entityCount, Common::Name behavior)
+        {
+            for(std::size_t i = 0; i < entityCount; ++i)
+            {
+                Game::EntityHandle entity = entitySystem->CreateEntity().Unwrap();
+                componentSystem->Create<Game::TransformComponent>(entity).Unwrap();
+                auto* script = componentSystem->Create<Game::ScriptComponent>(entity).Unwrap();
+                script->SetBehavior(behavior);
+                entities.push_back(entity);
+            }
+
+            entitySystem->ProcessCommands();
+        }
+
+        Game::TransformComponent* GetTransform(std::size_t index)
+        {
+            return componentSystem->Lookup<Game::TransformComponent>(entities[index]).Unwrap();
+        }
+
+        Game::ScriptComponent* GetScript(std::size_t index)
+        {
+            return componentSystem->Lookup<Game::ScriptComponent>(entities[index]).Unwrap();
+        }
+
+        lua_Integer GetGlobalInteger(const char* name)
+        {
+            lua_State* state = *scriptSystem->GetScriptState();
+            lua_getglobal(state, name);
+            const lua_Integer value = lua_tointeger(state, -1);
+            lua_pop(state, 1);
+            return value;
+        }
+
+        std::unique_ptr<Game::GameInstance> gameInstance;
+        Game::EntitySystem* entitySystem = nullptr;
+        Game::ComponentSystem* componentSystem = nullptr;
+        Game::ScriptSystem* scriptSystem = nullptr;
+        std::vector<Game::EntityHandle> entities;
+    };
+
+    const char* MoveBehavior = R"(
+        local Position = Types["Game::TransformComponent"].currentPosition
+        UpdateCalls = 0
+
+        function Update(batch, timeDelta)
+            UpdateCalls = UpdateCalls + 1
+            local transforms = batch.transforms
+            for i = 1, batch.count do
+                local x, y, z = GetField(transforms[i], Position)
+                SetField(transforms[i], Position, x + timeDelta, y, z)
+            end
+        end
+    )";
+}
+
+DOCTEST_TEST_CASE("Script System")
+{
+    TestScene scene;
+
+    DOCTEST_SUBCASE("Lazy Script State")
+    {
+        // Script state is not created until behavior is loaded.
+        scene.CreateEntities(10, "Move");
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetScriptState(), nullptr);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchCalls, 0);
+
+        DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Move", MoveBehavior));
+        DOCTEST_CHECK_NE(scene.scriptSystem->GetScriptState(), nullptr);
+
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 10);
+    }
+
+    DOCTEST_SUBCASE("Batched Update")
+    {
+        DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Move", MoveBehavior));
+        DOCTEST_CHECK_FALSE(scene.scriptSystem->LoadBehavior("Move", MoveBehavior));
+        scene.CreateEntities(100, "Move");
+
+        scene.gameInstance->Tick(1.0f);
+        scene.gameInstance->Tick(1.0f);
+
+        // Update of behavior is called once per tick for all entities.
+        const auto& tickStats = scene.scriptSystem->GetTickStats();
+        DOCTEST_CHECK_EQ(tickStats.dispatchCalls, 1);
+        DOCTEST_CHECK_EQ(tickStats.dispatchedEntities, 100);
+
+        // Behaviors are executed in their own environments.
+        DOCTEST_CHECK_EQ(scene.GetGlobalInteger("UpdateCalls"), 0);
+        lua_State* state = *scene.scriptSystem->GetScriptState();
+        DOCTEST_CHECK_EQ(lua_getglobal(state, "Update"), LUA_TNIL);
+        lua_pop(state, 1);
+
+        for(std::size_t i = 0; i < scene.entities.size(); ++i)
+        {
+            DOCTEST_CHECK_EQ(scene.GetTransform(i)->GetPosition().x, 2.0f);
+        }
+    }
+
+    DOCTEST_SUBCASE("Sleeping Entities")
+    {
+        DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Move", MoveBehavior));
+        DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Idle", R"(
+            function Update(batch, timeDelta)
+                for i = 1, batch.count do
+                    Sleep(i, i == 1 and 1.5 or nil)
+                end
+            end
+        )"));
+
+        scene.CreateEntities(4, "Move");
+        scene.CreateEntities(3, "Idle");
+
+        scene.scriptSystem->Sleep(*scene.GetScript(0), 2.5f);
+        scene.GetScript(1)->Sleep();
+
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchCalls, 2);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 5);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().sleepingEntities, 2);
+
+        // Sleeping entities are not dispatched until their wake time passes.
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchCalls, 1);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 2);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().sleepingEntities, 5);
+
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 4);
+        DOCTEST_CHECK_EQ(scene.GetTransform(0)->GetPosition().x, 1.0f);
+        DOCTEST_CHECK_EQ(scene.GetTransform(1)->GetPosition().x, 0.0f);
+        DOCTEST_CHECK_EQ(scene.GetTransform(2)->GetPosition().x, 3.0f);
+
+        // Entities sleeping indefinitely are dispatched again once woken.
+        scene.GetScript(1)->Wake();
+        scene.GetScript(6)->Wake();
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 5);
+        DOCTEST_CHECK_EQ(scene.GetTransform(1)->GetPosition().x, 1.0f);
+    }
+
+    DOCTEST_SUBCASE("Coroutines")
+    {
+        DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Patrol", R"(
+            local Position = Types["Game::TransformComponent"].currentPosition
+
+            function Run(entity, transform, timeDelta)
+                for step = 1, 3 do
+                    local x, y, z = GetField(transform, Position)
+                    SetField(transform, Position, x + 1.0, y, z)
+                    timeDelta = coroutine.yield(step == 2 and 1.5 or nil)
+                end
+            end
+        )"));
+
+        scene.CreateEntities(2, "Patrol");
+
+        // Coroutine is resumed every tick unless it yields number of seconds to sleep.
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.GetTransform(0)->GetPosition().x, 1.0f);
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.GetTransform(0)->GetPosition().x, 2.0f);
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 0);
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.GetTransform(0)->GetPosition().x, 3.0f);
+
+        // Finished coroutine puts entity to sleep until it is woken and restarted.
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK(scene.GetScript(0)->IsSleeping(scene.scriptSystem->GetTime()));
+        DOCTEST_CHECK_EQ(scene.GetTransform(1)->GetPosition().x, 3.0f);
+
+        scene.GetScript(0)->Wake();
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.GetTransform(0)->GetPosition().x, 4.0f);
+        DOCTEST_CHECK_EQ(scene.GetTransform(1)->GetPosition().x, 3.0f);
+
+        // Coroutines of destroyed entities are released.
+        scene.entitySystem->DestroyEntity(scene.entities[0]);
+        scene.entitySystem->ProcessCommands();
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 0);
+    }
+
+    DOCTEST_SUBCASE("Finished Coroutines With Update")
+    {
+        DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Mixed", R"(
+            local Position = Types["Game::TransformComponent"].currentPosition
+            _G.RunCalls = 0
+
+            function Update(batch, timeDelta)
+                for i = 1, batch.count do
+                    local x, y, z = GetField(batch.transforms[i], Position)
+                    SetField(batch.transforms[i], Position, x + 1.0, y, z)
+                end
+            end
+
+            function Run(entity, transform, timeDelta)
+                _G.RunCalls = _G.RunCalls + 1
+                if entity % 2 == 0 then
+                    error("Broken entity")
+                end
+            end
+        )"));
+
+        scene.CreateEntities(2, "Mixed");
+
+        // Finished or failed coroutine does not stop entity from being updated.
+        for(int tick = 0; tick < 3; ++tick)
+        {
+            scene.gameInstance->Tick(1.0f);
+            DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 2);
+        }
+
+        for(std::size_t i = 0; i < scene.entities.size(); ++i)
+        {
+            DOCTEST_CHECK_FALSE(scene.GetScript(i)->IsSleeping(scene.scriptSystem->GetTime()));
+            DOCTEST_CHECK_EQ(scene.GetTransform(i)->GetPosition().x, 3.0f);
+        }
+
+        // Finished coroutines are not started again.
+        DOCTEST_CHECK_EQ(scene.GetGlobalInteger("RunCalls"), 2);
+    }
+
+    DOCTEST_SUBCASE("Stale Handles")
+    {
+        DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Keep", R"(
+            function Update(batch, timeDelta)
+                _G.Kept = batch.transforms[1]
+                _G.Length = #batch.transforms
+            end
+        )"));
+
+        scene.CreateEntities(3, "Keep");
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.GetGlobalInteger("Length"), 3);
+
+        // Elements past count of smaller batch are cleared.
+        scene.GetScript(1)->Sleep();
+        scene.GetScript(2)->Sleep();
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.GetGlobalInteger("Length"), 1);
+
+        // Handles kept past dispatch can no longer access components.
+        Script::ScriptState* scriptState = scene.scriptSystem->GetScriptState();
+        DOCTEST_CHECK_FALSE(scriptState->Execute(
+            "GetField(Kept, Types[\"Game::TransformComponent\"].currentPosition)"));
+        scriptState->CleanStack();
+
+        // Handles of entities are reused between dispatches.
+        DOCTEST_REQUIRE(scriptState->Execute("FirstKept = Kept"));
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK(scriptState->Execute("assert(rawequal(FirstKept, Kept))"));
+    }
+
+    DOCTEST_SUBCASE("Script Errors")
+    {
+        DOCTEST_CHECK_FALSE(scene.scriptSystem->LoadBehavior("Invalid", "function Update("));
+        DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Broken", R"(
+            function Run(entity, transform, timeDelta)
+                if entity % 2 == 0 then
+                    error("Broken entity")
+                end
+
+                coroutine.yield()
+            end
+        )"));
+
+        scene.CreateEntities(4, "Broken");
+        scene.CreateEntities(2, "Invalid");
+
+        // Failing coroutines put only their entities to sleep.
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().failedDispatches, 0);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 4);
+
+        scene.gameInstance->Tick(1.0f);
+        DOCTEST_CHECK_EQ(scene.scriptSystem->GetTickStats().dispatchedEntities, 2);
+        DOCTEST_CHECK_EQ(lua_gettop(*scene.scriptSystem->GetScriptState()), 0);
+    }
+}
+
+DOCTEST_TEST_CASE("Script System Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to compare ticking 10k scripted entities by calling script function
+        for every entity, against batched dispatch of their behavior, with and without half of
+        entities sleeping, and with per entity coroutines.
+    */
+
+    const std::size_t entityCount = 10000;
+    const int tickCount = 100;
+    const float timeDelta = 1.0f / 60.0f;
+
+    TestScene scene;
+    DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Move", MoveBehavior));
+    DOCTEST_REQUIRE(scene.scriptSystem->LoadBehavior("Wander", R"(
+        local Position = Types["Game::TransformComponent"].currentPosition
+
+        function Run(entity, transform, timeDelta)
+            while true do
+                local x, y, z = GetField(transform, Position)
+                SetField(transform, Position, x + timeDelta, y, z)
+                timeDelta = coroutine.yield()
+            end
+        end
+    )"));
+
+    lua_State* state = *scene.scriptSystem->GetScriptState();
+    DOCTEST_REQUIRE(scene.scriptSystem->GetScriptState()->Execute(R"(
+        local Position = Types["Game::TransformComponent"].currentPosition
+
+        function UpdateEntity(transform, timeDelta)
+            local x, y, z = GetField(transform, Position)
+            SetField(transform, Position, x + timeDelta, y, z)
+        end
+    )"));
+
+    scene.CreateEntities(entityCount, "Move");
+    scene.gameInstance->Tick(timeDelta);
+
+    auto Measure = [&](const char* label, auto&& function)
+    {
+        const double time = Test::MeasureMilliseconds([&]()
+        {
+            for(int tick = 0; tick < tickCount; ++tick)
+            {
+                function();
+            }
+        });
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(label, time / tickCount, "tick",
+            fmt::format("{} entities", entityCount)));
+    };
+
+    // Calling script for each entity is measured with all script components asleep,
+    // so both approaches include cost of ticking remaining game systems.
+    for(auto& script : scene.componentSystem->GetPool<Game::ScriptComponent>())
+    {
+        script.Sleep();
+    }
+
+    Measure("Tick without scripts", [&]()
+    {
+        scene.gameInstance->Tick(timeDelta);
+    });
+
+    // Single handle is pointed at transform of each entity before calling script.
+    DOCTEST_REQUIRE(scene.scriptSystem->GetScriptBindings()->PushObject<Game::TransformComponent>(state, nullptr));
+    const int handleReference = luaL_ref(state, LUA_REGISTRYINDEX);
+
+    Measure("Call per entity", [&]()
+    {
+        scene.gameInstance->Tick(timeDelta);
+
+        auto& scriptPool = scene.componentSystem->GetPool<Game::ScriptComponent>();
+        for(auto it = scriptPool.Begin(); it != scriptPool.End(); ++it)
+        {
+            auto* transform = scene.componentSystem->Lookup<
+                Game::TransformComponent>(it.GetEntityHandle()).Unwrap();
+
+            lua_getglobal(state, "UpdateEntity");
+            lua_rawgeti(state, LUA_REGISTRYINDEX, handleReference);
+            Script::ScriptBindings::SetObject(state, -1, transform);
+            lua_pushnumber(state, timeDelta);
+            lua_pcall(state, 2, 0, 0);
+        }
+    });
+
+    for(auto& script : scene.componentSystem->GetPool<Game::ScriptComponent>())
+    {
+        script.Wake();
+    }
+
+    Measure("Batched update", [&]()
+    {
+        scene.gameInstance->Tick(timeDelta);
+    });
+
+    for(std::size_t i = 0; i < entityCount; i += 2)
+    {
+        scene.GetScript(i)->Sleep();
+    }
+
+    Measure("Batched update with half sleeping", [&]()
+    {
+        scene.gameInstance->Tick(timeDelta);
+    });
+
+    for(std::size_t i = 0; i < entityCount; ++i)
+    {
+        scene.GetScript(i)->SetBehavior("Wander");
+        scene.GetScript(i)->Wake();
+    }
+
+    Measure("Batched coroutines", [&]()
+    {
+        scene.gameInstance->Tick(timeDelta);
+    });
+}
@@ -0,0 +1,423 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <random>
+#include <Core/Core.hpp>
+#include <Core/ReflectionGenerated.hpp>
+#include <Game/ReflectionGenerated.hpp>
+#include <Game/GameInstance.hpp>
+#include <Game/EntitySystem.hpp>
+#include <Game/ComponentSystem.hpp>
+#include <Game/Components/TransformComponent.hpp>
+#include <Game/Systems/SpatialGridSystem.hpp>
+#include <Common/Test/Benchmark.hpp>
+
+namespace
+{
+    using Bounds = Game::SpatialGridSystem::Bounds;
+    using EntityList = Game::SpatialGridSystem::EntityList;
+    using RayHitList = Game::SpatialGridSystem::RayHitList;
+
+    Bounds CalculateBounds(const Game::TransformComponent& transform)
+    {
+        const glm::vec2 extent(0.5f * glm::length(glm::vec2(transform.GetScale())));
+
+        Bounds bounds;
+        bounds.min = glm::vec2(transform.GetPosition()) - extent;
+        bounds.max = glm::vec2(transform.GetPosition()) + extent;
+        return bounds;
+    }
+
+    template<typename Predicate>
+    EntityList BruteForceQuery(Game::ComponentSystem* componentSystem, Predicate predicate)
+    {
+        EntityList results;
+        auto& transformPool = componentSystem->GetPool<Game::TransformComponent>();
+        for(auto it = transformPool.Begin(); it != transformPool.End(); ++it)
+        {
+            if(predicate(CalculateBounds(*it)))
+            {
+                results.push_back(it.GetEntityHandle());
+            }
+        }
+
+        std::sort(results.begin(), results.end());
+        return results;
+    }
+
+    EntityList BruteForceAabb(Game::ComponentSystem* componentSystem,
+        const glm::vec2& min, const glm::vec2& max)
+    {
+        return BruteForceQuery(componentSystem, [&min, &max](const Bounds& bounds)
+        {
+            return bounds.min.x <= max.x && bounds.max.x >= min.x
+                && bounds.min.y <= max.y && bounds.max.y >= min.y;
+        });
+    }
+
+    EntityList BruteForceRadius(Game::ComponentSystem* componentSystem,
+        const glm::vec2& center, float radius)
+    {
+        return BruteForceQuery(componentSystem, [&center, radius](const Bounds& bounds)
+        {
+            const glm::vec2 closest = glm::clamp(center, bounds.min, bounds.max);
+            return glm::length2(closest - center) <= radius * radius;
+        });
+    }
+
+    EntityList BruteForceRay(Game::ComponentSystem* componentSystem,
+        const glm::vec2& origin, const glm::vec2& direction, float maxDistance)
+    {
+        const glm::vec2 inverseDirection = 1.0f / glm::normalize(direction);
+        return BruteForceQuery(componentSystem,
+            [&origin, &inverseDirection, maxDistance](const Bounds& bounds)
+        {
+            const glm::vec2 t0 = (bounds.min - origin) * inverseDirection;
+            const glm::vec2 t1 = (bounds.max - origin) * inverseDirection;
+            const glm::vec2 tMin = glm::min(t0, t1);
+            const glm::vec2 tMax = glm::max(t0, t1);
+            return std::max(std::max(tMin.x, tMin.y), 0.0f)
+                <= std::min(std::min(tMax.x, tMax.y), maxDistance);
+        });
+    }
+
+    EntityList Sorted(EntityList entities)
+    {
+        std::sort(entities.begin(), entities.end());
+        return entities;
+    }
+
+    EntityList Sorted(const RayHitList& hits)
+    {
+        EntityList entities;
+        for(const auto& hit : hits)
+        {
+            entities.push_back(hit.entity);
+        }
+
+        std::sort(entities.begin(), entities.end());
+        return entities;
+    }
+
+    struct TestScene
+    {
+        TestScene(std::size_t entityCount, float worldSize)
+        {
+            gameInstance = Game::GameInstance::Create().UnwrapOr(nullptr);
+            DOCTEST_REQUIRE(gameInstance);
+
+            entitySystem = gameInstance->GetSystems().Locate<Game::EntitySystem>();
+            componentSystem = gameInstance->GetSystems().Locate<Game::ComponentSystem>();
+            spatialGrid = gameInstance->GetSystems().Locate<Game::SpatialGridSystem>();
+            DOCTEST_REQUIRE(entitySystem);
+            DOCTEST_REQUIRE(componentSystem);
+            DOCTEST_REQUIRE(spatialGrid);
+
+            std::uniform_real_distribution<float> positionDistribution(-worldSize, worldSize);
+            std::uniform_real_distribution<float> scaleDistribution(0.1f, 3.0f);
+
+            for(std::size_t i = 0; i < entityCount; ++i)
+            {
+                Game::EntityHandle entity = entitySystem->CreateEntity().Unwrap();
+                auto* transform = componentSystem->Create<Game::TransformComponent>(entity).Unwrap();
+                transform->SetPosition(glm::vec3(positionDistribution(random),
+                    positionDistribution(random), 0.0f));
+                transform->SetScale(glm::vec3(scaleDistribution(random)));
+                entities.push_back(entity);
+            }
+
+            entitySystem->ProcessCommands();
+        }
+
+        void MoveEntities(float maxStep)
+        {
+            std::uniform_real_distribution<float> stepDistribution(-maxStep, maxStep);
+            for(auto& transform : componentSystem->GetPool<Game::TransformComponent>())
+            {
+                transform.SetPosition(transform.GetPosition()
+                    + glm::vec3(stepDistribution(random), stepDistribution(random), 0.0f));
+            }
+        }
+
+        std::mt19937 random = std::mt19937(1337);
+        std::unique_ptr<Game::GameInstance> gameInstance;
+        Game::EntitySystem* entitySystem = nullptr;
+        Game::ComponentSystem* componentSystem = nullptr;
+        Game::SpatialGridSystem* spatialGrid = nullptr;
+        EntityList entities;
+    };
+}
+
+DOCTEST_TEST_CASE("Spatial Grid System")
+{
+    TestScene scene(2000, 100.0f);
+    scene.gameInstance->Tick(0.0f);
+    DOCTEST_CHECK_EQ(scene.spatialGrid->GetEntityCount(), 2000);
+
+    std::uniform_real_distribution<float> pointDistribution(-110.0f, 110.0f);
+    std::uniform_real_distribution<float> sizeDistribution(0.0f, 30.0f);
+
+    auto CompareQueries = [&scene, &pointDistribution, &sizeDistribution]()
+    {
+        for(int i = 0; i < 50; ++i)
+        {
+            const glm::vec2 point(pointDistribution(scene.random), pointDistribution(scene.random));
+            const glm::vec2 size(sizeDistribution(scene.random), sizeDistribution(scene.random));
+
+            EntityList aabbResults;
+            scene.spatialGrid->QueryAabb(point, point + size, aabbResults);
+            DOCTEST_CHECK_EQ(Sorted(aabbResults),
+                BruteForceAabb(scene.componentSystem, point, point + size));
+
+            EntityList radiusResults;
+            scene.spatialGrid->QueryRadius(point, size.x, radiusResults);
+            DOCTEST_CHECK_EQ(Sorted(radiusResults),
+                BruteForceRadius(scene.componentSystem, point, size.x));
+
+            const glm::vec2 direction = size - glm::vec2(15.0f);
+            if(glm::length2(direction) > 0.0f)
+            {
+                RayHitList rayResults;
+                scene.spatialGrid->QueryRay(point, direction, 80.0f, rayResults);
+                DOCTEST_CHECK_EQ(Sorted(rayResults),
+                    BruteForceRay(scene.componentSystem, point, direction, 80.0f));
+                DOCTEST_CHECK(std::is_sorted(rayResults.begin(), rayResults.end(),
+                    [](const auto& a, const auto& b) { return a.distance < b.distance; }));
+            }
+        }
+    };
+
+    DOCTEST_SUBCASE("Queries")
+    {
+        CompareQueries();
+
+        // Results are appended to caller provided buffer.
+        EntityList results = { Game::EntityHandle() };
+        std::size_t count = scene.spatialGrid->QueryAabb(
+            glm::vec2(-200.0f), glm::vec2(200.0f), results);
+        DOCTEST_CHECK_EQ(count, 2000);
+        DOCTEST_CHECK_EQ(results.size(), 2001);
+
+        // Empty regions.
+        results.clear();
+        DOCTEST_CHECK_EQ(scene.spatialGrid->QueryAabb(
+            glm::vec2(500.0f), glm::vec2(600.0f), results), 0);
+        DOCTEST_CHECK_EQ(scene.spatialGrid->QueryRadius(
+            glm::vec2(-500.0f), 10.0f, results), 0);
+    }
+
+    DOCTEST_SUBCASE("Incremental Updates")
+    {
+        // Small movements should rebucket only fraction of entities.
+        scene.MoveEntities(0.1f);
+        scene.spatialGrid->Update();
+        DOCTEST_CHECK_GT(scene.spatialGrid->GetLastUpdateRebucketCount(), 0);
+        DOCTEST_CHECK_LT(scene.spatialGrid->GetLastUpdateRebucketCount(), 1000);
+        CompareQueries();
+
+        // No movement should not rebucket anything.
+        scene.spatialGrid->Update();
+        DOCTEST_CHECK_EQ(scene.spatialGrid->GetLastUpdateRebucketCount(), 0);
+
+        // Large movements.
+        scene.MoveEntities(20.0f);
+        scene.gameInstance->Tick(0.0f);
+        CompareQueries();
+
+        // Changing cell size rebuilds grid.
+        scene.spatialGrid->SetCellSize(1.5f);
+        DOCTEST_CHECK_EQ(scene.spatialGrid->GetCellSize(), 1.5f);
+        CompareQueries();
+    }
+
+    DOCTEST_SUBCASE("Entity Destruction")
+    {
+        for(std::size_t i = 0; i < scene.entities.size(); i += 2)
+        {
+            scene.entitySystem->DestroyEntity(scene.entities[i]);
+        }
+
+        scene.gameInstance->Tick(0.0f);
+        DOCTEST_CHECK_EQ(scene.spatialGrid->GetEntityCount(), 1000);
+        CompareQueries();
+
+        // Component entries of destroyed entities are reused by new ones.
+        for(std::size_t i = 0; i < 500; ++i)
+        {
+            Game::EntityHandle entity = scene.entitySystem->CreateEntity().Unwrap();
+            auto* transform = scene.componentSystem->Create<Game::TransformComponent>(entity).Unwrap();
+            transform->SetPosition(glm::vec3(pointDistribution(scene.random),
+                pointDistribution(scene.random), 0.0f));
+        }
+
+        scene.entitySystem->ProcessCommands();
+        scene.gameInstance->Tick(0.0f);
+        DOCTEST_CHECK_EQ(scene.spatialGrid->GetEntityCount(), 1500);
+        CompareQueries();
+
+        // Transforms removed without their entities are released.
+        auto& transformPool = scene.componentSystem->GetPool<Game::TransformComponent>();
+        for(std::size_t i = 1; i < scene.entities.size(); i += 4)
+        {
+            DOCTEST_CHECK(transformPool.DestroyComponent(scene.entities[i]));
+        }
+
+        scene.spatialGrid->Update();
+        DOCTEST_CHECK_EQ(scene.spatialGrid->GetEntityCount(), 1000);
+        CompareQueries();
+
+        scene.entitySystem->DestroyAllEntities();
+        scene.gameInstance->Tick(0.0f);
+        DOCTEST_CHECK_EQ(scene.spatialGrid->GetEntityCount(), 0);
+        DOCTEST_CHECK_EQ(scene.spatialGrid->GetCellCount(), 0);
+    }
+}
+
+DOCTEST_TEST_CASE("Spatial Grid System Axis Aligned Rays")
+{
+    TestScene scene(0, 0.0f);
+
+    // Entities with bounds of two by two units, one on each side of ray origin.
+    auto CreateEntity = [&scene](const glm::vec2& position)
+    {
+        Game::EntityHandle entity = scene.entitySystem->CreateEntity().Unwrap();
+        auto* transform = scene.componentSystem->Create<Game::TransformComponent>(entity).Unwrap();
+        transform->SetPosition(glm::vec3(position, 0.0f));
+        transform->SetScale(glm::vec3(1.2f, 1.6f, 1.0f));
+        return entity;
+    };
+
+    const Game::EntityHandle up = CreateEntity(glm::vec2(0.5f, 10.0f));
+    const Game::EntityHandle down = CreateEntity(glm::vec2(0.5f, -9.0f));
+    const Game::EntityHandle right = CreateEntity(glm::vec2(10.0f, 0.5f));
+    const Game::EntityHandle left = CreateEntity(glm::vec2(-9.0f, 0.5f));
+
+    scene.entitySystem->ProcessCommands();
+    scene.spatialGrid->Update();
+    DOCTEST_CHECK_EQ(scene.spatialGrid->GetEntityCount(), 4);
+
+    auto CastRay = [&scene](const glm::vec2& origin, const glm::vec2& direction)
+    {
+        RayHitList results;
+        scene.spatialGrid->QueryRay(origin, direction, 50.0f, results);
+        return results;
+    };
+
+    DOCTEST_SUBCASE("Signed Zero Directions")
+    {
+        // Zero components of either sign must not step across cells along their axis.
+        const std::pair<glm::vec2, Game::EntityHandle> rays[] =
+        {
+            { glm::vec2(0.0f, 1.0f), up },
+            { glm::vec2(-0.0f, 1.0f), up },
+            { glm::vec2(0.0f, -1.0f), down },
+            { glm::vec2(-0.0f, -1.0f), down },
+            { glm::vec2(1.0f, 0.0f), right },
+            { glm::vec2(1.0f, -0.0f), right },
+            { glm::vec2(-1.0f, 0.0f), left },
+            { glm::vec2(-1.0f, -0.0f), left },
+        };
+
+        for(const auto& [direction, entity] : rays)
+        {
+            RayHitList results = CastRay(glm::vec2(0.5f), direction);
+            DOCTEST_REQUIRE_EQ(results.size(), 1);
+            DOCTEST_CHECK_EQ(results[0].entity, entity);
+            DOCTEST_CHECK_EQ(results[0].distance, doctest::Approx(8.5f));
+        }
+    }
+
+    DOCTEST_SUBCASE("Origin On Edge")
+    {
+        // Rays running along edges of bounds hit them.
+        RayHitList results = CastRay(glm::vec2(0.0f, 1.5f), glm::vec2(1.0f, 0.0f));
+        DOCTEST_REQUIRE_EQ(results.size(), 1);
+        DOCTEST_CHECK_EQ(results[0].entity, right);
+        DOCTEST_CHECK_EQ(results[0].distance, doctest::Approx(9.0f));
+
+        results = CastRay(glm::vec2(0.0f, -0.5f), glm::vec2(1.0f, -0.0f));
+        DOCTEST_REQUIRE_EQ(results.size(), 1);
+        DOCTEST_CHECK_EQ(results[0].entity, right);
+
+        results = CastRay(glm::vec2(-0.5f, 0.0f), glm::vec2(-0.0f, 1.0f));
+        DOCTEST_REQUIRE_EQ(results.size(), 1);
+        DOCTEST_CHECK_EQ(results[0].entity, up);
+        DOCTEST_CHECK_EQ(results[0].distance, doctest::Approx(9.0f));
+
+        // Rays starting on edge of bounds hit them at zero distance.
+        results = CastRay(glm::vec2(9.0f, 0.5f), glm::vec2(0.0f, -1.0f));
+        DOCTEST_REQUIRE_EQ(results.size(), 1);
+        DOCTEST_CHECK_EQ(results[0].entity, right);
+        DOCTEST_CHECK_EQ(results[0].distance, 0.0f);
+    }
+}
+
+DOCTEST_TEST_CASE("Spatial Grid System Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure update and query cost of 100k moving entities
+        against brute force iteration over transform components.
+    */
+
+    TestScene scene(100000, 1000.0f);
+    scene.spatialGrid->Update();
+
+    const int frameCount = 20;
+    const int queryCount = 1000;
+    std::uniform_real_distribution<float> pointDistribution(-1000.0f, 1000.0f);
+
+    double updateTime = 0.0;
+    double gridQueryTime = 0.0;
+    double bruteQueryTime = 0.0;
+    std::size_t gridResultCount = 0;
+    std::size_t bruteResultCount = 0;
+
+    EntityList results;
+    results.reserve(4096);
+
+    for(int frame = 0; frame < frameCount; ++frame)
+    {
+        scene.MoveEntities(0.5f);
+
+        updateTime += Test::MeasureMilliseconds([&]()
+        {
+            scene.spatialGrid->Update();
+        });
+
+        std::vector<glm::vec2> points(queryCount);
+        for(auto& point : points)
+        {
+            point = glm::vec2(pointDistribution(scene.random), pointDistribution(scene.random));
+        }
+
+        gridQueryTime += Test::MeasureMilliseconds([&]()
+        {
+            for(const auto& point : points)
+            {
+                results.clear();
+                gridResultCount += scene.spatialGrid->QueryRadius(point, 20.0f, results);
+            }
+        });
+
+        bruteQueryTime += Test::MeasureMilliseconds([&]()
+        {
+            for(const auto& point : points)
+            {
+                bruteResultCount += BruteForceRadius(scene.componentSystem, point, 20.0f).size();
+            }
+        });
+    }
+
+    DOCTEST_CHECK_EQ(gridResultCount, bruteResultCount);
+    DOCTEST_MESSAGE(Test::FormatBenchmark("Update", updateTime / frameCount, "frame",
+        fmt::format("rebucketed {} of 100000 entities", scene.spatialGrid->GetLastUpdateRebucketCount())));
+    DOCTEST_MESSAGE(Test::FormatBenchmark("Radius query (grid)",
+        gridQueryTime / (frameCount * queryCount), "query"));
+    DOCTEST_MESSAGE(Test::FormatBenchmark("Radius query (brute force)",
+        bruteQueryTime / (frameCount * queryCount), "query"));
+}
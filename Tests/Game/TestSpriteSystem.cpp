@@ -0,0 +1,277 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Core/Core.hpp>
+#include <Core/ReflectionGenerated.hpp>
+#include <Game/ReflectionGenerated.hpp>
+#include <Game/GameInstance.hpp>
+#include <Game/EntitySystem.hpp>
+#include <Game/ComponentSystem.hpp>
+#include <Game/Components/TransformComponent.hpp>
+#include <Game/Components/SpriteComponent.hpp>
+#include <Game/Components/SpriteAnimationComponent.hpp>
+#include <Game/Systems/SpriteSystem.hpp>
+#include <Graphics/Sprite/SpriteAnimationList.hpp>
+#include <Common/Test/Benchmark.hpp>
+
+namespace
+{
+    using Animation = Graphics::SpriteAnimationList::Animation;
+
+    Graphics::TextureView CreateFrameView(int frameIndex)
+    {
+        // Frames are told apart by their texture rectangles only.
+        const float offset = static_cast<float>(frameIndex);
+        return Graphics::TextureView(nullptr, glm::vec4(offset, 0.0f, offset + 1.0f, 1.0f));
+    }
+
+    Animation CreateAnimation(const std::vector<float>& frameDurations)
+    {
+        Animation animation;
+        for(std::size_t i = 0; i < frameDurations.size(); ++i)
+        {
+            animation.AddFrame(CreateFrameView(static_cast<int>(i)), frameDurations[i]);
+        }
+
+        return animation;
+    }
+
+    std::shared_ptr<Graphics::SpriteAnimationList> CreateAnimationList()
+    {
+        Graphics::SpriteAnimationList::CreateFromParams params;
+        params.animations.emplace_back("uniform",
+            CreateAnimation({ 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f, 0.125f }));
+        params.animations.emplace_back("varying",
+            CreateAnimation({ 0.05f, 0.1f, 0.15f, 0.2f, 0.05f, 0.1f, 0.15f, 0.2f }));
+
+        std::shared_ptr<Graphics::SpriteAnimationList> animationList =
+            Graphics::SpriteAnimationList::Create(params).UnwrapOr(nullptr);
+        DOCTEST_REQUIRE(animationList);
+        return animationList;
+    }
+
+    uint32_t LinearFrameIndexByTime(const Animation& animation, float animationTime)
+    {
+        for(std::size_t i = 0; i < animation.frames.size(); ++i)
+        {
+            if(animationTime <= animation.frames[i].duration)
+                return static_cast<uint32_t>(i);
+
+            animationTime -= animation.frames[i].duration;
+        }
+
+        return Animation::InvalidFrameIndex;
+    }
+
+    struct TestScene
+    {
+        TestScene(std::size_t entityCount)
+        {
+            gameInstance = Game::GameInstance::Create().UnwrapOr(nullptr);
+            DOCTEST_REQUIRE(gameInstance);
+
+            entitySystem = gameInstance->GetSystems().Locate<Game::EntitySystem>();
+            componentSystem = gameInstance->GetSystems().Locate<Game::ComponentSystem>();
+            spriteSystem = gameInstance->GetSystems().Locate<Game::SpriteSystem>();
+            DOCTEST_REQUIRE(entitySystem);
+            DOCTEST_REQUIRE(componentSystem);
+            DOCTEST_REQUIRE(spriteSystem);
+
+            animationList = CreateAnimationList();
+            const uint32_t animationIndices[2] =
+            {
+                animationList->GetAnimationIndex("uniform").Unwrap(),
+                animationList->GetAnimationIndex("varying").Unwrap(),
+            };
+
+            for(std::size_t i = 0; i < entityCount; ++i)
+            {
+                Game::EntityHandle entity = entitySystem->CreateEntity().Unwrap();
+                componentSystem->Create<Game::TransformComponent>(entity).Unwrap();
+                componentSystem->Create<Game::SpriteComponent>(entity).Unwrap();
+                auto* spriteAnimation = componentSystem->Create<Game::SpriteAnimationComponent>(entity).Unwrap();
+                spriteAnimation->SetSpriteAnimationList(animationList);
+                spriteAnimation->PlayByIndex(animationIndices[i % 2], true);
+                entities.push_back(entity);
+            }
+
+            entitySystem->ProcessCommands();
+        }
+
+        std::unique_ptr<Game::GameInstance> gameInstance;
+        Game::EntitySystem* entitySystem = nullptr;
+        Game::ComponentSystem* componentSystem = nullptr;
+        Game::SpriteSystem* spriteSystem = nullptr;
+        std::shared_ptr<Graphics::SpriteAnimationList> animationList;
+        std::vector<Game::EntityHandle> entities;
+    };
+}
+
+DOCTEST_TEST_CASE("Sprite Animation Frame Lookup")
+{
+    DOCTEST_SUBCASE("Uniform Frame Durations")
+    {
+        Animation animation = CreateAnimation({ 0.25f, 0.25f, 0.25f, 0.25f });
+        DOCTEST_CHECK_EQ(animation.uniformFrameDuration, 0.25f);
+        DOCTEST_CHECK_EQ(animation.duration, 1.0f);
+
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.0f), 0);
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.25f), 0);
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.3f), 1);
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.75f), 2);
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(1.0f), 3);
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(1.01f), Animation::InvalidFrameIndex);
+    }
+
+    DOCTEST_SUBCASE("Varying Frame Durations")
+    {
+        Animation animation = CreateAnimation({ 0.1f, 0.5f, 0.2f });
+        DOCTEST_CHECK_EQ(animation.uniformFrameDuration, 0.0f);
+        DOCTEST_CHECK_EQ(animation.frameEndTimes.size(), 3);
+
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.0f), 0);
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.1f), 0);
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.4f), 1);
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.7f), 2);
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.9f), Animation::InvalidFrameIndex);
+        DOCTEST_CHECK_EQ(animation.GetFrameByTime(0.4f).textureView.GetTextureRect(),
+            CreateFrameView(1).GetTextureRect());
+    }
+
+    DOCTEST_SUBCASE("Matches Linear Search")
+    {
+        std::shared_ptr<Graphics::SpriteAnimationList> animationList = CreateAnimationList();
+
+        for(std::size_t index = 0; index < animationList->GetAnimationCount(); ++index)
+        {
+            const Animation* animation = animationList->GetAnimationByIndex(index);
+            // Subtracting frame durations accumulates rounding error at animation end.
+            for(int step = 0; step < 1000; ++step)
+            {
+                const float animationTime = animation->duration * step / 1000.0f;
+                DOCTEST_CHECK_EQ(animation->GetFrameIndexByTime(animationTime),
+                    LinearFrameIndexByTime(*animation, animationTime));
+            }
+        }
+    }
+
+    DOCTEST_SUBCASE("Empty Animation")
+    {
+        Animation animation;
+        DOCTEST_CHECK_EQ(animation.GetFrameIndexByTime(0.0f), Animation::InvalidFrameIndex);
+        DOCTEST_CHECK_EQ(animation.GetFrameByTime(0.0f).textureView.GetTexturePtr(), nullptr);
+    }
+}
+
+DOCTEST_TEST_CASE("Sprite Animation List Indices")
+{
+    std::shared_ptr<Graphics::SpriteAnimationList> animationList = CreateAnimationList();
+    DOCTEST_CHECK_EQ(animationList->GetAnimationCount(), 2);
+    DOCTEST_CHECK_FALSE(animationList->GetAnimationIndex("missing"));
+
+    // Animations with same name cannot be told apart by their hashes.
+    Graphics::SpriteAnimationList::CreateFromParams duplicateParams;
+    duplicateParams.animations.emplace_back("uniform", CreateAnimation({ 1.0f }));
+    duplicateParams.animations.emplace_back("uniform", CreateAnimation({ 1.0f }));
+    DOCTEST_CHECK_EQ(Graphics::SpriteAnimationList::Create(duplicateParams).UnwrapFailure(),
+        Graphics::SpriteAnimationList::CreateErrors::InvalidArgument);
+
+    // Indices are resolved by name to same animations that were added.
+    const Animation* uniform = animationList->GetAnimationByIndex(
+        animationList->GetAnimationIndex("uniform").Unwrap());
+    const Animation* varying = animationList->GetAnimationByIndex(
+        animationList->GetAnimationIndex("varying").Unwrap());
+
+    DOCTEST_REQUIRE(uniform);
+    DOCTEST_REQUIRE(varying);
+    DOCTEST_CHECK_NE(uniform->uniformFrameDuration, 0.0f);
+    DOCTEST_CHECK_EQ(varying->uniformFrameDuration, 0.0f);
+}
+
+DOCTEST_TEST_CASE("Sprite System Animation Frames")
+{
+    TestScene scene(4);
+
+    // All sprites receive their first frame on first evaluation.
+    scene.spriteSystem->UpdateAnimationFrames(1.0f);
+    DOCTEST_CHECK_EQ(scene.spriteSystem->GetLastFrameUpdateCount(), 4);
+
+    auto* spriteAnimation = scene.componentSystem->Lookup<
+        Game::SpriteAnimationComponent>(scene.entities[0]).Unwrap();
+    DOCTEST_CHECK_EQ(spriteAnimation->GetCurrentFrameIndex(), 0);
+    DOCTEST_CHECK_EQ(spriteAnimation->GetSpriteComponent()->GetTextureView().GetTextureRect(),
+        CreateFrameView(0).GetTextureRect());
+
+    // Sprites are not updated again when displayed frame stays same.
+    scene.spriteSystem->UpdateAnimationFrames(1.0f);
+    DOCTEST_CHECK_EQ(scene.spriteSystem->GetLastFrameUpdateCount(), 0);
+
+    // Uniform animation moves to second frame, while varying one moves to third.
+    scene.gameInstance->Tick(0.2f);
+    scene.spriteSystem->UpdateAnimationFrames(1.0f);
+    DOCTEST_CHECK_EQ(scene.spriteSystem->GetLastFrameUpdateCount(), 4);
+    DOCTEST_CHECK_EQ(spriteAnimation->GetCurrentFrameIndex(), 1);
+    DOCTEST_CHECK_EQ(spriteAnimation->GetSpriteComponent()->GetTextureView().GetTextureRect(),
+        CreateFrameView(1).GetTextureRect());
+
+    // Restarting playback forces frame to be evaluated again.
+    spriteAnimation->Stop();
+    DOCTEST_CHECK_EQ(spriteAnimation->GetCurrentFrameIndex(),
+        Animation::InvalidFrameIndex);
+
+    spriteAnimation->Play("uniform", true);
+    scene.spriteSystem->UpdateAnimationFrames(1.0f);
+    DOCTEST_CHECK_EQ(scene.spriteSystem->GetLastFrameUpdateCount(), 1);
+    DOCTEST_CHECK_EQ(spriteAnimation->GetCurrentFrameIndex(), 0);
+}
+
+DOCTEST_TEST_CASE("Sprite Animation Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure cost of evaluating frames of 100k animated sprites
+        against linear frame search that updates texture view of every sprite.
+    */
+
+    TestScene scene(100000);
+
+    const int frameCount = 120;
+    const float timeDelta = 1.0f / 60.0f;
+
+    double linearTime = 0.0;
+    double batchedTime = 0.0;
+    std::size_t frameUpdateCount = 0;
+
+    for(int frame = 0; frame < frameCount; ++frame)
+    {
+        scene.gameInstance->Tick(timeDelta);
+
+        linearTime += Test::MeasureMilliseconds([&]()
+        {
+            for(auto& spriteAnimation : scene.componentSystem->GetPool<Game::SpriteAnimationComponent>())
+            {
+                const Animation* animation = spriteAnimation.GetCurrentSpriteAnimation();
+                const uint32_t frameIndex = LinearFrameIndexByTime(*animation,
+                    spriteAnimation.CalculateAnimationTime(0.5f));
+
+                spriteAnimation.GetSpriteComponent()->SetTextureView(
+                    frameIndex != Animation::InvalidFrameIndex ?
+                        animation->frames[frameIndex].textureView : Graphics::TextureView());
+            }
+        });
+
+        batchedTime += Test::MeasureMilliseconds([&]()
+        {
+            scene.spriteSystem->UpdateAnimationFrames(0.5f);
+        });
+        frameUpdateCount += scene.spriteSystem->GetLastFrameUpdateCount();
+    }
+
+    DOCTEST_MESSAGE(Test::FormatBenchmark("Linear search", linearTime / frameCount, "frame"));
+    DOCTEST_MESSAGE(Test::FormatBenchmark("Batched evaluation", batchedTime / frameCount, "frame",
+        fmt::format("updated {} of 100000 sprites", frameUpdateCount / frameCount)));
+}
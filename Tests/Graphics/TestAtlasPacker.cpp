@@ -0,0 +1,224 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <random>
+#include <Core/Core.hpp>
+#include <Graphics/AtlasPacker.hpp>
+#include <Common/Test/Benchmark.hpp>
+
+namespace
+{
+    std::unique_ptr<Graphics::AtlasPacker> CreatePacker(int width, int height, int padding)
+    {
+        Graphics::AtlasPacker::CreateFromParams params;
+        params.width = width;
+        params.height = height;
+        params.padding = padding;
+
+        return Graphics::AtlasPacker::Create(params).UnwrapOr(nullptr);
+    }
+
+    glm::ivec4 Expand(const glm::ivec4& rectangle, int padding)
+    {
+        return rectangle + glm::ivec4(-padding, -padding, padding, padding);
+    }
+
+    bool Overlaps(const glm::ivec4& left, const glm::ivec4& right)
+    {
+        return left.x < right.z && right.x < left.z && left.y < right.w && right.y < left.w;
+    }
+
+    std::vector<glm::ivec2> GenerateSizes(std::size_t count, int minSize, int maxSize)
+    {
+        std::mt19937 random(1337);
+        std::uniform_int_distribution<int> sizeDistribution(minSize, maxSize);
+
+        std::vector<glm::ivec2> sizes(count);
+        for(glm::ivec2& size : sizes)
+        {
+            size = glm::ivec2(sizeDistribution(random), sizeDistribution(random));
+        }
+
+        return sizes;
+    }
+}
+
+DOCTEST_TEST_CASE("Atlas Packer")
+{
+    DOCTEST_SUBCASE("Invalid Arguments")
+    {
+        DOCTEST_CHECK_FALSE(CreatePacker(0, 64, 0));
+        DOCTEST_CHECK_FALSE(CreatePacker(64, -1, 0));
+        DOCTEST_CHECK_FALSE(CreatePacker(64, 64, -1));
+    }
+
+    DOCTEST_SUBCASE("Skyline Placement")
+    {
+        auto packer = CreatePacker(64, 64, 0);
+        DOCTEST_REQUIRE(packer);
+
+        // Rectangles are placed next to each other along bottom edge first.
+        DOCTEST_CHECK_EQ(packer->Allocate(32, 16), std::optional(glm::ivec4(0, 0, 32, 16)));
+        DOCTEST_CHECK_EQ(packer->Allocate(16, 8), std::optional(glm::ivec4(32, 0, 48, 8)));
+        DOCTEST_CHECK_EQ(packer->Allocate(16, 24), std::optional(glm::ivec4(48, 0, 64, 24)));
+
+        // Next rectangle rests on lowest segment that it fits on.
+        DOCTEST_CHECK_EQ(packer->Allocate(16, 8), std::optional(glm::ivec4(32, 8, 48, 16)));
+        DOCTEST_CHECK_EQ(packer->Allocate(48, 8), std::optional(glm::ivec4(0, 16, 48, 24)));
+        DOCTEST_CHECK_EQ(packer->Allocate(64, 40), std::optional(glm::ivec4(0, 24, 64, 64)));
+
+        DOCTEST_CHECK_EQ(packer->GetAllocatedArea(), 64 * 64);
+        DOCTEST_CHECK_EQ(packer->GetOccupancy(), doctest::Approx(1.0f));
+        DOCTEST_CHECK_FALSE(packer->CanAllocate(1, 1));
+        DOCTEST_CHECK_FALSE(packer->Allocate(1, 1));
+
+        packer->Reset();
+        DOCTEST_CHECK_EQ(packer->GetAllocatedArea(), 0);
+        DOCTEST_CHECK_EQ(packer->Allocate(64, 64), std::optional(glm::ivec4(0, 0, 64, 64)));
+    }
+
+    DOCTEST_SUBCASE("Padding")
+    {
+        auto packer = CreatePacker(32, 32, 2);
+        DOCTEST_REQUIRE(packer);
+
+        // Padding is reserved around rectangle, including page edges.
+        DOCTEST_CHECK_EQ(packer->Allocate(8, 8), std::optional(glm::ivec4(2, 2, 10, 10)));
+        DOCTEST_CHECK_EQ(packer->Allocate(8, 8), std::optional(glm::ivec4(14, 2, 22, 10)));
+        DOCTEST_CHECK_EQ(packer->GetAllocatedArea(), 2 * 12 * 12);
+
+        DOCTEST_CHECK(packer->CanAllocate(28, 16));
+        DOCTEST_CHECK_FALSE(packer->CanAllocate(29, 1));
+        DOCTEST_CHECK_FALSE(packer->CanAllocate(1, 29));
+    }
+
+    DOCTEST_SUBCASE("No Overlaps")
+    {
+        const int padding = 1;
+        auto packer = CreatePacker(512, 512, padding);
+        DOCTEST_REQUIRE(packer);
+
+        std::vector<glm::ivec4> rectangles;
+        for(const glm::ivec2& size : GenerateSizes(400, 4, 48))
+        {
+            if(std::optional<glm::ivec4> rectangle = packer->Allocate(size.x, size.y))
+            {
+                DOCTEST_CHECK_EQ(rectangle->z - rectangle->x, size.x);
+                DOCTEST_CHECK_EQ(rectangle->w - rectangle->y, size.y);
+                rectangles.push_back(*rectangle);
+            }
+        }
+
+        DOCTEST_CHECK_GT(rectangles.size(), 100);
+
+        // Padded rectangles stay within page and never share pixels.
+        for(std::size_t i = 0; i < rectangles.size(); ++i)
+        {
+            const glm::ivec4 padded = Expand(rectangles[i], padding);
+            DOCTEST_CHECK_GE(padded.x, 0);
+            DOCTEST_CHECK_GE(padded.y, 0);
+            DOCTEST_CHECK_LE(padded.z, 512);
+            DOCTEST_CHECK_LE(padded.w, 512);
+
+            for(std::size_t j = i + 1; j < rectangles.size(); ++j)
+            {
+                DOCTEST_CHECK_FALSE(Overlaps(padded, Expand(rectangles[j], padding)));
+            }
+        }
+    }
+
+    DOCTEST_SUBCASE("Bleed Policy")
+    {
+        // Two by two image with single channel and one pixel of padding.
+        const uint8_t source[] =
+        {
+            1, 2,
+            3, 4,
+        };
+
+        uint8_t extruded[16] = {};
+        Graphics::AtlasPacker::CopyPadded(source, 2, 2, 1, 1,
+            Graphics::AtlasPacker::BleedPolicy::Extrude, extruded);
+
+        const uint8_t expectedExtruded[16] =
+        {
+            1, 1, 2, 2,
+            1, 1, 2, 2,
+            3, 3, 4, 4,
+            3, 3, 4, 4,
+        };
+
+        DOCTEST_CHECK(std::equal(std::begin(extruded), std::end(extruded),
+            std::begin(expectedExtruded)));
+
+        uint8_t transparent[16];
+        std::fill(std::begin(transparent), std::end(transparent), uint8_t(255));
+        Graphics::AtlasPacker::CopyPadded(source, 2, 2, 1, 1,
+            Graphics::AtlasPacker::BleedPolicy::Transparent, transparent);
+
+        const uint8_t expectedTransparent[16] =
+        {
+            0, 0, 0, 0,
+            0, 1, 2, 0,
+            0, 3, 4, 0,
+            0, 0, 0, 0,
+        };
+
+        DOCTEST_CHECK(std::equal(std::begin(transparent), std::end(transparent),
+            std::begin(expectedTransparent)));
+    }
+}
+
+DOCTEST_TEST_CASE("Atlas Packer Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure packing efficiency and allocation cost of filling pages
+        with small sprite textures of random sizes, both in arrival order and sorted by height.
+    */
+
+    const int pageSize = 1024;
+    const int padding = 2;
+
+    std::vector<glm::ivec2> sizes = GenerateSizes(4000, 8, 128);
+
+    auto Measure = [&](const char* name, const std::vector<glm::ivec2>& order)
+    {
+        std::vector<std::unique_ptr<Graphics::AtlasPacker>> pages;
+        int64_t imageArea = 0;
+
+        const double milliseconds = Test::MeasureMilliseconds([&]()
+        {
+            for(const glm::ivec2& size : order)
+            {
+                bool allocated = !pages.empty() && pages.back()->Allocate(size.x, size.y);
+                if(!allocated)
+                {
+                    pages.push_back(CreatePacker(pageSize, pageSize, padding));
+                    allocated = pages.back()->Allocate(size.x, size.y).has_value();
+                }
+
+                DOCTEST_CHECK(allocated);
+                imageArea += static_cast<int64_t>(size.x) * size.y;
+            }
+        });
+
+        const double pageArea = static_cast<double>(pages.size()) * pageSize * pageSize;
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(name, milliseconds, {}, fmt::format("{} images in {} pages, "
+            "{:.1f}% efficiency", order.size(), pages.size(), 100.0 * imageArea / pageArea)));
+    };
+
+    Measure("Arrival order", sizes);
+
+    std::sort(sizes.begin(), sizes.end(), [](const glm::ivec2& left, const glm::ivec2& right)
+    {
+        return left.y > right.y;
+    });
+
+    Measure("Sorted by height", sizes);
+}
@@ -0,0 +1,124 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Core/Core.hpp>
+#include <Graphics/CommandRecorder.hpp>
+#include <Graphics/RenderState.hpp>
+
+DOCTEST_TEST_CASE("Command Recorder")
+{
+    PFNGLBINDBUFFERPROC originalBindBuffer = glad_glBindBuffer;
+    PFNGLGETINTEGERVPROC originalGetIntegerv = glad_glGetIntegerv;
+
+    DOCTEST_SUBCASE("Install")
+    {
+        {
+            Graphics::CommandRecorder recorder;
+            DOCTEST_CHECK_FALSE(recorder.IsInstalled());
+            DOCTEST_CHECK_EQ(Graphics::CommandRecorder::GetInstalled(), nullptr);
+
+            DOCTEST_REQUIRE(recorder.Install());
+            DOCTEST_CHECK(recorder.IsInstalled());
+            DOCTEST_CHECK_EQ(Graphics::CommandRecorder::GetInstalled(), &recorder);
+            DOCTEST_CHECK_NE(glad_glBindBuffer, originalBindBuffer);
+
+            Graphics::CommandRecorder otherRecorder;
+            DOCTEST_CHECK_FALSE(otherRecorder.Install());
+
+            recorder.Uninstall();
+            DOCTEST_CHECK_FALSE(recorder.IsInstalled());
+            DOCTEST_CHECK_EQ(glad_glBindBuffer, originalBindBuffer);
+            DOCTEST_CHECK_EQ(glad_glGetIntegerv, originalGetIntegerv);
+
+            DOCTEST_REQUIRE(otherRecorder.Install());
+        }
+
+        DOCTEST_CHECK_EQ(Graphics::CommandRecorder::GetInstalled(), nullptr);
+        DOCTEST_CHECK_EQ(glad_glBindBuffer, originalBindBuffer);
+    }
+
+    DOCTEST_SUBCASE("Render State Stream")
+    {
+        Graphics::CommandRecorder recorder;
+        DOCTEST_REQUIRE(recorder.Install());
+
+        // Saving state only queries emulated context and restores active texture.
+        Graphics::RenderState state;
+        state.Save();
+        DOCTEST_CHECK_EQ(state.GetActiveTexture(), GL_TEXTURE0);
+        DOCTEST_CHECK_FALSE(state.IsEnabled(GL_BLEND));
+
+        recorder.BeginFrame();
+        state.Enable(GL_BLEND);
+        state.Enable(GL_BLEND);
+        state.BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+        state.Viewport(0, 0, 640, 480);
+        state.UseProgram(3);
+        state.DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        recorder.EndFrame();
+
+        const char* expectedStream =
+            "glEnable(0x0be2)\n"
+            "glBlendFuncSeparate(0x0302, 0x0303, 0x0001, 0x0000)\n"
+            "glViewport(0, 0, 640, 480)\n"
+            "glUseProgram(3)\n"
+            "glDrawArrays(0x0005, 0, 4)\n";
+
+        DOCTEST_CHECK_EQ(recorder.FormatCommands(), expectedStream);
+        DOCTEST_CHECK_EQ(recorder.GetCommands().size(), 5);
+
+        const Graphics::CommandRecorder::FrameStats& stats = recorder.GetLastFrameStats();
+        DOCTEST_CHECK_EQ(stats.commandCount, 5);
+        DOCTEST_CHECK_EQ(stats.drawCalls, 1);
+        DOCTEST_CHECK_EQ(stats.drawnInstances, 1);
+        DOCTEST_CHECK_EQ(stats.stateChanges, 4);
+        DOCTEST_CHECK_EQ(stats.redundantStateChanges, 0);
+        DOCTEST_CHECK_EQ(stats.programSwitches, 1);
+
+        // Emulated context must answer queries with recorded state.
+        Graphics::RenderState savedState;
+        savedState.Save();
+        DOCTEST_CHECK(savedState.IsEnabled(GL_BLEND));
+        DOCTEST_CHECK_EQ(savedState.GetCurrentProgram(), 3);
+
+        // Stats are reset on next frame.
+        recorder.BeginFrame();
+        DOCTEST_CHECK(recorder.GetCommands().empty());
+        DOCTEST_CHECK_EQ(recorder.GetFrameStats().commandCount, 0);
+        DOCTEST_CHECK_EQ(recorder.GetLastFrameStats().commandCount, 5);
+    }
+
+    DOCTEST_SUBCASE("Redundant State Changes")
+    {
+        Graphics::CommandRecorder recorder;
+        DOCTEST_REQUIRE(recorder.Install());
+        recorder.SetRecordingCommands(false);
+
+        recorder.BeginFrame();
+        glBindBuffer(GL_ARRAY_BUFFER, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, 1);
+        glUseProgram(2);
+        glUseProgram(2);
+        glBufferData(GL_ARRAY_BUFFER, 256, &recorder, GL_STATIC_DRAW);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 16, 8, GL_RGBA, GL_UNSIGNED_BYTE, &recorder);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 100);
+        recorder.EndFrame();
+
+        DOCTEST_CHECK(recorder.GetCommands().empty());
+
+        const Graphics::CommandRecorder::FrameStats& stats = recorder.GetLastFrameStats();
+        DOCTEST_CHECK_EQ(stats.commandCount, 7);
+        DOCTEST_CHECK_EQ(stats.stateChanges, 4);
+        DOCTEST_CHECK_EQ(stats.redundantStateChanges, 2);
+        DOCTEST_CHECK_EQ(stats.programSwitches, 1);
+        DOCTEST_CHECK_EQ(stats.bufferBytesUploaded, 256);
+        DOCTEST_CHECK_EQ(stats.textureBytesUploaded, 16 * 8 * 4);
+        DOCTEST_CHECK_EQ(stats.drawCalls, 1);
+        DOCTEST_CHECK_EQ(stats.drawnInstances, 100);
+    }
+}
@@ -0,0 +1,381 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <map>
+#include <set>
+#include <Core/Core.hpp>
+#include <Graphics/ShaderPreprocessor.hpp>
+
+namespace
+{
+    using Stage = Graphics::ShaderPreprocessor::Stage;
+
+    Graphics::ShaderPreprocessor::IncludeCallback CreateIncludeCallback(
+        std::map<std::string, std::string> files, std::vector<std::string>* requests = nullptr)
+    {
+        return [files = std::move(files), requests](const fs::path& path)
+            -> Graphics::ShaderPreprocessor::IncludeResult
+        {
+            if(requests != nullptr)
+            {
+                requests->push_back(path.generic_string());
+            }
+
+            auto it = files.find(path.generic_string());
+            if(it == files.end())
+                return Common::Failure();
+
+            return Common::Success(it->second);
+        };
+    }
+
+    std::unique_ptr<Graphics::ShaderPreprocessor> CreatePreprocessor(std::string shaderCode,
+        Graphics::ShaderPreprocessor::IncludeCallback includeCallback = nullptr)
+    {
+        Graphics::ShaderPreprocessor::LoadFromString params;
+        params.includeCallback = std::move(includeCallback);
+        params.sourcePath = "Shaders/Test.shader";
+        params.shaderCode = std::move(shaderCode);
+        return Graphics::ShaderPreprocessor::Create(params).UnwrapOr(nullptr);
+    }
+}
+
+DOCTEST_TEST_CASE("Shader Preprocessor")
+{
+    DOCTEST_SUBCASE("Stages")
+    {
+        auto preprocessor = CreatePreprocessor(
+            "#version 300 es\n"
+            "#if defined(VERTEX_SHADER)\n"
+            "    void main() { vertex(); }\n"
+            "#endif\n"
+            "#ifdef FRAGMENT_SHADER\n"
+            "    void main() { fragment(); }\n"
+            "#endif\n");
+
+        DOCTEST_REQUIRE(preprocessor);
+        DOCTEST_CHECK_EQ(preprocessor->GetVersion(), "#version 300 es\n");
+
+        Graphics::ShaderPreprocessor::ExpandedSource source = preprocessor->Expand(0);
+        DOCTEST_CHECK_EQ(source.GetStage(Stage::Vertex),
+            "#version 300 es\n"
+            "#line 3 0\n"
+            "    void main() { vertex(); }\n");
+        DOCTEST_CHECK_EQ(source.GetStage(Stage::Fragment),
+            "#version 300 es\n"
+            "#line 6 0\n"
+            "    void main() { fragment(); }\n");
+    }
+
+    DOCTEST_SUBCASE("Missing Stage")
+    {
+        auto preprocessor = CreatePreprocessor(
+            "#if defined(VERTEX_SHADER)\n"
+            "    void main() {}\n"
+            "#endif\n");
+
+        DOCTEST_REQUIRE(preprocessor);
+        DOCTEST_CHECK_FALSE(preprocessor->Expand(0).GetStage(Stage::Vertex).empty());
+        DOCTEST_CHECK(preprocessor->Expand(0).GetStage(Stage::Fragment).empty());
+    }
+
+    DOCTEST_SUBCASE("Includes")
+    {
+        std::vector<std::string> requests;
+        auto includeCallback = CreateIncludeCallback(
+            {
+                { "Shaders/Common/Lighting.glsl", "#include \"Math.glsl\"\nvec3 light();\n" },
+                { "Shaders/Common/Math.glsl", "float square(float x);\n" },
+            }, &requests);
+
+        auto preprocessor = CreatePreprocessor(
+            "#version 300 es\n"
+            "#include \"Common/Math.glsl\"\n"
+            "#include \"Common/Lighting.glsl\" // Comment\n"
+            "void main() {}\n", includeCallback);
+
+        DOCTEST_REQUIRE(preprocessor);
+
+        // Each file is loaded once, but inlined at every include site.
+        DOCTEST_CHECK_EQ(preprocessor->GetCode(),
+            "float square(float x);\n"
+            "float square(float x);\n"
+            "vec3 light();\n"
+            "void main() {}\n");
+
+        DOCTEST_CHECK_EQ(requests, std::vector<std::string>{
+            "Shaders/Common/Math.glsl", "Shaders/Common/Lighting.glsl" });
+        DOCTEST_CHECK_EQ(preprocessor->GetIncludedFiles().size(), 2);
+    }
+
+    DOCTEST_SUBCASE("Stage Includes")
+    {
+        auto includeCallback = CreateIncludeCallback(
+            {
+                { "Shaders/Common.glsl", "uniform vec4 color;\nvec4 tint(vec4 value);\n" },
+            });
+
+        auto preprocessor = CreatePreprocessor(
+            "#version 300 es\n"
+            "#if defined(VERTEX_SHADER)\n"
+            "    #include \"Common.glsl\"\n"
+            "    void main() { vertex(); }\n"
+            "#endif\n"
+            "#if defined(FRAGMENT_SHADER)\n"
+            "    #include \"Common.glsl\"\n"
+            "    #include \"Common.glsl\"\n"
+            "    void main() { fragment(); }\n"
+            "#endif\n", includeCallback);
+
+        DOCTEST_REQUIRE(preprocessor);
+        DOCTEST_CHECK_EQ(preprocessor->GetIncludedFiles().size(), 1);
+
+        // Files included by stage sections are inlined once in each stage.
+        Graphics::ShaderPreprocessor::ExpandedSource source = preprocessor->Expand(0);
+        DOCTEST_CHECK_EQ(source.GetStage(Stage::Vertex),
+            "#version 300 es\n"
+            "#line 1 1\n"
+            "uniform vec4 color;\n"
+            "vec4 tint(vec4 value);\n"
+            "#line 4 0\n"
+            "    void main() { vertex(); }\n");
+        DOCTEST_CHECK_EQ(source.GetStage(Stage::Fragment),
+            "#version 300 es\n"
+            "#line 1 1\n"
+            "uniform vec4 color;\n"
+            "vec4 tint(vec4 value);\n"
+            "#line 9 0\n"
+            "    void main() { fragment(); }\n");
+    }
+
+    DOCTEST_SUBCASE("Pass Through Includes")
+    {
+        auto includeCallback = CreateIncludeCallback(
+            {
+                { "Shaders/Shadows.glsl", "float shadow();\n" },
+            });
+
+        auto preprocessor = CreatePreprocessor(
+            "#if defined(VERTEX_SHADER)\n"
+            "  #if QUALITY > 1\n"
+            "    #include \"Shadows.glsl\"\n"
+            "  #endif\n"
+            "  #include \"Shadows.glsl\"\n"
+            "  #include \"Shadows.glsl\"\n"
+            "  void main() {}\n"
+            "#endif\n", includeCallback);
+
+        DOCTEST_REQUIRE(preprocessor);
+
+        // Inclusion inside block left for GLSL compiler may not happen.
+        DOCTEST_CHECK_EQ(preprocessor->Expand(0).GetStage(Stage::Vertex),
+            "#line 2 0\n"
+            "  #if QUALITY > 1\n"
+            "#line 1 1\n"
+            "float shadow();\n"
+            "#line 4 0\n"
+            "  #endif\n"
+            "#line 1 1\n"
+            "float shadow();\n"
+            "#line 7 0\n"
+            "  void main() {}\n");
+    }
+
+    DOCTEST_SUBCASE("Include Errors")
+    {
+        auto includeCallback = CreateIncludeCallback(
+            {
+                { "Shaders/A.glsl", "#include \"B.glsl\"\n" },
+                { "Shaders/B.glsl", "#include \"A.glsl\"\n" },
+            });
+
+        DOCTEST_CHECK_FALSE(CreatePreprocessor("#include \"A.glsl\"\n", includeCallback));
+        DOCTEST_CHECK_FALSE(CreatePreprocessor("#include \"Missing.glsl\"\n", includeCallback));
+        DOCTEST_CHECK_FALSE(CreatePreprocessor("#include \"B.glsl\"\n"));
+        DOCTEST_CHECK_FALSE(CreatePreprocessor("#include B.glsl\n", includeCallback));
+    }
+
+    DOCTEST_SUBCASE("Keywords")
+    {
+        auto preprocessor = CreatePreprocessor(
+            "#pragma keywords FOG ALPHA_TEST\n"
+            "#pragma keywords FOG SHADOWS\n"
+            "#pragma optimize(off)\n"
+            "void main() {}\n");
+
+        DOCTEST_REQUIRE(preprocessor);
+        DOCTEST_CHECK_EQ(preprocessor->GetKeywords(),
+            std::vector<std::string>{ "FOG", "ALPHA_TEST", "SHADOWS" });
+        DOCTEST_CHECK_EQ(preprocessor->GetCode(), "#pragma optimize(off)\nvoid main() {}\n");
+        DOCTEST_CHECK_EQ(preprocessor->GetKeywordMask({ "SHADOWS", "FOG" }), 0b101);
+        DOCTEST_CHECK_EQ(preprocessor->GetKeywordMask({ "UNKNOWN" }), 0);
+        DOCTEST_CHECK_EQ(preprocessor->GetAllKeywordsMask(), 0b111);
+        DOCTEST_CHECK_EQ(preprocessor->GetPermutations().size(), 8);
+
+        DOCTEST_CHECK_FALSE(CreatePreprocessor("#pragma keywords FOG +\n"));
+    }
+
+    DOCTEST_SUBCASE("Conditionals")
+    {
+        auto preprocessor = CreatePreprocessor(
+            "#pragma keywords FOG ALPHA_TEST\n"
+            "#if defined(FRAGMENT_SHADER)\n"
+            "#ifdef FOG\n"
+            "    fog();\n"
+            "#elif defined(ALPHA_TEST)\n"
+            "    alphaTest();\n"
+            "#else\n"
+            "    opaque();\n"
+            "#endif\n"
+            "#if !defined ALPHA_TEST\n"
+            "    #if MAX_LIGHTS > 4\n"
+            "        manyLights();\n"
+            "    #endif\n"
+            "#endif\n"
+            "#ifndef FOG\n"
+            "    #if defined(ALPHA_TEST)\n"
+            "        discard();\n"
+            "    #endif\n"
+            "#endif\n"
+            "#endif\n");
+
+        DOCTEST_REQUIRE(preprocessor);
+
+        auto Fragment = [&preprocessor](const std::vector<std::string>& keywords)
+        {
+            return preprocessor->Expand(preprocessor->GetKeywordMask(keywords))
+                .GetStage(Stage::Fragment);
+        };
+
+        // Conditions using other symbols are left for GLSL compiler.
+        DOCTEST_CHECK_EQ(Fragment({}),
+            "#line 8 0\n"
+            "    opaque();\n"
+            "#line 11 0\n"
+            "    #if MAX_LIGHTS > 4\n"
+            "        manyLights();\n"
+            "    #endif\n");
+
+        DOCTEST_CHECK_EQ(Fragment({ "FOG" }),
+            "#line 4 0\n"
+            "    fog();\n"
+            "#line 11 0\n"
+            "    #if MAX_LIGHTS > 4\n"
+            "        manyLights();\n"
+            "    #endif\n");
+
+        DOCTEST_CHECK_EQ(Fragment({ "ALPHA_TEST" }),
+            "#line 6 0\n"
+            "    alphaTest();\n"
+            "#line 17 0\n"
+            "        discard();\n");
+
+        DOCTEST_CHECK_EQ(Fragment({ "FOG", "ALPHA_TEST" }),
+            "#line 4 0\n"
+            "    fog();\n");
+
+        // Defines naming keywords enable them.
+        DOCTEST_CHECK_EQ(preprocessor->Expand(0, { "FOG" }).GetStage(Stage::Fragment), Fragment({ "FOG" }));
+    }
+
+    DOCTEST_SUBCASE("Pass Through Elif")
+    {
+        auto preprocessor = CreatePreprocessor(
+            "#pragma keywords FOG\n"
+            "#if defined(VERTEX_SHADER)\n"
+            "  #if defined(FOG)\n"
+            "    fog();\n"
+            "  #elif QUALITY > 1\n"
+            "    quality();\n"
+            "  #else\n"
+            "    fallback();\n"
+            "  #endif\n"
+            "#endif\n");
+
+        DOCTEST_REQUIRE(preprocessor);
+        DOCTEST_CHECK_EQ(preprocessor->Expand(1).GetStage(Stage::Vertex),
+            "#line 4 0\n"
+            "    fog();\n");
+        DOCTEST_CHECK_EQ(preprocessor->Expand(0).GetStage(Stage::Vertex),
+            "#line 5 0\n"
+            "  #if QUALITY > 1\n"
+            "    quality();\n"
+            "  #else\n"
+            "    fallback();\n"
+            "  #endif\n");
+    }
+
+    DOCTEST_SUBCASE("Observable Defines")
+    {
+        auto preprocessor = CreatePreprocessor(
+            "#version 300 es\n"
+            "#pragma keywords FOG\n"
+            "#if defined(VERTEX_SHADER)\n"
+            "    #if defined(FOG) && defined(VERTEX_SHADER)\n"
+            "        fog();\n"
+            "    #endif\n"
+            "#endif\n");
+
+        DOCTEST_REQUIRE(preprocessor);
+
+        // Defines are emitted when remaining code can still test them.
+        DOCTEST_CHECK_EQ(preprocessor->Expand(1, { "MAX_LIGHTS 8" }).GetStage(Stage::Vertex),
+            "#version 300 es\n"
+            "#define VERTEX_SHADER\n"
+            "#define MAX_LIGHTS 8\n"
+            "#define FOG\n"
+            "#line 4 0\n"
+            "    #if defined(FOG) && defined(VERTEX_SHADER)\n"
+            "        fog();\n"
+            "    #endif\n");
+    }
+}
+
+DOCTEST_TEST_CASE("Shader Permutations")
+{
+    auto preprocessor = CreatePreprocessor(
+        "#version 300 es\n"
+        "#pragma keywords FOG ALPHA_TEST INSTANCED UNUSED\n"
+        "#if defined(VERTEX_SHADER)\n"
+        "    #ifdef INSTANCED\n"
+        "        instanced();\n"
+        "    #endif\n"
+        "#endif\n"
+        "#if defined(FRAGMENT_SHADER)\n"
+        "    #ifdef FOG\n"
+        "        fog();\n"
+        "        #ifdef ALPHA_TEST\n"
+        "            alphaTest();\n"
+        "        #endif\n"
+        "    #endif\n"
+        "#endif\n");
+
+    DOCTEST_REQUIRE(preprocessor);
+
+    const std::vector<Graphics::ShaderPreprocessor::KeywordMask> permutations =
+        preprocessor->GetPermutations();
+    DOCTEST_CHECK_EQ(permutations.size(), 16);
+
+    // Unused keyword and alpha test without fog produce no new code.
+    std::set<uint64_t> uniqueHashes;
+    for(Graphics::ShaderPreprocessor::KeywordMask keywords : permutations)
+    {
+        uniqueHashes.insert(preprocessor->Expand(keywords).hash);
+    }
+
+    DOCTEST_CHECK_EQ(uniqueHashes.size(), 2 * 3);
+
+    const auto fog = preprocessor->GetKeywordMask({ "FOG" });
+    const auto alphaTest = preprocessor->GetKeywordMask({ "ALPHA_TEST" });
+    const auto unused = preprocessor->GetKeywordMask({ "UNUSED" });
+
+    DOCTEST_CHECK_EQ(preprocessor->Expand(0).hash, preprocessor->Expand(alphaTest | unused).hash);
+    DOCTEST_CHECK_NE(preprocessor->Expand(fog).hash, preprocessor->Expand(fog | alphaTest).hash);
+    DOCTEST_CHECK_EQ(preprocessor->Expand(fog).hash, preprocessor->Expand(0, { "FOG", "UNUSED" }).hash);
+    DOCTEST_CHECK_NE(preprocessor->Expand(0).hash, preprocessor->Expand(0, { "MAX_LIGHTS 8" }).hash);
+}
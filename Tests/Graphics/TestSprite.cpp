@@ -0,0 +1,119 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <random>
+#include <Core/Core.hpp>
+#include <Graphics/Sprite/Sprite.hpp>
+
+namespace
+{
+    glm::vec4 TransformCorner(const Graphics::Sprite::Data& data, const glm::vec2& corner)
+    {
+        glm::vec4 position(corner, 0.0f, 1.0f);
+        position.x = data.rectangle.x + position.x * (data.rectangle.z - data.rectangle.x);
+        position.y = data.rectangle.y + position.y * (data.rectangle.w - data.rectangle.y);
+        return data.transform * position;
+    }
+
+    bool ComparePacked(const Graphics::Sprite::CompactData& a, const Graphics::Sprite::CompactData& b)
+    {
+        return a.basis == b.basis && a.position == b.position
+            && a.coords == b.coords && a.color == b.color;
+    }
+}
+
+DOCTEST_TEST_CASE("Sprite Compact Data")
+{
+    DOCTEST_CHECK_EQ(sizeof(Graphics::Sprite::CompactData), 40);
+    DOCTEST_CHECK_LT(sizeof(Graphics::Sprite::CompactData) * 2, sizeof(Graphics::Sprite::Data));
+
+    DOCTEST_SUBCASE("Default")
+    {
+        Graphics::Sprite::Data data;
+        Graphics::Sprite::CompactData compact = Graphics::Sprite::PackData(data);
+        DOCTEST_CHECK(ComparePacked(compact, Graphics::Sprite::CompactData()));
+
+        Graphics::Sprite::Data unpacked = Graphics::Sprite::UnpackData(compact);
+        DOCTEST_CHECK_EQ(unpacked.transform, data.transform);
+        DOCTEST_CHECK_EQ(unpacked.rectangle, data.rectangle);
+        DOCTEST_CHECK_EQ(unpacked.coords, data.coords);
+        DOCTEST_CHECK_EQ(unpacked.color, data.color);
+    }
+
+    DOCTEST_SUBCASE("Round Trip")
+    {
+        std::mt19937 random(1337);
+        std::uniform_real_distribution<float> unitDistribution(0.0f, 1.0f);
+        std::uniform_real_distribution<float> worldDistribution(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> scaleDistribution(0.1f, 10.0f);
+
+        for(int i = 0; i < 1000; ++i)
+        {
+            Graphics::Sprite::Data data;
+            data.transform = glm::translate(glm::mat4(1.0f), glm::vec3(
+                worldDistribution(random), worldDistribution(random), unitDistribution(random)));
+            data.transform = glm::rotate(data.transform,
+                glm::two_pi<float>() * unitDistribution(random), glm::vec3(0.0f, 0.0f, 1.0f));
+            data.transform = glm::scale(data.transform, glm::vec3(
+                scaleDistribution(random), scaleDistribution(random), 1.0f));
+            data.rectangle = glm::vec4(-0.5f, -0.5f, 0.5f, 0.5f) * scaleDistribution(random);
+            data.coords = glm::vec4(unitDistribution(random), unitDistribution(random),
+                unitDistribution(random), unitDistribution(random));
+            data.color = glm::vec4(unitDistribution(random), unitDistribution(random),
+                unitDistribution(random), unitDistribution(random));
+
+            Graphics::Sprite::CompactData compact = Graphics::Sprite::PackData(data);
+            Graphics::Sprite::Data unpacked = Graphics::Sprite::UnpackData(compact);
+
+            // Quad corners must land in the same place.
+            const glm::vec2 corners[] =
+            {
+                glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 1.0f),
+                glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f),
+            };
+
+            for(const glm::vec2& corner : corners)
+            {
+                const glm::vec4 expected = TransformCorner(data, corner);
+                const glm::vec4 actual = TransformCorner(unpacked, corner);
+                DOCTEST_CHECK_LT(glm::distance(expected, actual), 0.001f);
+            }
+
+            // Quantization error must stay within half of integer step.
+            const glm::vec4 coordsError = glm::abs(unpacked.coords - data.coords);
+            const glm::vec4 colorError = glm::abs(unpacked.color - data.color);
+            DOCTEST_CHECK(glm::all(glm::lessThanEqual(coordsError, glm::vec4(0.5f / 65535.0f + 1e-7f))));
+            DOCTEST_CHECK(glm::all(glm::lessThanEqual(colorError, glm::vec4(0.5f / 255.0f + 1e-7f))));
+
+            // Packing unpacked data must be lossless.
+            DOCTEST_CHECK(ComparePacked(Graphics::Sprite::PackData(unpacked), compact));
+        }
+    }
+
+    DOCTEST_SUBCASE("Flipped Coordinates")
+    {
+        Graphics::Sprite::Data data;
+        data.coords = glm::vec4(0.75f, 0.5f, 0.25f, 1.0f);
+
+        Graphics::Sprite::CompactData compact = Graphics::Sprite::PackData(data);
+        DOCTEST_CHECK_GT(compact.coords.x, compact.coords.z);
+        DOCTEST_CHECK_LT(compact.coords.y, compact.coords.w);
+        DOCTEST_CHECK_EQ(compact.coords.w, 65535);
+    }
+
+    DOCTEST_SUBCASE("Out Of Range")
+    {
+        Graphics::Sprite::Data data;
+        data.coords = glm::vec4(-1.0f, 0.0f, 2.0f, 1.0f);
+        data.color = glm::vec4(2.0f, -1.0f, 0.5f, 1.0f);
+
+        Graphics::Sprite::CompactData compact = Graphics::Sprite::PackData(data);
+        DOCTEST_CHECK_EQ(compact.coords, glm::u16vec4(0, 0, 65535, 65535));
+        DOCTEST_CHECK_EQ(compact.color, glm::u8vec4(255, 0, 128, 255));
+    }
+}
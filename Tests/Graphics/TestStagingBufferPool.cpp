@@ -0,0 +1,94 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <Core/Core.hpp>
+#include <Graphics/StagingBufferPool.hpp>
+
+DOCTEST_TEST_CASE("Staging Buffer Pool")
+{
+    Graphics::StagingBufferPool pool(4096);
+
+    DOCTEST_SUBCASE("Reuse")
+    {
+        Graphics::StagingBufferPool::Buffer small = pool.Acquire(256);
+        Graphics::StagingBufferPool::Buffer large = pool.Acquire(1024);
+        DOCTEST_CHECK(small.empty());
+        DOCTEST_CHECK_GE(small.capacity(), 256);
+        DOCTEST_CHECK_GE(large.capacity(), 1024);
+
+        const uint8_t* smallMemory = small.data();
+        const uint8_t* largeMemory = large.data();
+        pool.Release(std::move(large));
+        pool.Release(std::move(small));
+
+        // Smallest buffer that fits is reused.
+        Graphics::StagingBufferPool::Buffer buffer = pool.Acquire(200);
+        DOCTEST_CHECK_EQ(buffer.data(), smallMemory);
+        DOCTEST_CHECK(buffer.empty());
+
+        Graphics::StagingBufferPool::Buffer other = pool.Acquire(512);
+        DOCTEST_CHECK_EQ(other.data(), largeMemory);
+
+        // New buffer is allocated when none is large enough.
+        Graphics::StagingBufferPool::Buffer fresh = pool.Acquire(128);
+        DOCTEST_CHECK_GE(fresh.capacity(), 128);
+
+        Graphics::StagingBufferPool::Stats stats = pool.GetStats();
+        DOCTEST_CHECK_EQ(stats.acquiredBuffers, 5);
+        DOCTEST_CHECK_EQ(stats.reusedBuffers, 2);
+        DOCTEST_CHECK_EQ(stats.pooledBuffers, 0);
+        DOCTEST_CHECK_EQ(stats.pooledBytes, 0);
+    }
+
+    DOCTEST_SUBCASE("Capacity Limit")
+    {
+        Graphics::StagingBufferPool::Buffer first = pool.Acquire(3000);
+        Graphics::StagingBufferPool::Buffer second = pool.Acquire(3000);
+        const std::size_t firstCapacity = first.capacity();
+
+        // Buffer that would exceed pool size is freed.
+        pool.Release(std::move(first));
+        pool.Release(std::move(second));
+
+        Graphics::StagingBufferPool::Stats stats = pool.GetStats();
+        DOCTEST_CHECK_EQ(stats.pooledBuffers, 1);
+        DOCTEST_CHECK_EQ(stats.pooledBytes, firstCapacity);
+        DOCTEST_CHECK_EQ(stats.discardedBuffers, 1);
+
+        pool.Clear();
+        DOCTEST_CHECK_EQ(pool.GetStats().pooledBuffers, 0);
+        DOCTEST_CHECK_EQ(pool.GetStats().pooledBytes, 0);
+    }
+
+    DOCTEST_SUBCASE("Threads")
+    {
+        std::vector<std::thread> threads;
+        for(int i = 0; i < 4; ++i)
+        {
+            threads.emplace_back([&pool, i]()
+            {
+                for(int j = 0; j < 1000; ++j)
+                {
+                    Graphics::StagingBufferPool::Buffer buffer = pool.Acquire(64 + (i * 1000 + j) % 512);
+                    buffer.resize(64, static_cast<uint8_t>(i));
+                    pool.Release(std::move(buffer));
+                }
+            });
+        }
+
+        for(std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        Graphics::StagingBufferPool::Stats stats = pool.GetStats();
+        DOCTEST_CHECK_EQ(stats.acquiredBuffers, 4000);
+        DOCTEST_CHECK_LE(stats.pooledBytes, 4096);
+        DOCTEST_CHECK_GT(stats.reusedBuffers, 0);
+    }
+}
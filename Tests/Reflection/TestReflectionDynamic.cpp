@@ -10,6 +10,7 @@
 #include <vector>
 #include <cinttypes>
 #include <Reflection/Reflection.hpp>
+#include <Common/Test/Benchmark.hpp>
 #include "TestReflectionHeader.hpp"
 #include "TestReflection/ReflectionGenerated.hpp"
 
@@ -145,6 +146,55 @@ DOCTEST_TEST_CASE("Dynamic Reflection")
         DOCTEST_CHECK(Reflection::DynamicType<Derived>().IsBaseOf<BranchedOne>());
     }
 
+    DOCTEST_SUBCASE("Check registered type ancestors")
+    {
+        const Reflection::DynamicTypeInfo& base = Reflection::DynamicType<Base>();
+        const Reflection::DynamicTypeInfo& derived = Reflection::DynamicType<Derived>();
+        const Reflection::DynamicTypeInfo& branchedOne = Reflection::DynamicType<BranchedOne>();
+        const Reflection::DynamicTypeInfo& branchedTwo = Reflection::DynamicType<BranchedTwo>();
+        const Reflection::DynamicTypeInfo& deepFour = Reflection::DynamicType<DeepFour>();
+
+        DOCTEST_CHECK_EQ(base.GetDepth(), 0);
+        DOCTEST_CHECK_EQ(derived.GetDepth(), 1);
+        DOCTEST_CHECK_EQ(branchedTwo.GetDepth(), 2);
+        DOCTEST_CHECK_EQ(deepFour.GetDepth(), 6);
+        DOCTEST_CHECK_EQ(Reflection::DynamicType<Reflection::NullType>().GetDepth(), 0);
+
+        // Ancestors are listed from root of hierarchy and end with type itself.
+        const auto& ancestors = deepFour.GetAncestors();
+        DOCTEST_REQUIRE_EQ(ancestors.size(), 7);
+        DOCTEST_CHECK_EQ(ancestors[0], &base);
+        DOCTEST_CHECK_EQ(ancestors[1], &derived);
+        DOCTEST_CHECK_EQ(ancestors[2], &branchedTwo);
+        DOCTEST_CHECK_EQ(ancestors[3], &Reflection::DynamicType<DeepOne>());
+        DOCTEST_CHECK_EQ(ancestors[6], &deepFour);
+
+        DOCTEST_CHECK(deepFour.IsType(deepFour));
+        DOCTEST_CHECK(deepFour.IsType(base));
+        DOCTEST_CHECK(deepFour.IsDerivedFrom(branchedTwo));
+        DOCTEST_CHECK_FALSE(deepFour.IsDerivedFrom(deepFour));
+        DOCTEST_CHECK_FALSE(deepFour.IsType(branchedOne));
+        DOCTEST_CHECK_FALSE(branchedTwo.IsType(deepFour));
+        DOCTEST_CHECK(branchedTwo.IsBaseOf(deepFour));
+        DOCTEST_CHECK_FALSE(deepFour.IsBaseOf(branchedTwo));
+        DOCTEST_CHECK_FALSE(branchedOne.IsBaseOf(deepFour));
+
+        DOCTEST_CHECK(deepFour.IsDerivedFrom(Reflection::GetIdentifier<Derived>()));
+        DOCTEST_CHECK(deepFour.IsType(Reflection::GetIdentifier<DeepTwo>()));
+        DOCTEST_CHECK_FALSE(deepFour.IsType(Reflection::GetIdentifier<BranchedOne>()));
+        DOCTEST_CHECK(base.IsBaseOf(Reflection::GetIdentifier<DeepFour>()));
+
+        // Null, unregistered and invalid types are never ancestors.
+        const Reflection::DynamicTypeInfo& undefined =
+            Reflection::DynamicType(Reflection::GetIdentifier<Undefined>());
+
+        DOCTEST_CHECK_FALSE(base.IsDerivedFrom<Reflection::NullType>());
+        DOCTEST_CHECK_FALSE(deepFour.IsType(undefined));
+        DOCTEST_CHECK_FALSE(deepFour.IsType(Reflection::DynamicTypeInfo::Invalid));
+        DOCTEST_CHECK_FALSE(undefined.IsType(base));
+        DOCTEST_CHECK_FALSE(undefined.IsType(undefined));
+    }
+
     DOCTEST_SUBCASE("Check registered super declaration")
     {
         DOCTEST_CHECK_EQ(Reflection::DynamicType<Derived>().GetBaseType().GetIdentifier(),
@@ -291,6 +341,35 @@ DOCTEST_TEST_CASE("Dynamic Reflection")
         DOCTEST_CHECK_EQ(branchedTwoPtr, nullptr);
     }
 
+    DOCTEST_SUBCASE("Check registered type members")
+    {
+        const auto& baseMembers = Reflection::DynamicType<Base>().GetMembers();
+        DOCTEST_REQUIRE_EQ(baseMembers.size(), 2);
+        DOCTEST_CHECK_EQ(baseMembers[0].name, "textWithoutAttribute");
+        DOCTEST_CHECK_EQ(baseMembers[0].typeIdentifier, Reflection::InvalidIdentifier);
+        DOCTEST_CHECK_EQ(baseMembers[1].name, "textPtrWithAttribute");
+        DOCTEST_CHECK_EQ(baseMembers[1].typeIdentifier, Reflection::InvalidIdentifier);
+
+        const auto& derivedMembers = Reflection::DynamicType<Derived>().GetMembers();
+        DOCTEST_REQUIRE_EQ(derivedMembers.size(), 1);
+        DOCTEST_CHECK_EQ(derivedMembers[0].name, "counter");
+        DOCTEST_CHECK_EQ(derivedMembers[0].typeIdentifier, Reflection::GetIdentifier<int>());
+
+        const auto& branchedMembers = Reflection::DynamicType<BranchedOne>().GetMembers();
+        DOCTEST_REQUIRE_EQ(branchedMembers.size(), 2);
+        DOCTEST_CHECK_EQ(branchedMembers[0].typeIdentifier, Reflection::GetIdentifier<bool>());
+        DOCTEST_CHECK_EQ(branchedMembers[1].typeIdentifier, Reflection::GetIdentifier<Inner>());
+
+        BranchedOne branchedOne;
+        *static_cast<bool*>(branchedMembers[0].accessFunction(&branchedOne)) = true;
+        static_cast<Inner*>(branchedMembers[1].accessFunction(&branchedOne))->value = 7;
+        DOCTEST_CHECK(branchedOne.toggle);
+        DOCTEST_CHECK_EQ(branchedOne.inner.value, 7);
+
+        DOCTEST_CHECK_EQ(Reflection::DynamicType<BranchedOne>().GetTypeName(), "BranchedOne");
+        DOCTEST_CHECK(Reflection::DynamicType<Empty>().GetMembers().empty());
+    }
+
     DOCTEST_SUBCASE("Construct types from identifier")
     {
         DOCTEST_CHECK(Reflection::StaticType<Derived>().IsConstructible());
@@ -338,3 +417,98 @@ DOCTEST_TEST_CASE("Dynamic Reflection")
         }
     }
 }
+
+DOCTEST_TEST_CASE("Dynamic Reflection Cast Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to measure checking types of instances in deep hierarchy, by walking
+        chain of base types, by type identifiers, by precomputed ancestors when casting, and
+        compared to built-in dynamic cast.
+    */
+
+    std::vector<std::unique_ptr<Base>> instances;
+    for(int i = 0; i < 256; ++i)
+    {
+        switch(i % 5)
+        {
+        case 0: instances.push_back(std::make_unique<Base>()); break;
+        case 1: instances.push_back(std::make_unique<Derived>()); break;
+        case 2: instances.push_back(std::make_unique<BranchedOne>()); break;
+        case 3: instances.push_back(std::make_unique<DeepTwo>()); break;
+        case 4: instances.push_back(std::make_unique<DeepFour>()); break;
+        }
+    }
+
+    const std::size_t checkCount = 10000000;
+
+    auto Measure = [&](const char* method, auto&& check)
+    {
+        std::size_t matches = 0;
+        const double time = Test::MeasureMilliseconds([&]()
+        {
+            for(std::size_t i = 0; i < checkCount; ++i)
+            {
+                Base* instance = instances[i % instances.size()].get();
+                matches += check(instance, i % 3) ? 1 : 0;
+            }
+        });
+
+        DOCTEST_MESSAGE(Test::FormatBenchmark(method, time, {},
+            fmt::format("{} checks, {} matches", checkCount, matches)));
+        return matches;
+    };
+
+    const Reflection::TypeIdentifier targets[3] =
+    {
+        Reflection::GetIdentifier<Derived>(),
+        Reflection::GetIdentifier<BranchedTwo>(),
+        Reflection::GetIdentifier<DeepThree>(),
+    };
+
+    const std::size_t chainMatches = Measure("Base chain walk",
+        [&targets](Base* instance, std::size_t target)
+        {
+            const Reflection::DynamicTypeInfo* typeInfo = &instance->GetTypeInfo();
+            while(!typeInfo->IsNullType())
+            {
+                if(typeInfo->GetIdentifier() == targets[target])
+                    return true;
+
+                typeInfo = &typeInfo->GetBaseType();
+            }
+
+            return false;
+        });
+
+    const std::size_t identifierMatches = Measure("Identifier check",
+        [&targets](Base* instance, std::size_t target)
+        {
+            return instance->GetTypeInfo().IsType(targets[target]);
+        });
+
+    const std::size_t castMatches = Measure("Reflection cast",
+        [](Base* instance, std::size_t target)
+        {
+            switch(target)
+            {
+            case 0: return Reflection::Cast<Derived>(instance) != nullptr;
+            case 1: return Reflection::Cast<BranchedTwo>(instance) != nullptr;
+            default: return Reflection::Cast<DeepThree>(instance) != nullptr;
+            }
+        });
+
+    const std::size_t dynamicCastMatches = Measure("Dynamic cast",
+        [](Base* instance, std::size_t target)
+        {
+            switch(target)
+            {
+            case 0: return dynamic_cast<Derived*>(instance) != nullptr;
+            case 1: return dynamic_cast<BranchedTwo*>(instance) != nullptr;
+            default: return dynamic_cast<DeepThree*>(instance) != nullptr;
+            }
+        });
+
+    DOCTEST_CHECK_EQ(identifierMatches, chainMatches);
+    DOCTEST_CHECK_EQ(castMatches, chainMatches);
+    DOCTEST_CHECK_EQ(dynamicCastMatches, chainMatches);
+}
@@ -5,6 +5,10 @@
 
 #pragma once
 
+#include <array>
+#include <string>
+#include <vector>
+
 class Undefined
 {
 };
@@ -228,6 +232,121 @@ REFLECTION_TYPE_BEGIN(BranchedTwo, Derived)
     REFLECTION_FIELD(letterTwo, LetterAttribute("Ugly"))
 REFLECTION_TYPE_END
 
+class DeepOne : public BranchedTwo
+{
+    REFLECTION_ENABLE(DeepOne, BranchedTwo)
+};
+
+REFLECTION_TYPE(DeepOne, BranchedTwo)
+
+class DeepTwo : public DeepOne
+{
+    REFLECTION_ENABLE(DeepTwo, DeepOne)
+};
+
+REFLECTION_TYPE(DeepTwo, DeepOne)
+
+class DeepThree : public DeepTwo
+{
+    REFLECTION_ENABLE(DeepThree, DeepTwo)
+};
+
+REFLECTION_TYPE(DeepThree, DeepTwo)
+
+class DeepFour : public DeepThree
+{
+    REFLECTION_ENABLE(DeepFour, DeepThree)
+};
+
+REFLECTION_TYPE(DeepFour, DeepThree)
+
+struct SerializedPoint
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    int id = 0;
+};
+
+REFLECTION_STATIC_TYPE_BEGIN(SerializedPoint)
+    REFLECTION_FIELD(x)
+    REFLECTION_FIELD(y)
+    REFLECTION_FIELD(id)
+REFLECTION_STATIC_TYPE_END
+
+struct SerializedPadded
+{
+    bool enabled = false;
+    double value = 0.0;
+};
+
+REFLECTION_STATIC_TYPE_BEGIN(SerializedPadded)
+    REFLECTION_FIELD(enabled)
+    REFLECTION_FIELD(value)
+REFLECTION_STATIC_TYPE_END
+
+struct SerializedFlags
+{
+    bool visible = false;
+    bool active = false;
+    uint8_t layer = 0;
+    uint8_t order = 0;
+};
+
+REFLECTION_STATIC_TYPE_BEGIN(SerializedFlags)
+    REFLECTION_FIELD(visible)
+    REFLECTION_FIELD(active)
+    REFLECTION_FIELD(layer)
+    REFLECTION_FIELD(order)
+REFLECTION_STATIC_TYPE_END
+
+struct SerializedEmpty
+{
+};
+
+REFLECTION_STATIC_TYPE(SerializedEmpty)
+
+struct SerializedRecord
+{
+    std::string name;
+    std::vector<SerializedPoint> points;
+    std::vector<std::string> tags;
+    std::array<SerializedPadded, 2> pair;
+    unsigned int transient = 0;
+};
+
+REFLECTION_STATIC_TYPE_BEGIN(SerializedRecord)
+    REFLECTION_FIELD(name)
+    REFLECTION_FIELD(points)
+    REFLECTION_FIELD(tags)
+    REFLECTION_FIELD(pair)
+REFLECTION_STATIC_TYPE_END
+
+class SerializedBase
+{
+    REFLECTION_ENABLE(SerializedBase)
+
+public:
+    int health = 0;
+};
+
+REFLECTION_TYPE_BEGIN(SerializedBase)
+    REFLECTION_FIELD(health)
+REFLECTION_TYPE_END
+
+class SerializedDerived : public SerializedBase
+{
+    REFLECTION_ENABLE(SerializedDerived, SerializedBase)
+
+public:
+    std::string label;
+    float speed = 0.0f;
+};
+
+REFLECTION_TYPE_BEGIN(SerializedDerived, SerializedBase)
+    REFLECTION_FIELD(label)
+    REFLECTION_FIELD(speed)
+REFLECTION_TYPE_END
+
 class CrossUnit
 {
 };
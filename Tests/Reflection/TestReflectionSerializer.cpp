@@ -0,0 +1,318 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <Reflection/Reflection.hpp>
+#include <Common/Test/Benchmark.hpp>
+#include "TestReflectionHeader.hpp"
+
+namespace
+{
+    SerializedRecord CreateRecord()
+    {
+        SerializedRecord record;
+        record.name = "Record";
+        record.points = { { 1.0f, 2.0f, 3 }, { 4.0f, 5.0f, 6 } };
+        record.tags = { "First", "", "Third" };
+        record.pair[0] = { true, 0.5 };
+        record.pair[1] = { false, -2.0 };
+        record.transient = 7;
+        return record;
+    }
+}
+
+DOCTEST_TEST_CASE("Reflection Serializer")
+{
+    DOCTEST_SUBCASE("Memory copyable types")
+    {
+        DOCTEST_CHECK(Reflection::IsMemoryCopyable<int>());
+        DOCTEST_CHECK_FALSE(Reflection::IsMemoryCopyable<bool>());
+        DOCTEST_CHECK_FALSE(Reflection::IsMemoryCopyable<std::array<bool, 4>>());
+        DOCTEST_CHECK_FALSE(Reflection::IsMemoryCopyable<SerializedFlags>());
+        DOCTEST_CHECK(Reflection::IsMemoryCopyable<SerializedPoint>());
+        DOCTEST_CHECK(Reflection::IsMemoryCopyable<std::array<SerializedPoint, 4>>());
+        DOCTEST_CHECK_FALSE(Reflection::IsMemoryCopyable<SerializedPadded>());
+        DOCTEST_CHECK_FALSE(Reflection::IsMemoryCopyable<SerializedRecord>());
+        DOCTEST_CHECK_FALSE(Reflection::IsMemoryCopyable<SerializedBase>());
+        DOCTEST_CHECK_FALSE(Reflection::IsMemoryCopyable<std::string>());
+        DOCTEST_CHECK_FALSE(Reflection::IsMemoryCopyable<std::vector<int>>());
+    }
+
+    DOCTEST_SUBCASE("Schema hashes")
+    {
+        static_assert(Reflection::SchemaHash<SerializedPoint>() == Reflection::SchemaHash<SerializedPoint>());
+        DOCTEST_CHECK_NE(Reflection::SchemaHash<SerializedPoint>(), Reflection::SchemaHash<SerializedPadded>());
+        DOCTEST_CHECK_NE(Reflection::SchemaHash<SerializedBase>(), Reflection::SchemaHash<SerializedDerived>());
+        DOCTEST_CHECK_NE(Reflection::SchemaHash<int>(), Reflection::SchemaHash<unsigned int>());
+        DOCTEST_CHECK_NE(Reflection::SchemaHash<int>(), Reflection::SchemaHash<float>());
+        DOCTEST_CHECK_NE(Reflection::SchemaHash<std::vector<int>>(), Reflection::SchemaHash<std::vector<float>>());
+        DOCTEST_CHECK_NE(Reflection::SchemaHash<std::array<int, 2>>(), Reflection::SchemaHash<std::array<int, 3>>());
+    }
+
+    DOCTEST_SUBCASE("Round trip")
+    {
+        const SerializedRecord record = CreateRecord();
+
+        std::vector<uint8_t> buffer;
+        Reflection::BinaryWriter writer(buffer);
+        writer.Serialize(record);
+
+        SerializedRecord result;
+        Reflection::BinaryReader reader(buffer.data(), buffer.size());
+        DOCTEST_REQUIRE(reader.Deserialize(result).IsSuccess());
+        DOCTEST_CHECK_EQ(reader.GetRemaining(), 0);
+
+        DOCTEST_CHECK_EQ(result.name, record.name);
+        DOCTEST_REQUIRE_EQ(result.points.size(), 2);
+        DOCTEST_CHECK_EQ(result.points[1].x, 4.0f);
+        DOCTEST_CHECK_EQ(result.points[1].id, 6);
+        DOCTEST_CHECK_EQ(result.tags, record.tags);
+        DOCTEST_CHECK(result.pair[0].enabled);
+        DOCTEST_CHECK_EQ(result.pair[1].value, -2.0);
+
+        // Fields that are not reflected are not serialized.
+        DOCTEST_CHECK_EQ(result.transient, 0);
+    }
+
+    DOCTEST_SUBCASE("Base type members")
+    {
+        SerializedDerived derived;
+        derived.health = 100;
+        derived.label = "Runner";
+        derived.speed = 2.5f;
+
+        std::vector<uint8_t> buffer;
+        Reflection::BinaryWriter writer(buffer);
+        writer.Serialize(derived);
+
+        // Base members are written first, followed by members of derived type.
+        const std::size_t headerSize = sizeof(uint64_t);
+        DOCTEST_REQUIRE_EQ(buffer.size(), headerSize + sizeof(int) + sizeof(uint32_t) + 6 + sizeof(float));
+
+        int health = 0;
+        std::memcpy(&health, buffer.data() + headerSize, sizeof(health));
+        DOCTEST_CHECK_EQ(health, 100);
+
+        SerializedDerived result;
+        Reflection::BinaryReader reader(buffer.data(), buffer.size());
+        DOCTEST_REQUIRE(reader.Deserialize(result).IsSuccess());
+        DOCTEST_CHECK_EQ(result.health, 100);
+        DOCTEST_CHECK_EQ(result.label, "Runner");
+        DOCTEST_CHECK_EQ(result.speed, 2.5f);
+    }
+
+    DOCTEST_SUBCASE("Read into preallocated objects")
+    {
+        std::vector<uint8_t> buffer;
+        Reflection::BinaryWriter writer(buffer);
+        writer.Serialize(CreateRecord());
+
+        // Objects are read in place, reusing memory of their containers.
+        SerializedRecord result;
+        result.points.reserve(16);
+        result.name.reserve(32);
+        result.transient = 3;
+
+        const SerializedPoint* points = result.points.data();
+        const char* name = result.name.data();
+
+        Reflection::BinaryReader reader(buffer.data(), buffer.size());
+        DOCTEST_REQUIRE(reader.Deserialize(result).IsSuccess());
+        DOCTEST_CHECK_EQ(result.points.data(), points);
+        DOCTEST_CHECK_EQ(result.name.data(), name);
+        DOCTEST_CHECK_EQ(result.points[0].y, 2.0f);
+        DOCTEST_CHECK_EQ(result.transient, 3);
+    }
+
+    DOCTEST_SUBCASE("Schema mismatch")
+    {
+        std::vector<uint8_t> buffer;
+        Reflection::BinaryWriter writer(buffer);
+        writer.Serialize(SerializedPoint{ 1.0f, 2.0f, 3 });
+
+        SerializedPadded padded;
+        Reflection::BinaryReader reader(buffer.data(), buffer.size());
+        auto result = reader.Deserialize(padded);
+        DOCTEST_REQUIRE(result.IsFailure());
+        DOCTEST_CHECK_EQ(result.UnwrapFailure(), Reflection::BinaryReader::ReadErrors::SchemaMismatch);
+    }
+
+    DOCTEST_SUBCASE("Truncated data")
+    {
+        std::vector<uint8_t> buffer;
+        Reflection::BinaryWriter writer(buffer);
+        writer.Serialize(CreateRecord());
+
+        for(std::size_t size = 0; size < buffer.size(); ++size)
+        {
+            SerializedRecord record;
+            Reflection::BinaryReader reader(buffer.data(), size);
+            auto result = reader.Deserialize(record);
+            DOCTEST_REQUIRE(result.IsFailure());
+            DOCTEST_CHECK_EQ(result.UnwrapFailure(), Reflection::BinaryReader::ReadErrors::UnexpectedEnd);
+        }
+    }
+
+    DOCTEST_SUBCASE("Corrupted container size")
+    {
+        // Container sizes larger than remaining data are rejected before allocating.
+        std::vector<uint8_t> buffer;
+        Reflection::BinaryWriter writer(buffer);
+        writer.WriteValue(Reflection::SchemaHash<std::vector<std::string>>());
+        writer.WriteSize(0xFFFFFFFF);
+
+        std::vector<std::string> strings;
+        Reflection::BinaryReader reader(buffer.data(), buffer.size());
+        DOCTEST_CHECK(reader.Deserialize(strings).IsFailure());
+        DOCTEST_CHECK(strings.empty());
+    }
+
+    DOCTEST_SUBCASE("Corrupted empty element count")
+    {
+        // Elements without serialized data are bounded by fixed count instead.
+        std::vector<uint8_t> buffer;
+        Reflection::BinaryWriter writer(buffer);
+        writer.Serialize(std::vector<SerializedEmpty>(16));
+
+        std::vector<SerializedEmpty> elements;
+        Reflection::BinaryReader reader(buffer.data(), buffer.size());
+        DOCTEST_REQUIRE(reader.Deserialize(elements).IsSuccess());
+        DOCTEST_CHECK_EQ(elements.size(), 16);
+
+        buffer.clear();
+        writer.WriteValue(Reflection::SchemaHash<std::vector<SerializedEmpty>>());
+        writer.WriteSize(0xFFFFFFFF);
+
+        elements.clear();
+        Reflection::BinaryReader corruptedReader(buffer.data(), buffer.size());
+        DOCTEST_CHECK(corruptedReader.Deserialize(elements).IsFailure());
+        DOCTEST_CHECK(elements.empty());
+    }
+
+    DOCTEST_SUBCASE("Corrupted bool")
+    {
+        std::vector<uint8_t> buffer;
+        Reflection::BinaryWriter writer(buffer);
+        writer.Serialize(SerializedPadded{ true, 1.0 });
+        DOCTEST_REQUIRE_EQ(buffer.size(), sizeof(uint64_t) + 1 + sizeof(double));
+        DOCTEST_CHECK_EQ(buffer[sizeof(uint64_t)], 1);
+
+        // Bytes that are not valid bool representation are rejected.
+        buffer[sizeof(uint64_t)] = 2;
+
+        SerializedPadded result;
+        Reflection::BinaryReader reader(buffer.data(), buffer.size());
+        DOCTEST_CHECK(reader.Deserialize(result).IsFailure());
+    }
+
+    DOCTEST_SUBCASE("Bool members")
+    {
+        // Members of type without padding are still written one by one when it contains bools.
+        std::vector<uint8_t> buffer;
+        Reflection::BinaryWriter writer(buffer);
+        writer.Serialize(SerializedFlags{ true, false, 3, 4 });
+        DOCTEST_REQUIRE_EQ(buffer.size(), sizeof(uint64_t) + sizeof(SerializedFlags));
+
+        SerializedFlags result;
+        Reflection::BinaryReader reader(buffer.data(), buffer.size());
+        DOCTEST_REQUIRE(reader.Deserialize(result).IsSuccess());
+        DOCTEST_CHECK(result.visible);
+        DOCTEST_CHECK_FALSE(result.active);
+        DOCTEST_CHECK_EQ(result.layer, 3);
+        DOCTEST_CHECK_EQ(result.order, 4);
+
+        buffer[sizeof(uint64_t) + 1] = 0xFF;
+
+        Reflection::BinaryReader corruptedReader(buffer.data(), buffer.size());
+        DOCTEST_CHECK(corruptedReader.Deserialize(result).IsFailure());
+    }
+}
+
+DOCTEST_TEST_CASE("Reflection Serializer Benchmark" * doctest::skip())
+{
+    /*
+        Run with --no-skip to compare binary serialization of one million small structs,
+        copied in bulk or written member by member, against simple text format.
+    */
+
+    const std::size_t structCount = 1000000;
+
+    std::vector<SerializedPoint> points(structCount);
+    std::vector<SerializedPadded> paddedPoints(structCount);
+    for(std::size_t i = 0; i < structCount; ++i)
+    {
+        points[i] = { static_cast<float>(i) * 0.5f, static_cast<float>(i % 1000), static_cast<int>(i) };
+        paddedPoints[i] = { i % 2 == 0, static_cast<double>(i) * 0.25 };
+    }
+
+    auto MeasureBinary = [&](const char* method, const auto& objects)
+    {
+        using ObjectsType = std::decay_t<decltype(objects)>;
+
+        std::vector<uint8_t> buffer;
+        const double writeTime = Test::MeasureMilliseconds([&]()
+        {
+            Reflection::BinaryWriter writer(buffer);
+            writer.Serialize(objects);
+        });
+
+        ObjectsType result;
+        const double readTime = Test::MeasureMilliseconds([&]()
+        {
+            Reflection::BinaryReader reader(buffer.data(), buffer.size());
+            DOCTEST_CHECK(reader.Deserialize(result).IsSuccess());
+        });
+
+        DOCTEST_CHECK_EQ(result.size(), objects.size());
+
+        const std::string details = fmt::format("{} bytes", buffer.size());
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("{} write", method), writeTime, {}, details));
+        DOCTEST_MESSAGE(Test::FormatBenchmark(fmt::format("{} read", method), readTime, {}, details));
+    };
+
+    MeasureBinary("Binary memory copy", points);
+    MeasureBinary("Binary per member", paddedPoints);
+
+    {
+        fmt::memory_buffer text;
+        const double writeTime = Test::MeasureMilliseconds([&]()
+        {
+            for(const SerializedPoint& point : points)
+            {
+                fmt::format_to(text, "x={} y={} id={}\n", point.x, point.y, point.id);
+            }
+        });
+
+        std::string string(text.data(), text.size());
+        std::vector<SerializedPoint> result;
+        result.reserve(structCount);
+
+        const double readTime = Test::MeasureMilliseconds([&]()
+        {
+            const char* cursor = string.c_str();
+            while(*cursor != '\0')
+            {
+                SerializedPoint& point = result.emplace_back();
+                char* end = nullptr;
+                point.x = std::strtof(cursor + 2, &end);
+                point.y = std::strtof(end + 3, &end);
+                point.id = static_cast<int>(std::strtol(end + 4, &end, 10));
+                cursor = end + 1;
+            }
+        });
+
+        DOCTEST_CHECK_EQ(result.size(), structCount);
+        DOCTEST_CHECK_EQ(result.back().id, points.back().id);
+
+        const std::string details = fmt::format("{} bytes", text.size());
+        DOCTEST_MESSAGE(Test::FormatBenchmark("Text write", writeTime, {}, details));
+        DOCTEST_MESSAGE(Test::FormatBenchmark("Text read", readTime, {}, details));
+    }
+}
@@ -0,0 +1,356 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include <iostream>
+#include <Core/Core.hpp>
+#include <System/Image.hpp>
+#include <System/KtxImage.hpp>
+#include <System/FileSystem/NativeFileHandle.hpp>
+#include <System/FileSystem/MemoryFileHandle.hpp>
+#include <Graphics/TextureAtlas.hpp>
+#include <Graphics/Sprite/SpriteAnimationList.hpp>
+
+/*
+    Asset Cooker
+
+    Converts all PNG images found in source directory into cooked textures, which are written to
+    cooked directory under same relative paths and names. Cooked textures are stored in KTX2
+    container with tightly packed pixels in their source channel format, with rows already flipped
+    and with optional mip chain, so they can be uploaded without decoding. Hash of source file
+    content and cook parameters is stored with each texture, and textures with unchanged sources
+    are not cooked again unless they were cooked with different parameters (e.g. "--no-mipmaps").
+
+    Texture atlas and sprite animation list scripts are compiled into their binary form, which is
+    loaded without creating script state. Compiled files are only written when their content
+    changes, keeping modification times of up to date files.
+
+    Cooked directory is mounted over source assets when "engine.cookedDirectory" is set.
+
+    Usage: AssetCooker <sourceDir> <cookedDir> [--no-mipmaps] [--force]
+*/
+
+namespace
+{
+    using Pixels = std::vector<uint8_t>;
+
+    const char* ContentHashKey = "ContentHash";
+
+    struct CookerParameters
+    {
+        fs::path sourceDirectory;
+        fs::path cookedDirectory;
+        bool mipmaps = true;
+        bool force = false;
+        bool isValid = false;
+    };
+
+    CookerParameters ParseCommandLineArguments(int argc, const char* argv[])
+    {
+        CookerParameters parameters;
+        std::vector<std::string_view> positional;
+
+        for(int arg = 1; arg < argc; ++arg)
+        {
+            std::string_view argument = argv[arg];
+            if(argument == "--no-mipmaps")
+            {
+                parameters.mipmaps = false;
+            }
+            else if(argument == "--force")
+            {
+                parameters.force = true;
+            }
+            else
+            {
+                positional.push_back(argument);
+            }
+        }
+
+        if(positional.size() != 2 || !fs::is_directory(positional[0]))
+        {
+            std::cerr << "AssetCooker: Usage: AssetCooker <sourceDir> <cookedDir> "
+                "[--no-mipmaps] [--force]\n";
+            return parameters;
+        }
+
+        parameters.sourceDirectory = positional[0];
+        parameters.cookedDirectory = positional[1];
+        parameters.isValid = true;
+        return parameters;
+    }
+
+    System::PixelFormat GetChannelFormat(int channels)
+    {
+        switch(channels)
+        {
+        case 1:
+            return System::PixelFormat::R8;
+
+        case 2:
+            return System::PixelFormat::RG8;
+
+        case 3:
+            return System::PixelFormat::RGB8;
+
+        case 4:
+            return System::PixelFormat::RGBA8;
+
+        default:
+            return System::PixelFormat::Unknown;
+        }
+    }
+
+    Pixels Downsample(const Pixels& pixels, int width, int height, int channels)
+    {
+        // Average two by two pixels, clamping at odd edges.
+        const int nextWidth = std::max(1, width / 2);
+        const int nextHeight = std::max(1, height / 2);
+        Pixels next(static_cast<std::size_t>(nextWidth) * nextHeight * channels);
+
+        for(int y = 0; y < nextHeight; ++y)
+        {
+            for(int x = 0; x < nextWidth; ++x)
+            {
+                for(int channel = 0; channel < channels; ++channel)
+                {
+                    int sum = 0;
+                    for(int offset = 0; offset < 4; ++offset)
+                    {
+                        const int sourceX = std::min(x * 2 + offset % 2, width - 1);
+                        const int sourceY = std::min(y * 2 + offset / 2, height - 1);
+                        sum += pixels[(static_cast<std::size_t>(sourceY) * width + sourceX) * channels + channel];
+                    }
+
+                    next[(static_cast<std::size_t>(y) * nextWidth + x) * channels + channel] =
+                        static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+
+        return next;
+    }
+
+    std::string ReadContentHash(const fs::path& cookedPath)
+    {
+        // Cooked file is only read when it exists, so missing file is not an error.
+        if(!fs::is_regular_file(cookedPath))
+            return std::string();
+
+        auto cookedFile = System::NativeFileHandle::Create(cookedPath, cookedPath,
+            System::FileHandle::OpenFlags::Read).UnwrapOr(nullptr);
+        if(cookedFile == nullptr || !System::KtxImage::IsKtxFile(*cookedFile))
+            return std::string();
+
+        auto cookedImage = System::KtxImage::Create(*cookedFile).UnwrapOr(nullptr);
+        if(cookedImage == nullptr)
+            return std::string();
+
+        const std::string* contentHash = cookedImage->FindValue(ContentHashKey);
+        return contentHash != nullptr ? *contentHash : std::string();
+    }
+
+    enum class CookResult
+    {
+        Cooked,
+        UpToDate,
+        Failed,
+    };
+
+    using CompileFunction = bool(*)(System::FileHandle& sourceFile, System::FileHandle& outputFile);
+
+    CompileFunction GetCompileFunction(const fs::path& extension)
+    {
+        if(extension == ".atlas")
+            return &Graphics::TextureAtlas::Compile;
+
+        if(extension == ".animation")
+            return &Graphics::SpriteAnimationList::Compile;
+
+        return nullptr;
+    }
+
+    CookResult CompileResource(const fs::path& sourcePath, const fs::path& cookedPath,
+        CompileFunction compileFunction, const CookerParameters& parameters, std::size_t& cookedSize)
+    {
+        auto sourceFile = System::NativeFileHandle::Create(sourcePath, sourcePath,
+            System::FileHandle::OpenFlags::Read).UnwrapOr(nullptr);
+        if(sourceFile == nullptr)
+        {
+            std::cerr << "AssetCooker: Could not open \"" << sourcePath.generic_string() << "\" file!\n";
+            return CookResult::Failed;
+        }
+
+        // Compile resource into memory first, so it can be compared with existing output.
+        auto compiledFile = System::MemoryFileHandle::Create(cookedPath, {},
+            System::FileHandle::OpenFlags::Write);
+        if(!compileFunction(*sourceFile, *compiledFile))
+        {
+            std::cerr << "AssetCooker: Could not compile \"" << sourcePath.generic_string() << "\" file!\n";
+            return CookResult::Failed;
+        }
+
+        const std::vector<uint8_t> compiledData = compiledFile->ReleaseData();
+
+        if(!parameters.force && fs::is_regular_file(cookedPath))
+        {
+            auto existingFile = System::NativeFileHandle::Create(cookedPath, cookedPath,
+                System::FileHandle::OpenFlags::Read).UnwrapOr(nullptr);
+            if(existingFile != nullptr && existingFile->ReadAsBinaryArray() == compiledData)
+                return CookResult::UpToDate;
+        }
+
+        // Write compiled file under same relative path.
+        std::error_code error;
+        fs::create_directories(cookedPath.parent_path(), error);
+
+        auto cookedFile = System::NativeFileHandle::Create(cookedPath, cookedPath,
+            System::FileHandle::OpenFlags::Write | System::FileHandle::OpenFlags::Truncate).UnwrapOr(nullptr);
+        if(cookedFile == nullptr || cookedFile->Write(compiledData.data(), compiledData.size()) != compiledData.size())
+        {
+            std::cerr << "AssetCooker: Could not write \"" << cookedPath.generic_string() << "\" file!\n";
+            return CookResult::Failed;
+        }
+
+        cookedSize += compiledData.size();
+        return CookResult::Cooked;
+    }
+
+    CookResult CookTexture(const fs::path& sourcePath, const fs::path& cookedPath,
+        const CookerParameters& parameters, std::size_t& cookedSize)
+    {
+        auto sourceFile = System::NativeFileHandle::Create(sourcePath, sourcePath,
+            System::FileHandle::OpenFlags::Read).UnwrapOr(nullptr);
+        if(sourceFile == nullptr)
+        {
+            std::cerr << "AssetCooker: Could not open \"" << sourcePath.generic_string() << "\" file!\n";
+            return CookResult::Failed;
+        }
+
+        // Skip textures which have been cooked from identical source with same parameters.
+        const std::vector<uint8_t> sourceData = sourceFile->ReadAsBinaryArray();
+        const std::string cookParameters = fmt::format("mipmaps={}", parameters.mipmaps);
+        const std::string contentHash = fmt::format("{:016x}{:016x}",
+            Common::StringHash<uint64_t>(std::string_view(
+                reinterpret_cast<const char*>(sourceData.data()), sourceData.size())),
+            Common::StringHash<uint64_t>(cookParameters));
+
+        if(!parameters.force && ReadContentHash(cookedPath) == contentHash)
+            return CookResult::UpToDate;
+
+        // Decode source image, with its rows flipped same as for loaded textures.
+        sourceFile->Seek(0);
+        auto image = System::Image::Create(*sourceFile, System::Image::LoadFromFile()).UnwrapOr(nullptr);
+        if(image == nullptr)
+        {
+            std::cerr << "AssetCooker: Could not load image from \"" << sourcePath.generic_string() << "\" file!\n";
+            return CookResult::Failed;
+        }
+
+        System::KtxImage::CreateFromParams ktxParams;
+        ktxParams.format = GetChannelFormat(image->GetChannels());
+        ktxParams.width = image->GetWidth();
+        ktxParams.height = image->GetHeight();
+        ktxParams.keyValues[ContentHashKey] = contentHash;
+
+        if(ktxParams.format == System::PixelFormat::Unknown)
+        {
+            std::cerr << "AssetCooker: Unsupported number of channels in \"" << sourcePath.generic_string() << "\" file!\n";
+            return CookResult::Failed;
+        }
+
+        // Store full size image and its mip levels.
+        const int channels = image->GetChannels();
+        Pixels pixels(image->GetData(), image->GetData() +
+            static_cast<std::size_t>(image->GetWidth()) * image->GetHeight() * channels);
+        int width = image->GetWidth();
+        int height = image->GetHeight();
+
+        while(true)
+        {
+            ktxParams.levels.push_back(pixels);
+
+            if(!parameters.mipmaps || (width == 1 && height == 1))
+                break;
+
+            pixels = Downsample(pixels, width, height, channels);
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+
+        auto ktxImage = System::KtxImage::Create(ktxParams).UnwrapOr(nullptr);
+        if(ktxImage == nullptr)
+        {
+            std::cerr << "AssetCooker: Could not create cooked image for \"" << sourcePath.generic_string() << "\" file!\n";
+            return CookResult::Failed;
+        }
+
+        // Write cooked file under same relative path.
+        std::error_code error;
+        fs::create_directories(cookedPath.parent_path(), error);
+
+        auto cookedFile = System::NativeFileHandle::Create(cookedPath, cookedPath,
+            System::FileHandle::OpenFlags::Write | System::FileHandle::OpenFlags::Truncate).UnwrapOr(nullptr);
+        if(cookedFile == nullptr || !ktxImage->Write(*cookedFile))
+        {
+            std::cerr << "AssetCooker: Could not write \"" << cookedPath.generic_string() << "\" file!\n";
+            return CookResult::Failed;
+        }
+
+        cookedSize += cookedFile->GetSize();
+        return CookResult::Cooked;
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    CookerParameters parameters = ParseCommandLineArguments(argc, argv);
+    if(!parameters.isValid)
+        return -1;
+
+    // Cook every image and compile every resource script found in source directory.
+    int cookedCount = 0;
+    int upToDateCount = 0;
+    int failedCount = 0;
+    std::size_t cookedSize = 0;
+
+    for(const auto& entry : fs::recursive_directory_iterator(parameters.sourceDirectory))
+    {
+        if(!entry.is_regular_file())
+            continue;
+
+        const fs::path extension = entry.path().extension();
+        const CompileFunction compileFunction = GetCompileFunction(extension);
+        if(extension != ".png" && compileFunction == nullptr)
+            continue;
+
+        const fs::path relativePath = fs::relative(entry.path(), parameters.sourceDirectory);
+        const fs::path cookedPath = parameters.cookedDirectory / relativePath;
+
+        const CookResult result = compileFunction != nullptr ?
+            CompileResource(entry.path(), cookedPath, compileFunction, parameters, cookedSize) :
+            CookTexture(entry.path(), cookedPath, parameters, cookedSize);
+
+        switch(result)
+        {
+        case CookResult::Cooked:
+            std::cout << "AssetCooker: Cooked \"" << relativePath.generic_string() << "\" file.\n";
+            ++cookedCount;
+            break;
+
+        case CookResult::UpToDate:
+            ++upToDateCount;
+            break;
+
+        case CookResult::Failed:
+            ++failedCount;
+            break;
+        }
+    }
+
+    std::cout << "AssetCooker: Cooked " << cookedCount << " files (" << cookedSize << " bytes), "
+        << upToDateCount << " up to date, " << failedCount << " failed.\n";
+
+    return failedCount == 0 ? 0 : -1;
+}
@@ -4,6 +4,7 @@
 */
 
 #include <cassert>
+#include <cstdlib>
 #include <string>
 #include <regex>
 #include <filesystem>
@@ -13,6 +14,7 @@
 #include <vector>
 #include <set>
 #include <unordered_map>
+#include <Common/StringHash.hpp>
 
 namespace fs = std::filesystem;
 
@@ -23,14 +25,30 @@ struct GeneratorParameters
     std::vector<std::string_view> targetDependencies;
 
     std::string_view outputDir;
-    std::vector<fs::path> sourceDirs;
+    std::vector<fs::path> sourcePaths;
+    std::vector<fs::path> nameListPaths;
 
     bool isExecutable = false;
+    bool isNameCheck = false;
     bool isValid = false;
 };
 
 GeneratorParameters ParseCommandLineArguments(const int argc, const char* argv[])
 {
+    // Name lists written for modules are checked together when executable is linked.
+    if(argc >= 2 && std::string_view(argv[1]) == "--check-names")
+    {
+        GeneratorParameters output;
+        for(int arg = 2; arg < argc; ++arg)
+        {
+            output.nameListPaths.emplace_back(fs::path(argv[arg]));
+        }
+
+        output.isNameCheck = true;
+        output.isValid = true;
+        return output;
+    }
+
     if(argc < 5)
     {
         std::cerr << "ReflectionGenerator: Unexpected number of arguments!\n";
@@ -83,7 +101,7 @@ GeneratorParameters ParseCommandLineArguments(const int argc, const char* argv[]
 
     for(int arg = 5; arg < argc; ++arg)
     {
-        output.sourceDirs.emplace_back(fs::path(argv[arg]));
+        output.sourcePaths.emplace_back(fs::path(argv[arg]));
     }
 
     output.isExecutable = (output.targetType == "EXECUTABLE");
@@ -109,6 +127,244 @@ void TrimWhitespaceRight(const std::string_view& string, std::size_t& position)
         --position;
 };
 
+struct NameLiteral
+{
+    std::string string;
+
+    fs::path sourcePath;
+    std::size_t sourceLine = 0;
+};
+
+bool ParseNameLiterals(const std::string& line, const fs::path& sourcePath,
+    const std::size_t sourceLine, std::vector<NameLiteral>& nameLiterals)
+{
+    const std::string_view nameTokenName = "NAME_CONSTEXPR(";
+    std::size_t nameTokenBegin = line.find(nameTokenName);
+
+    while(nameTokenBegin != std::string::npos)
+    {
+        std::size_t position = nameTokenBegin + nameTokenName.size();
+        while(position < line.size() && std::isspace(line[position]))
+            ++position;
+
+        // Only string literals can be hashed here, other arguments are left to name registry.
+        if(position < line.size() && line[position] == '"')
+        {
+            NameLiteral nameLiteral;
+            nameLiteral.sourcePath = sourcePath;
+            nameLiteral.sourceLine = sourceLine;
+
+            bool terminated = false;
+            for(++position; position < line.size(); ++position)
+            {
+                char character = line[position];
+                if(character == '"')
+                {
+                    terminated = true;
+                    break;
+                }
+
+                if(character == '\\' && position + 1 < line.size())
+                {
+                    switch(line[++position])
+                    {
+                    case 'n': character = '\n'; break;
+                    case 't': character = '\t'; break;
+                    case 'r': character = '\r'; break;
+                    case '0': character = '\0'; break;
+                    default: character = line[position]; break;
+                    }
+                }
+
+                nameLiteral.string.push_back(character);
+            }
+
+            if(!terminated)
+            {
+                std::cerr << "ReflectionGenerator: Detected malformed NAME_CONSTEXPR() literal"
+                    " in \"" << sourcePath.generic_string() << "(" << sourceLine << ")\"\n";
+                return false;
+            }
+
+            nameLiterals.push_back(std::move(nameLiteral));
+        }
+
+        nameTokenBegin = line.find(nameTokenName, position);
+    }
+
+    return true;
+}
+
+void WriteNameLiteralString(std::ostream& stream, const std::string& string)
+{
+    for(char character : string)
+    {
+        switch(character)
+        {
+        case '\\': stream << "\\\\"; break;
+        case '\n': stream << "\\n"; break;
+        case '\t': stream << "\\t"; break;
+        case '\r': stream << "\\r"; break;
+        case '\0': stream << "\\0"; break;
+        default: stream << character; break;
+        }
+    }
+}
+
+std::string ReadNameLiteralString(const std::string_view& escapedString)
+{
+    std::string string;
+    string.reserve(escapedString.size());
+
+    for(std::size_t position = 0; position < escapedString.size(); ++position)
+    {
+        char character = escapedString[position];
+        if(character == '\\' && position + 1 < escapedString.size())
+        {
+            switch(escapedString[++position])
+            {
+            case 'n': character = '\n'; break;
+            case 't': character = '\t'; break;
+            case 'r': character = '\r'; break;
+            case '0': character = '\0'; break;
+            default: character = escapedString[position]; break;
+            }
+        }
+
+        string.push_back(character);
+    }
+
+    return string;
+}
+
+std::string WriteNameList(const std::vector<NameLiteral>& nameLiterals)
+{
+    // Each line holds source path, source line and escaped string separated by tabs.
+    std::ostringstream nameList;
+    for(const auto& nameLiteral : nameLiterals)
+    {
+        nameList << nameLiteral.sourcePath.generic_string() << '\t' << nameLiteral.sourceLine << '\t';
+        WriteNameLiteralString(nameList, nameLiteral.string);
+        nameList << '\n';
+    }
+
+    return nameList.str();
+}
+
+bool ReadNameList(const fs::path& nameListPath, std::vector<NameLiteral>& nameLiterals)
+{
+    std::ifstream file(nameListPath);
+    if(!file.is_open())
+    {
+        std::cerr << "ReflectionGenerator: Failed to open name list file - \""
+            << nameListPath.generic_string() << "\"\n";
+        return false;
+    }
+
+    std::string line;
+    std::size_t lineCount = 0;
+
+    while(std::getline(file, line))
+    {
+        ++lineCount;
+
+        const std::size_t pathEnd = line.find('\t');
+        const std::size_t sourceLineEnd = pathEnd != std::string::npos ?
+            line.find('\t', pathEnd + 1) : std::string::npos;
+
+        if(sourceLineEnd == std::string::npos)
+        {
+            std::cerr << "ReflectionGenerator: Detected malformed name list entry"
+                " in \"" << nameListPath.generic_string() << "(" << lineCount << ")\"\n";
+            return false;
+        }
+
+        NameLiteral& nameLiteral = nameLiterals.emplace_back();
+        nameLiteral.sourcePath = line.substr(0, pathEnd);
+        nameLiteral.sourceLine = std::strtoull(line.c_str() + pathEnd + 1, nullptr, 10);
+        nameLiteral.string = ReadNameLiteralString(std::string_view(line).substr(sourceLineEnd + 1));
+    }
+
+    return true;
+}
+
+bool CheckNameCollisions(const std::vector<NameLiteral>& nameLiterals)
+{
+    // Names with same string share hash, only different strings with same hash collide.
+    std::unordered_map<uint64_t, const NameLiteral*> nameHashes;
+    bool collisionFound = false;
+
+    for(const auto& nameLiteral : nameLiterals)
+    {
+        const uint64_t hash = Common::StringHash<uint64_t>(nameLiteral.string);
+        auto result = nameHashes.emplace(hash, &nameLiteral);
+
+        if(!result.second && result.first->second->string != nameLiteral.string)
+        {
+            const NameLiteral& collidingLiteral = *result.first->second;
+
+            std::cerr << "ReflectionGenerator: Found two names with colliding hashes!\n"
+                << "\t\"" << nameLiteral.string << "\" from \""
+                << nameLiteral.sourcePath.generic_string()
+                << "(" << nameLiteral.sourceLine << ")\"\n"
+                << "\t\"" << collidingLiteral.string << "\" from \""
+                << collidingLiteral.sourcePath.generic_string()
+                << "(" << collidingLiteral.sourceLine << ")\"\n";
+
+            collisionFound = true;
+        }
+    }
+
+    return !collisionFound;
+}
+
+bool WriteFileIfChanged(const fs::path& filePath, const std::string& content)
+{
+    // Check existing file, which is left untouched to avoid needless rebuilds.
+    std::ifstream existingFile(filePath);
+    std::string existingContent;
+
+    if(existingFile.good())
+    {
+        existingFile.seekg(0, std::ios::end);
+        existingContent.reserve(existingFile.tellg());
+        existingFile.seekg(0, std::ios::beg);
+
+        existingContent.assign(
+        std::istreambuf_iterator<char>(existingFile),
+        std::istreambuf_iterator<char>());
+    }
+
+    // Empty file still has to be created, as other modules expect it to exist.
+    if(existingFile.good() && content == existingContent)
+        return true;
+
+    existingFile.close();
+
+    // Create new file.
+    std::ofstream file(filePath);
+
+    if(!file.is_open())
+    {
+        std::cerr << "ReflectionGenerator: Failed to open file for writing - \""
+            << filePath.generic_string() << "\"\n";
+        return false;
+    }
+
+    file << content;
+
+    if(!file.good())
+    {
+        std::cerr << "ReflectionGenerator: Failed to write file - \""
+            << filePath.generic_string() << "\"\n";
+        return false;
+    }
+
+    file.close();
+
+    return true;
+}
+
 struct ReflectedType
 {
     std::string name;
@@ -166,34 +422,86 @@ int main(int argc, const char* argv[])
     if(!parameters.isValid)
         return -1;
 
-    // Create list of header files.
+    // Check name hashes across all modules linked into executable.
+    if(parameters.isNameCheck)
+    {
+        std::vector<NameLiteral> nameLiterals;
+        for(const auto& nameListPath : parameters.nameListPaths)
+        {
+            if(!ReadNameList(nameListPath, nameLiterals))
+                return -1;
+        }
+
+        return CheckNameCollisions(nameLiterals) ? 0 : -1;
+    }
+
+    // Create list of header and source files.
     std::vector<fs::path> headerFileList;
-    
-    for(const auto& sourceDirPath : parameters.sourceDirs)
+    std::vector<fs::path> sourceFileList;
+
+    auto AddFile = [&headerFileList, &sourceFileList](const fs::path& filePath)
     {
-        if(!fs::exists(sourceDirPath))
+        if(filePath.extension() == ".hpp" || filePath.extension() == ".h")
         {
-            std::cerr << "ReflectionGenerator: Source directory path does not exist - \""
-                << sourceDirPath.generic_string() << "\"\n";
+            headerFileList.push_back(filePath);
+        }
+        else if(filePath.extension() == ".cpp")
+        {
+            sourceFileList.push_back(filePath);
+        }
+    };
+
+    for(const auto& sourcePath : parameters.sourcePaths)
+    {
+        if(!fs::exists(sourcePath))
+        {
+            std::cerr << "ReflectionGenerator: Source path does not exist - \""
+                << sourcePath.generic_string() << "\"\n";
             return -1;
         }
 
-        if(!fs::is_directory(sourceDirPath))
+        // Modules without own directory can list their files individually.
+        if(fs::is_regular_file(sourcePath))
         {
-            std::cerr << "ReflectionGenerator: Provided source path is not a directory!\n";
-            std::cerr << "ReflectionGenerator: \"" << sourceDirPath.generic_string() << "\"\n";
+            AddFile(sourcePath);
+            continue;
+        }
+
+        if(!fs::is_directory(sourcePath))
+        {
+            std::cerr << "ReflectionGenerator: Provided source path is not a directory or file!\n";
+            std::cerr << "ReflectionGenerator: \"" << sourcePath.generic_string() << "\"\n";
             return -1;
         }
 
-        for(const auto& dirEntry : fs::recursive_directory_iterator(sourceDirPath))
+        for(const auto& dirEntry : fs::recursive_directory_iterator(sourcePath))
         {
             if(!dirEntry.is_regular_file())
                 continue;
 
-            if(dirEntry.path().extension() == ".hpp" || dirEntry.path().extension() == ".h")
-            {
-                headerFileList.push_back(dirEntry);
-            }
+            AddFile(dirEntry.path());
+        }
+    }
+
+    // Parse source files and collect name literals hashed at compile time.
+    std::vector<NameLiteral> nameLiterals;
+    for(const auto& sourcePath : sourceFileList)
+    {
+        std::ifstream file(sourcePath);
+        if(!file.is_open())
+        {
+            std::cerr << "ReflectionGenerator: Failed to open source file - \""
+                << sourcePath << "\"\n";
+            return -1;
+        }
+
+        std::string line;
+        std::size_t lineCount = 0;
+
+        while(std::getline(file, line))
+        {
+            if(!ParseNameLiterals(line, sourcePath, ++lineCount, nameLiterals))
+                return -1;
         }
     }
 
@@ -219,6 +527,9 @@ int main(int argc, const char* argv[])
         {
             ++lineCount;
 
+            if(!ParseNameLiterals(line, headerPath, lineCount, nameLiterals))
+                return -1;
+
             std::string_view reflectionTokenName = "REFLECTION_TYPE(";
             std::size_t reflectionTokenBegin = line.find(reflectionTokenName);
             if(reflectionTokenBegin == std::string::npos)
@@ -276,6 +587,17 @@ int main(int argc, const char* argv[])
         }
     }
 
+    // Fail on name hash collisions, which could not be detected at run time.
+    // Names of all modules are checked again once executable is linked.
+    if(!CheckNameCollisions(nameLiterals))
+        return -1;
+
+    if(!WriteFileIfChanged(fs::path(parameters.outputDir) / "ReflectionNames.txt",
+        WriteNameList(nameLiterals)))
+    {
+        return -1;
+    }
+
     // Collect unique headers.
     std::set<fs::path> reflectedHeaders;
     for(const auto& type : parsedTypes)
@@ -422,54 +744,10 @@ int main(int argc, const char* argv[])
     reflectionBinding <<
         "}\n";
 
-    // Determine reflection binding file path.
-    std::string reflectionBindingFilename;
-    reflectionBindingFilename += "ReflectionGenerated";
-    reflectionBindingFilename += ".cpp";
-
-    fs::path reflectionBindingFilePath =
-        fs::path(parameters.outputDir) / reflectionBindingFilename;
-
-    // Check existing reflection binding file.
-    std::ifstream existingBindingFile(reflectionBindingFilePath);
-    std::string existingReflectionBinding;
-
-    if(existingBindingFile.good())
-    {
-        existingBindingFile.seekg(0, std::ios::end);
-        existingReflectionBinding.reserve(existingBindingFile.tellg());
-        existingBindingFile.seekg(0, std::ios::beg);
-
-        existingReflectionBinding.assign(
-        std::istreambuf_iterator<char>(existingBindingFile),
-        std::istreambuf_iterator<char>());
-    }
-
-    if(reflectionBinding.str() == existingReflectionBinding)
-        return 0;
-
-    existingBindingFile.close();
-
-    // Create new reflection binding file.
-    std::ofstream reflectionBindingFile(reflectionBindingFilePath);
-    
-    if(!reflectionBindingFile.is_open())
-    {
-        std::cerr << "ReflectionGenerator: Failed to open file for writing - \""
-            << reflectionBindingFilePath.generic_string() << "\"\n";
+    // Write reflection binding file.
+    fs::path reflectionBindingFilePath = fs::path(parameters.outputDir) / "ReflectionGenerated.cpp";
+    if(!WriteFileIfChanged(reflectionBindingFilePath, reflectionBinding.str()))
         return -1;
-    }
-
-    reflectionBindingFile << reflectionBinding.str();
-
-    if(!reflectionBindingFile.good())
-    {
-        std::cerr << "ReflectionGenerator: Failed to write file - \""
-            << reflectionBindingFilePath.generic_string() << "\"\n";
-        return -1;
-    }
-
-    reflectionBindingFile.close();
 
     return 0;
 }
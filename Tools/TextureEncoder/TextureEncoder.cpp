@@ -0,0 +1,962 @@
+/*
+    Copyright (c) 2018-2021 Piotr Doan. All rights reserved.
+    Software distributed under the permissive MIT License.
+*/
+
+#include <iostream>
+#include <Core/Core.hpp>
+#include <System/Image.hpp>
+#include <System/KtxImage.hpp>
+#include <System/FileSystem/NativeFileHandle.hpp>
+
+/*
+    Texture Encoder
+
+    Converts PNG image into KTX2 file with block compressed mip levels, which can be loaded as
+    texture without decoding. Encoders favor speed and simplicity over best possible quality:
+    BC7 uses only its single subset mode, and ETC2 uses only individual and differential modes.
+
+    Usage: TextureEncoder <input.png> <output.ktx2> [--format <name>] [--no-mipmaps]
+*/
+
+namespace
+{
+    using Pixels = std::vector<uint8_t>;
+    using BlockPixels = uint8_t[16][4];
+    using EncodeBlockFunction = void(*)(const BlockPixels& pixels, uint8_t* output);
+
+    struct EncoderParameters
+    {
+        fs::path inputPath;
+        fs::path outputPath;
+        System::PixelFormat format = System::PixelFormat::ETC2_RGBA8;
+        bool mipmaps = true;
+        bool isValid = false;
+    };
+
+    EncoderParameters ParseCommandLineArguments(int argc, const char* argv[])
+    {
+        EncoderParameters parameters;
+        std::vector<std::string_view> positional;
+
+        for(int arg = 1; arg < argc; ++arg)
+        {
+            std::string_view argument = argv[arg];
+            if(argument == "--format" && arg + 1 < argc)
+            {
+                parameters.format = System::FindPixelFormat(argv[++arg]);
+                if(parameters.format == System::PixelFormat::Unknown)
+                {
+                    std::cerr << "TextureEncoder: Unknown pixel format \"" << argv[arg] << "\"!\n";
+                    return parameters;
+                }
+            }
+            else if(argument == "--no-mipmaps")
+            {
+                parameters.mipmaps = false;
+            }
+            else
+            {
+                positional.push_back(argument);
+            }
+        }
+
+        if(positional.size() != 2)
+        {
+            std::cerr << "TextureEncoder: Usage: TextureEncoder <input.png> <output.ktx2> "
+                "[--format <name>] [--no-mipmaps]\n";
+            return parameters;
+        }
+
+        parameters.inputPath = positional[0];
+        parameters.outputPath = positional[1];
+        parameters.isValid = true;
+        return parameters;
+    }
+
+    int ColorDistance(const uint8_t* left, const uint8_t* right, int channels)
+    {
+        int distance = 0;
+        for(int channel = 0; channel < channels; ++channel)
+        {
+            const int difference = left[channel] - right[channel];
+            distance += difference * difference;
+        }
+
+        return distance;
+    }
+
+    uint8_t Clamp255(int value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+
+    void WriteBigEndian64(uint64_t value, uint8_t* output)
+    {
+        for(int i = 0; i < 8; ++i)
+        {
+            output[i] = static_cast<uint8_t>(value >> (56 - i * 8));
+        }
+    }
+
+    void WriteLittleEndian64(uint64_t value, uint8_t* output)
+    {
+        for(int i = 0; i < 8; ++i)
+        {
+            output[i] = static_cast<uint8_t>(value >> (i * 8));
+        }
+    }
+
+    /*
+        BC1, BC2, BC3, BC4 and BC5
+    */
+
+    uint32_t Quantize565(const int* color)
+    {
+        const uint32_t red = (std::clamp(color[0], 0, 255) * 31 + 127) / 255;
+        const uint32_t green = (std::clamp(color[1], 0, 255) * 63 + 127) / 255;
+        const uint32_t blue = (std::clamp(color[2], 0, 255) * 31 + 127) / 255;
+        return (red << 11) | (green << 5) | blue;
+    }
+
+    void Expand565(uint32_t color, uint8_t* rgb)
+    {
+        const uint32_t red = (color >> 11) & 31;
+        const uint32_t green = (color >> 5) & 63;
+        const uint32_t blue = color & 31;
+        rgb[0] = static_cast<uint8_t>((red << 3) | (red >> 2));
+        rgb[1] = static_cast<uint8_t>((green << 2) | (green >> 4));
+        rgb[2] = static_cast<uint8_t>((blue << 3) | (blue >> 2));
+    }
+
+    void EncodeColorBC(const BlockPixels& pixels, bool allowTransparent, uint8_t* output)
+    {
+        // Transparent pixels are only representable in three color mode.
+        bool transparent = false;
+        int minimum[3] = { 255, 255, 255 };
+        int maximum[3] = { 0, 0, 0 };
+
+        for(int i = 0; i < 16; ++i)
+        {
+            if(allowTransparent && pixels[i][3] < 128)
+            {
+                transparent = true;
+                continue;
+            }
+
+            for(int channel = 0; channel < 3; ++channel)
+            {
+                minimum[channel] = std::min<int>(minimum[channel], pixels[i][channel]);
+                maximum[channel] = std::max<int>(maximum[channel], pixels[i][channel]);
+            }
+        }
+
+        // Inset bounding box to reduce error of interpolated colors.
+        for(int channel = 0; channel < 3 && minimum[channel] <= maximum[channel]; ++channel)
+        {
+            const int inset = (maximum[channel] - minimum[channel]) / 16;
+            minimum[channel] += inset;
+            maximum[channel] -= inset;
+        }
+
+        uint32_t color0 = Quantize565(maximum);
+        uint32_t color1 = Quantize565(minimum);
+
+        // Order of endpoints selects between four and three color modes.
+        if(transparent ? color0 > color1 : color0 < color1)
+        {
+            std::swap(color0, color1);
+        }
+
+        uint8_t palette[4][3];
+        Expand565(color0, palette[0]);
+        Expand565(color1, palette[1]);
+
+        const int paletteSize = color0 > color1 || !allowTransparent ? 4 : 3;
+        for(int channel = 0; channel < 3; ++channel)
+        {
+            if(paletteSize == 4)
+            {
+                palette[2][channel] = static_cast<uint8_t>((2 * palette[0][channel] + palette[1][channel]) / 3);
+                palette[3][channel] = static_cast<uint8_t>((palette[0][channel] + 2 * palette[1][channel]) / 3);
+            }
+            else
+            {
+                palette[2][channel] = static_cast<uint8_t>((palette[0][channel] + palette[1][channel]) / 2);
+                palette[3][channel] = 0;
+            }
+        }
+
+        uint32_t indices = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            uint32_t bestIndex = 3;
+            if(!(allowTransparent && pixels[i][3] < 128))
+            {
+                int bestDistance = std::numeric_limits<int>::max();
+                for(int index = 0; index < paletteSize; ++index)
+                {
+                    const int distance = ColorDistance(pixels[i], palette[index], 3);
+                    if(distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        bestIndex = index;
+                    }
+                }
+            }
+
+            indices |= bestIndex << (i * 2);
+        }
+
+        output[0] = static_cast<uint8_t>(color0);
+        output[1] = static_cast<uint8_t>(color0 >> 8);
+        output[2] = static_cast<uint8_t>(color1);
+        output[3] = static_cast<uint8_t>(color1 >> 8);
+        output[4] = static_cast<uint8_t>(indices);
+        output[5] = static_cast<uint8_t>(indices >> 8);
+        output[6] = static_cast<uint8_t>(indices >> 16);
+        output[7] = static_cast<uint8_t>(indices >> 24);
+    }
+
+    void EncodeAlphaBC(const BlockPixels& pixels, int channel, uint8_t* output)
+    {
+        int minimum = 255;
+        int maximum = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            minimum = std::min<int>(minimum, pixels[i][channel]);
+            maximum = std::max<int>(maximum, pixels[i][channel]);
+        }
+
+        // Eight value mode needs first value to be larger.
+        if(minimum == maximum)
+        {
+            maximum = std::min(maximum + 1, 255);
+            minimum = maximum - 1;
+        }
+
+        int values[8] = { maximum, minimum };
+        for(int i = 2; i < 8; ++i)
+        {
+            values[i] = ((8 - i) * maximum + (i - 1) * minimum) / 7;
+        }
+
+        uint64_t block = static_cast<uint64_t>(maximum) | (static_cast<uint64_t>(minimum) << 8);
+        for(int i = 0; i < 16; ++i)
+        {
+            uint64_t bestIndex = 0;
+            int bestDistance = std::numeric_limits<int>::max();
+            for(int index = 0; index < 8; ++index)
+            {
+                const int distance = std::abs(values[index] - pixels[i][channel]);
+                if(distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+
+            block |= bestIndex << (16 + i * 3);
+        }
+
+        WriteLittleEndian64(block, output);
+    }
+
+    void EncodeBC1(const BlockPixels& pixels, uint8_t* output)
+    {
+        EncodeColorBC(pixels, true, output);
+    }
+
+    void EncodeBC2(const BlockPixels& pixels, uint8_t* output)
+    {
+        uint64_t alpha = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            alpha |= static_cast<uint64_t>((pixels[i][3] + 8) / 17) << (i * 4);
+        }
+
+        WriteLittleEndian64(alpha, output);
+        EncodeColorBC(pixels, false, output + 8);
+    }
+
+    void EncodeBC3(const BlockPixels& pixels, uint8_t* output)
+    {
+        EncodeAlphaBC(pixels, 3, output);
+        EncodeColorBC(pixels, false, output + 8);
+    }
+
+    void EncodeBC4(const BlockPixels& pixels, uint8_t* output)
+    {
+        EncodeAlphaBC(pixels, 0, output);
+    }
+
+    void EncodeBC5(const BlockPixels& pixels, uint8_t* output)
+    {
+        EncodeAlphaBC(pixels, 0, output);
+        EncodeAlphaBC(pixels, 1, output + 8);
+    }
+
+    /*
+        BC7
+    */
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(uint8_t* output) :
+            m_output(output)
+        {
+            std::memset(m_output, 0, 16);
+        }
+
+        void Write(uint32_t value, int count)
+        {
+            for(int i = 0; i < count; ++i, ++m_position)
+            {
+                m_output[m_position / 8] |= static_cast<uint8_t>(((value >> i) & 1) << (m_position % 8));
+            }
+        }
+
+    private:
+        uint8_t* m_output;
+        int m_position = 0;
+    };
+
+    void EncodeBC7(const BlockPixels& pixels, uint8_t* output)
+    {
+        // Mode 6 with single subset, seven bit RGBA endpoints with unique bits and four bit indices.
+        const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        int endpoints[2][4];
+        for(int channel = 0; channel < 4; ++channel)
+        {
+            endpoints[0][channel] = 255;
+            endpoints[1][channel] = 0;
+        }
+
+        for(int i = 0; i < 16; ++i)
+        {
+            for(int channel = 0; channel < 4; ++channel)
+            {
+                endpoints[0][channel] = std::min<int>(endpoints[0][channel], pixels[i][channel]);
+                endpoints[1][channel] = std::max<int>(endpoints[1][channel], pixels[i][channel]);
+            }
+        }
+
+        // Quantize endpoints to seven bits and unique bit shared by all channels.
+        int quantized[2][4];
+        int endpointBits[2];
+        uint8_t expanded[2][4];
+
+        for(int endpoint = 0; endpoint < 2; ++endpoint)
+        {
+            int bestError = std::numeric_limits<int>::max();
+            for(int bit = 0; bit < 2; ++bit)
+            {
+                int error = 0;
+                int values[4];
+                for(int channel = 0; channel < 4; ++channel)
+                {
+                    const int target = endpoints[endpoint][channel];
+                    values[channel] = std::clamp((target - bit + 1) >> 1, 0, 127);
+                    const int value = (values[channel] << 1) | bit;
+                    error += (value - target) * (value - target);
+                }
+
+                if(error < bestError)
+                {
+                    bestError = error;
+                    endpointBits[endpoint] = bit;
+                    std::copy(std::begin(values), std::end(values), quantized[endpoint]);
+                }
+            }
+
+            for(int channel = 0; channel < 4; ++channel)
+            {
+                expanded[endpoint][channel] = static_cast<uint8_t>(
+                    (quantized[endpoint][channel] << 1) | endpointBits[endpoint]);
+            }
+        }
+
+        int indices[16];
+        for(int i = 0; i < 16; ++i)
+        {
+            int bestDistance = std::numeric_limits<int>::max();
+            for(int index = 0; index < 16; ++index)
+            {
+                uint8_t color[4];
+                for(int channel = 0; channel < 4; ++channel)
+                {
+                    color[channel] = static_cast<uint8_t>(((64 - weights[index]) * expanded[0][channel] +
+                        weights[index] * expanded[1][channel] + 32) >> 6);
+                }
+
+                const int distance = ColorDistance(pixels[i], color, 4);
+                if(distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    indices[i] = index;
+                }
+            }
+        }
+
+        // Most significant bit of first index is implied to be zero.
+        if(indices[0] >= 8)
+        {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(endpointBits[0], endpointBits[1]);
+            for(int& index : indices)
+            {
+                index = 15 - index;
+            }
+        }
+
+        BitWriter bits(output);
+        bits.Write(1 << 6, 7);
+
+        for(int channel = 0; channel < 4; ++channel)
+        {
+            bits.Write(quantized[0][channel], 7);
+            bits.Write(quantized[1][channel], 7);
+        }
+
+        bits.Write(endpointBits[0], 1);
+        bits.Write(endpointBits[1], 1);
+
+        for(int i = 0; i < 16; ++i)
+        {
+            bits.Write(indices[i], i == 0 ? 3 : 4);
+        }
+    }
+
+    /*
+        ETC2 and EAC
+    */
+
+    const int ModifiersETC[8][2] =
+    {
+        { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 },
+        { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 },
+    };
+
+    const int ModifiersEAC[16][8] =
+    {
+        { -3, -6, -9, -15, 2, 5, 8, 14 },
+        { -3, -7, -10, -13, 2, 6, 9, 12 },
+        { -2, -5, -8, -13, 1, 4, 7, 12 },
+        { -2, -4, -6, -13, 1, 3, 5, 12 },
+        { -3, -6, -8, -12, 2, 5, 7, 11 },
+        { -3, -7, -9, -11, 2, 6, 8, 10 },
+        { -4, -7, -8, -11, 3, 6, 7, 10 },
+        { -3, -5, -8, -11, 2, 4, 7, 10 },
+        { -2, -6, -8, -10, 1, 5, 7, 9 },
+        { -2, -5, -8, -10, 1, 4, 7, 9 },
+        { -2, -4, -8, -10, 1, 3, 7, 9 },
+        { -2, -5, -7, -10, 1, 4, 6, 9 },
+        { -3, -4, -7, -10, 2, 3, 6, 9 },
+        { -1, -2, -3, -10, 0, 1, 2, 9 },
+        { -4, -6, -8, -9, 3, 5, 7, 8 },
+        { -3, -5, -7, -9, 2, 4, 6, 8 },
+    };
+
+    // Pixels of ETC blocks are indexed in columns.
+    int BlockPixelIndex(int column, int row)
+    {
+        return row * 4 + column;
+    }
+
+    struct SubblockFit
+    {
+        int table = 0;
+        int error = 0;
+        int indices[8] = {};
+        int pixels[8] = {};
+    };
+
+    SubblockFit FitSubblock(const BlockPixels& pixels, const int* subblockPixels,
+        const int* baseColor, bool punchthrough)
+    {
+        SubblockFit bestFit;
+        bestFit.error = std::numeric_limits<int>::max();
+
+        for(int table = 0; table < 8; ++table)
+        {
+            SubblockFit fit;
+            fit.table = table;
+
+            for(int i = 0; i < 8; ++i)
+            {
+                const uint8_t* pixel = pixels[subblockPixels[i]];
+                fit.pixels[i] = subblockPixels[i];
+
+                // Transparent pixels of punchthrough blocks use reserved index.
+                if(punchthrough && pixel[3] < 128)
+                {
+                    fit.indices[i] = 2;
+                    continue;
+                }
+
+                int bestDistance = std::numeric_limits<int>::max();
+                for(int index = 0; index < 4; ++index)
+                {
+                    if(punchthrough && index == 2)
+                        continue;
+
+                    int modifier = (index & 1) ? ModifiersETC[table][1] : ModifiersETC[table][0];
+                    modifier = (index & 2) ? -modifier : modifier;
+                    modifier = punchthrough && (index & 1) == 0 ? 0 : modifier;
+
+                    const uint8_t color[3] =
+                    {
+                        Clamp255(baseColor[0] + modifier),
+                        Clamp255(baseColor[1] + modifier),
+                        Clamp255(baseColor[2] + modifier),
+                    };
+
+                    const int distance = ColorDistance(pixel, color, 3);
+                    if(distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        fit.indices[i] = index;
+                    }
+                }
+
+                fit.error += bestDistance;
+            }
+
+            if(fit.error < bestFit.error)
+            {
+                bestFit = fit;
+            }
+        }
+
+        return bestFit;
+    }
+
+    void EncodeColorETC(const BlockPixels& pixels, bool punchthrough, uint8_t* output)
+    {
+        bool transparent = false;
+        for(int i = 0; i < 16; ++i)
+        {
+            transparent |= punchthrough && pixels[i][3] < 128;
+        }
+
+        uint64_t bestBlock = 0;
+        int bestError = std::numeric_limits<int>::max();
+
+        for(int flip = 0; flip < 2; ++flip)
+        {
+            // Gather pixels and average colors of both halves of block.
+            int subblockPixels[2][8];
+            int averages[2][3] = {};
+            int counts[2] = {};
+
+            for(int subblock = 0; subblock < 2; ++subblock)
+            {
+                for(int i = 0; i < 8; ++i)
+                {
+                    const int column = flip ? i % 4 : subblock * 2 + i / 4;
+                    const int row = flip ? subblock * 2 + i / 4 : i % 4;
+                    const int pixel = BlockPixelIndex(column, row);
+                    subblockPixels[subblock][i] = pixel;
+
+                    if(punchthrough && pixels[pixel][3] < 128)
+                        continue;
+
+                    for(int channel = 0; channel < 3; ++channel)
+                    {
+                        averages[subblock][channel] += pixels[pixel][channel];
+                    }
+
+                    counts[subblock] += 1;
+                }
+
+                for(int channel = 0; channel < 3; ++channel)
+                {
+                    averages[subblock][channel] = counts[subblock] != 0 ?
+                        averages[subblock][channel] / counts[subblock] : 0;
+                }
+            }
+
+            for(int differential = punchthrough ? 1 : 0; differential < 2; ++differential)
+            {
+                uint64_t block = 0;
+                int baseColors[2][3];
+
+                if(differential)
+                {
+                    // Second color is stored as three bit signed offset from first color.
+                    for(int channel = 0; channel < 3; ++channel)
+                    {
+                        const int first = (averages[0][channel] * 31 + 127) / 255;
+                        const int second = (averages[1][channel] * 31 + 127) / 255;
+                        const int delta = std::clamp(second - first, -4, 3);
+
+                        baseColors[0][channel] = (first << 3) | (first >> 2);
+                        baseColors[1][channel] = ((first + delta) << 3) | ((first + delta) >> 2);
+                        block |= static_cast<uint64_t>(first) << (59 - channel * 8);
+                        block |= static_cast<uint64_t>(delta & 7) << (56 - channel * 8);
+                    }
+
+                    // Punchthrough blocks use differential bit to mark opaque blocks instead.
+                    if(!punchthrough || !transparent)
+                    {
+                        block |= 1ull << 33;
+                    }
+                }
+                else
+                {
+                    for(int channel = 0; channel < 3; ++channel)
+                    {
+                        const int first = (averages[0][channel] * 15 + 127) / 255;
+                        const int second = (averages[1][channel] * 15 + 127) / 255;
+
+                        baseColors[0][channel] = first * 17;
+                        baseColors[1][channel] = second * 17;
+                        block |= static_cast<uint64_t>(first) << (60 - channel * 8);
+                        block |= static_cast<uint64_t>(second) << (56 - channel * 8);
+                    }
+                }
+
+                block |= static_cast<uint64_t>(flip) << 32;
+
+                int error = 0;
+                for(int subblock = 0; subblock < 2; ++subblock)
+                {
+                    const SubblockFit fit = FitSubblock(pixels, subblockPixels[subblock],
+                        baseColors[subblock], punchthrough && transparent);
+
+                    error += fit.error;
+                    block |= static_cast<uint64_t>(fit.table) << (subblock == 0 ? 37 : 34);
+
+                    for(int i = 0; i < 8; ++i)
+                    {
+                        // Convert row-major pixel into column-major bit position.
+                        const int pixel = fit.pixels[i];
+                        const int bit = (pixel % 4) * 4 + pixel / 4;
+                        block |= static_cast<uint64_t>(fit.indices[i] >> 1) << (16 + bit);
+                        block |= static_cast<uint64_t>(fit.indices[i] & 1) << bit;
+                    }
+                }
+
+                if(error < bestError)
+                {
+                    bestError = error;
+                    bestBlock = block;
+                }
+            }
+        }
+
+        WriteBigEndian64(bestBlock, output);
+    }
+
+    template<typename DecodeFunction>
+    uint64_t EncodeBlockEAC(const BlockPixels& pixels, int channel, int base, DecodeFunction decode)
+    {
+        // Search all tables and multipliers for smallest error.
+        uint64_t bestBlock = 0;
+        int bestError = std::numeric_limits<int>::max();
+
+        for(int table = 0; table < 16; ++table)
+        {
+            for(int multiplier = 1; multiplier < 16; ++multiplier)
+            {
+                uint64_t block = (static_cast<uint64_t>(base) << 56) |
+                    (static_cast<uint64_t>(multiplier) << 52) | (static_cast<uint64_t>(table) << 48);
+
+                int error = 0;
+                for(int column = 0; column < 4; ++column)
+                {
+                    for(int row = 0; row < 4; ++row)
+                    {
+                        const int target = pixels[BlockPixelIndex(column, row)][channel];
+                        int bestDistance = std::numeric_limits<int>::max();
+                        uint64_t bestIndex = 0;
+
+                        for(int index = 0; index < 8; ++index)
+                        {
+                            const int value = decode(base, ModifiersEAC[table][index], multiplier);
+                            const int distance = std::abs(value - target);
+                            if(distance < bestDistance)
+                            {
+                                bestDistance = distance;
+                                bestIndex = index;
+                            }
+                        }
+
+                        error += bestDistance * bestDistance;
+                        block |= bestIndex << (45 - (column * 4 + row) * 3);
+                    }
+                }
+
+                if(error < bestError)
+                {
+                    bestError = error;
+                    bestBlock = block;
+                }
+            }
+        }
+
+        return bestBlock;
+    }
+
+    int FindBaseEAC(const BlockPixels& pixels, int channel)
+    {
+        int minimum = 255;
+        int maximum = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            minimum = std::min<int>(minimum, pixels[i][channel]);
+            maximum = std::max<int>(maximum, pixels[i][channel]);
+        }
+
+        return (minimum + maximum + 1) / 2;
+    }
+
+    void EncodeAlphaEAC(const BlockPixels& pixels, int channel, uint8_t* output)
+    {
+        const int base = FindBaseEAC(pixels, channel);
+        WriteBigEndian64(EncodeBlockEAC(pixels, channel, base,
+            [](int base, int modifier, int multiplier)
+            {
+                return std::clamp(base + modifier * multiplier, 0, 255);
+            }), output);
+    }
+
+    void EncodeRedEAC(const BlockPixels& pixels, int channel, uint8_t* output)
+    {
+        const int base = FindBaseEAC(pixels, channel);
+        WriteBigEndian64(EncodeBlockEAC(pixels, channel, base,
+            [](int base, int modifier, int multiplier)
+            {
+                const int value = std::clamp(base * 8 + 4 + modifier * multiplier * 8, 0, 2047);
+                return (value * 255 + 1023) / 2047;
+            }), output);
+    }
+
+    void EncodeETC2RGB8(const BlockPixels& pixels, uint8_t* output)
+    {
+        EncodeColorETC(pixels, false, output);
+    }
+
+    void EncodeETC2RGB8A1(const BlockPixels& pixels, uint8_t* output)
+    {
+        EncodeColorETC(pixels, true, output);
+    }
+
+    void EncodeETC2RGBA8(const BlockPixels& pixels, uint8_t* output)
+    {
+        EncodeAlphaEAC(pixels, 3, output);
+        EncodeColorETC(pixels, false, output + 8);
+    }
+
+    void EncodeEACR11(const BlockPixels& pixels, uint8_t* output)
+    {
+        EncodeRedEAC(pixels, 0, output);
+    }
+
+    void EncodeEACRG11(const BlockPixels& pixels, uint8_t* output)
+    {
+        EncodeRedEAC(pixels, 0, output);
+        EncodeRedEAC(pixels, 1, output + 8);
+    }
+
+    EncodeBlockFunction GetBlockEncoder(System::PixelFormat format)
+    {
+        switch(format)
+        {
+        case System::PixelFormat::BC1: return &EncodeBC1;
+        case System::PixelFormat::BC2: return &EncodeBC2;
+        case System::PixelFormat::BC3: return &EncodeBC3;
+        case System::PixelFormat::BC4: return &EncodeBC4;
+        case System::PixelFormat::BC5: return &EncodeBC5;
+        case System::PixelFormat::BC7: return &EncodeBC7;
+        case System::PixelFormat::ETC2_RGB8: return &EncodeETC2RGB8;
+        case System::PixelFormat::ETC2_RGB8A1: return &EncodeETC2RGB8A1;
+        case System::PixelFormat::ETC2_RGBA8: return &EncodeETC2RGBA8;
+        case System::PixelFormat::EAC_R11: return &EncodeEACR11;
+        case System::PixelFormat::EAC_RG11: return &EncodeEACRG11;
+        default: return nullptr;
+        }
+    }
+
+    /*
+        Levels
+    */
+
+    Pixels ConvertToRGBA(const System::Image& image)
+    {
+        const int channels = image.GetChannels();
+        const std::size_t pixelCount = static_cast<std::size_t>(image.GetWidth()) * image.GetHeight();
+        const uint8_t* data = image.GetData();
+
+        Pixels pixels(pixelCount * 4);
+        for(std::size_t i = 0; i < pixelCount; ++i)
+        {
+            const uint8_t* source = data + i * channels;
+            uint8_t* destination = &pixels[i * 4];
+
+            // Grayscale images are expanded to all color channels.
+            const bool gray = channels <= 2;
+            destination[0] = source[0];
+            destination[1] = gray ? source[0] : source[1];
+            destination[2] = gray ? source[0] : source[2];
+            destination[3] = channels == 2 ? source[1] : channels == 4 ? source[3] : 255;
+        }
+
+        return pixels;
+    }
+
+    Pixels Downsample(const Pixels& pixels, int width, int height)
+    {
+        // Average two by two pixels, clamping at odd edges.
+        const int nextWidth = std::max(1, width / 2);
+        const int nextHeight = std::max(1, height / 2);
+        Pixels next(static_cast<std::size_t>(nextWidth) * nextHeight * 4);
+
+        for(int y = 0; y < nextHeight; ++y)
+        {
+            for(int x = 0; x < nextWidth; ++x)
+            {
+                for(int channel = 0; channel < 4; ++channel)
+                {
+                    int sum = 0;
+                    for(int offset = 0; offset < 4; ++offset)
+                    {
+                        const int sourceX = std::min(x * 2 + offset % 2, width - 1);
+                        const int sourceY = std::min(y * 2 + offset / 2, height - 1);
+                        sum += pixels[(static_cast<std::size_t>(sourceY) * width + sourceX) * 4 + channel];
+                    }
+
+                    next[(static_cast<std::size_t>(y) * nextWidth + x) * 4 + channel] =
+                        static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+
+        return next;
+    }
+
+    System::KtxImage::Data EncodeLevel(System::PixelFormat format,
+        const Pixels& pixels, int width, int height)
+    {
+        const System::PixelFormatInfo& info = System::GetPixelFormatInfo(format);
+        System::KtxImage::Data data(System::CalculateLevelSize(format, width, height));
+
+        // Uncompressed formats keep their leading channels.
+        if(!info.compressed)
+        {
+            const std::size_t pixelCount = static_cast<std::size_t>(width) * height;
+            for(std::size_t i = 0; i < pixelCount; ++i)
+            {
+                std::memcpy(&data[i * info.channels], &pixels[i * 4], info.channels);
+            }
+
+            return data;
+        }
+
+        // Encode blocks, repeating edge pixels of partial blocks.
+        EncodeBlockFunction encodeBlock = GetBlockEncoder(format);
+        uint8_t* output = data.data();
+
+        for(int blockY = 0; blockY < height; blockY += 4)
+        {
+            for(int blockX = 0; blockX < width; blockX += 4)
+            {
+                BlockPixels block;
+                for(int y = 0; y < 4; ++y)
+                {
+                    for(int x = 0; x < 4; ++x)
+                    {
+                        const int sourceX = std::min(blockX + x, width - 1);
+                        const int sourceY = std::min(blockY + y, height - 1);
+                        std::memcpy(block[y * 4 + x],
+                            &pixels[(static_cast<std::size_t>(sourceY) * width + sourceX) * 4], 4);
+                    }
+                }
+
+                encodeBlock(block, output);
+                output += info.blockBytes;
+            }
+        }
+
+        return data;
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    EncoderParameters parameters = ParseCommandLineArguments(argc, argv);
+    if(!parameters.isValid)
+        return -1;
+
+    // Load source image.
+    auto inputFile = System::NativeFileHandle::Create(parameters.inputPath,
+        parameters.inputPath, System::FileHandle::OpenFlags::Read).UnwrapOr(nullptr);
+    if(inputFile == nullptr)
+    {
+        std::cerr << "TextureEncoder: Could not open \"" << parameters.inputPath.generic_string() << "\" file!\n";
+        return -1;
+    }
+
+    auto image = System::Image::Create(*inputFile, System::Image::LoadFromFile()).UnwrapOr(nullptr);
+    if(image == nullptr)
+    {
+        std::cerr << "TextureEncoder: Could not load image from \"" << parameters.inputPath.generic_string() << "\" file!\n";
+        return -1;
+    }
+
+    // Encode full size image and its mip levels.
+    System::KtxImage::CreateFromParams ktxParams;
+    ktxParams.format = parameters.format;
+    ktxParams.width = image->GetWidth();
+    ktxParams.height = image->GetHeight();
+
+    Pixels pixels = ConvertToRGBA(*image);
+    int width = image->GetWidth();
+    int height = image->GetHeight();
+    std::size_t uncompressedSize = 0;
+
+    while(true)
+    {
+        ktxParams.levels.push_back(EncodeLevel(parameters.format, pixels, width, height));
+        uncompressedSize += static_cast<std::size_t>(width) * height * 4;
+
+        if(!parameters.mipmaps || (width == 1 && height == 1))
+            break;
+
+        pixels = Downsample(pixels, width, height);
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+
+    auto ktxImage = System::KtxImage::Create(ktxParams).UnwrapOr(nullptr);
+    if(ktxImage == nullptr)
+    {
+        std::cerr << "TextureEncoder: Could not create KTX image!\n";
+        return -1;
+    }
+
+    // Write output file.
+    auto outputFile = System::NativeFileHandle::Create(parameters.outputPath, parameters.outputPath,
+        System::FileHandle::OpenFlags::Write | System::FileHandle::OpenFlags::Truncate).UnwrapOr(nullptr);
+    if(outputFile == nullptr || !ktxImage->Write(*outputFile))
+    {
+        std::cerr << "TextureEncoder: Could not write \"" << parameters.outputPath.generic_string() << "\" file!\n";
+        return -1;
+    }
+
+    std::size_t encodedSize = 0;
+    for(int level = 0; level < ktxImage->GetLevelCount(); ++level)
+    {
+        encodedSize += ktxImage->GetLevelSize(level);
+    }
+
+    std::cout << "TextureEncoder: Encoded " << image->GetWidth() << "x" << image->GetHeight()
+        << " image with " << ktxImage->GetLevelCount() << " levels to "
+        << System::GetPixelFormatInfo(parameters.format).name << " format using "
+        << encodedSize << " bytes instead of " << uncompressedSize << " bytes of RGBA8 ("
+        << 100 - encodedSize * 100 / uncompressedSize << "% smaller).\n";
+
+    return 0;
+}